@@ -34,6 +34,7 @@ bool	gDynarecLoopOptimisation	= false;	// Enable the dynarec loop optmisation
 bool	gDynarecDoublesOptimisation	= false;	// Enable the dynarec Doubles optmisation
 bool	gOSHooksEnabled				= true;		// Apply os-hooks
 u32		gCheckTextureHashFrequency	= 16;		// How often to check textures for updates (every N frames, 0 to disable)
+bool	gBatchTrisEnabled			= true;		// Merge consecutive triangle flushes drawn with the same state
 bool	gDoubleDisplayEnabled		= true;		// Workaround for games that have shaking issues
 bool	gCleanSceneEnabled			= false;	// Clean our Scenes, it gets rid of many glitches
 bool	gClearDepthFrameBuffer		= false;	// Clears depth frame buffer, fixes shaky camera in DK64 and sun/flame glare in Zelda
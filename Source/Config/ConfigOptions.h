@@ -51,6 +51,7 @@ extern bool gCheatsEnabled;
 extern bool	gCleanSceneEnabled;
 extern bool	gClearDepthFrameBuffer;
 extern u32	gCheckTextureHashFrequency;
+extern bool	gBatchTrisEnabled;
 //ToDo: Needs moving to Input plugin config
 extern u32	gControllerIndex;
 
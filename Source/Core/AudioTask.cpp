@@ -0,0 +1,118 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Core/AudioTask.h"
+
+#include "Core/CPU.h"
+#include "Core/Memory.h"
+#include "HLEAudio/audiohle.h"
+#include "OSHLE/ultra_rcp.h"
+#include "Utility/Profiler.h"
+#include "Utility/WorkerPool.h"
+
+namespace
+{
+	// About as long as a typical alist keeps the RSP busy. Games poll
+	// SP_STATUS or wait for the SP interrupt, so the exact figure doesn't matter
+	const s32		kAudioTaskCycles = 4000;
+
+	class CAudioUcodeJob : public CWorkerJob
+	{
+	public:
+		virtual void	Run();
+	};
+
+	CWorkerPool *		gAudioThread = nullptr;
+	CAudioUcodeJob		gAudioUcodeJob;
+
+	bool				gTaskInFlight = false;			// Cpu thread only
+	bool				gFinishEventQueued = false;		// Cpu thread only
+
+	void CAudioUcodeJob::Run()
+	{
+		DAEDALUS_PROFILE( "AudioTask: Run" );
+
+		Audio_Ucode();
+	}
+}
+
+bool AudioTask_Open()
+{
+	gTaskInFlight = false;
+	gFinishEventQueued = false;
+	return true;
+}
+
+void AudioTask_Close()
+{
+	if( gAudioThread != nullptr )
+	{
+		gAudioThread->Wait( &gAudioUcodeJob );
+		delete gAudioThread;
+		gAudioThread = nullptr;
+	}
+	gTaskInFlight = false;
+}
+
+EProcessResult AudioTask_Start()
+{
+	DAEDALUS_ASSERT( !gTaskInFlight, "The last audio task hasn't finished" );
+
+	// Started on first use, as the mode can be changed while a rom is running
+	if( gAudioThread == nullptr )
+	{
+		gAudioThread = new CWorkerPool( "Audio", 1 );
+	}
+
+	if( gAudioThread->GetNumThreads() == 0 )
+	{
+		gAudioUcodeJob.Run();
+		return PR_COMPLETED;
+	}
+
+	gAudioThread->Submit( &gAudioUcodeJob );
+	gTaskInFlight = true;
+
+	// If the last task finished early its event is still queued, and can finish this one too
+	if( !gFinishEventQueued )
+	{
+		CPU_AddEvent( kAudioTaskCycles, CPU_EVENT_AUDIOTASK );
+		gFinishEventQueued = true;
+	}
+	return PR_STARTED;
+}
+
+void AudioTask_Finish()
+{
+	if( !gTaskInFlight )
+		return;
+
+	DAEDALUS_PROFILE( "AudioTask: Wait" );
+
+	gAudioThread->Wait( &gAudioUcodeJob );
+	gTaskInFlight = false;
+	RSP_HLE_Finished( SP_STATUS_TASKDONE|SP_STATUS_BROKE|SP_STATUS_HALT );
+}
+
+void AudioTask_OnFinishEvent()
+{
+	gFinishEventQueued = false;
+	AudioTask_Finish();
+}
@@ -0,0 +1,49 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef CORE_AUDIOTASK_H_
+#define CORE_AUDIOTASK_H_
+
+#include "Core/RSP_HLE.h"
+
+//
+//	With APM_ENABLED_ASYNC, the audio plugins hand alists to an audio thread
+//	and let the cpu carry on. The game sees the task finish a fixed number
+//	of cycles later, or as soon as it reads SP_STATUS, whichever comes
+//	first. Either way the cpu waits for the audio thread first, so the game
+//	never sees a task as done before its output is in RDRAM.
+//
+//	The cpu also waits before it starts another RSP task, before save states
+//	and when it stops running.
+//
+bool			AudioTask_Open();
+void			AudioTask_Close();
+
+// Called from the audio plugin's ProcessAList. Returns PR_COMPLETED if the task ran synchronously
+EProcessResult	AudioTask_Start();
+
+// Waits for any task on the audio thread, then signals that it's done. Cpu thread only
+void			AudioTask_Finish();
+
+// Called when the task's CPU_EVENT_AUDIOTASK fires
+void			AudioTask_OnFinishEvent();
+
+#endif // CORE_AUDIOTASK_H_
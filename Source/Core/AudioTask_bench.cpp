@@ -0,0 +1,433 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Stress test for the audio thread. Runs a stream of random ABI1 alists
+//	through RSP_HLE_ProcessTask as a game would, once with APM_ENABLED_SYNC
+//	and once with APM_ENABLED_ASYNC, and checks the game saw the same output
+//	from every task. Returns 1 if anything differs.
+//
+//	Each task's header is DMAed into DMEM and its alist written to the same
+//	RDRAM as the last one's, and its output goes to one of two buffers which
+//	the "game" reads back and clears once the task is done. So if the cpu
+//	ever got ahead of the audio thread, the thread would run a half written
+//	alist or the game would read half written output. The alists keep
+//	state in RDRAM and in the HLE state from task to task, as the real ones
+//	do, so tasks finishing out of order would show up too.
+//
+//	Between tasks the game does a random amount of work, then waits for the
+//	task by polling SP_STATUS, by running to its finish event, or not at all
+//	(the next SP DMA has to wait instead).
+//
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "Config/ConfigOptions.h"
+#include "Core/AudioTask.h"
+#include "Core/CPU.h"
+#include "Core/Memory.h"
+#include "HLEAudio/AudioHLEProcessor.h"
+#include "HLEAudio/audiohle.h"
+#include "OSHLE/ultra_mbi.h"
+#include "OSHLE/ultra_rcp.h"
+#include "OSHLE/ultra_sptask.h"
+#include "Plugins/AudioPlugin.h"
+#include "System/Paths.h"
+#include "System/System.h"
+#include "Utility/CRC.h"
+#include "Utility/IO.h"
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kDefaultTasks = 20000;
+
+	// RDRAM layout
+	const u32	kUcodeData = 0x001000;
+	const u32	kAList = 0x002000;
+	const u32	kTaskHeader = 0x003000;
+	const u32	kSamples = 0x010000;
+	const u32	kSamplesSize = 0x020000;
+	const u32	kADPCMBook = 0x030000;
+	const u32	kStateSlots = 0x040000;
+	const u32	kNumStateSlots = 16;
+	const u32	kOutput = 0x050000;
+	const u32	kOutputSize = 0x400;			// Per task, two tasks' worth
+
+	const u32	kSPBase = 0xA4040000;
+	const u32	kTaskDone = SP_STATUS_TASKDONE|SP_STATUS_BROKE|SP_STATUS_HALT;
+	const u32	kMaxAListSize = 0x400;
+
+	enum EFence
+	{
+		FENCE_STATUS,			// Poll SP_STATUS until the task is done
+		FENCE_EVENT,			// Run up to the task's finish event
+		FENCE_NONE,				// Leave it to the next SP DMA
+		NUM_FENCES
+	};
+
+	struct SRand
+	{
+		explicit SRand( u32 seed ) : State( seed ) {}
+
+		u32		Next()
+		{
+			State = State * 1664525 + 1013904223;
+			return State >> 8;
+		}
+
+		u32		Below( u32 n )		{ return Next() % n; }
+
+		u32		State;
+	};
+
+	//
+	//	Writes random alists
+	//
+	class CAListWriter
+	{
+	public:
+		explicit CAListWriter( u32 seed ) : mRand( seed ) {}
+
+		// Returns the size in bytes
+		u32		Write( u32 * commands, u32 output )
+		{
+			mCommands = commands;
+			mNumCommands = 0;
+
+			if( mRand.Below( 4 ) == 0 )
+			{
+				Command( 0x0B, 0x80, kADPCMBook );							// LOADADPCM
+			}
+			Command( 0x0F, 0, StateSlot() );								// SETLOOP
+
+			const u32	num_ops( 4 + mRand.Below( 12 ) );
+			for( u32 i = 0; i < num_ops; ++i )
+			{
+				RandomOp();
+			}
+
+			const u32	num_saves( 1 + mRand.Below( 4 ) );
+			for( u32 i = 0; i < num_saves; ++i )
+			{
+				SetBuffer( 0, DmemAddr(), DmemAddr(), 0x10 + mRand.Below( 0xF ) * 0x10 );
+				Command( 0x06, 0, output + i * 0x100 );						// SAVEBUFF
+			}
+
+			return mNumCommands * 8;
+		}
+
+	private:
+		void	Command( u32 op, u32 cmd0, u32 cmd1 )
+		{
+			mCommands[ mNumCommands * 2 + 0 ] = ( op << 24 ) | cmd0;
+			mCommands[ mNumCommands * 2 + 1 ] = cmd1;
+			mNumCommands++;
+		}
+
+		// Resample reads a sample before InBuffer, so keep clear of 0
+		u32		DmemAddr()		{ return 0x10 + mRand.Below( 0xC0 ) * 0x10; }
+		u32		Count()			{ return 0x10 + mRand.Below( 0x17 ) * 0x10; }
+		u32		StateSlot()		{ return kStateSlots + mRand.Below( kNumStateSlots ) * 0x40; }
+
+		void	SetBuffer( u32 flags, u32 in, u32 out, u32 count )
+		{
+			Command( 0x08, ( flags << 16 ) | in, ( out << 16 ) | count );
+		}
+
+		void	RandomOp()
+		{
+			switch( mRand.Below( 11 ) )
+			{
+			case 0:
+				SetBuffer( 0, DmemAddr(), DmemAddr(), Count() );
+				Command( 0x04, 0, kSamples + mRand.Below( kSamplesSize - 0x200 ) );			// LOADBUFF
+				break;
+			case 1:
+				Command( 0x02, DmemAddr(), Count() );									// CLEARBUFF
+				break;
+			case 2:
+				SetBuffer( 0x8, DmemAddr(), DmemAddr(), DmemAddr() );					// Aux buffers
+				break;
+			case 3:
+				{
+					static const u32	kFlags[] = { A_AUX, A_VOL|A_LEFT, A_VOL, A_LEFT, 0 };
+					const u32	flags( kFlags[ mRand.Below( 5 ) ] );
+					Command( 0x09, ( flags << 16 ) | ( mRand.Next() & 0xFFFF ), ( flags & (A_AUX|A_VOL) ) ? ( mRand.Next() & 0xFFFF ) : mRand.Next() & 0x1FFFF );	// SETVOL
+				}
+				break;
+			case 4:
+				SetBuffer( 0, DmemAddr(), DmemAddr(), Count() );
+				Command( 0x03, ( ( mRand.Below( 2 ) ? A_INIT : 0 ) | ( mRand.Below( 2 ) ? A_AUX : 0 ) ) << 16, StateSlot() );	// ENVMIXER
+				break;
+			case 5:
+				SetBuffer( 0, DmemAddr(), DmemAddr(), Count() );
+				Command( 0x05, ( ( mRand.Below( 2 ) ? A_INIT : 0 ) << 16 ) | ( mRand.Next() & 0xFFFF ), StateSlot() );		// RESAMPLE
+				break;
+			case 6:
+				SetBuffer( 0, DmemAddr(), DmemAddr(), Count() );
+				Command( 0x0C, mRand.Next() & 0xFFFF, ( DmemAddr() << 16 ) | DmemAddr() );	// MIXER
+				break;
+			case 7:
+				SetBuffer( 0, DmemAddr(), DmemAddr(), Count() );
+				Command( 0x0D, 0, ( DmemAddr() << 16 ) | DmemAddr() );					// INTERLEAVE
+				break;
+			case 8:
+				// memcpy()s, so keep the source and destination apart
+				Command( 0x0A, DmemAddr() & 0x3FF, ( ( DmemAddr() | 0x800 ) << 16 ) | Count() );	// DMEMMOVE
+				break;
+			case 9:
+				SetBuffer( 0, DmemAddr(), DmemAddr(), Count() );
+				Command( 0x01, mRand.Below( 4 ) << 16, StateSlot() );					// ADPCM (A_INIT/A_LOOP)
+				break;
+			default:
+				Command( 0x0F, 0, StateSlot() );										// SETLOOP
+				break;
+			}
+		}
+
+	private:
+		SRand		mRand;
+		u32 *		mCommands;
+		u32			mNumCommands;
+	};
+
+	void	FillRandom( u32 address, u32 size, u32 seed )
+	{
+		SRand	rand( seed );
+		for( u32 i = 0; i < size; i += 4 )
+		{
+			*(u32 *)( g_pu8RamBase + address + i ) = rand.Next() ^ ( rand.Next() << 24 );
+		}
+	}
+
+	void	InitRDRAM()
+	{
+		memset( g_pu8RamBase, 0, kOutput + 2 * kOutputSize );
+
+		// Markers Audio_Ucode looks for to pick ABI1
+		*(u32 *)( g_pu8RamBase + kUcodeData + 0x00 ) = 0x00000001;
+		*(u32 *)( g_pu8RamBase + kUcodeData + 0x30 ) = 0xF0000F00;
+
+		FillRandom( kSamples, kSamplesSize, 0x2468ace0 );
+		FillRandom( kADPCMBook, 0x100, 0x0f1e2d3c );
+	}
+
+	void	WriteTaskHeader( u32 alist_size )
+	{
+		OSTask *	task( (OSTask *)( g_pu8RamBase + kTaskHeader ) );
+		memset( task, 0, sizeof( OSTask ) );
+		task->t.type = M_AUDTASK;
+		task->t.ucode_data = kUcodeData;
+		task->t.ucode_data_size = 0x40;
+		task->t.data_ptr = kAList;
+		task->t.data_size = alist_size;
+	}
+
+	// As osSpTaskLoad would
+	void	LoadTask()
+	{
+		Write32Bits( kSPBase + 0x00, 0x04000FC0 );			// SP_MEM_ADDR_REG
+		Write32Bits( kSPBase + 0x04, kTaskHeader );			// SP_DRAM_ADDR_REG
+		Write32Bits( kSPBase + 0x08, sizeof( OSTask ) - 1 );	// SP_RD_LEN_REG, which does the DMA
+	}
+
+	// As osSpTaskStartGo would
+	void	StartTask()
+	{
+		Write32Bits( kSPBase + 0x10, SP_CLR_HALT|SP_CLR_BROKE|SP_CLR_SIG2 );
+	}
+
+	bool	WaitForTask( EFence fence )
+	{
+		switch( fence )
+		{
+		case FENCE_STATUS:
+			while( ( Read32Bits( kSPBase + 0x10 ) & kTaskDone ) != kTaskDone )
+			{
+			}
+			break;
+
+		case FENCE_EVENT:
+			while( ( Memory_SP_GetRegister( SP_STATUS_REG ) & kTaskDone ) != kTaskDone )
+			{
+				if( gCPUState.Events[ 0 ].mEventType != CPU_EVENT_AUDIOTASK )
+				{
+					printf( "Task isn't done, and there's no event to finish it\n" );
+					return false;
+				}
+				CPU_SkipToNextEvent();
+				gCPUState.Events[ 0 ].mCount = 0;
+				CPU_HANDLE_COUNT_INTERRUPT();
+			}
+			break;
+
+		default:
+			break;
+		}
+		return true;
+	}
+
+	struct SRun
+	{
+		std::vector< u32 >	TaskHashes;
+		u32					StateHash;
+		u64					Ticks;
+	};
+
+	bool	Run( EAudioPluginMode mode, u32 num_tasks, const AudioHLEState & initial_state, SRun & run )
+	{
+		InitRDRAM();
+		Audio_Reset();
+		memcpy( &gAudioHLEState, &initial_state, sizeof( AudioHLEState ) );
+		Memory_SP_SetRegister( SP_STATUS_REG, SP_STATUS_HALT );
+		gAudioPluginEnabled = mode;
+
+		CAListWriter	writer( 0x600df00d );
+		SRand			game( 0xfeedbeef );
+		volatile u32	work( 0 );
+		u32				alist[ kMaxAListSize / 4 ];
+
+		run.TaskHashes.resize( num_tasks );
+
+		u64		start( 0 ), end( 0 );
+		NTiming::GetPreciseTime( &start );
+
+		for( u32 t = 0; t <= num_tasks; ++t )
+		{
+			const EFence	fence( EFence( game.Below( NUM_FENCES ) ) );
+
+			const u32		alist_size( t < num_tasks ? writer.Write( alist, kOutput + ( t & 1 ) * kOutputSize ) : 0 );
+
+			if( t > 0 && !WaitForTask( fence ) )
+				return false;
+
+			WriteTaskHeader( alist_size );
+			LoadTask();
+
+			// The last task's done now, so the game can use its output and reuse its alist
+			if( t > 0 )
+			{
+				const u32	status( Memory_SP_GetRegister( SP_STATUS_REG ) );
+				if( ( status & kTaskDone ) != kTaskDone )
+				{
+					printf( "Task %u isn't done: SP_STATUS is %08x\n", t - 1, status );
+					return false;
+				}
+
+				u8 *	output( g_pu8RamBase + kOutput + ( ( t - 1 ) & 1 ) * kOutputSize );
+				run.TaskHashes[ t - 1 ] = daedalus_crc32( 0, output, kOutputSize );
+				memset( output, 0, kOutputSize );
+			}
+
+			memcpy( g_pu8RamBase + kAList, alist, alist_size );
+			StartTask();
+
+			// The rest of the frame
+			for( u32 i = game.Below( 20000 ); i != 0; --i )
+			{
+				work = work + i;
+			}
+		}
+
+		AudioTask_Finish();
+
+		NTiming::GetPreciseTime( &end );
+		run.Ticks = end - start;
+		run.StateHash = daedalus_crc32( 0, g_pu8RamBase + kStateSlots, kNumStateSlots * 0x40 );
+		return true;
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	const u32		num_tasks( argc > 1 ? strtoul( argv[ 1 ], NULL, 10 ) : kDefaultTasks );
+
+	IO::Filename	exe_path;
+	realpath( argv[ 0 ], exe_path );
+	strcpy( gDaedalusExePath, exe_path );
+	IO::Path::RemoveFileSpec( gDaedalusExePath );
+
+	if( !System_Init() || !Memory_Reset() )
+		return 1;
+
+	// A VBL which never comes, so the only event run is the audio task's
+	gCPUState.Events[ 0 ].mCount = 0x7fffffff;
+	gCPUState.Events[ 0 ].mEventType = CPU_EVENT_VBL;
+	gCPUState.NumEvents = 1;
+
+	gAudioPlugin = CreateAudioPlugin();
+	if( gAudioPlugin == nullptr || !AudioTask_Open() )
+		return 1;
+
+	// Whatever the HLE state starts as, both runs start from the same
+	AudioHLEState *	initial_state( new AudioHLEState( gAudioHLEState ) );
+
+	u64		frequency( 0 );
+	NTiming::GetPreciseFrequency( &frequency );
+
+	SRun	sync_run, async_run;
+	if( !Run( APM_ENABLED_SYNC, num_tasks, *initial_state, sync_run ) ||
+		!Run( APM_ENABLED_ASYNC, num_tasks, *initial_state, async_run ) )
+	{
+		return 1;
+	}
+
+	u32		num_mismatches( 0 );
+	for( u32 t = 0; t < num_tasks; ++t )
+	{
+		if( sync_run.TaskHashes[ t ] != async_run.TaskHashes[ t ] )
+		{
+			if( num_mismatches < 10 )
+			{
+				printf( "Task %u: output %08x, expected %08x\n", t, async_run.TaskHashes[ t ], sync_run.TaskHashes[ t ] );
+			}
+			num_mismatches++;
+		}
+	}
+	if( sync_run.StateHash != async_run.StateHash )
+	{
+		printf( "State: %08x, expected %08x\n", async_run.StateHash, sync_run.StateHash );
+		num_mismatches++;
+	}
+
+	printf( "%u tasks\n", num_tasks );
+	printf( "  sync:  %8.2f ms\n", f64( sync_run.Ticks ) * 1000.0 / f64( frequency ) );
+	printf( "  async: %8.2f ms\n", f64( async_run.Ticks ) * 1000.0 / f64( frequency ) );
+
+	AudioTask_Close();
+	delete initial_state;
+	delete gAudioPlugin;
+	gAudioPlugin = nullptr;
+
+	if( num_mismatches > 0 )
+	{
+		printf( "FAILED: %u mismatches\n", num_mismatches );
+		return 1;
+	}
+
+	printf( "OK\n" );
+	return 0;
+}
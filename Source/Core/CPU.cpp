@@ -26,9 +26,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <string>
 #include <vector>
 
+#include "AudioTask.h"
 #include "Cheats.h"
 #include "Dynamo.h"
+#include "GraphicsTask.h"
 #include "Interpret.h"
+#include "InterpretCache.h"
 #include "Interrupt.h"
 #include "Memory.h"
 #include "R4300.h"
@@ -71,8 +74,6 @@ u64					gTotalInstructionsEmulated {};
 std::vector< DBG_BreakPoint > g_BreakPoints;
 #endif
 
-volatile u32 eventQueueLocked {};
-
 static bool			gCPURunning      {false};			// CPU is actively running
 u8 *				gLastAddress       {nullptr};
 std::string			gSaveStateFilename {""};
@@ -132,8 +133,6 @@ void CPU_UnregisterVblCallback(VblCallbackFn fn, void * arg)
 
 void CPU_SkipToNextEvent()
 {
-	LOCK_EVENT_QUEUE();
-
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( gCPUState.NumEvents > 0, "There are no events" );
 	#endif
@@ -146,13 +145,10 @@ static void CPU_ResetEventList()
 	gCPUState.Events[ 0 ].mCount     = kInitialVIInterruptCycles;
 	gCPUState.Events[ 0 ].mEventType = CPU_EVENT_VBL;
 	gCPUState.NumEvents = 1;
-
-	RESET_EVENT_QUEUE_LOCK();
 }
 
 void CPU_AddEvent( s32 count, ECPUEventType event_type )
 {
-	LOCK_EVENT_QUEUE();
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( count > 0, "Count is invalid" );
 	DAEDALUS_ASSERT( gCPUState.NumEvents < MAX_CPU_EVENTS, "Too many events" );
@@ -193,31 +189,27 @@ void CPU_AddEvent( s32 count, ECPUEventType event_type )
 
 static void CPU_SetCompareEvent( s32 count )
 {
-	{
-		LOCK_EVENT_QUEUE();
-
 #ifdef DAEDALUS_ENABLE_ASSERTS
-		DAEDALUS_ASSERT( count > 0, "Count is invalid" );
+	DAEDALUS_ASSERT( count > 0, "Count is invalid" );
 #endif
-		//
-		//	Remove any existing compare events. Need to adjust any subsequent timer's count.
-		//
-		for( u32 i {}; i < gCPUState.NumEvents; ++i )
+	//
+	//	Remove any existing compare events. Need to adjust any subsequent timer's count.
+	//
+	for( u32 i {}; i < gCPUState.NumEvents; ++i )
+	{
+		if( gCPUState.Events[ i ].mEventType == CPU_EVENT_COMPARE )
 		{
-			if( gCPUState.Events[ i ].mEventType == CPU_EVENT_COMPARE )
+			//
+			//	Check for a following event, and remove
+			//
+			if( i+1 < gCPUState.NumEvents )
 			{
-				//
-				//	Check for a following event, and remove
-				//
-				if( i+1 < gCPUState.NumEvents )
-				{
-					gCPUState.Events[ i+1 ].mCount += gCPUState.Events[ i ].mCount;
-					u32 num_to_copy {gCPUState.NumEvents - (i+1)};
-					memmove( &gCPUState.Events[ i ], &gCPUState.Events[ i+1 ], num_to_copy * sizeof( CPUEvent ) );
-				}
-				gCPUState.NumEvents--;
-				break;
+				gCPUState.Events[ i+1 ].mCount += gCPUState.Events[ i ].mCount;
+				u32 num_to_copy {gCPUState.NumEvents - (i+1)};
+				memmove( &gCPUState.Events[ i ], &gCPUState.Events[ i+1 ], num_to_copy * sizeof( CPUEvent ) );
 			}
+			gCPUState.NumEvents--;
+			break;
 		}
 	}
 
@@ -226,8 +218,6 @@ static void CPU_SetCompareEvent( s32 count )
 
 static ECPUEventType CPU_PopEvent()
 {
-	LOCK_EVENT_QUEUE();
-
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( gCPUState.NumEvents > 0, "Event queue empty" );
 	DAEDALUS_ASSERT( gCPUState.Events[ 0 ].mCount <= 0, "Popping event when cycles remain" );
@@ -337,7 +327,6 @@ bool CPU_RomOpen()
 	gLastAddress = nullptr;
 	gCPURunning = false;
 	gCPUStopOnSimpleState = false;
-	RESET_EVENT_QUEUE_LOCK();
 
 	memset(&gCPUState, 0, sizeof(gCPUState));
 
@@ -386,11 +375,17 @@ bool CPU_RomOpen()
 #endif
 
 	Dynamo_Reset();
+	gInterpretCache.Reset();
 
 	CPU_SelectCore();
 	return true;
 }
 
+void CPU_RomClose()
+{
+	Dynamo_RomClose();
+}
+
 
 static bool	CPU_IsStateSimple()
 {
@@ -485,6 +480,8 @@ static void HandleSaveStateOperationOnVerticalBlank()
 		#ifdef DAEDALUS_DEBUG_CONSOLE
 		DBGConsole_Msg(0, "Saving '%s'\n", gSaveStateFilename.c_str());
 		#endif
+		GraphicsTask_Finish();
+		AudioTask_Finish();
 		SaveState_SaveToFile( gSaveStateFilename.c_str() );
 		gSaveStateOperation = SSO_NONE;
 		break;
@@ -497,9 +494,12 @@ static void HandleSaveStateOperationOnVerticalBlank()
 		// separate return code to check this case). In that case we
 		// stop the cpu and handle the load in
 		// HandleSaveStateOperationOnCPUStopRunning.
+		GraphicsTask_Finish();
+		AudioTask_Finish();
 		if (SaveState_LoadFromFile( gSaveStateFilename.c_str() ))
 		{
 			CPU_ResetFragmentCache();
+			gInterpretCache.InvalidateAll();
 			gSaveStateOperation = SSO_NONE;
 		}
 		else
@@ -551,13 +551,15 @@ bool CPU_Run()
 		#ifdef DAEDALUS_ENABLE_ASSERTS
 		DAEDALUS_ASSERT(gSaveStateOperation == SSO_NONE, "Shouldn't have a save state operation queued.");
 		#endif
-		RESET_EVENT_QUEUE_LOCK();
-
 		while (gCPURunning)
 		{
 			g_pCPUCore();
 		}
 
+		// Don't leave the render or audio thread working on a task the cpu will never see finish
+		GraphicsTask_Finish();
+		AudioTask_Finish();
+
 		if (!HandleSaveStateOperationOnCPUStopRunning())
 			break;
 	}
@@ -721,6 +723,12 @@ void CPU_HANDLE_COUNT_INTERRUPT()
 		Memory_MI_SetRegisterBits(MI_INTR_REG, MI_INTR_SP);
 		R4300_Interrupt_UpdateCause3();
 		break;
+	case CPU_EVENT_GFXTASK:
+		GraphicsTask_OnPollEvent();
+		break;
+	case CPU_EVENT_AUDIOTASK:
+		AudioTask_OnFinishEvent();
+		break;
 	default:
 		NODEFAULT;
 	}
@@ -26,7 +26,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "R4300OpCode.h"
 #include "Memory.h"
 #include "TLB.h"
-#include "Utility/SpinLock.h"
 
 //*****************************************************************************
 //
@@ -73,10 +72,12 @@ enum	ECPUEventType
 	CPU_EVENT_COMPARE,
 	CPU_EVENT_AUDIO,
 	CPU_EVENT_SPINT,
+	CPU_EVENT_GFXTASK,
+	CPU_EVENT_AUDIOTASK,
 };
 
 // In practice there should only ever be 2
-#define MAX_CPU_EVENTS 4
+#define MAX_CPU_EVENTS 6
 
 struct CPUEvent
 {
@@ -155,7 +156,7 @@ ALIGNED_EXTERN(SCPUState, gCPUState, CACHE_ALIGN);
 //
 //*****************************************************************************
 bool	CPU_RomOpen();
-//void	CPU_RomClose();
+void	CPU_RomClose();
 void	CPU_Step();
 void	CPU_Skip();
 bool	CPU_Run();
@@ -200,14 +201,6 @@ inline void CPU_TakeBranch( u32 new_pc ) { gCPUState.TargetPC = new_pc; gCPUStat
 
 extern u8 *		gLastAddress;
 
-// Take advantage of the cooperative multitasking
-// of the PSP to make locking/unlocking as fast as possible.
-//
-extern volatile u32 eventQueueLocked;
-
-#define LOCK_EVENT_QUEUE() CSpinLock _lock( &eventQueueLocked )
-#define RESET_EVENT_QUEUE_LOCK() eventQueueLocked = 0;
-
 #ifdef FRAGMENT_SIMULATE_EXECUTION
 void	CPU_ExecuteOpRaw( u32 count, u32 address, OpCode op_code, CPU_Instruction p_instruction, bool * p_branch_taken );
 #endif
@@ -247,10 +240,13 @@ extern	void (* g_pCPUCore)();
 //***********************************************
 //This function gets called *alot* //Corn
 //CPU_ProcessEventCycles
+//
+//	The event queue is only ever touched from the cpu thread (the audio
+//	plugins queue their events from ProcessAList, which runs on it too),
+//	so it doesn't need locking
 //***********************************************
 inline bool CPU_ProcessEventCycles( u32 cycles )
 {
-	LOCK_EVENT_QUEUE();
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( gCPUState.NumEvents > 0, "There are no events" );
 	#endif
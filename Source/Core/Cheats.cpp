@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "InterpretCache.h"
 #include "Memory.h"
 #include "ROM.h"
 #include "Config/ConfigOptions.h"
@@ -106,6 +107,7 @@ void CheatCodes_Apply(u32 index, u32 mode)
 			}
 
 			*(u8 *)(p_mem) = (u8)value;
+			gInterpretCache.InvalidateRange( address, 1 );
 			break;
 		case 0x81:
 		case 0xA1:
@@ -122,6 +124,7 @@ void CheatCodes_Apply(u32 index, u32 mode)
 			}
 
 			*(u16 *)(p_mem) = value;
+			gInterpretCache.InvalidateRange( address, 2 );
 			break;
 		case 0xD0:
 			skip = ( *(u8 *)(p_mem) != value );
@@ -136,10 +139,18 @@ void CheatCodes_Apply(u32 index, u32 mode)
 			skip = ( *(u16 *)(p_mem) == value );
 			break;
 		case 0x88:
-			if( mode == GS_BUTTON )*(u8 *)(p_mem) = (u8)value;
+			if( mode == GS_BUTTON )
+			{
+				*(u8 *)(p_mem) = (u8)value;
+				gInterpretCache.InvalidateRange( address, 1 );
+			}
 			break;
 		case 0x89:
-			if( mode == GS_BUTTON )	*(u16 *)(p_mem) = value;
+			if( mode == GS_BUTTON )
+			{
+				*(u16 *)(p_mem) = value;
+				gInterpretCache.InvalidateRange( address, 2 );
+			}
 			break;
 		case 0x04:
 			if( ((code->addr >> 20) & 0xF) == 0x5 )
@@ -160,12 +171,15 @@ void CheatCodes_Apply(u32 index, u32 mode)
 					value		= code->val;
 					p_mem		= g_pu8RamBase + address;
 
+					// The codes always write at least once
+					gInterpretCache.InvalidateRange( address, (count > 0 ? count : 1) * offset + 2 );
+
 					switch(type)
 					{
 					case 0x80:
 						do
 						{
-							*(u8 *)((u32)p_mem ^ U8_TWIDDLE) = (u8)value;
+							*(u8 *)((uintptr_t)p_mem ^ U8_TWIDDLE) = (u8)value;
 							p_mem += offset;
 							value += (u8)valinc;
 							count--;
@@ -174,7 +188,7 @@ void CheatCodes_Apply(u32 index, u32 mode)
 					case 0x81:
 						do
 						{
-							*(u16 *)((u32)p_mem ^ U16_TWIDDLE) = value;
+							*(u16 *)((uintptr_t)p_mem ^ U16_TWIDDLE) = value;
 							p_mem += offset;
 							value += valinc;
 							count--;
@@ -22,6 +22,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "stdafx.h"
 
 #include "DMA.h"
+#include "AudioTask.h"
+#include "GraphicsTask.h"
+#include "InterpretCache.h"
 #include "Memory.h"
 #include "RSP_HLE.h"
 #include "CPU.h"
@@ -45,6 +48,10 @@ bool gDMAUsed = false;
 //*****************************************************************************
 void DMA_SP_CopyFromRDRAM()
 {
+	GraphicsTask_SyncFramebuffer();
+	// The audio thread reads its task header from DMEM
+	AudioTask_Finish();
+
 	u32 spmem_address_reg = Memory_SP_GetRegister(SP_MEM_ADDR_REG);
 	u32 rdram_address_reg = Memory_SP_GetRegister(SP_DRAM_ADDR_REG);
 	u32 rdlen_reg         = Memory_SP_GetRegister(SP_RD_LEN_REG);
@@ -117,6 +124,7 @@ void DMA_SP_CopyToRDRAM()
 			*(uint8_t *)(((size_t)dest + j * skip + i) ^ U8_TWIDDLE) = *(uint8_t *)(((size_t)src + j * length + i) ^ U8_TWIDDLE);
 		}
 	}
+	gInterpretCache.InvalidateRange( rdram_address & ~7, (count - 1) * skip + length );
 
 	//Clear the DMA Busy
 	Memory_SP_SetRegister(SP_DMA_BUSY_REG, 0);
@@ -167,6 +175,7 @@ void DMA_SI_CopyToDRAM( )
 	{
 		p_dst[i] = BSWAP32(p_src[i]);
 	}
+	gInterpretCache.InvalidateRange( mem, 16 * sizeof( u32 ) );
 
 
 	Memory_SI_SetRegisterBits(SI_STATUS_REG, SI_STATUS_INTERRUPT);
@@ -231,7 +240,10 @@ static void OnCopiedRom()
 
 		// Azimer's DK64 hack, it makes DK64 boot!
 		if(g_ROM.GameHacks == DK64)
+		{
 			*(u32 *)(g_pu8RamBase + 0x2FE1C0) = 0xAD170014;
+			gInterpretCache.InvalidateRange( 0x2FE1C0, 4 );
+		}
 	}
 }
 
@@ -255,6 +267,7 @@ void DMA_PI_CopyToRDRAM()
 			u32			src_size( ( MemoryRegionSizes[MEM_SAVE] ) );
 			cart_address -= PI_DOM2_ADDR2;
 
+			gInterpretCache.InvalidateRange( mem_address, pi_length_reg );
 			if (g_ROM.settings.SaveType != SAVE_TYPE_FLASH)
 				DMA_HandleTransfer( g_pu8RamBase, mem_address, gRamSize, p_src, cart_address, src_size, pi_length_reg );
 			else
@@ -301,6 +314,9 @@ void DMA_PI_CopyToRDRAM()
 //*****************************************************************************
 void DMA_PI_CopyFromRDRAM()
 {
+	// e.g. Pokemon Snap copies photos from the frame buffer to flash
+	GraphicsTask_SyncFramebuffer();
+
 	u32 mem_address  {Memory_PI_GetRegister(PI_DRAM_ADDR_REG) & 0xFFFFFFFF};
 	u32 cart_address {Memory_PI_GetRegister(PI_CART_ADDR_REG)  & 0xFFFFFFFF};
 	u32 pi_length_reg {(Memory_PI_GetRegister(PI_RD_LEN_REG)  & 0xFFFFFFFF) + 1};
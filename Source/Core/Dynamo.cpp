@@ -28,14 +28,19 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Registers.h"					// For REG_?? defines
 #include "Memory.h"
 #include "Interrupt.h"
+#include "InterpretCache.h"
 #include "R4300.h"
+#include "ROM.h"
 
 #include "Config/ConfigOptions.h"
 #include "Debug/DBGConsole.h"
 #include "Debug/DebugLog.h"
+#include "DynaRec/CodeBufferManager.h"
 #include "DynaRec/DynaRecProfile.h"
 #include "DynaRec/Fragment.h"
 #include "DynaRec/FragmentCache.h"
+#include "DynaRec/HotTraceCounter.h"
+#include "DynaRec/TraceCache.h"
 #include "DynaRec/TraceRecorder.h"
 #include "OSHLE/patch.h"				// GetCorrectOp
 #include "OSHLE/ultra_R4300.h"
@@ -48,26 +53,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // These values are very sensitive to change in some games so be carefull!!! //Corn
 // War God is sensitive to gHotTraceThreshold
-// PD is sensitive to gMaxHotTraceMapSize
-//
-// Banjo Tooie needs a larger cache size
-// BUT leave PSP cache size untouched for now
-#ifdef DAEDALUS_PSP
-#define TRACE_SIZE 512
-#else
-#define TRACE_SIZE 1024
-#endif
+// The hot trace counter is fixed size and ages out stale targets itself,
+// so it never needs to flush the fragment cache
 
 static const u32					gMaxFragmentCacheSize {(8192 + 1024)}; //Maximum amount of fragments in the cache
-static const u32					gMaxHotTraceMapSize {(2048 + TRACE_SIZE)};
 static const u32					gHotTraceThreshold {10};	//How many times interpreter has to loop a trace before it becomes hot and sent to dynarec
 
-//typedef CMemoryPoolAllocator< std::pair< const u32, u32 > > MyAllocator;
-//std::map< u32, u32, std::less<u32>, MyAllocator >				gHotTraceCountMap;
-//std::map< u32, u32, std::less<u32>, boost::pool_allocator<std::pair< const u32, u32 > > >				gHotTraceCountMap;
-std::map< u32, u32 >				gHotTraceCountMap {};
+static CHotTraceCounter				gHotTraceCounter {};
 CFragmentCache						gFragmentCache {};
 static bool							gResetFragmentCache {false};
+static bool							gTraceInvalidated {false};	//Code was overwritten while a trace was being recorded
 
 #ifdef DAEDALUS_DEBUG_DYNAREC
 std::map< u32, u32 >				gAbortedTraceReasons;
@@ -78,6 +73,7 @@ void								CPU_DumpFragmentCache();
 static void							CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled );
 static void							CPU_UpdateTrace( u32 address, OpCode op_code, bool branch_delay_slot, bool branch_taken );
 static void							CPU_CreateAndAddFragment();
+static bool							CPU_CreateFragmentFromTraceCache( u32 address );
 
 
 #ifdef DAEDALUS_PROFILE_EXECUTION
@@ -93,6 +89,7 @@ u32 gFragmentLookupSuccess {};
 void R4300_CALL_TYPE CPU_InvalidateICache()
 {
 	CPU_ResetFragmentCache();
+	gInterpretCache.InvalidateAll();
 }
 
 //*****************************************************************************
@@ -105,16 +102,27 @@ void CPU_DynarecEnable()
 }
 
 //*****************************************************************************
-// If fragments overlap dynarec has to start all over which is very costly
+// Only the fragments built from the overlapped pages are thrown away. They're
+// unlinked straight away (we may be called from inside one of them, so
+// nothing can be allowed to jump to a stale fragment once we return) and freed
+// later from CPU_HandleDynaRecOnBranch
 //*****************************************************************************
 void R4300_CALL_TYPE CPU_InvalidateICacheRange( u32 address, u32 length )
 {
+	gInterpretCache.InvalidateRange( address, length );
+
 	if( gFragmentCache.ShouldInvalidateOnWrite( address, length ) )
 	{
 #ifndef DAEDALUS_SILENT
 		printf( "Write to %08x (%d bytes) overlaps fragment cache entries\n", address, length );
 #endif
-		CPU_ResetFragmentCache();
+		gFragmentCache.InvalidateRange( address, length );
+	}
+
+	// The trace may already hold some of the old code
+	if( gTraceRecorder.IsTraceActive() )
+	{
+		gTraceInvalidated = true;
 	}
 }
 
@@ -312,11 +320,15 @@ void	CPU_DumpFragmentCache()
 	{
 		std::vector< SAddressHitCount >	hit_counts;
 
-		hit_counts.reserve( gHotTraceCountMap.size() );
+		hit_counts.reserve( gHotTraceCounter.GetSize() );
 
-		for(std::map<u32,u32>::const_iterator it = gHotTraceCountMap.begin(); it != gHotTraceCountMap.end(); ++it )
+		const CHotTraceCounter::SEntry * entries( gHotTraceCounter.GetEntries() );
+		for( u32 i = 0; i < CHotTraceCounter::NUM_ENTRIES; ++i )
 		{
-			hit_counts.push_back( SAddressHitCount( it->first, it->second ) );
+			if( entries[ i ].Count != 0 )
+			{
+				hit_counts.push_back( SAddressHitCount( entries[ i ].Address, entries[ i ].Count ) );
+			}
 		}
 
 		std::sort( hit_counts.begin(), hit_counts.end(), SortByHitCount );
@@ -362,17 +374,48 @@ void	CPU_DumpFragmentCache()
 //*****************************************************************************
 void CPU_CreateAndAddFragment()
 {
+	// Only keep traces for the next boot if none of their code was overwritten while recording
+	if( !gTraceInvalidated )
+	{
+		gTraceRecorder.AddToTraceCache();
+	}
+
 	CFragment * p_fragment( gTraceRecorder.CreateFragment( gFragmentCache.GetCodeBufferManager() ) );
 
 	if( p_fragment != nullptr )
 	{
-		gHotTraceCountMap.erase( p_fragment->GetEntryAddress() );
+		gHotTraceCounter.Remove( p_fragment->GetEntryAddress() );
+
+		// Some of the traced code was overwritten while recording, so this would be stale
+		if( gTraceInvalidated )
+		{
+			gTraceInvalidated = false;
+			delete p_fragment;
+			return;
+		}
+
 		gFragmentCache.InsertFragment( p_fragment );
 
 		//DBGConsole_Msg( 0, "Inserted hot trace at [R%08x]! (size is %d. %dKB)", p_fragment->GetEntryAddress(), gFragmentCache.GetCacheSize(), gFragmentCache.GetMemoryUsage() / 1024 );
 	}
 }
 
+//*****************************************************************************
+//	Rebuilds a fragment from a trace recorded on an earlier boot, if the code
+//	in memory still matches it
+//*****************************************************************************
+bool CPU_CreateFragmentFromTraceCache( u32 address )
+{
+	if( !gTraceCache.MayContain( address ) || !gTraceRecorder.ReplayTrace( address ) )
+	{
+		return false;
+	}
+
+	gTraceInvalidated = false;
+	CPU_CreateAndAddFragment();
+	return true;
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -433,6 +476,9 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 		DAEDALUS_ASSERT( gCPUState.Delay == NO_DELAY, "Why are we entering with a delay slot active?" );
 		u32			entry_count( gCPUState.CPUControl[C0_COUNT]._u32 ); // Just used DYNAREC_PROFILE_ENTEREXIT
 #endif
+		// No fragment is running here, so anything invalidated can be freed
+		gFragmentCache.FreeStaleFragments();
+
 		u32			entry_address( gCPUState.CurrentPC );
 #ifdef DAEDALUS_DEBUG_DYNAREC
 		CFragment * p_fragment( gFragmentCache.LookupFragment( entry_address ) );
@@ -482,7 +528,7 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 #endif
 						{
 							gFragmentCache.Clear();
-							gHotTraceCountMap.clear();		// Makes sense to clear this now, to get accurate usage stats
+							gHotTraceCounter.Reset();		// Makes sense to clear this now, to get accurate usage stats
 #ifdef DAEDALUS_ENABLE_OS_HOOKS
 							Patch_PatchAll();
 #endif
@@ -496,32 +542,28 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 						gResetFragmentCache = false;
 					}
 
-					if( gFragmentCache.GetCacheSize() > gMaxFragmentCacheSize)
+					// Partial invalidation doesn't free any code bytes, so also clear before the code buffer can overflow
+					if( gFragmentCache.GetCacheSize() > gMaxFragmentCacheSize || gFragmentCache.GetCodeBufferManager()->IsNearlyFull() )
 					{
 						gFragmentCache.Clear();
-						gHotTraceCountMap.clear();		// Makes sense to clear this now, to get accurate usage stats
+						gHotTraceCounter.Reset();		// Makes sense to clear this now, to get accurate usage stats
 #ifdef DAEDALUS_ENABLE_OS_HOOKS
 						Patch_PatchAll();
 #endif
 					}
 
 					// If there is no fragment for this target, start tracing
-					u32 trace_count( ++gHotTraceCountMap[ gCPUState.CurrentPC ] );
-					if( gHotTraceCountMap.size() >= gMaxHotTraceMapSize )
+					u32 trace_count( gHotTraceCounter.Increment( gCPUState.CurrentPC ) );
+					if( trace_count == 1 && CPU_CreateFragmentFromTraceCache( gCPUState.CurrentPC ) )
 					{
-						#ifdef DAEDALUS_DEBUG_CONSOLE
-						DBGConsole_Msg( 0, "Hot trace cache hit %d, dumping", gHotTraceCountMap.size() );
-						#endif
-						gHotTraceCountMap.clear();
-						gFragmentCache.Clear();
-#ifdef DAEDALUS_ENABLE_OS_HOOKS
-						Patch_PatchAll();
-#endif
+						// Go round again to pick up the new fragment
+						continue;
 					}
 					else if( trace_count == gHotTraceThreshold )
 					{
-						//DBGConsole_Msg( 0, "Identified hot trace at [R%08x]! (size is %d)", gCPUState.CurrentPC, gHotTraceCountMap.size() );
+						//DBGConsole_Msg( 0, "Identified hot trace at [R%08x]! (size is %d)", gCPUState.CurrentPC, gHotTraceCounter.GetSize() );
 						gTraceRecorder.StartTrace( gCPUState.CurrentPC );
+						gTraceInvalidated = false;
 
 						if(!trace_already_enabled)
 						{
@@ -536,8 +578,8 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 						{
 							u32 reason( gAbortedTraceReasons[ gCPUState.CurrentPC ] );
 							//use( reason );
-							//DBGConsole_Msg( 0, "Hot trace at [R%08x] has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCountMap.size( ) );
-							DAED_LOG( DEBUG_DYNAREC_CACHE, "Hot trace at %08x has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCountMap.size( ) );
+							//DBGConsole_Msg( 0, "Hot trace at [R%08x] has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCounter.GetSize() );
+							DAED_LOG( DEBUG_DYNAREC_CACHE, "Hot trace at %08x has count of %d! (reason is %x) size %d", gCPUState.CurrentPC, trace_count, reason, gHotTraceCounter.GetSize() );
 						}
 						else
 						{
@@ -565,15 +607,22 @@ void CPU_HandleDynaRecOnBranch( bool backwards, bool trace_already_enabled )
 
 void Dynamo_Reset()
 {
-	gHotTraceCountMap.clear();
+	gHotTraceCounter.Reset();
 	gFragmentCache.Clear();
 	gResetFragmentCache = false;
+	gTraceInvalidated = false;
 	gTraceRecorder.AbortTrace();
+	gTraceCache.Load( g_ROM.mFileName, g_ROM.mRomID );
 #ifdef DAEDALUS_DEBUG_DYNAREC
 	gAbortedTraceReasons.clear();
 #endif
 }
 
+void Dynamo_RomClose()
+{
+	gTraceCache.Save();
+}
+
 void Dynamo_SelectCore()
 {
 	bool trace_enabled = gTraceRecorder.IsTraceActive();
@@ -592,6 +641,8 @@ void Dynamo_SelectCore()
 
 void CPU_ResetFragmentCache() {}
 void Dynamo_Reset() {}
-void R4300_CALL_TYPE CPU_InvalidateICacheRange( u32 address, u32 length ) {}
+void Dynamo_RomClose() {}
+void R4300_CALL_TYPE CPU_InvalidateICacheRange( u32 address, u32 length )	{ gInterpretCache.InvalidateRange( address, length ); }
+void R4300_CALL_TYPE CPU_InvalidateICache()							{ gInterpretCache.InvalidateAll(); }
 
 #endif //DAEDALUS_ENABLE_DYNAREC
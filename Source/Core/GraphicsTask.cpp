@@ -0,0 +1,274 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Core/GraphicsTask.h"
+
+#include "Core/CPU.h"
+#include "Core/Interrupt.h"
+#include "Core/Memory.h"
+#include "Core/ROM.h"
+#include "Debug/DBGConsole.h"
+#include "HLEGraphics/DLCapture.h"
+#include "Math/MathUtil.h"
+#include "OSHLE/ultra_rcp.h"
+#include "Plugins/GraphicsPlugin.h"
+#include "Test/BatchTest.h"
+#include "Utility/Profiler.h"
+#include "Utility/WorkerPool.h"
+
+#include <string.h>
+
+#include <vector>
+
+EGraphicsTaskMode	gGraphicsTaskMode = GTM_SYNC;
+u8 *				gGraphicsTaskRam = nullptr;
+
+namespace
+{
+	// How often the cpu looks to see if the render thread has finished. Each
+	// look is a mutex lock, so it's cheap, and only happens while a task is running
+	const s32		kGraphicsTaskPollCycles = 2000;
+
+	// A range of the render thread's RDRAM to copy back when the task finishes
+	struct SRamRange
+	{
+		u32			Address;
+		u32			Length;
+	};
+
+	class CDisplayListJob : public CWorkerJob
+	{
+	public:
+		virtual void	Run();
+	};
+
+	CWorkerPool *		gRenderThread = nullptr;
+	CDisplayListJob		gDisplayListJob;
+	OSTask				gTask;
+
+	bool				gTaskInFlight = false;			// Cpu thread only
+	bool				gPollEventQueued = false;		// Cpu thread only
+
+	// Owned by the render thread while a task is in flight
+	std::vector< u8 >			gRamSnapshot;
+	std::vector< SRamRange >	gRamWrites;
+
+	// Written by whichever thread is processing the task. The cpu thread
+	// only reads gRDPInterruptPending after waiting for the job
+	bool				gInTask = false;
+	bool				gRDPInterruptPending = false;
+
+	void CDisplayListJob::Run()
+	{
+		DAEDALUS_PROFILE( "GraphicsTask: Run" );
+
+		gInTask = true;
+		gGraphicsPlugin->ProcessDList();
+		gInTask = false;
+	}
+
+	// Presents the last frame before the display list runs, or after it for Chameleon Twist 2, which only
+	// works that way. Only when something is drawn, otherwise several games ex Army Men will flash or shake.
+	// This is done here rather than by the parser so the plugins' UpdateScreen always runs on the cpu thread
+	void	UpdateScreen( bool after_task )
+	{
+		if( ( g_ROM.GameHacks == CHAMELEON_TWIST_2 ) == after_task )
+		{
+			gGraphicsPlugin->UpdateScreen();
+		}
+	}
+
+	// Gives the cpu what the render thread wrote to its copy of RDRAM
+	void	CopyBackRamWrites()
+	{
+		for( u32 i = 0; i < gRamWrites.size(); ++i )
+		{
+			const SRamRange &	range( gRamWrites[ i ] );
+			if( range.Address < gRamSize )
+			{
+				u32		length( Min( range.Length, gRamSize - range.Address ) );
+				memcpy( g_pu8RamBase + range.Address, &gRamSnapshot[ range.Address ], length );
+			}
+		}
+		gRamWrites.clear();
+	}
+
+	// Raises the RDP interrupt and anything else the task held back. The caller sets the SP status
+	void	CompleteTask()
+	{
+		UpdateScreen( true );
+
+		if( gRDPInterruptPending )
+		{
+			gRDPInterruptPending = false;
+			Memory_MI_SetRegisterBits( MI_INTR_REG, MI_INTR_DP );
+			R4300_Interrupt_UpdateCause3();
+		}
+
+#ifdef DAEDALUS_BATCH_TEST_ENABLED
+		if (CBatchTestEventHandler * handler = BatchTest_GetHandler())
+		{
+			handler->OnDisplayListComplete();
+		}
+#endif
+	}
+}
+
+bool GraphicsTask_Open()
+{
+	DAEDALUS_ASSERT( gRenderThread == nullptr, "Render thread is already running" );
+
+	gTaskInFlight = false;
+	gPollEventQueued = false;
+	gRDPInterruptPending = false;
+	gGraphicsTaskRam = nullptr;
+
+	if( gGraphicsTaskMode != GTM_SYNC )
+	{
+		gRenderThread = new CWorkerPool( "Render", 1 );
+		if( gRenderThread->GetNumThreads() > 0 )
+		{
+			gRamSnapshot.resize( MAX_RAM_ADDRESS );
+		}
+	}
+	return true;
+}
+
+void GraphicsTask_Close()
+{
+	if( gRenderThread != nullptr )
+	{
+		// The game is going away, so there's nobody to tell
+		gRenderThread->Wait( &gDisplayListJob );
+		delete gRenderThread;
+		gRenderThread = nullptr;
+	}
+	gTaskInFlight = false;
+	gGraphicsTaskRam = nullptr;
+	gRamWrites.clear();
+	std::vector< u8 >().swap( gRamSnapshot );
+}
+
+EProcessResult GraphicsTask_Start()
+{
+	DAEDALUS_ASSERT( !gTaskInFlight, "The last graphics task hasn't finished" );
+
+	// The game can rewrite DMEM as soon as the task is running, so keep a copy for the parser
+	memcpy( &gTask, g_pu8SpMemBase + 0x0FC0, sizeof( gTask ) );
+
+	UpdateScreen( false );
+
+	// A capture has to see RDRAM as the game left it when the task started, so it's taken synchronously
+	if( gRenderThread == nullptr || gRenderThread->GetNumThreads() == 0 || DLCapture_IsRequested() )
+	{
+		gDisplayListJob.Run();
+		CompleteTask();
+		return PR_COMPLETED;
+	}
+
+	// Everything the display list refers to (the list itself, segments, matrices, vertices,
+	// textures) is somewhere in RDRAM, and the ucodes read it from too many places to track
+	{
+		DAEDALUS_PROFILE( "GraphicsTask: Snapshot" );
+		memcpy( &gRamSnapshot[0], g_pu8RamBase, gRamSize );
+	}
+	gGraphicsTaskRam = &gRamSnapshot[0];
+
+	gRenderThread->Submit( &gDisplayListJob );
+	gTaskInFlight = true;
+
+	// If the last task finished early its event is still queued, and can poll for this one too
+	if( !gPollEventQueued )
+	{
+		CPU_AddEvent( kGraphicsTaskPollCycles, CPU_EVENT_GFXTASK );
+		gPollEventQueued = true;
+	}
+	return PR_STARTED;
+}
+
+void GraphicsTask_Finish()
+{
+	if( !gTaskInFlight )
+		return;
+
+	DAEDALUS_PROFILE( "GraphicsTask: Wait" );
+
+	gRenderThread->Wait( &gDisplayListJob );
+	gTaskInFlight = false;
+	gGraphicsTaskRam = nullptr;
+	CopyBackRamWrites();
+	CompleteTask();
+	RSP_HLE_Finished( SP_STATUS_TASKDONE|SP_STATUS_BROKE|SP_STATUS_HALT );
+}
+
+void GraphicsTask_OnPollEvent()
+{
+	gPollEventQueued = false;
+	if( !gTaskInFlight )
+		return;
+
+	if( gRenderThread->GetState( &gDisplayListJob ) == WJS_IDLE )
+	{
+		GraphicsTask_Finish();
+	}
+	else
+	{
+		CPU_AddEvent( kGraphicsTaskPollCycles, CPU_EVENT_GFXTASK );
+		gPollEventQueued = true;
+	}
+}
+
+void GraphicsTask_SyncFramebuffer()
+{
+	if( gGraphicsTaskMode == GTM_ASYNC_FB_SYNC )
+	{
+		GraphicsTask_Finish();
+	}
+}
+
+const OSTask & GraphicsTask_GetTask()
+{
+	return gTask;
+}
+
+bool GraphicsTask_DeferRDPInterrupt()
+{
+	if( !gInTask )
+		return false;
+
+	gRDPInterruptPending = true;
+	return true;
+}
+
+void GraphicsTask_RamWritten( u32 address, u32 length )
+{
+	if( gGraphicsTaskRam == nullptr || length == 0 )
+		return;
+
+	// Writes usually run on from the last one, a row at a time
+	if( !gRamWrites.empty() && gRamWrites.back().Address + gRamWrites.back().Length == address )
+	{
+		gRamWrites.back().Length += length;
+		return;
+	}
+
+	SRamRange	range = { address, length };
+	gRamWrites.push_back( range );
+}
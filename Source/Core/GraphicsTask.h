@@ -0,0 +1,88 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef CORE_GRAPHICSTASK_H_
+#define CORE_GRAPHICSTASK_H_
+
+#include "Core/Memory.h"
+#include "Core/RSP_HLE.h"
+#include "OSHLE/ultra_sptask.h"
+
+//
+//	Graphics tasks can run on a render thread, in parallel with the cpu, like
+//	the real RSP and RDP. RDRAM is copied when the task starts and the render
+//	thread only reads the copy, so the game can rewrite its display lists,
+//	matrices, vertices and textures as soon as the task is running. What the
+//	task writes to RDRAM (depth buffer clears, S2DEX copies to the colour
+//	image) goes to the copy too, and is copied back when the task finishes.
+//	The cpu thread is the only one which touches RDRAM itself.
+//
+//	The cpu checks every couple of thousand cycles whether the render thread
+//	has finished, and raises the task's interrupts as soon as it has. It waits for
+//	the render thread before it starts another RSP task, before the VI origin
+//	changes (the plugins present the frame then), before save states and when
+//	it stops running, and the interrupts are raised then too. The plugins'
+//	UpdateScreen is only ever called from the cpu thread, and a task being
+//	captured with DLCapture always runs on it.
+//
+enum EGraphicsTaskMode
+{
+	GTM_SYNC,				// Display lists are processed as soon as the task starts
+	GTM_ASYNC,				// On the render thread
+	GTM_ASYNC_FB_SYNC,		// On the render thread, but the cpu waits for it before any DMA reads RDRAM.
+							// Slower, but games which copy a frame out with PI or SP DMA see the task's writes
+};
+
+extern EGraphicsTaskMode	gGraphicsTaskMode;		// Set by the platform before a rom is opened
+
+// The render thread's copy of RDRAM while a task runs there, otherwise nullptr
+extern u8 *					gGraphicsTaskRam;
+
+// Display list processing reads and writes RDRAM through these
+#define g_pu8GfxRamBase		(gGraphicsTaskRam != nullptr ? gGraphicsTaskRam : g_pu8RamBase)
+#define g_ps8GfxRamBase		((s8*)g_pu8GfxRamBase)
+
+bool			GraphicsTask_Open();
+void			GraphicsTask_Close();
+
+// Called from RSP_HLE_ProcessTask for display list tasks
+EProcessResult	GraphicsTask_Start();
+
+// Waits for any task on the render thread, then signals that it's done. Cpu thread only
+void			GraphicsTask_Finish();
+
+// Called when CPU_EVENT_GFXTASK fires, to see if the render thread has finished
+void			GraphicsTask_OnPollEvent();
+
+// As GraphicsTask_Finish, in GTM_ASYNC_FB_SYNC mode only
+void			GraphicsTask_SyncFramebuffer();
+
+// The task being processed, copied out of DMEM when it started
+const OSTask &	GraphicsTask_GetTask();
+
+// Returns true if the RDP interrupt should be left for GraphicsTask_Finish to raise, i.e. inside a task
+bool			GraphicsTask_DeferRDPInterrupt();
+
+// Display list processing calls this after writing to g_pu8GfxRamBase, so the
+// bytes are copied back to RDRAM when the task finishes
+void			GraphicsTask_RamWritten( u32 address, u32 length );
+
+#endif // CORE_GRAPHICSTASK_H_
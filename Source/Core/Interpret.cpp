@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ROMBuffer.h"
 #include "R4300.h"
 #include "Interpret.h"
+#include "InterpretCache.h"
 
 #include "Config/ConfigOptions.h"
 #include "Debug/DBGConsole.h"
@@ -37,6 +38,69 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Utility/Profiler.h"
 #include "Utility/Synchroniser.h"
 
+//*****************************************************************************
+//	Move on to the next op, taking any branch whose delay slot just executed
+//*****************************************************************************
+DAEDALUS_FORCEINLINE void CPU_ADVANCE_PC()
+{
+	switch (gCPUState.Delay)
+	{
+	case DO_DELAY:
+		// We've got a delayed instruction to execute. Increment
+		// PC as normal, so that subsequent instruction is executed
+		INCREMENT_PC();
+		gCPUState.Delay = EXEC_DELAY;
+
+		break;
+	case EXEC_DELAY:
+		{
+			//bool	backwards( gCPUState.TargetPC <= gCPUState.CurrentPC );
+
+			// We've just executed the delayed instr. Now carry out jump as stored in gCPUState.TargetPC;
+			CPU_SetPC(gCPUState.TargetPC);
+			gCPUState.Delay = NO_DELAY;
+
+		}
+		break;
+	case NO_DELAY:
+		// Normal operation - just increment the PC
+		INCREMENT_PC();
+		break;
+	default:
+		NODEFAULT;
+	}
+}
+
+//*****************************************************************************
+//	Execute a single MIPS op that has already been fetched and decoded
+//*****************************************************************************
+DAEDALUS_FORCEINLINE void CPU_EXECUTE_HANDLER( CPU_Instruction handler, OpCode op_code )
+{
+	SYNCH_POINT( DAED_SYNC_REG_PC, gCPUState.CurrentPC, "Program Counter doesn't match" );
+	SYNCH_POINT( DAED_SYNC_FRAGMENT_PC, gCPUState.CurrentPC + gCPUState.Delay, "Program Counter/Delay doesn't match while interpreting" );
+
+	SYNCH_POINT( DAED_SYNC_REG_PC, gCPUState.CPUControl[C0_COUNT]._u32, "Count doesn't match" );
+
+	handler( op_code._u32 );
+	gGPR[0]._u64 = 0;	//Ensure r0 is zero
+
+#ifdef DAEDALUS_PROFILE_EXECUTION
+		gTotalInstructionsEmulated++;
+#endif
+
+	SYNCH_POINT( DAED_SYNC_REGS, CPU_ProduceRegisterHash(), "Registers don't match" );
+
+	// Increment count register
+	gCPUState.CPUControl[C0_COUNT]._u32 = gCPUState.CPUControl[C0_COUNT]._u32 + COUNTER_INCREMENT_PER_OP;
+
+	if (CPU_ProcessEventCycles( COUNTER_INCREMENT_PER_OP ) )
+	{
+		CPU_HANDLE_COUNT_INTERRUPT();
+	}
+
+	CPU_ADVANCE_PC();
+}
+
 //*****************************************************************************
 //	Execute a single MIPS op. The conditionals for the templated arguments
 //	are completely optimised away by the compiler.
@@ -79,56 +143,62 @@ template< bool TranslateOp > DAEDALUS_FORCEINLINE void CPU_EXECUTE_OP()
 	}
 #endif
 
-	SYNCH_POINT( DAED_SYNC_REG_PC, gCPUState.CurrentPC, "Program Counter doesn't match" );
-	SYNCH_POINT( DAED_SYNC_FRAGMENT_PC, gCPUState.CurrentPC + gCPUState.Delay, "Program Counter/Delay doesn't match while interpreting" );
-
-	SYNCH_POINT( DAED_SYNC_REG_PC, gCPUState.CPUControl[C0_COUNT]._u32, "Count doesn't match" );
+	CPU_EXECUTE_HANDLER( R4300Instruction[ op_code.op ], op_code );
+}
 
-	R4300_ExecuteInstruction(op_code);
-	gGPR[0]._u64 = 0;	//Ensure r0 is zero
+//*****************************************************************************
+//	As CPU_EXECUTE_OP, but for an op taken from gInterpretCache,
+//	which saves the memory lookup and the jump table dispatch
+//*****************************************************************************
+DAEDALUS_FORCEINLINE void CPU_EXECUTE_PREDECODED_OP( const CInterpretCache::SOp * p_op )
+{
+	if( p_op == nullptr )
+	{
+		CPU_EXECUTE_OP< false >();
+		return;
+	}
 
-#ifdef DAEDALUS_PROFILE_EXECUTION
-		gTotalInstructionsEmulated++;
-#endif
+	// Cache instruction base pointer (used for SpeedHack() @ R4300.0)
+	gLastAddress = g_pu8RamBase + (gCPUState.CurrentPC & 0x1FFFFFFF);
 
-	SYNCH_POINT( DAED_SYNC_REGS, CPU_ProduceRegisterHash(), "Registers don't match" );
+	OpCode	op_code;
+	op_code._u32 = p_op->OpCode;
 
-	// Increment count register
-	gCPUState.CPUControl[C0_COUNT]._u32 = gCPUState.CPUControl[C0_COUNT]._u32 + COUNTER_INCREMENT_PER_OP;
+	CPU_EXECUTE_HANDLER( p_op->Handler, op_code );
+}
 
-	if (CPU_ProcessEventCycles( COUNTER_INCREMENT_PER_OP ) )
-	{
-		CPU_HANDLE_COUNT_INTERRUPT();
-	}
+//*****************************************************************************
+//	Runs simple ops (see R4300_IsSimpleOp) from gInterpretCache until it reaches
+//	one that isn't simple or max_ops have run, and returns the op it stopped at.
+//	These ops can't look at Count or the event queue, so they skip the per-op
+//	event check - the caller brings both up to date afterwards.
+//*****************************************************************************
+DAEDALUS_FORCEINLINE const CInterpretCache::SOp * CPU_EXECUTE_SIMPLE_OPS( s32 max_ops, s32 * p_ops_executed )
+{
+	s32		ops_executed( 0 );
+	const CInterpretCache::SOp * p_op( gInterpretCache.GetOp( gCPUState.CurrentPC ) );
 
-	switch (gCPUState.Delay)
+	while( p_op != nullptr && p_op->Simple && ops_executed < max_ops )
 	{
-	case DO_DELAY:
-		// We've got a delayed instruction to execute. Increment
-		// PC as normal, so that subsequent instruction is executed
-		INCREMENT_PC();
-		gCPUState.Delay = EXEC_DELAY;
-
-		break;
-	case EXEC_DELAY:
+		if( p_op->DecodedHandler != nullptr )
 		{
-			//bool	backwards( gCPUState.TargetPC <= gCPUState.CurrentPC );
+			p_op->DecodedHandler( p_op->Operands );
+		}
+		else
+		{
+			p_op->Handler( p_op->OpCode );
+		}
+		gGPR[0]._u64 = 0;	//Ensure r0 is zero
 
-			// We've just executed the delayed instr. Now carry out jump as stored in gCPUState.TargetPC;
-			CPU_SetPC(gCPUState.TargetPC);
-			gCPUState.Delay = NO_DELAY;
+		CPU_ADVANCE_PC();
+		ops_executed++;
 
-		}
-		break;
-	case NO_DELAY:
-		// Normal operation - just increment the PC
-		INCREMENT_PC();
-		break;
-	default:
-		NODEFAULT;
+		p_op = gInterpretCache.GetOp( gCPUState.CurrentPC );
 	}
-}
 
+	*p_ops_executed = ops_executed;
+	return p_op;
+}
 
 //*****************************************************************************
 // Keep executing instructions until there are other tasks to do (i.e. gCPUState.GetStuffToDo() is set)
@@ -156,10 +226,51 @@ void CPU_Go()
 	}
 }
 
+//*****************************************************************************
+//
+//*****************************************************************************
+void CPU_GoPredecoded()
+{
+	DAEDALUS_PROFILE( __FUNCTION__ );
+
+	while (CPU_KeepRunning())
+	{
+		u32	stuff_to_do( gCPUState.GetStuffToDo() );
+		while(stuff_to_do == 0)
+		{
+			// Run straight up to the op before the next event. That op (and anything
+			// that isn't simple) goes through the normal path, which services the event.
+			s32	ops_executed;
+			const CInterpretCache::SOp * p_op( CPU_EXECUTE_SIMPLE_OPS( gCPUState.Events[ 0 ].mCount - 1, &ops_executed ) );
+			if( ops_executed > 0 )
+			{
+				gCPUState.CPUControl[C0_COUNT]._u32 += ops_executed * COUNTER_INCREMENT_PER_OP;
+				gCPUState.Events[ 0 ].mCount -= ops_executed * COUNTER_INCREMENT_PER_OP;
+#ifdef DAEDALUS_PROFILE_EXECUTION
+				gTotalInstructionsEmulated += ops_executed;
+#endif
+			}
+
+			CPU_EXECUTE_PREDECODED_OP( p_op );
+
+			stuff_to_do = gCPUState.GetStuffToDo();
+		}
+
+		if (CPU_CheckStuffToDo())
+			break;
+	}
+}
+
 
 void Inter_SelectCore()
 {
-   g_pCPUCore = CPU_Go;
+	// Breakpoints are written straight over the code, so they need the ops fetching every time.
+	// The synchroniser also needs Count to be up to date after every op.
+#if defined(DAEDALUS_BREAKPOINTS_ENABLED) || defined(DAEDALUS_ENABLE_SYNCHRONISATION)
+	g_pCPUCore = CPU_Go;
+#else
+	g_pCPUCore = CPU_GoPredecoded;
+#endif
 }
 
 //*****************************************************************************
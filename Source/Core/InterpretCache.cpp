@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "InterpretCache.h"
+
+#include <string.h>
+
+#include "Memory.h"
+#include "R4300.h"
+
+CInterpretCache		gInterpretCache;
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CInterpretCache::CInterpretCache()
+{
+	memset( mPages, 0, sizeof( mPages ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CInterpretCache::~CInterpretCache()
+{
+	Reset();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CInterpretCache::Reset()
+{
+	for( u32 i = 0; i < NUM_PAGES; ++i )
+	{
+		delete [] mPages[ i ];
+		mPages[ i ] = nullptr;
+	}
+}
+
+//*****************************************************************************
+//	Pages are kept, so this is safe to call while an op is executing
+//*****************************************************************************
+void CInterpretCache::InvalidateAll()
+{
+	for( u32 i = 0; i < NUM_PAGES; ++i )
+	{
+		if( mPages[ i ] != nullptr )
+		{
+			memset( mPages[ i ], 0, OPS_PER_PAGE * sizeof( SOp ) );
+		}
+	}
+}
+
+//*****************************************************************************
+//	Like the fragment cache, this ignores the segment and assumes the address is
+//	in one of the rdram mirrors
+//*****************************************************************************
+void CInterpretCache::InvalidateRange( u32 address, u32 length )
+{
+	if( length == 0 )
+		return;
+
+	u32		start( (address & 0x1FFFFFFF) & ~3 );
+	u32		end( (address & 0x1FFFFFFF) + length );
+
+	if( start >= MEMORY_8_MEG )
+		return;
+	if( end > MEMORY_8_MEG )
+		end = MEMORY_8_MEG;
+
+	while( start < end )
+	{
+		u32		page_idx( start >> PAGE_SHIFT );
+		u32		page_end( (page_idx + 1) << PAGE_SHIFT );
+		u32		range_end( end < page_end ? end : page_end );
+
+		if( mPages[ page_idx ] != nullptr )
+		{
+			u32		first( (start >> 2) & (OPS_PER_PAGE - 1) );
+			u32		last( ((range_end - 1) >> 2) & (OPS_PER_PAGE - 1) );
+
+			memset( &mPages[ page_idx ][ first ], 0, (last - first + 1) * sizeof( SOp ) );
+		}
+
+		start = range_end;
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CInterpretCache::SOp * CInterpretCache::AllocatePage( u32 page_idx )
+{
+	SOp *	page( new SOp[ OPS_PER_PAGE ] );
+	memset( page, 0, OPS_PER_PAGE * sizeof( SOp ) );
+
+	mPages[ page_idx ] = page;
+	return page;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CInterpretCache::Decode( SOp * op, u32 physical )
+{
+	OpCode	op_code;
+	op_code._u32 = *(const u32 *)( g_pu8RamBase + physical );
+
+	op->Handler = R4300_GetPredecodedHandler( op_code );
+	op->DecodedHandler = R4300_GetDecodedHandler( op_code, &op->Operands );
+	op->OpCode = op_code._u32;
+	op->Simple = R4300_IsSimpleOp( op_code );
+}
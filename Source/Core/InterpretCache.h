@@ -0,0 +1,115 @@
+/*
+Copyright (C) 2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef CORE_INTERPRETCACHE_H_
+#define CORE_INTERPRETCACHE_H_
+
+#include "R4300Instruction.h"
+
+extern u32		gRamSize;
+
+//*****************************************************************************
+//	Predecoded ops for the interpreter. Every op executed from kseg0/kseg1
+//	rdram is decoded once into its final handler (skipping the special/regimm/
+//	cop0 jump tables) and kept with its opcode, indexed by physical address so
+//	the cached and uncached mirrors share entries.
+//
+//	Pages of 1024 ops are allocated the first time code in them runs, and ops
+//	are decoded the first time they're executed. Fetches never look at rdram
+//	again, so everything that writes to rdram has to clear the ops it overlaps:
+//	CPU_InvalidateICacheRange (cache ops, osInvalICache, PI DMA), the other DMA
+//	copies, cheats and the interpreter's stores (via InvalidateStore).
+//	Stores made by dynarec fragments aren't seen - as for the fragment cache,
+//	code written that way is only picked up after a cache op.
+//*****************************************************************************
+class CInterpretCache
+{
+public:
+	struct SOp
+	{
+		CPU_Instruction			Handler;		// nullptr until decoded
+		CPU_DecodedInstruction	DecodedHandler;	// nullptr unless R4300_GetDecodedHandler has one
+		SDecodedOperands		Operands;		// Only filled in for DecodedHandler
+		u32						OpCode;
+		bool					Simple;			// See R4300_IsSimpleOp
+	};
+
+	CInterpretCache();
+	~CInterpretCache();
+
+	// Returns nullptr for code outside rdram or behind the tlb - it's not worth caching
+	inline const SOp *		GetOp( u32 address )
+	{
+		if( (address >> 30) != 2 )						// Not kseg0/kseg1
+			return nullptr;
+
+		u32		physical( address & 0x1FFFFFFF );
+		if( physical >= gRamSize )
+			return nullptr;
+
+		SOp *	page( mPages[ physical >> PAGE_SHIFT ] );
+		if( page == nullptr )
+		{
+			page = AllocatePage( physical >> PAGE_SHIFT );
+		}
+
+		SOp *	op( &page[ (physical >> 2) & (OPS_PER_PAGE - 1) ] );
+		if( op->Handler == nullptr )
+		{
+			Decode( op, physical );
+		}
+		return op;
+	}
+
+	// Called for every interpreted store, so it's just a page check unless the page
+	// holds decoded ops. Stores through the tlb are skipped, like their fetches
+	inline void				InvalidateStore( u32 address, u32 length )
+	{
+		if( (address >> 30) != 2 )						// Not kseg0/kseg1
+			return;
+
+		u32		physical( address & 0x1FFFFFFF );
+		if( physical < MEMORY_8_MEG && mPages[ physical >> PAGE_SHIFT ] != nullptr )
+		{
+			InvalidateRange( address, length );
+		}
+	}
+
+	void					InvalidateRange( u32 address, u32 length );
+	void					InvalidateAll();
+	void					Reset();
+
+	static const u32		MEMORY_8_MEG = 8*1024*1024;
+	static const u32		PAGE_SHIFT = 12;		// 4k
+	static const u32		OPS_PER_PAGE = (1 << PAGE_SHIFT) / 4;
+	static const u32		NUM_PAGES = MEMORY_8_MEG >> PAGE_SHIFT;
+
+private:
+	SOp *					AllocatePage( u32 page_idx );
+	void					Decode( SOp * op, u32 physical );
+
+private:
+	SOp *					mPages[ NUM_PAGES ];
+};
+
+extern CInterpretCache		gInterpretCache;
+
+#endif // CORE_INTERPRETCACHE_H_
@@ -0,0 +1,141 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Core/JpegKernels.h"
+
+#include "Core/RDRam.h"
+
+namespace
+{
+	// One 1D pass over x[0], x[stride] .. x[7*stride], leaving the result scaled up by 1 << kJpegIDCTConstBits
+	template< typename T >
+	inline void IDCT1D( s32 (&out)[ 8 ], const T * x, u32 stride )
+	{
+		const s32	x0( x[ 0 ] ),          x1( x[ stride ] ),     x2( x[ 2 * stride ] ), x3( x[ 3 * stride ] );
+		const s32	x4( x[ 4 * stride ] ), x5( x[ 5 * stride ] ), x6( x[ 6 * stride ] ), x7( x[ 7 * stride ] );
+
+		const s32	x15(   kJpegIDCT_K3  * ( x1 + x5 ) );
+		const s32	x37(   kJpegIDCT_K4  * ( x3 + x7 ) );
+		const s32	x17(   kJpegIDCT_K9  * ( x1 + x7 ) );
+		const s32	x35(   kJpegIDCT_K10 * ( x3 + x5 ) );
+		const s32	x1357( kJpegIDCT_C3  * ( x1 + x3 + x5 + x7 ) );
+		const s32	x26(   kJpegIDCT_C6  * ( x2 + x6 ) );
+
+		const s32	f0( ( x0 + x4 ) * ( 1 << kJpegIDCTConstBits ) );
+		const s32	f1( ( x0 - x4 ) * ( 1 << kJpegIDCTConstBits ) );
+		const s32	f2( x26 + kJpegIDCT_K1 * x2 );
+		const s32	f3( x26 + kJpegIDCT_K2 * x6 );
+
+		const s32	e0( x1357 + x15 + kJpegIDCT_K5 * x1 + x17 );
+		const s32	e1( x1357 + x37 + kJpegIDCT_K7 * x3 + x35 );
+		const s32	e2( x1357 + x15 + kJpegIDCT_K6 * x5 + x35 );
+		const s32	e3( x1357 + x37 + kJpegIDCT_K8 * x7 + x17 );
+
+		out[ 0 ] = f0 + f2 + e0;
+		out[ 1 ] = f1 + f3 + e1;
+		out[ 2 ] = f1 - f3 + e2;
+		out[ 3 ] = f0 - f2 + e3;
+		out[ 4 ] = f0 - f2 - e3;
+		out[ 5 ] = f1 - f3 - e2;
+		out[ 6 ] = f1 + f3 - e1;
+		out[ 7 ] = f0 + f2 - e0;
+	}
+
+	inline u16 GetRGBA( s32 y, s32 u, s32 v )
+	{
+		const s32	yy( y + 2048 );
+		const s32	r( yy + ( ( kJpegRGBA_VR * v ) >> kJpegRGBABits ) );
+		const s32	g( yy + ( ( kJpegRGBA_UG * u + kJpegRGBA_VG * v ) >> kJpegRGBABits ) );
+		const s32	b( yy + ( ( kJpegRGBA_UB * u ) >> kJpegRGBABits ) );
+
+		return ( clamp_RGBA_component( s16( r ) ) << 4 ) |
+			   ( clamp_RGBA_component( s16( g ) ) >> 1 ) |
+			   ( clamp_RGBA_component( s16( b ) ) >> 6 ) | 1;
+	}
+}
+
+void JpegIDCTScalar( s16 * dst, const s16 * src )
+{
+	const u32	kPass1Shift( kJpegIDCTConstBits - kJpegIDCTPass1Bits );
+	const u32	kPass2Shift( kJpegIDCTConstBits + kJpegIDCTPass1Bits );
+
+	s32		workspace[ 64 ];
+	s32		out[ 8 ];
+
+	// Columns, rounding to kJpegIDCTPass1Bits of fraction. Most of them are only a DC term,
+	// and then every output is the same (and exact), as with libjpeg
+	for( u32 c = 0; c < 8; ++c )
+	{
+		const s16 *	x( src + c );
+		if( ( x[ 8 ] | x[ 16 ] | x[ 24 ] | x[ 32 ] | x[ 40 ] | x[ 48 ] | x[ 56 ] ) == 0 )
+		{
+			const s32	dc( x[ 0 ] * ( 1 << kJpegIDCTPass1Bits ) );
+			for( u32 r = 0; r < 8; ++r )
+			{
+				workspace[ r * 8 + c ] = dc;
+			}
+			continue;
+		}
+
+		IDCT1D( out, x, 8 );
+
+		for( u32 r = 0; r < 8; ++r )
+		{
+			workspace[ r * 8 + c ] = ( out[ r ] + ( 1 << ( kPass1Shift - 1 ) ) ) >> kPass1Shift;
+		}
+	}
+
+	// Rows, truncating towards zero as the float version's cast to s16 does
+	for( u32 r = 0; r < 8; ++r )
+	{
+		const s32 *	x( workspace + r * 8 );
+		if( ( x[ 1 ] | x[ 2 ] | x[ 3 ] | x[ 4 ] | x[ 5 ] | x[ 6 ] | x[ 7 ] ) == 0 )
+		{
+			for( u32 c = 0; c < 8; ++c )
+			{
+				out[ c ] = x[ 0 ] * ( 1 << kJpegIDCTConstBits );
+			}
+		}
+		else
+		{
+			IDCT1D( out, x, 1 );
+		}
+
+		for( u32 c = 0; c < 8; ++c )
+		{
+			const s32	v( out[ c ] );
+			const s32	t( ( v + ( ( v >> 31 ) & ( ( 1 << kPass2Shift ) - 1 ) ) ) >> kPass2Shift );
+			dst[ r * 8 + c ] = s16( t ) >> 3;
+		}
+	}
+}
+
+void JpegRGBALineScalar( u16 * out, const s16 * y, const s16 * u )
+{
+	const s16 * const	v( u + 64 );
+
+	for( u32 i = 0; i < 8; ++i )
+	{
+		const s16 * const	yi( i < 4 ? y + i * 2 : y + 64 + ( i - 4 ) * 2 );
+
+		out[ i * 2 ]     = GetRGBA( yi[ 0 ], u[ i ], v[ i ] );
+		out[ i * 2 + 1 ] = GetRGBA( yi[ 1 ], u[ i ], v[ i ] );
+	}
+}
@@ -0,0 +1,97 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef CORE_JPEGKERNELS_H_
+#define CORE_JPEGKERNELS_H_
+
+#include "Utility/DaedalusTypes.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DAEDALUS_SIMD_JPEG
+#endif
+
+//*****************************************************************************
+//	The inner loops of the JPEG tasks: the 8x8 inverse DCT and the conversion
+//	of a line of pixels to RGBA. Both are in fixed point. The Scalar versions
+//	are the reference; the SIMD versions give the same results with SSE2/NEON.
+//*****************************************************************************
+
+// The 8x8 inverse DCT, normalised as the ucodes' is (so the DC term is 8 times the mean)
+// and then shifted right by 3: dst[y*8+x] = s16( idct( src )[y][x] ) >> 3. It uses the
+// same factorisation as libjpeg's islow IDCT, with 13 bit constants and 2 extra bits
+// between the passes, and is within 1 of doing it in floating point. dst can be src.
+// Coefficients big enough to overflow the s16 output aren't handled.
+void	JpegIDCTScalar( s16 * dst, const s16 * src );
+
+// Converts a line of 16 pixels to RGBA 5551 for the PS ucode's tile lines: the first 8
+// from y[0..7] and the second from y[64..71], with u[i] and v[i] = u[64+i] shared by
+// pixels 2i and 2i+1. The inputs are IDCT outputs, so within -4096..4095
+void	JpegRGBALineScalar( u16 * out, const s16 * y, const s16 * u );
+
+// The IDCT's constants in 1.13 (the float version's C3, C6 and K1..K10)
+const u32	kJpegIDCTConstBits = 13;
+const u32	kJpegIDCTPass1Bits = 2;
+
+const s32	kJpegIDCT_C3  =   9633;		//  1.175875602
+const s32	kJpegIDCT_C6  =   4433;		//  0.541196100
+const s32	kJpegIDCT_K1  =   6270;		//  0.765366865
+const s32	kJpegIDCT_K2  = -15137;		// -1.847759065
+const s32	kJpegIDCT_K3  =  -3196;		// -0.390180644
+const s32	kJpegIDCT_K4  = -16069;		// -1.961570561
+const s32	kJpegIDCT_K5  =  12299;		//  1.501321110
+const s32	kJpegIDCT_K6  =  16819;		//  2.053119869
+const s32	kJpegIDCT_K7  =  25172;		//  3.072711027
+const s32	kJpegIDCT_K8  =   2446;		//  0.298631336
+const s32	kJpegIDCT_K9  =  -7373;		// -0.899976223
+const s32	kJpegIDCT_K10 = -20995;		// -2.562915448
+
+// The colour conversion's in 1.14
+const u32	kJpegRGBABits = 14;
+
+const s32	kJpegRGBA_VR =  22979;		//  1.4025
+const s32	kJpegRGBA_UG =  -5641;		// -0.3443
+const s32	kJpegRGBA_VG = -11705;		// -0.7144
+const s32	kJpegRGBA_UB =  29047;		//  1.7729
+
+#ifdef DAEDALUS_SIMD_JPEG
+void	JpegIDCTSIMD( s16 * dst, const s16 * src );
+void	JpegRGBALineSIMD( u16 * out, const s16 * y, const s16 * u );
+#endif
+
+inline void JpegIDCT( s16 * dst, const s16 * src )
+{
+#ifdef DAEDALUS_SIMD_JPEG
+	JpegIDCTSIMD( dst, src );
+#else
+	JpegIDCTScalar( dst, src );
+#endif
+}
+
+inline void JpegRGBALine( u16 * out, const s16 * y, const s16 * u )
+{
+#ifdef DAEDALUS_SIMD_JPEG
+	JpegRGBALineSIMD( out, y, u );
+#else
+	JpegRGBALineScalar( out, y, u );
+#endif
+}
+
+#endif // CORE_JPEGKERNELS_H_
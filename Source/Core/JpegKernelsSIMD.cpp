@@ -0,0 +1,325 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	SSE2/NEON versions of the JpegKernels loops.
+//
+//	The IDCT keeps the block as 8 rows of two vectors of four 32 bit lanes,
+//	so each 1D pass does four columns (or rows) at once with the same integer
+//	arithmetic as the scalar version, and the block is transposed in 4x4
+//	quarters between the passes and after the second. SSE2 has no 32 bit
+//	multiply, so it's made from two 32x32->64 ones.
+//
+//	The colour conversion works out the chroma terms for the line's eight
+//	u/v pairs in 32 bits, then duplicates them for each pair of pixels and
+//	does the rest in 16 bits, which the IDCT's output range leaves room for.
+//
+
+#include "stdafx.h"
+#include "Core/JpegKernels.h"
+
+#ifdef DAEDALUS_SIMD_JPEG
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+#if defined(__SSE2__)
+
+	typedef __m128i		V32x4;
+
+	inline V32x4	Add( V32x4 a, V32x4 b )			{ return _mm_add_epi32( a, b ); }
+	inline V32x4	Sub( V32x4 a, V32x4 b )			{ return _mm_sub_epi32( a, b ); }
+
+	inline V32x4	Mul( V32x4 a, s32 c )
+	{
+		const __m128i	k( _mm_set1_epi32( c ) );
+		const __m128i	even( _mm_mul_epu32( a, k ) );
+		const __m128i	odd( _mm_mul_epu32( _mm_srli_epi64( a, 32 ), k ) );
+		return _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ),
+								   _mm_shuffle_epi32( odd,  _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+	}
+
+	inline V32x4	ScaleUp( V32x4 a )			{ return _mm_slli_epi32( a, kJpegIDCTConstBits ); }
+
+	// ( v + half ) >> n
+	inline V32x4	Descale1( V32x4 v )
+	{
+		const u32	n( kJpegIDCTConstBits - kJpegIDCTPass1Bits );
+		return _mm_srai_epi32( _mm_add_epi32( v, _mm_set1_epi32( 1 << ( n - 1 ) ) ), n );
+	}
+
+	// s16( v / ( 1 << n ) ) >> 3, dividing towards zero
+	inline V32x4	Descale2( V32x4 v )
+	{
+		const u32	n( kJpegIDCTConstBits + kJpegIDCTPass1Bits );
+		const __m128i	bias( _mm_and_si128( _mm_srai_epi32( v, 31 ), _mm_set1_epi32( ( 1 << n ) - 1 ) ) );
+		const __m128i	t( _mm_srai_epi32( _mm_add_epi32( v, bias ), n ) );
+		return _mm_srai_epi32( _mm_slli_epi32( t, 16 ), 16 + 3 );
+	}
+
+	inline void	Load( V32x4 (&row)[ 2 ], const s16 * src )
+	{
+		const __m128i	x( _mm_loadu_si128( (const __m128i *)src ) );
+		row[ 0 ] = _mm_srai_epi32( _mm_unpacklo_epi16( x, x ), 16 );
+		row[ 1 ] = _mm_srai_epi32( _mm_unpackhi_epi16( x, x ), 16 );
+	}
+
+	// The values fit in 16 bits, so packing doesn't saturate
+	inline void	Store( s16 * dst, const V32x4 (&row)[ 2 ] )
+	{
+		_mm_storeu_si128( (__m128i *)dst, _mm_packs_epi32( row[ 0 ], row[ 1 ] ) );
+	}
+
+	inline void	Transpose( V32x4 & a, V32x4 & b, V32x4 & c, V32x4 & d )
+	{
+		const __m128i	ab_lo( _mm_unpacklo_epi32( a, b ) );
+		const __m128i	cd_lo( _mm_unpacklo_epi32( c, d ) );
+		const __m128i	ab_hi( _mm_unpackhi_epi32( a, b ) );
+		const __m128i	cd_hi( _mm_unpackhi_epi32( c, d ) );
+		a = _mm_unpacklo_epi64( ab_lo, cd_lo );
+		b = _mm_unpackhi_epi64( ab_lo, cd_lo );
+		c = _mm_unpacklo_epi64( ab_hi, cd_hi );
+		d = _mm_unpackhi_epi64( ab_hi, cd_hi );
+	}
+
+#else
+
+	typedef int32x4_t	V32x4;
+
+	inline V32x4	Add( V32x4 a, V32x4 b )			{ return vaddq_s32( a, b ); }
+	inline V32x4	Sub( V32x4 a, V32x4 b )			{ return vsubq_s32( a, b ); }
+	inline V32x4	Mul( V32x4 a, s32 c )		{ return vmulq_n_s32( a, c ); }
+	inline V32x4	ScaleUp( V32x4 a )			{ return vshlq_n_s32( a, kJpegIDCTConstBits ); }
+
+	inline V32x4	Descale1( V32x4 v )
+	{
+		return vrshrq_n_s32( v, kJpegIDCTConstBits - kJpegIDCTPass1Bits );
+	}
+
+	inline V32x4	Descale2( V32x4 v )
+	{
+		const u32	n( kJpegIDCTConstBits + kJpegIDCTPass1Bits );
+		const int32x4_t	bias( vandq_s32( vshrq_n_s32( v, 31 ), vdupq_n_s32( ( 1 << n ) - 1 ) ) );
+		const int32x4_t	t( vshrq_n_s32( vaddq_s32( v, bias ), n ) );
+		return vshrq_n_s32( vshlq_n_s32( t, 16 ), 16 + 3 );
+	}
+
+	inline void	Load( V32x4 (&row)[ 2 ], const s16 * src )
+	{
+		const int16x8_t	x( vld1q_s16( src ) );
+		row[ 0 ] = vmovl_s16( vget_low_s16( x ) );
+		row[ 1 ] = vmovl_s16( vget_high_s16( x ) );
+	}
+
+	inline void	Store( s16 * dst, const V32x4 (&row)[ 2 ] )
+	{
+		vst1q_s16( dst, vcombine_s16( vmovn_s32( row[ 0 ] ), vmovn_s32( row[ 1 ] ) ) );
+	}
+
+	inline void	Transpose( V32x4 & a, V32x4 & b, V32x4 & c, V32x4 & d )
+	{
+		const int32x4x2_t	ab( vtrnq_s32( a, b ) );
+		const int32x4x2_t	cd( vtrnq_s32( c, d ) );
+		a = vcombine_s32( vget_low_s32( ab.val[ 0 ] ),  vget_low_s32( cd.val[ 0 ] ) );
+		b = vcombine_s32( vget_low_s32( ab.val[ 1 ] ),  vget_low_s32( cd.val[ 1 ] ) );
+		c = vcombine_s32( vget_high_s32( ab.val[ 0 ] ), vget_high_s32( cd.val[ 0 ] ) );
+		d = vcombine_s32( vget_high_s32( ab.val[ 1 ] ), vget_high_s32( cd.val[ 1 ] ) );
+	}
+
+#endif
+
+	// As the scalar IDCT1D, on x[0][h] .. x[7][h]
+	inline void	IDCT1D( V32x4 (&out)[ 8 ], const V32x4 (&x)[ 8 ][ 2 ], u32 h )
+	{
+		const V32x4		x0( x[ 0 ][ h ] ), x1( x[ 1 ][ h ] ), x2( x[ 2 ][ h ] ), x3( x[ 3 ][ h ] );
+		const V32x4		x4( x[ 4 ][ h ] ), x5( x[ 5 ][ h ] ), x6( x[ 6 ][ h ] ), x7( x[ 7 ][ h ] );
+
+		const V32x4		x15(   Mul( Add( x1, x5 ), kJpegIDCT_K3 ) );
+		const V32x4		x37(   Mul( Add( x3, x7 ), kJpegIDCT_K4 ) );
+		const V32x4		x17(   Mul( Add( x1, x7 ), kJpegIDCT_K9 ) );
+		const V32x4		x35(   Mul( Add( x3, x5 ), kJpegIDCT_K10 ) );
+		const V32x4		x1357( Mul( Add( Add( x1, x3 ), Add( x5, x7 ) ), kJpegIDCT_C3 ) );
+		const V32x4		x26(   Mul( Add( x2, x6 ), kJpegIDCT_C6 ) );
+
+		const V32x4		f0( ScaleUp( Add( x0, x4 ) ) );
+		const V32x4		f1( ScaleUp( Sub( x0, x4 ) ) );
+		const V32x4		f2( Add( x26, Mul( x2, kJpegIDCT_K1 ) ) );
+		const V32x4		f3( Add( x26, Mul( x6, kJpegIDCT_K2 ) ) );
+
+		const V32x4		e0( Add( Add( x1357, x15 ), Add( Mul( x1, kJpegIDCT_K5 ), x17 ) ) );
+		const V32x4		e1( Add( Add( x1357, x37 ), Add( Mul( x3, kJpegIDCT_K7 ), x35 ) ) );
+		const V32x4		e2( Add( Add( x1357, x15 ), Add( Mul( x5, kJpegIDCT_K6 ), x35 ) ) );
+		const V32x4		e3( Add( Add( x1357, x37 ), Add( Mul( x7, kJpegIDCT_K8 ), x17 ) ) );
+
+		const V32x4		f02p( Add( f0, f2 ) ), f02m( Sub( f0, f2 ) );
+		const V32x4		f13p( Add( f1, f3 ) ), f13m( Sub( f1, f3 ) );
+
+		out[ 0 ] = Add( f02p, e0 );
+		out[ 1 ] = Add( f13p, e1 );
+		out[ 2 ] = Add( f13m, e2 );
+		out[ 3 ] = Add( f02m, e3 );
+		out[ 4 ] = Sub( f02m, e3 );
+		out[ 5 ] = Sub( f13m, e2 );
+		out[ 6 ] = Sub( f13p, e1 );
+		out[ 7 ] = Sub( f02p, e0 );
+	}
+
+	// In place, as four 4x4 transposes with the top right and bottom left swapped
+	inline void	Transpose( V32x4 (&b)[ 8 ][ 2 ] )
+	{
+		Transpose( b[ 0 ][ 0 ], b[ 1 ][ 0 ], b[ 2 ][ 0 ], b[ 3 ][ 0 ] );
+		Transpose( b[ 4 ][ 1 ], b[ 5 ][ 1 ], b[ 6 ][ 1 ], b[ 7 ][ 1 ] );
+		Transpose( b[ 0 ][ 1 ], b[ 1 ][ 1 ], b[ 2 ][ 1 ], b[ 3 ][ 1 ] );
+		Transpose( b[ 4 ][ 0 ], b[ 5 ][ 0 ], b[ 6 ][ 0 ], b[ 7 ][ 0 ] );
+
+		for( u32 i = 0; i < 4; ++i )
+		{
+			const V32x4		t( b[ i ][ 1 ] );
+			b[ i ][ 1 ] = b[ 4 + i ][ 0 ];
+			b[ 4 + i ][ 0 ] = t;
+		}
+	}
+}
+
+void JpegIDCTSIMD( s16 * dst, const s16 * src )
+{
+	V32x4		block[ 8 ][ 2 ];
+	V32x4		out[ 8 ];
+
+	for( u32 r = 0; r < 8; ++r )
+	{
+		Load( block[ r ], src + r * 8 );
+	}
+
+	// Columns
+	for( u32 h = 0; h < 2; ++h )
+	{
+		IDCT1D( out, block, h );
+
+		for( u32 r = 0; r < 8; ++r )
+		{
+			block[ r ][ h ] = Descale1( out[ r ] );
+		}
+	}
+
+	// Rows, with each block[ c ][ h ] now holding column c of rows 4h..4h+3
+	Transpose( block );
+
+	for( u32 h = 0; h < 2; ++h )
+	{
+		IDCT1D( out, block, h );
+
+		for( u32 c = 0; c < 8; ++c )
+		{
+			block[ c ][ h ] = Descale2( out[ c ] );
+		}
+	}
+
+	Transpose( block );
+
+	for( u32 r = 0; r < 8; ++r )
+	{
+		Store( dst + r * 8, block[ r ] );
+	}
+}
+
+void JpegRGBALineSIMD( u16 * out, const s16 * y, const s16 * u )
+{
+#if defined(__SSE2__)
+	const __m128i	uu( _mm_loadu_si128( (const __m128i *)u ) );
+	const __m128i	vv( _mm_loadu_si128( (const __m128i *)( u + 64 ) ) );
+	const __m128i	uv_lo( _mm_unpacklo_epi16( uu, vv ) );
+	const __m128i	uv_hi( _mm_unpackhi_epi16( uu, vv ) );
+
+	// Each 32 bit lane of these is the u and v coefficients for pmaddwd
+	const __m128i	k_r( _mm_set1_epi32( s32( u32( kJpegRGBA_VR ) << 16 ) ) );
+	const __m128i	k_g( _mm_set1_epi32( s32( ( u32( kJpegRGBA_VG ) << 16 ) | u16( kJpegRGBA_UG ) ) ) );
+	const __m128i	k_b( _mm_set1_epi32( u16( kJpegRGBA_UB ) ) );
+
+	#define CHROMA( k )	_mm_packs_epi32( _mm_srai_epi32( _mm_madd_epi16( uv_lo, k ), kJpegRGBABits ), \
+										 _mm_srai_epi32( _mm_madd_epi16( uv_hi, k ), kJpegRGBABits ) )
+	const __m128i	cr( CHROMA( k_r ) );
+	const __m128i	cg( CHROMA( k_g ) );
+	const __m128i	cb( CHROMA( k_b ) );
+	#undef CHROMA
+
+	const __m128i	bias( _mm_set1_epi16( 2048 ) );
+	const __m128i	zero( _mm_setzero_si128() );
+	const __m128i	max( _mm_set1_epi16( 0xff0 ) );
+	const __m128i	mask( _mm_set1_epi16( 0xf80 ) );
+
+	#define COMPONENT( yy, c )	_mm_and_si128( _mm_min_epi16( _mm_max_epi16( _mm_add_epi16( yy, c ), zero ), max ), mask )
+
+	for( u32 i = 0; i < 2; ++i )
+	{
+		const __m128i	yy( _mm_add_epi16( _mm_loadu_si128( (const __m128i *)( y + i * 64 ) ), bias ) );
+		const __m128i	r( COMPONENT( yy, i ? _mm_unpackhi_epi16( cr, cr ) : _mm_unpacklo_epi16( cr, cr ) ) );
+		const __m128i	g( COMPONENT( yy, i ? _mm_unpackhi_epi16( cg, cg ) : _mm_unpacklo_epi16( cg, cg ) ) );
+		const __m128i	b( COMPONENT( yy, i ? _mm_unpackhi_epi16( cb, cb ) : _mm_unpacklo_epi16( cb, cb ) ) );
+
+		const __m128i	rgba( _mm_or_si128( _mm_or_si128( _mm_slli_epi16( r, 4 ), _mm_srli_epi16( g, 1 ) ),
+											_mm_or_si128( _mm_srli_epi16( b, 6 ), _mm_set1_epi16( 1 ) ) ) );
+		_mm_storeu_si128( (__m128i *)( out + i * 8 ), rgba );
+	}
+
+	#undef COMPONENT
+#else
+	const int16x8_t	uu( vld1q_s16( u ) );
+	const int16x8_t	vv( vld1q_s16( u + 64 ) );
+
+	const int16x8_t	cr( vcombine_s16( vshrn_n_s32( vmull_n_s16( vget_low_s16( vv ), kJpegRGBA_VR ), kJpegRGBABits ),
+									  vshrn_n_s32( vmull_n_s16( vget_high_s16( vv ), kJpegRGBA_VR ), kJpegRGBABits ) ) );
+	const int16x8_t	cg( vcombine_s16( vshrn_n_s32( vmlal_n_s16( vmull_n_s16( vget_low_s16( uu ), kJpegRGBA_UG ), vget_low_s16( vv ), kJpegRGBA_VG ), kJpegRGBABits ),
+									  vshrn_n_s32( vmlal_n_s16( vmull_n_s16( vget_high_s16( uu ), kJpegRGBA_UG ), vget_high_s16( vv ), kJpegRGBA_VG ), kJpegRGBABits ) ) );
+	const int16x8_t	cb( vcombine_s16( vshrn_n_s32( vmull_n_s16( vget_low_s16( uu ), kJpegRGBA_UB ), kJpegRGBABits ),
+									  vshrn_n_s32( vmull_n_s16( vget_high_s16( uu ), kJpegRGBA_UB ), kJpegRGBABits ) ) );
+
+	const int16x8x2_t	dr( vzipq_s16( cr, cr ) );
+	const int16x8x2_t	dg( vzipq_s16( cg, cg ) );
+	const int16x8x2_t	db( vzipq_s16( cb, cb ) );
+
+	const int16x8_t	bias( vdupq_n_s16( 2048 ) );
+	const int16x8_t	zero( vdupq_n_s16( 0 ) );
+	const int16x8_t	max( vdupq_n_s16( 0xff0 ) );
+	const int16x8_t	mask( vdupq_n_s16( 0xf80 ) );
+
+	#define COMPONENT( yy, c )	vreinterpretq_u16_s16( vandq_s16( vminq_s16( vmaxq_s16( vaddq_s16( yy, c ), zero ), max ), mask ) )
+
+	for( u32 i = 0; i < 2; ++i )
+	{
+		const int16x8_t	yy( vaddq_s16( vld1q_s16( y + i * 64 ), bias ) );
+		const uint16x8_t	r( COMPONENT( yy, dr.val[ i ] ) );
+		const uint16x8_t	g( COMPONENT( yy, dg.val[ i ] ) );
+		const uint16x8_t	b( COMPONENT( yy, db.val[ i ] ) );
+
+		const uint16x8_t	rgba( vorrq_u16( vorrq_u16( vshlq_n_u16( r, 4 ), vshrq_n_u16( g, 1 ) ),
+											 vorrq_u16( vshrq_n_u16( b, 6 ), vdupq_n_u16( 1 ) ) ) );
+		vst1q_u16( out + i * 8, rgba );
+	}
+
+	#undef COMPONENT
+#endif
+}
+
+#endif // DAEDALUS_SIMD_JPEG
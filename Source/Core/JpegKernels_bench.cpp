@@ -0,0 +1,468 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Checks the JpegKernels against the floating point IDCT and colour
+//	conversion JpegTask used to have, which are kept here for reference, and
+//	times a PS macroblock (four Y and two chroma subblocks, then its 16x16
+//	pixels as RGBA) with each. Returns 1 if anything's wrong.
+//
+//	The fixed point versions have to be within 1 of the float ones for every
+//	IDCT output, and within one step of each 5 bit RGBA component; the SIMD
+//	versions have to match the Scalar ones exactly. The blocks are made by a
+//	forward DCT of 8x8 pixels (smooth gradients, some with a lot of noise)
+//	quantised at a few different qualities, as the games' are, with some
+//	random sparse blocks on top.
+//
+
+#include "stdafx.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Core/JpegKernels.h"
+#include "Core/RDRam.h"
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kDefaultBlocks = 20000;
+	const u32	kNumMacroblocks = 64;
+	const u32	kTimingPasses = 200;
+
+	struct SRand
+	{
+		explicit SRand( u32 seed ) : State( seed ) {}
+
+		u32		Next()
+		{
+			State = State * 1664525 + 1013904223;
+			return State >> 8;
+		}
+
+		u32		Below( u32 n )		{ return Next() % n; }
+		s32		Between( s32 lo, s32 hi )	{ return lo + s32( Below( u32( hi - lo + 1 ) ) ); }
+
+		u32		State;
+	};
+
+	//
+	//	The float versions, as they were in JpegTask.cpp
+	//
+
+	/* Normalized such as C4 = 1 */
+	#define C3   1.175875602f
+	#define C6   0.541196100f
+	#define K1   0.765366865f   //  C2-C6
+	#define K2  -1.847759065f   // -C2-C6
+	#define K3  -0.390180644f   //  C5-C3
+	#define K4  -1.961570561f   // -C5-C3
+	#define K5   1.501321110f   //  C1+C3-C5-C7
+	#define K6   2.053119869f   //  C1+C3-C5+C7
+	#define K7   3.072711027f   //  C1+C3+C5-C7
+	#define K8   0.298631336f   // -C1+C3+C5-C7
+	#define K9  -0.899976223f   //  C7-C3
+	#define K10 -2.562915448f   // -C1-C3
+	void InverseDCT1D(const float * const x, float *dst, u32 stride)
+	{
+		float e[4];
+		float f[4];
+		float x26, x1357, x15, x37, x17, x35;
+
+		x15   =  K3 * (x[1] + x[5]);
+		x37   =  K4 * (x[3] + x[7]);
+		x17   =  K9 * (x[1] + x[7]);
+		x35   = K10 * (x[3] + x[5]);
+		x1357 =  C3 * (x[1] + x[3] + x[5] + x[7]);
+		x26   =  C6 * (x[2] + x[6]);
+
+		f[0] = x[0] + x[4];
+		f[1] = x[0] - x[4];
+		f[2] = x26 + K1*x[2];
+		f[3] = x26 + K2*x[6];
+
+		e[0] = x1357 + x15 + K5*x[1] + x17;
+		e[1] = x1357 + x37 + K7*x[3] + x35;
+		e[2] = x1357 + x15 + K6*x[5] + x35;
+		e[3] = x1357 + x37 + K8*x[7] + x17;
+
+		*dst = f[0] + f[2] + e[0]; dst += stride;
+		*dst = f[1] + f[3] + e[1]; dst += stride;
+		*dst = f[1] - f[3] + e[2]; dst += stride;
+		*dst = f[0] - f[2] + e[3]; dst += stride;
+		*dst = f[0] - f[2] - e[3]; dst += stride;
+		*dst = f[1] - f[3] - e[2]; dst += stride;
+		*dst = f[1] + f[3] - e[1]; dst += stride;
+		*dst = f[0] + f[2] - e[0]; dst += stride;
+	}
+	#undef C3
+	#undef C6
+	#undef K1
+	#undef K2
+	#undef K3
+	#undef K4
+	#undef K5
+	#undef K6
+	#undef K7
+	#undef K8
+	#undef K9
+	#undef K10
+
+	void JpegIDCTFloat(s16 *dst, const s16 *src)
+	{
+		float x[8];
+		float block[64];
+
+		/* idct 1d on rows (+transposition) */
+		for (u32 i = 0; i < 8; ++i)
+		{
+			for (u32 j = 0; j < 8; ++j)
+			{
+				x[j] = (float)src[i*8+j];
+			}
+
+			InverseDCT1D(x, &block[i], 8);
+		}
+
+		/* idct 1d on columns (thanks to previous transposition) */
+		for (u32 i = 0; i < 8; ++i)
+		{
+			InverseDCT1D(&block[i*8], x, 1);
+
+			/* C4 = 1 normalization implies a division by 8 */
+			for (u32 j = 0; j < 8; ++j)
+			{
+				dst[i+j*8] = (s16)x[j] >> 3;
+			}
+		}
+	}
+
+	u16 GetRGBA(s16 y, s16 u, s16 v)
+	{
+		const float fY = (float)y + 2048.0f;
+		const float fU = (float)u;
+		const float fV = (float)v;
+
+		const u16 r = clamp_RGBA_component((s16)(fY             + 1.4025*fV));
+		const u16 g = clamp_RGBA_component((s16)(fY - 0.3443*fU - 0.7144*fV));
+		const u16 b = clamp_RGBA_component((s16)(fY + 1.7729*fU            ));
+
+		return (r << 4) | (g >> 1) | (b >> 6) | 1;
+	}
+
+	void JpegRGBALineFloat(u16 *rgba, const s16 *y, const s16 *u)
+	{
+		const s16 * const v  = u + 64;
+		const s16 * const y2 = y + 64;
+
+		for (u32 i = 0; i < 4; ++i)
+		{
+			rgba[i*2]     = GetRGBA(y[i*2],    u[i],   v[i]);
+			rgba[i*2+1]   = GetRGBA(y[i*2+1],  u[i],   v[i]);
+			rgba[i*2+8]   = GetRGBA(y2[i*2],   u[i+4], v[i+4]);
+			rgba[i*2+9]   = GetRGBA(y2[i*2+1], u[i+4], v[i+4]);
+		}
+	}
+
+	//
+	//	Test data
+	//
+
+	// The ucodes' transposed default quantisation table
+	const s16	kQTable[ 64 ] =
+	{
+		16, 12, 14, 14,  18,  24,  49,  72,
+		11, 12, 13, 17,  22,  35,  64,  92,
+		10, 14, 16, 22,  37,  55,  78,  95,
+		16, 19, 24, 29,  56,  64,  87,  98,
+		24, 26, 40, 51,  68,  81, 103, 112,
+		40, 58, 57, 87, 109, 104, 121, 100,
+		51, 60, 69, 80, 103, 113, 120, 103,
+		61, 55, 56, 62,  77,  92, 101,  99
+	};
+
+	f64		gBasis[ 8 ][ 8 ];
+
+	void	InitBasis()
+	{
+		for( u32 u = 0; u < 8; ++u )
+		{
+			for( u32 x = 0; x < 8; ++x )
+			{
+				gBasis[ u ][ x ] = u == 0 ? 1.0 : sqrt( 2.0 ) * cos( ( 2 * x + 1 ) * u * M_PI / 16.0 );
+			}
+		}
+	}
+
+	// Coefficients which the IDCT turns back into (about) 8x8 pixels in -2048..2047
+	void	MakeBlock( SRand & rand, s16 * coefs )
+	{
+		const s32	base( rand.Between( -2048, 2047 ) );
+		const s32	dx( rand.Between( -100, 100 ) );
+		const s32	dy( rand.Between( -100, 100 ) );
+		const s32	noise( rand.Below( 3 ) == 0 ? 800 : 60 );
+		const f64	quality( rand.Below( 3 ) == 0 ? 0.5 : rand.Below( 2 ) ? 2.0 : 8.0 );
+
+		f64			pixels[ 64 ];
+		for( u32 i = 0; i < 64; ++i )
+		{
+			s32		p( base + dx * s32( i % 8 ) + dy * s32( i / 8 ) + rand.Between( -noise, noise ) );
+			p = p < -2048 ? -2048 : p > 2047 ? 2047 : p;
+			pixels[ i ] = p * 8.0;
+		}
+
+		for( u32 v = 0; v < 8; ++v )
+		{
+			for( u32 u = 0; u < 8; ++u )
+			{
+				f64		sum( 0.0 );
+				for( u32 y = 0; y < 8; ++y )
+				{
+					for( u32 x = 0; x < 8; ++x )
+					{
+						sum += pixels[ y * 8 + x ] * gBasis[ u ][ x ] * gBasis[ v ][ y ];
+					}
+				}
+
+				const f64	q( kQTable[ u * 8 + v ] * quality * 16.0 );
+				f64			c( floor( sum / 64.0 / q + 0.5 ) * q );
+				c = c < -32768.0 ? -32768.0 : c > 32767.0 ? 32767.0 : c;
+				coefs[ v * 8 + u ] = s16( c );
+			}
+		}
+	}
+
+	void	MakeSparseBlock( SRand & rand, s16 * coefs )
+	{
+		memset( coefs, 0, 64 * sizeof( s16 ) );
+		coefs[ 0 ] = s16( rand.Between( -8192, 8191 ) );
+
+		for( u32 n = rand.Below( 12 ); n != 0; --n )
+		{
+			coefs[ rand.Below( 64 ) ] = s16( rand.Between( -512, 511 ) );
+		}
+	}
+
+	u32		CheckIDCT( u32 num_blocks )
+	{
+		SRand	rand( 0x1dc71dc7 );
+		u32		num_errors( 0 );
+		u32		num_off_by_one( 0 );
+
+		for( u32 b = 0; b < num_blocks; ++b )
+		{
+			s16		coefs[ 64 ];
+			if( b % 4 == 3 )
+				MakeSparseBlock( rand, coefs );
+			else
+				MakeBlock( rand, coefs );
+
+			s16		expected[ 64 ], scalar[ 64 ], in_place[ 64 ];
+			JpegIDCTFloat( expected, coefs );
+			JpegIDCTScalar( scalar, coefs );
+
+			for( u32 i = 0; i < 64; ++i )
+			{
+				const s32	d( abs( scalar[ i ] - expected[ i ] ) );
+				if( d == 1 )
+				{
+					num_off_by_one++;
+				}
+				else if( d > 1 && num_errors++ < 10 )
+				{
+					printf( "IDCT block %u [%u]: float %d, fixed %d\n", b, i, expected[ i ], scalar[ i ] );
+				}
+			}
+
+			memcpy( in_place, coefs, sizeof( in_place ) );
+			JpegIDCT( in_place, in_place );
+			if( memcmp( in_place, scalar, sizeof( scalar ) ) != 0 && num_errors++ < 10 )
+			{
+				printf( "IDCT block %u: JpegIDCT doesn't match JpegIDCTScalar\n", b );
+			}
+		}
+
+		printf( "IDCT: %u blocks, %.2f%% of outputs 1 off the float version\n",
+				num_blocks, 100.0 * num_off_by_one / ( num_blocks * 64.0 ) );
+		return num_errors;
+	}
+
+	inline s32 Component( u16 rgba, u32 shift )		{ return ( rgba >> shift ) & 0x1f; }
+
+	u32		CheckRGBA( u32 num_lines )
+	{
+		SRand	rand( 0x76b476b4 );
+		u32		num_errors( 0 );
+		u32		num_off_by_one( 0 );
+
+		// Laid out as in a macroblock: y at 0 and 64, u at 128 and v at 192
+		s16		block[ 4 * 64 ];
+
+		for( u32 l = 0; l < num_lines; ++l )
+		{
+			// Mostly within the range of real pixels, sometimes anywhere the IDCT can put them
+			const s32	range( l % 8 == 0 ? 4096 : 2048 );
+			for( u32 i = 0; i < 4 * 64; ++i )
+			{
+				block[ i ] = s16( rand.Between( -range, range - 1 ) );
+			}
+
+			u16		expected[ 16 ], scalar[ 16 ], actual[ 16 ];
+			JpegRGBALineFloat( expected, block, block + 128 );
+			JpegRGBALineScalar( scalar, block, block + 128 );
+			JpegRGBALine( actual, block, block + 128 );
+
+			for( u32 i = 0; i < 16; ++i )
+			{
+				bool	off_by_one( false );
+				for( u32 shift = 1; shift < 16; shift += 5 )
+				{
+					const s32	d( abs( Component( scalar[ i ], shift ) - Component( expected[ i ], shift ) ) );
+					if( d == 1 )
+					{
+						off_by_one = true;
+					}
+					else if( d > 1 && num_errors++ < 10 )
+					{
+						printf( "RGBA line %u [%u]: float %04x, fixed %04x\n", l, i, expected[ i ], scalar[ i ] );
+					}
+				}
+				if( ( scalar[ i ] & 1 ) == 0 && num_errors++ < 10 )
+				{
+					printf( "RGBA line %u [%u]: no alpha in %04x\n", l, i, scalar[ i ] );
+				}
+				if( off_by_one )
+					num_off_by_one++;
+			}
+
+			if( memcmp( actual, scalar, sizeof( scalar ) ) != 0 && num_errors++ < 10 )
+			{
+				printf( "RGBA line %u: JpegRGBALine doesn't match JpegRGBALineScalar\n", l );
+			}
+		}
+
+		printf( "RGBA: %u lines, %.3f%% of pixels 1 off the float version\n",
+				num_lines, 100.0 * num_off_by_one / ( num_lines * 16.0 ) );
+		return num_errors;
+	}
+
+	typedef void ( *IDCTFunction )( s16 * dst, const s16 * src );
+	typedef void ( *RGBALineFunction )( u16 * out, const s16 * y, const s16 * u );
+
+	// As DecodeMacroblockPS and EmitTilesMode2, without the dequantisation and RDRAM
+	void	DecodeMacroblock( u16 * rgba, const s16 * coefs, IDCTFunction idct, RGBALineFunction rgba_line )
+	{
+		s16		macroblock[ 6 * 64 ];
+		for( u32 sb = 0; sb < 6; ++sb )
+		{
+			idct( macroblock + sb * 64, coefs + sb * 64 );
+		}
+
+		u32		y_offset( 0 );
+		u32		u_offset( 4 * 64 );
+		for( u32 i = 0; i < 8; ++i )
+		{
+			rgba_line( rgba,      &macroblock[ y_offset ],     &macroblock[ u_offset ] );
+			rgba_line( rgba + 16, &macroblock[ y_offset + 8 ], &macroblock[ u_offset ] );
+
+			y_offset += ( i == 3 ) ? 64 + 16 : 16;
+			u_offset += 8;
+			rgba += 32;
+		}
+	}
+
+	f64		TimeMacroblocks( const s16 * coefs, u16 * rgba, IDCTFunction idct, RGBALineFunction rgba_line )
+	{
+		u64		start( 0 ), end( 0 ), frequency( 0 );
+		NTiming::GetPreciseFrequency( &frequency );
+		NTiming::GetPreciseTime( &start );
+
+		for( u32 p = 0; p < kTimingPasses; ++p )
+		{
+			for( u32 mb = 0; mb < kNumMacroblocks; ++mb )
+			{
+				DecodeMacroblock( rgba + mb * 256, coefs + mb * 6 * 64, idct, rgba_line );
+			}
+		}
+
+		NTiming::GetPreciseTime( &end );
+		return f64( end - start ) * 1000000.0 / ( f64( frequency ) * kTimingPasses * kNumMacroblocks );
+	}
+
+	u32		TimeDecode()
+	{
+		SRand	rand( 0x3acb3acb );
+		s16 *	coefs( new s16[ kNumMacroblocks * 6 * 64 ] );
+		u16 *	expected( new u16[ kNumMacroblocks * 256 ] );
+		u16 *	actual( new u16[ kNumMacroblocks * 256 ] );
+
+		for( u32 sb = 0; sb < kNumMacroblocks * 6; ++sb )
+		{
+			MakeBlock( rand, coefs + sb * 64 );
+		}
+
+		const f64	float_us( TimeMacroblocks( coefs, expected, JpegIDCTFloat, JpegRGBALineFloat ) );
+		const f64	scalar_us( TimeMacroblocks( coefs, actual, JpegIDCTScalar, JpegRGBALineScalar ) );
+		printf( "Macroblock: float %.3f us, scalar %.3f us (%.2fx)\n", float_us, scalar_us, float_us / scalar_us );
+
+		u32		num_errors( 0 );
+#ifdef DAEDALUS_SIMD_JPEG
+		u16 *	simd( new u16[ kNumMacroblocks * 256 ] );
+		const f64	simd_us( TimeMacroblocks( coefs, simd, JpegIDCTSIMD, JpegRGBALineSIMD ) );
+		printf( "Macroblock: SIMD %.3f us (%.2fx)\n", simd_us, float_us / simd_us );
+
+		if( memcmp( simd, actual, kNumMacroblocks * 256 * sizeof( u16 ) ) != 0 )
+		{
+			printf( "SIMD macroblocks don't match the scalar ones\n" );
+			num_errors++;
+		}
+		delete [] simd;
+#endif
+
+		u32		num_different( 0 );
+		for( u32 i = 0; i < kNumMacroblocks * 256; ++i )
+		{
+			if( actual[ i ] != expected[ i ] )
+				num_different++;
+		}
+		printf( "Macroblock: %.3f%% of pixels differ from the float version\n", 100.0 * num_different / ( kNumMacroblocks * 256.0 ) );
+
+		delete [] coefs;
+		delete [] expected;
+		delete [] actual;
+		return num_errors;
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	const u32	num_blocks( argc > 1 ? strtoul( argv[ 1 ], NULL, 10 ) : kDefaultBlocks );
+
+	InitBasis();
+
+	u32		num_errors( 0 );
+	num_errors += CheckIDCT( num_blocks );
+	num_errors += CheckRGBA( num_blocks );
+	num_errors += TimeDecode();
+
+	printf( num_errors ? "FAILED\n" : "OK\n" );
+	return num_errors ? 1 : 0;
+}
@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "Core/JpegKernels.h"
 #include "Debug/DBGConsole.h"
 #include "Memory.h"
 #include "RDRam.h"
@@ -43,7 +44,6 @@ typedef void (*tile_line_emitter_t)(const s16 *y, const s16 *u, u32 address);
 
 /* pixel conversion & foratting */
 static u32 GetUYVY(s16 y1, s16 y2, s16 u, s16 v);
-static u16 GetRGBA(s16 y, s16 u, s16 v);
 
 /* tile line emitters */
 static void EmitYUVTileLine(const s16 *y, const s16 *u, u32 address);
@@ -64,8 +64,6 @@ static void ReorderSubBlock(s16 *dst, const s16 *src, const u32 *table);
 static void MultSubBlocks(s16 *dst, const s16 *src1, const s16 *src2, u32 shift);
 static void ScaleSubBlock(s16 *dst, const s16 *src, s16 scale);
 static void RShiftSubBlock(s16 *dst, const s16 *src, u32 shift);
-static void InverseDCT1D(const float * const x, float *dst, u32 stride);
-static void InverseDCTSubBlock(s16 *dst, const s16 *src);
 static void RescaleYSubBlock(s16 *dst, const s16 *src);
 static void RescaleUVSubBlock(s16 *dst, const s16 *src);
 
@@ -122,12 +120,12 @@ void jpeg_decode_PS0(OSTask *task)
         return;
     }
     #endif
-    u32       address          = rdram_read_u32((u32)task->t.data_ptr);
-    const u32 macroblock_count = rdram_read_u32((u32)task->t.data_ptr + 4);
-    const u32 mode             = rdram_read_u32((u32)task->t.data_ptr + 8);
-    const u32 qtableY_ptr      = rdram_read_u32((u32)task->t.data_ptr + 12);
-    const u32 qtableU_ptr      = rdram_read_u32((u32)task->t.data_ptr + 16);
-    const u32 qtableV_ptr      = rdram_read_u32((u32)task->t.data_ptr + 20);
+    u32       address          = rdram_read_u32(task->t.data_ptr);
+    const u32 macroblock_count = rdram_read_u32(task->t.data_ptr + 4);
+    const u32 mode             = rdram_read_u32(task->t.data_ptr + 8);
+    const u32 qtableY_ptr      = rdram_read_u32(task->t.data_ptr + 12);
+    const u32 qtableU_ptr      = rdram_read_u32(task->t.data_ptr + 16);
+    const u32 qtableV_ptr      = rdram_read_u32(task->t.data_ptr + 20);
 
     #ifdef DAEDALUS_DEBUG_CONSOLE
     if (mode != 0 && mode != 2)
@@ -178,12 +176,12 @@ void jpeg_decode_PS(OSTask *task)
         return;
     }
     #endif
-    u32       address          = rdram_read_u32((u32)task->t.data_ptr);
-    const u32 macroblock_count = rdram_read_u32((u32)task->t.data_ptr + 4);
-    const u32 mode             = rdram_read_u32((u32)task->t.data_ptr + 8);
-    const u32 qtableY_ptr      = rdram_read_u32((u32)task->t.data_ptr + 12);
-    const u32 qtableU_ptr      = rdram_read_u32((u32)task->t.data_ptr + 16);
-    const u32 qtableV_ptr      = rdram_read_u32((u32)task->t.data_ptr + 20);
+    u32       address          = rdram_read_u32(task->t.data_ptr);
+    const u32 macroblock_count = rdram_read_u32(task->t.data_ptr + 4);
+    const u32 mode             = rdram_read_u32(task->t.data_ptr + 8);
+    const u32 qtableY_ptr      = rdram_read_u32(task->t.data_ptr + 12);
+    const u32 qtableU_ptr      = rdram_read_u32(task->t.data_ptr + 16);
+    const u32 qtableV_ptr      = rdram_read_u32(task->t.data_ptr + 20);
 
     #ifdef DAEDALUS_DEBUG_CONSOLE
     if (mode != 0 && mode != 2)
@@ -227,7 +225,7 @@ void jpeg_decode_OB(OSTask *task)
 
     s32 y_dc = 0, u_dc = 0, v_dc = 0;
 
-	u32  address = (u32)task->t.data_ptr;
+	u32  address = task->t.data_ptr;
 	const u32 macroblock_count = task->t.data_size;
 	const int qscale = task->t.yield_data_size;
 
@@ -262,19 +260,6 @@ static u32 GetUYVY(s16 y1, s16 y2, s16 u, s16 v)
         |  (u32)clamp_u8(y2);
 }
 
-static u16 GetRGBA(s16 y, s16 u, s16 v)
-{
-    const float fY = (float)y + 2048.0f;
-    const float fU = (float)u;
-    const float fV = (float)v;
-
-    const u16 r = clamp_RGBA_component((s16)(fY             + 1.4025*fV));
-    const u16 g = clamp_RGBA_component((s16)(fY - 0.3443*fU - 0.7144*fV));
-    const u16 b = clamp_RGBA_component((s16)(fY + 1.7729*fU            ));
-
-    return (r << 4) | (g >> 1) | (b >> 6) | 1;
-}
-
 static void EmitYUVTileLine(const s16 *y, const s16 *u, u32 address)
 {
     u32 uyvy[8];
@@ -298,25 +283,7 @@ static void EmitRGBATileLine(const s16 *y, const s16 *u, u32 address)
 {
     u16 rgba[16];
 
-    const s16 * const v  = u + SUBBLOCK_SIZE;
-    const s16 * const y2 = y + SUBBLOCK_SIZE;
-
-    rgba[0]  = GetRGBA(y[0],  u[0], v[0]);
-    rgba[1]  = GetRGBA(y[1],  u[0], v[0]);
-    rgba[2]  = GetRGBA(y[2],  u[1], v[1]);
-    rgba[3]  = GetRGBA(y[3],  u[1], v[1]);
-    rgba[4]  = GetRGBA(y[4],  u[2], v[2]);
-    rgba[5]  = GetRGBA(y[5],  u[2], v[2]);
-    rgba[6]  = GetRGBA(y[6],  u[3], v[3]);
-    rgba[7]  = GetRGBA(y[7],  u[3], v[3]);
-    rgba[8]  = GetRGBA(y2[0], u[4], v[4]);
-    rgba[9]  = GetRGBA(y2[1], u[4], v[4]);
-    rgba[10] = GetRGBA(y2[2], u[5], v[5]);
-    rgba[11] = GetRGBA(y2[3], u[5], v[5]);
-    rgba[12] = GetRGBA(y2[4], u[6], v[6]);
-    rgba[13] = GetRGBA(y2[5], u[6], v[6]);
-    rgba[14] = GetRGBA(y2[6], u[7], v[7]);
-    rgba[15] = GetRGBA(y2[7], u[7], v[7]);
+    JpegRGBALine(rgba, y, u);
 
     rdram_write_many_u16(rgba, address, 16);
 }
@@ -389,7 +356,7 @@ static void DecodeMacroblockOB(s16 *macroblock, s32 *y_dc, s32 *u_dc, s32 *v_dc,
 		if (qtable != nullptr)
 			MultSubBlocks(tmp_sb, tmp_sb, qtable, 0);
 		TransposeSubBlock(macroblock, tmp_sb);
-		InverseDCTSubBlock(macroblock, macroblock);
+		JpegIDCT(macroblock, macroblock);
 
 		macroblock += SUBBLOCK_SIZE;
 	}
@@ -409,7 +376,7 @@ static void DecodeMacroblockPS(s16 *macroblock, u32 subblock_count, const s16 qt
 
         MultSubBlocks(macroblock, macroblock, qtables[q], 4);
         ZigZagSubBlock(tmp_sb, macroblock);
-        InverseDCTSubBlock(macroblock, tmp_sb);
+        JpegIDCT(macroblock, tmp_sb);
 
         macroblock += SUBBLOCK_SIZE;
     }
@@ -430,7 +397,7 @@ static void DecodeMacroblockPS0(s16 *macroblock, u32 subblock_count, const s16 q
 
         MultSubBlocks(macroblock, macroblock, qtables[q], 4);
         ZigZagSubBlock(tmp_sb, macroblock);
-        InverseDCTSubBlock(macroblock, tmp_sb);
+        JpegIDCT(macroblock, tmp_sb);
 
         if (isChromaSubBlock)
         {
@@ -494,100 +461,6 @@ static void RShiftSubBlock(s16 *dst, const s16 *src, u32 shift)
     }
 }
 
-/***************************************************************************
- * Fast 2D IDCT using separable formulation and normalization
- * Computations use single precision floats
- * Implementation based on Wikipedia :
- * http://fr.wikipedia.org/wiki/Transform%C3%A9e_en_cosinus_discr%C3%A8te
- **************************************************************************/
-
-/* Normalized such as C4 = 1 */
-#define C3   1.175875602f
-#define C6   0.541196100f
-#define K1   0.765366865f   //  C2-C6
-#define K2  -1.847759065f   // -C2-C6
-#define K3  -0.390180644f   //  C5-C3
-#define K4  -1.961570561f   // -C5-C3
-#define K5   1.501321110f   //  C1+C3-C5-C7
-#define K6   2.053119869f   //  C1+C3-C5+C7
-#define K7   3.072711027f   //  C1+C3+C5-C7
-#define K8   0.298631336f   // -C1+C3+C5-C7
-#define K9  -0.899976223f   //  C7-C3
-#define K10 -2.562915448f   // -C1-C3
-static void InverseDCT1D(const float * const x, float *dst, u32 stride)
-{
-    float e[4];
-    float f[4];
-    float x26, x1357, x15, x37, x17, x35;
-
-    x15   =  K3 * (x[1] + x[5]);
-    x37   =  K4 * (x[3] + x[7]);
-    x17   =  K9 * (x[1] + x[7]);
-    x35   = K10 * (x[3] + x[5]);
-    x1357 =  C3 * (x[1] + x[3] + x[5] + x[7]);
-    x26   =  C6 * (x[2] + x[6]);
-
-    f[0] = x[0] + x[4];
-    f[1] = x[0] - x[4];
-    f[2] = x26 + K1*x[2];
-    f[3] = x26 + K2*x[6];
-
-    e[0] = x1357 + x15 + K5*x[1] + x17;
-    e[1] = x1357 + x37 + K7*x[3] + x35;
-    e[2] = x1357 + x15 + K6*x[5] + x35;
-    e[3] = x1357 + x37 + K8*x[7] + x17;
-
-    *dst = f[0] + f[2] + e[0]; dst += stride;
-    *dst = f[1] + f[3] + e[1]; dst += stride;
-    *dst = f[1] - f[3] + e[2]; dst += stride;
-    *dst = f[0] - f[2] + e[3]; dst += stride;
-    *dst = f[0] - f[2] - e[3]; dst += stride;
-    *dst = f[1] - f[3] - e[2]; dst += stride;
-    *dst = f[1] + f[3] - e[1]; dst += stride;
-    *dst = f[0] + f[2] - e[0]; dst += stride;
-}
-#undef C3
-#undef C6
-#undef K1
-#undef K2
-#undef K3
-#undef K4
-#undef K5
-#undef K6
-#undef K7
-#undef K8
-#undef K9
-#undef K10
-
-static void InverseDCTSubBlock(s16 *dst, const s16 *src)
-{
-    float x[8];
-    float block[SUBBLOCK_SIZE];
-
-    /* idct 1d on rows (+transposition) */
-    for (u32 i = 0; i < 8; ++i)
-    {
-        for (u32 j = 0; j < 8; ++j)
-        {
-            x[j] = (float)src[i*8+j];
-        }
-
-        InverseDCT1D(x, &block[i], 8);
-    }
-
-    /* idct 1d on columns (thanks to previous transposition) */
-    for (u32 i = 0; i < 8; ++i)
-    {
-        InverseDCT1D(&block[i*8], x, 1);
-
-        /* C4 = 1 normalization implies a division by 8 */
-        for (u32 j = 0; j < 8; ++j)
-        {
-            dst[i+j*8] = (s16)x[j] >> 3;
-        }
-    }
-}
-
 static void RescaleYSubBlock(s16 *dst, const s16 *src)
 {
     for (u32 i = 0; i < SUBBLOCK_SIZE; ++i)
@@ -80,6 +80,10 @@ static void * Read_8404_8404( u32 address )
 	#ifdef DAEDALUS_DEBUG_CONSOLE
 	DPF( DEBUG_MEMORY_SP_REG, "Reading from SP_REG: 0x%08x", address );
 	#endif
+	// The game polls SP_STATUS to see if its task is done
+	if( (address & 0xFF) == (SP_STATUS_REG - SP_BASE_REG) )
+		AudioTask_Finish();
+
 	return (u8 *)g_pMemoryBuffers[MEM_SP_REG] + (address & 0xFF);
 }
 
@@ -237,6 +237,9 @@ static void WriteValue_8440_844F( u32 address, u32 value )
 	#ifdef DAEDALUS_DEBUG_CONSOLE
 		DPF( DEBUG_VI, "VI_ORIGIN_REG set to %d", value );
 #endif
+		// The plugins present the frame from here, so the render thread has to be done with it
+		GraphicsTask_Finish();
+
 		 // NB: if no display lists executed, interpret framebuffer
 		if( gRDPFrame == 0 )
 		{
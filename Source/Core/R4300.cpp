@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "R4300.h"
 
 #include "CPU.h"
+#include "InterpretCache.h"
 #include "Interrupt.h"
 #include "ROM.h"
 
@@ -1080,6 +1081,7 @@ static void R4300_CALL_TYPE R4300_SW( R4300_CALL_SIGNATURE ) 			// Store Word
 
 	u32 address {(u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate )};
 	Write32Bits(address, gGPR[op_code.rt]._u32_0);
+	gInterpretCache.InvalidateStore(address, 4);
 }
 
 static void R4300_CALL_TYPE R4300_SH( R4300_CALL_SIGNATURE ) 			// Store Halfword
@@ -1088,6 +1090,7 @@ static void R4300_CALL_TYPE R4300_SH( R4300_CALL_SIGNATURE ) 			// Store Halfwor
 
 	u32 address {(u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate )};
 	Write16Bits(address, (u16)(gGPR[op_code.rt]._u32_0 & 0xffff));
+	gInterpretCache.InvalidateStore(address, 2);
 }
 
 static void R4300_CALL_TYPE R4300_SB( R4300_CALL_SIGNATURE ) 			// Store Byte
@@ -1096,6 +1099,7 @@ static void R4300_CALL_TYPE R4300_SB( R4300_CALL_SIGNATURE ) 			// Store Byte
 
 	u32 address {(u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate )};
 	Write8Bits(address, (u8)(gGPR[op_code.rt]._u32_0 & 0xff));
+	gInterpretCache.InvalidateStore(address, 1);
 }
 
 static void R4300_CALL_TYPE R4300_SWL( R4300_CALL_SIGNATURE ) 			// Store Word Left
@@ -1121,6 +1125,7 @@ static void R4300_CALL_TYPE R4300_SWL( R4300_CALL_SIGNATURE ) 			// Store Word L
 #endif
 
 	QuickWrite32Bits(base, 0x0, dNew);
+	gInterpretCache.InvalidateStore(address & ~0x3, 4);
 }
 
 static void R4300_CALL_TYPE R4300_SWR( R4300_CALL_SIGNATURE ) 			// Store Word Right
@@ -1146,6 +1151,7 @@ static void R4300_CALL_TYPE R4300_SWR( R4300_CALL_SIGNATURE ) 			// Store Word R
 #endif
 
 	QuickWrite32Bits(base, 0x0, dNew);
+	gInterpretCache.InvalidateStore(address & ~0x3, 4);
 
 }
 
@@ -1160,6 +1166,7 @@ static void R4300_CALL_TYPE R4300_SDL( R4300_CALL_SIGNATURE )//CYRUS64
 	u64 nNew = (nMem & ~(((u64)~0LL >> ((address & 0x7) << 3)))) | (nReg >> ((address & 0x7) << 3));
 
 	QuickWrite64Bits(base, 0x0, nNew);
+	gInterpretCache.InvalidateStore(address & ~0x7, 8);
 }
 
 static void R4300_CALL_TYPE R4300_SDR( R4300_CALL_SIGNATURE )//CYRUS64
@@ -1173,6 +1180,7 @@ static void R4300_CALL_TYPE R4300_SDR( R4300_CALL_SIGNATURE )//CYRUS64
 	u64 nReg {gGPR[op_code.rt]._u64};
 	u64 nNew = (nMem & ~(~0LL << ((~address & 0x7) << 3))) | (nReg << ((~address & 0x7) << 3));
 	QuickWrite64Bits(base, 0x0, nNew);
+	gInterpretCache.InvalidateStore(address & ~0x7, 8);
 }
 
 static void R4300_CALL_TYPE R4300_CACHE( R4300_CALL_SIGNATURE )
@@ -1180,7 +1188,6 @@ static void R4300_CALL_TYPE R4300_CACHE( R4300_CALL_SIGNATURE )
 	R4300_CALL_MAKE_OP( op_code );
 //	return;
 
-#ifdef DAEDALUS_ENABLE_DYNAREC
 	u32 cache_op  {op_code.rt};
 	u32 address {(u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate )};
 
@@ -1194,7 +1201,6 @@ static void R4300_CALL_TYPE R4300_CACHE( R4300_CALL_SIGNATURE )
 		CPU_InvalidateICacheRange(address, 0x20);
 	}
 	//DBGConsole_Msg(0, "CACHE %s/%d, 0x%08x", gCacheNames[dwCache], dwAction, address);
-#endif
 }
 
 static void R4300_CALL_TYPE R4300_LWC1( R4300_CALL_SIGNATURE ) 				// Load Word to Copro 1 (FPU)
@@ -1230,6 +1236,7 @@ static void R4300_CALL_TYPE R4300_SWC1( R4300_CALL_SIGNATURE ) 			// Store Word
 
 	u32 address {(u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate )};
 	Write32Bits(address, LoadFPR_Word(op_code.ft));
+	gInterpretCache.InvalidateStore(address, 4);
 }
 
 static void R4300_CALL_TYPE R4300_SDC1( R4300_CALL_SIGNATURE )		// Store Doubleword From Copro 1
@@ -1238,6 +1245,7 @@ static void R4300_CALL_TYPE R4300_SDC1( R4300_CALL_SIGNATURE )		// Store Doublew
 
 	u32 address {(u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate )};
 	Write64Bits(address, LoadFPR_Long(op_code.ft));
+	gInterpretCache.InvalidateStore(address, 8);
 }
 
 
@@ -1247,6 +1255,7 @@ static void R4300_CALL_TYPE R4300_SD( R4300_CALL_SIGNATURE )			// Store Doublewo
 
 	u32 address {(u32)( gGPR[op_code.base]._s32_0 + (s32)(s16)op_code.immediate )};
 	Write64Bits(address, gGPR[op_code.rt]._u64);
+	gInterpretCache.InvalidateStore(address, 8);
 }
 
 
@@ -3302,6 +3311,176 @@ CPU_Instruction	R4300_GetInstructionHandler( OpCode op_code )
 	}
 }
 
+//	The cop1 ops are swapped for R4300_CoPro1_Disabled whenever SR_CU1 changes,
+//	so they have to be looked up in R4300Instruction each time they're executed
+static void R4300_CALL_TYPE R4300_Dispatch( R4300_CALL_SIGNATURE )
+{
+	R4300_CALL_MAKE_OP( op_code );
+	R4300Instruction[ op_code.op ]( R4300_CALL_ARGUMENTS );
+}
+
+//	Like R4300_GetInstructionHandler, but only resolves the tables which don't
+//	change while the rom is running, so the result can be kept by the interpreter
+CPU_Instruction	R4300_GetPredecodedHandler( OpCode op_code )
+{
+	switch( op_code.op )
+	{
+	case OP_SPECOP:
+	case OP_REGIMM:
+	case OP_COPRO0:
+		return R4300_GetInstructionHandler( op_code );
+
+	case OP_COPRO1:
+	case OP_LWC1:
+	case OP_LDC1:
+	case OP_SWC1:
+	case OP_SDC1:
+		return R4300_Dispatch;
+
+	default:
+		return R4300Instruction[ op_code.op ];
+	}
+}
+
+//	Simple ops only touch the gprs and hi/lo - no memory, cop0, branches or
+//	exceptions - so they can't read Count or the event queue, or raise any
+//	jobs. The interpreter runs these without checking for events after each one
+bool	R4300_IsSimpleOp( OpCode op_code )
+{
+	switch( op_code.op )
+	{
+	case OP_SPECOP:
+		switch( op_code.spec_op )
+		{
+		case SpecOp_JR:
+		case SpecOp_JALR:
+		case SpecOp_SYSCALL:
+		case SpecOp_BREAK:
+		case SpecOp_SYNC:
+		case SpecOp_TGE:
+		case SpecOp_TGEU:
+		case SpecOp_TLT:
+		case SpecOp_TLTU:
+		case SpecOp_TEQ:
+		case SpecOp_TNE:
+			return false;
+		default:
+			// Leave the unknown ops to the normal path too
+			return R4300SpecialInstruction[ op_code.spec_op ] != R4300_Special_Unk;
+		}
+
+	case OP_ADDI:
+	case OP_ADDIU:
+	case OP_SLTI:
+	case OP_SLTIU:
+	case OP_ANDI:
+	case OP_ORI:
+	case OP_XORI:
+	case OP_LUI:
+	case OP_DADDI:
+	case OP_DADDIU:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//	Versions of the most common simple ops which take their fields from
+//	SDecodedOperands. They must behave exactly like the handlers above
+static void R4300_CALL_TYPE R4300_Decoded_ADDIU( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._s64 = (s64)(s32)( gGPR[ op.Rs ]._s32_0 + op.Immediate ); }
+static void R4300_CALL_TYPE R4300_Decoded_DADDIU( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._s64 = gGPR[ op.Rs ]._s64 + op.Immediate; }
+static void R4300_CALL_TYPE R4300_Decoded_SLTI( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._u64 = gGPR[ op.Rs ]._s64 < (s64)op.Immediate ? 1 : 0; }
+static void R4300_CALL_TYPE R4300_Decoded_SLTIU( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._u64 = gGPR[ op.Rs ]._u64 < (u64)(s64)op.Immediate ? 1 : 0; }
+static void R4300_CALL_TYPE R4300_Decoded_ANDI( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._u64 = gGPR[ op.Rs ]._u64 & (u64)(u32)op.Immediate; }
+static void R4300_CALL_TYPE R4300_Decoded_ORI( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._u64 = gGPR[ op.Rs ]._u64 | (u64)(u32)op.Immediate; }
+static void R4300_CALL_TYPE R4300_Decoded_XORI( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._u64 = gGPR[ op.Rs ]._u64 ^ (u64)(u32)op.Immediate; }
+static void R4300_CALL_TYPE R4300_Decoded_LUI( const SDecodedOperands & op )	{ gGPR[ op.Rt ]._s64 = (s64)op.Immediate; }
+
+static void R4300_CALL_TYPE R4300_Decoded_SLL( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rt ]._u32_0 << op.Sa ); }
+static void R4300_CALL_TYPE R4300_Decoded_SRL( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rt ]._u32_0 >> op.Sa ); }
+static void R4300_CALL_TYPE R4300_Decoded_SRA( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rt ]._s32_0 >> op.Sa ); }
+static void R4300_CALL_TYPE R4300_Decoded_SLLV( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rt ]._u32_0 << ( gGPR[ op.Rs ]._u32_0 & 0x1F ) ); }
+static void R4300_CALL_TYPE R4300_Decoded_SRLV( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rt ]._u32_0 >> ( gGPR[ op.Rs ]._u32_0 & 0x1F ) ); }
+static void R4300_CALL_TYPE R4300_Decoded_SRAV( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rt ]._s32_0 >> ( gGPR[ op.Rs ]._u32_0 & 0x1F ) ); }
+static void R4300_CALL_TYPE R4300_Decoded_ADDU( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rs ]._s32_0 + gGPR[ op.Rt ]._s32_0 ); }
+static void R4300_CALL_TYPE R4300_Decoded_SUBU( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._s64 = (s64)(s32)( gGPR[ op.Rs ]._s32_0 - gGPR[ op.Rt ]._s32_0 ); }
+static void R4300_CALL_TYPE R4300_Decoded_AND( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rs ]._u64 & gGPR[ op.Rt ]._u64; }
+static void R4300_CALL_TYPE R4300_Decoded_OR( const SDecodedOperands & op )		{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rs ]._u64 | gGPR[ op.Rt ]._u64; }
+static void R4300_CALL_TYPE R4300_Decoded_XOR( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rs ]._u64 ^ gGPR[ op.Rt ]._u64; }
+static void R4300_CALL_TYPE R4300_Decoded_NOR( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = ~( gGPR[ op.Rs ]._u64 | gGPR[ op.Rt ]._u64 ); }
+static void R4300_CALL_TYPE R4300_Decoded_SLT( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rs ]._s64 < gGPR[ op.Rt ]._s64 ? 1 : 0; }
+static void R4300_CALL_TYPE R4300_Decoded_SLTU( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rs ]._u64 < gGPR[ op.Rt ]._u64 ? 1 : 0; }
+static void R4300_CALL_TYPE R4300_Decoded_DADDU( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rs ]._u64 + gGPR[ op.Rt ]._u64; }
+static void R4300_CALL_TYPE R4300_Decoded_MFHI( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gCPUState.MultHi._u64; }
+static void R4300_CALL_TYPE R4300_Decoded_MFLO( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gCPUState.MultLo._u64; }
+static void R4300_CALL_TYPE R4300_Decoded_DSLL32( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rt ]._u64 << ( 32 + op.Sa ); }
+static void R4300_CALL_TYPE R4300_Decoded_DSRA32( const SDecodedOperands & op )	{ gGPR[ op.Rd ]._u64 = gGPR[ op.Rt ]._s64 >> ( 32 + op.Sa ); }
+
+//	Returns nullptr (leaving p_operands untouched) for ops without a decoded
+//	version - they're run through R4300_GetPredecodedHandler's handler instead
+CPU_DecodedInstruction	R4300_GetDecodedHandler( OpCode op_code, SDecodedOperands * p_operands )
+{
+	CPU_DecodedInstruction	handler( nullptr );
+	s32						immediate( (s32)(s16)op_code.immediate );
+
+	switch( op_code.op )
+	{
+	case OP_SPECOP:
+		switch( op_code.spec_op )
+		{
+		case SpecOp_SLL:	handler = R4300_Decoded_SLL;	break;
+		case SpecOp_SRL:	handler = R4300_Decoded_SRL;	break;
+		case SpecOp_SRA:	handler = R4300_Decoded_SRA;	break;
+		case SpecOp_SLLV:	handler = R4300_Decoded_SLLV;	break;
+		case SpecOp_SRLV:	handler = R4300_Decoded_SRLV;	break;
+		case SpecOp_SRAV:	handler = R4300_Decoded_SRAV;	break;
+		case SpecOp_ADD:	// No overflow exceptions, as R4300_Special_ADD/SUB
+		case SpecOp_ADDU:	handler = R4300_Decoded_ADDU;	break;
+		case SpecOp_SUB:
+		case SpecOp_SUBU:	handler = R4300_Decoded_SUBU;	break;
+		case SpecOp_AND:	handler = R4300_Decoded_AND;	break;
+		case SpecOp_OR:		handler = R4300_Decoded_OR;		break;
+		case SpecOp_XOR:	handler = R4300_Decoded_XOR;	break;
+		case SpecOp_NOR:	handler = R4300_Decoded_NOR;	break;
+		case SpecOp_SLT:	handler = R4300_Decoded_SLT;	break;
+		case SpecOp_SLTU:	handler = R4300_Decoded_SLTU;	break;
+		case SpecOp_DADDU:	handler = R4300_Decoded_DADDU;	break;
+		case SpecOp_MFHI:	handler = R4300_Decoded_MFHI;	break;
+		case SpecOp_MFLO:	handler = R4300_Decoded_MFLO;	break;
+		case SpecOp_DSLL32:	handler = R4300_Decoded_DSLL32;	break;
+		case SpecOp_DSRA32:	handler = R4300_Decoded_DSRA32;	break;
+		default:
+			break;
+		}
+		break;
+
+	case OP_ADDI:		// No overflow exceptions, as R4300_ADDI/DADDI
+	case OP_ADDIU:		handler = R4300_Decoded_ADDIU;	break;
+	case OP_DADDI:
+	case OP_DADDIU:		handler = R4300_Decoded_DADDIU;	break;
+	case OP_SLTI:		handler = R4300_Decoded_SLTI;	break;
+	case OP_SLTIU:		handler = R4300_Decoded_SLTIU;	break;
+	case OP_ANDI:		handler = R4300_Decoded_ANDI;	immediate = (u16)op_code.immediate;			break;
+	case OP_ORI:		handler = R4300_Decoded_ORI;	immediate = (u16)op_code.immediate;			break;
+	case OP_XORI:		handler = R4300_Decoded_XORI;	immediate = (u16)op_code.immediate;			break;
+	case OP_LUI:		handler = R4300_Decoded_LUI;	immediate = (s32)( (u32)op_code.immediate << 16 );	break;
+
+	default:
+		break;
+	}
+
+	if( handler != nullptr )
+	{
+		p_operands->Rs = op_code.rs;
+		p_operands->Rt = op_code.rt;
+		p_operands->Rd = op_code.rd;
+		p_operands->Sa = op_code.sa;
+		p_operands->Immediate = immediate;
+	}
+	return handler;
+}
+
 //Used to swap functions(apply hacks) in interpreter mode (used for the PSP only)
 void R4300_Init()
 {
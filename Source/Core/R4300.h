@@ -34,6 +34,9 @@ inline CPU_Instruction	R4300_GetDInstructionHandler( OpCode op_code )
 }
 
 CPU_Instruction	R4300_GetInstructionHandler( OpCode op_code );
+CPU_Instruction	R4300_GetPredecodedHandler( OpCode op_code );
+bool			R4300_IsSimpleOp( OpCode op_code );
+CPU_DecodedInstruction	R4300_GetDecodedHandler( OpCode op_code, SDecodedOperands * p_operands );
 bool			R4300_InstructionHandlerNeedsPC( OpCode op_code );
 inline void			R4300_ExecuteInstruction( OpCode op_code )
 {
@@ -33,5 +33,19 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 typedef void (R4300_CALL_TYPE *CPU_Instruction )( R4300_CALL_SIGNATURE );
 
+// Ops that are run over and over from the interpreter cache get their fields
+// pulled out once, when they're decoded, rather than every time they execute.
+// Immediate is already sign or zero extended as the op needs (and shifted, for LUI)
+struct SDecodedOperands
+{
+	u8		Rs;
+	u8		Rt;
+	u8		Rd;
+	u8		Sa;
+	s32		Immediate;
+};
+
+typedef void (R4300_CALL_TYPE *CPU_DecodedInstruction )( const SDecodedOperands & operands );
+
 
 #endif // CORE_R4300INSTRUCTION_H_
@@ -21,6 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "RSP_HLE.h"
 
+#include "AudioTask.h"
+#include "GraphicsTask.h"
 #include "Interrupt.h"
 #include "Memory.h"
 #include "Debug/DBGConsole.h"
@@ -162,15 +164,13 @@ static EProcessResult RSP_HLE_Graphics()
 
 	if (gGraphicsEnabled && gGraphicsPlugin != nullptr)
 	{
-		gGraphicsPlugin->ProcessDList();
-	}
-	else
-	{
-		// Skip the entire dlist if graphics are disabled
-		Memory_MI_SetRegisterBits(MI_INTR_REG, MI_INTR_DP);
-		R4300_Interrupt_UpdateCause3();
+		// Signals the task is done itself, possibly later on
+		return GraphicsTask_Start();
 	}
 
+	// Skip the entire dlist if graphics are disabled
+	Memory_MI_SetRegisterBits(MI_INTR_REG, MI_INTR_DP);
+	R4300_Interrupt_UpdateCause3();
 
 #ifdef DAEDALUS_BATCH_TEST_ENABLED
 	if (CBatchTestEventHandler * handler = BatchTest_GetHandler())
@@ -212,7 +212,7 @@ EProcessResult RSP_HLE_Jpeg(OSTask * task)
 {
 	// most ucode_boot procedure copy 0xf80 bytes of ucode whatever the ucode_size is.
 	// For practical purpose we use a ucode_size = min(0xf80, task->ucode_size)
-	u32 sum = sum_bytes(g_pu8RamBase + (u32)task->t.ucode , Min<u32>(task->t.ucode_size, 0xf80) >> 1);
+	u32 sum = sum_bytes(g_pu8RamBase + task->t.ucode , Min<u32>(task->t.ucode_size, 0xf80) >> 1);
 
 	//DBGConsole_Msg(0, "JPEG Task: Sum=0x%08x", sum);
 	switch(sum)
@@ -267,7 +267,7 @@ EProcessResult RSP_HLE_CICX105(OSTask * task)
 
 EProcessResult RSP_HLE_RE2(OSTask * task)
 {
-	u32 sum = sum_bytes(g_pu8RamBase + (u32)task->t.ucode, 256);
+	u32 sum = sum_bytes(g_pu8RamBase + task->t.ucode, 256);
 
 	switch(sum)
 	{
@@ -290,6 +290,10 @@ EProcessResult RSP_HLE_RE2(OSTask * task)
 
 void RSP_HLE_ProcessTask()
 {
+	// Only one task runs at a time
+	GraphicsTask_Finish();
+	AudioTask_Finish();
+
 	OSTask * pTask = (OSTask *)(g_pu8SpMemBase + 0x0FC0);
 
 	EProcessResult	result( PR_NOT_STARTED );
@@ -309,7 +313,7 @@ void RSP_HLE_ProcessTask()
 			if(Memory_DPC_GetRegister(DPC_STATUS_REG) & DPC_STATUS_FREEZE)
 				return;
 			
-			if ((u32*)(pTask->t.data_ptr) == nullptr) {
+			if (pTask->t.data_ptr == 0) {
 				result = RSP_HLE_RE2(pTask);
 			} else {
 				result = RSP_HLE_Graphics();
@@ -36,4 +36,7 @@ enum EProcessResult
 
 void RSP_HLE_ProcessTask();
 
+// Sets the SP status bits for a finished task, and the SP interrupt if it breaks
+void RSP_HLE_Finished(u32 setbits);
+
 #endif // CORE_RSP_HLE_H_
@@ -20,6 +20,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "stdafx.h"
 
 #include "TLB.h"
+
+#include <string.h>
+
 #include "CPU.h"
 #include "Debug/DebugLog.h"
 #include "Debug/DBGConsole.h"
@@ -28,6 +31,54 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 ALIGNED_GLOBAL(TLBEntry, g_TLBs[32], CACHE_ALIGN);
 
+//*****************************************************************************
+//	Translation cache. Remembers the physical page for recently translated 4k
+//	virtual pages, so mapped accesses don't have to walk all 32 tlb entries.
+//	The asid is part of the tag, so switching address space never returns a
+//	stale page. Writing a tlb entry drops the pages covered by both its old and
+//	new mapping.
+//*****************************************************************************
+namespace
+{
+	const u32	TLB_CACHE_ENTRIES {256};
+	const u32	TLB_CACHE_PAGE_SHIFT {12};
+	const u32	TLB_CACHE_PAGE_MASK {(1 << TLB_CACHE_PAGE_SHIFT) - 1};
+	const u32	TLB_CACHE_VALID {0x100};		// Above the asid bits
+
+	struct TLBCacheEntry
+	{
+		u32		Tag;				// Virtual page | asid | TLB_CACHE_VALID
+		u32		PhysicalPage;
+	};
+
+	TLBCacheEntry	gTLBCache[ TLB_CACHE_ENTRIES ];
+
+	// Drops the pages from address to address + mask
+	void	InvalidateTranslationCacheRange( u32 address, u32 mask )
+	{
+		u32		num_pages {(mask >> TLB_CACHE_PAGE_SHIFT) + 1};
+		if (num_pages >= TLB_CACHE_ENTRIES)
+		{
+			memset( gTLBCache, 0, sizeof( gTLBCache ) );
+			return;
+		}
+
+		u32		page {address & ~TLB_CACHE_PAGE_MASK};
+		for (u32 i {}; i < num_pages; ++i, page += (1 << TLB_CACHE_PAGE_SHIFT))
+		{
+			TLBCacheEntry &	entry {gTLBCache[ (page >> TLB_CACHE_PAGE_SHIFT) & (TLB_CACHE_ENTRIES - 1) ]};
+			if ((entry.Tag & ~TLB_CACHE_PAGE_MASK) == page)
+			{
+				entry.Tag = 0;
+			}
+		}
+	}
+}
+
+u64		gTLBCacheHits {};
+u64		gTLBCacheMisses {};
+u32		gTLBCacheInvalidations {};
+
 void TLBEntry::UpdateValue(u32 _pagemask, u32 _hi, u32 _pfno, u32 _pfne)
 {
 	// From the R4300i Instruction manual:
@@ -37,6 +88,10 @@ void TLBEntry::UpdateValue(u32 _pagemask, u32 _hi, u32 _pfno, u32 _pfne)
 	// TLB[INDEX] <- PageMask || (EntryHi AND NOT PageMask) || EntryLo1 || EntryLo0
 	DPF( DEBUG_TLB, "PAGEMASK: 0x%08x ENTRYHI: 0x%08x. ENTRYLO1: 0x%08x. ENTRYLO0: 0x%08x", _pagemask, _hi, _pfno, _pfne);
 
+	// Forget any pages translated through the old mapping
+	InvalidateTranslationCacheRange( addrcheck, mask );
+	gTLBCacheInvalidations++;
+
 	pagemask = _pagemask;
 	hi = _hi;
 	pfne = _pfne;
@@ -55,6 +110,9 @@ void TLBEntry::UpdateValue(u32 _pagemask, u32 _hi, u32 _pfno, u32 _pfne)
 	pfnehi = ((pfne<<TLBLO_PFNSHIFT) & vpn2mask);
 	pfnohi = ((pfno<<TLBLO_PFNSHIFT) & vpn2mask);
 
+	// And any that another entry translated, which this one might now overlap
+	InvalidateTranslationCacheRange( addrcheck, mask );
+
 	switch (pagemask)
 	{
 	case TLBPGMASK_4K:	// 4k
@@ -154,7 +212,46 @@ inline bool	TLBEntry::FindTLBEntry( u32 address, u32 * p_idx )
 //*****************************************************************************
 //
 //*****************************************************************************
+void TLBEntry::InvalidateTranslationCache()
+{
+	memset( gTLBCache, 0, sizeof( gTLBCache ) );
+	gTLBCacheInvalidations++;
+}
+
+//*****************************************************************************
+//	Pages are at least 4k, so everything in a 4k virtual page maps to the same
+//	4k physical page. Only successful lookups are cached, misses and invalid
+//	entries go through the tlb each time.
+//*****************************************************************************
 u32 TLBEntry::Translate(u32 address, bool& missing)
+{
+	TLBCacheEntry &	entry {gTLBCache[ (address >> TLB_CACHE_PAGE_SHIFT) & (TLB_CACHE_ENTRIES - 1) ]};
+	u32				tag {(address & ~TLB_CACHE_PAGE_MASK) | (gCPUState.CPUControl[C0_ENTRYHI]._u32 & TLBHI_PIDMASK) | TLB_CACHE_VALID};
+
+	if (entry.Tag == tag)
+	{
+		gTLBCacheHits++;
+		missing = false;
+		return entry.PhysicalPage | (address & TLB_CACHE_PAGE_MASK);
+	}
+
+	gTLBCacheMisses++;
+
+	// A result of 0 means the access faults. (A hit in a page based at 0 gives
+	// 0 for the first word too, which is what the tlb walk returns for it.)
+	u32 physical_addr {TranslateUncached(address, missing)};
+	if (physical_addr != 0)
+	{
+		entry.Tag = tag;
+		entry.PhysicalPage = physical_addr & ~TLB_CACHE_PAGE_MASK;
+	}
+	return physical_addr;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 TLBEntry::TranslateUncached(u32 address, bool& missing)
 {
 	u32 iMatched {};
 
@@ -43,6 +43,14 @@ public:
 	void UpdateValue(u32 _pagemask, u32 _hi, u32 _pfne, u32 _pfno);
 	void Reset();
 	static u32 Translate(u32 address, bool& missing);
+
+	// Translate without the translation cache (walks the tlb every time)
+	static u32 TranslateUncached(u32 address, bool& missing);
+	static void InvalidateTranslationCache();
 };
 
 ALIGNED_EXTERN(TLBEntry, g_TLBs[32], CACHE_ALIGN);
+
+extern u64		gTLBCacheHits;
+extern u64		gTLBCacheMisses;
+extern u32		gTLBCacheInvalidations;
@@ -0,0 +1,217 @@
+/*
+Copyright (C) 2009 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Micro-benchmark for the tlb translation cache. The tlb is filled with 32
+//	entries the way a game using mapped memory would set it up, then streams
+//	of mapped addresses are translated once by walking the tlb and once
+//	through the translation cache. Both must give the same physical addresses.
+//
+
+#include "stdafx.h"
+#include "Core/CPU.h"
+#include "Core/TLB.h"
+#include "OSHLE/ultra_R4300.h"
+#include "Utility/Timing.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+namespace
+{
+	const u32	kStreamLength = 4*1024*1024;
+	const u32	kVirtualBase = 0x7F000000;
+	const u32	kPhysicalBase = 0x00400000;
+	const u32	kNumEntries = 32;
+
+	class CRandom
+	{
+	public:
+		explicit CRandom( u32 seed ) : mState( seed ) {}
+
+		u32		Next()
+		{
+			mState ^= mState << 13;
+			mState ^= mState >> 17;
+			mState ^= mState << 5;
+			return mState;
+		}
+
+	private:
+		u32		mState;
+	};
+
+	struct SResult
+	{
+		f64		NsPerTranslate;
+		u32		Checksum;
+		u32		Faults;
+	};
+
+	//
+	//	Each entry maps an even/odd pair of pages. Entries are written in a shuffled order
+	//	so matches aren't always found near the start of the walk.
+	//
+	void	SetupTLB( u32 pagemask, bool global )
+	{
+		const u32	page_size( (pagemask | 0x1fff) + 1 );		// Size of the even/odd pair
+		CRandom		rng( 0x2468ace );
+
+		u32		order[ kNumEntries ];
+		for( u32 i = 0; i < kNumEntries; ++i )
+		{
+			order[ i ] = i;
+		}
+		for( u32 i = kNumEntries - 1; i > 0; --i )
+		{
+			u32		j( rng.Next() % (i + 1) );
+			u32		t( order[ i ] );
+			order[ i ] = order[ j ];
+			order[ j ] = t;
+		}
+
+		for( u32 i = 0; i < kNumEntries; ++i )
+		{
+			u32		vaddr( kVirtualBase + order[ i ] * page_size );
+			u32		paddr( kPhysicalBase + i * page_size );
+			u32		flags( TLBLO_V | TLBLO_D | (global ? TLBLO_G : 0) );
+			u32		pfne( ((paddr >> 12) << TLBLO_PFNSHIFT) | flags );
+			u32		pfno( (((paddr + page_size / 2) >> 12) << TLBLO_PFNSHIFT) | flags );
+
+			g_TLBs[ i ].UpdateValue( pagemask, vaddr, pfno, pfne );
+		}
+	}
+
+	//
+	//	Mostly sequential word accesses that hop to a random page every so often, which is
+	//	roughly what code and data in mapped memory looks like
+	//
+	void	GenerateStream( std::vector< u32 > & stream, u32 mapped_size, u32 run_length, u32 seed )
+	{
+		CRandom		rng( seed );
+		u32			address( kVirtualBase );
+
+		stream.resize( kStreamLength );
+		for( u32 i = 0; i < kStreamLength; ++i )
+		{
+			if( run_length == 0 || (rng.Next() % run_length) == 0 )
+			{
+				address = kVirtualBase + ((rng.Next() % mapped_size) & ~3u);
+			}
+			else
+			{
+				address = kVirtualBase + ((address - kVirtualBase + 4) % mapped_size);
+			}
+			stream[ i ] = address;
+		}
+	}
+
+	template< bool Cached >
+	SResult	Run( const std::vector< u32 > & stream, u32 asid_switch_interval )
+	{
+		SResult		result = { 0.0, 0, 0 };
+
+		TLBEntry::InvalidateTranslationCache();
+
+		u64		freq( 0 ), start( 0 ), end( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+		NTiming::GetPreciseTime( &start );
+
+		for( u32 i = 0; i < stream.size(); ++i )
+		{
+			// Flip between two asids, like a context switch would
+			if( asid_switch_interval != 0 && (i % asid_switch_interval) == 0 )
+			{
+				gCPUState.CPUControl[C0_ENTRYHI]._u32 ^= 1;
+			}
+
+			bool	missing;
+			u32		physical( Cached ? TLBEntry::Translate( stream[ i ], missing ) : TLBEntry::TranslateUncached( stream[ i ], missing ) );
+			if( physical == 0 )
+			{
+				result.Faults++;
+			}
+			result.Checksum = (result.Checksum * 33) ^ physical;
+		}
+
+		NTiming::GetPreciseTime( &end );
+
+		gCPUState.CPUControl[C0_ENTRYHI]._u32 = 0;
+
+		result.NsPerTranslate = (f64( end - start ) * 1e9 / f64( freq )) / f64( stream.size() );
+		return result;
+	}
+}
+
+int main()
+{
+	struct SWorkload
+	{
+		const char *	Name;
+		u32				PageMask;
+		u32				MappedPairs;		// How many of the 32 entries the stream touches
+		u32				RunLength;			// Average accesses before jumping to a random address
+		u32				AsidSwitch;			// Accesses between asid changes (0 for none)
+		bool			Global;				// Whether the entries match every asid
+	};
+
+	static const SWorkload	workloads[] =
+	{
+		{ "4k sequential",	TLBPGMASK_4K,	32,	256,	0,		false },
+		{ "4k random",		TLBPGMASK_4K,	32,	0,		0,		false },
+		{ "4k hot set",		TLBPGMASK_4K,	4,	16,		0,		false },
+		{ "64k random",		TLBPGMASK_64K,	32,	0,		0,		false },
+		{ "4k asid switch",	TLBPGMASK_4K,	32,	256,	4096,	true },
+		{ "4k unmapped",	TLBPGMASK_4K,	32,	256,	4096,	false },
+	};
+
+	printf( "TLB translation cache: %u translations per run\n\n", kStreamLength );
+	printf( "%-16s %12s %12s %9s %10s %10s %8s\n", "workload", "walk ns/op", "cache ns/op", "speedup", "hit rate", "faults", "match" );
+
+	for( u32 w = 0; w < sizeof( workloads ) / sizeof( workloads[0] ); ++w )
+	{
+		const SWorkload &	workload( workloads[ w ] );
+		const u32			pair_size( (workload.PageMask | 0x1fff) + 1 );
+
+		gCPUState.CPUControl[C0_ENTRYHI]._u32 = 0;
+		SetupTLB( workload.PageMask, workload.Global );
+
+		std::vector< u32 >	stream;
+		GenerateStream( stream, workload.MappedPairs * pair_size, workload.RunLength, 0x1234567 + w );
+
+		SResult		walk_result( Run< false >( stream, workload.AsidSwitch ) );
+
+		u64			hits_before( gTLBCacheHits );
+		u64			misses_before( gTLBCacheMisses );
+		SResult		cache_result( Run< true >( stream, workload.AsidSwitch ) );
+		u64			hits( gTLBCacheHits - hits_before );
+		u64			misses( gTLBCacheMisses - misses_before );
+
+		printf( "%-16s %12.2f %12.2f %8.2fx %9.2f%% %10u %8s\n",
+			workload.Name,
+			walk_result.NsPerTranslate, cache_result.NsPerTranslate,
+			cache_result.NsPerTranslate > 0.0 ? walk_result.NsPerTranslate / cache_result.NsPerTranslate : 0.0,
+			hits + misses ? 100.0 * f64( hits ) / f64( hits + misses ) : 0.0,
+			cache_result.Faults,
+			walk_result.Checksum == cache_result.Checksum && walk_result.Faults == cache_result.Faults ? "yes" : "NO" );
+	}
+
+	return 0;
+}
@@ -35,6 +35,10 @@ public:
 	virtual	CCodeGenerator *		StartNewBlock() = 0;
 	virtual	u32						FinaliseCurrentBlock() = 0;
 
+	// True once the space left might not fit the largest block a trace can produce.
+	// The cache must be cleared (which calls Reset()) before starting another block
+	virtual	bool					IsNearlyFull() const = 0;
+
 public:
 	static	CCodeBufferManager *	Create();
 };
@@ -61,7 +61,8 @@ class CCodeGenerator
 		virtual CCodeLabel			GetCurrentLocation() const = 0;
 //		virtual u32					GetCompiledCodeSize() const = 0;
 
-		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment ) = 0;
+		// p_fallback receives the location the returned jump targets while it isn't linked to another fragment
+		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment, CCodeLabel * p_fallback ) = 0;
 		virtual void				GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map ) = 0;
 		virtual void				GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map ) = 0;
 
@@ -105,6 +105,14 @@ CFragment::CFragment( CCodeBufferManager * p_manager,
 #endif
 
 	Assemble( p_manager, exit_address, trace, branch_details, register_usage );
+
+	// Traces can branch around, so record each page actually compiled rather than the entry address span
+	for( u32 i {}; i < trace.size(); ++i )
+	{
+		AddCodePages( trace[ i ].Address, sizeof( OpCode ) );
+	}
+	std::sort( mCodePages.begin(), mCodePages.end() );
+	mCodePages.erase( std::unique( mCodePages.begin(), mCodePages.end() ), mCodePages.end() );
 }
 
 #ifdef DAEDALUS_ENABLE_OS_HOOKS
@@ -129,6 +137,8 @@ CFragment::CFragment(CCodeBufferManager * p_manager, u32 entry_address,
 #endif
 {
 	Assemble(p_manager, CCodeLabel(function_Ptr));
+
+	AddCodePages( entry_address, mInputLength );
 }
 #endif
 //*************************************************************************************
@@ -526,6 +536,7 @@ u32	CFragment::GetMemoryUsage() const
 	// Ignore the 'additional info' when computing this
 
 	return sizeof( CFragment ) +
+		   mCodePages.size() * sizeof( u32 ) +
 		   mPatchList.size() * sizeof( SFragmentPatchDetails );
 }
 
@@ -552,7 +563,7 @@ namespace
 //*************************************************************************************
 //
 //*************************************************************************************
-void	CFragment::AddPatch( u32 address, CJumpLocation jump_location )
+void	CFragment::AddPatch( u32 address, CJumpLocation jump_location, CCodeLabel fallback )
 {
 	if( jump_location.IsSet() )
 	{
@@ -560,11 +571,29 @@ void	CFragment::AddPatch( u32 address, CJumpLocation jump_location )
 
 		patch_details.Address = address;
 		patch_details.Jump = jump_location;
+		patch_details.Fallback = fallback;
 
 		mPatchList.push_back( patch_details );
 	}
 }
 
+//*************************************************************************************
+//
+//*************************************************************************************
+void	CFragment::AddCodePages( u32 address, u32 length )
+{
+	u32		first_page( CFragmentCacheCoverage::AddressToPage( address ) );
+	u32		last_page( CFragmentCacheCoverage::AddressToPage( address + length - 1 ) );
+
+	for( u32 page = first_page; page <= last_page && page < CFragmentCacheCoverage::NUM_PAGES; ++page )
+	{
+		if( mCodePages.empty() || mCodePages.back() != page )
+		{
+			mCodePages.push_back( page );
+		}
+	}
+}
+
 
 //*************************************************************************************
 //
@@ -732,9 +761,10 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 #endif
 
 	CCodeLabel		no_next_fragment( nullptr );
-	CJumpLocation	exit_jump( p_generator->GenerateExitCode( exit_address, NO_JUMP_ADDRESS, trace.size(), no_next_fragment ) );
+	CCodeLabel		exit_fallback( nullptr );
+	CJumpLocation	exit_jump( p_generator->GenerateExitCode( exit_address, NO_JUMP_ADDRESS, trace.size(), no_next_fragment, &exit_fallback ) );
 
-	AddPatch( exit_address, exit_jump );
+	AddPatch( exit_address, exit_jump, exit_fallback );
 
 	//
 	//	Generate handlers for each exit branch
@@ -800,26 +830,28 @@ void CFragment::Assemble( CCodeBufferManager * p_manager,
 		{
 			u32				exit_address {};
 			CJumpLocation	jump_location {};
+			CCodeLabel		fallback( nullptr );
 
 			if( details.ConditionalBranchTaken )
 			{
 				exit_address = branch_instruction_address + 8;
-				jump_location = p_generator->GenerateExitCode( exit_address, NO_JUMP_ADDRESS, num_instructions_executed, no_next_fragment );
+				jump_location = p_generator->GenerateExitCode( exit_address, NO_JUMP_ADDRESS, num_instructions_executed, no_next_fragment, &fallback );
 			}
 			else
 			{
 				exit_address = branch_instruction_address + 4;
-				jump_location = p_generator->GenerateExitCode( exit_address, details.TargetAddress, num_instructions_executed, no_next_fragment );
+				jump_location = p_generator->GenerateExitCode( exit_address, details.TargetAddress, num_instructions_executed, no_next_fragment, &fallback );
 			}
 
-			AddPatch( exit_address, jump_location );
+			AddPatch( exit_address, jump_location, fallback );
 		}
 		else if( details.Direct )
 		{
 			u32				exit_address( details.TargetAddress );
-			CJumpLocation	jump_location( p_generator->GenerateExitCode( details.TargetAddress, NO_JUMP_ADDRESS, num_instructions_executed, no_next_fragment ) );
+			CCodeLabel		fallback( nullptr );
+			CJumpLocation	jump_location( p_generator->GenerateExitCode( details.TargetAddress, NO_JUMP_ADDRESS, num_instructions_executed, no_next_fragment, &fallback ) );
 
-			AddPatch( exit_address, jump_location );
+			AddPatch( exit_address, jump_location, fallback );
 		}
 		else
 		{
@@ -54,6 +54,7 @@ struct SFragmentPatchDetails
 {
 	u32				Address;
 	CJumpLocation	Jump;
+	CCodeLabel		Fallback;		// Where Jump goes when it isn't linked to another fragment
 };
 typedef std::vector<SFragmentPatchDetails>	FragmentPatchList;
 
@@ -89,7 +90,9 @@ public:
 		void		SetCache( const CFragmentCache * p_cache );
 
 		const FragmentPatchList &	GetPatchList() const		{ return mPatchList; }
-		void		DiscardPatchList()							{ mPatchList.clear(); }
+
+		// The 4k pages of rdram this fragment was built from, for selective invalidation
+		const std::vector< u32 > &	GetCodePages() const		{ return mCodePages; }
 
 #ifdef FRAGMENT_RETAIN_ADDITIONAL_INFO
 		u32			GetHitCount() const							{ return mHitCount; }
@@ -102,7 +105,8 @@ private:
 		void		Analyse( const std::vector< STraceEntry > & trace, SRegisterUsageInfo & register_usage );
 		void		Assemble( CCodeBufferManager * p_manager, u32 exit_address, const std::vector< STraceEntry > & trace, const std::vector<SBranchDetails> & branch_details, const SRegisterUsageInfo & register_usage );
 
-		void		AddPatch( u32 address, CJumpLocation jump_location );
+		void		AddPatch( u32 address, CJumpLocation jump_location, CCodeLabel fallback );
+		void		AddCodePages( u32 address, u32 length );
 
 #ifdef FRAGMENT_SIMULATE_EXECUTION
 		CFragment *	Simulate();
@@ -112,6 +116,7 @@ private:
 		u32								mEntryAddress;
 
 		std::vector< SFragmentPatchDetails >	mPatchList;
+		std::vector< u32 >						mCodePages;
 
 		CCodeLabel						mEntryPoint;
 		u32								mInputLength;
@@ -35,10 +35,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "AssemblyUtils.h"
 
-
-//Define to show hash table statistics cache hit/miss
-//#define HASH_TABLE_STATS
-
 using namespace AssemblyUtils;
 
 //*************************************************************************************
@@ -48,10 +44,14 @@ CFragmentCache::CFragmentCache()
 :	mMemoryUsage( 0 )
 ,	mInputLength( 0 )
 ,	mOutputLength( 0 )
-,	mCachedFragmentAddress( 0 )
-,	mpCachedFragment( nullptr )
+,	mLookupHits( 0 )
+,	mLookupVictimHits( 0 )
+,	mLookupMisses( 0 )
+,	mEvictions( 0 )
+,	mFullInvalidations( 0 )
+,	mPartialInvalidations( 0 )
 {
-	memset( mpCacheHashTable, 0, sizeof(mpCacheHashTable) );
+	ResetHashTable();
 
 	mFragments.reserve( 2000 );
 
@@ -81,99 +81,186 @@ CFragment * CFragmentCache::LookupFragment( u32 address ) const
 {
 	DAEDALUS_PROFILE( "CFragmentCache::LookupFragment" );
 
-	if( address != mCachedFragmentAddress )
+	CFragment * p = LookupFragmentQ( address );
+
+	DYNAREC_PROFILE_LOGLOOKUP( address, p );
+
+	return p;
+}
+#endif
+//*************************************************************************************
+//
+//*************************************************************************************
+namespace
+{
+	// Writes entry into way, shuffling the more recently used ways down to make room
+	template< typename Entry >
+	inline void MoveToFront( Entry * set, u32 way, const Entry & entry )
+	{
+		for( u32 i = way; i > 0; --i )
+		{
+			set[ i ] = set[ i - 1 ];
+		}
+		set[ 0 ] = entry;
+	}
+
+	// The least recently used empty or failed lookup entry, or num_ways if every way holds a fragment
+	template< typename Entry >
+	inline u32 FindReplaceableWay( const Entry * set, u32 num_ways )
 	{
-		mCachedFragmentAddress = address;
+		for( u32 i = num_ways; i > 0; --i )
+		{
+			if( set[ i - 1 ].Fragment == nullptr )
+			{
+				return i - 1;
+			}
+		}
+		return num_ways;
+	}
+}
 
-		// check if in hash table
-		u32 ix = MakeHashIdx( address );
+//*************************************************************************************
+//	A hit on a cached failed lookup returns nullptr without going any further. Only
+//	addresses the set knows nothing about are looked for in the victim buffer
+//*************************************************************************************
+CFragment * CFragmentCache::LookupFragmentQ( u32 address ) const
+{
+	SFragmentHashEntry * set( mpCacheHashTable[ MakeHashIdx( address ) ] );
 
-		if ( address != mpCacheHashTable[ix].addr )
+	for( u32 i = 0; i < HASH_TABLE_WAYS; ++i )
+	{
+		if( set[ i ].Address == address )
 		{
-			SFragmentEntry				entry( address, nullptr );
-			FragmentVec::const_iterator	it( std::lower_bound( mFragments.begin(), mFragments.end(), entry ) );
-			if( it != mFragments.end() && it->Address == address )
+			SFragmentHashEntry	hit( set[ i ] );
+			if( i > 0 )
+			{
+				MoveToFront( set, i, hit );
+			}
+
+			if( hit.Fragment != nullptr )
 			{
-				mpCachedFragment = it->Fragment;
+				mLookupHits++;
 			}
 			else
 			{
-				mpCachedFragment = nullptr;
+				mLookupMisses++;
 			}
-
-			// put in hash table
-			mpCacheHashTable[ix].addr = address;
-			mpCacheHashTable[ix].ptr = reinterpret_cast< u32 >( mpCachedFragment );
+			return hit.Fragment;
 		}
-		else
+	}
+
+	for( u32 i = 0; i < mVictims.size(); ++i )
+	{
+		if( mVictims[ i ].Address == address )
 		{
-			mpCachedFragment = reinterpret_cast< CFragment * >( mpCacheHashTable[ix].ptr );
+			CFragment *	p_fragment( mVictims[ i ].Fragment );
+			mVictims[ i ] = mVictims.back();
+			mVictims.pop_back();
+
+			AddToHashTable( address, p_fragment );
+
+			mLookupHits++;
+			mLookupVictimHits++;
+			return p_fragment;
 		}
 	}
 
-	CFragment * p = mpCachedFragment;
-
-	DYNAREC_PROFILE_LOGLOOKUP( address, p );
+	// Remember the miss, unless that would push a fragment out of the set
+	u32		way( FindReplaceableWay( set, HASH_TABLE_WAYS ) );
+	if( way < HASH_TABLE_WAYS )
+	{
+		SFragmentHashEntry	miss = { address, nullptr };
+		MoveToFront( set, way, miss );
+	}
 
-	return p;
+	mLookupMisses++;
+	return nullptr;
 }
-#endif
+
 //*************************************************************************************
-//
+//	New entries go in way 0. They replace a cached miss for the same address if there
+//	is one, otherwise the LRU empty or miss entry. If the set is all fragments, the
+//	LRU one moves to the victim buffer
 //*************************************************************************************
-CFragment * CFragmentCache::LookupFragmentQ( u32 address ) const
+void CFragmentCache::AddToHashTable( u32 address, CFragment * p_fragment ) const
 {
-	#ifdef DAEDALUS_DEBUG_DYNAREC
-	DAEDALUS_PROFILE( "CFragmentCache::LookupFragmentQ" );
-	#endif
-#ifdef HASH_TABLE_STATS
-	static u32 hit=0, miss=0;
-#endif
-	if( address != mCachedFragmentAddress )
+	SFragmentHashEntry * set( mpCacheHashTable[ MakeHashIdx( address ) ] );
+
+	u32		way( HASH_TABLE_WAYS );
+	for( u32 i = 0; i < HASH_TABLE_WAYS; ++i )
+	{
+		if( set[ i ].Address == address )
+		{
+			#ifdef DAEDALUS_ENABLE_ASSERTS
+			DAEDALUS_ASSERT( set[ i ].Fragment == nullptr, "A fragment with this address is already in the hash table" );
+			#endif
+			way = i;
+			break;
+		}
+	}
+
+	if( way == HASH_TABLE_WAYS )
 	{
-		mCachedFragmentAddress = address;
+		way = FindReplaceableWay( set, HASH_TABLE_WAYS );
+		if( way == HASH_TABLE_WAYS )
+		{
+			way = HASH_TABLE_WAYS - 1;
+			mVictims.push_back( set[ way ] );
+			mEvictions++;
+		}
+	}
+
+	SFragmentHashEntry	entry = { address, p_fragment };
+	MoveToFront( set, way, entry );
+}
 
-		// check if in hash table
-		u32 ix {MakeHashIdx( address )};
+//*************************************************************************************
+//	Drops the entry for address from its set (keeping the others in LRU order) or
+//	from the victim buffer
+//*************************************************************************************
+void CFragmentCache::RemoveFromHashTable( u32 address ) const
+{
+	SFragmentHashEntry * set( mpCacheHashTable[ MakeHashIdx( address ) ] );
 
-		if ( address != mpCacheHashTable[ix].addr )
+	for( u32 i = 0; i < HASH_TABLE_WAYS; ++i )
+	{
+		if( set[ i ].Address == address )
 		{
-#ifdef HASH_TABLE_STATS
-			miss++;
-#endif
-			SFragmentEntry				entry( address, nullptr );
-			FragmentVec::const_iterator	it( std::lower_bound( mFragments.begin(), mFragments.end(), entry ) );
-			if( it != mFragments.end() && it->Address == address )
-			{
-				mpCachedFragment = it->Fragment;
-			}
-			else
+			for( u32 j = i; j < HASH_TABLE_WAYS - 1; ++j )
 			{
-				mpCachedFragment = nullptr;
+				set[ j ] = set[ j + 1 ];
 			}
-
-			// put in hash table
-			mpCacheHashTable[ix].addr = address;
-			mpCacheHashTable[ix].ptr = reinterpret_cast< u32 >( mpCachedFragment );
+			set[ HASH_TABLE_WAYS - 1 ].Address = EMPTY_ADDRESS;
+			set[ HASH_TABLE_WAYS - 1 ].Fragment = nullptr;
+			return;
 		}
-		else
+	}
+
+	for( u32 i = 0; i < mVictims.size(); ++i )
+	{
+		if( mVictims[ i ].Address == address )
 		{
-#ifdef HASH_TABLE_STATS
-			hit++;
-#endif
-			mpCachedFragment = reinterpret_cast< CFragment * >( mpCacheHashTable[ix].ptr );
+			mVictims[ i ] = mVictims.back();
+			mVictims.pop_back();
+			return;
 		}
+	}
+}
 
-#ifdef HASH_TABLE_STATS
-		if(miss+hit==10000)
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCache::ResetHashTable()
+{
+	for( u32 i = 0; i < HASH_TABLE_SETS; ++i )
+	{
+		for( u32 j = 0; j < HASH_TABLE_WAYS; ++j )
 		{
-			printf("Hit[%d]  Miss[%d]\n", hit, miss);
-			miss=hit=0;
+			mpCacheHashTable[ i ][ j ].Address = EMPTY_ADDRESS;
+			mpCacheHashTable[ i ][ j ].Fragment = nullptr;
 		}
-#endif
 	}
-
-	return mpCachedFragment;
+	mVictims.clear();
 }
 
 //*************************************************************************************
@@ -183,34 +270,33 @@ void CFragmentCache::InsertFragment( CFragment * p_fragment )
 {
 	u32		fragment_address( p_fragment->GetEntryAddress() );
 
-	mCacheCoverage.ExtendCoverage( fragment_address, p_fragment->GetInputLength() );
+	mCacheCoverage.AddFragment( p_fragment );
 
-	SFragmentEntry				entry( fragment_address, nullptr );
+	SFragmentEntry				entry( fragment_address, p_fragment );
 	FragmentVec::iterator		it( std::lower_bound( mFragments.begin(), mFragments.end(), entry ) );
 	#ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( it == mFragments.end() || it->Address != fragment_address, "A fragment with this address already exists" );
 	#endif
-	entry.Fragment = p_fragment;
 	mFragments.insert( it, entry );
 
-	// Update the hash table (it stores failed lookups now, so we need to be sure to purge any stale entries in there
-	u32 ix {MakeHashIdx( fragment_address )};
-	mpCacheHashTable[ix].addr = fragment_address;
-	mpCacheHashTable[ix].ptr = reinterpret_cast< u32 >( p_fragment );
+	// This also replaces any failed lookup cached for the address
+	AddToHashTable( fragment_address, p_fragment );
 
 	// Process any jumps for this before inserting new ones
 	JumpMap::iterator	jump_it( mJumpMap.find( fragment_address ) );
 	if( jump_it != mJumpMap.end() )
 	{
-		const JumpList &		jumps( jump_it->second );
-		for( JumpList::const_iterator it = jumps.begin(); it != jumps.end(); ++it )
+		LinkList &		links( jump_it->second );
+		for( LinkList::iterator it = links.begin(); it != links.end(); ++it )
 		{
-			//DBGConsole_Msg( 0, "Inserting [R%08x], patching jump at %08x ", address, (*it) );
-			PatchJumpLongAndFlush( (*it), p_fragment->GetEntryTarget() );
+			// Jumps already linked to an older fragment for this address are left alone
+			if( it->Target == nullptr )
+			{
+				//DBGConsole_Msg( 0, "Inserting [R%08x], patching jump at %08x ", address, (*it) );
+				PatchJumpLongAndFlush( it->Jump, p_fragment->GetEntryTarget() );
+				it->Target = p_fragment;
+			}
 		}
-
-		// All patched - clear
-		mJumpMap.erase( jump_it );
 	}
 
 	// Finally register any links that this fragment may have
@@ -224,33 +310,35 @@ void CFragmentCache::InsertFragment( CFragment * p_fragment )
 		DAEDALUS_ASSERT( jump.IsSet(), "No exit jump?" );
 		#endif
 
+		if( target_address == u32(~0) )
+		{
+			continue;
+		}
+
 #ifdef DAEDALUS_DEBUG_DYNAREC
-		CFragment * p_fragment( LookupFragment( target_address ) );
+		CFragment * p_target( LookupFragment( target_address ) );
 #else
-		CFragment * p_fragment( LookupFragmentQ( target_address ) );
+		CFragment * p_target( LookupFragmentQ( target_address ) );
 #endif
-		if( p_fragment != nullptr )
-		{
-			PatchJumpLongAndFlush( jump, p_fragment->GetEntryTarget() );
-
-	#ifdef DAEDALUS_ENABLE_ASSERTS
-			DAEDALUS_ASSERT( mJumpMap.find( target_address ) == mJumpMap.end(), "Jump map still contains an entry for this" );
-			#endif
-		}
-		else if( target_address != u32(~0) )
+		if( p_target != nullptr )
 		{
-			// Store the address for later processing
-			mJumpMap[ target_address ].push_back( jump );
+			PatchJumpLongAndFlush( jump, p_target->GetEntryTarget() );
 		}
-	}
 
-	// Free memoire
-	p_fragment->DiscardPatchList();
+		// Store the link for later processing, or for unlinking if the target is invalidated
+		SFragmentLink	link;
+		link.Source = p_fragment;
+		link.Target = p_target;
+		link.Jump = jump;
+		link.Fallback = it->Fallback;
+
+		mJumpMap[ target_address ].push_back( link );
+	}
 
 	// For simulation only
 	p_fragment->SetCache( this );
 
-	// Update memory usage etc after discarding patch list
+	// Update memory usage etc. The patch list is kept, as we need it if the fragment is invalidated
 	mMemoryUsage += p_fragment->GetMemoryUsage();
 	mInputLength += p_fragment->GetInputLength();
 	mOutputLength += p_fragment->GetOutputLength();
@@ -280,6 +368,11 @@ void CFragmentCache::Clear()
 		DBGConsole_Msg( 0, "Clearing fragment cache of %d fragments", mFragments.size() );
 	}
 #endif
+	if( !mFragments.empty() )
+	{
+		mFullInvalidations++;
+	}
+
 	// Clear out all the framents
 	for(FragmentVec::iterator it = mFragments.begin(); it != mFragments.end(); ++it)
 	{
@@ -287,12 +380,11 @@ void CFragmentCache::Clear()
 	}
 
 	mFragments.erase( mFragments.begin(), mFragments.end() );
+	FreeStaleFragments();
 	mMemoryUsage = 0;
 	mInputLength = 0;
 	mOutputLength = 0;
-	mCachedFragmentAddress = 0;
-	mpCachedFragment = nullptr;
-	memset( mpCacheHashTable, 0, sizeof(mpCacheHashTable) );
+	ResetHashTable();
 	mJumpMap.clear();
 
 	mCacheCoverage.Reset();
@@ -300,6 +392,121 @@ void CFragmentCache::Clear()
 	mpCodeBufferManager->Reset();
 }
 
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCache::InvalidateRange( u32 address, u32 length )
+{
+	FragmentList	stale_fragments;
+
+	mCacheCoverage.GetFragments( address, length, stale_fragments );
+	if( stale_fragments.empty() )
+	{
+		return;
+	}
+
+#ifdef DAEDALUS_DEBUG_CONSOLE
+	if(CDebugConsole::IsAvailable())
+	{
+		DBGConsole_Msg( 0, "Invalidating %d fragments for write to %08x (%d bytes)", stale_fragments.size(), address, length );
+	}
+#endif
+
+	for(FragmentList::iterator it = stale_fragments.begin(); it != stale_fragments.end(); ++it)
+	{
+		RemoveFragment( *it );
+	}
+
+	// GetFragments() returns a sorted list, so we can binary search it here. mFragments stays sorted
+	FragmentVec::iterator	new_end( mFragments.begin() );
+	for(FragmentVec::iterator it = mFragments.begin(); it != mFragments.end(); ++it)
+	{
+		if( !std::binary_search( stale_fragments.begin(), stale_fragments.end(), it->Fragment ) )
+		{
+			*new_end++ = *it;
+		}
+	}
+	mFragments.erase( new_end, mFragments.end() );
+
+	mStaleFragments.insert( mStaleFragments.end(), stale_fragments.begin(), stale_fragments.end() );
+
+	mPartialInvalidations++;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCache::FreeStaleFragments()
+{
+	for(FragmentList::iterator it = mStaleFragments.begin(); it != mStaleFragments.end(); ++it)
+	{
+		delete *it;
+	}
+	mStaleFragments.clear();
+}
+
+//*************************************************************************************
+//	Detach a fragment from everything that refers to it. The generated code stays
+//	in the code buffer until the next Clear().
+//*************************************************************************************
+void CFragmentCache::RemoveFragment( CFragment * p_fragment )
+{
+	u32		fragment_address( p_fragment->GetEntryAddress() );
+
+	RemoveFromHashTable( fragment_address );
+
+	// Anything linked to this fragment goes back to its fallback, until the address is recompiled
+	JumpMap::iterator	jump_it( mJumpMap.find( fragment_address ) );
+	if( jump_it != mJumpMap.end() )
+	{
+		LinkList &		links( jump_it->second );
+		for( LinkList::iterator it = links.begin(); it != links.end(); ++it )
+		{
+			if( it->Target == p_fragment )
+			{
+				PatchJumpLongAndFlush( it->Jump, it->Fallback );
+				it->Target = nullptr;
+			}
+		}
+	}
+
+	// Forget about this fragment's own exits
+	const FragmentPatchList &	patch_list( p_fragment->GetPatchList() );
+	for( FragmentPatchList::const_iterator it = patch_list.begin(); it != patch_list.end(); ++it )
+	{
+		JumpMap::iterator	exit_it( mJumpMap.find( it->Address ) );
+		if( exit_it == mJumpMap.end() )
+		{
+			continue;
+		}
+
+		LinkList &		links( exit_it->second );
+		for( u32 i {}; i < links.size(); )
+		{
+			if( links[ i ].Source == p_fragment )
+			{
+				links[ i ] = links.back();
+				links.pop_back();
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		if( links.empty() )
+		{
+			mJumpMap.erase( exit_it );
+		}
+	}
+
+	mCacheCoverage.RemoveFragment( p_fragment );
+
+	mMemoryUsage -= p_fragment->GetMemoryUsage();
+	mInputLength -= p_fragment->GetInputLength();
+	mOutputLength -= p_fragment->GetOutputLength();
+}
+
 //*************************************************************************************
 //
 //*************************************************************************************
@@ -408,20 +615,39 @@ void CFragmentCache::DumpStats( const char * outputdir ) const
 //*************************************************************************************
 //
 //*************************************************************************************
-#define AddressToIndex( addr ) ((addr - BASE_ADDRESS) >> MEM_USAGE_SHIFT)
+void CFragmentCacheCoverage::GetPageRange( u32 address, u32 len, u32 * p_first, u32 * p_last )
+{
+	*p_first = AddressToPage( address );
+	*p_last = AddressToPage( address + (len > 0 ? len - 1 : 0) );
+}
 
 //*************************************************************************************
 //
 //*************************************************************************************
-void CFragmentCacheCoverage::ExtendCoverage( u32 address, u32 len )
+void CFragmentCacheCoverage::AddFragment( CFragment * p_fragment )
 {
-	u32 first_entry( AddressToIndex( address ) );
-	u32 last_entry( AddressToIndex( address + len ) );
+	const std::vector< u32 > &	pages( p_fragment->GetCodePages() );
+	for( u32 i {}; i < pages.size(); ++i )
+	{
+		mPageFragments[ pages[ i ] ].push_back( p_fragment );
+	}
+}
 
-	// Mark all entries as true
-	for( u32 i = first_entry; i <= last_entry && i < NUM_MEM_USAGE_ENTRIES; ++i )
+//*************************************************************************************
+//
+//*************************************************************************************
+void CFragmentCacheCoverage::RemoveFragment( CFragment * p_fragment )
+{
+	const std::vector< u32 > &	pages( p_fragment->GetCodePages() );
+	for( u32 i {}; i < pages.size(); ++i )
 	{
-		mCacheCoverage[ i ] = true;
+		std::vector< CFragment * > &	fragments( mPageFragments[ pages[ i ] ] );
+		std::vector< CFragment * >::iterator	it( std::find( fragments.begin(), fragments.end(), p_fragment ) );
+		if( it != fragments.end() )
+		{
+			*it = fragments.back();
+			fragments.pop_back();
+		}
 	}
 }
 
@@ -431,29 +657,49 @@ void CFragmentCacheCoverage::ExtendCoverage( u32 address, u32 len )
 bool CFragmentCacheCoverage::IsCovered( u32 address, u32 len ) const
 {
 	#ifdef DAEDALUS_DEBUG_CONSOLE
-	if((address - BASE_ADDRESS) == 0)
+	if((address - 0x80000000) == 0)
 	{
 		DBGConsole_Msg( 0, "Cache coverage address is overlapping" );
 		return true;
 	}
 #endif
-	u32 first_entry( AddressToIndex( address ) );
-	u32 last_entry( AddressToIndex( address + len ) );
+	u32 first_page, last_page;
+	GetPageRange( address, len, &first_page, &last_page );
 
-	// Mark all entries as true
-	for( u32 i = first_entry; i <= last_entry && i < NUM_MEM_USAGE_ENTRIES; ++i )
+	for( u32 i = first_page; i <= last_page && i < NUM_PAGES; ++i )
 	{
-		if( mCacheCoverage[ i ] )
+		if( !mPageFragments[ i ].empty() )
 			return true;
 	}
 
 	return false;
 }
 
+//*************************************************************************************
+//	Fills in a sorted list of every fragment built from code in the range
+//*************************************************************************************
+void CFragmentCacheCoverage::GetFragments( u32 address, u32 len, std::vector< CFragment * > & fragments ) const
+{
+	u32 first_page, last_page;
+	GetPageRange( address, len, &first_page, &last_page );
+
+	for( u32 i = first_page; i <= last_page && i < NUM_PAGES; ++i )
+	{
+		fragments.insert( fragments.end(), mPageFragments[ i ].begin(), mPageFragments[ i ].end() );
+	}
+
+	// Fragments spanning several pages appear more than once
+	std::sort( fragments.begin(), fragments.end() );
+	fragments.erase( std::unique( fragments.begin(), fragments.end() ), fragments.end() );
+}
+
 //*************************************************************************************
 //
 //*************************************************************************************
 void CFragmentCacheCoverage::Reset( )
 {
-	memset( mCacheCoverage, 0, sizeof( mCacheCoverage ) );
+	for( u32 i {}; i < NUM_PAGES; ++i )
+	{
+		mPageFragments[ i ].clear();
+	}
 }
@@ -21,44 +21,41 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define DYNAREC_FRAGMENTCACHE_H_
 
 #include "Utility/DaedalusTypes.h"
+#include "AssemblyUtils.h"
 
 class	CFragment;
-class	CJumpLocation;
 class	CCodeBufferManager;
 
 #include <map>
 #include <vector>
 
-struct FHashT
-{
-	u32	addr;
-	u32 ptr;
-};
-
 //*************************************************************************************
-//
+//	Keeps a list of the fragments built from each 4k page of rdram, so that a
+//	write to code only has to throw away the fragments it actually overlaps
 //*************************************************************************************
 class CFragmentCacheCoverage
 {
 public:
-	CFragmentCacheCoverage() { Reset(); }
+	void			AddFragment( CFragment * p_fragment );
+	void			RemoveFragment( CFragment * p_fragment );
 
-	void			ExtendCoverage( u32 address, u32 len );
 	bool			IsCovered( u32 address, u32 len ) const;
+	void			GetFragments( u32 address, u32 len, std::vector< CFragment * > & fragments ) const;
 
 	void			Reset();
 
-private:
-	static u32		AddressToIndex( u32 address );
-
-private:
-	static const u32 BASE_ADDRESS = 0x80000000;
+	// The kseg0/kseg1 mirrors share pages. Anything outside rdram gives a page >= NUM_PAGES
+	static u32		AddressToPage( u32 address )			{ return (address & 0x1FFFFFFF) >> PAGE_SHIFT; }
 
 	static const u32 MEMORY_8_MEG = 8*1024*1024;
-	static const u32 MEM_USAGE_SHIFT = 12;		// 4k
-	static const u32 NUM_MEM_USAGE_ENTRIES = MEMORY_8_MEG >> MEM_USAGE_SHIFT;
+	static const u32 PAGE_SHIFT = 12;		// 4k
+	static const u32 NUM_PAGES = MEMORY_8_MEG >> PAGE_SHIFT;
 
-	bool			mCacheCoverage[ NUM_MEM_USAGE_ENTRIES ];
+private:
+	static void		GetPageRange( u32 address, u32 len, u32 * p_first, u32 * p_last );
+
+private:
+	std::vector< CFragment * >	mPageFragments[ NUM_PAGES ];
 };
 
 //*************************************************************************************
@@ -79,56 +76,112 @@ public:
 	u32						GetCacheSize() const					{ return mFragments.size(); }
 	void					Clear();
 
+	// Unlinks every fragment built from code in the range. This is safe to call from inside
+	// generated code, so they're only freed by a later FreeStaleFragments() (or Clear())
+	void					InvalidateRange( u32 address, u32 length );
+	void					FreeStaleFragments();
+
 #ifdef DAEDALUS_DEBUG_DYNAREC
 	void					DumpStats( const char * outputdir ) const;
 #endif
 
 	u32						GetMemoryUsage() const					{ return mMemoryUsage; }
 
+	// Lookup statistics, accumulated across Clear(). Hits include those found in the victim buffer
+	u64						GetLookupHits() const					{ return mLookupHits; }
+	u64						GetLookupVictimHits() const				{ return mLookupVictimHits; }
+	u64						GetLookupMisses() const					{ return mLookupMisses; }
+	u32						GetEvictions() const					{ return mEvictions; }
+
+	// Clear() of a non-empty cache vs InvalidateRange() that hit something
+	u32						GetFullInvalidations() const			{ return mFullInvalidations; }
+	u32						GetPartialInvalidations() const			{ return mPartialInvalidations; }
+
 	CCodeBufferManager *	GetCodeBufferManager() const			{ return mpCodeBufferManager; }
 
 	bool					ShouldInvalidateOnWrite( u32 address, u32 length ) const;
 
+private:
+	void					RemoveFragment( CFragment * p_fragment );
+	void					AddToHashTable( u32 address, CFragment * p_fragment ) const;
+	void					RemoveFromHashTable( u32 address ) const;
+
 private:
 	struct SFragmentEntry
 	{
-		SFragmentEntry( u32 address, CFragment * fragment )
-			:	Address( address )
-			,	Fragment( fragment )
-		{
-		}
+		SFragmentEntry( u32 address, CFragment * p_fragment ) : Address( address ), Fragment( p_fragment ) {}
 
-		bool operator<( const SFragmentEntry & rhs ) const
-		{
-			return Address < rhs.Address;
-		}
+		u32				Address;
+		CFragment *		Fragment;
 
-		u32			Address;
-		CFragment *	Fragment;
+		bool operator<( const SFragmentEntry & rhs ) const		{ return Address < rhs.Address; }
 	};
 
+	//
+	//	mFragments owns every live fragment and is kept sorted by address. Lookups never
+	//	search it: every live fragment is in either the hash table or the victim buffer.
+	//
 	typedef std::vector< SFragmentEntry >	FragmentVec;
-	FragmentVec				mFragments;			// Sorted on Address
+	FragmentVec				mFragments;
+
+	typedef std::vector< CFragment * >		FragmentList;
+	FragmentList			mStaleFragments;	// Invalidated, but possibly still executing
 
 	u32						mMemoryUsage;
 	u32						mInputLength;
 	u32						mOutputLength;
 
-	typedef std::vector< CJumpLocation >	JumpList;
-	typedef std::map< u32, JumpList >		JumpMap;
+	//
+	//	Every exit jump of every live fragment, keyed by the address it exits to. Target is
+	//	the fragment the jump is currently patched to, or nullptr if it still goes to Fallback.
+	//	Keeping linked jumps around lets us unpatch them when their target is invalidated.
+	//
+	struct SFragmentLink
+	{
+		CFragment *		Source;
+		CFragment *		Target;
+		CJumpLocation	Jump;
+		CCodeLabel		Fallback;
+	};
+
+	typedef std::vector< SFragmentLink >	LinkList;
+	typedef std::map< u32, LinkList >		JumpMap;
 	JumpMap					mJumpMap;
 
-	mutable u32				mCachedFragmentAddress;
-	mutable CFragment *		mpCachedFragment;
+	//
+	//	The hash table is 4-way set associative, with the ways of each set kept in most to
+	//	least recently used order. An entry with a null Fragment caches a failed lookup, and
+	//	is replaced before any live fragment is. A live fragment pushed out of a full set
+	//	goes to the victim buffer, which is only searched when the set has no entry at all
+	//	for the address. With far more slots than gMaxFragmentCacheSize it stays tiny.
+	//
+	struct SFragmentHashEntry
+	{
+		u32			Address;
+		CFragment *	Fragment;
+	};
 
-	static const u32 HASH_TABLE_BITS = 15;
-	static const u32 HASH_TABLE_SIZE = 1<<HASH_TABLE_BITS;
+	static const u32 HASH_TABLE_WAYS = 4;
+	static const u32 HASH_TABLE_BITS = 13;
+	static const u32 HASH_TABLE_SETS = 1<<HASH_TABLE_BITS;
+	static const u32 EMPTY_ADDRESS = ~0u;		// Never a valid PC, as the low 2 bits are set
 
 	//Low 2 bits will always be 0, remove this redundancy (the amount of folding depends on the hash table size)
-	//#define MakeHashIdx( addr ) (((addr >> (2 * HASH_TABLE_BITS + 2)) ^ (addr >> (HASH_TABLE_BITS + 2)) ^ addr >> 2 ) & (HASH_TABLE_SIZE-1))
-	#define MakeHashIdx( addr ) (((addr >> (HASH_TABLE_BITS + 2)) ^ addr >> 2 ) & (HASH_TABLE_SIZE-1))
+	static inline u32		MakeHashIdx( u32 addr )					{ return ((addr >> (HASH_TABLE_BITS + 2)) ^ (addr >> 2)) & (HASH_TABLE_SETS-1); }
+
+	void					ResetHashTable();
+
+	mutable SFragmentHashEntry	mpCacheHashTable[HASH_TABLE_SETS][HASH_TABLE_WAYS];
+
+	typedef std::vector< SFragmentHashEntry >	VictimList;
+	mutable VictimList		mVictims;
 
-	mutable FHashT			mpCacheHashTable[HASH_TABLE_SIZE];
+	mutable u64				mLookupHits;
+	mutable u64				mLookupVictimHits;
+	mutable u64				mLookupMisses;
+	mutable u32				mEvictions;
+	u32						mFullInvalidations;
+	u32						mPartialInvalidations;
 
 	CCodeBufferManager *	mpCodeBufferManager;
 
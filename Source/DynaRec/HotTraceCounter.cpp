@@ -0,0 +1,72 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "HotTraceCounter.h"
+
+#include <string.h>
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CHotTraceCounter::Remove( u32 address )
+{
+	SEntry *	set( mEntries[ MakeSetIdx( address ) ] );
+	for( u32 i = 0; i < NUM_WAYS; ++i )
+	{
+		if( set[i].Address == address )
+		{
+			if( set[i].Count != 0 )
+			{
+				set[i].Count = 0;
+				mSize--;
+			}
+			return;
+		}
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CHotTraceCounter::Reset()
+{
+	memset( mEntries, 0, sizeof( mEntries ) );
+	mUpdatesUntilAging = AGING_PERIOD;
+	mSize = 0;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CHotTraceCounter::Age()
+{
+	SEntry *	entries( &mEntries[0][0] );
+	u32			size( 0 );
+	for( u32 i = 0; i < NUM_ENTRIES; ++i )
+	{
+		entries[i].Count >>= 1;
+		if( entries[i].Count != 0 )
+		{
+			size++;
+		}
+	}
+	mUpdatesUntilAging = AGING_PERIOD;
+	mSize = size;
+}
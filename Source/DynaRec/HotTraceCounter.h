@@ -0,0 +1,103 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef DYNAREC_HOTTRACECOUNTER_H_
+#define DYNAREC_HOTTRACECOUNTER_H_
+
+#include "Utility/DaedalusTypes.h"
+
+//*************************************************************************************
+//	Counts how often the interpreter arrives at each branch target that isn't
+//	compiled yet. It's a fixed size, 4-way set associative table, so bumping a
+//	count never allocates. When a set is full the entry with the lowest count is
+//	replaced. Every AGING_PERIOD updates all the counts are halved, so targets
+//	only become hot if they're hit often in a short space of time, and targets
+//	that stopped being hit eventually free up their slot.
+//*************************************************************************************
+class CHotTraceCounter
+{
+public:
+	struct SEntry
+	{
+		u32			Address;
+		u32			Count;		// 0 means the entry is free
+	};
+
+	static const u32 NUM_WAYS = 4;
+	static const u32 SET_BITS = 10;
+	static const u32 NUM_SETS = 1<<SET_BITS;
+	static const u32 NUM_ENTRIES = NUM_SETS * NUM_WAYS;
+	static const u32 AGING_PERIOD = NUM_ENTRIES * 4;
+
+	CHotTraceCounter()												{ Reset(); }
+
+	// Returns the updated count for this address
+	inline u32				Increment( u32 address )
+	{
+		if( --mUpdatesUntilAging == 0 )
+		{
+			Age();
+		}
+
+		SEntry *	set( mEntries[ MakeSetIdx( address ) ] );
+		SEntry *	victim( &set[0] );
+		for( u32 i = 0; i < NUM_WAYS; ++i )
+		{
+			if( set[i].Address == address )
+			{
+				if( set[i].Count == 0 )
+				{
+					mSize++;
+				}
+				return ++set[i].Count;
+			}
+			if( set[i].Count < victim->Count )
+			{
+				victim = &set[i];
+			}
+		}
+
+		if( victim->Count == 0 )
+		{
+			mSize++;
+		}
+		victim->Address = address;
+		victim->Count = 1;
+		return 1;
+	}
+
+	void					Remove( u32 address );
+	void					Reset();
+
+	u32						GetSize() const							{ return mSize; }		// Number of entries in use
+	const SEntry *			GetEntries() const						{ return &mEntries[0][0]; }
+
+private:
+	void					Age();
+
+	// Fibonacci hashing - spreads word aligned addresses evenly across the sets
+	static inline u32		MakeSetIdx( u32 address )				{ return (address * 2654435761u) >> (32 - SET_BITS); }
+
+private:
+	SEntry					mEntries[ NUM_SETS ][ NUM_WAYS ];
+	u32						mUpdatesUntilAging;
+	u32						mSize;
+};
+
+#endif // DYNAREC_HOTTRACECOUNTER_H_
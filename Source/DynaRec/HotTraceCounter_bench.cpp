@@ -0,0 +1,247 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Micro-benchmark for the hot trace counter. Synthetic streams of branch
+//	targets are first filtered down to the ones that would miss the fragment
+//	cache (only those reach the counter), then replayed through the same
+//	count/threshold/flush logic Dynamo uses, once with the old std::map
+//	counter and once with CHotTraceCounter.
+//
+
+#include "stdafx.h"
+#include "DynaRec/HotTraceCounter.h"
+#include "Utility/Timing.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace
+{
+	// Same values as Core/Dynamo.cpp
+	const u32	kHotTraceThreshold = 10;
+	const u32	kMaxHotTraceMapSize = 2048 + 1024;
+
+	const u32	kStreamLength = 4*1024*1024;
+	const u32	kCodeBase = 0x80000000;
+	const u32	kCodeSize = 4*1024*1024;
+
+	class CRandom
+	{
+	public:
+		explicit CRandom( u32 seed ) : mState( seed ) {}
+
+		u32		Next()
+		{
+			mState ^= mState << 13;
+			mState ^= mState >> 17;
+			mState ^= mState << 5;
+			return mState;
+		}
+
+		f64		NextUnit()				{ return f64( Next() ) / 4294967296.0; }
+
+	private:
+		u32		mState;
+	};
+
+	struct SResult
+	{
+		f64		NsPerUpdate;
+		u32		Updates;
+		u32		TracesStarted;
+		u32		Flushes;
+	};
+
+	//
+	//	Zipf distributed targets model a handful of hot loops with a long tail. cold_pct
+	//	of the stream is replaced by targets that are only ever seen once.
+	//
+	void	GenerateStream( std::vector< u32 > & stream, u32 num_targets, f64 skew, u32 cold_pct, u32 seed )
+	{
+		CRandom		rng( seed );
+
+		std::vector< u32 >	targets( num_targets );
+		for( u32 i = 0; i < num_targets; ++i )
+		{
+			targets[ i ] = kCodeBase + ((rng.Next() % kCodeSize) & ~3u);
+		}
+
+		std::vector< f64 >	cdf( num_targets );
+		f64		total( 0.0 );
+		for( u32 i = 0; i < num_targets; ++i )
+		{
+			total += 1.0 / pow( f64( i + 1 ), skew );
+			cdf[ i ] = total;
+		}
+
+		u32		next_cold( kCodeBase );
+		stream.resize( kStreamLength );
+		for( u32 i = 0; i < kStreamLength; ++i )
+		{
+			if( rng.Next() % 100 < cold_pct )
+			{
+				next_cold = kCodeBase + ((next_cold - kCodeBase + 0x44) % kCodeSize);
+				stream[ i ] = next_cold;
+			}
+			else
+			{
+				f64		r( rng.NextUnit() * total );
+				u32		idx( u32( std::lower_bound( cdf.begin(), cdf.end(), r ) - cdf.begin() ) );
+				stream[ i ] = targets[ std::min( idx, num_targets - 1 ) ];
+			}
+		}
+	}
+
+	//
+	//	Only targets that miss the fragment cache get counted. Once a target becomes hot
+	//	it's compiled and stops missing (until the cache is flushed).
+	//
+	void	FilterMisses( const std::vector< u32 > & stream, std::vector< u32 > & misses )
+	{
+		std::map< u32, u32 >	counts;
+		std::vector< bool >		compiled( kCodeSize / 4 );
+
+		misses.clear();
+		for( u32 i = 0; i < stream.size(); ++i )
+		{
+			u32		idx( (stream[ i ] - kCodeBase) >> 2 );
+			if( compiled[ idx ] )
+			{
+				continue;
+			}
+
+			misses.push_back( stream[ i ] );
+
+			u32		count( ++counts[ stream[ i ] ] );
+			if( counts.size() >= kMaxHotTraceMapSize )
+			{
+				counts.clear();
+				compiled.assign( compiled.size(), false );
+			}
+			else if( count == kHotTraceThreshold )
+			{
+				counts.erase( stream[ i ] );
+				compiled[ idx ] = true;
+			}
+		}
+	}
+
+	struct SMapCounter
+	{
+		std::map< u32, u32 >	Map;
+
+		u32		Increment( u32 address )	{ return ++Map[ address ]; }
+		void	Remove( u32 address )		{ Map.erase( address ); }
+		void	Reset()						{ Map.clear(); }
+		u32		GetSize() const				{ return Map.size(); }
+	};
+
+	struct STableCounter
+	{
+		CHotTraceCounter		Table;
+
+		u32		Increment( u32 address )	{ return Table.Increment( address ); }
+		void	Remove( u32 address )		{ Table.Remove( address ); }
+		void	Reset()						{ Table.Reset(); }
+		u32		GetSize() const				{ return Table.GetSize(); }
+	};
+
+	template< typename Counter >
+	SResult	Run( Counter & counter, const std::vector< u32 > & misses )
+	{
+		SResult		result = { 0.0, u32( misses.size() ), 0, 0 };
+
+		u64		freq( 0 ), start( 0 ), end( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+		NTiming::GetPreciseTime( &start );
+
+		for( u32 i = 0; i < misses.size(); ++i )
+		{
+			u32		address( misses[ i ] );
+			u32		count( counter.Increment( address ) );
+			if( counter.GetSize() >= kMaxHotTraceMapSize )
+			{
+				counter.Reset();
+				result.Flushes++;
+			}
+			else if( count == kHotTraceThreshold )
+			{
+				counter.Remove( address );
+				result.TracesStarted++;
+			}
+		}
+
+		NTiming::GetPreciseTime( &end );
+
+		result.NsPerUpdate = result.Updates ? (f64( end - start ) * 1e9 / f64( freq )) / f64( result.Updates ) : 0.0;
+		return result;
+	}
+}
+
+int main()
+{
+	struct SDistribution
+	{
+		const char *	Name;
+		u32				NumTargets;
+		f64				Skew;
+		u32				ColdPct;
+	};
+
+	static const SDistribution	distributions[] =
+	{
+		{ "hot loops",		512,	1.2,	0 },
+		{ "wide",			8192,	0.9,	2 },
+		{ "boot/cold",		2048,	1.0,	40 },
+		{ "uniform",		4096,	0.0,	0 },
+	};
+
+	printf( "Hot trace counter: %u branch targets per run, threshold %u\n\n", kStreamLength, kHotTraceThreshold );
+	printf( "%-12s %10s %12s %12s %9s %16s %14s\n", "distribution", "misses", "map ns/op", "table ns/op", "speedup", "traces map/tbl", "flushes m/t" );
+
+	for( u32 d = 0; d < sizeof( distributions ) / sizeof( distributions[0] ); ++d )
+	{
+		const SDistribution &	dist( distributions[ d ] );
+
+		std::vector< u32 >	stream;
+		std::vector< u32 >	misses;
+		GenerateStream( stream, dist.NumTargets, dist.Skew, dist.ColdPct, 0x1234567 + d );
+		FilterMisses( stream, misses );
+
+		SMapCounter		map_counter;
+		STableCounter	table_counter;
+
+		SResult		map_result( Run( map_counter, misses ) );
+		SResult		table_result( Run( table_counter, misses ) );
+
+		printf( "%-12s %10u %12.2f %12.2f %8.2fx %7u/%-8u %6u/%-6u\n",
+			dist.Name, map_result.Updates,
+			map_result.NsPerUpdate, table_result.NsPerUpdate,
+			table_result.NsPerUpdate > 0.0 ? map_result.NsPerUpdate / table_result.NsPerUpdate : 0.0,
+			map_result.TracesStarted, table_result.TracesStarted,
+			map_result.Flushes, table_result.Flushes );
+	}
+
+	return 0;
+}
@@ -0,0 +1,335 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "TraceCache.h"
+#include "BranchType.h"
+#include "StaticAnalysis.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Core/Memory.h"
+#include "Debug/DBGConsole.h"
+#include "Debug/Dump.h"
+#include "Utility/Hash.h"
+
+CTraceCache		gTraceCache;
+
+namespace
+{
+	const u32 MAGIC_HEADER = 0x54524331;	// 'TRC1'
+	const u32 CACHE_VERSION = 1;
+
+	const u32 INVALID_IDX = u32( ~0 );
+
+	const u32 OP_DELAY_SLOT = 0x1;
+
+	const u32 RECORD_INDIRECT_EXIT_MAP = 0x1;
+
+	const u32 BRANCH_TAKEN = 0x1;
+	const u32 BRANCH_LIKELY = 0x2;
+	const u32 BRANCH_DIRECT = 0x4;
+	const u32 BRANCH_ERET = 0x8;
+	const u32 BRANCH_SPEEDHACK_SHIFT = 8;
+
+	template< typename T >
+	bool	ReadArray( FILE * fp, std::vector< T > & items, u32 count )
+	{
+		items.resize( count );
+		return count == 0 || fread( &items[0], sizeof( T ), count, fp ) == count;
+	}
+
+	template< typename T >
+	void	WriteArray( FILE * fp, const std::vector< T > & items )
+	{
+		if( !items.empty() )
+		{
+			fwrite( &items[0], sizeof( T ), items.size(), fp );
+		}
+	}
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+CTraceCache::CTraceCache()
+:	mDirty( false )
+,	mNumReplayed( 0 )
+{
+	mFilename[0] = '\0';
+	memset( mAddressFilter, 0, sizeof( mAddressFilter ) );
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::Clear()
+{
+	mRecords.clear();
+	mOps.clear();
+	mBranches.clear();
+	mRecordMap.clear();
+	memset( mAddressFilter, 0, sizeof( mAddressFilter ) );
+	mDirty = false;
+	mNumReplayed = 0;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::Load( const char * rom_filename, const RomID & rom_id )
+{
+	Clear();
+
+	Dump_GetSaveDirectory( mFilename, rom_filename, ".trc" );
+	mRomID = rom_id;
+
+	FILE * fp( fopen( mFilename, "rb" ) );
+	if( fp == nullptr )
+	{
+		return;
+	}
+
+	u32		header[8];
+	bool	ok( fread( header, sizeof( header ), 1, fp ) == 1 );
+
+	ok = ok && header[0] == MAGIC_HEADER && header[1] == CACHE_VERSION;
+	ok = ok && header[2] == rom_id.CRC[0] && header[3] == rom_id.CRC[1] && header[4] == rom_id.CountryID;
+	ok = ok && header[6] <= MAX_OPS;
+	ok = ok && ReadArray( fp, mRecords, header[5] ) && ReadArray( fp, mOps, header[6] ) && ReadArray( fp, mBranches, header[7] );
+
+	fclose( fp );
+
+	// Make sure none of the records point outside the op/branch arrays before using them
+	for( u32 i = 0; ok && i < mRecords.size(); ++i )
+	{
+		const SRecord &	record( mRecords[ i ] );
+		ok = record.NumOps > 0 &&
+			 record.FirstOp <= mOps.size() && record.NumOps <= mOps.size() - record.FirstOp &&
+			 record.FirstBranch <= mBranches.size() && record.NumBranches <= mBranches.size() - record.FirstBranch;
+	}
+
+	if( !ok )
+	{
+		#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Ignoring trace cache %s", mFilename );
+		#endif
+		Clear();
+		return;
+	}
+
+	for( u32 i = 0; i < mRecords.size(); ++i )
+	{
+		IndexRecord( i );
+	}
+
+	#ifdef DAEDALUS_DEBUG_CONSOLE
+	DBGConsole_Msg( 0, "Read %d traces from trace cache %s", mRecords.size(), mFilename );
+	#endif
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::Save()
+{
+	if( !mDirty || mFilename[0] == '\0' )
+	{
+		return;
+	}
+
+	FILE * fp( fopen( mFilename, "wb" ) );
+	if( fp != nullptr )
+	{
+		#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Write %d traces to trace cache %s", mRecords.size(), mFilename );
+		#endif
+		u32		header[8] = { MAGIC_HEADER, CACHE_VERSION, mRomID.CRC[0], mRomID.CRC[1], mRomID.CountryID,
+							  u32( mRecords.size() ), u32( mOps.size() ), u32( mBranches.size() ) };
+
+		fwrite( header, sizeof( header ), 1, fp );
+		WriteArray( fp, mRecords );
+		WriteArray( fp, mOps );
+		WriteArray( fp, mBranches );
+		fclose( fp );
+	}
+
+	mDirty = false;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::AddTrace( u32 entry_address, u32 exit_address, const std::vector< STraceEntry > & trace,
+							const std::vector< SBranchDetails > & branch_details, bool need_indirect_exit_map )
+{
+	if( trace.empty() || mOps.size() + trace.size() > MAX_OPS )
+	{
+		return;
+	}
+
+	SRecord		record;
+	record.EntryAddress = entry_address;
+	record.ExitAddress = exit_address;
+	record.Flags = need_indirect_exit_map ? RECORD_INDIRECT_EXIT_MAP : 0;
+	record.FirstOp = mOps.size();
+	record.NumOps = trace.size();
+	record.FirstBranch = mBranches.size();
+	record.NumBranches = branch_details.size();
+
+	for( u32 i = 0; i < trace.size(); ++i )
+	{
+		SOp		op = { trace[ i ].Address | (trace[ i ].BranchDelaySlot ? OP_DELAY_SLOT : 0), trace[ i ].OpCode._u32 };
+		mOps.push_back( op );
+	}
+
+	record.CodeHash = HashOps( &mOps[ record.FirstOp ], record.NumOps );
+
+	// Traces replayed from the cache come back through here too, so drop anything we already have
+	std::pair< RecordMap::const_iterator, RecordMap::const_iterator >	range( mRecordMap.equal_range( entry_address ) );
+	for( RecordMap::const_iterator it = range.first; it != range.second; ++it )
+	{
+		const SRecord &	existing( mRecords[ it->second ] );
+		if( existing.CodeHash == record.CodeHash && existing.NumOps == record.NumOps &&
+			memcmp( &mOps[ existing.FirstOp ], &mOps[ record.FirstOp ], record.NumOps * sizeof( SOp ) ) == 0 )
+		{
+			mOps.resize( record.FirstOp );
+			return;
+		}
+	}
+
+	for( u32 i = 0; i < branch_details.size(); ++i )
+	{
+		const SBranchDetails &	details( branch_details[ i ] );
+		SBranch		branch;
+		branch.TargetAddress = details.TargetAddress;
+		branch.DelaySlotTraceIndex = details.DelaySlotTraceIndex;
+		branch.Flags = (details.ConditionalBranchTaken ? BRANCH_TAKEN : 0) |
+					   (details.Likely ? BRANCH_LIKELY : 0) |
+					   (details.Direct ? BRANCH_DIRECT : 0) |
+					   (details.Eret ? BRANCH_ERET : 0) |
+					   (u32( details.SpeedHack ) << BRANCH_SPEEDHACK_SHIFT);
+		mBranches.push_back( branch );
+	}
+
+	mRecords.push_back( record );
+	IndexRecord( mRecords.size() - 1 );
+	mDirty = true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+bool CTraceCache::FindTrace( u32 address, u32 * p_exit_address, std::vector< STraceEntry > & trace,
+							 std::vector< SBranchDetails > & branch_details, bool * p_need_indirect_exit_map ) const
+{
+	std::pair< RecordMap::const_iterator, RecordMap::const_iterator >	range( mRecordMap.equal_range( address ) );
+	for( RecordMap::const_iterator it = range.first; it != range.second; ++it )
+	{
+		const SRecord &	record( mRecords[ it->second ] );
+		if( !MatchesMemory( record ) )
+		{
+			continue;
+		}
+
+		// The branch indices and register usage aren't stored, they're recalculated from the ops the same way CTraceRecorder does
+		trace.resize( record.NumOps );
+		u32		branch_idx( 0 );
+		for( u32 i = 0; i < record.NumOps; ++i )
+		{
+			const SOp &		op( mOps[ record.FirstOp + i ] );
+			STraceEntry &	entry( trace[ i ] );
+
+			entry.Address = op.Address & ~3;
+			entry.OpCode._u32 = op.OpCode;
+			entry.BranchDelaySlot = (op.Address & OP_DELAY_SLOT) != 0;
+			StaticAnalysis::Analyse( entry.OpCode, entry.Usage );
+			entry.BranchIdx = entry.Usage.BranchType != BT_NOT_BRANCH ? branch_idx++ : INVALID_IDX;
+		}
+
+		if( branch_idx != record.NumBranches )
+		{
+			continue;
+		}
+
+		branch_details.resize( record.NumBranches );
+		for( u32 i = 0; i < record.NumBranches; ++i )
+		{
+			const SBranch &		branch( mBranches[ record.FirstBranch + i ] );
+			SBranchDetails &	details( branch_details[ i ] );
+
+			details.TargetAddress = branch.TargetAddress;
+			details.DelaySlotTraceIndex = branch.DelaySlotTraceIndex;
+			details.ConditionalBranchTaken = (branch.Flags & BRANCH_TAKEN) != 0;
+			details.Likely = (branch.Flags & BRANCH_LIKELY) != 0;
+			details.Direct = (branch.Flags & BRANCH_DIRECT) != 0;
+			details.Eret = (branch.Flags & BRANCH_ERET) != 0;
+			details.SpeedHack = SpeedHackProbe( branch.Flags >> BRANCH_SPEEDHACK_SHIFT );
+		}
+
+		*p_exit_address = record.ExitAddress;
+		*p_need_indirect_exit_map = (record.Flags & RECORD_INDIRECT_EXIT_MAP) != 0;
+		mNumReplayed++;
+		return true;
+	}
+
+	return false;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+u32 CTraceCache::HashOps( const SOp * ops, u32 num_ops ) const
+{
+	return murmur2_hash( ops, num_ops * sizeof( SOp ), 0 );
+}
+
+//*************************************************************************************
+//	Only code that can be read directly is checked - anything behind the tlb or
+//	in a register range is left to be recorded again
+//*************************************************************************************
+bool CTraceCache::MatchesMemory( const SRecord & record ) const
+{
+	for( u32 i = 0; i < record.NumOps; ++i )
+	{
+		const SOp &			op( mOps[ record.FirstOp + i ] );
+		u32					address( op.Address & ~3 );
+		const MemFuncRead &	m( g_MemoryLookupTableRead[ address >> 18 ] );
+
+		if( m.pRead == nullptr || *(const u32 *)( m.pRead + address ) != op.OpCode )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//*************************************************************************************
+//
+//*************************************************************************************
+void CTraceCache::IndexRecord( u32 record_idx )
+{
+	u32		address( mRecords[ record_idx ].EntryAddress );
+	u32		bit( (address >> 2) & (FILTER_BITS - 1) );
+
+	mRecordMap.insert( RecordMap::value_type( address, record_idx ) );
+	mAddressFilter[ bit >> 5 ] |= 1u << (bit & 31);
+}
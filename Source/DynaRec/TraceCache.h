@@ -0,0 +1,112 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef DYNAREC_TRACECACHE_H_
+#define DYNAREC_TRACECACHE_H_
+
+#include <map>
+#include <vector>
+
+#include "Core/ROM.h"
+#include "Trace.h"
+
+//*************************************************************************************
+//	Keeps every trace recorded for the current rom, and saves them next to the
+//	savegames when the rom is closed. On the next boot a trace can be replayed
+//	the first time its entry address is reached, instead of interpreting it
+//	until it gets hot and recording it again.
+//
+//	Traces are keyed by entry address and a hash of the ops they were recorded
+//	from, so overlays loaded at the same address can each have their own trace.
+//	A trace is only replayed if the code currently in memory matches it exactly.
+//*************************************************************************************
+class CTraceCache
+{
+public:
+	CTraceCache();
+
+	void			Load( const char * rom_filename, const RomID & rom_id );
+	void			Save();
+	void			Clear();
+
+	void			AddTrace( u32 entry_address, u32 exit_address, const std::vector< STraceEntry > & trace,
+							  const std::vector< SBranchDetails > & branch_details, bool need_indirect_exit_map );
+
+	// Cheap test for whether there's any trace starting at this address (can give false positives)
+	bool			MayContain( u32 address ) const				{ u32 bit( (address >> 2) & (FILTER_BITS - 1) ); return (mAddressFilter[ bit >> 5 ] >> (bit & 31)) & 1; }
+
+	// Finds a trace starting at address whose ops match the code in memory, and rebuilds the trace/branch buffers for it
+	bool			FindTrace( u32 address, u32 * p_exit_address, std::vector< STraceEntry > & trace,
+							   std::vector< SBranchDetails > & branch_details, bool * p_need_indirect_exit_map ) const;
+
+	u32				GetNumTraces() const						{ return mRecords.size(); }
+	u32				GetNumReplayed() const						{ return mNumReplayed; }
+
+private:
+	struct SRecord
+	{
+		u32			EntryAddress;
+		u32			ExitAddress;
+		u32			CodeHash;
+		u32			Flags;
+		u32			FirstOp;
+		u32			NumOps;
+		u32			FirstBranch;
+		u32			NumBranches;
+	};
+
+	// The ops are stored as address/opcode pairs. Ops are word aligned, so bit 0 of the address flags a delay slot
+	struct SOp
+	{
+		u32			Address;
+		u32			OpCode;
+	};
+
+	struct SBranch
+	{
+		u32			TargetAddress;
+		s32			DelaySlotTraceIndex;
+		u32			Flags;
+	};
+
+	typedef std::multimap< u32, u32 >	RecordMap;		// Entry address -> index into mRecords
+
+	u32				HashOps( const SOp * ops, u32 num_ops ) const;
+	bool			MatchesMemory( const SRecord & record ) const;
+	void			IndexRecord( u32 record_idx );
+
+private:
+	static const u32	FILTER_BITS = 64 * 1024;
+	static const u32	MAX_OPS = 256 * 1024;		// Roughly 2MB of ops, the traces for most roms fit comfortably
+
+	std::vector< SRecord >	mRecords;
+	std::vector< SOp >		mOps;
+	std::vector< SBranch >	mBranches;
+	RecordMap				mRecordMap;
+	u32						mAddressFilter[ FILTER_BITS / 32 ];
+
+	IO::Filename			mFilename;
+	RomID					mRomID;
+	bool					mDirty;
+	mutable u32				mNumReplayed;
+};
+
+extern CTraceCache			gTraceCache;
+
+#endif // DYNAREC_TRACECACHE_H_
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "TraceRecorder.h"
 #include "Fragment.h"
 #include "BranchType.h"
+#include "TraceCache.h"
 
 #include "Core/CPU.h"			// For dubious use of PC/NewPC
 #include "Core/Registers.h"
@@ -322,6 +323,35 @@ CFragment *		CTraceRecorder::CreateFragment( CCodeBufferManager * p_manager )
 }
 
 
+//
+
+bool	CTraceRecorder::ReplayTrace( u32 address )
+{
+#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( !mTracing, "We're already tracing" );
+#endif
+	if( !gTraceCache.FindTrace( address, &mExpectedExitTraceAddress, mTraceBuffer, mBranchDetails, &mNeedIndirectExitMap ) )
+	{
+		mTraceBuffer.clear();
+		mBranchDetails.clear();
+		return false;
+	}
+
+	mStartTraceAddress = address;
+	mActiveBranchIdx = INVALID_IDX;
+	mStopTraceAfterDelaySlot = false;
+	return true;
+}
+
+
+//
+
+void	CTraceRecorder::AddToTraceCache() const
+{
+	gTraceCache.AddTrace( mStartTraceAddress, mExpectedExitTraceAddress, mTraceBuffer, mBranchDetails, mNeedIndirectExitMap );
+}
+
+
 //
 
 void	CTraceRecorder::AbortTrace()
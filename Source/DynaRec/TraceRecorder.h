@@ -50,6 +50,10 @@ public:
 	CFragment *			CreateFragment( CCodeBufferManager * p_manager );
 	void				AbortTrace();
 
+	// Sets up a trace from the trace cache, ready for CreateFragment
+	bool				ReplayTrace( u32 address );
+	void				AddToTraceCache() const;
+
 	bool				IsTraceActive() const						{ return mTracing; }
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	u32					GetStartTraceAddress() const				{ DAEDALUS_ASSERT_Q( mTracing ); return mStartTraceAddress; }
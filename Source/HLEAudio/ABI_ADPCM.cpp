@@ -4,6 +4,7 @@
 
 #include "audiohle.h"
 #include "AudioHLEProcessor.h"
+#include "ADPCMPredict.h"
 
 #include "Core/Memory.h"
 #include "Math/MathUtil.h"
@@ -28,7 +29,7 @@ inline int Scale16( s16 in, int vscale )
 	return ((int)in*vscale)>>16;
 }
 
-void Decode4_Scale( int (&inp1)[8], u32 icode_a, u32 icode_b, int vscale )
+void Decode4_Scale( s32 (&inp1)[8], u32 icode_a, u32 icode_b, int vscale )
 {
 	inp1[0] = Scale16( (s16)((icode_a&0xC0) <<  8), vscale );
 	inp1[1] = Scale16( (s16)((icode_a&0x30) << 10), vscale );
@@ -40,7 +41,7 @@ void Decode4_Scale( int (&inp1)[8], u32 icode_a, u32 icode_b, int vscale )
 	inp1[7] = Scale16( (s16)((icode_b&0x03) << 14), vscale );
 }
 
-void Decode4( int (&inp1)[8], u32 icode_a, u32 icode_b )
+void Decode4( s32 (&inp1)[8], u32 icode_a, u32 icode_b )
 {
 	inp1[0] = (s16)((icode_a&0xC0) <<  8);
 	inp1[1] = (s16)((icode_a&0x30) << 10);
@@ -52,7 +53,7 @@ void Decode4( int (&inp1)[8], u32 icode_a, u32 icode_b )
 	inp1[7] = (s16)((icode_b&0x03) << 14);
 }
 
-void Decode8_Scale( int (&inp1)[8], u32 icode_a, u32 icode_b, u32 icode_c, u32 icode_d, int vscale )
+void Decode8_Scale( s32 (&inp1)[8], u32 icode_a, u32 icode_b, u32 icode_c, u32 icode_d, int vscale )
 {
 	inp1[0] = Scale16( (s16)((icode_a&0xF0) <<  8), vscale );
 	inp1[1] = Scale16( (s16)((icode_a&0x0F) << 12), vscale );
@@ -64,7 +65,7 @@ void Decode8_Scale( int (&inp1)[8], u32 icode_a, u32 icode_b, u32 icode_c, u32 i
 	inp1[7] = Scale16( (s16)((icode_d&0x0F) << 12), vscale );
 }
 
-void Decode8( int (&inp1)[8], u32 icode_a, u32 icode_b, u32 icode_c, u32 icode_d )
+void Decode8( s32 (&inp1)[8], u32 icode_a, u32 icode_b, u32 icode_c, u32 icode_d )
 {
 	inp1[0] = (s16)((icode_a&0xF0) <<  8);
 	inp1[1] = (s16)((icode_a&0x0F) << 12);
@@ -76,7 +77,7 @@ void Decode8( int (&inp1)[8], u32 icode_a, u32 icode_b, u32 icode_c, u32 icode_d
 	inp1[7] = (s16)((icode_d&0x0F) << 12);
 }
 
-void ADPCM2_Decode4( int (&inp1)[8], int (&inp2)[8], u32 inPtr, u8 code )
+void ADPCM2_Decode4( s32 (&inp1)[8], s32 (&inp2)[8], u32 inPtr, u8 code )
 {
 	u32 icode_a=gAudioHLEState.Buffer[(gAudioHLEState.InBuffer+inPtr+0)^3];
 	u32 icode_b=gAudioHLEState.Buffer[(gAudioHLEState.InBuffer+inPtr+1)^3];
@@ -96,7 +97,7 @@ void ADPCM2_Decode4( int (&inp1)[8], int (&inp2)[8], u32 inPtr, u8 code )
 	}
 }
 
-void ADPCM2_Decode8( int (&inp1)[8], int (&inp2)[8], u32 inPtr, u8 code )
+void ADPCM2_Decode8( s32 (&inp1)[8], s32 (&inp2)[8], u32 inPtr, u8 code )
 {
 	u32 icode_a=gAudioHLEState.Buffer[(gAudioHLEState.InBuffer+inPtr+0)^3];
 	u32 icode_b=gAudioHLEState.Buffer[(gAudioHLEState.InBuffer+inPtr+1)^3];
@@ -120,29 +121,6 @@ void ADPCM2_Decode8( int (&inp1)[8], int (&inp2)[8], u32 inPtr, u8 code )
 	}
 }
 
-void ADPCM2_Loop( s32 (&a)[8], int (&i1)[8], const s16 * b1, const s16 * b2, s16 * out )
-{
-	int l1( a[6] );
-	int l2( a[7] );
-
-	const int scl( 2048 );
-
-	a[0] = ((int)b1[0]*l1) + ((int)b2[0]*l2) + ((int)i1[0]*scl);
-	a[1] = ((int)b1[1]*l1) + ((int)b2[1]*l2) + ((int)b2[0]*i1[0]) + ((int)i1[1]*scl);
-	a[2] = ((int)b1[2]*l1) + ((int)b2[2]*l2) + ((int)b2[1]*i1[0]) + ((int)b2[0]*i1[1]) + ((int)i1[2]*scl);
-	a[3] = ((int)b1[3]*l1) + ((int)b2[3]*l2) + ((int)b2[2]*i1[0]) + ((int)b2[1]*i1[1]) + ((int)b2[0]*i1[2]) + ((int)i1[3]*scl);
-	a[4] = ((int)b1[4]*l1) + ((int)b2[4]*l2) + ((int)b2[3]*i1[0]) + ((int)b2[2]*i1[1]) + ((int)b2[1]*i1[2]) + ((int)b2[0]*i1[3]) + ((int)i1[4]*scl);
-	a[5] = ((int)b1[5]*l1) + ((int)b2[5]*l2) + ((int)b2[4]*i1[0]) + ((int)b2[3]*i1[1]) + ((int)b2[2]*i1[2]) + ((int)b2[1]*i1[3]) + ((int)b2[0]*i1[4]) + ((int)i1[5]*scl);
-	a[6] = ((int)b1[6]*l1) + ((int)b2[6]*l2) + ((int)b2[5]*i1[0]) + ((int)b2[4]*i1[1]) + ((int)b2[3]*i1[2]) + ((int)b2[2]*i1[3]) + ((int)b2[1]*i1[4]) + ((int)b2[0]*i1[5]) + ((int)i1[6]*scl);
-	a[7] = ((int)b1[7]*l1) + ((int)b2[7]*l2) + ((int)b2[6]*i1[0]) + ((int)b2[5]*i1[1]) + ((int)b2[4]*i1[2]) + ((int)b2[3]*i1[3]) + ((int)b2[2]*i1[4]) + ((int)b2[1]*i1[5]) + ((int)b2[0]*i1[6]) + ((int)i1[7]*scl);
-
-	for(u32 j=0;j<8;j++)
-	{
-		s16 r = Saturate<s16>( a[j^1] >> 11 );
-		a[j^1] = r;
-		out[j]=r;		// XXXX endian issues
-	}
-}
 void ADPCM2(AudioHLECommand command)
 {
 
@@ -168,7 +146,8 @@ void ADPCM2(AudioHLECommand command)
 
   	u16 inPtr=0;
 
-  	s32 a[8] = { 0,0,0,0,0,0,out[15],out[14] };		// XXXX Endian issues - should be 14/15^TWIDDLE?
+  	s32 l1=out[15];		// XXXX Endian issues - should be 14/15^TWIDDLE?
+  	s32 l2=out[14];
 
   	out+=16;
   	short count=gAudioHLEState.Count;
@@ -184,23 +163,21 @@ void ADPCM2(AudioHLECommand command)
   		s16 * book2=book1+8;
 
   		// Decode inputs
-  		int inp1[8];
-  		int inp2[8];
+  		s32 inp[2][8];
 
   		if( decode4 )
   		{
-  			ADPCM2_Decode4( inp1, inp2, inPtr, code );
+  			ADPCM2_Decode4( inp[0], inp[1], inPtr, code );
   			inPtr+=4;
   		}
   		else
   		{
-  			ADPCM2_Decode8( inp1, inp2, inPtr, code );
+  			ADPCM2_Decode8( inp[0], inp[1], inPtr, code );
   			inPtr+=8;
   		}
 
   		// Generate samples
-  		ADPCM2_Loop( a, inp1, book1, book2, out );
-  		ADPCM2_Loop( a, inp2, book1, book2, out+8 );
+  		ADPCMPredict( out, l1, l2, inp[0], book1, book2 );
 
   		out += 16;
   		count-=32;
@@ -225,7 +202,6 @@ void ADPCM3(AudioHLECommand command)
   	s32 vscale;
   	u16 index;
   	u16 j;
-  	s32 a[8];
   	s16 *book1,*book2;
 
   	memset(out,0,32);
@@ -237,8 +213,7 @@ void ADPCM3(AudioHLECommand command)
 
   	s32 l1=out[15];
   	s32 l2=out[14];
-  	s32 inp1[8];
-  	s32 inp2[8];
+  	s32 inp[2][8];
   	out+=16;
   	while(count>0)
   	{
@@ -268,17 +243,17 @@ void ADPCM3(AudioHLECommand command)
   			icode=gAudioHLEState.Buffer[(0x4f0+inPtr)^3];
   			inPtr++;
 
-  			inp1[j]=(s16)((icode&0xf0)<<8);			// this will in effect be signed
+  			inp[0][j]=(s16)((icode&0xf0)<<8);			// this will in effect be signed
 
   			// Conker and Banjo set this!
   			if(code<12)
-  				inp1[j]=((s32)((s32)inp1[j]*(s32)vscale)>>16);
+  				inp[0][j]=((s32)((s32)inp[0][j]*(s32)vscale)>>16);
 
   			j++;
 
-  			inp1[j]=(s16)((icode&0xf)<<12);
+  			inp[0][j]=(s16)((icode&0xf)<<12);
 
-  			inp1[j]=((s32)((s32)inp1[j]*(s32)vscale)>>16);
+  			inp[0][j]=((s32)((s32)inp[0][j]*(s32)vscale)>>16);
   			j++;
   		}
 
@@ -288,156 +263,21 @@ void ADPCM3(AudioHLECommand command)
   			icode=gAudioHLEState.Buffer[(0x4f0+inPtr)^3];
   			inPtr++;
 
-  			inp2[j]=(s16)((icode&0xf0)<<8);			// this will in effect be signed
+  			inp[1][j]=(s16)((icode&0xf0)<<8);			// this will in effect be signed
 
   			if(code<12)
-  				inp2[j]=((s32)((s32)inp2[j]*(s32)vscale)>>16);
+  				inp[1][j]=((s32)((s32)inp[1][j]*(s32)vscale)>>16);
 
   			j++;
 
-  			inp2[j]=(s16)((icode&0xf)<<12);
+  			inp[1][j]=(s16)((icode&0xf)<<12);
 
-  			inp2[j]=((s32)((s32)inp2[j]*(s32)vscale)>>16);
+  			inp[1][j]=((s32)((s32)inp[1][j]*(s32)vscale)>>16);
   			j++;
   		}
 
-  		a[0]= (s32)book1[0]*(s32)l1;
-  		a[0]+=(s32)book2[0]*(s32)l2;
-  		a[0]+=(s32)inp1[0]*(s32)2048;
-
-  		a[1] =(s32)book1[1]*(s32)l1;
-  		a[1]+=(s32)book2[1]*(s32)l2;
-  		a[1]+=(s32)book2[0]*inp1[0];
-  		a[1]+=(s32)inp1[1]*(s32)2048;
-
-  		a[2] =(s32)book1[2]*(s32)l1;
-  		a[2]+=(s32)book2[2]*(s32)l2;
-  		a[2]+=(s32)book2[1]*inp1[0];
-  		a[2]+=(s32)book2[0]*inp1[1];
-  		a[2]+=(s32)inp1[2]*(s32)2048;
-
-  		a[3] =(s32)book1[3]*(s32)l1;
-  		a[3]+=(s32)book2[3]*(s32)l2;
-  		a[3]+=(s32)book2[2]*inp1[0];
-  		a[3]+=(s32)book2[1]*inp1[1];
-  		a[3]+=(s32)book2[0]*inp1[2];
-  		a[3]+=(s32)inp1[3]*(s32)2048;
-
-  		a[4] =(s32)book1[4]*(s32)l1;
-  		a[4]+=(s32)book2[4]*(s32)l2;
-  		a[4]+=(s32)book2[3]*inp1[0];
-  		a[4]+=(s32)book2[2]*inp1[1];
-  		a[4]+=(s32)book2[1]*inp1[2];
-  		a[4]+=(s32)book2[0]*inp1[3];
-  		a[4]+=(s32)inp1[4]*(s32)2048;
-
-  		a[5] =(s32)book1[5]*(s32)l1;
-  		a[5]+=(s32)book2[5]*(s32)l2;
-  		a[5]+=(s32)book2[4]*inp1[0];
-  		a[5]+=(s32)book2[3]*inp1[1];
-  		a[5]+=(s32)book2[2]*inp1[2];
-  		a[5]+=(s32)book2[1]*inp1[3];
-  		a[5]+=(s32)book2[0]*inp1[4];
-  		a[5]+=(s32)inp1[5]*(s32)2048;
-
-  		a[6] =(s32)book1[6]*(s32)l1;
-  		a[6]+=(s32)book2[6]*(s32)l2;
-  		a[6]+=(s32)book2[5]*inp1[0];
-  		a[6]+=(s32)book2[4]*inp1[1];
-  		a[6]+=(s32)book2[3]*inp1[2];
-  		a[6]+=(s32)book2[2]*inp1[3];
-  		a[6]+=(s32)book2[1]*inp1[4];
-  		a[6]+=(s32)book2[0]*inp1[5];
-  		a[6]+=(s32)inp1[6]*(s32)2048;
-
-  		a[7] =(s32)book1[7]*(s32)l1;
-  		a[7]+=(s32)book2[7]*(s32)l2;
-  		a[7]+=(s32)book2[6]*inp1[0];
-  		a[7]+=(s32)book2[5]*inp1[1];
-  		a[7]+=(s32)book2[4]*inp1[2];
-  		a[7]+=(s32)book2[3]*inp1[3];
-  		a[7]+=(s32)book2[2]*inp1[4];
-  		a[7]+=(s32)book2[1]*inp1[5];
-  		a[7]+=(s32)book2[0]*inp1[6];
-  		a[7]+=(s32)inp1[7]*(s32)2048;
-
-  		*(out++) =      Saturate<s16>( a[1] >> 11 );
-  		*(out++) =      Saturate<s16>( a[0] >> 11 );
-  		*(out++) =      Saturate<s16>( a[3] >> 11 );
-  		*(out++) =      Saturate<s16>( a[2] >> 11 );
-  		*(out++) =      Saturate<s16>( a[5] >> 11 );
-  		*(out++) =      Saturate<s16>( a[4] >> 11 );
-  		*(out++) = l2 = Saturate<s16>( a[7] >> 11 );
-  		*(out++) = l1 = Saturate<s16>( a[6] >> 11 );
-
-  		a[0]= (s32)book1[0]*(s32)l1;
-  		a[0]+=(s32)book2[0]*(s32)l2;
-  		a[0]+=(s32)inp2[0]*(s32)2048;
-
-  		a[1] =(s32)book1[1]*(s32)l1;
-  		a[1]+=(s32)book2[1]*(s32)l2;
-  		a[1]+=(s32)book2[0]*inp2[0];
-  		a[1]+=(s32)inp2[1]*(s32)2048;
-
-  		a[2] =(s32)book1[2]*(s32)l1;
-  		a[2]+=(s32)book2[2]*(s32)l2;
-  		a[2]+=(s32)book2[1]*inp2[0];
-  		a[2]+=(s32)book2[0]*inp2[1];
-  		a[2]+=(s32)inp2[2]*(s32)2048;
-
-  		a[3] =(s32)book1[3]*(s32)l1;
-  		a[3]+=(s32)book2[3]*(s32)l2;
-  		a[3]+=(s32)book2[2]*inp2[0];
-  		a[3]+=(s32)book2[1]*inp2[1];
-  		a[3]+=(s32)book2[0]*inp2[2];
-  		a[3]+=(s32)inp2[3]*(s32)2048;
-
-  		a[4] =(s32)book1[4]*(s32)l1;
-  		a[4]+=(s32)book2[4]*(s32)l2;
-  		a[4]+=(s32)book2[3]*inp2[0];
-  		a[4]+=(s32)book2[2]*inp2[1];
-  		a[4]+=(s32)book2[1]*inp2[2];
-  		a[4]+=(s32)book2[0]*inp2[3];
-  		a[4]+=(s32)inp2[4]*(s32)2048;
-
-  		a[5] =(s32)book1[5]*(s32)l1;
-  		a[5]+=(s32)book2[5]*(s32)l2;
-  		a[5]+=(s32)book2[4]*inp2[0];
-  		a[5]+=(s32)book2[3]*inp2[1];
-  		a[5]+=(s32)book2[2]*inp2[2];
-  		a[5]+=(s32)book2[1]*inp2[3];
-  		a[5]+=(s32)book2[0]*inp2[4];
-  		a[5]+=(s32)inp2[5]*(s32)2048;
-
-  		a[6] =(s32)book1[6]*(s32)l1;
-  		a[6]+=(s32)book2[6]*(s32)l2;
-  		a[6]+=(s32)book2[5]*inp2[0];
-  		a[6]+=(s32)book2[4]*inp2[1];
-  		a[6]+=(s32)book2[3]*inp2[2];
-  		a[6]+=(s32)book2[2]*inp2[3];
-  		a[6]+=(s32)book2[1]*inp2[4];
-  		a[6]+=(s32)book2[0]*inp2[5];
-  		a[6]+=(s32)inp2[6]*(s32)2048;
-
-  		a[7] =(s32)book1[7]*(s32)l1;
-  		a[7]+=(s32)book2[7]*(s32)l2;
-  		a[7]+=(s32)book2[6]*inp2[0];
-  		a[7]+=(s32)book2[5]*inp2[1];
-  		a[7]+=(s32)book2[4]*inp2[2];
-  		a[7]+=(s32)book2[3]*inp2[3];
-  		a[7]+=(s32)book2[2]*inp2[4];
-  		a[7]+=(s32)book2[1]*inp2[5];
-  		a[7]+=(s32)book2[0]*inp2[6];
-  		a[7]+=(s32)inp2[7]*(s32)2048;
-
-  		*(out++) =      Saturate<s16>( a[1] >> 11 );
-  		*(out++) =      Saturate<s16>( a[0] >> 11 );
-  		*(out++) =      Saturate<s16>( a[3] >> 11 );
-  		*(out++) =      Saturate<s16>( a[2] >> 11 );
-  		*(out++) =      Saturate<s16>( a[5] >> 11 );
-  		*(out++) =      Saturate<s16>( a[4] >> 11 );
-  		*(out++) = l2 = Saturate<s16>( a[7] >> 11 );
-  		*(out++) = l1 = Saturate<s16>( a[6] >> 11 );
+  		ADPCMPredict( out, l1, l2, inp[0], book1, book2 );
+  		out+=16;
 
   		count-=32;
   	}
@@ -4,6 +4,7 @@
 
 #include "audiohle.h"
 #include "AudioHLEProcessor.h"
+#include "AudioHLEKernels.h"
 
 #include "Core/Memory.h"
 #include "Math/MathUtil.h"
@@ -13,11 +14,6 @@
 extern bool isMKABI;
 extern bool isZeldaABI;
 
-inline s32		FixedPointMul16( s32 a, s32 b )
-{
-	return s32( ( a * b ) >> 16 );
-}
-
 void RESAMPLE(AudioHLECommand command)
 {
 	#ifdef DEBUG_AUDIO
@@ -51,9 +47,7 @@ void RESAMPLE3(AudioHLECommand command)
   	u32 Pitch=((command.cmd1>>0xe)&0xffff) << 1;
   	u32 addy = (command.cmd0 & 0xffffff);
   	u32 Accum;
-  	s16 *dst;
   	s16 *src;
-  	dst=(s16 *)(gAudioHLEState.Buffer);
   	src=(s16 *)(gAudioHLEState.Buffer);
   	u32 srcPtr=((((command.cmd1>>2)&0xfff)+0x4f0)/2);
   	u32 dstPtr;//=(gAudioHLEState.OutBuffer/2);
@@ -74,14 +68,7 @@ void RESAMPLE3(AudioHLECommand command)
   		Accum = 0;
   	}
 
-  	for(u32 i=0;i < 0x170/2;i++)
-  	{
-  		dst[dstPtr^1] = src[srcPtr^1] + FixedPointMul16( src[(srcPtr+1)^1] - src[srcPtr^1], Accum );
-  		++dstPtr;
-  		Accum += Pitch;
-  		srcPtr += (Accum>>16);
-  		Accum &= 0xFFFF;
-  	}
+  	AudioResample( src, dstPtr, srcPtr, Accum, Pitch, 0x170/2 );
 
   	((u16 *)rdram)[((addy/2))^1] = src[srcPtr^1];
   	*(u16 *)(rdram+addy+10) = u16( Accum );
@@ -0,0 +1,108 @@
+/*
+Copyright (C) 2003 Azimer
+Copyright (C) 2001,2006-2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "HLEAudio/ADPCMPredict.h"
+
+#include "Math/MathUtil.h"
+
+//
+//	l1/l2 are IN/OUT
+//
+static inline void DecodeSamples( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 )
+{
+	s32 a[8];
+
+	a[0]= (s32)book1[0]*l1;
+	a[0]+=(s32)book2[0]*l2;
+	a[0]+=input[0]*2048;
+
+	a[1] =(s32)book1[1]*l1;
+	a[1]+=(s32)book2[1]*l2;
+	a[1]+=(s32)book2[0]*input[0];
+	a[1]+=input[1]*2048;
+
+	a[2] =(s32)book1[2]*l1;
+	a[2]+=(s32)book2[2]*l2;
+	a[2]+=(s32)book2[1]*input[0];
+	a[2]+=(s32)book2[0]*input[1];
+	a[2]+=input[2]*2048;
+
+	a[3] =(s32)book1[3]*l1;
+	a[3]+=(s32)book2[3]*l2;
+	a[3]+=(s32)book2[2]*input[0];
+	a[3]+=(s32)book2[1]*input[1];
+	a[3]+=(s32)book2[0]*input[2];
+	a[3]+=input[3]*2048;
+
+	a[4] =(s32)book1[4]*l1;
+	a[4]+=(s32)book2[4]*l2;
+	a[4]+=(s32)book2[3]*input[0];
+	a[4]+=(s32)book2[2]*input[1];
+	a[4]+=(s32)book2[1]*input[2];
+	a[4]+=(s32)book2[0]*input[3];
+	a[4]+=input[4]*2048;
+
+	a[5] =(s32)book1[5]*l1;
+	a[5]+=(s32)book2[5]*l2;
+	a[5]+=(s32)book2[4]*input[0];
+	a[5]+=(s32)book2[3]*input[1];
+	a[5]+=(s32)book2[2]*input[2];
+	a[5]+=(s32)book2[1]*input[3];
+	a[5]+=(s32)book2[0]*input[4];
+	a[5]+=input[5]*2048;
+
+	a[6] =(s32)book1[6]*l1;
+	a[6]+=(s32)book2[6]*l2;
+	a[6]+=(s32)book2[5]*input[0];
+	a[6]+=(s32)book2[4]*input[1];
+	a[6]+=(s32)book2[3]*input[2];
+	a[6]+=(s32)book2[2]*input[3];
+	a[6]+=(s32)book2[1]*input[4];
+	a[6]+=(s32)book2[0]*input[5];
+	a[6]+=input[6]*2048;
+
+	a[7] =(s32)book1[7]*l1;
+	a[7]+=(s32)book2[7]*l2;
+	a[7]+=(s32)book2[6]*input[0];
+	a[7]+=(s32)book2[5]*input[1];
+	a[7]+=(s32)book2[4]*input[2];
+	a[7]+=(s32)book2[3]*input[3];
+	a[7]+=(s32)book2[2]*input[4];
+	a[7]+=(s32)book2[1]*input[5];
+	a[7]+=(s32)book2[0]*input[6];
+	a[7]+=input[7]*2048;
+
+	*out++ =      Saturate<s16>( a[1] >> 11 );
+	*out++ =      Saturate<s16>( a[0] >> 11 );
+	*out++ =      Saturate<s16>( a[3] >> 11 );
+	*out++ =      Saturate<s16>( a[2] >> 11 );
+	*out++ =      Saturate<s16>( a[5] >> 11 );
+	*out++ =      Saturate<s16>( a[4] >> 11 );
+	*out++ = l2 = Saturate<s16>( a[7] >> 11 );
+	*out++ = l1 = Saturate<s16>( a[6] >> 11 );
+}
+
+
+void ADPCMPredictScalar( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 )
+{
+	DecodeSamples( out + 0, l1, l2, input + 0, book1, book2 );
+	DecodeSamples( out + 8, l1, l2, input + 8, book1, book2 );
+}
@@ -0,0 +1,62 @@
+/*
+Copyright (C) 2003 Azimer
+Copyright (C) 2001,2006-2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef HLEAUDIO_ADPCMPREDICT_H_
+#define HLEAUDIO_ADPCMPREDICT_H_
+
+#include "Utility/DaedalusTypes.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DAEDALUS_SIMD_ADPCM
+#endif
+
+//*****************************************************************************
+//	The 8 tap predictor shared by the ADPCM commands of every ABI. Turns one
+//	16 sample frame of unpacked (and scaled) residuals into pcm, using the
+//	frame's codebook. Each half of the frame is:
+//
+//		a[k] = book1[k]*l1 + book2[k]*l2 + sum(j<k) book2[k-1-j]*input[j] + input[k]*2048
+//
+//	written out as Saturate<s16>(a[k^1] >> 11), to match the word swapped
+//	layout of DMEM. l1/l2 are the last two samples of the previous half (as
+//	out[7] and out[6]) and are updated to those of this frame.
+//
+//	ADPCMPredictScalar is the reference. ADPCMPredictSIMD gives the same
+//	results with SSE2/NEON, as long as l1/l2 and the inputs are 16 bit
+//	values, which they always are: the samples come from DMEM or Saturate,
+//	and the nibbles are at most scaled down.
+//*****************************************************************************
+void	ADPCMPredictScalar( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 );
+#ifdef DAEDALUS_SIMD_ADPCM
+void	ADPCMPredictSIMD( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 );
+#endif
+
+inline void ADPCMPredict( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 )
+{
+#ifdef DAEDALUS_SIMD_ADPCM
+	ADPCMPredictSIMD( out, l1, l2, input, book1, book2 );
+#else
+	ADPCMPredictScalar( out, l1, l2, input, book1, book2 );
+#endif
+}
+
+#endif // HLEAUDIO_ADPCMPREDICT_H_
@@ -0,0 +1,194 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	SSE2/NEON version of ADPCMPredictScalar. The predictor is a matrix times
+//	the vector (l1, l2, input[0..7]): column j of the input part is
+//	(2048, book2[0], book2[1], ...) moved down j rows, so each column is the
+//	same register shifted by j lanes. The columns only depend on the codebook,
+//	so they're built once and used for both halves of the frame; what's left
+//	is ten multiply-accumulates of a column by a broadcast input, with all
+//	eight outputs done at once.
+//
+//	The products are 16x16 bit and summed in 32 bit lanes, which wrap just as
+//	the scalar sums do, and both narrowing instructions saturate exactly as
+//	Saturate<s16>, so the output is identical.
+//
+
+#include "stdafx.h"
+#include "HLEAudio/ADPCMPredict.h"
+
+#ifdef DAEDALUS_SIMD_ADPCM
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+
+#if defined(__SSE2__)
+
+//*****************************************************************************
+//	SSE2. _mm_madd_epi16 does two of the multiply-accumulates at once, so the
+//	columns are interleaved in pairs to match an input pair in each 32 bit lane
+//*****************************************************************************
+namespace
+{
+	struct SColumns
+	{
+		__m128i		Lo[ 5 ];		// Rows 0-3 of each column pair
+		__m128i		Hi[ 5 ];		// Rows 4-7
+	};
+
+	inline void BuildColumns( SColumns & c, const s16 * book1, const s16 * book2 )
+	{
+		const __m128i	b1( _mm_loadu_si128( (const __m128i *)book1 ) );
+		const __m128i	b2( _mm_loadu_si128( (const __m128i *)book2 ) );
+		const __m128i	col( _mm_insert_epi16( _mm_slli_si128( b2, 2 ), 2048, 0 ) );
+
+		const __m128i	c0( col );
+		const __m128i	c1( _mm_slli_si128( col, 2 ) );
+		const __m128i	c2( _mm_slli_si128( col, 4 ) );
+		const __m128i	c3( _mm_slli_si128( col, 6 ) );
+		const __m128i	c4( _mm_slli_si128( col, 8 ) );
+		const __m128i	c5( _mm_slli_si128( col, 10 ) );
+		const __m128i	c6( _mm_slli_si128( col, 12 ) );
+		const __m128i	c7( _mm_slli_si128( col, 14 ) );
+
+		c.Lo[ 0 ] = _mm_unpacklo_epi16( b1, b2 );	c.Hi[ 0 ] = _mm_unpackhi_epi16( b1, b2 );
+		c.Lo[ 1 ] = _mm_unpacklo_epi16( c0, c1 );	c.Hi[ 1 ] = _mm_unpackhi_epi16( c0, c1 );
+		c.Lo[ 2 ] = _mm_unpacklo_epi16( c2, c3 );	c.Hi[ 2 ] = _mm_unpackhi_epi16( c2, c3 );
+		c.Lo[ 3 ] = _mm_unpacklo_epi16( c4, c5 );	c.Hi[ 3 ] = _mm_unpackhi_epi16( c4, c5 );
+		c.Lo[ 4 ] = _mm_unpacklo_epi16( c6, c7 );	c.Hi[ 4 ] = _mm_unpackhi_epi16( c6, c7 );
+	}
+
+	inline void Predict8( const SColumns & c, s16 * out, s32 & l1, s32 & l2, const s32 * input )
+	{
+		// The inputs are all 16 bit values, so packing doesn't change them
+		const __m128i	in( _mm_packs_epi32( _mm_loadu_si128( (const __m128i *)input ), _mm_loadu_si128( (const __m128i *)(input + 4) ) ) );
+		const __m128i	l( _mm_set1_epi32( (l1 & 0xffff) | (l2 << 16) ) );
+
+		__m128i			lo( _mm_madd_epi16( c.Lo[ 0 ], l ) );
+		__m128i			hi( _mm_madd_epi16( c.Hi[ 0 ], l ) );
+
+		__m128i			x;
+		x = _mm_shuffle_epi32( in, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		lo = _mm_add_epi32( lo, _mm_madd_epi16( c.Lo[ 1 ], x ) );
+		hi = _mm_add_epi32( hi, _mm_madd_epi16( c.Hi[ 1 ], x ) );
+		x = _mm_shuffle_epi32( in, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		lo = _mm_add_epi32( lo, _mm_madd_epi16( c.Lo[ 2 ], x ) );
+		hi = _mm_add_epi32( hi, _mm_madd_epi16( c.Hi[ 2 ], x ) );
+		x = _mm_shuffle_epi32( in, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		lo = _mm_add_epi32( lo, _mm_madd_epi16( c.Lo[ 3 ], x ) );
+		hi = _mm_add_epi32( hi, _mm_madd_epi16( c.Hi[ 3 ], x ) );
+		x = _mm_shuffle_epi32( in, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		lo = _mm_add_epi32( lo, _mm_madd_epi16( c.Lo[ 4 ], x ) );
+		hi = _mm_add_epi32( hi, _mm_madd_epi16( c.Hi[ 4 ], x ) );
+
+		const __m128i	r( _mm_packs_epi32( _mm_srai_epi32( lo, 11 ), _mm_srai_epi32( hi, 11 ) ) );
+
+		// Swap each pair of samples
+		_mm_storeu_si128( (__m128i *)out, _mm_or_si128( _mm_slli_epi32( r, 16 ), _mm_srli_epi32( r, 16 ) ) );
+
+		l1 = s16( _mm_extract_epi16( r, 6 ) );
+		l2 = s16( _mm_extract_epi16( r, 7 ) );
+	}
+}
+
+#else
+
+//*****************************************************************************
+//	NEON. vmlal_lane_s16 multiplies a column by one input lane directly
+//*****************************************************************************
+namespace
+{
+	struct SColumns
+	{
+		int16x4_t	Lo[ 10 ];		// Rows 0-3 of book1, book2 and the eight input columns
+		int16x4_t	Hi[ 10 ];		// Rows 4-7
+	};
+
+	inline void BuildColumns( SColumns & c, const s16 * book1, const s16 * book2 )
+	{
+		const int16x8_t	zero( vdupq_n_s16( 0 ) );
+		const int16x8_t	b1( vld1q_s16( book1 ) );
+		const int16x8_t	b2( vld1q_s16( book2 ) );
+		const int16x8_t	col( vsetq_lane_s16( 2048, vextq_s16( zero, b2, 7 ), 0 ) );
+
+		int16x8_t		cols[ 10 ];
+		cols[ 0 ] = b1;
+		cols[ 1 ] = b2;
+		cols[ 2 ] = col;
+		cols[ 3 ] = vextq_s16( zero, col, 7 );
+		cols[ 4 ] = vextq_s16( zero, col, 6 );
+		cols[ 5 ] = vextq_s16( zero, col, 5 );
+		cols[ 6 ] = vextq_s16( zero, col, 4 );
+		cols[ 7 ] = vextq_s16( zero, col, 3 );
+		cols[ 8 ] = vextq_s16( zero, col, 2 );
+		cols[ 9 ] = vextq_s16( zero, col, 1 );
+
+		for( u32 i = 0; i < 10; ++i )
+		{
+			c.Lo[ i ] = vget_low_s16( cols[ i ] );
+			c.Hi[ i ] = vget_high_s16( cols[ i ] );
+		}
+	}
+
+	inline void Predict8( const SColumns & c, s16 * out, s32 & l1, s32 & l2, const s32 * input )
+	{
+		// The inputs are all 16 bit values, so narrowing doesn't change them
+		const int16x4_t	in_lo( vmovn_s32( vld1q_s32( input ) ) );
+		const int16x4_t	in_hi( vmovn_s32( vld1q_s32( input + 4 ) ) );
+
+		int32x4_t		lo( vmull_n_s16( c.Lo[ 0 ], s16( l1 ) ) );
+		int32x4_t		hi( vmull_n_s16( c.Hi[ 0 ], s16( l1 ) ) );
+		lo = vmlal_n_s16( lo, c.Lo[ 1 ], s16( l2 ) );
+		hi = vmlal_n_s16( hi, c.Hi[ 1 ], s16( l2 ) );
+
+		lo = vmlal_lane_s16( lo, c.Lo[ 2 ], in_lo, 0 );		hi = vmlal_lane_s16( hi, c.Hi[ 2 ], in_lo, 0 );
+		lo = vmlal_lane_s16( lo, c.Lo[ 3 ], in_lo, 1 );		hi = vmlal_lane_s16( hi, c.Hi[ 3 ], in_lo, 1 );
+		lo = vmlal_lane_s16( lo, c.Lo[ 4 ], in_lo, 2 );		hi = vmlal_lane_s16( hi, c.Hi[ 4 ], in_lo, 2 );
+		lo = vmlal_lane_s16( lo, c.Lo[ 5 ], in_lo, 3 );		hi = vmlal_lane_s16( hi, c.Hi[ 5 ], in_lo, 3 );
+		lo = vmlal_lane_s16( lo, c.Lo[ 6 ], in_hi, 0 );		hi = vmlal_lane_s16( hi, c.Hi[ 6 ], in_hi, 0 );
+		lo = vmlal_lane_s16( lo, c.Lo[ 7 ], in_hi, 1 );		hi = vmlal_lane_s16( hi, c.Hi[ 7 ], in_hi, 1 );
+		lo = vmlal_lane_s16( lo, c.Lo[ 8 ], in_hi, 2 );		hi = vmlal_lane_s16( hi, c.Hi[ 8 ], in_hi, 2 );
+		lo = vmlal_lane_s16( lo, c.Lo[ 9 ], in_hi, 3 );		hi = vmlal_lane_s16( hi, c.Hi[ 9 ], in_hi, 3 );
+
+		const int16x8_t	r( vcombine_s16( vqshrn_n_s32( lo, 11 ), vqshrn_n_s32( hi, 11 ) ) );
+
+		// Swap each pair of samples
+		vst1q_s16( out, vrev32q_s16( r ) );
+
+		l1 = vgetq_lane_s16( r, 6 );
+		l2 = vgetq_lane_s16( r, 7 );
+	}
+}
+
+#endif
+
+void ADPCMPredictSIMD( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 )
+{
+	SColumns	c;
+	BuildColumns( c, book1, book2 );
+
+	Predict8( c, out + 0, l1, l2, input + 0 );
+	Predict8( c, out + 8, l1, l2, input + 8 );
+}
+
+#endif // DAEDALUS_SIMD_ADPCM
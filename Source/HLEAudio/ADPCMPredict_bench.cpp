@@ -0,0 +1,331 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Checks ADPCMPredictSIMD against ADPCMPredictScalar, then times both.
+//
+//	Most of the frames are encoded from test tones and noise the way the
+//	sound banks in games are: second order predictor codebooks, and a scale
+//	and 4 bit residuals picked per frame to follow the signal. Decoding those
+//	gives the sample ranges and state carried between frames that the ADPCM
+//	commands see in practice. The rest are random codebooks, state and
+//	residuals, to push the sums into wrapping and most outputs into
+//	saturation. Every output and the l1/l2 state must match exactly.
+//
+
+#include "stdafx.h"
+#include "HLEAudio/ADPCMPredict.h"
+#include "Math/MathUtil.h"
+#include "Utility/Timing.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+namespace
+{
+	const u32	kNumBooks = 16;
+	const u32	kFramesPerSignal = 2048;
+	const u32	kNumStressFrames = 1000000;
+	const u32	kBenchFrames = 4096;			// 64K samples
+	const u32	kBenchRuns = 200;
+
+	u32		gState( 0x2468ace0 );
+
+	u32		Rand()
+	{
+		gState = gState * 1664525 + 1013904223;
+		return gState;
+	}
+
+	s16		RandS16()
+	{
+		return s16( Rand() >> 16 );
+	}
+
+	struct SBook
+	{
+		s16		Book1[ 8 ];		// Response to the sample before last
+		s16		Book2[ 8 ];		// Response to the last sample, and to each residual
+	};
+
+	struct SFrame
+	{
+		u32		Book;
+		s32		Input[ 16 ];
+	};
+
+	// The codebook for x[n] = c1*x[n-1] + c2*x[n-2], in 11 bit fixed point
+	void	MakeBook( SBook & book, f32 c1, f32 c2 )
+	{
+		for( u32 b = 0; b < 2; ++b )
+		{
+			f32		x2( b == 0 ? 1.0f : 0.0f );
+			f32		x1( b == 0 ? 0.0f : 1.0f );
+			s16 *	out( b == 0 ? book.Book1 : book.Book2 );
+			for( u32 k = 0; k < 8; ++k )
+			{
+				f32		x( c1 * x1 + c2 * x2 );
+				out[ k ] = s16( Clamp< s32 >( s32( floorf( x * 2048.0f + 0.5f ) ), -32768, 32767 ) );
+				x2 = x1;
+				x1 = x;
+			}
+		}
+	}
+
+	// Picks residuals for 8 samples with the given scale, and returns the squared error
+	f64		EncodeHalf( const SBook & book, s32 l1, s32 l2, const s16 * target, u32 scale, s32 * input, s32 * decoded )
+	{
+		f64		error( 0.0 );
+		for( u32 k = 0; k < 8; ++k )
+		{
+			s32		a( book.Book1[ k ] * l1 + book.Book2[ k ] * l2 );
+			for( u32 j = 0; j < k; ++j )
+			{
+				a += book.Book2[ k - 1 - j ] * input[ j ];
+			}
+
+			// The residual needed, in units of 1 << scale, rounded and clamped to a nibble
+			s32		want( ( target[ k ] * 2048 - a ) / 2048 );
+			s32		nibble( Clamp< s32 >( ( want + ( want >= 0 ? 1 : -1 ) * ( 1 << scale ) / 2 ) >> scale, -8, 7 ) );
+
+			// As ADPCMDecode unpacks it
+			s32		value( s16( nibble << 12 ) );
+			input[ k ] = scale < 12 ? ( value * ( 0x8000 >> ( 11 - scale ) ) ) >> 16 : value;
+
+			decoded[ k ] = Saturate< s16 >( ( a + input[ k ] * 2048 ) >> 11 );
+			f64		diff( decoded[ k ] - target[ k ] );
+			error += diff * diff;
+		}
+		return error;
+	}
+
+	// Returns the signal to noise ratio in dB
+	f64		EncodeSignal( std::vector< SFrame > & frames, const SBook * books, const s16 * signal, u32 num_frames, u32 first_book )
+	{
+		s32		l1( 0 ), l2( 0 );
+		f64		signal_power( 0.0 ), noise_power( 0.0 );
+		for( u32 f = 0; f < num_frames; ++f )
+		{
+			SFrame		best;
+			f64			best_error( -1.0 );
+			s32			best_l1( 0 ), best_l2( 0 );
+
+			for( u32 b = first_book; b < first_book + 4; ++b )
+			{
+				for( u32 scale = 0; scale <= 12; ++scale )
+				{
+					SFrame		frame;
+					s32			decoded[ 16 ];
+					frame.Book = b;
+					f64			error( EncodeHalf( books[ b ], l1, l2, signal + f * 16, scale, frame.Input, decoded ) );
+					error += EncodeHalf( books[ b ], decoded[ 6 ], decoded[ 7 ], signal + f * 16 + 8, scale, frame.Input + 8, decoded + 8 );
+					if( best_error < 0.0 || error < best_error )
+					{
+						best = frame;
+						best_error = error;
+						best_l1 = decoded[ 14 ];
+						best_l2 = decoded[ 15 ];
+					}
+				}
+			}
+
+			frames.push_back( best );
+			l1 = best_l1;
+			l2 = best_l2;
+			noise_power += best_error;
+			for( u32 i = 0; i < 16; ++i )
+			{
+				signal_power += f64( signal[ f * 16 + i ] ) * signal[ f * 16 + i ];
+			}
+		}
+		return 10.0 * log10( signal_power / ( noise_power > 0.0 ? noise_power : 1.0 ) );
+	}
+
+	void	MakeFrames( std::vector< SBook > & books, std::vector< SFrame > & frames )
+	{
+		// Four codebooks each for a low tone, a high tone, a sweep and noise, from typical predictors
+		static const f32	coeffs[ kNumBooks ][ 2 ] =
+		{
+			{ 1.95f, -0.96f }, { 1.90f, -0.92f }, { 1.80f, -0.85f }, { 1.99f, -0.995f },
+			{ 0.60f, -0.70f }, { 0.20f, -0.50f }, { -0.50f, -0.30f }, { 1.00f, -0.60f },
+			{ 1.50f, -0.70f }, { 1.00f, -0.30f }, { 0.50f, 0.20f }, { 1.70f, -0.75f },
+			{ 0.00f, 0.00f }, { 0.30f, 0.10f }, { -0.40f, 0.20f }, { 0.90f, -0.20f },
+		};
+
+		books.resize( kNumBooks );
+		for( u32 i = 0; i < kNumBooks; ++i )
+		{
+			MakeBook( books[ i ], coeffs[ i ][ 0 ], coeffs[ i ][ 1 ] );
+		}
+
+		std::vector< s16 >	signal( kFramesPerSignal * 16 );
+		f64					snr[ 4 ];
+		for( u32 s = 0; s < 4; ++s )
+		{
+			f32		phase( 0.0f );
+			for( u32 i = 0; i < signal.size(); ++i )
+			{
+				f32		t( f32( i ) / signal.size() );
+				f32		x( 0.0f );
+				switch( s )
+				{
+				case 0:	x = 0.9f * sinf( f32( i ) * 0.02f );								break;
+				case 1:	x = 0.5f * sinf( f32( i ) * 1.3f ) * ( 1.0f - t );				break;
+				case 2:	phase += 0.001f + 2.0f * t * t; x = 0.7f * sinf( phase );		break;
+				case 3:	x = f32( RandS16() ) / 32768.0f * ( i & 0x1000 ? 0.1f : 0.8f );	break;
+				}
+				signal[ i ] = s16( x * 32767.0f );
+			}
+			snr[ s ] = EncodeSignal( frames, books.data(), signal.data(), kFramesPerSignal, s * 4 );
+		}
+		printf( "Encoded test signals, SNR %.1f/%.1f/%.1f/%.1f dB\n", snr[ 0 ], snr[ 1 ], snr[ 2 ], snr[ 3 ] );
+	}
+
+#ifdef DAEDALUS_SIMD_ADPCM
+	u32		CheckFrame( const SBook & book, s32 & l1, s32 & l2, const s32 * input, u32 & failures )
+	{
+		s16		expected[ 17 ], actual[ 17 ];
+		s32		el1( l1 ), el2( l2 ), al1( l1 ), al2( l2 );
+
+		// The extra sample catches writes past the end
+		memset( expected, 0xcd, sizeof( expected ) );
+		memset( actual, 0xcd, sizeof( actual ) );
+
+		ADPCMPredictScalar( expected, el1, el2, input, book.Book1, book.Book2 );
+		ADPCMPredictSIMD( actual, al1, al2, input, book.Book1, book.Book2 );
+
+		if( memcmp( expected, actual, sizeof( expected ) ) != 0 || el1 != al1 || el2 != al2 )
+		{
+			if( failures++ < 4 )
+			{
+				printf( "  mismatch: l1 %d l2 %d -> scalar %d %d, SIMD %d %d\n", l1, l2, el1, el2, al1, al2 );
+			}
+		}
+
+		l1 = el1;
+		l2 = el2;
+
+		u32		saturated( 0 );
+		for( u32 i = 0; i < 16; ++i )
+		{
+			saturated += expected[ i ] == 32767 || expected[ i ] == -32768;
+		}
+		return saturated;
+	}
+
+	u32		Check( const std::vector< SBook > & books, const std::vector< SFrame > & frames )
+	{
+		u32		failures( 0 );
+		u32		saturated( 0 );
+
+		// Encoded frames, carrying the state from one to the next as the commands do
+		s32		l1( 0 ), l2( 0 );
+		for( u32 f = 0; f < frames.size(); ++f )
+		{
+			saturated += CheckFrame( books[ frames[ f ].Book ], l1, l2, frames[ f ].Input, failures );
+		}
+		printf( "%u encoded frames, %u samples saturated\n", u32( frames.size() ), saturated );
+
+		// Anything 16 bit, including what Decode4 and ADPCM3's scaling can give
+		saturated = 0;
+		for( u32 f = 0; f < kNumStressFrames; ++f )
+		{
+			SBook	book;
+			s32		input[ 16 ];
+			// Half with full range codebooks, which saturate most samples
+			const u32	shift( f & 2 ? 0 : 4 );
+			for( u32 i = 0; i < 8; ++i )
+			{
+				book.Book1[ i ] = RandS16() >> shift;
+				book.Book2[ i ] = RandS16() >> shift;
+			}
+			for( u32 i = 0; i < 16; ++i )
+			{
+				input[ i ] = ( f & 1 ) ? s16( ( Rand() >> 28 ) << 12 ) : RandS16();
+			}
+			if( f % 7 == 0 )
+			{
+				book.Book1[ Rand() & 7 ] = -32768;
+				book.Book2[ Rand() & 7 ] = -32768;
+				input[ Rand() & 15 ] = -32768;
+			}
+
+			s32		l1( RandS16() ), l2( f % 5 == 0 ? -32768 : RandS16() );
+			saturated += CheckFrame( book, l1, l2, input, failures );
+		}
+		printf( "%u random frames, %u samples saturated\n", kNumStressFrames, saturated );
+
+		return failures;
+	}
+#endif // DAEDALUS_SIMD_ADPCM
+
+	typedef void (*PredictFunction)( s16 *, s32 &, s32 &, const s32 *, const s16 *, const s16 * );
+
+	// Returns millions of samples per second
+	f64		Time( PredictFunction fn, const std::vector< SBook > & books, const std::vector< SFrame > & frames )
+	{
+		std::vector< s16 >	out( kBenchFrames * 16 );
+		u32		num_frames( Min< u32 >( kBenchFrames, frames.size() ) );
+
+		u64		freq( 0 ), start( 0 ), end( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+		NTiming::GetPreciseTime( &start );
+
+		for( u32 r = 0; r < kBenchRuns; ++r )
+		{
+			s32		l1( 0 ), l2( 0 );
+			for( u32 f = 0; f < num_frames; ++f )
+			{
+				const SBook &	book( books[ frames[ f ].Book ] );
+				fn( &out[ f * 16 ], l1, l2, frames[ f ].Input, book.Book1, book.Book2 );
+			}
+		}
+
+		NTiming::GetPreciseTime( &end );
+
+		f64		seconds( f64( end - start ) / f64( freq ) );
+		return seconds > 0.0 ? f64( kBenchRuns ) * num_frames * 16 / seconds / 1000000.0 : 0.0;
+	}
+}
+
+int main()
+{
+	std::vector< SBook >	books;
+	std::vector< SFrame >	frames;
+	MakeFrames( books, frames );
+
+#ifndef DAEDALUS_SIMD_ADPCM
+	printf( "No SIMD ADPCM in this build\n" );
+	printf( "Scalar: %.1f Msamples/s\n", Time( ADPCMPredictScalar, books, frames ) );
+	return 0;
+#else
+	u32		failures( Check( books, frames ) );
+	printf( "ADPCMPredictSIMD: %s\n\n", failures == 0 ? "matches scalar" : "MISMATCH" );
+
+	f64		scalar_mss( Time( ADPCMPredictScalar, books, frames ) );
+	f64		simd_mss( Time( ADPCMPredictSIMD, books, frames ) );
+	printf( "%12s %12s %9s\n", "scalar Ms/s", "SIMD Ms/s", "speedup" );
+	printf( "%12.1f %12.1f %8.2fx\n", scalar_mss, simd_mss, simd_mss / scalar_mss );
+
+	return failures == 0 ? 0 : 1;
+#endif
+}
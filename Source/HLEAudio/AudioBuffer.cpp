@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Config/ConfigOptions.h"
 #include "Debug/DBGConsole.h"
+#include "HLEAudio/AudioHLEKernels.h"
 #include "Utility/Thread.h"
 
 #ifdef DAEDALUS_PSP
@@ -30,35 +31,90 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "SysPSP/Utility/CacheUtil.h"
 #endif
 
+namespace
+{
+// Each stat only has one writer, so a plain load and store is enough to bump
+// it, and works on the PSP's ME, which has no ll/sc for an atomic add.
+inline void Bump( std::atomic< u32 > & counter, u32 amount = 1 )
+{
+	counter.store( counter.load( std::memory_order_relaxed ) + amount, std::memory_order_relaxed );
+}
+}
+
 CAudioBuffer::CAudioBuffer( u32 buffer_size )
-	:	mBufferBegin( new Sample[ buffer_size ] )
-	,	mBufferEnd( mBufferBegin + buffer_size )
-	,	mReadPtr( mBufferBegin )
-	,	mWritePtr( mBufferBegin )
+	:	mBuffer( new Sample[ buffer_size ] )
+	,	mBufferSize( buffer_size )
+	,	mReadIdx( 0 )
+	,	mWriteIdx( 0 )
+	,	mResamplePos( kResampleLookahead )
+	,	mResampleFrac( 0 )
 {
+	DAEDALUS_STATIC_ASSERT( kResampleHistory == kAudioPolyphaseTaps - 1 );
+
+	// The history starts silent, and mResamplePos puts the first output on the first sample added rather than in that silence
+	memset( mHistory, 0, sizeof( mHistory ) );
+	ResetStats();
 }
 
 CAudioBuffer::~CAudioBuffer()
 {
-	delete [] mBufferBegin;
+	delete [] mBuffer;
+}
+
+u32 CAudioBuffer::NumBuffered( u32 read_idx, u32 write_idx ) const
+{
+	return write_idx >= read_idx ? write_idx - read_idx : write_idx + mBufferSize - read_idx;
 }
 
 u32 CAudioBuffer::GetNumBufferedSamples() const
 {
-	 //Todo: Check Cache Routines
-// #ifdef DAEDALUS_PSP
-// 	dcache_wbinv_all();
-// #endif
+	// Loading the read index first means the count is never more than was
+	// really there: the write index can only have moved forward since.
+	u32 read_idx( mReadIdx.load( std::memory_order_acquire ) );
+	u32 write_idx( mWriteIdx.load( std::memory_order_acquire ) );
 
-	// Safe? What if we read mWrite, and then mRead moves to start of buffer?
-	s32 diff = mWritePtr - mReadPtr;
+	return NumBuffered( read_idx, write_idx );
+}
+
+u32 CAudioBuffer::WriteResampled( const Sample * in, u32 num_in, u32 step, u32 & read_idx, u32 & write_idx, bool & overrun )
+{
+	u32		num_out( 0 );
 
-	if( diff < 0 )
+	while( mResamplePos < num_in )
 	{
-		diff += (mBufferEnd - mBufferBegin);	// Add on buffer length
+		// Resample straight into the buffer, up to the wrap or the slot before the read index
+		u32		end( read_idx > write_idx ? read_idx - 1 : ( read_idx == 0 ? mBufferSize - 1 : mBufferSize ) );
+
+		if( write_idx == end )
+		{
+			// The buffer is full - hand over what we've got so far, then spin
+			// until the read index advances.
+			//    Note - spends a lot of time here if program is running
+			//    fast. This loop locks the speed to the playback rate
+			//    as the program winds up waiting for the buffer to empty.
+			// ToDo: Adjust Audio Frequency/ Look at Turok in this regard.
+			mWriteIdx.store( write_idx, std::memory_order_release );
+			overrun = true;
+
+			const u32	full_idx( read_idx );
+			do
+			{
+				read_idx = mReadIdx.load( std::memory_order_acquire );
+			}
+			while( read_idx == full_idx );
+			continue;
+		}
+
+		const u32	n( AudioPolyphase( mBuffer + write_idx, end - write_idx, in, num_in, mResamplePos, mResampleFrac, step ) );
+
+		write_idx += n;
+		if( write_idx >= mBufferSize )
+			write_idx = 0;
+
+		num_out += n;
 	}
 
-	return diff;
+	return num_out;
 }
 
 void CAudioBuffer::AddSamples( const Sample * samples, u32 num_samples, u32 frequency, u32 output_freq )
@@ -73,139 +129,161 @@ void CAudioBuffer::AddSamples( const Sample * samples, u32 num_samples, u32 freq
 	//}
 	//fwrite( samples, sizeof( Sample ), num_samples, fh );
 	//fflush( fh );
-	//clear the Cache
-	#ifdef DAEDALUS_PSP
-	//sceKernelDcacheWritebackInvalidateAll();
-	#endif
-	const Sample *	read_ptr( mReadPtr );		// No need to invalidate, as this is uncached/volatile
-	Sample *		write_ptr( mWritePtr );
+
+	// On the PSP this runs on the ME through an uncached pointer, so the
+	// buffer and indices go straight to memory and there's nothing to flush.
+	u32		read_idx( mReadIdx.load( std::memory_order_acquire ) );
+	u32		write_idx( mWriteIdx.load( std::memory_order_relaxed ) );		// Only we write it
+	bool	overrun( false );
 
 	//
-	//	'r' is the number of input samples we progress through for each output sample.
-	//	's' keeps track of how far between the current two input samples we are.
-	//	We increment it by 'r' for each output sample we generate.
-	//	When it reaches 1.0, we know we've hit the next sample, so we increment in_idx
-	//	and reduce s by 1.0 (to keep it in the range 0.0 .. 1.0)
-	//	Principle is the same but rewritten to integer mode (faster & less ASM) //Corn
-
-	const s32 r( (frequency << 12)  / output_freq );
-	s32		  s( 0 );
-	u32		  in_idx( 0 );
-	u32		  output_samples( (( num_samples * output_freq ) / frequency) - 1);
-
-	for( u32 i = output_samples; i != 0 ; i-- )
+	//	The resampler reads from the history followed by the new samples. The
+	//	first few outputs need both, so they come from a copy of the history
+	//	and the start of the new samples, and the rest straight from samples.
+	//
+	const u32	step( u32( ( u64( frequency ) << 16 ) / output_freq ) );
+	const u32	num_staged( num_samples < kResampleHistory ? num_samples : kResampleHistory );
+	Sample		staged[ kResampleHistory * 2 ];
+
+	memcpy( staged, mHistory, sizeof( mHistory ) );
+	memcpy( staged + kResampleHistory, samples, num_staged * sizeof( Sample ) );
+
+	u32		output_samples( WriteResampled( staged, num_staged, step, read_idx, write_idx, overrun ) );
+
+	if( num_samples > kResampleHistory )
 	{
-		#ifdef DAEDALUS_ENABLE_ASSERTS
-		DAEDALUS_ASSERT( in_idx + 1 < num_samples, "Input index out of range - %d / %d", in_idx+1, num_samples );
-#endif
-//#if 0 // 1->Sine tone, 0->Normal
-		//static float c= 0.0f;
-		//c += 100.0f / 44100.0f;
-		//if( c >= 1.0f )
-		//  c-=1.f;
-		//s16 v( s16( SHRT_MAX * sinf( c * 3.141f*2 ) ) );
-		// Sample	out;
-		// s16 v = WriteCounter++;
-		// if( WriteCounter >= MAX_COUNTER )
-		// {
-		// 	printf( "Loop write\n" );
-		// 	WriteCounter = 0;
-		// }
-		// out.L = out.R = v;
-		//
-// #else
-		// Resample in integer mode (faster & less ASM code) //Corn
-		Sample	out;
-
-		out.L = samples[ in_idx ].L + ((( samples[ in_idx + 1 ].L - samples[ in_idx ].L ) * s ) >> 12 );
-		out.R = samples[ in_idx ].R + ((( samples[ in_idx + 1 ].R - samples[ in_idx ].R ) * s ) >> 12 );
-
-		s += r;
-		in_idx += s >> 12;
-		s &= 4095;
-// #endif
-
-		write_ptr++;
-		if( write_ptr >= mBufferEnd )
-			write_ptr = mBufferBegin;
-
-		while( write_ptr == read_ptr )
-		{
-			// The buffer is full - spin until the read pointer advances.
-			//    Note - spends a lot of time here if program is running
-			//    fast. This loop locks the speed to the playback rate
-			//    as the program winds up waiting for the buffer to empty.
-			// ToDo: Adjust Audio Frequency/ Look at Turok in this regard.
-			// We might want to put a Sleep in when executing on the SC?
-			//Give time to other threads when using SYNC mode.
-		//ThreadYield();
+		mResamplePos -= kResampleHistory;
+		output_samples += WriteResampled( samples, num_samples - kResampleHistory, step, read_idx, write_idx, overrun );
+		mResamplePos += kResampleHistory;
 
-			read_ptr = mReadPtr;
-		}
+		memcpy( mHistory, samples + num_samples - kResampleHistory, sizeof( mHistory ) );
+	}
+	else
+	{
+		memcpy( mHistory, staged + num_samples, sizeof( mHistory ) );
+	}
+	mResamplePos -= num_samples;
+
+	mWriteIdx.store( write_idx, std::memory_order_release );
 
-		*write_ptr = out;
+	//
+	//	Stats
+	//
+	Bump( mSamplesAdded, output_samples );
+	if( overrun )
+	{
+		Bump( mOverruns );
 	}
 
-	//Todo: Check Cache Routines
-	// Ensure samples array is written back before mWritePtr
-	//dcache_wbinv_range_unaligned( mBufferBegin, mBufferEnd );
+	u32 latency( NumBuffered( mReadIdx.load( std::memory_order_acquire ), write_idx ) );
+	u32 latency_sum( mLatencySum.load( std::memory_order_relaxed ) );
+	u32 latency_count( mLatencyCount.load( std::memory_order_relaxed ) );
+
+	if( latency_sum >= 0x80000000 )
+	{
+		latency_sum >>= 1;
+		latency_count >>= 1;
+	}
+	mLatencySum.store( latency_sum + latency, std::memory_order_relaxed );
+	mLatencyCount.store( latency_count + 1, std::memory_order_relaxed );
 
-	mWritePtr = write_ptr;		// Needs cache wbinv
+	if( latency < mLatencyMin.load( std::memory_order_relaxed ) )
+		mLatencyMin.store( latency, std::memory_order_relaxed );
+	if( latency > mLatencyMax.load( std::memory_order_relaxed ) )
+		mLatencyMax.store( latency, std::memory_order_relaxed );
 }
 
 u32	CAudioBuffer::Drain( Sample * samples, u32 num_samples )
 {
-	//Todo: Check Cache Routines
-	// Ideally we could just invalidate this range?
-	//clear the Cache
-	#ifdef DAEDALUS_PSP
-	//sceKernelDcacheWritebackInvalidateAll();
-	#endif
+	u32		read_idx( mReadIdx.load( std::memory_order_relaxed ) );		// Only we write it
+	u32		write_idx( mWriteIdx.load( std::memory_order_acquire ) );
+	u32		available( NumBuffered( read_idx, write_idx ) );
+	u32		num_read( available < num_samples ? available : num_samples );
 
-	const Sample *	read_ptr( mReadPtr );		// No need to invalidate, as this is uncached/volatile
-	const Sample *	write_ptr( mWritePtr );		//
+	// At most two copies, either side of the wrap
+	u32		first( mBufferSize - read_idx );
+	if( first > num_read )
+		first = num_read;
 
-	Sample *	out_ptr( samples );
-	u32			samples_required( num_samples );
+	memcpy( samples, mBuffer + read_idx, first * sizeof( Sample ) );
+	memcpy( samples + first, mBuffer, ( num_read - first ) * sizeof( Sample ) );
 
-	while( samples_required > 0 )
-	{
-		// Check if empty
-		if( read_ptr == write_ptr )
-			break;
-
-		*out_ptr++ = *read_ptr++;
-
-		if( read_ptr >= mBufferEnd )
-			read_ptr = mBufferBegin;
-
-		samples_required--;
-	}
+	read_idx += num_read;
+	if( read_idx >= mBufferSize )
+		read_idx -= mBufferSize;
 
 	//static FILE * fh = nullptr;
 	//if( !fh )
 	//{
 	//	fh = fopen( "audio_out.raw", "wb" );
 	//}
-	//fwrite( samples, sizeof( Sample ), (num_samples-samples_required), fh );
+	//fwrite( samples, sizeof( Sample ), num_read, fh );
 	//fflush( fh );
 
-	mReadPtr = read_ptr;		// No need to invalidate, as this is uncached
-	//clear the Cache
-	#ifdef DAEDALUS_PSP
-	//sceKernelDcacheWritebackInvalidateAll();
-	#endif
+	// Done with the slots - AddSamples can have them back
+	mReadIdx.store( read_idx, std::memory_order_release );
+
 	//
 	//	If there weren't enough samples, zero out the buffer
 	//	FIXME(strmnnrmn): Unnecessary on OSX...
 	//
+	u32 samples_required( num_samples - num_read );
 	if( samples_required > 0 )
 	{
-		//DBGConsole_Msg( 0, "Buffer underflow (%d samples)\n", samples_required );
-		//printf( "Buffer underflow (%d samples)\n", samples_required );
-		memset( out_ptr, 0, samples_required * sizeof( Sample ) );
+		memset( samples + num_read, 0, samples_required * sizeof( Sample ) );
+
+		Bump( mUnderruns );
+		Bump( mUnderrunSamples, samples_required );
 	}
 
+	//
+	//	Stats
+	//
+	u32 bucket( available * SAudioBufferStats::kNumFillBuckets / ( mBufferSize - 1 ) );
+	if( bucket >= SAudioBufferStats::kNumFillBuckets )
+		bucket = SAudioBufferStats::kNumFillBuckets - 1;
+
+	Bump( mFillHistogram[ bucket ] );
+	Bump( mSamplesDrained, num_read );
+
 	// Return the number of samples written
-	return num_samples - samples_required;
+	return num_read;
+}
+
+void CAudioBuffer::GetStats( SAudioBufferStats * stats ) const
+{
+	stats->SamplesAdded    = mSamplesAdded.load( std::memory_order_relaxed );
+	stats->SamplesDrained  = mSamplesDrained.load( std::memory_order_relaxed );
+	stats->Overruns        = mOverruns.load( std::memory_order_relaxed );
+	stats->Underruns       = mUnderruns.load( std::memory_order_relaxed );
+	stats->UnderrunSamples = mUnderrunSamples.load( std::memory_order_relaxed );
+
+	for( u32 i = 0; i < SAudioBufferStats::kNumFillBuckets; ++i )
+	{
+		stats->FillHistogram[ i ] = mFillHistogram[ i ].load( std::memory_order_relaxed );
+	}
+
+	stats->LatencyMin   = mLatencyMin.load( std::memory_order_relaxed );
+	stats->LatencyMax   = mLatencyMax.load( std::memory_order_relaxed );
+	stats->LatencySum   = mLatencySum.load( std::memory_order_relaxed );
+	stats->LatencyCount = mLatencyCount.load( std::memory_order_relaxed );
+}
+
+void CAudioBuffer::ResetStats()
+{
+	mSamplesAdded.store( 0, std::memory_order_relaxed );
+	mSamplesDrained.store( 0, std::memory_order_relaxed );
+	mOverruns.store( 0, std::memory_order_relaxed );
+	mUnderruns.store( 0, std::memory_order_relaxed );
+	mUnderrunSamples.store( 0, std::memory_order_relaxed );
+
+	for( u32 i = 0; i < SAudioBufferStats::kNumFillBuckets; ++i )
+	{
+		mFillHistogram[ i ].store( 0, std::memory_order_relaxed );
+	}
+
+	mLatencyMin.store( ~0u, std::memory_order_relaxed );
+	mLatencyMax.store( 0, std::memory_order_relaxed );
+	mLatencySum.store( 0, std::memory_order_relaxed );
+	mLatencyCount.store( 0, std::memory_order_relaxed );
 }
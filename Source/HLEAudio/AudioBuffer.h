@@ -24,34 +24,103 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Utility/DaedalusTypes.h"
 
+#include <atomic>
+
 struct Sample
 {
 	s16		L;
 	s16		R;
 };
 
+//
+//	Collected by CAudioBuffer as it runs. Latencies are in output samples.
+//
+struct SAudioBufferStats
+{
+	static const u32	kNumFillBuckets = 8;
+
+	u32		SamplesAdded;
+	u32		SamplesDrained;
+
+	u32		Overruns;			// Times AddSamples found the buffer full and waited for Drain
+	u32		Underruns;			// Times Drain ran out of samples
+	u32		UnderrunSamples;	// Silence Drain padded its output with
+
+	u32		FillHistogram[ kNumFillBuckets ];	// How full the buffer was at each Drain, in eighths
+
+	// How many samples were queued when each AddSamples returned, i.e. how long its
+	// last sample waits for Drain. LatencyMin is ~0 if nothing's been added yet.
+	// LatencySum and LatencyCount get halved together rather than overflow
+	u32		LatencyMin;
+	u32		LatencyMax;
+	u32		LatencySum;
+	u32		LatencyCount;
+};
+
 // A utility class for buffering up samples, upsampling to the desired
 // output frequency and copying them to the desired output buffer.
 //
-// N.B. This class currently does no synchronisation - it's assumed that
-// the calling code will handle this
+// The resampling carries on from one AddSamples to the next, as one stream,
+// so the rate can change between calls without a click. Each output needs
+// the four input samples after it, so the last four of each call come out
+// at the start of the next.
+//
+// It's a single producer/single consumer ring: one thread can call
+// AddSamples while another calls Drain, without locking. Each side only
+// writes its own index (and its own stats), publishing it with a release
+// store which the other side loads with acquire, so the samples are always
+// written before the index that makes them visible.
 class CAudioBuffer
 {
 public:
+	static const u32	kResampleLookahead = 4;		// Input samples each call keeps back for the next
+
 	CAudioBuffer( u32 buffer_size );
 	~CAudioBuffer();
 
+	// Producer. Waits for Drain if the buffer fills up
 	void			AddSamples( const Sample * samples, u32 num_samples, u32 frequency, u32 output_freq );
+
+	// Consumer. Pads with silence if there aren't enough samples, and returns how many there were
 	u32				Drain( Sample * samples, u32 num_samples );
 
 	u32				GetNumBufferedSamples() const;
 
+	void			GetStats( SAudioBufferStats * stats ) const;
+
+	// Only while neither AddSamples nor Drain is running
+	void			ResetStats();
+
 private:
-	Sample *		mBufferBegin;
-	Sample *		mBufferEnd;
+	u32				NumBuffered( u32 read_idx, u32 write_idx ) const;
+	u32				WriteResampled( const Sample * in, u32 num_in, u32 step, u32 & read_idx, u32 & write_idx, bool & overrun );
+
+private:
+	Sample *		mBuffer;
+	u32				mBufferSize;		// Holds one sample fewer than this, so full and empty differ
+
+	std::atomic< u32 >	mReadIdx;		// Written by Drain
+	std::atomic< u32 >	mWriteIdx;		// Written by AddSamples
+
+	// Resampler state, only used by AddSamples. mResamplePos counts from the start of mHistory
+	static const u32	kResampleHistory = 7;
+	Sample			mHistory[ kResampleHistory ];		// The end of the last call's input
+	u32				mResamplePos;
+	u32				mResampleFrac;
+
+	// Written by AddSamples
+	std::atomic< u32 >	mSamplesAdded;
+	std::atomic< u32 >	mOverruns;
+	std::atomic< u32 >	mLatencyMin;
+	std::atomic< u32 >	mLatencyMax;
+	std::atomic< u32 >	mLatencySum;
+	std::atomic< u32 >	mLatencyCount;
 
-	const Sample * volatile	mReadPtr;
-	Sample * volatile		mWritePtr;
+	// Written by Drain
+	std::atomic< u32 >	mSamplesDrained;
+	std::atomic< u32 >	mUnderruns;
+	std::atomic< u32 >	mUnderrunSamples;
+	std::atomic< u32 >	mFillHistogram[ SAudioBufferStats::kNumFillBuckets ];
 };
 
 
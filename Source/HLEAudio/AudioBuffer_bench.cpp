@@ -0,0 +1,331 @@
+/*
+Copyright (C) 2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Torture test for CAudioBuffer. The main thread adds samples as the audio
+//	plugins do while a second thread drains them as the output callbacks do,
+//	both at random rates so the buffer keeps running full and running dry.
+//	Every sample carries its position in the stream, so the drain thread can
+//	check that it gets all of them, once each and in order, and silence when
+//	there aren't any. Then the stats are checked against what each side saw.
+//	Returns 1 if anything's wrong.
+//
+//	AddSamples is called with the input and output frequencies the same, so
+//	the resampler passes the samples through untouched, bar the last few of
+//	the stream, which it keeps back for the next call.
+//
+//	First, though, it checks the resampler gives the same output at 32KHz
+//	however the samples are split between calls.
+//
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "HLEAudio/AudioBuffer.h"
+#include "Math/MathUtil.h"
+#include "Utility/Thread.h"
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kDefaultCalls = 4000;
+	const u32	kBufferSize = 257;			// Odd, so the wrap lands all over the place
+	const u32	kMaxAdd = 400;				// More than the buffer holds
+	const u32	kMaxDrain = 300;
+	const u32	kFrequency = 44100;
+
+	struct SRand
+	{
+		explicit SRand( u32 seed ) : State( seed ) {}
+
+		u32		Next()
+		{
+			State = State * 1664525 + 1013904223;
+			return State >> 8;
+		}
+
+		u32		Below( u32 n )		{ return Next() % n; }
+
+		u32		State;
+	};
+
+	inline Sample	StreamSample( u32 position )
+	{
+		Sample	sample;
+		sample.L = s16( position & 0xFFFF );
+		sample.R = s16( position >> 16 );
+		return sample;
+	}
+
+	inline u32		StreamPosition( const Sample & sample )
+	{
+		return u16( sample.L ) | ( u32( u16( sample.R ) ) << 16 );
+	}
+
+	// Random gaps, so each side sometimes gets ahead of the other
+	void	Dawdle( SRand & rand )
+	{
+		switch( rand.Below( 16 ) )
+		{
+		case 0:		ThreadSleepMs( 1 );		break;
+		case 1:
+		case 2:		ThreadYield();			break;
+		default:							break;
+		}
+	}
+
+	struct SDrainer
+	{
+		CAudioBuffer *	Buffer;
+		u32				NumSamples;			// How many to wait for
+		std::atomic< bool >	AddsDone;		// So it doesn't wait forever for samples that got lost
+
+		// Results
+		u32				NumReceived;
+		u32				NumDrains;
+		u32				NumShortDrains;
+		u32				NumSilent;
+		u32				NumErrors;
+	};
+
+	u32		CheckChunking()
+	{
+		const u32	kStreamSamples = 20000;
+		const u32	kOutputSamples = kStreamSamples * 2;
+		const u32	kGameFrequency = 32000;
+
+		Sample *	stream( new Sample[ kStreamSamples ] );
+		Sample *	expected( new Sample[ kOutputSamples ] );
+		Sample *	actual( new Sample[ kOutputSamples ] );
+
+		SRand		rand( 0xc4c4c4c4 );
+		for( u32 i = 0; i < kStreamSamples; ++i )
+		{
+			stream[ i ].L = s16( rand.Next() );
+			stream[ i ].R = s16( rand.Next() );
+		}
+
+		CAudioBuffer	whole( kOutputSamples + 1 );
+		whole.AddSamples( stream, kStreamSamples, kGameFrequency, kFrequency );
+		const u32		num_expected( whole.Drain( expected, kOutputSamples ) );
+
+		CAudioBuffer	chunked( kOutputSamples + 1 );
+		for( u32 i = 0; i < kStreamSamples; )
+		{
+			const u32	n( Min( 1 + rand.Below( 50 ), kStreamSamples - i ) );
+			chunked.AddSamples( stream + i, n, kGameFrequency, kFrequency );
+			i += n;
+		}
+		const u32		num_actual( chunked.Drain( actual, kOutputSamples ) );
+
+		u32		num_errors( 0 );
+		if( num_expected != num_actual || memcmp( expected, actual, num_expected * sizeof( Sample ) ) != 0 )
+		{
+			printf( "Resampling in chunks gave %u samples, in one go %u\n", num_actual, num_expected );
+			num_errors++;
+		}
+
+		// About kFrequency / kGameFrequency of them, less the few still to come
+		const u32	num_due( u32( u64( kStreamSamples - CAudioBuffer::kResampleLookahead ) * kFrequency / kGameFrequency ) );
+		if( num_expected + 2 < num_due || num_expected > num_due + 2 )
+		{
+			printf( "Resampled %u samples to %u\n", kStreamSamples, num_expected );
+			num_errors++;
+		}
+
+		delete [] stream;
+		delete [] expected;
+		delete [] actual;
+		return num_errors;
+	}
+
+	u32 DAEDALUS_THREAD_CALL_TYPE DrainThread( void * arg )
+	{
+		SDrainer &	drainer( *static_cast< SDrainer * >( arg ) );
+		SRand		rand( 0xd7a1d7a1 );
+		Sample		samples[ kMaxDrain ];
+		u32			position( 0 );
+
+		while( position < drainer.NumSamples )
+		{
+			const u32	num_samples( 1 + rand.Below( kMaxDrain ) );
+			const bool	adds_done( drainer.AddsDone.load( std::memory_order_acquire ) );
+
+			// Scribble on it, to make sure Drain writes every sample
+			memset( samples, 0xAB, sizeof( samples ) );
+
+			const u32	num_drained( drainer.Buffer->Drain( samples, num_samples ) );
+			drainer.NumDrains++;
+
+			if( num_drained > num_samples )
+			{
+				printf( "Drain returned %u samples out of %u\n", num_drained, num_samples );
+				drainer.NumErrors++;
+				break;
+			}
+
+			for( u32 i = 0; i < num_drained; ++i, ++position )
+			{
+				if( StreamPosition( samples[ i ] ) != position && drainer.NumErrors++ < 10 )
+				{
+					printf( "Sample %u is %08x\n", position, StreamPosition( samples[ i ] ) );
+				}
+			}
+
+			if( num_drained < num_samples )
+			{
+				drainer.NumShortDrains++;
+				drainer.NumSilent += num_samples - num_drained;
+
+				for( u32 i = num_drained; i < num_samples; ++i )
+				{
+					if( ( samples[ i ].L != 0 || samples[ i ].R != 0 ) && drainer.NumErrors++ < 10 )
+					{
+						printf( "Padding after sample %u isn't silent\n", position );
+					}
+				}
+			}
+
+			if( adds_done && num_drained == 0 )
+				break;
+
+			Dawdle( rand );
+		}
+
+		drainer.NumReceived = position;
+		return 0;
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	const u32		num_calls( argc > 1 ? strtoul( argv[ 1 ], NULL, 10 ) : kDefaultCalls );
+
+	const u32		chunking_errors( CheckChunking() );
+	printf( "Resampling in chunks: %s\n", chunking_errors == 0 ? "matches" : "MISMATCH" );
+
+	CAudioBuffer *	buffer( new CAudioBuffer( kBufferSize ) );
+
+	// Work out the stream up front, so the drainer knows when to stop
+	SRand			rand( 0x5eed5eed );
+	u32 *			call_sizes( new u32[ num_calls ] );
+	u32				num_samples( 0 );
+	for( u32 c = 0; c < num_calls; ++c )
+	{
+		call_sizes[ c ] = 1 + rand.Below( kMaxAdd );
+		num_samples += call_sizes[ c ];
+	}
+	num_samples -= CAudioBuffer::kResampleLookahead;
+
+	SDrainer		drainer;
+	drainer.Buffer = buffer;
+	drainer.NumSamples = num_samples;
+	drainer.AddsDone = false;
+	drainer.NumReceived = 0;
+	drainer.NumDrains = 0;
+	drainer.NumShortDrains = 0;
+	drainer.NumSilent = 0;
+	drainer.NumErrors = 0;
+
+	u64		start( 0 ), end( 0 ), frequency( 0 );
+	NTiming::GetPreciseFrequency( &frequency );
+	NTiming::GetPreciseTime( &start );
+
+	ThreadHandle	thread( CreateThread( "AudioBufferDrain", DrainThread, &drainer ) );
+	if( thread == kInvalidThreadHandle )
+	{
+		printf( "Couldn't create the drain thread\n" );
+		return 1;
+	}
+
+	Sample	samples[ kMaxAdd ];
+	u32		position( 0 );
+	u32		max_buffered( 0 );
+	for( u32 c = 0; c < num_calls; ++c )
+	{
+		for( u32 i = 0; i < call_sizes[ c ]; ++i )
+		{
+			samples[ i ] = StreamSample( position + i );
+		}
+
+		buffer->AddSamples( samples, call_sizes[ c ], kFrequency, kFrequency );
+		position += call_sizes[ c ];
+
+		const u32	num_buffered( buffer->GetNumBufferedSamples() );
+		if( num_buffered > max_buffered )
+			max_buffered = num_buffered;
+
+		rand.Next();
+		Dawdle( rand );
+	}
+
+	drainer.AddsDone.store( true, std::memory_order_release );
+	JoinThread( thread, -1 );
+	ReleaseThreadHandle( thread );
+
+	NTiming::GetPreciseTime( &end );
+
+	SAudioBufferStats	stats;
+	buffer->GetStats( &stats );
+
+	u32		num_histogram( 0 );
+	printf( "Fill at drain:" );
+	for( u32 i = 0; i < SAudioBufferStats::kNumFillBuckets; ++i )
+	{
+		printf( " %u", stats.FillHistogram[ i ] );
+		num_histogram += stats.FillHistogram[ i ];
+	}
+	printf( "\n" );
+
+	printf( "%u samples in %u calls, %u drains: %u overruns, %u underruns (%u samples of silence)\n",
+			stats.SamplesAdded, num_calls, drainer.NumDrains, stats.Overruns, stats.Underruns, stats.UnderrunSamples );
+	printf( "Latency %u..%u samples, %.1f average (%.2f ms)\n",
+			stats.LatencyMin, stats.LatencyMax,
+			stats.LatencyCount ? f64( stats.LatencySum ) / stats.LatencyCount : 0.0,
+			stats.LatencyCount ? f64( stats.LatencySum ) * 1000.0 / ( f64( stats.LatencyCount ) * kFrequency ) : 0.0 );
+	printf( "%.1f ms\n", f64( end - start ) * 1000.0 / f64( frequency ) );
+
+	u32		num_errors( drainer.NumErrors + chunking_errors );
+	#define CHECK( x )	if( !( x ) ) { printf( "Failed: %s\n", #x ); num_errors++; }
+
+	CHECK( drainer.NumReceived == num_samples );
+	CHECK( stats.SamplesAdded == num_samples );
+	CHECK( stats.SamplesDrained == num_samples );
+	CHECK( buffer->GetNumBufferedSamples() == 0 );
+	CHECK( max_buffered < kBufferSize );
+	CHECK( num_histogram == drainer.NumDrains );
+	CHECK( stats.Underruns == drainer.NumShortDrains );
+	CHECK( stats.UnderrunSamples == drainer.NumSilent );
+	CHECK( stats.LatencyCount == num_calls );
+	CHECK( stats.LatencyMax < kBufferSize );
+	CHECK( stats.LatencyMin <= stats.LatencyMax );
+
+	#undef CHECK
+
+	delete [] call_sizes;
+	delete buffer;
+
+	printf( num_errors ? "FAILED\n" : "OK\n" );
+	return num_errors ? 1 : 0;
+}
@@ -0,0 +1,399 @@
+/*
+Copyright (C) 2003 Azimer
+Copyright (C) 2001,2006-2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "HLEAudio/AudioHLEKernels.h"
+
+#include "HLEAudio/AudioBuffer.h"
+#include "Math/MathUtil.h"
+
+void AudioMixScalar( s16 * out, const s16 * in, s32 gain, u32 num_samples )
+{
+	for( u32 x = num_samples; x != 0; x-- )
+	{
+		*out = Saturate<s16>( ( ( *in++ * gain ) >> 15 ) + s32( *out ) );
+		out++;
+	}
+}
+
+void AudioInterleaveScalar( u32 * out, const u16 * left, const u16 * right, u32 num_samples )
+{
+	for( u32 x = num_samples >> 1; x != 0; x-- )
+	{
+		const u16 r = *right++;
+		const u16 l = *left++;
+
+		*out++ = (*right++ << 16) | *left++;
+		*out++ = (r << 16) | l;
+	}
+}
+
+void AudioResampleScalar( s16 * buffer, u32 dst, u32 & src, u32 & accumulator, u32 pitch, u32 num_samples )
+{
+	u32		s( src );
+	u32		acc( accumulator );
+
+	for( u32 i = 0; i < num_samples; ++i )
+	{
+		const s32	a( buffer[ s^1 ] );
+		const s32	b( buffer[ (s+1)^1 ] );
+
+		buffer[ (dst+i)^1 ] = s16( a + s32( ( (b - a) * s32( acc ) ) >> 16 ) );
+		acc += pitch;
+		s += acc >> 16;
+		acc &= 0xFFFF;
+	}
+
+	src = s;
+	accumulator = acc;
+}
+
+void AudioEnvMixScalar( const s16 * in, s16 * out, s16 * aux1, s16 * aux2, s16 * aux3, const s32 (&vols)[4][8] )
+{
+	// Same order as the original loop, in case the buffers overlap
+	for( u32 x = 0; x < 8; ++x )
+	{
+		const u32	i( x ^ 1 );
+		const s32	i1( in[ i ] );
+		s32			o1( out[ i ] );
+		s32			a1( aux1[ i ] );
+		s32			a2( aux2 ? aux2[ i ] : 0 );
+		s32			a3( aux3 ? aux3[ i ] : 0 );
+
+		o1 += ( i1 * vols[ 0 ][ i ] + 0x4000 ) >> 15;
+		a1 += ( i1 * vols[ 1 ][ i ] + 0x4000 ) >> 15;
+
+		out[ i ] = Saturate<s16>( o1 );
+		aux1[ i ] = Saturate<s16>( a1 );
+
+		if( aux2 )
+		{
+			a2 += ( i1 * vols[ 2 ][ i ] + 0x4000 ) >> 15;
+			a3 += ( i1 * vols[ 3 ][ i ] + 0x4000 ) >> 15;
+
+			aux2[ i ] = Saturate<s16>( a2 );
+			aux3[ i ] = Saturate<s16>( a3 );
+		}
+	}
+}
+
+//
+//	Kaiser windowed (beta 6) sinc weights for in[pos..pos+7] at each phase, in
+//	1.14 with each row summing to 1.0. Phase 0 passes in[pos+3] straight
+//	through, and the extra last row in[pos+4], for fractions that round up.
+//	Generated with:
+//		w[k] = sinc(x) * I0(6 * sqrt(1 - (x/4)^2)) / I0(6), x = k - 3 - phase/256
+//		c[k] = round(w[k] * 16384 / sum(w)), the rounding error added to c[3] (c[4] from phase 128)
+//	They're constant data rather than worked out at startup so the PSP's ME
+//	can read them without the main CPU's cache in the way.
+//
+const s16 gAudioPolyphaseCoeffs[ kAudioPolyphasePhases + 1 ][ kAudioPolyphaseTaps ] =
+{
+	{      0,      0,      0,  16384,      0,      0,      0,      0 },	//   0
+	{     -3,     15,    -54,  16384,     54,    -16,      4,      0 },	//   1
+	{     -7,     31,   -106,  16381,    109,    -31,      7,      0 },	//   2
+	{    -10,     46,   -159,  16380,    164,    -47,     11,     -1 },	//   3
+	{    -14,     61,   -211,  16378,    220,    -63,     14,     -1 },	//   4
+	{    -17,     75,   -262,  16374,    276,    -79,     18,     -1 },	//   5
+	{    -20,     90,   -313,  16369,    333,    -95,     22,     -2 },	//   6
+	{    -23,    104,   -363,  16364,    390,   -112,     26,     -2 },	//   7
+	{    -26,    119,   -412,  16356,    448,   -128,     29,     -2 },	//   8
+	{    -29,    133,   -461,  16349,    507,   -145,     33,     -3 },	//   9
+	{    -32,    147,   -509,  16340,    566,   -162,     37,     -3 },	//  10
+	{    -35,    160,   -557,  16331,    626,   -179,     41,     -3 },	//  11
+	{    -38,    174,   -604,  16321,    686,   -196,     45,     -4 },	//  12
+	{    -41,    187,   -651,  16310,    747,   -213,     49,     -4 },	//  13
+	{    -44,    201,   -697,  16297,    808,   -231,     54,     -4 },	//  14
+	{    -47,    214,   -742,  16284,    870,   -248,     58,     -5 },	//  15
+	{    -50,    227,   -787,  16271,    932,   -266,     62,     -5 },	//  16
+	{    -52,    240,   -831,  16255,    995,   -284,     66,     -5 },	//  17
+	{    -55,    252,   -875,  16241,   1058,   -302,     71,     -6 },	//  18
+	{    -57,    265,   -918,  16223,   1122,   -320,     75,     -6 },	//  19
+	{    -60,    277,   -960,  16206,   1187,   -338,     79,     -7 },	//  20
+	{    -62,    289,  -1002,  16186,   1252,   -356,     84,     -7 },	//  21
+	{    -65,    301,  -1043,  16169,   1317,   -375,     88,     -8 },	//  22
+	{    -67,    312,  -1084,  16148,   1383,   -393,     93,     -8 },	//  23
+	{    -69,    324,  -1124,  16127,   1449,   -412,     97,     -8 },	//  24
+	{    -72,    335,  -1164,  16106,   1516,   -430,    102,     -9 },	//  25
+	{    -74,    347,  -1203,  16081,   1584,   -449,    107,     -9 },	//  26
+	{    -76,    358,  -1241,  16058,   1652,   -468,    111,    -10 },	//  27
+	{    -78,    368,  -1278,  16033,   1720,   -487,    116,    -10 },	//  28
+	{    -80,    379,  -1316,  16008,   1789,   -506,    121,    -11 },	//  29
+	{    -82,    390,  -1352,  15981,   1858,   -526,    126,    -11 },	//  30
+	{    -84,    400,  -1388,  15954,   1928,   -545,    131,    -12 },	//  31
+	{    -86,    410,  -1423,  15927,   1998,   -564,    135,    -13 },	//  32
+	{    -88,    420,  -1458,  15898,   2069,   -584,    140,    -13 },	//  33
+	{    -90,    430,  -1492,  15869,   2140,   -604,    145,    -14 },	//  34
+	{    -92,    439,  -1526,  15838,   2212,   -623,    150,    -14 },	//  35
+	{    -94,    449,  -1559,  15807,   2284,   -643,    155,    -15 },	//  36
+	{    -95,    458,  -1591,  15773,   2357,   -663,    160,    -15 },	//  37
+	{    -97,    467,  -1623,  15740,   2430,   -683,    166,    -16 },	//  38
+	{    -98,    476,  -1654,  15706,   2503,   -703,    171,    -17 },	//  39
+	{   -100,    485,  -1684,  15670,   2577,   -723,    176,    -17 },	//  40
+	{   -102,    493,  -1714,  15636,   2651,   -743,    181,    -18 },	//  41
+	{   -103,    502,  -1744,  15599,   2726,   -763,    186,    -19 },	//  42
+	{   -104,    510,  -1772,  15560,   2801,   -784,    192,    -19 },	//  43
+	{   -106,    518,  -1801,  15524,   2876,   -804,    197,    -20 },	//  44
+	{   -107,    526,  -1828,  15484,   2952,   -824,    202,    -21 },	//  45
+	{   -108,    533,  -1855,  15443,   3029,   -845,    208,    -21 },	//  46
+	{   -110,    541,  -1882,  15404,   3105,   -865,    213,    -22 },	//  47
+	{   -111,    548,  -1908,  15364,   3182,   -886,    218,    -23 },	//  48
+	{   -112,    555,  -1933,  15319,   3260,   -906,    224,    -23 },	//  49
+	{   -113,    562,  -1958,  15277,   3338,   -927,    229,    -24 },	//  50
+	{   -114,    569,  -1982,  15232,   3416,   -947,    235,    -25 },	//  51
+	{   -115,    575,  -2005,  15189,   3494,   -968,    240,    -26 },	//  52
+	{   -116,    582,  -2029,  15143,   3573,   -989,    246,    -26 },	//  53
+	{   -117,    588,  -2051,  15098,   3652,  -1010,    251,    -27 },	//  54
+	{   -118,    594,  -2073,  15050,   3732,  -1030,    257,    -28 },	//  55
+	{   -119,    600,  -2094,  15003,   3812,  -1051,    262,    -29 },	//  56
+	{   -120,    606,  -2115,  14955,   3892,  -1072,    268,    -30 },	//  57
+	{   -120,    611,  -2135,  14904,   3973,  -1093,    274,    -30 },	//  58
+	{   -121,    617,  -2155,  14855,   4054,  -1114,    279,    -31 },	//  59
+	{   -122,    622,  -2174,  14804,   4135,  -1134,    285,    -32 },	//  60
+	{   -123,    627,  -2192,  14754,   4216,  -1155,    290,    -33 },	//  61
+	{   -123,    632,  -2210,  14701,   4298,  -1176,    296,    -34 },	//  62
+	{   -124,    637,  -2228,  14649,   4380,  -1197,    302,    -35 },	//  63
+	{   -124,    641,  -2244,  14593,   4463,  -1218,    308,    -35 },	//  64
+	{   -125,    646,  -2261,  14540,   4545,  -1238,    313,    -36 },	//  65
+	{   -125,    650,  -2277,  14485,   4628,  -1259,    319,    -37 },	//  66
+	{   -126,    654,  -2292,  14430,   4711,  -1280,    325,    -38 },	//  67
+	{   -126,    658,  -2306,  14372,   4795,  -1300,    330,    -39 },	//  68
+	{   -126,    661,  -2321,  14316,   4879,  -1321,    336,    -40 },	//  69
+	{   -127,    665,  -2334,  14259,   4962,  -1342,    342,    -41 },	//  70
+	{   -127,    668,  -2347,  14199,   5047,  -1362,    348,    -42 },	//  71
+	{   -127,    672,  -2360,  14141,   5131,  -1383,    353,    -43 },	//  72
+	{   -128,    675,  -2372,  14081,   5216,  -1403,    359,    -44 },	//  73
+	{   -128,    678,  -2384,  14021,   5301,  -1424,    365,    -45 },	//  74
+	{   -128,    681,  -2395,  13959,   5386,  -1444,    371,    -46 },	//  75
+	{   -128,    683,  -2405,  13899,   5471,  -1465,    376,    -47 },	//  76
+	{   -128,    686,  -2415,  13835,   5556,  -1485,    382,    -47 },	//  77
+	{   -128,    688,  -2425,  13772,   5642,  -1505,    388,    -48 },	//  78
+	{   -128,    690,  -2434,  13708,   5728,  -1525,    394,    -49 },	//  79
+	{   -128,    692,  -2442,  13644,   5814,  -1545,    399,    -50 },	//  80
+	{   -128,    694,  -2450,  13579,   5900,  -1565,    405,    -51 },	//  81
+	{   -128,    696,  -2457,  13513,   5986,  -1585,    411,    -52 },	//  82
+	{   -128,    697,  -2464,  13448,   6073,  -1605,    416,    -53 },	//  83
+	{   -128,    699,  -2471,  13382,   6159,  -1625,    422,    -54 },	//  84
+	{   -128,    700,  -2477,  13315,   6246,  -1645,    428,    -55 },	//  85
+	{   -127,    701,  -2483,  13247,   6333,  -1664,    433,    -56 },	//  86
+	{   -127,    702,  -2488,  13179,   6420,  -1684,    439,    -57 },	//  87
+	{   -127,    703,  -2492,  13110,   6507,  -1703,    445,    -59 },	//  88
+	{   -127,    704,  -2496,  13041,   6594,  -1722,    450,    -60 },	//  89
+	{   -126,    704,  -2500,  12971,   6681,  -1741,    456,    -61 },	//  90
+	{   -126,    705,  -2503,  12900,   6769,  -1760,    461,    -62 },	//  91
+	{   -126,    705,  -2506,  12830,   6856,  -1779,    467,    -63 },	//  92
+	{   -125,    705,  -2508,  12758,   6944,  -1798,    472,    -64 },	//  93
+	{   -125,    705,  -2510,  12686,   7031,  -1816,    478,    -65 },	//  94
+	{   -125,    705,  -2511,  12614,   7119,  -1835,    483,    -66 },	//  95
+	{   -124,    705,  -2512,  12539,   7207,  -1853,    489,    -67 },	//  96
+	{   -124,    705,  -2513,  12467,   7294,  -1871,    494,    -68 },	//  97
+	{   -123,    704,  -2513,  12393,   7382,  -1889,    499,    -69 },	//  98
+	{   -123,    703,  -2513,  12319,   7470,  -1907,    505,    -70 },	//  99
+	{   -122,    703,  -2512,  12243,   7558,  -1925,    510,    -71 },	// 100
+	{   -122,    702,  -2511,  12168,   7646,  -1942,    515,    -72 },	// 101
+	{   -121,    701,  -2509,  12092,   7733,  -1960,    521,    -73 },	// 102
+	{   -120,    700,  -2507,  12015,   7821,  -1977,    526,    -74 },	// 103
+	{   -120,    699,  -2505,  11939,   7909,  -1994,    531,    -75 },	// 104
+	{   -119,    697,  -2502,  11861,   7997,  -2010,    536,    -76 },	// 105
+	{   -118,    696,  -2499,  11784,   8085,  -2027,    541,    -78 },	// 106
+	{   -118,    694,  -2495,  11707,   8172,  -2043,    546,    -79 },	// 107
+	{   -117,    693,  -2491,  11628,   8260,  -2060,    551,    -80 },	// 108
+	{   -116,    691,  -2486,  11549,   8347,  -2076,    556,    -81 },	// 109
+	{   -116,    689,  -2482,  11470,   8435,  -2091,    561,    -82 },	// 110
+	{   -115,    687,  -2476,  11390,   8522,  -2107,    566,    -83 },	// 111
+	{   -114,    685,  -2471,  11310,   8610,  -2122,    570,    -84 },	// 112
+	{   -113,    683,  -2465,  11230,   8697,  -2138,    575,    -85 },	// 113
+	{   -113,    680,  -2459,  11150,   8784,  -2152,    580,    -86 },	// 114
+	{   -112,    678,  -2452,  11069,   8871,  -2167,    584,    -87 },	// 115
+	{   -111,    675,  -2445,  10988,   8958,  -2182,    589,    -88 },	// 116
+	{   -110,    673,  -2438,  10906,   9045,  -2196,    593,    -89 },	// 117
+	{   -109,    670,  -2430,  10823,   9132,  -2210,    598,    -90 },	// 118
+	{   -108,    667,  -2422,  10741,   9218,  -2223,    602,    -91 },	// 119
+	{   -108,    664,  -2414,  10660,   9305,  -2237,    606,    -92 },	// 120
+	{   -107,    661,  -2405,  10577,   9391,  -2250,    610,    -93 },	// 121
+	{   -106,    658,  -2396,  10494,   9477,  -2263,    614,    -94 },	// 122
+	{   -105,    655,  -2386,  10409,   9563,  -2276,    619,    -95 },	// 123
+	{   -104,    652,  -2377,  10326,   9648,  -2288,    623,    -96 },	// 124
+	{   -103,    648,  -2367,  10243,   9734,  -2300,    626,    -97 },	// 125
+	{   -102,    645,  -2356,  10158,   9819,  -2312,    630,    -98 },	// 126
+	{   -101,    641,  -2346,  10075,   9904,  -2324,    634,    -99 },	// 127
+	{   -100,    638,  -2335,   9989,   9989,  -2335,    638,   -100 },	// 128
+	{    -99,    634,  -2324,   9904,  10075,  -2346,    641,   -101 },	// 129
+	{    -98,    630,  -2312,   9819,  10158,  -2356,    645,   -102 },	// 130
+	{    -97,    626,  -2300,   9734,  10243,  -2367,    648,   -103 },	// 131
+	{    -96,    623,  -2288,   9648,  10326,  -2377,    652,   -104 },	// 132
+	{    -95,    619,  -2276,   9563,  10409,  -2386,    655,   -105 },	// 133
+	{    -94,    614,  -2263,   9477,  10494,  -2396,    658,   -106 },	// 134
+	{    -93,    610,  -2250,   9391,  10577,  -2405,    661,   -107 },	// 135
+	{    -92,    606,  -2237,   9305,  10660,  -2414,    664,   -108 },	// 136
+	{    -91,    602,  -2223,   9218,  10741,  -2422,    667,   -108 },	// 137
+	{    -90,    598,  -2210,   9132,  10823,  -2430,    670,   -109 },	// 138
+	{    -89,    593,  -2196,   9045,  10906,  -2438,    673,   -110 },	// 139
+	{    -88,    589,  -2182,   8958,  10988,  -2445,    675,   -111 },	// 140
+	{    -87,    584,  -2167,   8871,  11069,  -2452,    678,   -112 },	// 141
+	{    -86,    580,  -2152,   8784,  11150,  -2459,    680,   -113 },	// 142
+	{    -85,    575,  -2138,   8697,  11230,  -2465,    683,   -113 },	// 143
+	{    -84,    570,  -2122,   8610,  11310,  -2471,    685,   -114 },	// 144
+	{    -83,    566,  -2107,   8522,  11390,  -2476,    687,   -115 },	// 145
+	{    -82,    561,  -2091,   8435,  11470,  -2482,    689,   -116 },	// 146
+	{    -81,    556,  -2076,   8347,  11549,  -2486,    691,   -116 },	// 147
+	{    -80,    551,  -2060,   8260,  11628,  -2491,    693,   -117 },	// 148
+	{    -79,    546,  -2043,   8172,  11707,  -2495,    694,   -118 },	// 149
+	{    -78,    541,  -2027,   8085,  11784,  -2499,    696,   -118 },	// 150
+	{    -76,    536,  -2010,   7997,  11861,  -2502,    697,   -119 },	// 151
+	{    -75,    531,  -1994,   7909,  11939,  -2505,    699,   -120 },	// 152
+	{    -74,    526,  -1977,   7821,  12015,  -2507,    700,   -120 },	// 153
+	{    -73,    521,  -1960,   7733,  12092,  -2509,    701,   -121 },	// 154
+	{    -72,    515,  -1942,   7646,  12168,  -2511,    702,   -122 },	// 155
+	{    -71,    510,  -1925,   7558,  12243,  -2512,    703,   -122 },	// 156
+	{    -70,    505,  -1907,   7470,  12319,  -2513,    703,   -123 },	// 157
+	{    -69,    499,  -1889,   7382,  12393,  -2513,    704,   -123 },	// 158
+	{    -68,    494,  -1871,   7294,  12467,  -2513,    705,   -124 },	// 159
+	{    -67,    489,  -1853,   7207,  12539,  -2512,    705,   -124 },	// 160
+	{    -66,    483,  -1835,   7119,  12614,  -2511,    705,   -125 },	// 161
+	{    -65,    478,  -1816,   7031,  12686,  -2510,    705,   -125 },	// 162
+	{    -64,    472,  -1798,   6944,  12758,  -2508,    705,   -125 },	// 163
+	{    -63,    467,  -1779,   6856,  12830,  -2506,    705,   -126 },	// 164
+	{    -62,    461,  -1760,   6769,  12900,  -2503,    705,   -126 },	// 165
+	{    -61,    456,  -1741,   6681,  12971,  -2500,    704,   -126 },	// 166
+	{    -60,    450,  -1722,   6594,  13041,  -2496,    704,   -127 },	// 167
+	{    -59,    445,  -1703,   6507,  13110,  -2492,    703,   -127 },	// 168
+	{    -57,    439,  -1684,   6420,  13179,  -2488,    702,   -127 },	// 169
+	{    -56,    433,  -1664,   6333,  13247,  -2483,    701,   -127 },	// 170
+	{    -55,    428,  -1645,   6246,  13315,  -2477,    700,   -128 },	// 171
+	{    -54,    422,  -1625,   6159,  13382,  -2471,    699,   -128 },	// 172
+	{    -53,    416,  -1605,   6073,  13448,  -2464,    697,   -128 },	// 173
+	{    -52,    411,  -1585,   5986,  13513,  -2457,    696,   -128 },	// 174
+	{    -51,    405,  -1565,   5900,  13579,  -2450,    694,   -128 },	// 175
+	{    -50,    399,  -1545,   5814,  13644,  -2442,    692,   -128 },	// 176
+	{    -49,    394,  -1525,   5728,  13708,  -2434,    690,   -128 },	// 177
+	{    -48,    388,  -1505,   5642,  13772,  -2425,    688,   -128 },	// 178
+	{    -47,    382,  -1485,   5556,  13835,  -2415,    686,   -128 },	// 179
+	{    -47,    376,  -1465,   5471,  13899,  -2405,    683,   -128 },	// 180
+	{    -46,    371,  -1444,   5386,  13959,  -2395,    681,   -128 },	// 181
+	{    -45,    365,  -1424,   5301,  14021,  -2384,    678,   -128 },	// 182
+	{    -44,    359,  -1403,   5216,  14081,  -2372,    675,   -128 },	// 183
+	{    -43,    353,  -1383,   5131,  14141,  -2360,    672,   -127 },	// 184
+	{    -42,    348,  -1362,   5047,  14199,  -2347,    668,   -127 },	// 185
+	{    -41,    342,  -1342,   4962,  14259,  -2334,    665,   -127 },	// 186
+	{    -40,    336,  -1321,   4879,  14316,  -2321,    661,   -126 },	// 187
+	{    -39,    330,  -1300,   4795,  14372,  -2306,    658,   -126 },	// 188
+	{    -38,    325,  -1280,   4711,  14430,  -2292,    654,   -126 },	// 189
+	{    -37,    319,  -1259,   4628,  14485,  -2277,    650,   -125 },	// 190
+	{    -36,    313,  -1238,   4545,  14540,  -2261,    646,   -125 },	// 191
+	{    -35,    308,  -1218,   4463,  14593,  -2244,    641,   -124 },	// 192
+	{    -35,    302,  -1197,   4380,  14649,  -2228,    637,   -124 },	// 193
+	{    -34,    296,  -1176,   4298,  14701,  -2210,    632,   -123 },	// 194
+	{    -33,    290,  -1155,   4216,  14754,  -2192,    627,   -123 },	// 195
+	{    -32,    285,  -1134,   4135,  14804,  -2174,    622,   -122 },	// 196
+	{    -31,    279,  -1114,   4054,  14855,  -2155,    617,   -121 },	// 197
+	{    -30,    274,  -1093,   3973,  14904,  -2135,    611,   -120 },	// 198
+	{    -30,    268,  -1072,   3892,  14955,  -2115,    606,   -120 },	// 199
+	{    -29,    262,  -1051,   3812,  15003,  -2094,    600,   -119 },	// 200
+	{    -28,    257,  -1030,   3732,  15050,  -2073,    594,   -118 },	// 201
+	{    -27,    251,  -1010,   3652,  15098,  -2051,    588,   -117 },	// 202
+	{    -26,    246,   -989,   3573,  15143,  -2029,    582,   -116 },	// 203
+	{    -26,    240,   -968,   3494,  15189,  -2005,    575,   -115 },	// 204
+	{    -25,    235,   -947,   3416,  15232,  -1982,    569,   -114 },	// 205
+	{    -24,    229,   -927,   3338,  15277,  -1958,    562,   -113 },	// 206
+	{    -23,    224,   -906,   3260,  15319,  -1933,    555,   -112 },	// 207
+	{    -23,    218,   -886,   3182,  15364,  -1908,    548,   -111 },	// 208
+	{    -22,    213,   -865,   3105,  15404,  -1882,    541,   -110 },	// 209
+	{    -21,    208,   -845,   3029,  15443,  -1855,    533,   -108 },	// 210
+	{    -21,    202,   -824,   2952,  15484,  -1828,    526,   -107 },	// 211
+	{    -20,    197,   -804,   2876,  15524,  -1801,    518,   -106 },	// 212
+	{    -19,    192,   -784,   2801,  15560,  -1772,    510,   -104 },	// 213
+	{    -19,    186,   -763,   2726,  15599,  -1744,    502,   -103 },	// 214
+	{    -18,    181,   -743,   2651,  15636,  -1714,    493,   -102 },	// 215
+	{    -17,    176,   -723,   2577,  15670,  -1684,    485,   -100 },	// 216
+	{    -17,    171,   -703,   2503,  15706,  -1654,    476,    -98 },	// 217
+	{    -16,    166,   -683,   2430,  15740,  -1623,    467,    -97 },	// 218
+	{    -15,    160,   -663,   2357,  15773,  -1591,    458,    -95 },	// 219
+	{    -15,    155,   -643,   2284,  15807,  -1559,    449,    -94 },	// 220
+	{    -14,    150,   -623,   2212,  15838,  -1526,    439,    -92 },	// 221
+	{    -14,    145,   -604,   2140,  15869,  -1492,    430,    -90 },	// 222
+	{    -13,    140,   -584,   2069,  15898,  -1458,    420,    -88 },	// 223
+	{    -13,    135,   -564,   1998,  15927,  -1423,    410,    -86 },	// 224
+	{    -12,    131,   -545,   1928,  15954,  -1388,    400,    -84 },	// 225
+	{    -11,    126,   -526,   1858,  15981,  -1352,    390,    -82 },	// 226
+	{    -11,    121,   -506,   1789,  16008,  -1316,    379,    -80 },	// 227
+	{    -10,    116,   -487,   1720,  16033,  -1278,    368,    -78 },	// 228
+	{    -10,    111,   -468,   1652,  16058,  -1241,    358,    -76 },	// 229
+	{     -9,    107,   -449,   1584,  16081,  -1203,    347,    -74 },	// 230
+	{     -9,    102,   -430,   1516,  16106,  -1164,    335,    -72 },	// 231
+	{     -8,     97,   -412,   1449,  16127,  -1124,    324,    -69 },	// 232
+	{     -8,     93,   -393,   1383,  16148,  -1084,    312,    -67 },	// 233
+	{     -8,     88,   -375,   1317,  16169,  -1043,    301,    -65 },	// 234
+	{     -7,     84,   -356,   1252,  16186,  -1002,    289,    -62 },	// 235
+	{     -7,     79,   -338,   1187,  16206,   -960,    277,    -60 },	// 236
+	{     -6,     75,   -320,   1122,  16223,   -918,    265,    -57 },	// 237
+	{     -6,     71,   -302,   1058,  16241,   -875,    252,    -55 },	// 238
+	{     -5,     66,   -284,    995,  16255,   -831,    240,    -52 },	// 239
+	{     -5,     62,   -266,    932,  16271,   -787,    227,    -50 },	// 240
+	{     -5,     58,   -248,    870,  16284,   -742,    214,    -47 },	// 241
+	{     -4,     54,   -231,    808,  16297,   -697,    201,    -44 },	// 242
+	{     -4,     49,   -213,    747,  16310,   -651,    187,    -41 },	// 243
+	{     -4,     45,   -196,    686,  16321,   -604,    174,    -38 },	// 244
+	{     -3,     41,   -179,    626,  16331,   -557,    160,    -35 },	// 245
+	{     -3,     37,   -162,    566,  16340,   -509,    147,    -32 },	// 246
+	{     -3,     33,   -145,    507,  16349,   -461,    133,    -29 },	// 247
+	{     -2,     29,   -128,    448,  16356,   -412,    119,    -26 },	// 248
+	{     -2,     26,   -112,    390,  16364,   -363,    104,    -23 },	// 249
+	{     -2,     22,    -95,    333,  16369,   -313,     90,    -20 },	// 250
+	{     -1,     18,    -79,    276,  16374,   -262,     75,    -17 },	// 251
+	{     -1,     14,    -63,    220,  16378,   -211,     61,    -14 },	// 252
+	{     -1,     11,    -47,    164,  16380,   -159,     46,    -10 },	// 253
+	{      0,      7,    -31,    109,  16381,   -106,     31,     -7 },	// 254
+	{      0,      4,    -16,     54,  16384,    -54,     15,     -3 },	// 255
+	{      0,      0,      0,      0,  16384,      0,      0,      0 },	// 256
+};
+
+u32 AudioPolyphaseScalar( Sample * out, u32 max_out, const Sample * in, u32 num_in, u32 & pos, u32 & frac, u32 step )
+{
+	u32		p( pos );
+	u32		f( frac );
+	u32		num_out( 0 );
+
+	while( p < num_in && num_out < max_out )
+	{
+		const s16 *		c( gAudioPolyphaseCoeffs[ AudioPolyphasePhase( f ) ] );
+		const Sample *	x( in + p );
+
+		s32		l( 0 );
+		s32		r( 0 );
+		for( u32 k = 0; k < kAudioPolyphaseTaps; ++k )
+		{
+			l += x[ k ].L * c[ k ];
+			r += x[ k ].R * c[ k ];
+		}
+
+		out[ num_out ].L = Saturate<s16>( ( l + 0x2000 ) >> 14 );
+		out[ num_out ].R = Saturate<s16>( ( r + 0x2000 ) >> 14 );
+		num_out++;
+
+		f += step;
+		p += f >> 16;
+		f &= 0xFFFF;
+	}
+
+	pos = p;
+	frac = f;
+	return num_out;
+}
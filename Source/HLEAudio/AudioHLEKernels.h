@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2003 Azimer
+Copyright (C) 2001,2006-2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef HLEAUDIO_AUDIOHLEKERNELS_H_
+#define HLEAUDIO_AUDIOHLEKERNELS_H_
+
+#include "Utility/DaedalusTypes.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DAEDALUS_SIMD_AUDIO
+#endif
+
+//*****************************************************************************
+//	The inner loops of the mixer, interleave, resample and envelope mixer
+//	commands, and of the resampler CAudioBuffer uses to get from the game's
+//	rate to the output rate. The Scalar versions are the reference; the SIMD
+//	versions give the same results with SSE2/NEON.
+//
+//	The commands can point their buffers anywhere in DMEM, including over each
+//	other, and then the order of the scalar loads and stores decides what comes
+//	out. The SIMD versions check for that and call the Scalar ones, so every
+//	case still matches.
+//*****************************************************************************
+
+// out[i] = Saturate<s16>( out[i] + (in[i] * gain >> 15) )
+void	AudioMixScalar( s16 * out, const s16 * in, s32 gain, u32 num_samples );
+
+// Interleaves num_samples (a multiple of 2) from each of left and right into out, two at a time for the word swapped DMEM
+void	AudioInterleaveScalar( u32 * out, const u16 * left, const u16 * right, u32 num_samples );
+
+// Linear interpolation from buffer[src] to buffer[dst] onwards, with DMEM's word swap (dst is even).
+// accumulator is the 16 bit fraction; src/accumulator are IN/OUT
+void	AudioResampleScalar( s16 * buffer, u32 dst, u32 & src, u32 & accumulator, u32 pitch, u32 num_samples );
+
+// Eight samples of EnvMixer: in * vols[0] goes to out, in * vols[1] to aux1, and, if aux2 isn't null,
+// in * vols[2] to aux2 and in * vols[3] to aux3. vols are per sample, in DMEM order, and at most +/-32768
+// (as EnvMixer's always are)
+void	AudioEnvMixScalar( const s16 * in, s16 * out, s16 * aux1, s16 * aux2, s16 * aux3, const s32 (&vols)[4][8] );
+
+struct Sample;
+
+// The output resampler is an 8 tap polyphase filter: each output interpolates between in[pos+3] and
+// in[pos+4] at frac (16 bits) with a windowed sinc from in[pos..pos+7], using the nearest of the
+// 256 precomputed phases. It runs while pos < num_in (so in needs num_in + 7 samples) and out has
+// room for more, and returns how many it wrote. pos/frac are IN/OUT; step is in 16.16
+const u32	kAudioPolyphaseTaps = 8;
+const u32	kAudioPolyphasePhaseBits = 8;
+const u32	kAudioPolyphasePhases = 1 << kAudioPolyphasePhaseBits;
+
+extern const s16	gAudioPolyphaseCoeffs[ kAudioPolyphasePhases + 1 ][ kAudioPolyphaseTaps ];
+
+inline u32 AudioPolyphasePhase( u32 frac )
+{
+	return ( frac + ( 1 << ( 15 - kAudioPolyphasePhaseBits ) ) ) >> ( 16 - kAudioPolyphasePhaseBits );
+}
+
+u32		AudioPolyphaseScalar( Sample * out, u32 max_out, const Sample * in, u32 num_in, u32 & pos, u32 & frac, u32 step );
+
+#ifdef DAEDALUS_SIMD_AUDIO
+void	AudioMixSIMD( s16 * out, const s16 * in, s32 gain, u32 num_samples );
+void	AudioInterleaveSIMD( u32 * out, const u16 * left, const u16 * right, u32 num_samples );
+void	AudioResampleSIMD( s16 * buffer, u32 dst, u32 & src, u32 & accumulator, u32 pitch, u32 num_samples );
+void	AudioEnvMixSIMD( const s16 * in, s16 * out, s16 * aux1, s16 * aux2, s16 * aux3, const s32 (&vols)[4][8] );
+u32		AudioPolyphaseSIMD( Sample * out, u32 max_out, const Sample * in, u32 num_in, u32 & pos, u32 & frac, u32 step );
+#endif
+
+inline void AudioMix( s16 * out, const s16 * in, s32 gain, u32 num_samples )
+{
+#ifdef DAEDALUS_SIMD_AUDIO
+	AudioMixSIMD( out, in, gain, num_samples );
+#else
+	AudioMixScalar( out, in, gain, num_samples );
+#endif
+}
+
+inline void AudioInterleave( u32 * out, const u16 * left, const u16 * right, u32 num_samples )
+{
+#ifdef DAEDALUS_SIMD_AUDIO
+	AudioInterleaveSIMD( out, left, right, num_samples );
+#else
+	AudioInterleaveScalar( out, left, right, num_samples );
+#endif
+}
+
+inline void AudioResample( s16 * buffer, u32 dst, u32 & src, u32 & accumulator, u32 pitch, u32 num_samples )
+{
+#ifdef DAEDALUS_SIMD_AUDIO
+	AudioResampleSIMD( buffer, dst, src, accumulator, pitch, num_samples );
+#else
+	AudioResampleScalar( buffer, dst, src, accumulator, pitch, num_samples );
+#endif
+}
+
+inline void AudioEnvMix( const s16 * in, s16 * out, s16 * aux1, s16 * aux2, s16 * aux3, const s32 (&vols)[4][8] )
+{
+#ifdef DAEDALUS_SIMD_AUDIO
+	AudioEnvMixSIMD( in, out, aux1, aux2, aux3, vols );
+#else
+	AudioEnvMixScalar( in, out, aux1, aux2, aux3, vols );
+#endif
+}
+
+inline u32 AudioPolyphase( Sample * out, u32 max_out, const Sample * in, u32 num_in, u32 & pos, u32 & frac, u32 step )
+{
+#ifdef DAEDALUS_SIMD_AUDIO
+	return AudioPolyphaseSIMD( out, max_out, in, num_in, pos, frac, step );
+#else
+	return AudioPolyphaseScalar( out, max_out, in, num_in, pos, frac, step );
+#endif
+}
+
+#endif // HLEAUDIO_AUDIOHLEKERNELS_H_
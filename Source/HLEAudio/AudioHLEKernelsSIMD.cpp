@@ -0,0 +1,407 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	SSE2/NEON versions of the AudioHLEKernels loops, eight samples at a time.
+//	Each does the scalar arithmetic in 32 bit lanes where it can overflow 16,
+//	and narrows with saturation where the scalar code calls Saturate<s16>, so
+//	the results are identical.
+//
+//	Resample can't load its input as a vector, as each output steps through
+//	the source by a different amount, so the sample pairs are gathered one by
+//	one and only the fractions and the interpolation are vectorised. The
+//	interpolation is done in 16 bits: the scalar code keeps the low 16 bits
+//	of a + ((b - a) * frac >> 16), where b - a can need 17, and those come
+//	out the same from the unsigned high half of the product of the low 16
+//	bits of b - a, less frac when b - a is negative.
+//
+//	The output resampler's taps for one output are eight stereo samples in a
+//	row, so the dot products are vectorised instead, one output at a time.
+//
+
+#include "stdafx.h"
+#include "HLEAudio/AudioHLEKernels.h"
+
+#include "HLEAudio/AudioBuffer.h"
+
+#include <string.h>
+
+#ifdef DAEDALUS_SIMD_AUDIO
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+	// True if a vector of one would take in part of the same vector of the other. Buffers
+	// which are the same, or a vector or more apart, are read and written in the same order as by the scalar loops
+	inline bool	Overlaps( const void * a, const void * b )
+	{
+		const intptr_t	d( (const u8 *)a - (const u8 *)b );
+		return d != 0 && d > -16 && d < 16;
+	}
+
+	inline bool	RangesOverlap( const void * a, u32 a_bytes, const void * b, u32 b_bytes )
+	{
+		return (const u8 *)a < (const u8 *)b + b_bytes && (const u8 *)b < (const u8 *)a + a_bytes;
+	}
+}
+
+#if defined(__SSE2__)
+
+//*****************************************************************************
+//	SSE2
+//*****************************************************************************
+namespace
+{
+	// Saturate<s16>( o + x ) for eight s16 o and two vectors of s32 x
+	inline __m128i AddSaturate( __m128i o, __m128i x_lo, __m128i x_hi )
+	{
+		const __m128i	o_lo( _mm_srai_epi32( _mm_unpacklo_epi16( o, o ), 16 ) );
+		const __m128i	o_hi( _mm_srai_epi32( _mm_unpackhi_epi16( o, o ), 16 ) );
+		return _mm_packs_epi32( _mm_add_epi32( o_lo, x_lo ), _mm_add_epi32( o_hi, x_hi ) );
+	}
+
+	// Swaps each pair of samples, for the word swapped DMEM
+	inline __m128i SwapPairs( __m128i x )
+	{
+		return _mm_or_si128( _mm_slli_epi32( x, 16 ), _mm_srli_epi32( x, 16 ) );
+	}
+
+	// Splits four volumes of up to +/-32768 into two s16 halves, to multiply with _mm_madd_epi16
+	inline __m128i SplitVolumes( const s32 * vols )
+	{
+		const __m128i	v( _mm_loadu_si128( (const __m128i *)vols ) );
+		const __m128i	h( _mm_srai_epi32( v, 1 ) );
+		const __m128i	l( _mm_sub_epi32( v, h ) );
+		return _mm_or_si128( _mm_and_si128( h, _mm_set1_epi32( 0xffff ) ), _mm_slli_epi32( l, 16 ) );
+	}
+
+	// Saturate<s16>( o + ((in * vols + 0x4000) >> 15) ), with in_lo/in_hi each sample of in twice
+	inline __m128i EnvMix( __m128i o, __m128i in_lo, __m128i in_hi, const s32 * vols )
+	{
+		const __m128i	round( _mm_set1_epi32( 0x4000 ) );
+		const __m128i	x_lo( _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( in_lo, SplitVolumes( vols ) ), round ), 15 ) );
+		const __m128i	x_hi( _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( in_hi, SplitVolumes( vols + 4 ) ), round ), 15 ) );
+		return AddSaturate( o, x_lo, x_hi );
+	}
+}
+
+void AudioMixSIMD( s16 * out, const s16 * in, s32 gain, u32 num_samples )
+{
+	if( gain != s16( gain ) || Overlaps( out, in ) )
+	{
+		AudioMixScalar( out, in, gain, num_samples );
+		return;
+	}
+
+	const __m128i	g( _mm_set1_epi16( s16( gain ) ) );
+	const u32		n( num_samples & ~7 );
+	for( u32 i = 0; i < n; i += 8 )
+	{
+		const __m128i	x( _mm_loadu_si128( (const __m128i *)(in + i) ) );
+		const __m128i	lo( _mm_mullo_epi16( x, g ) );
+		const __m128i	hi( _mm_mulhi_epi16( x, g ) );
+		const __m128i	o( _mm_loadu_si128( (const __m128i *)(out + i) ) );
+
+		_mm_storeu_si128( (__m128i *)(out + i), AddSaturate( o, _mm_srai_epi32( _mm_unpacklo_epi16( lo, hi ), 15 ),
+																_mm_srai_epi32( _mm_unpackhi_epi16( lo, hi ), 15 ) ) );
+	}
+	AudioMixScalar( out + n, in + n, gain, num_samples - n );
+}
+
+void AudioInterleaveSIMD( u32 * out, const u16 * left, const u16 * right, u32 num_samples )
+{
+	if( RangesOverlap( out, num_samples * 4, left, num_samples * 2 ) || RangesOverlap( out, num_samples * 4, right, num_samples * 2 ) )
+	{
+		AudioInterleaveScalar( out, left, right, num_samples );
+		return;
+	}
+
+	const u32	n( num_samples & ~7 );
+	for( u32 i = 0; i < n; i += 8 )
+	{
+		const __m128i	l( _mm_loadu_si128( (const __m128i *)(left + i) ) );
+		const __m128i	r( _mm_loadu_si128( (const __m128i *)(right + i) ) );
+
+		_mm_storeu_si128( (__m128i *)(out + i + 0), _mm_shuffle_epi32( _mm_unpacklo_epi16( l, r ), _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+		_mm_storeu_si128( (__m128i *)(out + i + 4), _mm_shuffle_epi32( _mm_unpackhi_epi16( l, r ), _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	}
+	AudioInterleaveScalar( out + n, left + n, right + n, num_samples - n );
+}
+
+#else
+
+//*****************************************************************************
+//	NEON
+//*****************************************************************************
+namespace
+{
+	// Saturate<s16>( o + x ) for eight s16 o and two vectors of s32 x
+	inline int16x8_t AddSaturate( int16x8_t o, int32x4_t x_lo, int32x4_t x_hi )
+	{
+		return vcombine_s16( vqmovn_s32( vaddw_s16( x_lo, vget_low_s16( o ) ) ), vqmovn_s32( vaddw_s16( x_hi, vget_high_s16( o ) ) ) );
+	}
+
+	// Saturate<s16>( o + ((in * vols + 0x4000) >> 15) ), with in_lo/in_hi widened to 32 bits
+	inline int16x8_t EnvMix( int16x8_t o, int32x4_t in_lo, int32x4_t in_hi, const s32 * vols )
+	{
+		const int32x4_t	round( vdupq_n_s32( 0x4000 ) );
+		const int32x4_t	x_lo( vshrq_n_s32( vaddq_s32( vmulq_s32( in_lo, vld1q_s32( vols ) ), round ), 15 ) );
+		const int32x4_t	x_hi( vshrq_n_s32( vaddq_s32( vmulq_s32( in_hi, vld1q_s32( vols + 4 ) ), round ), 15 ) );
+		return AddSaturate( o, x_lo, x_hi );
+	}
+}
+
+void AudioMixSIMD( s16 * out, const s16 * in, s32 gain, u32 num_samples )
+{
+	if( gain != s16( gain ) || Overlaps( out, in ) )
+	{
+		AudioMixScalar( out, in, gain, num_samples );
+		return;
+	}
+
+	const s16	g( gain );
+	const u32	n( num_samples & ~7 );
+	for( u32 i = 0; i < n; i += 8 )
+	{
+		const int16x8_t	x( vld1q_s16( in + i ) );
+		const int16x8_t	o( vld1q_s16( out + i ) );
+
+		vst1q_s16( out + i, AddSaturate( o, vshrq_n_s32( vmull_n_s16( vget_low_s16( x ), g ), 15 ),
+											vshrq_n_s32( vmull_n_s16( vget_high_s16( x ), g ), 15 ) ) );
+	}
+	AudioMixScalar( out + n, in + n, gain, num_samples - n );
+}
+
+void AudioInterleaveSIMD( u32 * out, const u16 * left, const u16 * right, u32 num_samples )
+{
+	if( RangesOverlap( out, num_samples * 4, left, num_samples * 2 ) || RangesOverlap( out, num_samples * 4, right, num_samples * 2 ) )
+	{
+		AudioInterleaveScalar( out, left, right, num_samples );
+		return;
+	}
+
+	const u32	n( num_samples & ~7 );
+	for( u32 i = 0; i < n; i += 8 )
+	{
+		const uint16x8x2_t	lr( vzipq_u16( vld1q_u16( left + i ), vld1q_u16( right + i ) ) );
+
+		vst1q_u32( out + i + 0, vrev64q_u32( vreinterpretq_u32_u16( lr.val[ 0 ] ) ) );
+		vst1q_u32( out + i + 4, vrev64q_u32( vreinterpretq_u32_u16( lr.val[ 1 ] ) ) );
+	}
+	AudioInterleaveScalar( out + n, left + n, right + n, num_samples - n );
+}
+
+#endif
+
+void AudioResampleSIMD( s16 * buffer, u32 dst, u32 & src, u32 & accumulator, u32 pitch, u32 num_samples )
+{
+	if( num_samples == 0 )
+		return;
+
+	// The samples read and written, widened to whole pairs as they're swapped
+	const u32	src_end( u32( src + ( ( u64( accumulator ) + u64( num_samples - 1 ) * pitch ) >> 16 ) + 2 ) );
+	const u32	src_begin( src & ~1 );
+	if( dst < ( (src_end + 1) & ~1 ) && src_begin < dst + num_samples + 1 )
+	{
+		AudioResampleScalar( buffer, dst, src, accumulator, pitch, num_samples );
+		return;
+	}
+
+	u32		s( src );
+	u32		acc( accumulator );
+
+	const u32	n( pitch <= 0xffffff ? num_samples & ~7 : 0 );
+	for( u32 i = 0; i < n; i += 8 )
+	{
+		// The fraction is just the low 16 bits of acc + k * pitch, and the sample steps on by the high ones
+		u32		idx[ 9 ];
+		for( u32 k = 0; k < 9; ++k )
+		{
+			idx[ k ] = s + ( ( acc + k * pitch ) >> 16 );
+		}
+
+#if defined(__SSE2__)
+		const __m128i	va( _mm_setr_epi16( buffer[ idx[ 0 ]^1 ], buffer[ idx[ 1 ]^1 ], buffer[ idx[ 2 ]^1 ], buffer[ idx[ 3 ]^1 ],
+											buffer[ idx[ 4 ]^1 ], buffer[ idx[ 5 ]^1 ], buffer[ idx[ 6 ]^1 ], buffer[ idx[ 7 ]^1 ] ) );
+		const __m128i	vb( _mm_setr_epi16( buffer[ (idx[ 0 ]+1)^1 ], buffer[ (idx[ 1 ]+1)^1 ], buffer[ (idx[ 2 ]+1)^1 ], buffer[ (idx[ 3 ]+1)^1 ],
+											buffer[ (idx[ 4 ]+1)^1 ], buffer[ (idx[ 5 ]+1)^1 ], buffer[ (idx[ 6 ]+1)^1 ], buffer[ (idx[ 7 ]+1)^1 ] ) );
+		const __m128i	vf( _mm_add_epi16( _mm_set1_epi16( s16( acc ) ),
+										   _mm_mullo_epi16( _mm_set1_epi16( s16( pitch ) ), _mm_setr_epi16( 0, 1, 2, 3, 4, 5, 6, 7 ) ) ) );
+		const __m128i	m( _mm_mulhi_epu16( _mm_sub_epi16( vb, va ), vf ) );
+		const __m128i	neg( _mm_and_si128( _mm_cmplt_epi16( vb, va ), vf ) );
+
+		_mm_storeu_si128( (__m128i *)(buffer + dst + i), SwapPairs( _mm_sub_epi16( _mm_add_epi16( va, m ), neg ) ) );
+#else
+		static const u16	kSteps[ 8 ] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		int16x8_t		va( vdupq_n_s16( 0 ) );
+		int16x8_t		vb( vdupq_n_s16( 0 ) );
+		va = vsetq_lane_s16( buffer[ idx[ 0 ]^1 ], va, 0 );	vb = vsetq_lane_s16( buffer[ (idx[ 0 ]+1)^1 ], vb, 0 );
+		va = vsetq_lane_s16( buffer[ idx[ 1 ]^1 ], va, 1 );	vb = vsetq_lane_s16( buffer[ (idx[ 1 ]+1)^1 ], vb, 1 );
+		va = vsetq_lane_s16( buffer[ idx[ 2 ]^1 ], va, 2 );	vb = vsetq_lane_s16( buffer[ (idx[ 2 ]+1)^1 ], vb, 2 );
+		va = vsetq_lane_s16( buffer[ idx[ 3 ]^1 ], va, 3 );	vb = vsetq_lane_s16( buffer[ (idx[ 3 ]+1)^1 ], vb, 3 );
+		va = vsetq_lane_s16( buffer[ idx[ 4 ]^1 ], va, 4 );	vb = vsetq_lane_s16( buffer[ (idx[ 4 ]+1)^1 ], vb, 4 );
+		va = vsetq_lane_s16( buffer[ idx[ 5 ]^1 ], va, 5 );	vb = vsetq_lane_s16( buffer[ (idx[ 5 ]+1)^1 ], vb, 5 );
+		va = vsetq_lane_s16( buffer[ idx[ 6 ]^1 ], va, 6 );	vb = vsetq_lane_s16( buffer[ (idx[ 6 ]+1)^1 ], vb, 6 );
+		va = vsetq_lane_s16( buffer[ idx[ 7 ]^1 ], va, 7 );	vb = vsetq_lane_s16( buffer[ (idx[ 7 ]+1)^1 ], vb, 7 );
+		const uint16x8_t	vf( vmlaq_n_u16( vdupq_n_u16( u16( acc ) ), vld1q_u16( kSteps ), u16( pitch ) ) );
+		const uint16x8_t	d( vreinterpretq_u16_s16( vsubq_s16( vb, va ) ) );
+		const uint16x8_t	m( vcombine_u16( vshrn_n_u32( vmull_u16( vget_low_u16( d ), vget_low_u16( vf ) ), 16 ),
+											 vshrn_n_u32( vmull_u16( vget_high_u16( d ), vget_high_u16( vf ) ), 16 ) ) );
+		const uint16x8_t	neg( vandq_u16( vcltq_s16( vb, va ), vf ) );
+
+		vst1q_s16( buffer + dst + i, vrev32q_s16( vsubq_s16( vaddq_s16( va, vreinterpretq_s16_u16( m ) ), vreinterpretq_s16_u16( neg ) ) ) );
+#endif
+
+		s = idx[ 8 ];
+		acc = ( acc + 8 * pitch ) & 0xFFFF;
+	}
+
+	src = s;
+	accumulator = acc;
+	AudioResampleScalar( buffer, dst + n, src, accumulator, pitch, num_samples - n );
+}
+
+void AudioEnvMixSIMD( const s16 * in, s16 * out, s16 * aux1, s16 * aux2, s16 * aux3, const s32 (&vols)[4][8] )
+{
+	bool	overlaps( Overlaps( out, in ) || Overlaps( aux1, in ) || Overlaps( aux1, out ) );
+	if( aux2 )
+	{
+		overlaps |= Overlaps( aux2, in ) || Overlaps( aux2, out ) || Overlaps( aux2, aux1 ) ||
+					Overlaps( aux3, in ) || Overlaps( aux3, out ) || Overlaps( aux3, aux1 ) || Overlaps( aux3, aux2 );
+	}
+	if( overlaps )
+	{
+		AudioEnvMixScalar( in, out, aux1, aux2, aux3, vols );
+		return;
+	}
+
+	// As in the scalar version, everything is read before anything is written
+#if defined(__SSE2__)
+	const __m128i	x( _mm_loadu_si128( (const __m128i *)in ) );
+	const __m128i	in_lo( _mm_unpacklo_epi16( x, x ) );
+	const __m128i	in_hi( _mm_unpackhi_epi16( x, x ) );
+	const __m128i	o( _mm_loadu_si128( (const __m128i *)out ) );
+	const __m128i	a1( _mm_loadu_si128( (const __m128i *)aux1 ) );
+
+	if( aux2 )
+	{
+		const __m128i	a2( _mm_loadu_si128( (const __m128i *)aux2 ) );
+		const __m128i	a3( _mm_loadu_si128( (const __m128i *)aux3 ) );
+
+		_mm_storeu_si128( (__m128i *)out, EnvMix( o, in_lo, in_hi, vols[ 0 ] ) );
+		_mm_storeu_si128( (__m128i *)aux1, EnvMix( a1, in_lo, in_hi, vols[ 1 ] ) );
+		_mm_storeu_si128( (__m128i *)aux2, EnvMix( a2, in_lo, in_hi, vols[ 2 ] ) );
+		_mm_storeu_si128( (__m128i *)aux3, EnvMix( a3, in_lo, in_hi, vols[ 3 ] ) );
+	}
+	else
+	{
+		_mm_storeu_si128( (__m128i *)out, EnvMix( o, in_lo, in_hi, vols[ 0 ] ) );
+		_mm_storeu_si128( (__m128i *)aux1, EnvMix( a1, in_lo, in_hi, vols[ 1 ] ) );
+	}
+#else
+	const int16x8_t	x( vld1q_s16( in ) );
+	const int32x4_t	in_lo( vmovl_s16( vget_low_s16( x ) ) );
+	const int32x4_t	in_hi( vmovl_s16( vget_high_s16( x ) ) );
+	const int16x8_t	o( vld1q_s16( out ) );
+	const int16x8_t	a1( vld1q_s16( aux1 ) );
+
+	if( aux2 )
+	{
+		const int16x8_t	a2( vld1q_s16( aux2 ) );
+		const int16x8_t	a3( vld1q_s16( aux3 ) );
+
+		vst1q_s16( out, EnvMix( o, in_lo, in_hi, vols[ 0 ] ) );
+		vst1q_s16( aux1, EnvMix( a1, in_lo, in_hi, vols[ 1 ] ) );
+		vst1q_s16( aux2, EnvMix( a2, in_lo, in_hi, vols[ 2 ] ) );
+		vst1q_s16( aux3, EnvMix( a3, in_lo, in_hi, vols[ 3 ] ) );
+	}
+	else
+	{
+		vst1q_s16( out, EnvMix( o, in_lo, in_hi, vols[ 0 ] ) );
+		vst1q_s16( aux1, EnvMix( a1, in_lo, in_hi, vols[ 1 ] ) );
+	}
+#endif
+}
+
+u32 AudioPolyphaseSIMD( Sample * out, u32 max_out, const Sample * in, u32 num_in, u32 & pos, u32 & frac, u32 step )
+{
+	DAEDALUS_STATIC_ASSERT( kAudioPolyphaseTaps == 8 );
+
+	u32		p( pos );
+	u32		f( frac );
+	u32		num_out( 0 );
+
+#if defined(__SSE2__)
+	const __m128i	round( _mm_set1_epi32( 0x2000 ) );
+#endif
+
+	while( p < num_in && num_out < max_out )
+	{
+		const s16 *		c( gAudioPolyphaseCoeffs[ AudioPolyphasePhase( f ) ] );
+		const Sample *	x( in + p );
+
+#if defined(__SSE2__)
+		// Reorder each half of L0 R0 L1 R1 L2 R2 L3 R3 to L0 L1 R0 R1 L2 L3 R2 R3, so that
+		// multiplying by c0 c1 c0 c1 c2 c3 c2 c3 leaves the left and right sums in alternate lanes
+		const __m128i	cv( _mm_loadu_si128( (const __m128i *)c ) );
+		const __m128i	x0( _mm_loadu_si128( (const __m128i *)x ) );
+		const __m128i	x1( _mm_loadu_si128( (const __m128i *)( x + 4 ) ) );
+		const __m128i	s0( _mm_shufflehi_epi16( _mm_shufflelo_epi16( x0, _MM_SHUFFLE( 3, 1, 2, 0 ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+		const __m128i	s1( _mm_shufflehi_epi16( _mm_shufflelo_epi16( x1, _MM_SHUFFLE( 3, 1, 2, 0 ) ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+
+		__m128i			sum( _mm_add_epi32( _mm_madd_epi16( s0, _mm_unpacklo_epi32( cv, cv ) ),
+											_mm_madd_epi16( s1, _mm_unpackhi_epi32( cv, cv ) ) ) );
+		sum = _mm_add_epi32( sum, _mm_srli_si128( sum, 8 ) );
+		sum = _mm_srai_epi32( _mm_add_epi32( sum, round ), 14 );
+
+		const u32		lr( _mm_cvtsi128_si32( _mm_packs_epi32( sum, sum ) ) );
+		memcpy( &out[ num_out ], &lr, sizeof( lr ) );
+#else
+		const int16x8_t		cv( vld1q_s16( c ) );
+		const int16x8x2_t	xv( vld2q_s16( (const int16_t *)x ) );		// Lefts and rights
+
+		int32x4_t		l( vmull_s16( vget_low_s16( xv.val[ 0 ] ), vget_low_s16( cv ) ) );
+		int32x4_t		r( vmull_s16( vget_low_s16( xv.val[ 1 ] ), vget_low_s16( cv ) ) );
+		l = vmlal_s16( l, vget_high_s16( xv.val[ 0 ] ), vget_high_s16( cv ) );
+		r = vmlal_s16( r, vget_high_s16( xv.val[ 1 ] ), vget_high_s16( cv ) );
+
+		const int32x2_t	lr( vpadd_s32( vadd_s32( vget_low_s32( l ), vget_high_s32( l ) ),
+									   vadd_s32( vget_low_s32( r ), vget_high_s32( r ) ) ) );
+
+		// Rounds with 0x2000 and saturates, as the scalar version
+		vst1_lane_s32( (int32_t *)&out[ num_out ], vreinterpret_s32_s16( vqrshrn_n_s32( vcombine_s32( lr, lr ), 14 ) ), 0 );
+#endif
+		num_out++;
+
+		f += step;
+		p += f >> 16;
+		f &= 0xFFFF;
+	}
+
+	pos = p;
+	frac = f;
+	return num_out;
+}
+
+#endif // DAEDALUS_SIMD_AUDIO
@@ -0,0 +1,578 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Checks the SIMD versions of the AudioHLEKernels against the Scalar ones,
+//	then times both.
+//
+//	Each check runs a kernel on two copies of a 4K buffer standing in for
+//	DMEM, filled with random samples, with the buffers at random addresses
+//	and counts as the commands can give them. Some of the buffers are put
+//	on top of or just past each other, which the SIMD versions have to hand
+//	to the Scalar ones. The whole of both copies, and any state passed back,
+//	must match exactly.
+//
+//	The output resampler is checked the same way, against its own state,
+//	and its table against the formula it came from. It's then timed and its
+//	noise measured on sine waves alongside the linear interpolation
+//	CAudioBuffer::AddSamples used before it.
+//
+
+#include "stdafx.h"
+#include "HLEAudio/AudioHLEKernels.h"
+#include "HLEAudio/AudioBuffer.h"
+#include "Math/MathUtil.h"
+#include "Utility/Alignment.h"
+#include "Utility/Timing.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	const u32	kDMEMSamples = 0x1000 / 2;
+	const u32	kNumChecks = 200000;
+	const u32	kBenchSamples = 0x170;			// As RESAMPLE3, and about what the ABIs mix at a time
+	const u32	kBenchRuns = 20000;
+
+	u32		gState( 0x13579bdf );
+
+	u32		Rand()
+	{
+		gState = gState * 1664525 + 1013904223;
+		return gState;
+	}
+
+	s16		RandS16()
+	{
+		return s16( Rand() >> 16 );
+	}
+
+	// Somewhere for count samples, which 1 in 4 times starts within 8 samples of near
+	u32		RandAddress( u32 count, u32 near, u32 align )
+	{
+		u32		address;
+		if( ( Rand() & 3 ) == 0 )
+		{
+			address = Clamp< s32 >( s32( near ) + s32( Rand() % 17 ) - 8, 0, s32( kDMEMSamples - count ) );
+		}
+		else
+		{
+			address = ( Rand() >> 8 ) % ( kDMEMSamples - count + 1 );
+		}
+		return address & ~( align - 1 );
+	}
+
+	// The output resampler goes from the game's rate to the output's
+	const u32	kGameFrequency = 32000;
+	const u32	kOutputFrequency = 44100;
+	const u32	kStreamSamples = 0x400;
+	const u32	kStreamOutput = kStreamSamples * 2;
+
+	ALIGNED_TYPE( s16, gExpected[ kDMEMSamples ], 16 );
+	ALIGNED_TYPE( s16, gActual[ kDMEMSamples ], 16 );
+
+	void	FillDMEM()
+	{
+		for( u32 i = 0; i < kDMEMSamples; ++i )
+		{
+			// Mostly quiet, with some loud enough to saturate
+			gExpected[ i ] = ( Rand() & 0x100 ) ? RandS16() : s16( RandS16() >> 4 );
+		}
+		memcpy( gActual, gExpected, sizeof( gExpected ) );
+	}
+
+	bool	Compare( const char * name, u32 & failures )
+	{
+		if( memcmp( gExpected, gActual, sizeof( gExpected ) ) == 0 )
+			return true;
+
+		if( failures++ < 4 )
+		{
+			for( u32 i = 0; i < kDMEMSamples; ++i )
+			{
+				if( gExpected[ i ] != gActual[ i ] )
+				{
+					printf( "  %s mismatch at %03x: scalar %d, SIMD %d\n", name, i, gExpected[ i ], gActual[ i ] );
+					break;
+				}
+			}
+		}
+		return false;
+	}
+
+	s32		RandGain()
+	{
+		switch( Rand() & 7 )
+		{
+		case 0:		return 0x7fff;
+		case 1:		return -32768;
+		case 2:		return s32( Rand() >> 15 ) - 0x10000;	// Not 16 bit, as ABI3 can pass
+		default:	return RandS16();
+		}
+	}
+
+	// As EnvMixer computes them, from two s16 values
+	s32		RandVolume()
+	{
+		return ( s32( RandS16() ) * RandS16() + 0x4000 ) >> 15;
+	}
+
+	void	RandVolumes( s32 (&vols)[4][8] )
+	{
+		for( u32 j = 0; j < 4; ++j )
+		{
+			for( u32 i = 0; i < 8; ++i )
+			{
+				vols[ j ][ i ] = ( Rand() & 0xf ) == 0 ? 32768 : RandVolume();
+			}
+		}
+	}
+
+	Sample	gStream[ kStreamSamples + kAudioPolyphaseTaps - 1 ];
+	Sample	gExpectedOutput[ kStreamOutput ];
+	Sample	gActualOutput[ kStreamOutput ];
+
+	u32		PolyphaseStep()
+	{
+		return u32( ( u64( kGameFrequency ) << 16 ) / kOutputFrequency );
+	}
+
+	// The inner loop of CAudioBuffer::AddSamples before it used AudioPolyphase, for comparison
+	u32		LinearResample( Sample * out, const Sample * samples, u32 num_samples, u32 frequency, u32 output_freq )
+	{
+		const s32 r( (frequency << 12)  / output_freq );
+		s32		  s( 0 );
+		u32		  in_idx( 0 );
+		u32		  output_samples( (( num_samples * output_freq ) / frequency) - 1);
+
+		for( u32 i = 0; i < output_samples; ++i )
+		{
+			out[ i ].L = samples[ in_idx ].L + ((( samples[ in_idx + 1 ].L - samples[ in_idx ].L ) * s ) >> 12 );
+			out[ i ].R = samples[ in_idx ].R + ((( samples[ in_idx + 1 ].R - samples[ in_idx ].R ) * s ) >> 12 );
+
+			s += r;
+			in_idx += s >> 12;
+			s &= 4095;
+		}
+		return output_samples;
+	}
+
+	f64		BesselI0( f64 x )
+	{
+		f64		sum( 1.0 ), term( 1.0 );
+		for( u32 k = 1; k < 30; ++k )
+		{
+			term *= ( x / ( 2.0 * k ) ) * ( x / ( 2.0 * k ) );
+			sum += term;
+		}
+		return sum;
+	}
+
+	// Works the coefficients out again as the comment on gAudioPolyphaseCoeffs says
+	u32		CheckPolyphaseTable()
+	{
+		const u32	num_phases( kAudioPolyphasePhases );
+		u32			failures( 0 );
+
+		for( u32 phase = 0; phase <= num_phases; ++phase )
+		{
+			f64		w[ kAudioPolyphaseTaps ];
+			f64		sum( 0.0 );
+			for( u32 k = 0; k < kAudioPolyphaseTaps; ++k )
+			{
+				const f64	x( f64( k ) - 3.0 - f64( phase ) / num_phases );
+				const f64	r( x / 4.0 );
+				const f64	window( r > -1.0 && r < 1.0 ? BesselI0( 6.0 * sqrt( 1.0 - r * r ) ) / BesselI0( 6.0 ) : 0.0 );
+				w[ k ] = ( x == 0.0 ? 1.0 : sin( M_PI * x ) / ( M_PI * x ) ) * window;
+				sum += w[ k ];
+			}
+
+			s32		c[ kAudioPolyphaseTaps ];
+			s32		total( 0 );
+			for( u32 k = 0; k < kAudioPolyphaseTaps; ++k )
+			{
+				c[ k ] = s32( floor( w[ k ] * 16384.0 / sum + 0.5 ) );
+				total += c[ k ];
+			}
+			c[ phase < num_phases / 2 ? 3 : 4 ] += 16384 - total;
+
+			for( u32 k = 0; k < kAudioPolyphaseTaps; ++k )
+			{
+				if( c[ k ] != gAudioPolyphaseCoeffs[ phase ][ k ] && failures++ < 4 )
+				{
+					printf( "  Polyphase table [%u][%u] is %d, should be %d\n", phase, k, gAudioPolyphaseCoeffs[ phase ][ k ], c[ k ] );
+				}
+			}
+		}
+		return failures;
+	}
+
+	// Noise of each resampler on a sine wave of the given frequency, as a ratio to the signal in dB.
+	// Each output is compared with the sine at the point in the input the resampler was at
+	void	MeasureNoise( u32 frequency, f64 & linear_snr, f64 & polyphase_snr )
+	{
+		const f64	amplitude( 16000.0 );
+		const f64	w( 2.0 * M_PI * frequency / kGameFrequency );
+		const u32	first( kAudioPolyphaseTaps - 1 );	// The polyphase history
+
+		for( u32 i = 0; i < kStreamSamples + first; ++i )
+		{
+			gStream[ i ].L = gStream[ i ].R = s16( floor( amplitude * sin( w * ( f64( i ) - first ) ) + 0.5 ) );
+		}
+
+		// Skip the start, where the polyphase filter's taps are in the silence before the stream
+		const u32	skip( 8 );
+
+		f64		signal( 0.0 ), noise( 0.0 );
+		{
+			const s32	r( (kGameFrequency << 12) / kOutputFrequency );
+			const u32	n( LinearResample( gExpectedOutput, gStream + first, kStreamSamples, kGameFrequency, kOutputFrequency ) );
+			for( u32 i = skip; i < n; ++i )
+			{
+				const f64	t( f64( u64( i ) * r ) / 4096.0 );
+				const f64	ideal( amplitude * sin( w * t ) );
+				signal += ideal * ideal;
+				noise += ( gExpectedOutput[ i ].L - ideal ) * ( gExpectedOutput[ i ].L - ideal );
+			}
+			linear_snr = 10.0 * log10( signal / noise );
+		}
+
+		signal = noise = 0.0;
+		{
+			u32		pos( 0 ), frac( 0 );
+			for( u32 i = 0; pos < kStreamSamples; ++i )
+			{
+				const f64	t( f64( pos ) + f64( frac ) / 65536.0 - 4.0 );	// The centre, less the history before the stream
+				AudioPolyphaseScalar( gExpectedOutput, 1, gStream, kStreamSamples, pos, frac, PolyphaseStep() );
+				if( i < skip )
+					continue;
+
+				const f64	ideal( amplitude * sin( w * t ) );
+				signal += ideal * ideal;
+				noise += ( gExpectedOutput[ 0 ].L - ideal ) * ( gExpectedOutput[ 0 ].L - ideal );
+			}
+			polyphase_snr = 10.0 * log10( signal / noise );
+		}
+	}
+
+#ifdef DAEDALUS_SIMD_AUDIO
+	u32		CheckPolyphase()
+	{
+		u32		failures( 0 );
+		for( u32 c = 0; c < kNumChecks; ++c )
+		{
+			for( u32 i = 0; i < kStreamSamples + kAudioPolyphaseTaps - 1; ++i )
+			{
+				gStream[ i ].L = ( Rand() & 0x100 ) ? RandS16() : s16( RandS16() >> 4 );
+				gStream[ i ].R = ( Rand() & 0x100 ) ? RandS16() : s16( RandS16() >> 4 );
+			}
+			memset( gExpectedOutput, 0, sizeof( gExpectedOutput ) );
+			memset( gActualOutput, 0, sizeof( gActualOutput ) );
+
+			const u32	num_in( Rand() % kStreamSamples );
+			const u32	max_out( Rand() % kStreamOutput );
+			const u32	step( ( Rand() & 3 ) == 0 ? 0x10000 + ( Rand() >> 16 ) : ( Rand() >> 16 ) + 1 );	// Mostly upsampling
+			u32			pos( Rand() % ( num_in + 2 ) ), frac( Rand() >> 16 );
+			u32			expected_pos( pos ), expected_frac( frac );
+
+			const u32	expected_out( AudioPolyphaseScalar( gExpectedOutput, max_out, gStream, num_in, expected_pos, expected_frac, step ) );
+			const u32	actual_out( AudioPolyphaseSIMD( gActualOutput, max_out, gStream, num_in, pos, frac, step ) );
+
+			if( memcmp( gExpectedOutput, gActualOutput, sizeof( gExpectedOutput ) ) != 0 ||
+				expected_out != actual_out || expected_pos != pos || expected_frac != frac )
+			{
+				if( failures++ < 4 )
+				{
+					printf( "  Polyphase mismatch: scalar %u out, %x/%04x, SIMD %u out, %x/%04x\n",
+							expected_out, expected_pos, expected_frac, actual_out, pos, frac );
+				}
+			}
+		}
+		return failures;
+	}
+
+	u32		CheckMix()
+	{
+		u32		failures( 0 );
+		for( u32 c = 0; c < kNumChecks; ++c )
+		{
+			FillDMEM();
+			const u32	count( Rand() % 0x200 );
+			const u32	in( RandAddress( count, kDMEMSamples / 2, 1 ) );
+			const u32	out( RandAddress( count, in, 1 ) );
+			const s32	gain( RandGain() );
+
+			AudioMixScalar( gExpected + out, gExpected + in, gain, count );
+			AudioMixSIMD( gActual + out, gActual + in, gain, count );
+			Compare( "Mix", failures );
+		}
+		return failures;
+	}
+
+	u32		CheckInterleave()
+	{
+		u32		failures( 0 );
+		for( u32 c = 0; c < kNumChecks; ++c )
+		{
+			FillDMEM();
+			const u32	count( ( Rand() % 0x100 ) & ~1 );
+			const u32	left( RandAddress( count, kDMEMSamples / 2, 1 ) );
+			const u32	right( RandAddress( count, left + count, 1 ) );
+			const u32	out( RandAddress( count * 2, ( Rand() & 1 ) ? left : right, 2 ) );
+
+			AudioInterleaveScalar( (u32 *)(gExpected + out), (const u16 *)(gExpected + left), (const u16 *)(gExpected + right), count );
+			AudioInterleaveSIMD( (u32 *)(gActual + out), (const u16 *)(gActual + left), (const u16 *)(gActual + right), count );
+			Compare( "Interleave", failures );
+		}
+		return failures;
+	}
+
+	u32		CheckResample()
+	{
+		u32		failures( 0 );
+		for( u32 c = 0; c < kNumChecks; ++c )
+		{
+			FillDMEM();
+			const u32	count( Rand() % 0x180 );
+			const u32	pitch( ( Rand() & 3 ) == 0 ? 0x10000 : ( Rand() >> 15 ) );	// Up to twice the rate
+			u32			accumulator( Rand() >> 16 );
+			const u32	read( u32( ( u64( accumulator ) + u64( count ) * pitch ) >> 16 ) + 2 );
+			u32			src( RandAddress( read, kDMEMSamples / 2, 1 ) );
+			const u32	dst( RandAddress( count + 1, src, 2 ) );
+
+			u32			expected_src( src ), expected_accumulator( accumulator );
+			AudioResampleScalar( gExpected, dst, expected_src, expected_accumulator, pitch, count );
+			AudioResampleSIMD( gActual, dst, src, accumulator, pitch, count );
+			if( Compare( "Resample", failures ) && ( src != expected_src || accumulator != expected_accumulator ) )
+			{
+				if( failures++ < 4 )
+				{
+					printf( "  Resample state: scalar %x/%04x, SIMD %x/%04x\n", expected_src, expected_accumulator, src, accumulator );
+				}
+			}
+		}
+		return failures;
+	}
+
+	u32		CheckEnvMix()
+	{
+		u32		failures( 0 );
+		for( u32 c = 0; c < kNumChecks; ++c )
+		{
+			FillDMEM();
+			s32			vols[ 4 ][ 8 ];
+			RandVolumes( vols );
+
+			const bool	aux( ( c & 1 ) != 0 );
+			const u32	in( RandAddress( 8, kDMEMSamples / 2, 2 ) );
+			const u32	out( RandAddress( 8, in, 2 ) );
+			const u32	aux1( RandAddress( 8, out, 2 ) );
+			const u32	aux2( RandAddress( 8, aux1, 2 ) );
+			const u32	aux3( RandAddress( 8, ( Rand() & 1 ) ? aux2 : in, 2 ) );
+
+			AudioEnvMixScalar( gExpected + in, gExpected + out, gExpected + aux1, aux ? gExpected + aux2 : nullptr, aux ? gExpected + aux3 : nullptr, vols );
+			AudioEnvMixSIMD( gActual + in, gActual + out, gActual + aux1, aux ? gActual + aux2 : nullptr, aux ? gActual + aux3 : nullptr, vols );
+			Compare( "EnvMix", failures );
+		}
+		return failures;
+	}
+#endif // DAEDALUS_SIMD_AUDIO
+
+	struct SBench
+	{
+		u64		Start;
+
+		SBench()
+		{
+			NTiming::GetPreciseTime( &Start );
+		}
+
+		// Returns millions of samples per second
+		f64		MSamples( u32 samples_per_run ) const
+		{
+			u64		freq( 0 ), end( 0 );
+			NTiming::GetPreciseFrequency( &freq );
+			NTiming::GetPreciseTime( &end );
+
+			f64		seconds( f64( end - Start ) / f64( freq ) );
+			return seconds > 0.0 ? f64( kBenchRuns ) * samples_per_run / seconds / 1000000.0 : 0.0;
+		}
+	};
+
+	typedef void (*MixFunction)( s16 *, const s16 *, s32, u32 );
+	typedef void (*InterleaveFunction)( u32 *, const u16 *, const u16 *, u32 );
+	typedef void (*ResampleFunction)( s16 *, u32, u32 &, u32 &, u32, u32 );
+	typedef void (*EnvMixFunction)( const s16 *, s16 *, s16 *, s16 *, s16 *, const s32 (&)[4][8] );
+	typedef u32 (*PolyphaseFunction)( Sample *, u32, const Sample *, u32, u32 &, u32 &, u32 );
+
+	// The buffers are laid out apart from each other, as the ABIs use them
+	f64		TimeMix( MixFunction fn )
+	{
+		SBench	bench;
+		for( u32 r = 0; r < kBenchRuns; ++r )
+		{
+			fn( gActual + 0x400, gActual + 0x200, 0x5a82, kBenchSamples );
+		}
+		return bench.MSamples( kBenchSamples );
+	}
+
+	f64		TimeInterleave( InterleaveFunction fn )
+	{
+		SBench	bench;
+		for( u32 r = 0; r < kBenchRuns; ++r )
+		{
+			fn( (u32 *)(gActual + 0x400), (const u16 *)(gActual + 0x000), (const u16 *)(gActual + 0x200), kBenchSamples );
+		}
+		return bench.MSamples( kBenchSamples * 2 );
+	}
+
+	f64		TimeResample( ResampleFunction fn )
+	{
+		SBench	bench;
+		for( u32 r = 0; r < kBenchRuns; ++r )
+		{
+			u32		src( 0x100 ), accumulator( 0 );
+			fn( gActual, 0x400, src, accumulator, 0xb000, kBenchSamples );
+		}
+		return bench.MSamples( kBenchSamples );
+	}
+
+	f64		TimeEnvMix( EnvMixFunction fn )
+	{
+		s32		vols[ 4 ][ 8 ];
+		RandVolumes( vols );
+
+		SBench	bench;
+		for( u32 r = 0; r < kBenchRuns; ++r )
+		{
+			for( u32 i = 0; i < kBenchSamples; i += 8 )
+			{
+				fn( gActual + i, gActual + 0x180 + i, gActual + 0x300 + i, gActual + 0x480 + i, gActual + 0x600 + i, vols );
+			}
+		}
+		return bench.MSamples( kBenchSamples );
+	}
+
+	// Output samples from kBenchSamples at the game's rate, as AddSamples makes them
+	f64		TimePolyphase( PolyphaseFunction fn )
+	{
+		u32		num_out( 0 );
+		SBench	bench;
+		for( u32 r = 0; r < kBenchRuns; ++r )
+		{
+			u32		pos( 0 ), frac( 0 );
+			num_out = fn( gActualOutput, kStreamOutput, gStream, kBenchSamples, pos, frac, PolyphaseStep() );
+		}
+		return bench.MSamples( num_out );
+	}
+
+	f64		TimeLinear()
+	{
+		u32		num_out( 0 );
+		SBench	bench;
+		for( u32 r = 0; r < kBenchRuns; ++r )
+		{
+			num_out = LinearResample( gActualOutput, gStream, kBenchSamples, kGameFrequency, kOutputFrequency );
+		}
+		return bench.MSamples( num_out );
+	}
+
+	void	PrintResamplerComparison()
+	{
+		static const u32	kFrequencies[] = { 200, 1000, 4000, 8000, 12000 };
+
+		printf( "\nOutput resampler, %u Hz to %u Hz\n", kGameFrequency, kOutputFrequency );
+		printf( "%-10s %12s %12s\n", "SNR", "linear", "polyphase" );
+		for( u32 i = 0; i < sizeof( kFrequencies ) / sizeof( kFrequencies[ 0 ] ); ++i )
+		{
+			f64		linear_snr, polyphase_snr;
+			MeasureNoise( kFrequencies[ i ], linear_snr, polyphase_snr );
+			printf( "%7u Hz %10.1fdB %10.1fdB\n", kFrequencies[ i ], linear_snr, polyphase_snr );
+		}
+
+		FillDMEM();
+		memcpy( gStream, gActual, Min( sizeof( gStream ), sizeof( gActual ) ) );
+
+		const f64	linear_mss( TimeLinear() );
+		const f64	scalar_mss( TimePolyphase( AudioPolyphaseScalar ) );
+		printf( "%-10s %12s %12s\n", "ns/sample", "linear", "polyphase" );
+		printf( "%-10s %12.2f %12.2f\n", "scalar", 1000.0 / linear_mss, 1000.0 / scalar_mss );
+#ifdef DAEDALUS_SIMD_AUDIO
+		const f64	simd_mss( TimePolyphase( AudioPolyphaseSIMD ) );
+		printf( "%-10s %12s %12.2f\n", "SIMD", "", 1000.0 / simd_mss );
+#endif
+	}
+}
+
+int main()
+{
+	FillDMEM();
+
+#ifndef DAEDALUS_SIMD_AUDIO
+	printf( "No SIMD audio kernels in this build\n" );
+	printf( "Scalar Ms/s: Mix %.1f, Interleave %.1f, Resample %.1f, EnvMix %.1f\n",
+			TimeMix( AudioMixScalar ), TimeInterleave( AudioInterleaveScalar ), TimeResample( AudioResampleScalar ), TimeEnvMix( AudioEnvMixScalar ) );
+
+	const u32	table_failures( CheckPolyphaseTable() );
+	printf( "gAudioPolyphaseCoeffs: %s\n", table_failures == 0 ? "matches formula" : "MISMATCH" );
+	PrintResamplerComparison();
+	return table_failures == 0 ? 0 : 1;
+#else
+	const u32	mix_failures( CheckMix() );
+	const u32	interleave_failures( CheckInterleave() );
+	const u32	resample_failures( CheckResample() );
+	const u32	envmix_failures( CheckEnvMix() );
+	const u32	polyphase_failures( CheckPolyphase() );
+	const u32	table_failures( CheckPolyphaseTable() );
+	const u32	failures( mix_failures + interleave_failures + resample_failures + envmix_failures + polyphase_failures + table_failures );
+
+	printf( "%u checks each\n", kNumChecks );
+	printf( "AudioMixSIMD: %s\n", mix_failures == 0 ? "matches scalar" : "MISMATCH" );
+	printf( "AudioInterleaveSIMD: %s\n", interleave_failures == 0 ? "matches scalar" : "MISMATCH" );
+	printf( "AudioResampleSIMD: %s\n", resample_failures == 0 ? "matches scalar" : "MISMATCH" );
+	printf( "AudioEnvMixSIMD: %s\n", envmix_failures == 0 ? "matches scalar" : "MISMATCH" );
+	printf( "AudioPolyphaseSIMD: %s\n", polyphase_failures == 0 ? "matches scalar" : "MISMATCH" );
+	printf( "gAudioPolyphaseCoeffs: %s\n\n", table_failures == 0 ? "matches formula" : "MISMATCH" );
+
+	FillDMEM();
+	printf( "%-12s %12s %12s %9s\n", "", "scalar Ms/s", "SIMD Ms/s", "speedup" );
+
+	f64		scalar_mss( TimeMix( AudioMixScalar ) );
+	f64		simd_mss( TimeMix( AudioMixSIMD ) );
+	printf( "%-12s %12.1f %12.1f %8.2fx\n", "Mix", scalar_mss, simd_mss, simd_mss / scalar_mss );
+
+	scalar_mss = TimeInterleave( AudioInterleaveScalar );
+	simd_mss = TimeInterleave( AudioInterleaveSIMD );
+	printf( "%-12s %12.1f %12.1f %8.2fx\n", "Interleave", scalar_mss, simd_mss, simd_mss / scalar_mss );
+
+	scalar_mss = TimeResample( AudioResampleScalar );
+	simd_mss = TimeResample( AudioResampleSIMD );
+	printf( "%-12s %12.1f %12.1f %8.2fx\n", "Resample", scalar_mss, simd_mss, simd_mss / scalar_mss );
+
+	scalar_mss = TimeEnvMix( AudioEnvMixScalar );
+	simd_mss = TimeEnvMix( AudioEnvMixSIMD );
+	printf( "%-12s %12.1f %12.1f %8.2fx\n", "EnvMix", scalar_mss, simd_mss, simd_mss / scalar_mss );
+
+	PrintResamplerComparison();
+
+	return failures == 0 ? 0 : 1;
+#endif
+}
@@ -30,6 +30,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <string.h>
 
 #include "audiohle.h"
+#include "ADPCMPredict.h"
+#include "AudioHLEKernels.h"
 
 #include "Math/MathUtil.h"
 #include "Utility/FastMemcpy.h"
@@ -77,10 +79,7 @@ void	AudioHLEState::EnvMixer( u8 flags, u32 address )
 	s32 MainL;
 	s32 AuxR;
 	s32 AuxL;
-	s32 i1,o1,a1,a2=0,a3=0;
 	u16 AuxIncRate=1;
-	s16 zero[8];
-	memset(zero,0,16);
 	s32 LVol, RVol;
 	s32 LAcc, RAcc;
 	s32 LTrg, RTrg;
@@ -129,7 +128,6 @@ void	AudioHLEState::EnvMixer( u8 flags, u32 address )
 	if(!(flags&A_AUX))
 	{
 		AuxIncRate=0;
-		aux2=aux3=zero;
 	}
 
 	oMainL = (Dry * (LTrg>>16) + 0x4000) >> 15;
@@ -179,16 +177,11 @@ void	AudioHLEState::EnvMixer( u8 flags, u32 address )
 			RVol = 0;
 		}
 
+		// The volumes for each sample, in DMEM order
+		s32 vols[4][8];
+
 		for (s32 x = 0; x < 8; x++)
 		{
-			i1=(s32)inp[ptr^1];
-			o1=(s32)out[ptr^1];
-			a1=(s32)aux1[ptr^1];
-			if (AuxIncRate)
-			{
-				a2=(s32)aux2[ptr^1];
-				a3=(s32)aux3[ptr^1];
-			}
 			// TODO: here...
 			//LAcc = LTrg;
 			//RAcc = RTrg;
@@ -262,34 +255,14 @@ void	AudioHLEState::EnvMixer( u8 flags, u32 address )
 
 			//fprintf (dfile, "%04X ", (LAcc>>16));
 
-			o1+=(/*(o1*0x7fff)+*/(i1*MainR)+0x4000) >> 15;
-			a1+=(/*(a1*0x7fff)+*/(i1*MainL)+0x4000) >> 15;
-
-			/*		o1=((s64)(((s64)o1*0xfffe)+((s64)i1*MainR*2)+0x8000)>>16);
-
-			a1=((s64)(((s64)a1*0xfffe)+((s64)i1*MainL*2)+0x8000)>>16);*/
-
-			o1 = Saturate<s16>( o1 );
-			a1 = Saturate<s16>( a1 );
-
-			out[ptr^1]=o1;
-			aux1[ptr^1]=a1;
-			if (AuxIncRate)
-			{
-				//a2=((s64)(((s64)a2*0xfffe)+((s64)i1*AuxR*2)+0x8000)>>16);
-
-				//a3=((s64)(((s64)a3*0xfffe)+((s64)i1*AuxL*2)+0x8000)>>16);
-				a2+=(/*(a2*0x7fff)+*/(i1*AuxR)+0x4000)>>15;
-				a3+=(/*(a3*0x7fff)+*/(i1*AuxL)+0x4000)>>15;
-
-				a2 = Saturate<s16>( a2 );
-				a3 = Saturate<s16>( a3 );
-
-				aux2[ptr^1]=a2;
-				aux3[ptr^1]=a3;
-			}
-			ptr++;
+			vols[0][x^1] = MainR;
+			vols[1][x^1] = MainL;
+			vols[2][x^1] = AuxR;
+			vols[3][x^1] = AuxL;
 		}
+
+		AudioEnvMix( inp+ptr, out+ptr, aux1+ptr, AuxIncRate ? aux2+ptr : nullptr, AuxIncRate ? aux3+ptr : nullptr, vols );
+		ptr += 8;
 	}
 
 	/*LAcc = LAdderEnd;
@@ -316,10 +289,8 @@ void	AudioHLEState::Resample( u8 flags, u32 pitch, u32 address )
 	pitch *= 2;
 
 	s16 *	in ( (s16 *)(Buffer) );
-	u32 *	out( (u32 *)(Buffer) );	//Save some bandwith and fuse two sample in one write
 	u32		srcPtr((InBuffer / 2) - 1);
 	u32		dstPtr(OutBuffer / 4);
-	u32		tmp;
 
 	u32 accumulator;
 	if (flags & 0x1)
@@ -333,20 +304,7 @@ void	AudioHLEState::Resample( u8 flags, u32 pitch, u32 address )
 		accumulator = *(u16 *)(rdram + address + 10);
 	}
 
-	for(u32 i = (((Count + 0xF) & 0xFFF0) >> 2); i != 0 ; i-- )
-	{
-		tmp =  (in[srcPtr^1] + FixedPointMul16( in[(srcPtr+1)^1] - in[srcPtr^1], accumulator )) << 16;
-		accumulator += pitch;
-		srcPtr += accumulator >> 16;
-		accumulator &= 0xFFFF;
-
-		tmp |= (in[srcPtr^1] + FixedPointMul16( in[(srcPtr+1)^1] - in[srcPtr^1], accumulator )) & 0xFFFF;
-		accumulator += pitch;
-		srcPtr += accumulator >> 16;
-		accumulator &= 0xFFFF;
-
-		out[dstPtr++] = tmp;
-	}
+	AudioResample( in, dstPtr * 2, srcPtr, accumulator, pitch, ((Count + 0xF) & 0xFFF0) >> 1 );
 
 	((u16 *)rdram)[((address >> 1))^1] = in[srcPtr^1];
 	*(u16 *)(rdram + address + 10) = (u16)accumulator;
@@ -452,162 +410,6 @@ inline void AudioHLEState::ExtractSamples( s32 * output, u32 inPtr ) const
 	*output++ = (s16)((icode&0x0f)<<12);
 }
 
-//
-//	l1/l2 are IN/OUT
-//
-#if 1 //1->fast, 0->original Azimer //Corn
-inline void DecodeSamples( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 )
-{
-	s32 a[8];
-
-	a[0]= (s32)book1[0]*l1;
-	a[0]+=(s32)book2[0]*l2;
-	a[0]+=input[0]*2048;
-
-	a[1] =(s32)book1[1]*l1;
-	a[1]+=(s32)book2[1]*l2;
-	a[1]+=(s32)book2[0]*input[0];
-	a[1]+=input[1]*2048;
-
-	a[2] =(s32)book1[2]*l1;
-	a[2]+=(s32)book2[2]*l2;
-	a[2]+=(s32)book2[1]*input[0];
-	a[2]+=(s32)book2[0]*input[1];
-	a[2]+=input[2]*2048;
-
-	a[3] =(s32)book1[3]*l1;
-	a[3]+=(s32)book2[3]*l2;
-	a[3]+=(s32)book2[2]*input[0];
-	a[3]+=(s32)book2[1]*input[1];
-	a[3]+=(s32)book2[0]*input[2];
-	a[3]+=input[3]*2048;
-
-	a[4] =(s32)book1[4]*l1;
-	a[4]+=(s32)book2[4]*l2;
-	a[4]+=(s32)book2[3]*input[0];
-	a[4]+=(s32)book2[2]*input[1];
-	a[4]+=(s32)book2[1]*input[2];
-	a[4]+=(s32)book2[0]*input[3];
-	a[4]+=input[4]*2048;
-
-	a[5] =(s32)book1[5]*l1;
-	a[5]+=(s32)book2[5]*l2;
-	a[5]+=(s32)book2[4]*input[0];
-	a[5]+=(s32)book2[3]*input[1];
-	a[5]+=(s32)book2[2]*input[2];
-	a[5]+=(s32)book2[1]*input[3];
-	a[5]+=(s32)book2[0]*input[4];
-	a[5]+=input[5]*2048;
-
-	a[6] =(s32)book1[6]*l1;
-	a[6]+=(s32)book2[6]*l2;
-	a[6]+=(s32)book2[5]*input[0];
-	a[6]+=(s32)book2[4]*input[1];
-	a[6]+=(s32)book2[3]*input[2];
-	a[6]+=(s32)book2[2]*input[3];
-	a[6]+=(s32)book2[1]*input[4];
-	a[6]+=(s32)book2[0]*input[5];
-	a[6]+=input[6]*2048;
-
-	a[7] =(s32)book1[7]*l1;
-	a[7]+=(s32)book2[7]*l2;
-	a[7]+=(s32)book2[6]*input[0];
-	a[7]+=(s32)book2[5]*input[1];
-	a[7]+=(s32)book2[4]*input[2];
-	a[7]+=(s32)book2[3]*input[3];
-	a[7]+=(s32)book2[2]*input[4];
-	a[7]+=(s32)book2[1]*input[5];
-	a[7]+=(s32)book2[0]*input[6];
-	a[7]+=input[7]*2048;
-
-	*out++ =      Saturate<s16>( a[1] >> 11 );
-	*out++ =      Saturate<s16>( a[0] >> 11 );
-	*out++ =      Saturate<s16>( a[3] >> 11 );
-	*out++ =      Saturate<s16>( a[2] >> 11 );
-	*out++ =      Saturate<s16>( a[5] >> 11 );
-	*out++ =      Saturate<s16>( a[4] >> 11 );
-	*out++ = l2 = Saturate<s16>( a[7] >> 11 );
-	*out++ = l1 = Saturate<s16>( a[6] >> 11 );
-}
-
-#else
-inline void DecodeSamples( s16 * out, s32 & l1, s32 & l2, const s32 * input, const s16 * book1, const s16 * book2 )
-{
-	s32 a[8];
-
-	a[0]= (s32)book1[0]*l1;
-	a[0]+=(s32)book2[0]*l2;
-	a[0]+=input[0]*2048;
-
-	a[1] =(s32)book1[1]*l1;
-	a[1]+=(s32)book2[1]*l2;
-	a[1]+=(s32)book2[0]*input[0];
-	a[1]+=input[1]*2048;
-
-	a[2] =(s32)book1[2]*l1;
-	a[2]+=(s32)book2[2]*l2;
-	a[2]+=(s32)book2[1]*input[0];
-	a[2]+=(s32)book2[0]*input[1];
-	a[2]+=input[2]*2048;
-
-	a[3] =(s32)book1[3]*l1;
-	a[3]+=(s32)book2[3]*l2;
-	a[3]+=(s32)book2[2]*input[0];
-	a[3]+=(s32)book2[1]*input[1];
-	a[3]+=(s32)book2[0]*input[2];
-	a[3]+=input[3]*2048;
-
-	a[4] =(s32)book1[4]*l1;
-	a[4]+=(s32)book2[4]*l2;
-	a[4]+=(s32)book2[3]*input[0];
-	a[4]+=(s32)book2[2]*input[1];
-	a[4]+=(s32)book2[1]*input[2];
-	a[4]+=(s32)book2[0]*input[3];
-	a[4]+=input[4]*2048;
-
-	a[5] =(s32)book1[5]*l1;
-	a[5]+=(s32)book2[5]*l2;
-	a[5]+=(s32)book2[4]*input[0];
-	a[5]+=(s32)book2[3]*input[1];
-	a[5]+=(s32)book2[2]*input[2];
-	a[5]+=(s32)book2[1]*input[3];
-	a[5]+=(s32)book2[0]*input[4];
-	a[5]+=input[5]*2048;
-
-	a[6] =(s32)book1[6]*l1;
-	a[6]+=(s32)book2[6]*l2;
-	a[6]+=(s32)book2[5]*input[0];
-	a[6]+=(s32)book2[4]*input[1];
-	a[6]+=(s32)book2[3]*input[2];
-	a[6]+=(s32)book2[2]*input[3];
-	a[6]+=(s32)book2[1]*input[4];
-	a[6]+=(s32)book2[0]*input[5];
-	a[6]+=input[6]*2048;
-
-	a[7] =(s32)book1[7]*l1;
-	a[7]+=(s32)book2[7]*l2;
-	a[7]+=(s32)book2[6]*input[0];
-	a[7]+=(s32)book2[5]*input[1];
-	a[7]+=(s32)book2[4]*input[2];
-	a[7]+=(s32)book2[3]*input[3];
-	a[7]+=(s32)book2[2]*input[4];
-	a[7]+=(s32)book2[1]*input[5];
-	a[7]+=(s32)book2[0]*input[6];
-	a[7]+=input[7]*2048;
-
-	s16 r[8];
-	for(u32 j=0;j<8;j++)
-	{
-		u32 idx( j^1 );
-		r[idx] = Saturate<s16>( a[idx] >> 11 );
-		*(out++) = r[idx];
-	}
-
-	l1=r[6];
-	l2=r[7];
-}
-#endif
-
 void AudioHLEState::ADPCMDecode( u8 flags, u32 address )
 {
 	bool	init( (flags&0x1) != 0 );
@@ -630,8 +432,7 @@ void AudioHLEState::ADPCMDecode( u8 flags, u32 address )
 	s32 l2=out[14];
 	out+=16;
 
-	s32 inp1[8];
-	s32 inp2[8];
+	s32 inp[16];
 
 	s32 count = (s16)Count;		// XXXX why convert this to signed?
 	while(count>0)
@@ -657,17 +458,16 @@ void AudioHLEState::ADPCMDecode( u8 flags, u32 address )
 														// that this could be negative, in which case we do
 														// not use the calculated vscale value... see the
 														// if(code>12) check below
-			ExtractSamplesScale( inp1, inPtr + 0, vscale );
-			ExtractSamplesScale( inp2, inPtr + 4, vscale );
+			ExtractSamplesScale( inp + 0, inPtr + 0, vscale );
+			ExtractSamplesScale( inp + 8, inPtr + 4, vscale );
 		}
 		else
 		{
-			ExtractSamples( inp1, inPtr + 0 );
-			ExtractSamples( inp2, inPtr + 4 );
+			ExtractSamples( inp + 0, inPtr + 0 );
+			ExtractSamples( inp + 8, inPtr + 4 );
 		}
 
-		DecodeSamples( out + 0, l1, l2, inp1, book1, book2 );
-		DecodeSamples( out + 8, l1, l2, inp2, book1, book2 );
+		ADPCMPredict( out, l1, l2, inp, book1, book2 );
 
 		inPtr += 8;
 		out += 16;
@@ -783,14 +583,7 @@ void	AudioHLEState::Interleave( u16 outaddr, u16 laddr, u16 raddr, u16 count )
 	const u16 *	inr = (const u16 *)(Buffer + raddr);
 	const u16 *	inl = (const u16 *)(Buffer + laddr);
 
-	for( u32 x = (count >> 2); x != 0; x-- )
-	{
-		const u16 right = *inr++;
-		const u16 left  = *inl++;
-
-		*out++ = (*inr++ << 16) | *inl++;
-		*out++ = (right  << 16) | left;
-	}
+	AudioInterleave( out, inl, inr, (count >> 2) * 2 );
 }
 
 void	AudioHLEState::Interleave( u16 laddr, u16 raddr )
@@ -806,11 +599,7 @@ void	AudioHLEState::Mixer( u16 dmemout, u16 dmemin, s32 gain, u16 count )
 	s16*  in( (s16 *)(Buffer + dmemin) );
 	s16* out( (s16 *)(Buffer + dmemout) );
 
-	for( u32 x = count >> 1; x != 0; x-- )
-	{
-		*out = Saturate<s16>( FixedPointMul15( *in++, gain ) + s32( *out ) );
-		out++;
-	}
+	AudioMix( out, in, gain, count >> 1 );
 
 #else
 	for( u32 x=0; x < count; x+=2 )
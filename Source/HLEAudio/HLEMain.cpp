@@ -96,7 +96,7 @@ void Audio_Reset()
 //*****************************************************************************
 inline void Audio_Ucode_Detect(OSTask * pTask)
 {
-	u8* p_base = g_pu8RamBase + (u32)pTask->t.ucode_data;
+	u8* p_base = g_pu8RamBase + pTask->t.ucode_data;
 	if (*(u32*)(p_base + 0) != 0x01)
 	{
 		if (*(u32*)(p_base + 0x10) == 0x00000001)
@@ -133,7 +133,7 @@ void Audio_Ucode()
 	gAudioHLEState.LoopVal = 0;
 	//memset( gAudioHLEState.Segments, 0, sizeof( gAudioHLEState.Segments ) );
 
-	u32 * p_alist = (u32 *)(g_pu8RamBase + (u32)pTask->t.data_ptr);
+	u32 * p_alist = (u32 *)(g_pu8RamBase + pTask->t.data_ptr);
 	u32 ucode_size = (pTask->t.data_size >> 3);	//ABI5 can return 0 here!!!
 
 	while( ucode_size )
@@ -20,6 +20,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "stdafx.h"
 
 
+#include "Config/ConfigOptions.h"
+#include "Core/GraphicsTask.h"
 #include "Core/Memory.h"		// We access the memory buffers
 #include "Core/ROM.h"
 #include "Debug/Dump.h"
@@ -30,6 +32,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "HLEGraphics/TextureCache.h"
 #include "HLEGraphics/RDPStateManager.h"
 #include "HLEGraphics/DLDebug.h"
+#include "HLEGraphics/TnL.h"
 #include "Math/Math.h"			// VFPU Math
 #include "Math/MathUtil.h"
 #include "OSHLE/ultra_gbi.h"
@@ -65,7 +68,7 @@ struct TempVerts
 
 	~TempVerts()
 	{
-#if defined(DAEDALUS_GL) || defined(DAEDALUS_CTR)
+#if defined(DAEDALUS_GL) || defined(DAEDALUS_CTR) || defined(DAEDALUS_HEADLESS)
 		free(Verts);
 #endif
 	}
@@ -76,7 +79,7 @@ struct TempVerts
 #ifdef DAEDALUS_PSP
 		Verts = static_cast<DaedalusVtx*>(sceGuGetMemory(bytes));
 #endif
-#if defined(DAEDALUS_GL) || defined(DAEDALUS_CTR)
+#if defined(DAEDALUS_GL) || defined(DAEDALUS_CTR) || defined(DAEDALUS_HEADLESS)
 		Verts = static_cast<DaedalusVtx*>(malloc(bytes));
 #endif
 
@@ -163,6 +166,12 @@ BaseRenderer::BaseRenderer()
 ,	mNumIndices(0)
 ,	mVtxClipFlagsUnion( 0 )
 
+,	mNumDrawsSubmitted( 0 )
+,	mNumDrawsMerged( 0 )
+#ifdef DAEDALUS_CTR
+,	mCullMode( ~0u )
+#endif
+
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 ,	mNumTrisRendered( 0 )
 ,	mNumTrisClipped( 0 )
@@ -180,12 +189,18 @@ BaseRenderer::BaseRenderer()
 		mTexWrap[i].v = 0;
 		mActiveTile[i] = 0;
 	}
-	memset( &mTnL, 0, sizeof(mTnL) );
+	mTnL = TnLParams();
 	
 	mTnL.Flags._u32 = 0;
 	mTnL.NumLights = 0;
 	mTnL.TextureScaleX = 1.0f;
 	mTnL.TextureScaleY = 1.0f;
+
+	mBatch.texture = nullptr;
+	mBatch.colour = nullptr;
+	mBatch.position = nullptr;
+	mBatch.num_vertices = 0;
+	memset( mScissor, 0xff, sizeof( mScissor ) );
 }
 
 //*****************************************************************************
@@ -252,6 +267,10 @@ void BaseRenderer::Reset()
 	mNumIndices = 0;
 	mVtxClipFlagsUnion = 0;
 
+	mBatch.num_vertices = 0;
+	mNumDrawsSubmitted = 0;
+	mNumDrawsMerged = 0;
+
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	mNumTrisRendered = 0;
 	mNumTrisClipped = 0;
@@ -281,6 +300,8 @@ void BaseRenderer::BeginScene()
 //*****************************************************************************
 void BaseRenderer::EndScene()
 {
+	FlushBatch();
+
 	CGraphicsContext::Get()->EndFrame();
 
 	//
@@ -297,6 +318,9 @@ void BaseRenderer::EndScene()
 //*****************************************************************************
 void BaseRenderer::InitViewport()
 {
+	// The screen scale may change, so the next scissor has to be set again
+	memset( mScissor, 0xff, sizeof( mScissor ) );
+
 	// Init the N64 viewport.
 	if (gRDPFrame == 0) {
 		mVpScale = v2( 160.0f, 120.0f );
@@ -350,7 +374,7 @@ void BaseRenderer::InitViewport()
 		}
 #endif
 
-#if defined(DAEDALUS_GL) || defined(DAEDALUS_CTR)
+#if defined(DAEDALUS_GL) || defined(DAEDALUS_CTR) || defined(DAEDALUS_HEADLESS)
 		f32 w = mScreenWidth;
 		f32 h = mScreenHeight;
 
@@ -383,6 +407,7 @@ void BaseRenderer::SetN64Viewport( const v2 & scale, const v2 & trans )
 	mVpTrans.x = trans.x;
 	mVpTrans.y = trans.y;
 
+	FlushBatch();
 	InitViewport();
 }
 
@@ -414,6 +439,8 @@ void BaseRenderer::UpdateViewport()
 	sceGuViewport(vx + vp_x, vy + vp_y, vp_w, vp_h);
 #elif defined(DAEDALUS_GL) || defined(DAEDALUS_CTR)
 	glViewport(mN64ToScreenTranslate.x + vp_x, (s32)mScreenHeight - (vp_h + vp_y), vp_w, vp_h);
+#elif defined(DAEDALUS_HEADLESS)
+	// Nothing to rasterise into
 #else
 #ifdef DAEDALUS_DEBUG_CONSOLE
 	DAEDALUS_ERROR("Code to set viewport not implemented on this platform");
@@ -592,12 +619,49 @@ void BaseRenderer::FlushTris()
 	#ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( !gRDPOtherMode.depth_source, " Warning : Using depth source in flushtris" );
 	#endif
-	//
-	//	Render out our vertices
-	RenderTriangles( &temp_verts, gRDPOtherMode.depth_source ? true : false );
-
 	mNumIndices = 0;
 	mVtxClipFlagsUnion = 0;
+
+	//
+	//	Anything which would draw these differently has submitted the last batch
+	//	already, so if they follow on from it in the vertex streams, add them to it
+	if( mBatch.num_vertices > 0 )
+	{
+		const u32	num_batched( mBatch.num_vertices );
+
+		if( gBatchTrisEnabled &&
+			temp_verts.position == mBatch.position + num_batched * 3 &&
+			temp_verts.texture == mBatch.texture + num_batched * 2 &&
+			temp_verts.colour == mBatch.colour + num_batched &&
+			num_batched + temp_verts.num_vertices <= kMaxBatchVertices )
+		{
+			mBatch.num_vertices += temp_verts.num_vertices;
+			mNumDrawsMerged++;
+			return;
+		}
+
+		SubmitBatch();
+	}
+
+	mBatch = temp_verts;
+	if( !gBatchTrisEnabled )
+	{
+		SubmitBatch();
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void BaseRenderer::SubmitBatch()
+{
+	DaedalusVtxBuffer	batch( mBatch );
+	mBatch.num_vertices = 0;
+	mNumDrawsSubmitted++;
+
+	//
+	//	Render out our vertices
+	RenderTriangles( &batch, gRDPOtherMode.depth_source ? true : false );
 }
 
 //*****************************************************************************
@@ -730,24 +794,6 @@ u32 clip_tri_to_frustum( DaedalusVtx4 * v0, DaedalusVtx4 * v1 )
 	return vOut;
 }
 
-//*****************************************************************************
-// Set Clipflags
-//*****************************************************************************
-static u32 set_clip_flags(const v4 & projected)
-{
-	u32 clip_flags = 0;
-	if		(projected.x < -projected.w)	clip_flags |= X_POS;
-	else if (projected.x > projected.w)		clip_flags |= X_NEG;
-
-	if		(projected.y < -projected.w)	clip_flags |= Y_POS;
-	else if (projected.y > projected.w)		clip_flags |= Y_NEG;
-
-	if		(projected.z < -projected.w)	clip_flags |= Z_POS;
-	else if (projected.z > projected.w)		clip_flags |= Z_NEG;
-
-	return clip_flags;
-}
-
 #endif // CPU clip
 
 //*****************************************************************************
@@ -958,70 +1004,6 @@ void BaseRenderer::PrepareTrisUnclipped( DaedalusVtxBuffer * temp_verts ) const
  #endif
 }
 
-#ifndef DAEDALUS_PSP_USE_VFPU
-//*****************************************************************************
-//
-//*****************************************************************************
-v3 BaseRenderer::LightVert( const v3 & norm ) const
-{
-	const v3 & col = mTnL.Lights[mTnL.NumLights].Colour;
-	v3 result( col.x, col.y, col.z );
-
-	for ( u32 l = 0; l < mTnL.NumLights; l++ )
-	{
-		f32 fCosT = norm.Dot( mTnL.Lights[l].Direction );
-		if (fCosT > 0.0f)
-		{
-			result.x += mTnL.Lights[l].Colour.x * fCosT;
-			result.y += mTnL.Lights[l].Colour.y * fCosT;
-			result.z += mTnL.Lights[l].Colour.z * fCosT;
-		}
-	}
-
-	//Clamp to 1.0
-	if( result.x > 1.0f ) result.x = 1.0f;
-	if( result.y > 1.0f ) result.y = 1.0f;
-	if( result.z > 1.0f ) result.z = 1.0f;
-
-	return result;
-}
-
-//*****************************************************************************
-//
-//*****************************************************************************
-v3 BaseRenderer::LightPointVert( const v4 & w ) const
-{
-	const v3 & col = mTnL.Lights[mTnL.NumLights].Colour;
-	v3 result( col.x, col.y, col.z );
-
-	for ( u32 l = 0; l < mTnL.NumLights; l++ )
-	{
-		if ( mTnL.Lights[l].SkipIfZero )
-		{
-			v3 distance_vec( mTnL.Lights[l].Position.x-w.x, mTnL.Lights[l].Position.y-w.y, mTnL.Lights[l].Position.z-w.z );
-
-			f32 light_qlen = distance_vec.LengthSq();
-			f32 light_llen = sqrtf( light_qlen );
-
-			f32 at = mTnL.Lights[l].ca + mTnL.Lights[l].la * light_llen + mTnL.Lights[l].qa * light_qlen;
-			if (at > 0.0f)
-			{
-				f32 fCosT = 1.0f/at;
-				result.x += mTnL.Lights[l].Colour.x * fCosT;
-				result.y += mTnL.Lights[l].Colour.y * fCosT;
-				result.z += mTnL.Lights[l].Colour.z * fCosT;
-			}
-		}
-	}
-
-	//Clamp to 1.0
-	if( result.x > 1.0f ) result.x = 1.0f;
-	if( result.y > 1.0f ) result.y = 1.0f;
-	if( result.z > 1.0f ) result.z = 1.0f;
-
-	return result;
-}
-#endif
 
 //*****************************************************************************
 // Standard rendering pipeline using FPU/CPU
@@ -1038,7 +1020,7 @@ void BaseRenderer::SetNewVertexInfo(u32 address, u32 v0, u32 n)
 	DL_PF( "    Ambient color RGB[%f][%f][%f] Texture scale X[%f] Texture scale Y[%f]", mTnL.Lights[mTnL.NumLights].Colour.x, mTnL.Lights[mTnL.NumLights].Colour.y, mTnL.Lights[mTnL.NumLights].Colour.z, mTnL.TextureScaleX, mTnL.TextureScaleY);
 	DL_PF( "    Light[%d %s] Texture[%s] EnvMap[%s] Fog[%s]", mTnL.NumLights, (mTnL.Flags.Light)? (mTnL.Flags.PointLight)? "Point":"Normal":"Off", (mTnL.Flags.Texture)? "On":"Off", (mTnL.Flags.TexGen)? (mTnL.Flags.TexGenLin)? "Linear":"Spherical":"Off", (mTnL.Flags.Fog)? "On":"Off");
 #endif
-	const FiddledVtx * pVtxBase = (const FiddledVtx*)(g_pu8RamBase + address);
+	const FiddledVtx * pVtxBase = (const FiddledVtx*)(g_pu8GfxRamBase + address);
 
 #ifdef DAEDALUS_PSP_USE_VFPU
 	if ( !mTnL.Flags.PointLight )
@@ -1052,117 +1034,17 @@ void BaseRenderer::SetNewVertexInfo(u32 address, u32 v0, u32 n)
 		_TnLVFPU_Plight( &mat_world, &mat_world_project, pVtxBase, &mVtxProjected[v0], n, &mTnL );
 	}
 #else
-	// Transform and Project + Lighting or Transform and Project with Colour
-	//
-	for (u32 i = v0; i < v0 + n; i++)
-	{
-		const FiddledVtx & vert = pVtxBase[i - v0];
-
-		// VTX Transform
-		//
-		v4 w( f32( vert.x ), f32( vert.y ), f32( vert.z ), 1.0f );
-
-		v4 & projected( mVtxProjected[i].ProjectedPos );
-		projected = mat_world_project.Transform( w );
-		mVtxProjected[i].TransformedPos = mat_world.Transform( w );
-
-		//	Initialise the clipping flags
-		//
-		mVtxProjected[i].ClipFlags = set_clip_flags( projected );
-
-		// LIGHTING OR COLOR
-		//
-		if ( mTnL.Flags.Light )
-		{
-			v3 model_normal(f32( vert.norm_x ), f32( vert.norm_y ), f32( vert.norm_z ) );
-			v3 vecTransformedNormal;
-			vecTransformedNormal = mat_world.TransformNormal( model_normal );
-			vecTransformedNormal.Normalise();
-
-			v3 col;
-
-			if ( mTnL.Flags.PointLight )
-			{//POINT LIGHT
-				col = LightPointVert(w); // Majora's Mask uses this
-			}
-			else
-			{//NORMAL LIGHT
-				col = LightVert(vecTransformedNormal);
-			}
-			mVtxProjected[i].Colour.x = col.x;
-			mVtxProjected[i].Colour.y = col.y;
-			mVtxProjected[i].Colour.z = col.z;
-			mVtxProjected[i].Colour.w = vert.rgba_a * (1.0f / 255.0f);
-
-			// ENV MAPPING
-			//
-			if ( mTnL.Flags.TexGen )
-			{
-				// Update texture coords n.b. need to divide tu/tv by bogus scale on addition to buffer
-				// If the vert is already lit, then there is no normal (and hence we can't generate tex coord)
-#if 1			// 1->Lets use mat_world_project instead of mat_world for nicer effect (see SSV space ship) //Corn
-				vecTransformedNormal = mat_world_project.TransformNormal( model_normal );
-				vecTransformedNormal.Normalise();
-#endif
-
-				const v3 & norm = vecTransformedNormal;
-
-				if( mTnL.Flags.TexGenLin )
-				{
-					mVtxProjected[i].Texture.x = 0.5f * ( 1.0f + norm.x );
-					mVtxProjected[i].Texture.y = 0.5f * ( 1.0f + norm.y );
-				}
-				else
-				{
-					//Cheap way to do Acos(x)/Pi (abs() fixes star in SM64, sort of) //Corn
-					f32 NormX = fabsf( norm.x );
-					f32 NormY = fabsf( norm.y );
-					mVtxProjected[i].Texture.x =  0.5f - 0.25f * NormX - 0.25f * NormX * NormX * NormX;
-					mVtxProjected[i].Texture.y =  0.5f - 0.25f * NormY - 0.25f * NormY * NormY * NormY;
-				}
-			}
-			else
-			{
-				//Set Texture coordinates
-				mVtxProjected[i].Texture.x = (float)vert.tu * mTnL.TextureScaleX;
-				mVtxProjected[i].Texture.y = (float)vert.tv * mTnL.TextureScaleY;
-			}
-		}
-		else
-		{
-			//if( mTnL.Flags.Shade )
-			{// FLAT shade
-				mVtxProjected[i].Colour = v4( vert.rgba_r * (1.0f / 255.0f), vert.rgba_g * (1.0f / 255.0f), vert.rgba_b * (1.0f / 255.0f), vert.rgba_a * (1.0f / 255.0f) );
-			}
-			/*else
-			{// PRIM shade, SSV uses this, doesn't seem to do anything????
-				mVtxProjected[i].Colour = mPrimitiveColour.GetColourV4();
-			}*/
-
-
-			//Set Texture coordinates
-			mVtxProjected[i].Texture.x = (float)vert.tu * mTnL.TextureScaleX;
-			mVtxProjected[i].Texture.y = (float)vert.tv * mTnL.TextureScaleY;
-		}
-
+	// Only the PSP generates fog alpha per vertex, the others fog in hardware
 #ifdef DAEDALUS_PSP
-		//Fog
-		if ( mTnL.Flags.Fog )
-		{
-			if(projected.w > 0.0f)	//checking for positive w fixes near plane fog errors //Corn
-			{
-				f32 eye_z = projected.z / projected.w;
-				f32 fog_alpha = eye_z * mTnL.FogMult + mTnL.FogOffs;
-				//f32 fog_alpha = eye_z * 20.0f - 19.0f;	//Fog test line
-				mVtxProjected[i].Colour.w = Clamp< f32 >( fog_alpha, 0.0f, 1.0f );
-			}
-			else
-			{
-				mVtxProjected[i].Colour.w = 0.0f;
-			}
-		}
-#endif // DAEDALUS_PSP
-	}
+	const bool fog = mTnL.Flags.Fog;
+#else
+	const bool fog = false;
+#endif
+#ifdef DAEDALUS_SIMD_TNL
+	TnLSIMD( &mat_world, &mat_world_project, pVtxBase, &mVtxProjected[v0], n, &mTnL, fog );
+#else
+	TnLScalar( &mat_world, &mat_world_project, pVtxBase, &mVtxProjected[v0], n, &mTnL, fog );
+#endif
 #endif // DAEDALUS_PSP_USE_VFPU
 }
 
@@ -1178,8 +1060,8 @@ void BaseRenderer::SetNewVertexInfoConker(u32 address, u32 v0, u32 n)
 	DL_PF( "    Light[%s] Texture[%s] EnvMap[%s] Fog[%s]", (mTnL.Flags.Light)? "On":"Off", (mTnL.Flags.Texture)? "On":"Off", (mTnL.Flags.TexGen)? (mTnL.Flags.TexGenLin)? "Linear":"Spherical":"Off", (mTnL.Flags.Fog)? "On":"Off");
 	
 	//Model normal base vector
-	const s8 *mn = (const s8*)(g_pu8RamBase + gAuxAddr);
-	const FiddledVtx * pVtxBase = (const FiddledVtx*)(g_pu8RamBase + address);
+	const s8 *mn = (const s8*)(g_pu8GfxRamBase + gAuxAddr);
+	const FiddledVtx * pVtxBase = (const FiddledVtx*)(g_pu8GfxRamBase + address);
 	
 #ifdef DAEDALUS_PSP_USE_VFPU	
 	_TnLVFPUCBFD( &mat_world, &mat_project, pVtxBase, &mVtxProjected[v0], n, &mTnL, mn, v0<<1 );
@@ -1312,7 +1194,7 @@ void BaseRenderer::SetNewVertexInfoConker(u32 address, u32 v0, u32 n)
 
 void BaseRenderer::SetNewVertexInfoDKR(u32 address, u32 v0, u32 n, bool billboard)
 {
-	u32 pVtxBase {u32(g_pu8RamBase + address)};
+	uintptr_t pVtxBase {reinterpret_cast<uintptr_t>(g_pu8GfxRamBase + address)};
 	const Matrix4x4 & mat_world_project {mModelViewStack[mDKRMatIdx]};
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
@@ -1380,7 +1262,7 @@ void BaseRenderer::SetNewVertexInfoDKR(u32 address, u32 v0, u32 n, bool billboar
 		{	
 			//Only reload matrix if it has been changed and no billbording //Corn
 			mWPmodified = false;
-			sceGuSetMatrix( GU_PROJECTION, reinterpret_cast< const ScePspFMatrix4 * >( &mat_world_project) );
+			SetProjectionMatrix( mat_world_project );
 		}
 #ifdef DAEDALUS_PSP_USE_VFPU
 		_TnLVFPUDKR( n, &mat_world_project, (const FiddledVtx*)pVtxBase, &mVtxProjected[v0] );
@@ -1428,8 +1310,8 @@ void BaseRenderer::SetNewVertexInfoPD(u32 address, u32 v0, u32 n)
 #endif
 
 	//Model normal and color base vector
-	const u8 *mn = (const u8*)(g_pu8RamBase + gAuxAddr);
-	const FiddledVtxPD * const pVtxBase = (const FiddledVtxPD*)(g_pu8RamBase + address);
+	const u8 *mn = (const u8*)(g_pu8GfxRamBase + gAuxAddr);
+	const FiddledVtxPD * const pVtxBase = (const FiddledVtxPD*)(g_pu8GfxRamBase + address);
 
 #ifdef DAEDALUS_PSP_USE_VFPU	
 	_TnLVFPUPD( &mat_world, &mat_project, pVtxBase, &mVtxProjected[v0], n, &mTnL, mn );
@@ -1459,7 +1341,7 @@ void BaseRenderer::SetNewVertexInfoPD(u32 address, u32 v0, u32 n)
 			vecTransformedNormal = mat_world.TransformNormal( model_normal );
 			vecTransformedNormal.Normalise();
 
-			const v3 col = LightVert(vecTransformedNormal);
+			const v3 col = LightVert(mTnL, vecTransformedNormal);
 			mVtxProjected[i].Colour.x = col.x;
 			mVtxProjected[i].Colour.y = col.y;
 			mVtxProjected[i].Colour.z = col.z;
@@ -1657,7 +1539,7 @@ void BaseRenderer::UpdateTileSnapshots( u32 tile_idx )
 		// LOD is disabled - use two textures
 		UpdateTileSnapshot( 1, tile_idx + 1 );
 	}
-#elif defined(DAEDALUS_GL) || defined(RDP_USE_TEXEL1) || defined(DAEDALUS_CTR)
+#elif defined(DAEDALUS_GL) || defined(RDP_USE_TEXEL1) || defined(DAEDALUS_CTR) || defined(DAEDALUS_HEADLESS)
 // FIXME(strmnnrmn): What's RDP_USE_TEXEL1? Can we remove it?
 
 	if (gRDPOtherMode.cycle_type == CYCLE_2CYCLE)
@@ -1931,6 +1813,9 @@ void BaseRenderer::PrepareTexRectUVs(TexCoord * puv0, TexCoord * puv1)
 
 CRefPtr<CNativeTexture> BaseRenderer::LoadTextureDirectly( const TextureInfo & ti )
 {
+	// Sprites and backgrounds are drawn with the texture installed here
+	FlushBatch();
+
 	CRefPtr<CNativeTexture> texture = CTextureCache::Get()->GetOrCreateTexture( ti );
 #ifdef DAEDALUS_ENABLE_ASSERTS
 	DAEDALUS_ASSERT( texture, "texture is nullptr" );
@@ -1947,6 +1832,15 @@ CRefPtr<CNativeTexture> BaseRenderer::LoadTextureDirectly( const TextureInfo & t
 //*****************************************************************************
 void BaseRenderer::SetScissor( u32 x0, u32 y0, u32 x1, u32 y1 )
 {
+	if( x0 == mScissor[0] && y0 == mScissor[1] && x1 == mScissor[2] && y1 == mScissor[3] )
+		return;
+
+	FlushBatch();
+	mScissor[0] = x0;
+	mScissor[1] = y0;
+	mScissor[2] = x1;
+	mScissor[3] = y1;
+
 	//Clamp scissor to max N64 screen resolution //Corn
 	if( x1 > uViWidth )  x1 = uViWidth;
 	if( y1 > uViHeight ) y1 = uViHeight;
@@ -1974,6 +1868,8 @@ void BaseRenderer::SetScissor( u32 x0, u32 y0, u32 x1, u32 y1 )
 	s32 w {Max<s32>( r - l, 0 )};
 	s32 h {Max<s32>( b - t, 0 )};
 	glScissor(mN64ToScreenTranslate.x + l, (s32)mScreenHeight - (t + h), w, h );
+#elif defined(DAEDALUS_HEADLESS)
+	// Nothing to rasterise into
 #else
 	DAEDALUS_ERROR("Need to implement scissor for this platform.");
 #endif
@@ -2007,7 +1903,7 @@ void BaseRenderer::SetProjection(const u32 address, bool bReplace)
 	}
 
 	mWorldProjectValid = false;
-	sceGuSetMatrix( GU_PROJECTION, reinterpret_cast< const ScePspFMatrix4 * >( &mProjectionMat) );
+	SetProjectionMatrix( mProjectionMat );
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	DL_PF(
 		"	 %#+12.5f %#+12.5f %#+12.7f %#+12.5f\n"
@@ -2107,6 +2003,16 @@ void BaseRenderer::SetWorldView(const u32 address, bool bPush, bool bReplace)
 #endif
 }
 
+//*****************************************************************************
+//	Batched triangles are drawn with the projection that's loaded when they're
+//	submitted, so they have to go before it changes
+//*****************************************************************************
+inline void BaseRenderer::SetProjectionMatrix( const Matrix4x4 & mat )
+{
+	FlushBatch();
+	sceGuSetMatrix( GU_PROJECTION, reinterpret_cast< const ScePspFMatrix4 * >( &mat ) );
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -2118,7 +2024,7 @@ inline void BaseRenderer::UpdateWorldProject()
 		if( mReloadProj )
 		{
 			mReloadProj = false;
-			sceGuSetMatrix( GU_PROJECTION, reinterpret_cast< const ScePspFMatrix4 * >( &mProjectionMat) );
+			SetProjectionMatrix( mProjectionMat );
 		}
 		MatrixMultiplyAligned( &mWorldProject, &mModelViewStack[mModelViewTop], &mProjectionMat );
 	}
@@ -2139,7 +2045,7 @@ inline void BaseRenderer::PokeWorldProject()
 			mWorldProject.mRaw[8] *= HD_SCALE;
 			mWorldProject.mRaw[12] *= HD_SCALE;
 		}
-		sceGuSetMatrix( GU_PROJECTION, reinterpret_cast< const ScePspFMatrix4 * >( &mWorldProject ) );
+		SetProjectionMatrix( mWorldProject );
 		mModelViewStack[mModelViewTop] = gMatrixIdentity;
 	}
 }
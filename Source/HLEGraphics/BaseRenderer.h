@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <vitaGL.h>
 #elif defined(DAEDALUS_CTR)
 #include <GL/picaGL.h>
+#elif defined(DAEDALUS_HEADLESS)
+#include "SysNull/Null.h"
 #else
 #include "SysGL/GL.h"
 #endif
@@ -223,6 +225,7 @@ enum CycleType
 };
 
 static const u32 kMaxN64Vertices = 80;		// F3DLP.Rej supports up to 80 verts!
+static const u32 kMaxBatchVertices = 3 * 1024;	// Most vertices FlushTris will merge into one draw
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -241,16 +244,16 @@ public:
 	// Various rendering states
 	// Don't think we need to updateshademodel, it breaks tiger's honey hunt
 #ifdef DAEDALUS_PSP
-	inline void			SetTnLMode(u32 mode)					{ mTnL.Flags.Modes = mode; /*UpdateFogEnable(); UpdateShadeModel();*/ }
+	inline void			SetTnLMode(u32 mode)					{ if( mode != mTnL.Flags.Modes ) FlushBatch(); mTnL.Flags.Modes = mode; /*UpdateFogEnable(); UpdateShadeModel();*/ }
 #else
-	inline void			SetTnLMode(u32 mode)					{ mTnL.Flags.Modes = mode; UpdateFogEnable(); /*UpdateShadeModel();*/ }
+	inline void			SetTnLMode(u32 mode)					{ if( mode != mTnL.Flags.Modes ) FlushBatch(); mTnL.Flags.Modes = mode; UpdateFogEnable(); /*UpdateShadeModel();*/ }
 #endif
-	inline void			SetTextureEnable(bool enable)			{ mTnL.Flags.Texture = enable; }
-	inline void			SetTextureTile(u32 tile)				{ mTextureTile = tile; }
+	inline void			SetTextureEnable(bool enable)			{ if( enable != (mTnL.Flags.Texture != 0) ) FlushBatch(); mTnL.Flags.Texture = enable; }
+	inline void			SetTextureTile(u32 tile)				{ if( tile != mTextureTile ) FlushBatch(); mTextureTile = tile; }
 	inline u32			GetTextureTile() const					{ return mTextureTile; }
 
 #ifdef DAEDALUS_CTR
-	inline void			SetCullMode(bool enable, bool mode)		{ enable ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE); mode ? glCullFace(GL_BACK) : glCullFace(GL_FRONT); }
+	inline void			SetCullMode(bool enable, bool mode)		{ u32 cull = enable ? 1 + mode : 0; if( cull == mCullMode ) return; FlushBatch(); mCullMode = cull; enable ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE); mode ? glCullFace(GL_BACK) : glCullFace(GL_FRONT); }
 #else
 	inline void			SetCullMode(bool enable, bool mode)		{ mTnL.Flags.TriCull = enable; mTnL.Flags.CullBack = mode; }
 #endif
@@ -258,23 +261,26 @@ public:
 	// Fog stuff
 	inline void			SetFogMultOffs(f32 Mult, f32 Offs)		{ mTnL.FogMult=Mult/255.0f; mTnL.FogOffs=Offs/255.0f;}
 #ifdef DAEDALUS_PSP
-	inline void			SetFogMinMax(f32 fog_near, f32 fog_far)	{ sceGuFog(fog_near, fog_far, mFogColour.GetColour()); }
-	inline void			SetFogColour( c32 colour )				{ mFogColour = colour; }
+	inline void			SetFogMinMax(f32 fog_near, f32 fog_far)	{ FlushBatch(); sceGuFog(fog_near, fog_far, mFogColour.GetColour()); }
+	inline void			SetFogColour( c32 colour )				{ if( colour.GetColour() != mFogColour.GetColour() ) FlushBatch(); mFogColour = colour; }
 #elif defined(DAEDALUS_VITA) || defined (DAEDALUS_CTR)
-	inline void			SetFogMinMax(f32 fog_near, f32 fog_far)	{ glFogf(GL_FOG_START, fog_near); glFogf(GL_FOG_END, fog_far); }
-	inline void			SetFogColour( c32 colour )				{ float fog_clr[4] = {mFogColour.GetRf(), mFogColour.GetBf(), mFogColour.GetGf(), mFogColour.GetAf()}; glFogfv(GL_FOG_COLOR, &fog_clr[0]); }
+	inline void			SetFogMinMax(f32 fog_near, f32 fog_far)	{ FlushBatch(); glFogf(GL_FOG_START, fog_near); glFogf(GL_FOG_END, fog_far); }
+	inline void			SetFogColour( c32 colour )				{ FlushBatch(); float fog_clr[4] = {mFogColour.GetRf(), mFogColour.GetBf(), mFogColour.GetGf(), mFogColour.GetAf()}; glFogfv(GL_FOG_COLOR, &fog_clr[0]); }
+#elif defined(DAEDALUS_HEADLESS)
+	inline void			SetFogMinMax(f32 fog_near, f32 fog_far)	{}
+	inline void			SetFogColour( c32 colour )				{ if( colour.GetColour() != mFogColour.GetColour() ) FlushBatch(); mFogColour = colour; }
 #endif
 
 	// PrimDepth will replace the z value if depth_source=1 (z range 32767-0 while PSP depthbuffer range 0-65535)//Corn
 #ifdef DAEDALUS_PSP
-	inline void			SetPrimitiveDepth( u32 z )				{ mPrimDepth = (f32)( ( ( 32767 - z ) << 1) + 1 ); }
+	inline void			SetPrimitiveDepth( u32 z )				{ f32 depth = (f32)( ( ( 32767 - z ) << 1) + 1 ); if( depth != mPrimDepth ) FlushBatch(); mPrimDepth = depth; }
 #else
-	inline void			SetPrimitiveDepth( u32 z )				{ mPrimDepth = (f32)(z - 0x4000) / (f32)0x4000;}
+	inline void			SetPrimitiveDepth( u32 z )				{ f32 depth = (f32)(z - 0x4000) / (f32)0x4000; if( depth != mPrimDepth ) FlushBatch(); mPrimDepth = depth; }
 #endif
-	inline void			SetPrimitiveLODFraction( f32 f )		{ mPrimLODFraction = f; }
-	inline void			SetPrimitiveColour( c32 colour )		{ mPrimitiveColour = colour; }
-	inline void			SetEnvColour( c32 colour )				{ mEnvColour = colour; }
-	inline void			SetBlendColour( c32 colour )			{ mBlendColour = colour; }
+	inline void			SetPrimitiveLODFraction( f32 f )		{ if( f != mPrimLODFraction ) FlushBatch(); mPrimLODFraction = f; }
+	inline void			SetPrimitiveColour( c32 colour )		{ if( colour.GetColour() != mPrimitiveColour.GetColour() ) FlushBatch(); mPrimitiveColour = colour; }
+	inline void			SetEnvColour( c32 colour )				{ if( colour.GetColour() != mEnvColour.GetColour() ) FlushBatch(); mEnvColour = colour; }
+	inline void			SetBlendColour( c32 colour )			{ if( colour.GetColour() != mBlendColour.GetColour() ) FlushBatch(); mBlendColour = colour; }
 	inline void			SetFillColour( u32 colour )				{ mFillColour = colour; }
 
 	inline void			SetNumLights(u32 num)					{ mTnL.NumLights = num; }
@@ -286,7 +292,7 @@ public:
 
 	inline f32			GetCoordMod( u32 idx )					{ return mTnL.CoordMod[idx]; }
 	inline void			SetCoordMod( u32 idx, f32 mod )			{ mTnL.CoordMod[idx] = mod; }
-	inline void			SetMux( u64 mux )						{ mMux = mux; }
+	inline void			SetMux( u64 mux )						{ if( mux != mMux ) FlushBatch(); mMux = mux; }
 
 	inline void			SetTextureScale(float fScaleX, float fScaleY)	{ mTnL.TextureScaleX = fScaleX == 0 ? 1/32.0f : fScaleX; mTnL.TextureScaleY = fScaleY == 0 ? 1/32.0f : fScaleY; }
 
@@ -331,8 +337,10 @@ public:
 	// Returns true if triangle visible, false otherwise
 	bool				AddTri(u32 v0, u32 v1, u32 v2);
 
-	// Render our current triangle list to screen
+	// Render our current triangle list to screen. Consecutive lists are merged into one
+	// draw, which FlushBatch() submits before anything changes the state it's drawn with
 	void				FlushTris();
+	inline void			FlushBatch()							{ if( mBatch.num_vertices > 0 ) SubmitBatch(); }
 	//void				Line3D( u32 v0, u32 v1, u32 width );
 
 	// Returns true if bounding volume is visible within NDC box, false if culled
@@ -350,6 +358,10 @@ public:
 	inline c32			GetBlendColour() const					{ return mBlendColour; }
 	inline u32			GetFillColour() const					{ return mFillColour; }
 
+	// Draws sent to the renderer this frame, and how many FlushTris calls were merged into them
+	inline u32			GetNumDrawsSubmitted() const			{ return mNumDrawsSubmitted; }
+	inline u32			GetNumDrawsMerged() const				{ return mNumDrawsMerged; }
+
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	// Rendering stats
 	inline u32			GetNumTrisRendered() const				{ return mNumTrisRendered; }
@@ -377,6 +389,9 @@ protected:
 #elif defined(DAEDALUS_VITA)
 	inline void			UpdateFogEnable()						{ if(gFogEnabled) mTnL.Flags.Fog ? glEnable(GL_FOG) : glDisable(GL_FOG); }
 	inline void			UpdateShadeModel() {}
+#elif defined(DAEDALUS_HEADLESS)
+	inline void			UpdateFogEnable()						{}
+	inline void			UpdateShadeModel()						{}
 #else
 	inline void			UpdateFogEnable()						{ if(gFogEnabled) mTnL.Flags.Fog ? glEnable(GL_FOG) : glDisable(GL_FOG); }
 	inline void			UpdateShadeModel()						{ glShadeModel( mTnL.Flags.Shade ? GL_SMOOTH : GL_FLAT ); }
@@ -414,13 +429,13 @@ protected:
 	void				PrepareTrisClipped( TempVerts * temp_verts ) const;
 	void				PrepareTrisUnclipped( DaedalusVtxBuffer * temp_verts ) const;
 
-	v3					LightVert( const v3 & norm ) const;
-	v3					LightPointVert( const v4 & w ) const;
+	void				SubmitBatch();
 
 private:
 	void				InitViewport();
 	void				UpdateViewport();
 
+	inline void			SetProjectionMatrix( const Matrix4x4 & mat );
 	inline void			UpdateWorldProject();
 	inline void 		PokeWorldProject();
 
@@ -487,7 +502,7 @@ protected:
 	float				mScreenWidth;
 	float				mScreenHeight;
 
-#if defined(DAEDALUS_GL) || defined(DAEDALUS_VITA) || defined(DAEDALUS_CTR)
+#if defined(DAEDALUS_GL) || defined(DAEDALUS_VITA) || defined(DAEDALUS_CTR) || defined(DAEDALUS_HEADLESS)
 	Matrix4x4			mScreenToDevice;					// Used by OSX renderer - scales screen coords (0..640 etc) to device coords (-1..+1)
 #endif
 
@@ -499,6 +514,17 @@ protected:
 	DaedalusVtx4		mVtxProjected[kMaxN64Vertices];		// Transformed and projected vertices (suitable for clipping etc)
 	u32					mVtxClipFlagsUnion;					// Bitwise OR of all the vertex flags added to the current batch. If this is 0, we can trivially accept everything without clipping
 
+	// Flushed triangles not yet sent to RenderTriangles. Each flush is appended to the
+	// vertex streams, so a flush which starts where the batch ends can be merged into it
+	DaedalusVtxBuffer	mBatch;
+	u32					mNumDrawsSubmitted;
+	u32					mNumDrawsMerged;
+
+	u32					mScissor[4];						// Last SetScissor() arguments
+#ifdef DAEDALUS_CTR
+	u32					mCullMode;							// 0 for none, 1 front, 2 back. ~0 until set
+#endif
+
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	//
@@ -41,6 +41,11 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Utility/AuxFunc.h"
 #include "Utility/IO.h"
 #include "Utility/Profiler.h"
+#include "Utility/WorkerPool.h"
+
+#ifdef DAEDALUS_CTR
+extern bool isN3DS;
+#endif
 
 static std::vector<u8>		gTexelBuffer;
 static NativePf8888			gPaletteBuffer[ 256 ];
@@ -57,7 +62,7 @@ static const bool kUpdateTexturesEveryFrame = true;
 #endif
 
 
-#if defined(DAEDALUS_GL) || defined(DAEDALUS_ACCURATE_TMEM) || defined(DAEDALUS_VITA) || defined(DAEDALUS_CTR)
+#if defined(DAEDALUS_GL) || defined(DAEDALUS_ACCURATE_TMEM) || defined(DAEDALUS_VITA) || defined(DAEDALUS_CTR) || defined(DAEDALUS_HEADLESS)
 static ETextureFormat SelectNativeFormat(const TextureInfo & ti)
 {
 	// On OSX, always use RGBA 8888 textures.
@@ -101,23 +106,54 @@ static ETextureFormat SelectNativeFormat(const TextureInfo & ti)
 }
 #endif
 
+// Texture updates are converted on worker threads where there's a core to spare.
+// ConvertTile reads the emulated tmem, which changes as the display list runs,
+// so accurate tmem builds always convert synchronously.
+static u32 GetNumConversionThreads()
+{
+#if defined(DAEDALUS_PSP) || defined(DAEDALUS_ACCURATE_TMEM)
+	return 0;
+#elif defined(DAEDALUS_CTR)
+	return isN3DS ? 1 : 0;
+#else
+	return 2;
+#endif
+}
+
+// On the New 3DS, the converter gets the spare core rather than sharing the emulation one
+static s32 GetConversionThreadCore()
+{
+#if defined(DAEDALUS_CTR)
+	return 2;
+#else
+	return kThreadDefaultCore;
+#endif
+}
+
+static CWorkerPool *				gConversionPool = nullptr;
+static STextureConversionStats		gConversionStats;
+
+// source is nullptr to read the texture straight from rdram
 static bool GenerateTexels(void ** p_texels,
 						   void ** p_palette,
+						   std::vector<u8> & texel_buffer,
+						   NativePf8888 * palette_buffer,
 						   const TextureInfo & ti,
+						   const TextureSource * source,
 						   ETextureFormat texture_format,
 						   u32 pitch,
 						   u32 buffer_size)
 {
-	if( gTexelBuffer.size() < buffer_size ) //|| gTexelBuffer.size() > (128 * 1024))//Cut off for downsizing may need to be adjusted to prevent some thrashing
+	if( texel_buffer.size() < buffer_size ) //|| texel_buffer.size() > (128 * 1024))//Cut off for downsizing may need to be adjusted to prevent some thrashing
 	{
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 		printf( "Resizing texel buffer to %d bytes. Texture is %dx%d\n", buffer_size, ti.GetWidth(), ti.GetHeight() );
 #endif
-		gTexelBuffer.resize( buffer_size );
+		texel_buffer.resize( buffer_size );
 	}
 
-	void *			texels  = &gTexelBuffer[0];
-	NativePf8888 *	palette = IsTextureFormatPalettised( texture_format ) ? gPaletteBuffer : nullptr;
+	void *			texels  = &texel_buffer[0];
+	NativePf8888 *	palette = IsTextureFormatPalettised( texture_format ) ? palette_buffer : nullptr;
 
 #ifdef DAEDALUS_ACCURATE_TMEM
 	// NB: if line is 0, it implies this is a direct load from ram (e.g. S2DEX and Sprite2D ucodes)
@@ -137,7 +173,9 @@ static bool GenerateTexels(void ** p_texels,
 	}
 #endif
 
-	if (ConvertTexture(ti, texels, palette, texture_format, pitch))
+	bool converted = source ? ConvertTexture(ti, *source, texels, palette, texture_format, pitch)
+							: ConvertTexture(ti, texels, palette, texture_format, pitch);
+	if (converted)
 	{
 		*p_texels  = texels;
 		*p_palette = palette;
@@ -147,6 +185,74 @@ static bool GenerateTexels(void ** p_texels,
 	return false;
 }
 
+//
+//	Everything needed to convert a texture, copied from the native texture so
+//	the conversion can run away from the thread which owns it.
+//
+struct STextureTarget
+{
+	explicit STextureTarget( const CNativeTexture * texture )
+		:	Format( texture->GetFormat() )
+		,	Stride( texture->GetStride() )
+		,	BytesRequired( texture->GetBytesRequired() )
+		,	CorrectedWidth( texture->GetCorrectedWidth() )
+		,	CorrectedHeight( texture->GetCorrectedHeight() )
+	{
+	}
+
+	ETextureFormat	Format;
+	u32				Stride;
+	u32				BytesRequired;
+	u32				CorrectedWidth;
+	u32				CorrectedHeight;
+};
+
+// Safe to call from any thread, as long as each caller has its own buffers and
+// a snapshot of the texture to read (source is nullptr to read rdram)
+static bool ConvertTexels( const TextureInfo & ti, const TextureSource * source, const STextureTarget & target,
+						   std::vector<u8> & texel_buffer, NativePf8888 * palette_buffer,
+						   void ** p_texels, void ** p_palette )
+{
+	ETextureFormat	format = target.Format;
+	u32 			stride = target.Stride;
+
+	void *	texels;
+	void *	palette;
+	if( !GenerateTexels( &texels, &palette, texel_buffer, palette_buffer, ti, source, format, stride, target.BytesRequired ) )
+	{
+		return false;
+	}
+
+	//
+	//	Recolour the texels
+	//
+	if( ti.GetWhite() )
+	{
+		Recolour( texels, palette, ti.GetWidth(), ti.GetHeight(), stride, format, c32::White );
+	}
+
+	//
+	//	Clamp edges. We do this so that non power-of-2 textures whose whose width/height
+	//	is less than the mask value clamp correctly. It still doesn't fix those
+	//	textures with a width which is greater than the power-of-2 size.
+	//
+	ClampTexels( texels, ti.GetWidth(), ti.GetHeight(), target.CorrectedWidth, target.CorrectedHeight, stride, format );
+
+	//
+	//	Mirror the texels if required (in-place)
+	//
+	bool mirror_s = ti.GetEmulateMirrorS();
+	bool mirror_t = ti.GetEmulateMirrorT();
+	if( mirror_s || mirror_t )
+	{
+		MirrorTexels( mirror_s, mirror_t, texels, stride, texels, stride, format, ti.GetWidth(), ti.GetHeight() );
+	}
+
+	*p_texels  = texels;
+	*p_palette = palette;
+	return true;
+}
+
 static void UpdateTexture( const TextureInfo & ti, CNativeTexture * texture )
 {
 	#ifdef DAEDALUS_PROFILE
@@ -157,43 +263,101 @@ static void UpdateTexture( const TextureInfo & ti, CNativeTexture * texture )
 	#endif
 	if ( texture != nullptr && texture->HasData() )
 	{
-		ETextureFormat	format = texture->GetFormat();
-		u32 			stride = texture->GetStride();
-
 		void *	texels;
 		void *	palette;
-		if( GenerateTexels( &texels, &palette, ti, format, stride, texture->GetBytesRequired() ) )
+		if( ConvertTexels( ti, nullptr, STextureTarget( texture ), gTexelBuffer, gPaletteBuffer, &texels, &palette ) )
 		{
-			//
-			//	Recolour the texels
-			//
-			if( ti.GetWhite() )
-			{
-				Recolour( texels, palette, ti.GetWidth(), ti.GetHeight(), stride, format, c32::White );
-			}
-
-			//
-			//	Clamp edges. We do this so that non power-of-2 textures whose whose width/height
-			//	is less than the mask value clamp correctly. It still doesn't fix those
-			//	textures with a width which is greater than the power-of-2 size.
-			//
-			ClampTexels( texels, ti.GetWidth(), ti.GetHeight(), texture->GetCorrectedWidth(), texture->GetCorrectedHeight(), stride, format );
-
-			//
-			//	Mirror the texels if required (in-place)
-			//
-			bool mirror_s = ti.GetEmulateMirrorS();
-			bool mirror_t = ti.GetEmulateMirrorT();
-			if( mirror_s || mirror_t )
-			{
-				MirrorTexels( mirror_s, mirror_t, texels, stride, texels, stride, format, ti.GetWidth(), ti.GetHeight() );
-			}
-
 			texture->SetData( texels, palette );
 		}
+		gConversionStats.SyncConversions++;
 	}
 }
 
+//
+//	A texture update being converted on a worker. The job keeps its own buffers,
+//	and the texels are uploaded by the texture's owner once it's finished. The
+//	worker converts a snapshot of rdram taken when the job was queued, as the
+//	emulated cpu can overwrite the texels and palette while it runs.
+//
+class CTextureConversion : public CWorkerJob
+{
+public:
+	CTextureConversion( const TextureInfo & ti, const CNativeTexture * texture )
+		:	mTextureInfo( ti )
+		,	mTarget( texture )
+		,	mSource()
+		,	mTexels( nullptr )
+		,	mPalette( nullptr )
+		,	mSucceeded( false )
+	{
+	}
+
+	// Call before each Submit, while the job isn't running
+	void Snapshot()
+	{
+		SnapshotTextureSource( mTextureInfo, mSourceBuffer, &mSource );
+	}
+
+	virtual void Run()
+	{
+		mSucceeded = ConvertTexels( mTextureInfo, &mSource, mTarget, mTexelBuffer, mPaletteBuffer, &mTexels, &mPalette );
+	}
+
+	void Upload( CNativeTexture * texture ) const
+	{
+		if( mSucceeded )
+		{
+			texture->SetData( mTexels, mPalette );
+		}
+	}
+
+private:
+	const TextureInfo	mTextureInfo;
+	STextureTarget		mTarget;
+
+	std::vector<u8>		mSourceBuffer;
+	TextureSource		mSource;
+
+	std::vector<u8>		mTexelBuffer;
+	NativePf8888		mPaletteBuffer[ 256 ];
+
+	void *				mTexels;
+	void *				mPalette;
+	bool				mSucceeded;
+};
+
+void CachedTexture::StartConversionThreads()
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT_Q(gConversionPool == nullptr);
+	#endif
+	u32 num_threads = GetNumConversionThreads();
+	if( num_threads > 0 )
+	{
+		gConversionPool = new CWorkerPool( "TextureConversion", num_threads, WPW_POLL, GetConversionThreadCore() );
+		if( gConversionPool->GetNumThreads() == 0 )
+		{
+			StopConversionThreads();
+		}
+	}
+}
+
+void CachedTexture::StopConversionThreads()
+{
+	delete gConversionPool;
+	gConversionPool = nullptr;
+}
+
+void CachedTexture::ResetConversionStats()
+{
+	memset( &gConversionStats, 0, sizeof( gConversionStats ) );
+}
+
+const STextureConversionStats & CachedTexture::GetConversionStats()
+{
+	return gConversionStats;
+}
+
 CachedTexture * CachedTexture::Create( const TextureInfo & ti )
 {
 	if( ti.GetWidth() == 0 || ti.GetHeight() == 0 )
@@ -216,6 +380,9 @@ CachedTexture * CachedTexture::Create( const TextureInfo & ti )
 CachedTexture::CachedTexture( const TextureInfo & ti )
 :	mTextureInfo( ti )
 ,	mpTexture(nullptr)
+,	mpConversion( nullptr )
+,	mConversionPending( false )
+,	mConversionStale( false )
 ,	mTextureContentsHash( 0 )
 ,	mFrameLastUpToDate( gRDPFrame )
 ,	mFrameLastUsed( gRDPFrame )
@@ -224,6 +391,11 @@ CachedTexture::CachedTexture( const TextureInfo & ti )
 
 CachedTexture::~CachedTexture()
 {
+	if( mConversionPending )
+	{
+		gConversionPool->Wait( mpConversion );
+	}
+	delete mpConversion;
 }
 
 bool CachedTexture::Initialise()
@@ -248,6 +420,7 @@ bool CachedTexture::Initialise()
 		{
 			mFrameLastUpToDate = gRDPFrame + (FastRand() & (gCheckTextureHashFrequency - 1));
 		}
+		// The first conversion is always synchronous, so there's never an empty texture to draw with
 		UpdateTextureHash();
 		UpdateTexture( mTextureInfo, mpTexture );
 	}
@@ -271,13 +444,70 @@ bool CachedTexture::UpdateTextureHash()
 	return changed;
 }
 
+//
+//	Until a queued conversion finishes, the texture keeps its previous contents.
+//
+void CachedTexture::QueueUpdate()
+{
+	if( gConversionPool == nullptr || !mpTexture->HasData() )
+	{
+		UpdateTexture( mTextureInfo, mpTexture );
+		return;
+	}
+
+	if( mConversionPending )
+	{
+		// The pending conversion has a snapshot of the old contents, so it's
+		// queued again once it's been uploaded.
+		mConversionStale = true;
+		return;
+	}
+
+	if( mpConversion == nullptr )
+	{
+		mpConversion = new CTextureConversion( mTextureInfo, mpTexture );
+	}
+
+	mpConversion->Snapshot();
+	gConversionPool->Submit( mpConversion );
+	mConversionPending = true;
+	gConversionStats.QueuedConversions++;
+}
+
+void CachedTexture::FinishConversion()
+{
+	if( gConversionPool->GetState( mpConversion ) != WJS_IDLE )
+		return;
+
+	mpConversion->Upload( mpTexture );
+	mConversionPending = false;
+	gConversionStats.Uploads++;
+
+	if( mConversionStale )
+	{
+		mConversionStale = false;
+		QueueUpdate();
+	}
+	else if( !kUpdateTexturesEveryFrame )
+	{
+		// Updates are rare, so don't hang on to the buffers
+		delete mpConversion;
+		mpConversion = nullptr;
+	}
+}
+
 void CachedTexture::UpdateIfNecessary()
 {
+	if( mConversionPending )
+	{
+		FinishConversion();
+	}
+
 	if( !IsFresh() )
 	{
 		if (UpdateTextureHash())
 		{
-			UpdateTexture( mTextureInfo, mpTexture );
+			QueueUpdate();
 		}
 
 		// FIXME(strmnrmn): should probably recreate mpWhiteTexture if it exists, else it may have stale data.
@@ -357,7 +587,7 @@ void CachedTexture::DumpTexture( const TextureInfo & ti, const CNativeTexture *
 
 		// Note that we re-convert the texels because those in the native texture may well already
 		// be swizzle. Maybe we should just have an unswizzle routine?
-		if( GenerateTexels( &texels, &palette, ti, texture->GetFormat(), texture->GetStride(), texture->GetBytesRequired() ) )
+		if( GenerateTexels( &texels, &palette, gTexelBuffer, gPaletteBuffer, ti, nullptr, texture->GetFormat(), texture->GetStride(), texture->GetBytesRequired() ) )
 		{
 			// NB - this does not include the mirrored texels
 
@@ -28,6 +28,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 extern u32 gRDPFrame;
 
+class CTextureConversion;
+
+struct STextureConversionStats
+{
+	u32			SyncConversions;	// Converted and uploaded on the spot
+	u32			QueuedConversions;	// Handed to a conversion thread
+	u32			Uploads;			// Queued conversions which have been uploaded
+};
+
 class CachedTexture
 {
 	protected:
@@ -45,6 +54,13 @@ class CachedTexture
 #endif
 		bool							HasExpired() const;
 
+		// Called by the texture cache as it's created and destroyed
+		static void						StartConversionThreads();
+		static void						StopConversionThreads();
+
+		static void						ResetConversionStats();
+		static const STextureConversionStats &	GetConversionStats();
+
 	private:
 		friend class CTextureCache;
 		void							UpdateIfNecessary();
@@ -52,12 +68,18 @@ class CachedTexture
 		bool							Initialise();
 		bool							IsFresh() const;
 		bool							UpdateTextureHash();
+		void							QueueUpdate();
+		void							FinishConversion();
 
 	private:
 		const TextureInfo				mTextureInfo;
 
 		CRefPtr<CNativeTexture>			mpTexture;
 
+		CTextureConversion *			mpConversion;		// Kept between updates if they're frequent
+		bool							mConversionPending;	// mpConversion is queued or hasn't been uploaded
+		bool							mConversionStale;	// Contents changed after the pending conversion was snapshotted
+
 		u32								mTextureContentsHash;
 		u32								mFrameLastUpToDate;	// Frame # that this was last updated
 		u32								mFrameLastUsed;		// Frame # that this was last used
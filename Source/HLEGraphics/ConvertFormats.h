@@ -0,0 +1,89 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef HLEGRAPHICS_CONVERTFORMATS_H_
+#define HLEGRAPHICS_CONVERTFORMATS_H_
+
+#include "Utility/DaedalusTypes.h"
+
+// Expansion tables for widening n-bit channels to 8 bits.
+static const u8 OneToEight[2] =
+{
+	0x00,		// 0 -> 00 00 00 00
+	0xff		// 1 -> 11 11 11 11
+};
+
+static const u8 ThreeToEight[8] =
+{
+	0x00,		// 000 -> 00 00 00 00
+	0x24,		// 001 -> 00 10 01 00
+	0x49,		// 010 -> 01 00 10 01
+	0x6d,		// 011 -> 01 10 11 01
+	0x92,		// 100 -> 10 01 00 10
+	0xb6,		// 101 -> 10 11 01 10
+	0xdb,		// 110 -> 11 01 10 11
+	0xff		// 111 -> 11 11 11 11
+};
+
+static const u8 FourToEight[16] =
+{
+	0x00, 0x11, 0x22, 0x33,
+	0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb,
+	0xcc, 0xdd, 0xee, 0xff
+};
+
+static const u8 FiveToEight[32] =
+{
+	0x00, 0x08, 0x10, 0x18, 0x21, 0x29, 0x31, 0x39,
+	0x42, 0x4a, 0x52, 0x5a, 0x63, 0x6b, 0x73, 0x7b,
+	0x84, 0x8c, 0x94, 0x9c, 0xa5, 0xad, 0xb5, 0xbd,
+	0xc6, 0xce, 0xd6, 0xde, 0xe7, 0xef, 0xf7, 0xff
+};
+
+inline s32 ClampYUVComponent( s32 c )
+{
+	return c < 0 ? 0 : (c > 255 ? 255 : c);
+}
+
+//*****************************************************************************
+// Converts a YUV texel to a little-endian 8888 value (R in the low byte).
+//*****************************************************************************
+inline u32 YUV16( s32 y, s32 u, s32 v )
+{
+	s32 r = ClampYUVComponent( s32( y + (1.370705f * (v - 128)) ) );
+	s32 g = ClampYUVComponent( s32( y - (0.698001f * (v - 128)) - (0.337633f * (u - 128)) ) );
+	s32 b = ClampYUVComponent( s32( y + (1.732446f * (u - 128)) ) );
+
+	return (0xff << 24) | (b << 16) | (g << 8) | r;
+}
+
+//*****************************************************************************
+// Converts a YUV texel to an N64 5551 framebuffer pixel.
+//*****************************************************************************
+inline u16 YUVtoRGBA( u8 y, u8 u, u8 v )
+{
+	s32 r = ClampYUVComponent( s32( y + (1.370705f * (v - 128)) ) );
+	s32 g = ClampYUVComponent( s32( y - (0.698001f * (v - 128)) - (0.337633f * (u - 128)) ) );
+	s32 b = ClampYUVComponent( s32( y + (1.732446f * (u - 128)) ) );
+
+	return (u16)(((r >> 3) << 11) | ((g >> 3) << 6) | ((b >> 3) << 1) | 1);
+}
+
+#endif // HLEGRAPHICS_CONVERTFORMATS_H_
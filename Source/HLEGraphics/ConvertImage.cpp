@@ -19,7 +19,11 @@ Copyright (C) 2001 StrmnNrmn
 
 #include "stdafx.h"
 
+#include <algorithm>
+#include <string.h>
+
 #include "DLDebug.h"
+#include "Core/GraphicsTask.h"
 #include "Core/Memory.h"
 #include "Debug/DBGConsole.h"
 #include "Graphics/NativePixelFormat.h"
@@ -34,6 +38,8 @@ Copyright (C) 2001 StrmnNrmn
 namespace
 {
 
+const SConvertRowKernels *	gConvertRowKernels = nullptr;
+
 struct TextureDestInfo
 {
 	explicit TextureDestInfo( ETextureFormat tex_fmt )
@@ -43,6 +49,7 @@ struct TextureDestInfo
 		,	Pitch( 0 )
 		,	Data( nullptr )
 		,	Palette( nullptr )
+		,	Source( nullptr )
 	{
 	}
 
@@ -52,6 +59,7 @@ struct TextureDestInfo
 	s32					Pitch;			// Specifies the number of bytes on each row (not necessarily bitdepth*width/8)
 	void *				Data;			// Pointer to the top left pixel of the image
 	NativePf8888 *		Palette;
+	const TextureSource *	Source;		// ti's load and tlut addresses are read from here
 };
 
 template< u32 Size >
@@ -98,8 +106,8 @@ static void ConvertGeneric( const TextureDestInfo & dsti,
 							ConvertRowFunction unswapped_fn )
 {
 	OutT *		dst        = reinterpret_cast< OutT * >( dsti.Data );
-	const u8 *	src  = g_pu8RamBase;
-	u32			src_offset = ti.GetLoadAddress();
+	const u8 *	src  = dsti.Source->Texels;
+	u32			src_offset = ti.GetLoadAddress() - dsti.Source->TexelsAddress;
 	u32			src_pitch  = ti.GetPitch();
 
 	if ( ti.IsSwapped())
@@ -135,34 +143,38 @@ static void ConvertGeneric( const TextureDestInfo & dsti,
 static void ConvertGenericYUVBlocks( const TextureDestInfo & dsti, const TextureInfo & ti)
 {
 	u32 *		dst  = reinterpret_cast< u32 * >( dsti.Data );
-	const u8 *	src  = g_pu8RamBase;
-	u32			src_offset = ti.GetLoadAddress();
+	const u8 *	src  = dsti.Source->Texels;
+	u32			src_offset = ti.GetLoadAddress() - dsti.Source->TexelsAddress;
 
 	u32 width = ti.GetWidth();
 	u32 height = ti.GetHeight();
 
-	u32 *mb = (u32*)(src + src_offset);
+	const u32 *mb = (const u32*)(src + src_offset);
 
-	//yuv macro block contains 16x16 texture.
-	for (u32 h = 0; h < height; h++)
-	{
-		// Do two pixels at a time
-		for (u32 w = 0; w < width; w+=2)
-		{
-			u32 t = *(mb++); //each u32 contains 2 pixels
-			u8 y1 = (u8)(t    )&0xFF;
-			u8 v  = (u8)(t>>8 )&0xFF;
-			u8 y0 = (u8)(t>>16)&0xFF;
-			u8 u  = (u8)(t>>24)&0xFF;
-			*(dst++) = YUV16(y0, u, v);
-			*(dst++) = YUV16(y1, u, v);
-		}
-	}
+	//yuv macro block contains 16x16 texture. Rows are converted two pixels at a time, and are packed together
+	gConvertRowKernels->YUV16( dst, mb, height * ((width + 1) / 2) );
 }
 
 };
 
-typedef void (*ConvertPalettisedRowFunction)( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width, const NativePf8888 * palette );
+static void ConvertYUV16_Row( u32 * dst, const u32 * src, u32 num_pairs )
+{
+	for (u32 i = 0; i < num_pairs; i++)
+	{
+		u32 t = *(src++); //each u32 contains 2 pixels
+		u8 y1 = (u8)(t    )&0xFF;
+		u8 v  = (u8)(t>>8 )&0xFF;
+		u8 y0 = (u8)(t>>16)&0xFF;
+		u8 u  = (u8)(t>>24)&0xFF;
+		*(dst++) = YUV16(y0, u, v);
+		*(dst++) = YUV16(y1, u, v);
+	}
+}
+
+static void ConvertRowsTo8888( const TextureDestInfo & dsti, const TextureInfo & ti, const ConvertRowFunction fns[2] )
+{
+	SConvertGeneric< NativePf8888 >::ConvertGeneric( dsti, ti, fns[1], fns[0] );
+}
 
 static void ConvertPalettisedTo8888( const TextureDestInfo & dsti, const TextureInfo & ti,
 									 const NativePf8888 * palette,
@@ -170,8 +182,8 @@ static void ConvertPalettisedTo8888( const TextureDestInfo & dsti, const Texture
 									 ConvertPalettisedRowFunction unswapped_fn )
 {
 	NativePf8888 *	dst        = reinterpret_cast< NativePf8888 * >( dsti.Data );
-	const u8 *		src        = g_pu8RamBase;
-	u32				src_offset = ti.GetLoadAddress();
+	const u8 *		src        = dsti.Source->Texels;
+	u32				src_offset = ti.GetLoadAddress() - dsti.Source->TexelsAddress;
 	u32				src_pitch  = ti.GetPitch();
 
 	if (ti.IsSwapped())
@@ -209,8 +221,8 @@ static void ConvertPalettisedToCI( const TextureDestInfo & dsti, const TextureIn
 								   void (*unswapped_fn)( OutT * dst, const u8 * src, u32 src_offset, u32 width ) )
 {
 	OutT *		dst        = reinterpret_cast< OutT * >( dsti.Data );
-	const u8 *	src        = g_pu8RamBase;
-	u32			src_offset = ti.GetLoadAddress();
+	const u8 *	src        = dsti.Source->Texels;
+	u32			src_offset = ti.GetLoadAddress() - dsti.Source->TexelsAddress;
 	u32			src_pitch  = ti.GetPitch();
 
 	if (ti.IsSwapped())
@@ -546,38 +558,59 @@ static  void ConvertCI8_Row_To_8888( NativePf8888 * dst, const u8 * src, u32 src
 
 static void ConvertRGBA16(const TextureDestInfo & dsti, const TextureInfo & ti)
 {
-	SConvert< N64Pf5551 >::ConvertTexture( dsti, ti );
+	if (dsti.Format == TexFmt_8888)
+		ConvertRowsTo8888( dsti, ti, gConvertRowKernels->RGBA16 );
+	else
+		SConvert< N64Pf5551 >::ConvertTexture( dsti, ti );
 }
 
 static void ConvertRGBA32(const TextureDestInfo & dsti, const TextureInfo & ti)
 {
 	// Did have Fiddle of 8 here, pretty sure this was wrong (should have been 4)
-	SConvert< N64Pf8888 >::ConvertTexture( dsti, ti );
+	if (dsti.Format == TexFmt_8888)
+		ConvertRowsTo8888( dsti, ti, gConvertRowKernels->RGBA32 );
+	else
+		SConvert< N64Pf8888 >::ConvertTexture( dsti, ti );
 }
 
 static void ConvertIA4(const TextureDestInfo & dsti, const TextureInfo & ti)
 {
-	SConvertIA4::ConvertTexture( dsti, ti );
+	if (dsti.Format == TexFmt_8888)
+		ConvertRowsTo8888( dsti, ti, gConvertRowKernels->IA4 );
+	else
+		SConvertIA4::ConvertTexture( dsti, ti );
 }
 
 static void ConvertIA8(const TextureDestInfo & dsti, const TextureInfo & ti)
 {
-	SConvert< N64PfIA8 >::ConvertTexture( dsti, ti );
+	if (dsti.Format == TexFmt_8888)
+		ConvertRowsTo8888( dsti, ti, gConvertRowKernels->IA8 );
+	else
+		SConvert< N64PfIA8 >::ConvertTexture( dsti, ti );
 }
 
 static void ConvertIA16(const TextureDestInfo & dsti, const TextureInfo & ti)
 {
-	SConvert< N64PfIA16 >::ConvertTexture( dsti, ti );
+	if (dsti.Format == TexFmt_8888)
+		ConvertRowsTo8888( dsti, ti, gConvertRowKernels->IA16 );
+	else
+		SConvert< N64PfIA16 >::ConvertTexture( dsti, ti );
 }
 
 static void ConvertI4(const TextureDestInfo & dsti, const TextureInfo & ti)
 {
-	SConvertI4::ConvertTexture( dsti, ti );
+	if (dsti.Format == TexFmt_8888)
+		ConvertRowsTo8888( dsti, ti, gConvertRowKernels->I4 );
+	else
+		SConvertI4::ConvertTexture( dsti, ti );
 }
 
 static void ConvertI8(const TextureDestInfo & dsti, const TextureInfo & ti)
 {
-	SConvert< N64PfI8 >::ConvertTexture( dsti, ti );
+	if (dsti.Format == TexFmt_8888)
+		ConvertRowsTo8888( dsti, ti, gConvertRowKernels->I8 );
+	else
+		SConvert< N64PfI8 >::ConvertTexture( dsti, ti );
 }
 
 static void ConvertCI8(const TextureDestInfo & dsti, const TextureInfo & ti)
@@ -586,7 +619,7 @@ static void ConvertCI8(const TextureDestInfo & dsti, const TextureInfo & ti)
 	NativePf8888 temp_palette[256];
 
 	NativePf8888 *	dst_palette = dsti.Palette ? reinterpret_cast< NativePf8888 * >( dsti.Palette ) : temp_palette;
-	const void * 	src_palette = g_pu8RamBase + ti.GetTlutAddress();
+	const void * 	src_palette = dsti.Source->Palette + (ti.GetTlutAddress() - dsti.Source->PaletteAddress);
 
 	ConvertPalette(ti.GetTLutFormat(), dst_palette, src_palette, 256);
 
@@ -594,8 +627,8 @@ static void ConvertCI8(const TextureDestInfo & dsti, const TextureInfo & ti)
 	{
 	case TexFmt_8888:
 		ConvertPalettisedTo8888( dsti, ti, dst_palette,
-								 ConvertCI8_Row_To_8888< 0x4 | 0x3 >,
-								 ConvertCI8_Row_To_8888< 0x3 > );
+								 gConvertRowKernels->CI8[1],
+								 gConvertRowKernels->CI8[0] );
 		break;
 
 	case TexFmt_CI8_8888:
@@ -622,7 +655,7 @@ static void ConvertCI4(const TextureDestInfo & dsti, const TextureInfo & ti)
 	NativePf8888 temp_palette[16];
 
 	NativePf8888 *	dst_palette = dsti.Palette ? reinterpret_cast< NativePf8888 * >( dsti.Palette ) : temp_palette;
-	const void * 	src_palette = g_pu8RamBase + ti.GetTlutAddress();
+	const void * 	src_palette = dsti.Source->Palette + (ti.GetTlutAddress() - dsti.Source->PaletteAddress);
 
 	ConvertPalette(ti.GetTLutFormat(), dst_palette, src_palette, 16);
 
@@ -630,8 +663,8 @@ static void ConvertCI4(const TextureDestInfo & dsti, const TextureInfo & ti)
 	{
 	case TexFmt_8888:
 		ConvertPalettisedTo8888( dsti, ti, dst_palette,
-								 ConvertCI4_Row_To_8888< 0x4 | 0x3 >,
-								 ConvertCI4_Row_To_8888< 0x3 > );
+								 gConvertRowKernels->CI4[1],
+								 gConvertRowKernels->CI4[0] );
 		break;
 
 	case TexFmt_CI4_8888:
@@ -650,6 +683,37 @@ static void ConvertCI4(const TextureDestInfo & dsti, const TextureInfo & ti)
 
 } // anonymous namespace
 
+const SConvertRowKernels gScalarConvertRowKernels =
+{
+	"scalar",
+	{ SConvert< N64Pf5551 >::ConvertRow< NativePf8888, SConvert< N64Pf5551 >::Fiddle, 0 >,
+	  SConvert< N64Pf5551 >::ConvertRow< NativePf8888, SConvert< N64Pf5551 >::Fiddle, SConvert< N64Pf5551 >::Swizzle > },
+	{ SConvert< N64Pf8888 >::ConvertRow< NativePf8888, SConvert< N64Pf8888 >::Fiddle, 0 >,
+	  SConvert< N64Pf8888 >::ConvertRow< NativePf8888, SConvert< N64Pf8888 >::Fiddle, SConvert< N64Pf8888 >::Swizzle > },
+	{ SConvertIA4::ConvertRow< NativePf8888, SConvertIA4::Fiddle >,
+	  SConvertIA4::ConvertRow< NativePf8888, 0x4 | SConvertIA4::Fiddle > },
+	{ SConvert< N64PfIA8 >::ConvertRow< NativePf8888, SConvert< N64PfIA8 >::Fiddle, 0 >,
+	  SConvert< N64PfIA8 >::ConvertRow< NativePf8888, SConvert< N64PfIA8 >::Fiddle, SConvert< N64PfIA8 >::Swizzle > },
+	{ SConvert< N64PfIA16 >::ConvertRow< NativePf8888, SConvert< N64PfIA16 >::Fiddle, 0 >,
+	  SConvert< N64PfIA16 >::ConvertRow< NativePf8888, SConvert< N64PfIA16 >::Fiddle, SConvert< N64PfIA16 >::Swizzle > },
+	{ SConvertI4::ConvertRow< NativePf8888, SConvertI4::Fiddle >,
+	  SConvertI4::ConvertRow< NativePf8888, 0x4 | SConvertI4::Fiddle > },
+	{ SConvert< N64PfI8 >::ConvertRow< NativePf8888, SConvert< N64PfI8 >::Fiddle, 0 >,
+	  SConvert< N64PfI8 >::ConvertRow< NativePf8888, SConvert< N64PfI8 >::Fiddle, SConvert< N64PfI8 >::Swizzle > },
+	{ ConvertCI4_Row_To_8888< 0x3 >, ConvertCI4_Row_To_8888< 0x4 | 0x3 > },
+	{ ConvertCI8_Row_To_8888< 0x3 >, ConvertCI8_Row_To_8888< 0x4 | 0x3 > },
+	ConvertYUV16_Row,
+};
+
+void SetConvertRowKernels( const SConvertRowKernels * kernels )
+{
+	if( kernels == nullptr )
+	{
+		kernels = gSIMDConvertRowKernels ? gSIMDConvertRowKernels : &gScalarConvertRowKernels;
+	}
+	gConvertRowKernels = kernels;
+}
+
 typedef void ( *ConvertFunction )( const TextureDestInfo & dsti, const TextureInfo & ti);
 static const ConvertFunction gConvertFunctions[ 32 ] =
 {
@@ -669,6 +733,18 @@ bool ConvertTexture(const TextureInfo & ti,
 					NativePf8888 * palette,
 					ETextureFormat texture_format,
 					u32 pitch)
+{
+	const TextureSource	rdram = { g_pu8GfxRamBase, 0, g_pu8GfxRamBase, 0 };
+
+	return ConvertTexture( ti, rdram, texels, palette, texture_format, pitch );
+}
+
+bool ConvertTexture(const TextureInfo & ti,
+					const TextureSource & source,
+					void * texels,
+					NativePf8888 * palette,
+					ETextureFormat texture_format,
+					u32 pitch)
 {
 	//Do nothing if palette address is nullptr or close to nullptr in a palette texture //Corn
 	//Loading a SaveState (OOT -> SSV) dont bring back our TMEM data which causes issues for the first rendered frame.
@@ -678,12 +754,17 @@ bool ConvertTexture(const TextureInfo & ti,
 
 	//memset( texels, 0, buffer_size );
 
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( gConvertRowKernels != nullptr, "SetConvertRowKernels hasn't been called" );
+	#endif
+
 	TextureDestInfo dsti( texture_format );
 	dsti.Data    = texels;
 	dsti.Width   = ti.GetWidth();
 	dsti.Height  = ti.GetHeight();
 	dsti.Pitch   = pitch;
 	dsti.Palette = palette;
+	dsti.Source  = &source;
 
 	const ConvertFunction fn = gConvertFunctions[ (ti.GetFormat() << 2) | ti.GetSize() ];
 	if( fn )
@@ -694,3 +775,51 @@ bool ConvertTexture(const TextureInfo & ti,
 
 	return false;
 }
+
+// Copies [address, address + length) widened to multiples of 8, and zero fills
+// anything past the end of rdram. Returns the (aligned) address the copy starts at
+static u32 SnapshotRamRange( u32 address, u32 length, std::vector<u8> & buffer, u32 buffer_offset )
+{
+	u32 start = address & ~7;
+	u32 end   = (address + length + 7) & ~7;
+	if( end < start ) end = MAX_RAM_ADDRESS;
+
+	buffer.resize( buffer_offset + (end - start) );
+	if( end == start ) return start;
+
+	u32 copy_end = std::min< u32 >( end, MAX_RAM_ADDRESS );
+	u32 copied   = copy_end > start ? copy_end - start : 0;
+	memcpy( &buffer[ buffer_offset ], g_pu8GfxRamBase + start, copied );
+	memset( &buffer[ buffer_offset + copied ], 0, (end - start) - copied );
+
+	return start;
+}
+
+void SnapshotTextureSource( const TextureInfo & ti, std::vector<u8> & buffer, TextureSource * source )
+{
+	// Every converter reads Height rows of Pitch bytes, except the last row may
+	// stop short of or run past its pitch, and YUV reads its blocks back to back.
+	u32 height    = ti.GetHeight();
+	u32 row_bytes = ((ti.GetWidth() << ti.GetSize()) + 1) >> 1;
+	u32 yuv_bytes = height * ((ti.GetWidth() + 1) / 2) * 4;
+	u32 length    = height * ti.GetPitch();
+	if( height > 0 )
+	{
+		length = std::max( length, (height - 1) * ti.GetPitch() + row_bytes );
+	}
+	length = std::max( length, yuv_bytes );
+
+	u32 texels_address = SnapshotRamRange( ti.GetLoadAddress(), length, buffer, 0 );
+	u32 palette_offset = buffer.size();
+	u32 palette_address = 0;
+	if( ti.GetFormat() == G_IM_FMT_CI )
+	{
+		u32 palette_bytes = (ti.GetSize() == G_IM_SIZ_4b) ? 16 * 2 : 256 * 2;
+		palette_address = SnapshotRamRange( ti.GetTlutAddress(), palette_bytes, buffer, palette_offset );
+	}
+
+	source->Texels         = buffer.data();
+	source->TexelsAddress  = texels_address;
+	source->Palette        = buffer.data() + palette_offset;
+	source->PaletteAddress = palette_address;
+}
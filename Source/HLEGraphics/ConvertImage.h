@@ -20,15 +20,76 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef HLEGRAPHICS_CONVERTIMAGE_H_
 #define HLEGRAPHICS_CONVERTIMAGE_H_
 
+#include <vector>
+
 #include "Graphics/TextureFormat.h"
 
 struct TextureInfo;
 struct NativePf8888;
 
+//*****************************************************************************
+//	Where ConvertTexture reads a texture from - copies of rdram starting at
+//	TexelsAddress and PaletteAddress. The addresses must be multiples of 8 so
+//	the byte swapping still lines up.
+//*****************************************************************************
+struct TextureSource
+{
+	const u8 *	Texels;
+	u32			TexelsAddress;
+	const u8 *	Palette;
+	u32			PaletteAddress;
+};
+
+// Reads straight from rdram
 bool ConvertTexture(const TextureInfo & ti,
 					void * texels,
 					NativePf8888 * palette,
 					ETextureFormat texture_format,
 					u32 pitch);
 
+bool ConvertTexture(const TextureInfo & ti,
+					const TextureSource & source,
+					void * texels,
+					NativePf8888 * palette,
+					ETextureFormat texture_format,
+					u32 pitch);
+
+// Copies the texels and palette ti will be converted from into buffer, so the
+// conversion can run on another thread while the emulated cpu carries on
+void SnapshotTextureSource( const TextureInfo & ti, std::vector<u8> & buffer, TextureSource * source );
+
+//*****************************************************************************
+//	Row converters used for 8888 textures. Each format has a pair - [0] for
+//	normal rows and [1] for the odd rows of swapped textures. src_offset is the
+//	offset of the row in src (rdram), so the byte swapping can be undone.
+//
+//	The scalar kernels are the reference. The SSE2/NEON ones fall back to them
+//	for unaligned rows and the last few texels, and must match them exactly.
+//*****************************************************************************
+typedef void (*ConvertRowFunction)( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width );
+typedef void (*ConvertPalettisedRowFunction)( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width, const NativePf8888 * palette );
+typedef void (*ConvertYUVFunction)( u32 * dst, const u32 * src, u32 num_pairs );
+
+struct SConvertRowKernels
+{
+	const char *					Name;
+	ConvertRowFunction				RGBA16[2];
+	ConvertRowFunction				RGBA32[2];
+	ConvertRowFunction				IA4[2];
+	ConvertRowFunction				IA8[2];
+	ConvertRowFunction				IA16[2];
+	ConvertRowFunction				I4[2];
+	ConvertRowFunction				I8[2];
+	ConvertPalettisedRowFunction	CI4[2];
+	ConvertPalettisedRowFunction	CI8[2];
+	ConvertYUVFunction				YUV16;		// Whole texture, two texels per word
+};
+
+extern const SConvertRowKernels			gScalarConvertRowKernels;
+extern const SConvertRowKernels * const	gSIMDConvertRowKernels;		// nullptr if built without SSE2/NEON
+
+// Selects the kernels ConvertTexture uses (nullptr for the default - SIMD where available).
+// ConvertTexture runs on the conversion threads, so call this before starting them
+void SetConvertRowKernels( const SConvertRowKernels * kernels );
+
 #endif // HLEGRAPHICS_CONVERTIMAGE_H_
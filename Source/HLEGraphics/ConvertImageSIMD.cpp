@@ -0,0 +1,684 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	SSE2/NEON versions of the 8888 row converters in ConvertImage.cpp.
+//
+//	Rdram is stored with each word byte swapped, so a 16 byte load gives four
+//	words in n64 order with their bytes reversed. Once that's undone (and the
+//	words of each dword swapped back for the odd rows of swapped textures)
+//	the texels are in order and can be expanded a register at a time.
+//
+//	This needs the row to start on a word boundary (a dword boundary for
+//	swapped rows, where the swap is relative to the address). Anything else,
+//	and the texels left over at the end of a row, go through the scalar code.
+//
+
+#include "stdafx.h"
+
+#include "Graphics/NativePixelFormat.h"
+#include "HLEGraphics/ConvertImage.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define DAEDALUS_CONVERT_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DAEDALUS_CONVERT_NEON
+#endif
+
+#if defined(DAEDALUS_CONVERT_SSE2) || defined(DAEDALUS_CONVERT_NEON)
+
+namespace
+{
+
+template< bool Swapped >
+inline bool CanConvertRow( u32 src_offset )
+{
+	return (src_offset & (Swapped ? 7 : 3)) == 0;
+}
+
+//*****************************************************************************
+//	Palette lookups are gathers, which neither instruction set has, so CI8
+//	(and CI4 on SSE2) read a word at a time and just skip the per texel
+//	address fiddling.
+//*****************************************************************************
+inline void LookupCI8Word( NativePf8888 * dst, u32 w, const NativePf8888 * palette )
+{
+	dst[0] = palette[ w >> 24 ];
+	dst[1] = palette[ (w >> 16) & 0xff ];
+	dst[2] = palette[ (w >> 8) & 0xff ];
+	dst[3] = palette[ w & 0xff ];
+}
+
+template< bool Swapped >
+void ConvertCI8_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width, const NativePf8888 * palette )
+{
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		const u32 * words = reinterpret_cast< const u32 * >( src + src_offset );
+		for( ; x + 8 <= width; x += 8, words += 2 )
+		{
+			LookupCI8Word( dst + x + 0, words[ Swapped ? 1 : 0 ], palette );
+			LookupCI8Word( dst + x + 4, words[ Swapped ? 0 : 1 ], palette );
+		}
+	}
+	gScalarConvertRowKernels.CI8[ Swapped ]( dst + x, src, src_offset + x, width - x, palette );
+}
+
+#if defined(DAEDALUS_CONVERT_SSE2)
+
+//*****************************************************************************
+//	SSE2
+//*****************************************************************************
+inline __m128i Load( const u8 * p )
+{
+	return _mm_loadu_si128( reinterpret_cast< const __m128i * >( p ) );
+}
+
+inline void Store( NativePf8888 * p, __m128i v )
+{
+	_mm_storeu_si128( reinterpret_cast< __m128i * >( p ), v );
+}
+
+inline __m128i SwapHalfwords( __m128i v )
+{
+	v = _mm_shufflelo_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+	return _mm_shufflehi_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+}
+
+inline __m128i SwapBytes( __m128i v )
+{
+	v = SwapHalfwords( v );
+	return _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+}
+
+inline __m128i SwapWords( __m128i v )
+{
+	return _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+}
+
+inline __m128i SwapDwords( __m128i v )
+{
+	return _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+}
+
+// 16 bytes of 8 bit texels, in n64 order
+template< bool Swapped >
+inline __m128i Load8( const u8 * p )
+{
+	__m128i v = SwapBytes( Load( p ) );
+	return Swapped ? SwapWords( v ) : v;
+}
+
+// 8 16 bit texels, in n64 order
+template< bool Swapped >
+inline __m128i Load16( const u8 * p )
+{
+	__m128i v = SwapHalfwords( Load( p ) );
+	return Swapped ? SwapWords( v ) : v;
+}
+
+// Stores 16 texels from their I and A bytes
+inline void StoreIA( NativePf8888 * dst, __m128i i, __m128i a )
+{
+	__m128i ii_lo = _mm_unpacklo_epi8( i, i );
+	__m128i ii_hi = _mm_unpackhi_epi8( i, i );
+	__m128i ia_lo = _mm_unpacklo_epi8( i, a );
+	__m128i ia_hi = _mm_unpackhi_epi8( i, a );
+
+	Store( dst + 0,  _mm_unpacklo_epi16( ii_lo, ia_lo ) );
+	Store( dst + 4,  _mm_unpackhi_epi16( ii_lo, ia_lo ) );
+	Store( dst + 8,  _mm_unpacklo_epi16( ii_hi, ia_hi ) );
+	Store( dst + 12, _mm_unpackhi_epi16( ii_hi, ia_hi ) );
+}
+
+// Stores 8 texels from 16 bit R|G<<8 and B|A<<8 lanes
+inline void StoreRGBA( NativePf8888 * dst, __m128i rg, __m128i ba )
+{
+	Store( dst + 0, _mm_unpacklo_epi16( rg, ba ) );
+	Store( dst + 4, _mm_unpackhi_epi16( rg, ba ) );
+}
+
+template< bool Swapped >
+void ConvertRGBA16_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const __m128i mask_f8 = _mm_set1_epi16( 0xf8 );
+	const __m128i mask_07 = _mm_set1_epi16( 0x07 );
+	const __m128i mask_ff = _mm_set1_epi16( 0xff );
+	const __m128i one     = _mm_set1_epi16( 1 );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 8 <= width; x += 8 )
+		{
+			__m128i c = Load16< Swapped >( src + src_offset + x * 2 );
+
+			__m128i r = _mm_or_si128( _mm_and_si128( _mm_srli_epi16( c, 8 ), mask_f8 ), _mm_srli_epi16( c, 13 ) );
+			__m128i g = _mm_or_si128( _mm_and_si128( _mm_srli_epi16( c, 3 ), mask_f8 ), _mm_and_si128( _mm_srli_epi16( c, 8 ), mask_07 ) );
+			__m128i b = _mm_or_si128( _mm_and_si128( _mm_slli_epi16( c, 2 ), mask_f8 ), _mm_and_si128( _mm_srli_epi16( c, 3 ), mask_07 ) );
+			__m128i a = _mm_and_si128( _mm_sub_epi16( _mm_setzero_si128(), _mm_and_si128( c, one ) ), mask_ff );
+
+			StoreRGBA( dst + x, _mm_or_si128( r, _mm_slli_epi16( g, 8 ) ), _mm_or_si128( b, _mm_slli_epi16( a, 8 ) ) );
+		}
+	}
+	gScalarConvertRowKernels.RGBA16[ Swapped ]( dst + x, src, src_offset + x * 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertRGBA32_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 4 <= width; x += 4 )
+		{
+			__m128i c = SwapBytes( Load( src + src_offset + x * 4 ) );
+			Store( dst + x, Swapped ? SwapDwords( c ) : c );
+		}
+	}
+	gScalarConvertRowKernels.RGBA32[ Swapped ]( dst + x, src, src_offset + x * 4, width - x );
+}
+
+template< bool Swapped >
+void ConvertIA4_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const __m128i mask_0f = _mm_set1_epi8( 0x0f );
+	const __m128i mask_07 = _mm_set1_epi8( 0x07 );
+	const __m128i mask_03 = _mm_set1_epi8( 0x03 );
+	const __m128i one     = _mm_set1_epi8( 1 );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 32 <= width; x += 32 )
+		{
+			__m128i b  = Load8< Swapped >( src + src_offset + x / 2 );
+			__m128i hi = _mm_and_si128( _mm_srli_epi16( b, 4 ), mask_0f );
+			__m128i lo = _mm_and_si128( b, mask_0f );
+
+			for( u32 half = 0; half < 2; ++half )
+			{
+				__m128i n = half ? _mm_unpackhi_epi8( hi, lo ) : _mm_unpacklo_epi8( hi, lo );
+
+				// ThreeToEight[v] is v<<5 | v<<2 | v>>1
+				__m128i v = _mm_and_si128( _mm_srli_epi16( n, 1 ), mask_07 );
+				__m128i i = _mm_or_si128( _mm_or_si128( _mm_slli_epi16( v, 5 ), _mm_slli_epi16( v, 2 ) ),
+										  _mm_and_si128( _mm_srli_epi16( v, 1 ), mask_03 ) );
+				__m128i a = _mm_cmpeq_epi8( _mm_and_si128( n, one ), one );
+
+				StoreIA( dst + x + half * 16, i, a );
+			}
+		}
+	}
+	gScalarConvertRowKernels.IA4[ Swapped ]( dst + x, src, src_offset + x / 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertIA8_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const __m128i mask_f0 = _mm_set1_epi8( s8( 0xf0 ) );
+	const __m128i mask_0f = _mm_set1_epi8( 0x0f );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 16 <= width; x += 16 )
+		{
+			__m128i b  = Load8< Swapped >( src + src_offset + x );
+			__m128i hi = _mm_and_si128( b, mask_f0 );
+			__m128i lo = _mm_and_si128( b, mask_0f );
+
+			StoreIA( dst + x, _mm_or_si128( hi, _mm_srli_epi16( hi, 4 ) ), _mm_or_si128( lo, _mm_slli_epi16( lo, 4 ) ) );
+		}
+	}
+	gScalarConvertRowKernels.IA8[ Swapped ]( dst + x, src, src_offset + x, width - x );
+}
+
+template< bool Swapped >
+void ConvertIA16_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const __m128i mask_ff00 = _mm_set1_epi16( s16( 0xff00 ) );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 8 <= width; x += 8 )
+		{
+			__m128i c = Load16< Swapped >( src + src_offset + x * 2 );
+			__m128i i = _mm_srli_epi16( c, 8 );
+
+			StoreRGBA( dst + x, _mm_or_si128( i, _mm_and_si128( c, mask_ff00 ) ), _mm_or_si128( i, _mm_slli_epi16( c, 8 ) ) );
+		}
+	}
+	gScalarConvertRowKernels.IA16[ Swapped ]( dst + x, src, src_offset + x * 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertI4_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const __m128i mask_f0 = _mm_set1_epi8( s8( 0xf0 ) );
+	const __m128i mask_0f = _mm_set1_epi8( 0x0f );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 32 <= width; x += 32 )
+		{
+			__m128i b  = Load8< Swapped >( src + src_offset + x / 2 );
+			__m128i hi = _mm_and_si128( b, mask_f0 );
+			__m128i lo = _mm_and_si128( b, mask_0f );
+			__m128i ev = _mm_or_si128( hi, _mm_srli_epi16( hi, 4 ) );
+			__m128i od = _mm_or_si128( lo, _mm_slli_epi16( lo, 4 ) );
+
+			__m128i i_lo = _mm_unpacklo_epi8( ev, od );
+			__m128i i_hi = _mm_unpackhi_epi8( ev, od );
+			StoreIA( dst + x,      i_lo, i_lo );
+			StoreIA( dst + x + 16, i_hi, i_hi );
+		}
+	}
+	gScalarConvertRowKernels.I4[ Swapped ]( dst + x, src, src_offset + x / 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertI8_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 16 <= width; x += 16 )
+		{
+			__m128i i = Load8< Swapped >( src + src_offset + x );
+			StoreIA( dst + x, i, i );
+		}
+	}
+	gScalarConvertRowKernels.I8[ Swapped ]( dst + x, src, src_offset + x, width - x );
+}
+
+inline void LookupCI4Word( NativePf8888 * dst, u32 w, const NativePf8888 * palette )
+{
+	dst[0] = palette[ w >> 28 ];
+	dst[1] = palette[ (w >> 24) & 0xf ];
+	dst[2] = palette[ (w >> 20) & 0xf ];
+	dst[3] = palette[ (w >> 16) & 0xf ];
+	dst[4] = palette[ (w >> 12) & 0xf ];
+	dst[5] = palette[ (w >> 8) & 0xf ];
+	dst[6] = palette[ (w >> 4) & 0xf ];
+	dst[7] = palette[ w & 0xf ];
+}
+
+template< bool Swapped >
+void ConvertCI4_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width, const NativePf8888 * palette )
+{
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		const u32 * words = reinterpret_cast< const u32 * >( src + src_offset );
+		for( ; x + 16 <= width; x += 16, words += 2 )
+		{
+			LookupCI4Word( dst + x + 0, words[ Swapped ? 1 : 0 ], palette );
+			LookupCI4Word( dst + x + 8, words[ Swapped ? 0 : 1 ], palette );
+		}
+	}
+	gScalarConvertRowKernels.CI4[ Swapped ]( dst + x, src, src_offset + x / 2, width - x, palette );
+}
+
+// Same sums as YUV16(), in the same order, so the rounding matches
+void ConvertYUV16_Row( u32 * dst, const u32 * src, u32 num_pairs )
+{
+	const __m128i mask_ff = _mm_set1_epi32( 0xff );
+	const __m128i bias    = _mm_set1_epi32( 128 );
+	const __m128i alpha   = _mm_set1_epi16( 0xff );
+	const __m128 kRV = _mm_set1_ps( 1.370705f );
+	const __m128 kGV = _mm_set1_ps( 0.698001f );
+	const __m128 kGU = _mm_set1_ps( 0.337633f );
+	const __m128 kBU = _mm_set1_ps( 1.732446f );
+
+	u32 i = 0;
+	for( ; i + 4 <= num_pairs; i += 4 )
+	{
+		__m128i t = _mm_loadu_si128( reinterpret_cast< const __m128i * >( src + i ) );
+
+		__m128 y1 = _mm_cvtepi32_ps( _mm_and_si128( t, mask_ff ) );
+		__m128 v  = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( t, 8 ), mask_ff ), bias ) );
+		__m128 y0 = _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( t, 16 ), mask_ff ) );
+		__m128 u  = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( t, 24 ), bias ) );
+
+		__m128 rv = _mm_mul_ps( kRV, v );
+		__m128 gv = _mm_mul_ps( kGV, v );
+		__m128 gu = _mm_mul_ps( kGU, u );
+		__m128 bu = _mm_mul_ps( kBU, u );
+
+		// Saturating packs do the clamping, and putting y0/y1 lanes side by side gives pixel order
+		__m128i r = _mm_packs_epi32( _mm_cvttps_epi32( _mm_add_ps( y0, rv ) ), _mm_cvttps_epi32( _mm_add_ps( y1, rv ) ) );
+		__m128i g = _mm_packs_epi32( _mm_cvttps_epi32( _mm_sub_ps( _mm_sub_ps( y0, gv ), gu ) ), _mm_cvttps_epi32( _mm_sub_ps( _mm_sub_ps( y1, gv ), gu ) ) );
+		__m128i b = _mm_packs_epi32( _mm_cvttps_epi32( _mm_add_ps( y0, bu ) ), _mm_cvttps_epi32( _mm_add_ps( y1, bu ) ) );
+
+		r = _mm_unpacklo_epi16( r, _mm_srli_si128( r, 8 ) );
+		g = _mm_unpacklo_epi16( g, _mm_srli_si128( g, 8 ) );
+		b = _mm_unpacklo_epi16( b, _mm_srli_si128( b, 8 ) );
+
+		__m128i rg8 = _mm_packus_epi16( r, g );
+		__m128i ba8 = _mm_packus_epi16( b, alpha );
+		__m128i rg  = _mm_unpacklo_epi8( rg8, _mm_srli_si128( rg8, 8 ) );
+		__m128i ba  = _mm_unpacklo_epi8( ba8, _mm_srli_si128( ba8, 8 ) );
+
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i * 2 + 0 ), _mm_unpacklo_epi16( rg, ba ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i * 2 + 4 ), _mm_unpackhi_epi16( rg, ba ) );
+	}
+	gScalarConvertRowKernels.YUV16( dst + i * 2, src + i, num_pairs - i );
+}
+
+#elif defined(DAEDALUS_CONVERT_NEON)
+
+//*****************************************************************************
+//	NEON
+//*****************************************************************************
+
+// 16 bytes of 8 bit texels, in n64 order
+template< bool Swapped >
+inline uint8x16_t Load8( const u8 * p )
+{
+	uint8x16_t v = vrev32q_u8( vld1q_u8( p ) );
+	return Swapped ? vreinterpretq_u8_u32( vrev64q_u32( vreinterpretq_u32_u8( v ) ) ) : v;
+}
+
+// 8 16 bit texels, in n64 order
+template< bool Swapped >
+inline uint16x8_t Load16( const u8 * p )
+{
+	uint16x8_t v = vrev32q_u16( vreinterpretq_u16_u8( vld1q_u8( p ) ) );
+	return Swapped ? vreinterpretq_u16_u32( vrev64q_u32( vreinterpretq_u32_u16( v ) ) ) : v;
+}
+
+inline void StoreIA( NativePf8888 * dst, uint8x16_t i, uint8x16_t a )
+{
+	uint8x16x4_t rgba;
+	rgba.val[0] = i;
+	rgba.val[1] = i;
+	rgba.val[2] = i;
+	rgba.val[3] = a;
+	vst4q_u8( reinterpret_cast< u8 * >( dst ), rgba );
+}
+
+inline void StoreRGBA( NativePf8888 * dst, uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a )
+{
+	uint8x8x4_t rgba;
+	rgba.val[0] = r;
+	rgba.val[1] = g;
+	rgba.val[2] = b;
+	rgba.val[3] = a;
+	vst4_u8( reinterpret_cast< u8 * >( dst ), rgba );
+}
+
+template< bool Swapped >
+void ConvertRGBA16_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const uint16x8_t mask_f8 = vdupq_n_u16( 0xf8 );
+	const uint16x8_t mask_07 = vdupq_n_u16( 0x07 );
+	const uint16x8_t one     = vdupq_n_u16( 1 );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 8 <= width; x += 8 )
+		{
+			uint16x8_t c = Load16< Swapped >( src + src_offset + x * 2 );
+
+			uint16x8_t r = vorrq_u16( vandq_u16( vshrq_n_u16( c, 8 ), mask_f8 ), vshrq_n_u16( c, 13 ) );
+			uint16x8_t g = vorrq_u16( vandq_u16( vshrq_n_u16( c, 3 ), mask_f8 ), vandq_u16( vshrq_n_u16( c, 8 ), mask_07 ) );
+			uint16x8_t b = vorrq_u16( vandq_u16( vshlq_n_u16( c, 2 ), mask_f8 ), vandq_u16( vshrq_n_u16( c, 3 ), mask_07 ) );
+			uint16x8_t a = vtstq_u16( c, one );
+
+			StoreRGBA( dst + x, vmovn_u16( r ), vmovn_u16( g ), vmovn_u16( b ), vmovn_u16( a ) );
+		}
+	}
+	gScalarConvertRowKernels.RGBA16[ Swapped ]( dst + x, src, src_offset + x * 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertRGBA32_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 4 <= width; x += 4 )
+		{
+			uint8x16_t c = vrev32q_u8( vld1q_u8( src + src_offset + x * 4 ) );
+			vst1q_u8( reinterpret_cast< u8 * >( dst + x ), Swapped ? vextq_u8( c, c, 8 ) : c );
+		}
+	}
+	gScalarConvertRowKernels.RGBA32[ Swapped ]( dst + x, src, src_offset + x * 4, width - x );
+}
+
+template< bool Swapped >
+void ConvertIA4_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const uint8x16_t mask_0f = vdupq_n_u8( 0x0f );
+	const uint8x16_t one     = vdupq_n_u8( 1 );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 32 <= width; x += 32 )
+		{
+			uint8x16_t		b = Load8< Swapped >( src + src_offset + x / 2 );
+			uint8x16x2_t	n = vzipq_u8( vshrq_n_u8( b, 4 ), vandq_u8( b, mask_0f ) );
+
+			for( u32 half = 0; half < 2; ++half )
+			{
+				// ThreeToEight[v] is v<<5 | v<<2 | v>>1
+				uint8x16_t v = vshrq_n_u8( n.val[ half ], 1 );
+				uint8x16_t i = vorrq_u8( vorrq_u8( vshlq_n_u8( v, 5 ), vshlq_n_u8( v, 2 ) ), vshrq_n_u8( v, 1 ) );
+
+				StoreIA( dst + x + half * 16, i, vtstq_u8( n.val[ half ], one ) );
+			}
+		}
+	}
+	gScalarConvertRowKernels.IA4[ Swapped ]( dst + x, src, src_offset + x / 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertIA8_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const uint8x16_t mask_f0 = vdupq_n_u8( 0xf0 );
+	const uint8x16_t mask_0f = vdupq_n_u8( 0x0f );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 16 <= width; x += 16 )
+		{
+			uint8x16_t b = Load8< Swapped >( src + src_offset + x );
+
+			StoreIA( dst + x, vorrq_u8( vandq_u8( b, mask_f0 ), vshrq_n_u8( b, 4 ) ),
+							  vorrq_u8( vshlq_n_u8( b, 4 ), vandq_u8( b, mask_0f ) ) );
+		}
+	}
+	gScalarConvertRowKernels.IA8[ Swapped ]( dst + x, src, src_offset + x, width - x );
+}
+
+template< bool Swapped >
+void ConvertIA16_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 8 <= width; x += 8 )
+		{
+			uint16x8_t c = Load16< Swapped >( src + src_offset + x * 2 );
+			uint8x8_t  i = vshrn_n_u16( c, 8 );
+
+			StoreRGBA( dst + x, i, i, i, vmovn_u16( c ) );
+		}
+	}
+	gScalarConvertRowKernels.IA16[ Swapped ]( dst + x, src, src_offset + x * 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertI4_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	const uint8x16_t mask_f0 = vdupq_n_u8( 0xf0 );
+	const uint8x16_t mask_0f = vdupq_n_u8( 0x0f );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 32 <= width; x += 32 )
+		{
+			uint8x16_t		b  = Load8< Swapped >( src + src_offset + x / 2 );
+			uint8x16_t		ev = vorrq_u8( vandq_u8( b, mask_f0 ), vshrq_n_u8( b, 4 ) );
+			uint8x16_t		od = vorrq_u8( vshlq_n_u8( b, 4 ), vandq_u8( b, mask_0f ) );
+			uint8x16x2_t	i  = vzipq_u8( ev, od );
+
+			StoreIA( dst + x,      i.val[0], i.val[0] );
+			StoreIA( dst + x + 16, i.val[1], i.val[1] );
+		}
+	}
+	gScalarConvertRowKernels.I4[ Swapped ]( dst + x, src, src_offset + x / 2, width - x );
+}
+
+template< bool Swapped >
+void ConvertI8_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width )
+{
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) )
+	{
+		for( ; x + 16 <= width; x += 16 )
+		{
+			uint8x16_t i = Load8< Swapped >( src + src_offset + x );
+			StoreIA( dst + x, i, i );
+		}
+	}
+	gScalarConvertRowKernels.I8[ Swapped ]( dst + x, src, src_offset + x, width - x );
+}
+
+// 16 entry table lookup on each byte
+inline uint8x16_t Lookup16( uint8x16_t table, uint8x16_t idx )
+{
+#if defined(__aarch64__)
+	return vqtbl1q_u8( table, idx );
+#else
+	uint8x8x2_t t;
+	t.val[0] = vget_low_u8( table );
+	t.val[1] = vget_high_u8( table );
+	return vcombine_u8( vtbl2_u8( t, vget_low_u8( idx ) ), vtbl2_u8( t, vget_high_u8( idx ) ) );
+#endif
+}
+
+template< bool Swapped >
+void ConvertCI4_Row( NativePf8888 * dst, const u8 * src, u32 src_offset, u32 width, const NativePf8888 * palette )
+{
+	const uint8x16_t mask_0f = vdupq_n_u8( 0x0f );
+
+	u32 x = 0;
+	if( CanConvertRow< Swapped >( src_offset ) && x + 32 <= width )
+	{
+		// The 16 entry palette fits in a register per channel
+		uint8x16x4_t pal = vld4q_u8( reinterpret_cast< const u8 * >( palette ) );
+
+		for( ; x + 32 <= width; x += 32 )
+		{
+			uint8x16_t		b = Load8< Swapped >( src + src_offset + x / 2 );
+			uint8x16x2_t	n = vzipq_u8( vshrq_n_u8( b, 4 ), vandq_u8( b, mask_0f ) );
+
+			for( u32 half = 0; half < 2; ++half )
+			{
+				uint8x16x4_t rgba;
+				rgba.val[0] = Lookup16( pal.val[0], n.val[ half ] );
+				rgba.val[1] = Lookup16( pal.val[1], n.val[ half ] );
+				rgba.val[2] = Lookup16( pal.val[2], n.val[ half ] );
+				rgba.val[3] = Lookup16( pal.val[3], n.val[ half ] );
+				vst4q_u8( reinterpret_cast< u8 * >( dst + x + half * 16 ), rgba );
+			}
+		}
+	}
+	gScalarConvertRowKernels.CI4[ Swapped ]( dst + x, src, src_offset + x / 2, width - x, palette );
+}
+
+// Same sums as YUV16(), in the same order, so the rounding matches
+void ConvertYUV16_Row( u32 * dst, const u32 * src, u32 num_pairs )
+{
+	const uint32x4_t mask_ff = vdupq_n_u32( 0xff );
+	const int32x4_t  bias    = vdupq_n_s32( 128 );
+
+	u32 i = 0;
+	for( ; i + 4 <= num_pairs; i += 4 )
+	{
+		uint32x4_t t = vld1q_u32( src + i );
+
+		float32x4_t y1 = vcvtq_f32_s32( vreinterpretq_s32_u32( vandq_u32( t, mask_ff ) ) );
+		float32x4_t v  = vcvtq_f32_s32( vsubq_s32( vreinterpretq_s32_u32( vandq_u32( vshrq_n_u32( t, 8 ), mask_ff ) ), bias ) );
+		float32x4_t y0 = vcvtq_f32_s32( vreinterpretq_s32_u32( vandq_u32( vshrq_n_u32( t, 16 ), mask_ff ) ) );
+		float32x4_t u  = vcvtq_f32_s32( vsubq_s32( vreinterpretq_s32_u32( vshrq_n_u32( t, 24 ) ), bias ) );
+
+		float32x4_t rv = vmulq_n_f32( v, 1.370705f );
+		float32x4_t gv = vmulq_n_f32( v, 0.698001f );
+		float32x4_t gu = vmulq_n_f32( u, 0.337633f );
+		float32x4_t bu = vmulq_n_f32( u, 1.732446f );
+
+		uint16x4x2_t r = vzip_u16( vqmovun_s32( vcvtq_s32_f32( vaddq_f32( y0, rv ) ) ),
+								   vqmovun_s32( vcvtq_s32_f32( vaddq_f32( y1, rv ) ) ) );
+		uint16x4x2_t g = vzip_u16( vqmovun_s32( vcvtq_s32_f32( vsubq_f32( vsubq_f32( y0, gv ), gu ) ) ),
+								   vqmovun_s32( vcvtq_s32_f32( vsubq_f32( vsubq_f32( y1, gv ), gu ) ) ) );
+		uint16x4x2_t b = vzip_u16( vqmovun_s32( vcvtq_s32_f32( vaddq_f32( y0, bu ) ) ),
+								   vqmovun_s32( vcvtq_s32_f32( vaddq_f32( y1, bu ) ) ) );
+
+		uint8x8x4_t rgba;
+		rgba.val[0] = vqmovn_u16( vcombine_u16( r.val[0], r.val[1] ) );
+		rgba.val[1] = vqmovn_u16( vcombine_u16( g.val[0], g.val[1] ) );
+		rgba.val[2] = vqmovn_u16( vcombine_u16( b.val[0], b.val[1] ) );
+		rgba.val[3] = vdup_n_u8( 0xff );
+		vst4_u8( reinterpret_cast< u8 * >( dst + i * 2 ), rgba );
+	}
+	gScalarConvertRowKernels.YUV16( dst + i * 2, src + i, num_pairs - i );
+}
+
+#endif
+
+const SConvertRowKernels gSIMDKernels =
+{
+#if defined(DAEDALUS_CONVERT_SSE2)
+	"sse2",
+#else
+	"neon",
+#endif
+	{ ConvertRGBA16_Row< false >,	ConvertRGBA16_Row< true > },
+	{ ConvertRGBA32_Row< false >,	ConvertRGBA32_Row< true > },
+	{ ConvertIA4_Row< false >,		ConvertIA4_Row< true > },
+	{ ConvertIA8_Row< false >,		ConvertIA8_Row< true > },
+	{ ConvertIA16_Row< false >,		ConvertIA16_Row< true > },
+	{ ConvertI4_Row< false >,		ConvertI4_Row< true > },
+	{ ConvertI8_Row< false >,		ConvertI8_Row< true > },
+	{ ConvertCI4_Row< false >,		ConvertCI4_Row< true > },
+	{ ConvertCI8_Row< false >,		ConvertCI8_Row< true > },
+	ConvertYUV16_Row,
+};
+
+} // anonymous namespace
+
+const SConvertRowKernels * const gSIMDConvertRowKernels = &gSIMDKernels;
+
+#else
+
+const SConvertRowKernels * const gSIMDConvertRowKernels = nullptr;
+
+#endif
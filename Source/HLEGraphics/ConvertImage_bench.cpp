@@ -0,0 +1,235 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Checks the SSE2/NEON texel row converters against the scalar ones, bit for
+//	bit - every width up to a few blocks, from every source alignment, for both
+//	normal and swapped rows, including what gets written past the end of the
+//	row. YUV16 is also checked the way ConvertYUV16 calls it, as one run of
+//	height * ((width + 1) / 2) pairs, for odd widths. Then times both over rows
+//	of 64 texels and reports MB/s of 8888 output.
+//
+
+#include "stdafx.h"
+#include "Graphics/NativePixelFormat.h"
+#include "HLEGraphics/ConvertImage.h"
+#include "Utility/Timing.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const u32	kSourceSize = 64 * 1024;
+	const u32	kMaxWidth = 160;
+	const u32	kGuard = 64;			// Converters can write past the row, up to a swizzle block
+	const u32	kBenchWidth = 64;
+	const u32	kBenchTexels = 64 * 1024 * 1024;
+
+	enum EFormat
+	{
+		RGBA16, RGBA32, IA4, IA8, IA16, I4, I8, CI4, CI8, YUV16, NUM_FORMATS
+	};
+
+	const char * const	gFormatNames[ NUM_FORMATS ] = { "RGBA16", "RGBA32", "IA4", "IA8", "IA16", "I4", "I8", "CI4", "CI8", "YUV16" };
+	const u32			gBitsPerTexel[ NUM_FORMATS ] = { 16, 32, 4, 8, 16, 4, 8, 4, 8, 16 };
+
+	std::vector< u8 >			gSource;
+	std::vector< NativePf8888 >	gPalette;
+
+	// Fills the output first, so anything written past the end shows up
+	void	FillGuard( std::vector< NativePf8888 > & texels )
+	{
+		NativePf8888	guard;
+		guard.Bits = 0xcdcdcdcd;
+		std::fill( texels.begin(), texels.end(), guard );
+	}
+
+	ConvertRowFunction	GetRowFunction( const SConvertRowKernels & k, EFormat format, u32 swapped )
+	{
+		switch( format )
+		{
+		case RGBA16:	return k.RGBA16[ swapped ];
+		case RGBA32:	return k.RGBA32[ swapped ];
+		case IA4:		return k.IA4[ swapped ];
+		case IA8:		return k.IA8[ swapped ];
+		case IA16:		return k.IA16[ swapped ];
+		case I4:		return k.I4[ swapped ];
+		case I8:		return k.I8[ swapped ];
+		default:		return nullptr;
+		}
+	}
+
+	// Converts a row (or for YUV, width/2 pairs) with the given kernels
+	void	Convert( const SConvertRowKernels & k, EFormat format, u32 swapped, NativePf8888 * dst, u32 src_offset, u32 width )
+	{
+		switch( format )
+		{
+		case CI4:	k.CI4[ swapped ]( dst, &gSource[0], src_offset, width, &gPalette[0] ); break;
+		case CI8:	k.CI8[ swapped ]( dst, &gSource[0], src_offset, width, &gPalette[0] ); break;
+		case YUV16:	k.YUV16( reinterpret_cast< u32 * >( dst ), reinterpret_cast< const u32 * >( &gSource[ src_offset & ~3 ] ), width / 2 ); break;
+		default:	GetRowFunction( k, format, swapped )( dst, &gSource[0], src_offset, width ); break;
+		}
+	}
+
+	u32		Check( const SConvertRowKernels & simd, EFormat format )
+	{
+		std::vector< NativePf8888 >	expected( kMaxWidth + kGuard );
+		std::vector< NativePf8888 >	actual( kMaxWidth + kGuard );
+		u32							failures( 0 );
+
+		for( u32 swapped = 0; swapped < (format == YUV16 ? 1u : 2u); ++swapped )
+		{
+			for( u32 offset = 0; offset < 16; ++offset )
+			{
+				// Texels are always aligned to their own size
+				if( gBitsPerTexel[ format ] >= 16 && (offset % (gBitsPerTexel[ format ] / 8)) != 0 )
+					continue;
+
+				for( u32 width = 0; width <= kMaxWidth; ++width )
+				{
+					FillGuard( expected );
+					FillGuard( actual );
+
+					Convert( gScalarConvertRowKernels, format, swapped, &expected[0], offset, width );
+					Convert( simd, format, swapped, &actual[0], offset, width );
+
+					if( memcmp( &expected[0], &actual[0], expected.size() * sizeof( NativePf8888 ) ) != 0 )
+					{
+						if( failures++ < 4 )
+						{
+							printf( "  %s mismatch: %s row, offset %u, width %u\n", gFormatNames[ format ], swapped ? "swapped" : "normal", offset, width );
+						}
+					}
+				}
+			}
+		}
+
+		return failures;
+	}
+
+	// As ConvertGenericYUVBlocks converts a whole texture: an odd width still has its last pair converted
+	u32		CheckYUVBlocks( const SConvertRowKernels & simd )
+	{
+		const u32	kMaxHeight = 16;
+		u32			failures( 0 );
+
+		for( u32 width = 1; width < kMaxWidth; width += 2 )
+		{
+			for( u32 height = 1; height <= kMaxHeight; ++height )
+			{
+				const u32	num_pairs( height * ((width + 1) / 2) );
+
+				std::vector< NativePf8888 >	expected( num_pairs * 2 + kGuard );
+				std::vector< NativePf8888 >	actual( num_pairs * 2 + kGuard );
+				FillGuard( expected );
+				FillGuard( actual );
+
+				const u32 *	src( reinterpret_cast< const u32 * >( &gSource[0] ) );
+				gScalarConvertRowKernels.YUV16( reinterpret_cast< u32 * >( &expected[0] ), src, num_pairs );
+				simd.YUV16( reinterpret_cast< u32 * >( &actual[0] ), src, num_pairs );
+
+				if( memcmp( &expected[0], &actual[0], expected.size() * sizeof( NativePf8888 ) ) != 0 )
+				{
+					if( failures++ < 4 )
+					{
+						printf( "  YUV16 block mismatch: %ux%u texels\n", width, height );
+					}
+				}
+			}
+		}
+
+		return failures;
+	}
+
+	// Returns MB/s of 8888 texels written
+	f64		Time( const SConvertRowKernels & k, EFormat format )
+	{
+		const u32	row_bytes( kBenchWidth * gBitsPerTexel[ format ] / 8 );
+		const u32	num_rows( kSourceSize / row_bytes );
+
+		std::vector< NativePf8888 >	dst( kBenchWidth + kGuard );
+
+		u64		freq( 0 ), start( 0 ), end( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+		NTiming::GetPreciseTime( &start );
+
+		u32		texels( 0 );
+		for( u32 row = 0; texels < kBenchTexels; row = (row + 1) % num_rows )
+		{
+			// Alternate rows are swapped, like most textures
+			Convert( k, format, row & 1, &dst[0], row * row_bytes, kBenchWidth );
+			texels += kBenchWidth;
+		}
+
+		NTiming::GetPreciseTime( &end );
+
+		f64		seconds( f64( end - start ) / f64( freq ) );
+		return seconds > 0.0 ? f64( texels ) * sizeof( NativePf8888 ) / seconds / (1024.0 * 1024.0) : 0.0;
+	}
+}
+
+int main()
+{
+	u32		state( 0x2468ace1 );
+	gSource.resize( kSourceSize + kGuard );
+	for( u32 i = 0; i < gSource.size(); ++i )
+	{
+		state = state * 1664525 + 1013904223;
+		gSource[ i ] = u8( state >> 24 );
+	}
+
+	gPalette.resize( 256 );
+	for( u32 i = 0; i < gPalette.size(); ++i )
+	{
+		state = state * 1664525 + 1013904223;
+		gPalette[ i ].Bits = state;
+	}
+
+	const SConvertRowKernels *	simd( gSIMDConvertRowKernels );
+	u32							failures( 0 );
+
+	if( simd == nullptr )
+	{
+		printf( "No SIMD kernels in this build, timing the scalar ones only\n\n" );
+	}
+	else
+	{
+		for( u32 f = 0; f < NUM_FORMATS; ++f )
+		{
+			failures += Check( *simd, EFormat( f ) );
+		}
+		failures += CheckYUVBlocks( *simd );
+		printf( "%s kernels: %s\n\n", simd->Name, failures == 0 ? "match scalar" : "MISMATCH" );
+	}
+
+	printf( "%-8s %14s %14s %9s\n", "format", "scalar MB/s", simd ? simd->Name : "-", "speedup" );
+	for( u32 f = 0; f < NUM_FORMATS; ++f )
+	{
+		f64		scalar_mbs( Time( gScalarConvertRowKernels, EFormat( f ) ) );
+		f64		simd_mbs( simd ? Time( *simd, EFormat( f ) ) : 0.0 );
+
+		printf( "%-8s %14.1f %14.1f %8.2fx\n", gFormatNames[ f ], scalar_mbs, simd_mbs, simd_mbs > 0.0 ? simd_mbs / scalar_mbs : 0.0 );
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "HLEGraphics/DLCapture.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "Core/Memory.h"
+#include "Core/ROM.h"
+#include "Debug/DBGConsole.h"
+#include "HLEGraphics/DLParser.h"
+#include "Utility/ZlibWrapper.h"
+
+extern u32 gRDPFrame;
+
+namespace
+{
+	const u32		kCaptureMagic = 0x50434c44;		// "DLCP"
+	const u32		kCaptureVersion = 1;
+
+	struct DLCaptureHeader
+	{
+		u32		Magic;
+		u32		Version;
+		u32		RamSize;
+		u32		VIRegistersSize;
+		u32		ParserStateSize;
+		u32		UcodeVersion;
+		u32		GameHacks;
+		char	GameName[ 64 ];
+	};
+
+	u32				gCaptureTask = 0;
+	std::string		gCaptureFilename;
+}
+
+void DLCapture_Request( u32 task_number, const char * filename )
+{
+	gCaptureTask = task_number;
+	gCaptureFilename = filename;
+}
+
+bool DLCapture_IsRequested()
+{
+	// gRDPFrame counts the task once the ucode is known
+	return gCaptureTask != 0 && gRDPFrame + 1 == gCaptureTask;
+}
+
+void DLCapture_Capture( const OSTask & task )
+{
+	gCaptureTask = 0;
+
+	DLCaptureHeader		header;
+	memset( &header, 0, sizeof( header ) );
+	header.Magic = kCaptureMagic;
+	header.Version = kCaptureVersion;
+	header.RamSize = gRamSize;
+	header.VIRegistersSize = MemoryRegionSizes[ MEM_VI_REG ];
+	header.ParserStateSize = DLParser_GetStateSize();
+	header.UcodeVersion = DLParser_GetUcodeVersion();
+	header.GameHacks = g_ROM.GameHacks;
+	const char *	game_name( g_ROM.settings.GameName.c_str() );
+	const u32		name_length( std::min< u32 >( strlen( game_name ), sizeof( header.GameName ) - 1 ) );
+	memcpy( header.GameName, game_name, name_length );
+	header.GameName[ name_length ] = '\0';
+
+	std::vector< u8 >	parser_state( header.ParserStateSize );
+	DLParser_SaveState( parser_state.data() );
+
+	COutStream		stream( gCaptureFilename.c_str() );
+	bool			ok( stream.IsOpen() &&
+						stream.WriteData( &header, sizeof( header ) ) &&
+						stream.WriteData( &task, sizeof( task ) ) &&
+						stream.WriteData( g_pu8RamBase, header.RamSize ) &&
+						stream.WriteData( g_pMemoryBuffers[ MEM_VI_REG ], header.VIRegistersSize ) &&
+						stream.WriteData( parser_state.data(), header.ParserStateSize ) );
+
+	#ifdef DAEDALUS_DEBUG_CONSOLE
+	DBGConsole_Msg( 0, "%s display list %u to %s", ok ? "Captured" : "Couldn't capture", gRDPFrame + 1, gCaptureFilename.c_str() );
+	#endif
+	(void)ok;
+}
+
+CDLCapture::CDLCapture()
+:	mUcodeVersion( 0 )
+,	mGameHacks( 0 )
+{
+	memset( &mTask, 0, sizeof( mTask ) );
+	memset( mGameName, 0, sizeof( mGameName ) );
+}
+
+bool CDLCapture::Load( const char * filename )
+{
+	CInStream		stream( filename );
+	if( !stream.IsOpen() )
+		return false;
+
+	DLCaptureHeader		header;
+	if( !stream.ReadData( &header, sizeof( header ) ) ||
+		header.Magic != kCaptureMagic ||
+		header.Version != kCaptureVersion ||
+		header.RamSize > MemoryRegionSizes[ MEM_RD_RAM ] ||
+		header.VIRegistersSize != MemoryRegionSizes[ MEM_VI_REG ] ||
+		header.ParserStateSize != DLParser_GetStateSize() )
+	{
+		return false;
+	}
+
+	mUcodeVersion = header.UcodeVersion;
+	mGameHacks = header.GameHacks;
+	memcpy( mGameName, header.GameName, sizeof( mGameName ) );
+	mGameName[ sizeof( mGameName ) - 1 ] = '\0';
+
+	mRam.resize( header.RamSize );
+	mVIRegisters.resize( header.VIRegistersSize );
+	mParserState.resize( header.ParserStateSize );
+
+	return stream.ReadData( &mTask, sizeof( mTask ) ) &&
+		   stream.ReadData( mRam.data(), mRam.size() ) &&
+		   stream.ReadData( mVIRegisters.data(), mVIRegisters.size() ) &&
+		   stream.ReadData( mParserState.data(), mParserState.size() );
+}
+
+void CDLCapture::Restore() const
+{
+	memcpy( g_pu8RamBase, mRam.data(), mRam.size() );
+	memcpy( g_pMemoryBuffers[ MEM_VI_REG ], mVIRegisters.data(), mVIRegisters.size() );
+	memcpy( g_pu8SpMemBase + 0x0FC0, &mTask, sizeof( mTask ) );
+	DLParser_LoadState( mParserState.data() );
+
+	gRamSize = mRam.size();
+	g_ROM.GameHacks = mGameHacks;
+}
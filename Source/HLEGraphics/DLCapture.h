@@ -0,0 +1,76 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef HLEGRAPHICS_DLCAPTURE_H_
+#define HLEGRAPHICS_DLCAPTURE_H_
+
+#include <vector>
+
+#include "OSHLE/ultra_sptask.h"
+#include "Utility/DaedalusTypes.h"
+
+//
+//	Writes a graphics task to a file, with everything DLParser_Process needs
+//	to run it again outside the game: the OSTask, RDRAM, the VI registers,
+//	the parser state carried over from earlier tasks (segments, TLUT addresses
+//	in TMEM and so on) and the ucode it detected. The whole of RDRAM is saved
+//	rather than just the ranges the display list touches, as the ucodes read
+//	it from too many places to track; it's compressed, so mostly costs the
+//	parts the game actually uses.
+//
+//	Renderer state (combiner, fog, colours) isn't captured. Games set what they
+//	use each frame, so this only matters for a task which relies on state left
+//	by a previous one.
+//
+
+// Captures the given task (counting from 1, like gRDPFrame) to filename
+void	DLCapture_Request( u32 task_number, const char * filename );
+
+// Called by DLParser_Process once the ucode is known, before it changes anything
+bool	DLCapture_IsRequested();
+void	DLCapture_Capture( const OSTask & task );
+
+class CDLCapture
+{
+public:
+	CDLCapture();
+
+	bool				Load( const char * filename );
+
+	// Puts RDRAM, the VI registers, the task in DMEM and the parser state back as they were captured
+	void				Restore() const;
+
+	const OSTask &		GetTask() const				{ return mTask; }
+	u32					GetUcodeVersion() const		{ return mUcodeVersion; }
+	u32					GetRamSize() const			{ return mRam.size(); }
+	const char *		GetGameName() const			{ return mGameName; }
+
+private:
+	OSTask				mTask;
+	u32					mUcodeVersion;
+	u32					mGameHacks;
+	char				mGameName[ 64 ];
+	std::vector< u8 >	mRam;
+	std::vector< u8 >	mVIRegisters;
+	std::vector< u8 >	mParserState;
+};
+
+#endif // HLEGRAPHICS_DLCAPTURE_H_
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Config/ConfigOptions.h"
 #include "Core/CPU.h"
+#include "Core/GraphicsTask.h"
 #include "Core/Memory.h"
 #include "Core/ROM.h"
 #include "Debug/DBGConsole.h"
@@ -29,6 +30,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Graphics/GraphicsContext.h"
 #include "Graphics/NativePixelFormat.h"
 #include "HLEGraphics/ConvertFormats.h"			// YUVtoRGBA
+#include "HLEGraphics/DLCapture.h"
 #include "HLEGraphics/DLDebug.h"
 #include "HLEGraphics/DLParser.h"
 #include "HLEGraphics/BaseRenderer.h"
@@ -47,6 +49,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "uCodes/Ucode.h"
 #include "Utility/IO.h"
 #include "Utility/Profiler.h"
+#include "Utility/Timing.h"
 
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
@@ -169,6 +172,9 @@ static SImageDescriptor g_DI = { G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, 0 };
 
 const MicroCodeInstruction *gUcodeFunc = gNormalInstruction[ GBI_0 ];
 static const char ** gUcodeName = gNormalInstructionName[ GBI_0 ];
+static u32 gUcodeVersion = GBI_0;
+
+static SDLCommandStats * gCommandStats = nullptr;
 
 bool gFrameskipActive = false;
 
@@ -215,6 +221,10 @@ static inline bool IsVertexInfoValid(u32 address, u32 size, u32 v0, u32 n)
 //*****************************************************************************
 inline void FinishRDPJob()
 {
+	// Raised when the whole task is done, if it's running on the render thread
+	if (GraphicsTask_DeferRDPInterrupt())
+		return;
+
 	Memory_MI_SetRegisterBits(MI_INTR_REG, MI_INTR_DP);
 	gCPUState.AddJob(CPU_CHECK_INTERRUPTS);
 }
@@ -229,7 +239,7 @@ inline bool	DLParser_FetchNextCommand( MicroCodeCommand * p_command )
 	if( !IsAddressValid(pc, 8, "FetchNextCommand") )
 		return false;
 
-	*p_command = *(MicroCodeCommand*)(g_pu8RamBase + pc);
+	*p_command = *(MicroCodeCommand*)(g_pu8GfxRamBase + pc);
 	pc += 8;
 
 	return true;
@@ -303,8 +313,8 @@ void DLParser_DumpVtxInfo(u32 address, u32 v0_idx, u32 num_verts)
 {
 	if (DLDebug_IsActive())
 	{
-		s8 *pcSrc = (s8 *)(g_pu8RamBase + address);
-		s16 *psSrc = (s16 *)(g_pu8RamBase + address);
+		s8 *pcSrc = (s8 *)(g_pu8GfxRamBase + address);
+		s16 *psSrc = (s16 *)(g_pu8GfxRamBase + address);
 
 		for ( u32 idx = v0_idx; idx < v0_idx + num_verts; idx++ )
 		{
@@ -360,6 +370,7 @@ bool DLParser_Initialise()
 	// Init with Fast 3D ucode incase of a failure to start the ucode detection
 	gUcodeFunc = gNormalInstruction[ GBI_0 ];
 	gUcodeName = gNormalInstructionName[ GBI_0 ];
+	gUcodeVersion = GBI_0;
 
 	//Clear pointers in TMEM block //Corn
 	memset(gTlutLoadAddresses, 0, sizeof(gTlutLoadAddresses));
@@ -387,6 +398,76 @@ void DLParser_InitMicrocode( u32 code_base, u32 code_size, u32 data_base, u32 da
 	const UcodeInfo& ucode_info( GBIMicrocode_DetectVersion(code_base, code_size, data_base, data_size) );
 	gUcodeFunc = ucode_info.func;
 	gUcodeName = ucode_info.name;
+	gUcodeVersion = ucode_info.version;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+namespace
+{
+	struct DLParserState
+	{
+		u32					Segments[16];
+		RDP_Scissor			Scissors;
+		RDP_GeometryMode	GeometryMode;
+		u32					RDPHalf1;
+		u32					AuxAddr;
+		SImageDescriptor	TI;
+		SImageDescriptor	CI;
+		SImageDescriptor	DI;
+		u32					TlutLoadAddresses[ ARRAYSIZE( gTlutLoadAddresses ) ];
+	};
+}
+
+u32 DLParser_GetStateSize()
+{
+	return sizeof( DLParserState );
+}
+
+void DLParser_SaveState( void * data )
+{
+	DLParserState & state( *static_cast< DLParserState * >( data ) );
+
+	memcpy( state.Segments, gSegments, sizeof( gSegments ) );
+	state.Scissors = scissors;
+	state.GeometryMode = gGeometryMode;
+	state.RDPHalf1 = gRDPHalf1;
+	state.AuxAddr = gAuxAddr;
+	state.TI = g_TI;
+	state.CI = g_CI;
+	state.DI = g_DI;
+	memcpy( state.TlutLoadAddresses, gTlutLoadAddresses, sizeof( gTlutLoadAddresses ) );
+}
+
+void DLParser_LoadState( const void * data )
+{
+	const DLParserState & state( *static_cast< const DLParserState * >( data ) );
+
+	memcpy( gSegments, state.Segments, sizeof( gSegments ) );
+	scissors = state.Scissors;
+	gGeometryMode = state.GeometryMode;
+	gRDPHalf1 = state.RDPHalf1;
+	gAuxAddr = state.AuxAddr;
+	g_TI = state.TI;
+	g_CI = state.CI;
+	g_DI = state.DI;
+	memcpy( gTlutLoadAddresses, state.TlutLoadAddresses, sizeof( gTlutLoadAddresses ) );
+}
+
+void DLParser_SetCommandStats( SDLCommandStats * stats )
+{
+	gCommandStats = stats;
+}
+
+const char * DLParser_GetCommandName( u32 cmd )
+{
+	return gUcodeName[ cmd & 0xFF ];
+}
+
+u32 DLParser_GetUcodeVersion()
+{
+	return gUcodeVersion;
 }
 
 //*****************************************************************************
@@ -411,7 +492,8 @@ SProfileItemHandle * gpProfileItemHandles[ 256 ];
 //*****************************************************************************
 //	Process the entire display list in one go
 //*****************************************************************************
-static u32 DLParser_ProcessDList(u32 instruction_limit)
+template< bool TimeCommands >
+static u32 DLParser_ProcessDListT(u32 instruction_limit)
 {
 	MicroCodeCommand command;
 
@@ -426,7 +508,20 @@ static u32 DLParser_ProcessDList(u32 instruction_limit)
 
 		PROFILE_DL_CMD( command.inst.cmd );
 
-		gUcodeFunc[ command.inst.cmd ]( command );
+		if( TimeCommands )
+		{
+			u64 start, end;
+			NTiming::GetPreciseTime( &start );
+			gUcodeFunc[ command.inst.cmd ]( command );
+			NTiming::GetPreciseTime( &end );
+
+			gCommandStats->Ticks[ command.inst.cmd ] += end - start;
+			gCommandStats->Count[ command.inst.cmd ]++;
+		}
+		else
+		{
+			gUcodeFunc[ command.inst.cmd ]( command );
+		}
 
 		DL_END_INSTR();
 
@@ -458,6 +553,13 @@ static u32 DLParser_ProcessDList(u32 instruction_limit)
 	return current_instruction_count;
 }
 
+static u32 DLParser_ProcessDList(u32 instruction_limit)
+{
+	// Timing each command is for the replay benchmark, so keep it out of the normal loop
+	return gCommandStats != nullptr ? DLParser_ProcessDListT< true >( instruction_limit )
+									: DLParser_ProcessDListT< false >( instruction_limit );
+}
+
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -480,19 +582,20 @@ u32 DLParser_Process(u32 instruction_limit, DLDebugOutput * debug_output)
 		gFirstCall = false;
 	}
 
-	// Update Screen only when something is drawn, otherwise several games ex Army Men will flash or shake.
-	if( g_ROM.GameHacks != CHAMELEON_TWIST_2 ) gGraphicsPlugin->UpdateScreen();
-
-	OSTask * pTask = (OSTask *)(g_pu8SpMemBase + 0x0FC0);
-	u32 code_base = (u32)pTask->t.ucode & 0x1fffffff;
+	const OSTask * pTask = &GraphicsTask_GetTask();
+	u32 code_base = pTask->t.ucode & 0x1fffffff;
 	//u32 code_size = pTask->t.ucode_size; // Conker sets this to 0..
 	u32 code_size = 0x1000;
-	u32 data_base = (u32)pTask->t.ucode_data & 0x1fffffff;
+	u32 data_base = pTask->t.ucode_data & 0x1fffffff;
 	u32 data_size = pTask->t.ucode_data_size;
 	u32 stack_size = pTask->t.dram_stack_size >> 6;
 	
 	DLParser_InitMicrocode( code_base, code_size, data_base, data_size );
 
+	// Before anything in the task changes the state
+	if( DLCapture_IsRequested() )
+		DLCapture_Capture( *pTask );
+
 	//
 	// Not sure what to init this with. We should probably read it from the dmem
 	//
@@ -505,7 +608,7 @@ u32 DLParser_Process(u32 instruction_limit, DLDebugOutput * debug_output)
 
 	// Initialise stack
 	gDlistStackPointer=0;
-	gDlistStack.address[0] = (u32)pTask->t.data_ptr;
+	gDlistStack.address[0] = pTask->t.data_ptr;
 	gDlistStack.limit = -1;
 
 	gRDPStateManager.Reset();
@@ -537,10 +640,6 @@ u32 DLParser_Process(u32 instruction_limit, DLDebugOutput * debug_output)
 		FinishRDPJob();
 	}
 
-	// Hack for Chameleon Twist 2, only works if screen is update at last
-	if( g_ROM.GameHacks == CHAMELEON_TWIST_2 ) 
-		gGraphicsPlugin->UpdateScreen();
-
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	DLDebug_SetOutput(NULL);
 
@@ -568,7 +667,7 @@ void MatrixFromN64FixedPoint( Matrix4x4 & mat, u32 address )
 		return;
 
 	const f32 fRecip = 1.0f / 65536.0f;
-	const N64mat *Imat = (N64mat *)( g_pu8RamBase + address );
+	const N64mat *Imat = (N64mat *)( g_pu8GfxRamBase + address );
 
 	for (u32 i = 0; i < 4; i++)
 	{
@@ -601,7 +700,7 @@ void RDP_MoveMemLight(u32 address, u32 light_idx)
 		if( !IsAddressValid(address, 40, "RDP_MoveMemLight") )
 			return;
 
-		const N64Light *light = (const N64Light*)(g_pu8RamBase + address);
+		const N64Light *light = (const N64Light*)(g_pu8GfxRamBase + address);
 
 		u8 r = light->r;
 		u8 g = light->g;
@@ -651,7 +750,7 @@ void RDP_MoveMemViewport(u32 address)
 		return;
 
 	// address is offset into RD_RAM of 8 x 16bits of data...
-	N64Viewport *vp = (N64Viewport*)(g_pu8RamBase + address);
+	N64Viewport *vp = (N64Viewport*)(g_pu8GfxRamBase + address);
 
 	// With D3D we had to ensure that the vp coords are positive, so
 	// we truncated them to 0. This happens a lot, as things
@@ -725,6 +824,9 @@ void DLParser_RDPSetOtherMode( MicroCodeCommand command )
 {
 	DL_PF( "    RDPSetOtherMode: 0x%08x 0x%08x", command.inst.cmd0, command.inst.cmd1 );
 
+	if( gRDPOtherMode.H != command.inst.cmd0 || gRDPOtherMode.L != command.inst.cmd1 )
+		gRenderer->FlushBatch();
+
 	gRDPOtherMode.H = command.inst.cmd0;
 	gRDPOtherMode.L = command.inst.cmd1;
 
@@ -789,6 +891,9 @@ void DLParser_SetTile( MicroCodeCommand command )
 	tile.cmd0 = command.inst.cmd0;
 	tile.cmd1 = command.inst.cmd1;
 
+	if( gRDPStateManager.GetTile( tile.tile_idx ) != tile )
+		gRenderer->FlushBatch();
+
 	gRDPStateManager.SetTile( tile );
 
 	DL_PF( "    Tile[%d] Format[%s/%s] Line[%d] TMEM[0x%03x] Palette[%d]", tile.tile_idx, gFormatNames[tile.format], gSizeNames[tile.size], tile.line, tile.tmem, tile.palette);
@@ -811,6 +916,9 @@ void DLParser_SetTileSize( MicroCodeCommand command )
 				((tile.right/4) - (tile.left/4)) + 1,
 				((tile.bottom/4) - (tile.top/4)) + 1);
 
+	if( gRDPStateManager.GetTileSize( tile.tile_idx ) != tile )
+		gRenderer->FlushBatch();
+
 	gRDPStateManager.SetTileSize( tile );
 }
 
@@ -834,6 +942,7 @@ void DLParser_SetTImg( MicroCodeCommand command )
 //*****************************************************************************
 void DLParser_LoadBlock( MicroCodeCommand command )
 {
+	gRenderer->FlushBatch();
 	gRDPStateManager.LoadBlock( command.loadtile );
 }
 
@@ -842,6 +951,7 @@ void DLParser_LoadBlock( MicroCodeCommand command )
 //*****************************************************************************
 void DLParser_LoadTile( MicroCodeCommand command )
 {
+	gRenderer->FlushBatch();
 	gRDPStateManager.LoadTile( command.loadtile );
 }
 
@@ -850,6 +960,7 @@ void DLParser_LoadTile( MicroCodeCommand command )
 //*****************************************************************************
 void DLParser_LoadTLut( MicroCodeCommand command )
 {
+	gRenderer->FlushBatch();
 	gRDPStateManager.LoadTlut( command.loadtile );
 }
 
@@ -939,6 +1050,7 @@ void DLParser_TexRect( MicroCodeCommand command )
 	DL_PF("    Screen(%.1f,%.1f) -> (%.1f,%.1f) Tile[%d]", xy0.x, xy0.y, xy1.x, xy1.y, tex_rect.tile_idx);
 	DL_PF("    Tex:(%#5.3f,%#5.3f) -> (%#5.3f,%#5.3f) (DSDX:%#5f DTDY:%#5f)", rect_s0/32.f, rect_t0/32.f, rect_s1/32.f, rect_t1/32.f, rect_dsdx/1024.f, rect_dtdy/1024.f);
 
+	gRenderer->FlushBatch();
 	gRenderer->TexRect( tex_rect.tile_idx, xy0, xy1, st0, st1 );
 }
 
@@ -997,6 +1109,7 @@ void DLParser_TexRectFlip( MicroCodeCommand command )
 	DL_PF("    Screen(%.1f,%.1f) -> (%.1f,%.1f) Tile[%d]", xy0.x, xy0.y, xy1.x, xy1.y, tex_rect.tile_idx);
 	DL_PF("    FlipTex:(%#5.3f,%#5.3f) -> (%#5.3f,%#5.3f) (DSDX:%#5f DTDY:%#5f)", rect_s0/32.f, rect_t0/32.f, rect_s1/32.f, rect_t1/32.f, rect_dsdx/1024.f, rect_dtdy/1024.f);
 
+	gRenderer->FlushBatch();
 	gRenderer->TexRectFlip( tex_rect.tile_idx, xy0, xy1, st0, st1 );
 }
 
@@ -1018,7 +1131,7 @@ void Clear_N64DepthBuffer( MicroCodeCommand command )
 	x1 >>= 1;
 	u32 zi_width_in_dwords = g_CI.Width >> 1;
 	u32 fill_colour = gRenderer->GetFillColour();
-	u32 * dst = (u32*)(g_pu8RamBase + g_CI.Address) + y0 * zi_width_in_dwords;
+	u32 * dst = (u32*)(g_pu8GfxRamBase + g_CI.Address) + y0 * zi_width_in_dwords;
 
 	for( u32 y = y0; y <y1; y++ )
 	{
@@ -1028,6 +1141,14 @@ void Clear_N64DepthBuffer( MicroCodeCommand command )
 		}
 		dst += zi_width_in_dwords;
 	}
+
+	if( x1 > x0 )
+	{
+		for( u32 y = y0; y < y1; y++ )
+		{
+			GraphicsTask_RamWritten( g_CI.Address + (y * zi_width_in_dwords + x0) * 4, (x1 - x0) * 4 );
+		}
+	}
 }
 
 //*****************************************************************************
@@ -1042,6 +1163,9 @@ void DLParser_FillRect( MicroCodeCommand command )
 		return;
 	}
 
+	// Clears and rects both land on top of any triangles waiting to be drawn
+	gRenderer->FlushBatch();
+
 	//Always clear Zbuffer if Depthbuffer is selected //Corn
 	if (g_DI.Address == g_CI.Address)
 	{
@@ -33,4 +33,21 @@ void DLParser_Finalise();
 const u32 kUnlimitedInstructionCount = u32( ~0 );
 u32 DLParser_Process(u32 instruction_limit = kUnlimitedInstructionCount, DLDebugOutput * debug_output = nullptr);
 
+// The parser state which carries over from one task to the next (segments, scissor,
+// image descriptors, TLUT addresses), as an opaque block for display list capture
+u32 DLParser_GetStateSize();
+void DLParser_SaveState( void * data );
+void DLParser_LoadState( const void * data );
+
+// Host time spent in each command of the current ucode, while collecting
+struct SDLCommandStats
+{
+	u64		Ticks[ 256 ];
+	u32		Count[ 256 ];
+};
+
+void DLParser_SetCommandStats( SDLCommandStats * stats );		// nullptr to stop collecting
+const char * DLParser_GetCommandName( u32 cmd );
+u32 DLParser_GetUcodeVersion();
+
 #endif // HLEGRAPHICS_DLPARSER_H_
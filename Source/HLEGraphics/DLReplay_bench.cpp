@@ -0,0 +1,290 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Replays a display list written by DLCapture (daedalus -dlcapture <n> <file>)
+//	through the null renderer, so changes to the parser and BaseRenderer can be
+//	timed on a real frame without running the game. Memory and parser state
+//	are put back before each run, and the first run, which detects the ucode
+//	and creates the textures, is reported separately.
+//
+//	The time per command and per triangle comes from untimed runs. A final pass
+//	times each command, which adds the cost of reading the clock to each one,
+//	so its figures are for comparing commands with each other. Where the clock
+//	is coarser than a command (it's in microseconds on Posix), the average over
+//	many runs still comes out right, as commands start at random points in a tick.
+//
+//	Finally the frame is drawn with and without triangle batching, and on the
+//	render thread while RDRAM is overwritten under it, as a game reusing its
+//	buffers would. The vertices the renderer was given are compared each time.
+//	Returns 1 if they differ.
+//
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Config/ConfigOptions.h"
+#include "Core/GraphicsTask.h"
+#include "Core/Memory.h"
+#include "Core/RSP_HLE.h"
+#include "HLEGraphics/DLCapture.h"
+#include "HLEGraphics/DLParser.h"
+#include "Math/MathUtil.h"
+#include "Plugins/GraphicsPlugin.h"
+#include "SysNull/HLEGraphics/RendererNull.h"
+#include "System/Paths.h"
+#include "System/System.h"
+#include "Utility/IO.h"
+#include "Utility/Timing.h"
+
+namespace
+{
+	const u32	kDefaultRuns = 200;
+
+	u64		gFrequency( 0 );
+
+	f64		TicksToNs( u64 ticks )
+	{
+		return f64( ticks ) * 1000000000.0 / f64( gFrequency );
+	}
+
+	u64		Replay( const CDLCapture & capture )
+	{
+		capture.Restore();
+
+		u64		start( 0 ), end( 0 );
+		NTiming::GetPreciseTime( &start );
+		GraphicsTask_Start();
+		NTiming::GetPreciseTime( &end );
+		return end - start;
+	}
+
+	struct SBatchCheck
+	{
+		u32		DrawsSubmitted;
+		u32		DrawsMerged;
+		u32		VertexHash;
+	};
+
+	SBatchCheck	ReplayForBatchCheck( const CDLCapture & capture, bool batch )
+	{
+		gBatchTrisEnabled = batch;
+		gRendererNull->ResetStats();
+		gRendererNull->SetHashVertices( true );
+		Replay( capture );
+		gRendererNull->SetHashVertices( false );
+		gBatchTrisEnabled = true;
+
+		SBatchCheck		check;
+		check.DrawsSubmitted = gRenderer->GetNumDrawsSubmitted();
+		check.DrawsMerged = gRenderer->GetNumDrawsMerged();
+		check.VertexHash = gRendererNull->GetStats().VertexHash;
+		return check;
+	}
+
+	// Returns false if there's no render thread to run the task on
+	bool		ReplayAsyncForSnapshotCheck( const CDLCapture & capture, u32 * p_vertex_hash )
+	{
+		capture.Restore();
+		Memory_SP_ClrRegisterBits( SP_STATUS_REG, SP_STATUS_HALT );
+
+		gRendererNull->ResetStats();
+		gRendererNull->SetHashVertices( true );
+		const bool	started( GraphicsTask_Start() == PR_STARTED );
+		if( started )
+		{
+			// The render thread should only be reading its copy
+			memset( g_pu8RamBase, 0xa5, gRamSize );
+			GraphicsTask_Finish();
+		}
+		gRendererNull->SetHashVertices( false );
+
+		*p_vertex_hash = gRendererNull->GetStats().VertexHash;
+		return started;
+	}
+
+	// The cost in ns of a pair of clock reads, as each timed command has
+	f64		TimerOverheadNs()
+	{
+		const u32	kLoops = 100000;
+		u64			start( 0 ), end( 0 ), a, b;
+		NTiming::GetPreciseTime( &start );
+		for( u32 i = 0; i < kLoops; ++i )
+		{
+			NTiming::GetPreciseTime( &a );
+			NTiming::GetPreciseTime( &b );
+		}
+		NTiming::GetPreciseTime( &end );
+		return TicksToNs( end - start ) / kLoops;
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	if( argc < 2 )
+	{
+		printf( "Usage: dlreplay_bench <capture> [runs]\n" );
+		return 1;
+	}
+
+	const char *	filename( argv[ 1 ] );
+	const u32		num_runs( argc > 2 ? Max< u32 >( strtoul( argv[ 2 ], NULL, 10 ), 1 ) : kDefaultRuns );
+
+	IO::Filename	exe_path;
+	realpath( argv[ 0 ], exe_path );
+	strcpy( gDaedalusExePath, exe_path );
+	IO::Path::RemoveFileSpec( gDaedalusExePath );
+
+	if( !System_Init() || !Memory_Reset() )
+		return 1;
+
+	CDLCapture		capture;
+	if( !capture.Load( filename ) )
+	{
+		fprintf( stderr, "Couldn't load %s\n", filename );
+		return 1;
+	}
+
+	// The plugin initialises the parser, texture cache and null renderer. Tasks are run on this thread
+	gGraphicsTaskMode = GTM_SYNC;
+	gGraphicsPlugin = CreateGraphicsPlugin();
+	if( gGraphicsPlugin == nullptr || !GraphicsTask_Open() )
+		return 1;
+
+	NTiming::GetPreciseFrequency( &gFrequency );
+
+	const u64	first_run( Replay( capture ) );
+	if( DLParser_GetUcodeVersion() != capture.GetUcodeVersion() )
+	{
+		printf( "Warning: captured with ucode %u, replayed with %u\n", capture.GetUcodeVersion(), DLParser_GetUcodeVersion() );
+	}
+
+	gRendererNull->ResetStats();
+
+	std::vector< u64 >	times;
+	times.reserve( num_runs );
+	for( u32 i = 0; i < num_runs; ++i )
+	{
+		times.push_back( Replay( capture ) );
+	}
+
+	const SNullRendererStats	render_stats( gRendererNull->GetStats() );
+
+	static SDLCommandStats		command_stats;
+	memset( &command_stats, 0, sizeof( command_stats ) );
+	DLParser_SetCommandStats( &command_stats );
+	for( u32 i = 0; i < num_runs; ++i )
+	{
+		Replay( capture );
+	}
+	DLParser_SetCommandStats( nullptr );
+
+	u64		total_ticks( 0 ), total_commands( 0 );
+	for( u32 i = 0; i < num_runs; ++i )
+	{
+		total_ticks += times[ i ];
+	}
+	for( u32 cmd = 0; cmd < 256; ++cmd )
+	{
+		total_commands += command_stats.Count[ cmd ];
+	}
+
+	const f64	commands_per_run( f64( total_commands ) / num_runs );
+	const f64	triangles_per_run( f64( render_stats.NumTriangles ) / num_runs );
+	const f64	ns_per_run( TicksToNs( total_ticks ) / num_runs );
+
+	std::sort( times.begin(), times.end() );
+
+	printf( "%s: ucode %u, %u KB RDRAM\n", capture.GetGameName(), capture.GetUcodeVersion(), capture.GetRamSize() / 1024 );
+	printf( "%.0f commands, %.0f triangles, %.0f tex rects, %.0f fill rects per run\n\n", commands_per_run, triangles_per_run,
+			f64( render_stats.NumTexRects ) / num_runs, f64( render_stats.NumFillRects ) / num_runs );
+
+	printf( "First run:      %10.3f ms\n", TicksToNs( first_run ) / 1000000.0 );
+	printf( "%u runs, mean:  %10.3f ms (min %.3f, p50 %.3f, max %.3f)\n", num_runs, ns_per_run / 1000000.0,
+			TicksToNs( times.front() ) / 1000000.0, TicksToNs( times[ times.size() / 2 ] ) / 1000000.0, TicksToNs( times.back() ) / 1000000.0 );
+	printf( "ns per command: %10.1f\n", commands_per_run > 0.0 ? ns_per_run / commands_per_run : 0.0 );
+	printf( "ns per triangle:%10.1f\n\n", triangles_per_run > 0.0 ? ns_per_run / triangles_per_run : 0.0 );
+
+	std::vector< u32 >	commands;
+	u64					timed_ticks( 0 );
+	for( u32 cmd = 0; cmd < 256; ++cmd )
+	{
+		if( command_stats.Count[ cmd ] > 0 )
+		{
+			commands.push_back( cmd );
+			timed_ticks += command_stats.Ticks[ cmd ];
+		}
+	}
+	std::sort( commands.begin(), commands.end(), []( u32 a, u32 b ) { return command_stats.Ticks[ a ] > command_stats.Ticks[ b ]; } );
+
+	printf( "Per command, timed individually (adding %.0f ns each to read the clock):\n", TimerOverheadNs() );
+	printf( "  %-4s %-28s %10s %12s %7s\n", "cmd", "name", "per run", "ns each", "%" );
+	for( u32 i = 0; i < commands.size(); ++i )
+	{
+		const u32	cmd( commands[ i ] );
+		printf( "  0x%02x %-28s %10.1f %12.1f %6.1f%%\n", cmd, DLParser_GetCommandName( cmd ),
+				f64( command_stats.Count[ cmd ] ) / num_runs,
+				TicksToNs( command_stats.Ticks[ cmd ] ) / command_stats.Count[ cmd ],
+				timed_ticks > 0 ? 100.0 * f64( command_stats.Ticks[ cmd ] ) / f64( timed_ticks ) : 0.0 );
+	}
+
+	const SBatchCheck	unbatched( ReplayForBatchCheck( capture, false ) );
+	const SBatchCheck	batched( ReplayForBatchCheck( capture, true ) );
+	const bool			batch_ok( batched.VertexHash == unbatched.VertexHash );
+
+	printf( "\nTriangle batching: %u draws without, %u with (%u flushes merged), vertices %s\n",
+			unbatched.DrawsSubmitted, batched.DrawsSubmitted, batched.DrawsMerged, batch_ok ? "match" : "DIFFER" );
+
+	GraphicsTask_Close();
+	gGraphicsTaskMode = GTM_ASYNC;
+	GraphicsTask_Open();
+
+	// Whether the overwrite lands before the render thread reads RDRAM is down to timing, so try a few times
+	const u32	kAsyncRuns = 20;
+	u32			async_hash( 0 ), async_mismatches( 0 ), async_unfinished( 0 );
+	bool		async_ok( true );
+	if( ReplayAsyncForSnapshotCheck( capture, &async_hash ) )
+	{
+		for( u32 i = 0; i < kAsyncRuns; ++i )
+		{
+			ReplayAsyncForSnapshotCheck( capture, &async_hash );
+			async_mismatches += async_hash != batched.VertexHash ? 1 : 0;
+			async_unfinished += RSP_IsRunning() ? 1 : 0;		// Finishing the task halts the RSP
+		}
+		async_ok = async_mismatches == 0 && async_unfinished == 0;
+		printf( "Render thread with RDRAM overwritten: %u runs, vertices differ in %u, %u left unfinished\n",
+				kAsyncRuns, async_mismatches, async_unfinished );
+	}
+	else
+	{
+		printf( "Render thread with RDRAM overwritten: skipped, no render thread\n" );
+	}
+
+	GraphicsTask_Close();
+	gGraphicsPlugin->RomClosed();
+	delete gGraphicsPlugin;
+	gGraphicsPlugin = nullptr;
+	System_Finalize();
+	return batch_ok && async_ok ? 0 : 1;
+}
@@ -19,6 +19,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "stdafx.h"
 #include "HLEGraphics/Microcode.h"
 
+#include "Core/GraphicsTask.h"
 #include "Core/ROM.h"
 #include "Core/Memory.h"
 
@@ -76,7 +77,7 @@ static UcodeUsage gUcodeUsage[ MAX_UCODE_CACHE_ENTRIES ];
 
 static bool	GBIMicrocode_DetectVersionString( u32 data_base, u32 data_size, char * str, u32 str_len )
 {
-	const s8 *ram = g_ps8RamBase;
+	const s8 *ram = g_ps8GfxRamBase;
 
 	for ( u32 i = 0; i+2 < data_size; i++ )
 	{
@@ -106,7 +107,7 @@ static bool	GBIMicrocode_DetectVersionString( u32 data_base, u32 data_size, char
 
 static u32 GBIMicrocode_MicrocodeHash(u32 code_base, u32 code_size)
 {
-	const u8 * ram = g_pu8RamBase;
+	const u8 * ram = g_pu8GfxRamBase;
 	u32 hash = 0;
 
 	for (u32 i = 0; i < code_size; ++i)
@@ -155,7 +156,7 @@ static const MicrocodeData gMicrocodeData[] =
 	{ GBI_BETA,		GBI_0,	0x64cc729d,	"RSP SW Version: 2.0D, 04-01-96"},	//"Wave Race 64 (v1.1)"
 };
 
-UcodeInfo GBIMicrocode_SetCache(u32 index, u32 code_base, u32 data_base, 
+UcodeInfo GBIMicrocode_SetCache(u32 index, u32 code_base, u32 data_base, u32 ucode_version,
 	const MicroCodeInstruction * ucode_function, const char ** name )
 {
 	//
@@ -175,6 +176,7 @@ UcodeInfo GBIMicrocode_SetCache(u32 index, u32 code_base, u32 data_base,
 	
 	used.info.func = ucode_function;
 	used.info.name = name;
+	used.info.version = ucode_version;
 	return used.info;
 }
 
@@ -211,7 +213,7 @@ UcodeInfo GBIMicrocode_DetectVersion( u32 code_base, u32 code_size, u32 data_bas
 			GBIMicrocode_SetCustomArray( ucode_version, ucode_offset ); 
 			DBGConsole_Msg(0, "Detected Custom Ucode is: [M Ucode %d, 0x%08x, \"%s\", \"%s\"]", ucode_version, code_hash, 
 				gMicrocodeData[i].ucode_name, g_ROM.settings.GameName.c_str());
-			return GBIMicrocode_SetCache( index, code_base, data_base, gCustomInstruction, gCustomInstructionName );
+			return GBIMicrocode_SetCache( index, code_base, data_base, ucode_version, gCustomInstruction, gCustomInstructionName );
 		}
 	}
 	
@@ -259,7 +261,7 @@ UcodeInfo GBIMicrocode_DetectVersion( u32 code_base, u32 code_size, u32 data_bas
 	}
 	DBGConsole_Msg(0, "Detected Ucode is: [M Ucode %d, 0x%08x, \"%s\", \"%s\"]", ucode_version, code_hash, 
 		str, g_ROM.settings.GameName.c_str());
-	return GBIMicrocode_SetCache(index, code_base, data_base, gNormalInstruction[ ucode_version ], gNormalInstructionName[ ucode_version ]);
+	return GBIMicrocode_SetCache(index, code_base, data_base, ucode_version, gNormalInstruction[ ucode_version ], gNormalInstructionName[ ucode_version ]);
 }
 
 //****************************************************'*********************************
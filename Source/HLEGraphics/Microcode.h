@@ -47,6 +47,7 @@ struct UcodeInfo
 {
 	const MicroCodeInstruction * func;
 	const char ** name;
+	u32 version;		// GBIVersion
 };
 
 //*****************************************************************************
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 
 
+#include "Core/GraphicsTask.h"
 #include "Core/Memory.h"
 #include "Core/ROM.h"
 #include "Debug/DBGConsole.h"
@@ -412,7 +413,7 @@ void CRDPStateManager::LoadBlock(const SetLoadTile & load)
 	}
 
 	u32* dst = (u32*)(gTMEM + tmem_offset);
-	u32* src = (u32*)(g_pu8RamBase + ram_offset);
+	u32* src = (u32*)(g_pu8GfxRamBase + ram_offset);
 
 	if (dxt == 0)
 	{
@@ -531,7 +532,7 @@ void CRDPStateManager::LoadTile(const SetLoadTile & load)
 	}
 
 	u8* dst = gTMEM + tmem_offset;
-	u8* src =  g_pu8RamBase + ram_offset;
+	u8* src =  g_pu8GfxRamBase + ram_offset;
 
 	for (u32 y  = 0; y < h; ++y)
 	{
@@ -582,7 +583,7 @@ void CRDPStateManager::LoadTlut(const SetLoadTile & load)
 	DAEDALUS_DL_ASSERT( (rdp_tile.tmem + count) <= (MAX_TMEM_ADDRESS/8), "LoadTlut address is invalid" );
 
 	u16* dst = (u16*)(((u64*)gTMEM) + rdp_tile.tmem);
-	u16* src = (u16*)(g_pu8RamBase + ram_offset);
+	u16* src = (u16*)(g_pu8GfxRamBase + ram_offset);
 
 	CopyLine16(dst, src, count);
 #endif
@@ -23,14 +23,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "stdafx.h"
 
+#include "HLEGraphics/ConvertImage.h"
 #include "HLEGraphics/DLDebug.h"
 #include "HLEGraphics/TextureCache.h"
 #include "HLEGraphics/TextureInfo.h"
 
+#include "Utility/Hash.h"
 #include "Utility/Profiler.h"
 
 #include <vector>
-#include <algorithm>
 
 //#define PROFILE_TEXTURE_CACHE
 
@@ -44,16 +45,35 @@ template<> bool CSingleton< CTextureCache >::Create()
 }
 
 CTextureCache::CTextureCache()
+:	mTable( INITIAL_TABLE_SIZE )
+,	mNumTextures( 0 )
+,	mPurgeCursor( 0 )
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
-:	mDebugMutex("TextureCache")
+,	mDebugMutex("TextureCache")
 #endif
 {
+	memset( &mTable[0], 0, mTable.size() * sizeof( STextureEntry ) );
 	memset( mpCacheHashTable, 0, sizeof(mpCacheHashTable) );
+	ResetStats();
+
+	SetConvertRowKernels( nullptr );
+	CachedTexture::StartConversionThreads();
 }
 
 CTextureCache::~CTextureCache()
 {
+	// Textures wait for their conversions, so drop them before the threads go
 	DropTextures();
+
+	CachedTexture::StopConversionThreads();
+}
+
+void CTextureCache::ResetStats()
+{
+	memset( &mStats, 0, sizeof( mStats ) );
+	CachedTexture::ResetConversionStats();
+	mStats.NumTextures = mNumTextures;
+	mStats.TableSize = mTable.size();
 }
 
 inline u32 CTextureCache::MakeHashIdxA( const TextureInfo & ti )
@@ -71,97 +91,188 @@ inline u32 CTextureCache::MakeHashIdxB( const TextureInfo & ti )
 	return ti.GetHashCode() & (HASH_TABLE_SIZE-1);
 }
 
-// Purge any textures that haven't been used recently
-void CTextureCache::PurgeOldTextures()
+// GetHashCode only mixes enough bits for the skewed cache, the table needs all 32
+u32 CTextureCache::MakeTableHash( const TextureInfo & ti )
 {
-	MutexLock lock(GetDebugMutex());
+	return murmur2_hash( &ti, sizeof( TextureInfo ), 0 );
+}
 
-	//
-	//	Erase expired textures in reverse order, which should require less
-	//	copying when large clumps of textures are released simultaneously.
-	//
-	for( s32 i = mTextures.size() - 1; i >= 0; --i )
-	{
-		CachedTexture * texture = mTextures[ i ];
-		if ( texture->HasExpired() )
-		{
-			u32	ixa = MakeHashIdxA( texture->GetTextureInfo() );
-			u32 ixb = MakeHashIdxB( texture->GetTextureInfo() );
+// Returns the slot holding ti, or the empty slot where it should go
+u32 CTextureCache::FindSlot( const TextureInfo & ti, u32 hash ) const
+{
+	const u32	mask( mTable.size() - 1 );
+	u32			slot( hash & mask );
+	u32			probes( 1 );
 
-			if( mpCacheHashTable[ixa] == texture )
-			{
-				mpCacheHashTable[ixa] = nullptr;
-			}
-			if( mpCacheHashTable[ixb] == texture )
-			{
-				mpCacheHashTable[ixb] = nullptr;
-			}
+	while( mTable[ slot ].Texture != nullptr )
+	{
+		if( mTable[ slot ].Hash == hash && mTable[ slot ].Texture->GetTextureInfo() == ti )
+			break;
 
-			mTextures.erase( mTextures.begin() + i );
+		slot = (slot + 1) & mask;
+		++probes;
+	}
 
-			delete texture;
-		}
+	mStats.TableProbes += probes;
+	if( probes > mStats.MaxProbeLength )
+	{
+		mStats.MaxProbeLength = probes;
 	}
+	return slot;
 }
 
-void CTextureCache::DropTextures()
+void CTextureCache::InsertTexture( u32 hash, CachedTexture * texture )
 {
-	MutexLock lock(GetDebugMutex());
+	const u32	mask( mTable.size() - 1 );
+	u32			slot( hash & mask );
 
-	for( u32 i = 0; i < mTextures.size(); ++i)
+	while( mTable[ slot ].Texture != nullptr )
 	{
-		delete mTextures[i];
+		slot = (slot + 1) & mask;
 	}
-	mTextures.clear();
-	for( u32 i = 0; i < HASH_TABLE_SIZE; ++i )
+
+	mTable[ slot ].Hash = hash;
+	mTable[ slot ].Texture = texture;
+	mNumTextures++;
+	mStats.NumTextures = mNumTextures;
+}
+
+//
+//	Linear probing has no tombstones - entries after the removed one are shifted back
+//	into the hole unless that would move them in front of their home slot.
+//
+void CTextureCache::RemoveSlot( u32 slot )
+{
+	const u32	mask( mTable.size() - 1 );
+	u32			hole( slot );
+	u32			next( slot );
+
+	for( ;; )
 	{
-		mpCacheHashTable[i] = nullptr;
+		next = (next + 1) & mask;
+		if( mTable[ next ].Texture == nullptr )
+			break;
+
+		u32		home( mTable[ next ].Hash & mask );
+		bool	home_in_range( hole <= next ? (hole < home && home <= next) : (hole < home || home <= next) );
+		if( !home_in_range )
+		{
+			mTable[ hole ] = mTable[ next ];
+			hole = next;
+		}
 	}
-}
 
-#ifdef PROFILE_TEXTURE_CACHE
-#define RECORD_CACHE_HIT( a, b )		TextureCacheStat( a, b, mTextures.size() )
+	mTable[ hole ].Hash = 0;
+	mTable[ hole ].Texture = nullptr;
+	mNumTextures--;
+	mStats.NumTextures = mNumTextures;
+}
 
-static void TextureCacheStat( u32 l1_hit, u32 l2_hit, u32 size )
+void CTextureCache::GrowTable()
 {
-	static u32 total_lookups = 0, total_l1_hits = 0, total_l2_hits = 0;
+	EntryVec	old_table( mTable.size() * 2 );
+	memset( &old_table[0], 0, old_table.size() * sizeof( STextureEntry ) );
+	mTable.swap( old_table );
 
-	total_l1_hits += l1_hit;
-	total_l2_hits += l2_hit;
-	++total_lookups;
+	mNumTextures = 0;
+	mPurgeCursor = 0;
+	mStats.TableSize = mTable.size();
 
-	if( total_lookups == 1000 )
+	for( u32 i = 0; i < old_table.size(); ++i )
 	{
-		printf( "L1 hits[%d] L2 hits[%d] Miss[%d] (%d entries)\n", total_l1_hits, total_l2_hits, total_lookups - (total_l1_hits+total_l2_hits), size );
-		total_lookups = total_l1_hits = total_l2_hits = 0;
+		if( old_table[ i ].Texture != nullptr )
+		{
+			InsertTexture( old_table[ i ].Hash, old_table[ i ].Texture );
+		}
 	}
 }
-#else
 
-#define RECORD_CACHE_HIT( a, b )
+void CTextureCache::ForgetTexture( const CachedTexture * texture )
+{
+	u32	ixa = MakeHashIdxA( texture->GetTextureInfo() );
+	u32 ixb = MakeHashIdxB( texture->GetTextureInfo() );
 
-#endif
+	if( mpCacheHashTable[ixa] == texture )
+	{
+		mpCacheHashTable[ixa] = nullptr;
+	}
+	if( mpCacheHashTable[ixb] == texture )
+	{
+		mpCacheHashTable[ixb] = nullptr;
+	}
+}
 
-struct SSortTextureEntries
+// Purge any textures that haven't been used recently
+void CTextureCache::PurgeOldTextures()
 {
-public:
-	bool operator()( const TextureInfo & a, const TextureInfo & b ) const
+	MutexLock lock(GetDebugMutex());
+
+	//
+	//	Textures are kept for 20 or so frames after their last use, so there's no need to
+	//	look at all of them every frame. Each call sweeps the next part of the table, which
+	//	spreads the cost of checking and releasing them over a few frames.
+	//
+	const u32	mask( mTable.size() - 1 );
+	u32			num_slots( mTable.size() / PURGE_SWEEP_FRACTION );
+	if( num_slots < MIN_PURGE_SWEEP )
 	{
-		return a < b;
+		num_slots = MIN_PURGE_SWEEP;
 	}
-	bool operator()( const CachedTexture * a, const TextureInfo & b ) const
+
+	for( u32 i = 0; i < num_slots; ++i )
 	{
-		return a->GetTextureInfo() < b;
+		CachedTexture * texture = mTable[ mPurgeCursor ].Texture;
+		if( texture != nullptr && texture->HasExpired() )
+		{
+			ForgetTexture( texture );
+			RemoveSlot( mPurgeCursor );
+			mStats.NumPurged++;
+
+			delete texture;
+
+			// Another entry may have been shifted into this slot, so look at it again
+			continue;
+		}
+
+		mPurgeCursor = (mPurgeCursor + 1) & mask;
 	}
-	bool operator()( const TextureInfo & a, const CachedTexture * b ) const
+}
+
+void CTextureCache::DropTextures()
+{
+	MutexLock lock(GetDebugMutex());
+
+	for( u32 i = 0; i < mTable.size(); ++i)
 	{
-		return a < b->GetTextureInfo();
+		delete mTable[i].Texture;
+		mTable[i].Hash = 0;
+		mTable[i].Texture = nullptr;
 	}
-	bool operator()( const CachedTexture * a, const CachedTexture * b ) const
+	mNumTextures = 0;
+	mPurgeCursor = 0;
+	mStats.NumTextures = 0;
+
+	for( u32 i = 0; i < HASH_TABLE_SIZE; ++i )
 	{
-		return a->GetTextureInfo() < b->GetTextureInfo();
+		mpCacheHashTable[i] = nullptr;
 	}
-};
+}
+
+#ifdef PROFILE_TEXTURE_CACHE
+static void TextureCacheStat( const STextureCacheStats & stats )
+{
+	if( (stats.Lookups % 1000) == 0 )
+	{
+		printf( "L1 hits[%d] Table hits[%d] Miss[%d] Avg probes[%.2f] Max probes[%d] (%d entries, %d slots)\n",
+			stats.L1Hits, stats.TableHits, stats.Misses,
+			f32( stats.TableProbes ) / f32( stats.TableHits + stats.Misses ), stats.MaxProbeLength,
+			stats.NumTextures, stats.TableSize );
+	}
+}
+#define RECORD_CACHE_LOOKUP()		TextureCacheStat( mStats )
+#else
+#define RECORD_CACHE_LOOKUP()
+#endif
 
 // If already in table, return cached copy
 // Otherwise, create surfaces, and load texture into memory
@@ -178,13 +289,16 @@ CachedTexture * CTextureCache::GetOrCreateCachedTexture(const TextureInfo & ti)
 	// NB: this is a no-op in normal builds.
 	MutexLock lock(GetDebugMutex());
 
+	mStats.Lookups++;
+	RECORD_CACHE_LOOKUP();
+
 	//
 	// Retrieve the texture from the cache (if it already exists)
 	//
 	u32	ixa = MakeHashIdxA( ti );
 	if( mpCacheHashTable[ixa] && mpCacheHashTable[ixa]->GetTextureInfo() == ti )
 	{
-		RECORD_CACHE_HIT( 1, 0 );
+		mStats.L1Hits++;
 		mpCacheHashTable[ixa]->UpdateIfNecessary();
 
 		return mpCacheHashTable[ixa];
@@ -193,28 +307,32 @@ CachedTexture * CTextureCache::GetOrCreateCachedTexture(const TextureInfo & ti)
 	u32 ixb = MakeHashIdxB( ti );
 	if( mpCacheHashTable[ixb] && mpCacheHashTable[ixb]->GetTextureInfo() == ti )
 	{
-		RECORD_CACHE_HIT( 1, 0 );
+		mStats.L1Hits++;
 		mpCacheHashTable[ixb]->UpdateIfNecessary();
 
 		return mpCacheHashTable[ixb];
 	}
 
-	CachedTexture *	texture = nullptr;
-	TextureVec::iterator	it = std::lower_bound( mTextures.begin(), mTextures.end(), ti, SSortTextureEntries() );
-	if( it != mTextures.end() && (*it)->GetTextureInfo() == ti )
+	u32				hash( MakeTableHash( ti ) );
+	u32				slot( FindSlot( ti, hash ) );
+	CachedTexture *	texture = mTable[ slot ].Texture;
+	if( texture != nullptr )
 	{
-		texture = *it;
-		RECORD_CACHE_HIT( 0, 1 );
+		mStats.TableHits++;
 	}
 	else
 	{
+		mStats.Misses++;
+
 		texture = CachedTexture::Create( ti );
 		if (texture != nullptr)
 		{
-			mTextures.insert( it, texture );
+			if( (mNumTextures + 1) * 2 > mTable.size() )
+			{
+				GrowTable();
+			}
+			InsertTexture( hash, texture );
 		}
-
-		RECORD_CACHE_HIT( 0, 0 );
 	}
 
 	// Update the hashtable
@@ -245,10 +363,13 @@ void CTextureCache::Snapshot(const MutexLock & lock, std::vector< STextureInfoSn
 
 	snapshot.erase( snapshot.begin(), snapshot.end() );
 
-	for( TextureVec::const_iterator it = mTextures.begin(); it != mTextures.end(); ++it )
+	for( EntryVec::const_iterator it = mTable.begin(); it != mTable.end(); ++it )
 	{
-		STextureInfoSnapshot	info( (*it)->GetTextureInfo(), (*it)->GetTexture() );
-		snapshot.push_back( info );
+		if( it->Texture != nullptr )
+		{
+			STextureInfoSnapshot	info( it->Texture->GetTextureInfo(), it->Texture->GetTexture() );
+			snapshot.push_back( info );
+		}
 	}
 }
 #endif // DAEDALUS_DEBUG_DISPLAYLIST
@@ -31,6 +31,19 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 struct TextureInfo;
 
 
+struct STextureCacheStats
+{
+	u32			Lookups;
+	u32			L1Hits;				// Found in the skewed cache
+	u32			TableHits;			// Found in the hash table
+	u32			Misses;				// Had to create a new texture
+	u32			TableProbes;		// Slots looked at by table lookups (hits and misses)
+	u32			MaxProbeLength;
+	u32			NumTextures;
+	u32			TableSize;
+	u32			NumPurged;
+};
+
 class CTextureCache : public CSingleton< CTextureCache >
 {
 public:
@@ -42,6 +55,8 @@ public:
 	void		PurgeOldTextures();
 	void		DropTextures();
 
+	const STextureCacheStats &	GetStats() const	{ return mStats; }
+	void		ResetStats();
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	Mutex * 	GetDebugMutex()		{ return &mDebugMutex; }
@@ -76,11 +91,34 @@ private:
 	inline static u32 MakeHashIdxA( const TextureInfo & ti );
 	inline static u32 MakeHashIdxB( const TextureInfo & ti );
 
-	// FIXME(strmnnrmn): we should have a struct of TextureInfo+CachedTexture instead -
-	// doing binary search on this array needs a memory indirect for every probe.
-	typedef std::vector< CachedTexture * >	TextureVec;
-	TextureVec			mTextures;
+	//
+	//	Behind that, every texture lives in an open addressed (linear probing) hash table.
+	//	The full hash is kept next to the pointer so probes only touch the CachedTexture
+	//	when the hashes match. The table is kept at most half full.
+	//
+	struct STextureEntry
+	{
+		u32					Hash;
+		CachedTexture *		Texture;		// nullptr for an empty slot
+	};
+
+	static const u32 INITIAL_TABLE_SIZE = 256;
+	static const u32 PURGE_SWEEP_FRACTION = 4;		// PurgeOldTextures looks at this fraction of the table each call
+	static const u32 MIN_PURGE_SWEEP = 64;
+
+	static u32			MakeTableHash( const TextureInfo & ti );
+	u32					FindSlot( const TextureInfo & ti, u32 hash ) const;
+	void				InsertTexture( u32 hash, CachedTexture * texture );
+	void				RemoveSlot( u32 slot );
+	void				GrowTable();
+	void				ForgetTexture( const CachedTexture * texture );
+
+	typedef std::vector< STextureEntry >	EntryVec;
+	EntryVec			mTable;
+	u32					mNumTextures;
+	u32					mPurgeCursor;
 	CachedTexture *		mpCacheHashTable[HASH_TABLE_SIZE];
+	mutable STextureCacheStats	mStats;
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	Mutex				mDebugMutex;
 #endif
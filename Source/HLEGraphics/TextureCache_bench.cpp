@@ -0,0 +1,235 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Runs a texture heavy scene through the texture cache, once converting
+//	updates synchronously and once on the conversion threads, and reports the
+//	time spent in texture lookups per frame. A quarter of the textures are
+//	animated, and each frame sleeps a little to stand in for the rest of the
+//	emulation. Once the scene stops changing, both runs must leave the same
+//	texels in every texture.
+//
+
+#include "stdafx.h"
+#include "Core/Memory.h"
+#include "HLEGraphics/CachedTexture.h"
+#include "HLEGraphics/TextureCache.h"
+#include "HLEGraphics/TextureInfo.h"
+#include "OSHLE/ultra_gbi.h"
+#include "Utility/Thread.h"
+#include "Utility/Timing.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const u32	kRamSize = 8 * 1024 * 1024;
+	const u32	kTlutAddress = 0x100000;
+	const u32	kTextureBase = 0x200000;
+	const u32	kNumTextures = 96;
+	const u32	kNumFrames = 300;
+	const u32	kNumSettleFrames = 4;
+	const u32	kOtherWorkMs = 2;			// Time spent emulating the rest of each frame
+
+	struct SResult
+	{
+		f64		Percentiles[ 3 ];		// p50, p99, max in ms
+		f64		TotalMs;
+		u32		Checksum;
+	};
+
+	std::vector< u8 >			gRam;
+	std::vector< TextureInfo >	gTextures;
+
+	void	SetupTextures()
+	{
+		static const struct { u32 Format, Size, Width, Height; } formats[] =
+		{
+			{ G_IM_FMT_RGBA,	G_IM_SIZ_16b,	64,	64 },
+			{ G_IM_FMT_RGBA,	G_IM_SIZ_32b,	64,	32 },
+			{ G_IM_FMT_CI,		G_IM_SIZ_8b,	64,	64 },
+			{ G_IM_FMT_CI,		G_IM_SIZ_4b,	128,64 },
+			{ G_IM_FMT_IA,		G_IM_SIZ_16b,	32,	32 },
+			{ G_IM_FMT_I,		G_IM_SIZ_8b,	128,64 },
+		};
+		const u32	num_formats( sizeof( formats ) / sizeof( formats[0] ) );
+
+		u32		address( kTextureBase );
+		for( u32 i = 0; i < kNumTextures; ++i )
+		{
+			const u32	f( i % num_formats );
+			const u32	pitch( (formats[ f ].Width << formats[ f ].Size) >> 1 );
+
+			TextureInfo	ti;
+			ti.SetLoadAddress( address );
+			ti.SetFormat( formats[ f ].Format );
+			ti.SetSize( formats[ f ].Size );
+			ti.SetWidth( formats[ f ].Width );
+			ti.SetHeight( formats[ f ].Height );
+			ti.SetPitch( pitch );
+			ti.SetSwapped( (i & 1) != 0 );
+			ti.SetEmulateMirrorS( (i % 7) == 0 );
+			if( formats[ f ].Format == G_IM_FMT_CI )
+			{
+				ti.SetTlutAddress( kTlutAddress );
+				ti.SetTLutFormat( kTT_RGBA16 );
+			}
+
+			gTextures.push_back( ti );
+			address += (pitch * formats[ f ].Height + 0xff) & ~0xff;
+		}
+	}
+
+	void	FillRam( u32 seed )
+	{
+		u32		state( seed );
+		for( u32 i = 0; i < gRam.size(); i += 4 )
+		{
+			state = state * 1664525 + 1013904223;
+			memcpy( &gRam[ i ], &state, 4 );
+		}
+	}
+
+	// Scribble over the animated textures, like a game updating its framebuffer effects or water
+	void	AnimateTextures( u32 frame )
+	{
+		for( u32 i = 0; i < gTextures.size(); i += 4 )
+		{
+			const TextureInfo &	ti( gTextures[ i ] );
+			u32 *				texels( reinterpret_cast< u32 * >( &gRam[ ti.GetLoadAddress() ] ) );
+			const u32			num_words( ti.GetPitch() * ti.GetHeight() / 4 );
+
+			for( u32 w = 0; w < num_words; w += 3 )
+			{
+				texels[ w ] = texels[ w ] * 33 + frame;
+			}
+		}
+	}
+
+	// Returns the checksum of all the texels, or times the lookups if times is given
+	u32		DrawFrame( std::vector< u64 > * times )
+	{
+		u64		start( 0 ), end( 0 );
+		NTiming::GetPreciseTime( &start );
+
+		u32		checksum( 0 );
+		for( u32 i = 0; i < gTextures.size(); ++i )
+		{
+			CRefPtr<CNativeTexture>	texture( CTextureCache::Get()->GetOrCreateTexture( gTextures[ i ] ) );
+			if( times == nullptr && texture != nullptr )
+			{
+				const u8 *	data( static_cast< const u8 * >( texture->GetData() ) );
+				for( u32 b = 0; b < texture->GetBytesRequired(); ++b )
+				{
+					checksum = (checksum * 33) ^ data[ b ];
+				}
+			}
+		}
+		CTextureCache::Get()->PurgeOldTextures();
+
+		NTiming::GetPreciseTime( &end );
+		if( times != nullptr )
+		{
+			times->push_back( end - start );
+		}
+
+		gRDPFrame++;
+		return checksum;
+	}
+
+	SResult	Run( bool async )
+	{
+		FillRam( 0x1234567 );
+		CTextureCache::Create();
+		if( !async )
+		{
+			CachedTexture::StopConversionThreads();
+		}
+
+		u64		freq( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+
+		// The first frame creates the textures, which is always synchronous
+		DrawFrame( nullptr );
+
+		std::vector< u64 >	times;
+		for( u32 frame = 0; frame < kNumFrames; ++frame )
+		{
+			AnimateTextures( frame );
+			DrawFrame( &times );
+			ThreadSleepMs( kOtherWorkMs );
+		}
+
+		// Give the last conversions time to land, then read back what's in the textures
+		for( u32 frame = 0; frame < kNumSettleFrames; ++frame )
+		{
+			ThreadSleepMs( 10 );
+			DrawFrame( nullptr );
+		}
+
+		SResult		result;
+		result.Checksum = DrawFrame( nullptr );
+		result.TotalMs = 0.0;
+		for( u32 i = 0; i < times.size(); ++i )
+		{
+			result.TotalMs += f64( times[ i ] ) * 1000.0 / f64( freq );
+		}
+
+		static const u32	percentiles[ 3 ] = { 50, 99, 100 };
+		for( u32 p = 0; p < 3; ++p )
+		{
+			u32		idx( ((times.size() - 1) * percentiles[ p ]) / 100 );
+			std::nth_element( times.begin(), times.begin() + idx, times.end() );
+			result.Percentiles[ p ] = f64( times[ idx ] ) * 1000.0 / f64( freq );
+		}
+
+		const STextureConversionStats &	stats( CachedTexture::GetConversionStats() );
+		printf( "%-6s %9.3f %9.3f %9.3f %10.1f   %u sync, %u queued, %u uploaded\n",
+			async ? "async" : "sync",
+			result.Percentiles[0], result.Percentiles[1], result.Percentiles[2], result.TotalMs,
+			stats.SyncConversions, stats.QueuedConversions, stats.Uploads );
+
+		CTextureCache::Destroy();
+		return result;
+	}
+}
+
+int main()
+{
+	gRam.resize( kRamSize );
+	g_pMemoryBuffers[ MEM_RD_RAM ] = &gRam[0];
+
+	SetupTextures();
+
+	printf( "%u textures, %u frames, every 4th texture animated\n\n", kNumTextures, kNumFrames );
+	printf( "%-6s %9s %9s %9s %10s\n", "mode", "p50 ms", "p99 ms", "max ms", "total ms" );
+
+	SResult		sync_result( Run( false ) );
+	SResult		async_result( Run( true ) );
+
+	const bool	match( sync_result.Checksum == async_result.Checksum );
+	printf( "\nSettled texels: %s\n", match ? "match" : "MISMATCH" );
+
+	g_pMemoryBuffers[ MEM_RD_RAM ] = nullptr;
+	return match ? 0 : 1;
+}
@@ -21,8 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "stdafx.h"
 
 #include "Config/ConfigOptions.h"
+#include "Core/GraphicsTask.h"
 #include "Core/Memory.h"
-#include "Core/ROM.h"
 #include "HLEGraphics/TextureInfo.h"
 #include "OSHLE/ultra_gbi.h"
 #include "Utility/Hash.h"
@@ -41,88 +41,38 @@ u32 TextureInfo::GetSizeInBits() const
 	return gImageSizesInBits[ Size ];
 }
 
-// Fast hash for checking is data in a texture source has changed //Corn
+// Hashes a range of rdram, clipped so bad texture addresses can't read past the end of it.
+// Rdram is word swapped, so the range is widened to whole words to get every byte in it.
+static u32 HashRamRange( u32 address, u32 length, u32 seed )
+{
+	u32 start = address & ~3;
+	u32 end   = (address + length + 3) & ~3;
+
+	if (start >= MAX_RAM_ADDRESS) return seed;
+	if (end > MAX_RAM_ADDRESS || end < start) end = MAX_RAM_ADDRESS;
+
+	return xxhash32x4( g_pu8GfxRamBase + start, end - start, seed );
+}
+
+// Hash for checking if the data a texture is converted from has changed.
+// Every byte of the texture and its palette is hashed, so changes between rows aren't
+// missed and no game needs a special row count - xxhash32x4 is fast enough to do this every frame.
 u32 TextureInfo::GenerateHashValue() const
 {
-	//Rewritten to use less recources //Corn
 #ifdef DAEDALUS_ENABLE_PROFILING
 	DAEDALUS_PROFILE( "TextureInfo::GenerateHashValue" );
 #endif
 	// If CRC checking is disabled, always return 0
 	if ( gCheckTextureHashFrequency == 0 ) return 0;
 
-	//DAEDALUS_ASSERT( (GetLoadAddress() + Height * Pitch) < 4*1024*1024, "Address of texture is out of bounds" );
-
-	//Number of places to do fragment hash from in texture
-	//More rows will use more CPU...
-	u32 CHK_ROW = 5;
-	u32 hash_value = 0;
-	u8 *ptr_u8  = g_pu8RamBase + GetLoadAddress();
-
-	if( g_ROM.GameHacks == YOSHI )
-	{
-		CHK_ROW = 49;
-		if (GetFormat() == G_IM_FMT_CI)
-		{
-			//Check palette changes too but only first 16 palette values//Corn
-			const u32* ptr_u32 = (u32*)(g_pu8RamBase + GetTlutAddress());
-			for (u32 z = 0; z < 8; z++) hash_value = ((hash_value << 1) | (hash_value >> 0x1F)) ^ *ptr_u32++;
-		}
-	}
-	else if( g_ROM.GameHacks == WORMS_ARMAGEDDON )
-	{
-		CHK_ROW = 1000;
-		if (GetFormat() == G_IM_FMT_CI)
-		{
-			//Check palette changes too but only first 16 palette values//Corn
-			const u32* ptr_u32 = (u32*)(g_pu8RamBase + GetTlutAddress());
-			for (u32 z = 0; z < 8; z++) hash_value = ((hash_value << 1) | (hash_value >> 0x1F)) ^ *ptr_u32++;
-		}
-	}
-
-	u32 step = (u32)(Height * Pitch);	//Get size in bytes, seems to be more accurate (alternative -> Height * Width * (1<<Size) >> 1;)
-
-	if((uintptr_t)ptr_u8 & 0x3)	//Check if aligned to 4 bytes if not then align
-	{
-		ptr_u8 += 4 - ((uintptr_t)ptr_u8 & 0x3);
-		step   -= 4 - ((uintptr_t)ptr_u8 & 0x3);
-	}
-
-	u32 *ptr_u32 = (u32*)ptr_u8;	//use 32bit access
-	step = step >> 2;	//convert to 32bit access
+	u32 hash_value = HashRamRange( GetLoadAddress(), Height * Pitch, 0 );
 
-	//We want to sample the texture data as far apart as possible
-	if (step < (CHK_ROW << 2))	//if texture is small hash all of it
-	{
-		for (u32 z = 0; z < step; z++)
-		{
-			hash_value = ((hash_value << 1) | (hash_value >> 0x1F)) ^ ptr_u32[z];
-		}
-	}
-	else	//if texture is big, hash only some parts inside it
-	{
-		step = (step - 4) / CHK_ROW;
-		for (u32 y = 0; y < CHK_ROW; y++)
-		{
-			hash_value = ((hash_value << 1) | (hash_value >> 0x1F)) ^ ptr_u32[0];
-			hash_value = ((hash_value << 1) | (hash_value >> 0x1F)) ^ ptr_u32[1];
-			hash_value = ((hash_value << 1) | (hash_value >> 0x1F)) ^ ptr_u32[2];
-			hash_value = ((hash_value << 1) | (hash_value >> 0x1F)) ^ ptr_u32[3];
-			ptr_u32 += step;
-		}
-	}
-#if 0
-	//If texture has a palette then make hash of that too
-	//Might not be needed but it would catch if only the colors are changed in a palette texture
-	//It is a bit expensive CPU wise so better leave out unless really needed
-	//It assumes 4 byte alignment so we use u32 (faster than u8)
-	//Used in OOT for the sky, really minor so is not worth the CPU time to always check for it
+	// Catch palette swaps too, e.g. OOT's sky
 	if (GetFormat() == G_IM_FMT_CI)
 	{
-		const u32* ptr_u32 = (u32*)(g_pu8RamBase + GetTlutAddress());
-		for (u32 z = 0; z < ((GetSize() == G_IM_SIZ_4b)? 8 : 128); z++) hash_value ^= *ptr_u32++;
+		u32 palette_bytes = (GetSize() == G_IM_SIZ_4b) ? 16 * 2 : 256 * 2;
+		hash_value = HashRamRange( GetTlutAddress(), palette_bytes, hash_value );
 	}
-#endif
-	//printf("%08X %d S%d P%d H%d W%d B%d\n", hash_value, step, Size, Pitch, Height, Width, Height * Pitch);
+
 	return hash_value;
 }
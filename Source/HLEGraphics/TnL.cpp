@@ -0,0 +1,203 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "HLEGraphics/TnL.h"
+
+#include "Math/Math.h"
+#include "Math/MathUtil.h"
+
+//*****************************************************************************
+//
+//*****************************************************************************
+v3 LightVert( const TnLParams & params, const v3 & norm )
+{
+	const v3 & col = params.Lights[params.NumLights].Colour;
+	v3 result( col.x, col.y, col.z );
+
+	for ( u32 l = 0; l < params.NumLights; l++ )
+	{
+		f32 fCosT = norm.Dot( params.Lights[l].Direction );
+		if (fCosT > 0.0f)
+		{
+			result.x += params.Lights[l].Colour.x * fCosT;
+			result.y += params.Lights[l].Colour.y * fCosT;
+			result.z += params.Lights[l].Colour.z * fCosT;
+		}
+	}
+
+	//Clamp to 1.0
+	if( result.x > 1.0f ) result.x = 1.0f;
+	if( result.y > 1.0f ) result.y = 1.0f;
+	if( result.z > 1.0f ) result.z = 1.0f;
+
+	return result;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+v3 LightPointVert( const TnLParams & params, const v4 & w )
+{
+	const v3 & col = params.Lights[params.NumLights].Colour;
+	v3 result( col.x, col.y, col.z );
+
+	for ( u32 l = 0; l < params.NumLights; l++ )
+	{
+		if ( params.Lights[l].SkipIfZero )
+		{
+			v3 distance_vec( params.Lights[l].Position.x-w.x, params.Lights[l].Position.y-w.y, params.Lights[l].Position.z-w.z );
+
+			f32 light_qlen = distance_vec.LengthSq();
+			f32 light_llen = sqrtf( light_qlen );
+
+			f32 at = params.Lights[l].ca + params.Lights[l].la * light_llen + params.Lights[l].qa * light_qlen;
+			if (at > 0.0f)
+			{
+				f32 fCosT = 1.0f/at;
+				result.x += params.Lights[l].Colour.x * fCosT;
+				result.y += params.Lights[l].Colour.y * fCosT;
+				result.z += params.Lights[l].Colour.z * fCosT;
+			}
+		}
+	}
+
+	//Clamp to 1.0
+	if( result.x > 1.0f ) result.x = 1.0f;
+	if( result.y > 1.0f ) result.y = 1.0f;
+	if( result.z > 1.0f ) result.z = 1.0f;
+
+	return result;
+}
+
+//*****************************************************************************
+// Standard rendering pipeline using FPU/CPU
+//*****************************************************************************
+void TnLScalar( const Matrix4x4 * world_matrix, const Matrix4x4 * projection_matrix, const FiddledVtx * p_in, DaedalusVtx4 * p_out, u32 num_vertices, const TnLParams * params, bool fog )
+{
+	// Transform and Project + Lighting or Transform and Project with Colour
+	//
+	for (u32 i = 0; i < num_vertices; i++)
+	{
+		const FiddledVtx & vert = p_in[i];
+
+		// VTX Transform
+		//
+		v4 w( f32( vert.x ), f32( vert.y ), f32( vert.z ), 1.0f );
+
+		v4 & projected( p_out[i].ProjectedPos );
+		projected = projection_matrix->Transform( w );
+		p_out[i].TransformedPos = world_matrix->Transform( w );
+
+		//	Initialise the clipping flags
+		//
+		p_out[i].ClipFlags = set_clip_flags( projected );
+
+		// LIGHTING OR COLOR
+		//
+		if ( params->Flags.Light )
+		{
+			v3 model_normal(f32( vert.norm_x ), f32( vert.norm_y ), f32( vert.norm_z ) );
+			v3 vecTransformedNormal;
+			vecTransformedNormal = world_matrix->TransformNormal( model_normal );
+			vecTransformedNormal.Normalise();
+
+			v3 col;
+
+			if ( params->Flags.PointLight )
+			{//POINT LIGHT
+				col = LightPointVert(*params, w); // Majora's Mask uses this
+			}
+			else
+			{//NORMAL LIGHT
+				col = LightVert(*params, vecTransformedNormal);
+			}
+			p_out[i].Colour.x = col.x;
+			p_out[i].Colour.y = col.y;
+			p_out[i].Colour.z = col.z;
+			p_out[i].Colour.w = vert.rgba_a * (1.0f / 255.0f);
+
+			// ENV MAPPING
+			//
+			if ( params->Flags.TexGen )
+			{
+				// Update texture coords n.b. need to divide tu/tv by bogus scale on addition to buffer
+				// If the vert is already lit, then there is no normal (and hence we can't generate tex coord)
+#if 1			// 1->Lets use mat_world_project instead of mat_world for nicer effect (see SSV space ship) //Corn
+				vecTransformedNormal = projection_matrix->TransformNormal( model_normal );
+				vecTransformedNormal.Normalise();
+#endif
+
+				const v3 & norm = vecTransformedNormal;
+
+				if( params->Flags.TexGenLin )
+				{
+					p_out[i].Texture.x = 0.5f * ( 1.0f + norm.x );
+					p_out[i].Texture.y = 0.5f * ( 1.0f + norm.y );
+				}
+				else
+				{
+					//Cheap way to do Acos(x)/Pi (abs() fixes star in SM64, sort of) //Corn
+					f32 NormX = fabsf( norm.x );
+					f32 NormY = fabsf( norm.y );
+					p_out[i].Texture.x =  0.5f - 0.25f * NormX - 0.25f * NormX * NormX * NormX;
+					p_out[i].Texture.y =  0.5f - 0.25f * NormY - 0.25f * NormY * NormY * NormY;
+				}
+			}
+			else
+			{
+				//Set Texture coordinates
+				p_out[i].Texture.x = (float)vert.tu * params->TextureScaleX;
+				p_out[i].Texture.y = (float)vert.tv * params->TextureScaleY;
+			}
+		}
+		else
+		{
+			//if( params->Flags.Shade )
+			{// FLAT shade
+				p_out[i].Colour = v4( vert.rgba_r * (1.0f / 255.0f), vert.rgba_g * (1.0f / 255.0f), vert.rgba_b * (1.0f / 255.0f), vert.rgba_a * (1.0f / 255.0f) );
+			}
+			/*else
+			{// PRIM shade, SSV uses this, doesn't seem to do anything????
+				p_out[i].Colour = mPrimitiveColour.GetColourV4();
+			}*/
+
+
+			//Set Texture coordinates
+			p_out[i].Texture.x = (float)vert.tu * params->TextureScaleX;
+			p_out[i].Texture.y = (float)vert.tv * params->TextureScaleY;
+		}
+
+		//Fog
+		if ( fog )
+		{
+			if(projected.w > 0.0f)	//checking for positive w fixes near plane fog errors //Corn
+			{
+				f32 eye_z = projected.z / projected.w;
+				f32 fog_alpha = eye_z * params->FogMult + params->FogOffs;
+				//f32 fog_alpha = eye_z * 20.0f - 19.0f;	//Fog test line
+				p_out[i].Colour.w = Clamp< f32 >( fog_alpha, 0.0f, 1.0f );
+			}
+			else
+			{
+				p_out[i].Colour.w = 0.0f;
+			}
+		}
+	}
+}
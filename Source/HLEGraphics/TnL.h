@@ -0,0 +1,65 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef HLEGRAPHICS_TNL_H_
+#define HLEGRAPHICS_TNL_H_
+
+#include "HLEGraphics/BaseRenderer.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DAEDALUS_SIMD_TNL
+#endif
+
+//*****************************************************************************
+//	Transform and lighting for the standard vertex format, as used by
+//	BaseRenderer::SetNewVertexInfo: transform, clip flags, lighting or vertex
+//	colour, texgen or scaled texture coords and, if fog is set, fog alpha
+//	(only the PSP generates fog here - the other ports fog in hardware).
+//	The PSP VFPU builds use _TnLVFPU instead.
+//
+//	TnLScalar is the reference. TnLSIMD does four vertices at a time with
+//	SSE2/NEON, and falls back to TnLScalar for point lights.
+//*****************************************************************************
+void	TnLScalar( const Matrix4x4 * world_matrix, const Matrix4x4 * projection_matrix, const FiddledVtx * p_in, DaedalusVtx4 * p_out, u32 num_vertices, const TnLParams * params, bool fog );
+#ifdef DAEDALUS_SIMD_TNL
+void	TnLSIMD( const Matrix4x4 * world_matrix, const Matrix4x4 * projection_matrix, const FiddledVtx * p_in, DaedalusVtx4 * p_out, u32 num_vertices, const TnLParams * params, bool fog );
+#endif
+
+v3		LightVert( const TnLParams & params, const v3 & norm );
+v3		LightPointVert( const TnLParams & params, const v4 & w );
+
+//*****************************************************************************
+// Set Clipflags
+//*****************************************************************************
+inline u32 set_clip_flags(const v4 & projected)
+{
+	u32 clip_flags = 0;
+	if		(projected.x < -projected.w)	clip_flags |= X_POS;
+	else if (projected.x > projected.w)		clip_flags |= X_NEG;
+
+	if		(projected.y < -projected.w)	clip_flags |= Y_POS;
+	else if (projected.y > projected.w)		clip_flags |= Y_NEG;
+
+	if		(projected.z < -projected.w)	clip_flags |= Z_POS;
+	else if (projected.z > projected.w)		clip_flags |= Z_NEG;
+
+	return clip_flags;
+}
+
+#endif // HLEGRAPHICS_TNL_H_
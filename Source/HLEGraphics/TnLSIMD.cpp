@@ -0,0 +1,398 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	SSE2/NEON version of TnLScalar. Vertices are done four at a time, with
+//	each component of four vertices in one register, so the code reads like
+//	the scalar version and does its arithmetic in the same order. On SSE2 that
+//	makes the results identical; NEON on 32 bit ARM has no divide or square
+//	root, so it refines the hardware estimates and is within a few ulp.
+//
+
+#include "stdafx.h"
+#include "HLEGraphics/TnL.h"
+
+#ifdef DAEDALUS_SIMD_TNL
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+#if defined(__SSE2__)
+
+//*****************************************************************************
+//	SSE2
+//*****************************************************************************
+typedef __m128		VecF;
+typedef __m128i		VecI;		// Also used for masks
+
+inline VecF Splat( f32 x )						{ return _mm_set1_ps( x ); }
+inline VecI SplatI( s32 x )						{ return _mm_set1_epi32( x ); }
+inline VecF Add( VecF a, VecF b )				{ return _mm_add_ps( a, b ); }
+inline VecF Sub( VecF a, VecF b )				{ return _mm_sub_ps( a, b ); }
+inline VecF Mul( VecF a, VecF b )				{ return _mm_mul_ps( a, b ); }
+inline VecF Div( VecF a, VecF b )				{ return _mm_div_ps( a, b ); }
+inline VecF Min( VecF a, VecF b )				{ return _mm_min_ps( a, b ); }
+inline VecF Max( VecF a, VecF b )				{ return _mm_max_ps( a, b ); }
+inline VecF InvSqrt( VecF a )					{ return _mm_div_ps( _mm_set1_ps( 1.0f ), _mm_sqrt_ps( a ) ); }
+inline VecF Abs( VecF a )						{ return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a ); }
+inline VecI CmpLT( VecF a, VecF b )				{ return _mm_castps_si128( _mm_cmplt_ps( a, b ) ); }
+inline VecI CmpGT( VecF a, VecF b )				{ return _mm_castps_si128( _mm_cmpgt_ps( a, b ) ); }
+inline VecF And( VecI mask, VecF a )			{ return _mm_and_ps( _mm_castsi128_ps( mask ), a ); }
+inline VecF Select( VecI mask, VecF a, VecF b )	{ return _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( mask ), a ), _mm_andnot_ps( _mm_castsi128_ps( mask ), b ) ); }
+inline VecI AndI( VecI a, VecI b )				{ return _mm_and_si128( a, b ); }
+inline VecI AndNotI( VecI a, VecI b )			{ return _mm_andnot_si128( a, b ); }		// ~a & b
+inline VecI OrI( VecI a, VecI b )				{ return _mm_or_si128( a, b ); }
+inline VecF ToFloat( VecI a )					{ return _mm_cvtepi32_ps( a ); }
+template< int N > inline VecI Shl( VecI a )		{ return _mm_slli_epi32( a, N ); }
+template< int N > inline VecI Sra( VecI a )		{ return _mm_srai_epi32( a, N ); }
+template< int N > inline VecI Srl( VecI a )		{ return _mm_srli_epi32( a, N ); }
+
+inline void Store( f32 * p, VecF a )			{ _mm_storeu_ps( p, a ); }
+inline void StoreI( u32 * p, VecI a )			{ _mm_storeu_si128( reinterpret_cast< __m128i * >( p ), a ); }
+
+inline void Transpose( VecF & a, VecF & b, VecF & c, VecF & d )
+{
+	_MM_TRANSPOSE4_PS( a, b, c, d );
+}
+
+// Returns the nth word of each of four vertices in w[n]
+inline void LoadVertices( const FiddledVtx * p, VecI w[ 4 ] )
+{
+	const f32 *	f( reinterpret_cast< const f32 * >( p ) );
+	VecF		a( _mm_loadu_ps( f + 0 ) );
+	VecF		b( _mm_loadu_ps( f + 4 ) );
+	VecF		c( _mm_loadu_ps( f + 8 ) );
+	VecF		d( _mm_loadu_ps( f + 12 ) );
+	Transpose( a, b, c, d );
+	w[0] = _mm_castps_si128( a );
+	w[1] = _mm_castps_si128( b );
+	w[2] = _mm_castps_si128( c );
+	w[3] = _mm_castps_si128( d );
+}
+
+#else
+
+//*****************************************************************************
+//	NEON
+//*****************************************************************************
+typedef float32x4_t	VecF;
+typedef int32x4_t	VecI;		// Also used for masks
+
+inline VecF Splat( f32 x )						{ return vdupq_n_f32( x ); }
+inline VecI SplatI( s32 x )						{ return vdupq_n_s32( x ); }
+inline VecF Add( VecF a, VecF b )				{ return vaddq_f32( a, b ); }
+inline VecF Sub( VecF a, VecF b )				{ return vsubq_f32( a, b ); }
+inline VecF Mul( VecF a, VecF b )				{ return vmulq_f32( a, b ); }
+inline VecF Min( VecF a, VecF b )				{ return vminq_f32( a, b ); }
+inline VecF Max( VecF a, VecF b )				{ return vmaxq_f32( a, b ); }
+inline VecF Abs( VecF a )						{ return vabsq_f32( a ); }
+inline VecI CmpLT( VecF a, VecF b )				{ return vreinterpretq_s32_u32( vcltq_f32( a, b ) ); }
+inline VecI CmpGT( VecF a, VecF b )				{ return vreinterpretq_s32_u32( vcgtq_f32( a, b ) ); }
+inline VecF And( VecI mask, VecF a )			{ return vreinterpretq_f32_s32( vandq_s32( mask, vreinterpretq_s32_f32( a ) ) ); }
+inline VecF Select( VecI mask, VecF a, VecF b )	{ return vbslq_f32( vreinterpretq_u32_s32( mask ), a, b ); }
+inline VecI AndI( VecI a, VecI b )				{ return vandq_s32( a, b ); }
+inline VecI AndNotI( VecI a, VecI b )			{ return vbicq_s32( b, a ); }		// ~a & b
+inline VecI OrI( VecI a, VecI b )				{ return vorrq_s32( a, b ); }
+inline VecF ToFloat( VecI a )					{ return vcvtq_f32_s32( a ); }
+template< int N > inline VecI Shl( VecI a )		{ return vshlq_n_s32( a, N ); }
+template< int N > inline VecI Sra( VecI a )		{ return vshrq_n_s32( a, N ); }
+template< int N > inline VecI Srl( VecI a )		{ return vreinterpretq_s32_u32( vshrq_n_u32( vreinterpretq_u32_s32( a ), N ) ); }
+
+#if defined(__aarch64__)
+inline VecF Div( VecF a, VecF b )				{ return vdivq_f32( a, b ); }
+inline VecF InvSqrt( VecF a )					{ return vdivq_f32( vdupq_n_f32( 1.0f ), vsqrtq_f32( a ) ); }
+#else
+// Two Newton-Raphson steps take the estimates to within a couple of ulp
+inline VecF Div( VecF a, VecF b )
+{
+	VecF	r( vrecpeq_f32( b ) );
+	r = vmulq_f32( r, vrecpsq_f32( b, r ) );
+	r = vmulq_f32( r, vrecpsq_f32( b, r ) );
+	return vmulq_f32( a, r );
+}
+
+inline VecF InvSqrt( VecF a )
+{
+	VecF	r( vrsqrteq_f32( a ) );
+	r = vmulq_f32( r, vrsqrtsq_f32( vmulq_f32( a, r ), r ) );
+	r = vmulq_f32( r, vrsqrtsq_f32( vmulq_f32( a, r ), r ) );
+	return r;
+}
+#endif
+
+inline void Store( f32 * p, VecF a )			{ vst1q_f32( p, a ); }
+inline void StoreI( u32 * p, VecI a )			{ vst1q_u32( p, vreinterpretq_u32_s32( a ) ); }
+
+inline void Transpose( VecF & a, VecF & b, VecF & c, VecF & d )
+{
+	float32x4x2_t	ac( vzipq_f32( a, c ) );
+	float32x4x2_t	bd( vzipq_f32( b, d ) );
+	float32x4x2_t	lo( vzipq_f32( ac.val[0], bd.val[0] ) );
+	float32x4x2_t	hi( vzipq_f32( ac.val[1], bd.val[1] ) );
+	a = lo.val[0];
+	b = lo.val[1];
+	c = hi.val[0];
+	d = hi.val[1];
+}
+
+// Returns the nth word of each of four vertices in w[n]
+inline void LoadVertices( const FiddledVtx * p, VecI w[ 4 ] )
+{
+	uint32x4x4_t	v( vld4q_u32( reinterpret_cast< const u32 * >( p ) ) );
+	w[0] = vreinterpretq_s32_u32( v.val[0] );
+	w[1] = vreinterpretq_s32_u32( v.val[1] );
+	w[2] = vreinterpretq_s32_u32( v.val[2] );
+	w[3] = vreinterpretq_s32_u32( v.val[3] );
+}
+
+#endif
+
+//*****************************************************************************
+//	Shared code
+//*****************************************************************************
+struct SVec3
+{
+	VecF	x, y, z;
+};
+
+struct SVec4
+{
+	VecF	x, y, z, w;
+};
+
+// Matrix4x4::Transform, with w == 1
+inline SVec4 Transform( const Matrix4x4 & m, const SVec3 & v )
+{
+	SVec4	r;
+	r.x = Add( Add( Add( Mul( v.x, Splat( m.m11 ) ), Mul( v.y, Splat( m.m21 ) ) ), Mul( v.z, Splat( m.m31 ) ) ), Splat( m.m41 ) );
+	r.y = Add( Add( Add( Mul( v.x, Splat( m.m12 ) ), Mul( v.y, Splat( m.m22 ) ) ), Mul( v.z, Splat( m.m32 ) ) ), Splat( m.m42 ) );
+	r.z = Add( Add( Add( Mul( v.x, Splat( m.m13 ) ), Mul( v.y, Splat( m.m23 ) ) ), Mul( v.z, Splat( m.m33 ) ) ), Splat( m.m43 ) );
+	r.w = Add( Add( Add( Mul( v.x, Splat( m.m14 ) ), Mul( v.y, Splat( m.m24 ) ) ), Mul( v.z, Splat( m.m34 ) ) ), Splat( m.m44 ) );
+	return r;
+}
+
+// Matrix4x4::TransformNormal followed by v3::Normalise
+inline SVec3 TransformNormalise( const Matrix4x4 & m, const SVec3 & v )
+{
+	SVec3	r;
+	r.x = Add( Add( Mul( v.x, Splat( m.m11 ) ), Mul( v.y, Splat( m.m21 ) ) ), Mul( v.z, Splat( m.m31 ) ) );
+	r.y = Add( Add( Mul( v.x, Splat( m.m12 ) ), Mul( v.y, Splat( m.m22 ) ) ), Mul( v.z, Splat( m.m32 ) ) );
+	r.z = Add( Add( Mul( v.x, Splat( m.m13 ) ), Mul( v.y, Splat( m.m23 ) ) ), Mul( v.z, Splat( m.m33 ) ) );
+
+	VecF	len_sq( Add( Add( Mul( r.x, r.x ), Mul( r.y, r.y ) ), Mul( r.z, r.z ) ) );
+	VecI	non_zero( CmpGT( len_sq, Splat( 0.0f ) ) );
+	VecF	scale( Select( non_zero, InvSqrt( len_sq ), Splat( 1.0f ) ) );
+
+	r.x = Select( non_zero, Mul( r.x, scale ), r.x );
+	r.y = Select( non_zero, Mul( r.y, scale ), r.y );
+	r.z = Select( non_zero, Mul( r.z, scale ), r.z );
+	return r;
+}
+
+// Same as set_clip_flags - the positive test wins if both are true (i.e. w is negative)
+inline VecI ClipFlags( const SVec4 & p )
+{
+	VecF	neg_w( Sub( Splat( 0.0f ), p.w ) );
+
+	VecI	x_pos( CmpLT( p.x, neg_w ) );
+	VecI	y_pos( CmpLT( p.y, neg_w ) );
+	VecI	z_pos( CmpLT( p.z, neg_w ) );
+	VecI	x_neg( AndNotI( x_pos, CmpGT( p.x, p.w ) ) );
+	VecI	y_neg( AndNotI( y_pos, CmpGT( p.y, p.w ) ) );
+	VecI	z_neg( AndNotI( z_pos, CmpGT( p.z, p.w ) ) );
+
+	VecI	flags( AndI( x_pos, SplatI( X_POS ) ) );
+	flags = OrI( flags, AndI( x_neg, SplatI( X_NEG ) ) );
+	flags = OrI( flags, AndI( y_pos, SplatI( Y_POS ) ) );
+	flags = OrI( flags, AndI( y_neg, SplatI( Y_NEG ) ) );
+	flags = OrI( flags, AndI( z_pos, SplatI( Z_POS ) ) );
+	flags = OrI( flags, AndI( z_neg, SplatI( Z_NEG ) ) );
+	return flags;
+}
+
+// LightVert - lights facing away add zero, which leaves the colour unchanged
+inline SVec3 Light( const TnLParams & params, const SVec3 & norm )
+{
+	const v3 &	ambient( params.Lights[ params.NumLights ].Colour );
+	const VecF	zero( Splat( 0.0f ) );
+	const VecF	one( Splat( 1.0f ) );
+
+	SVec3	col = { Splat( ambient.x ), Splat( ambient.y ), Splat( ambient.z ) };
+	for( u32 l = 0; l < params.NumLights; ++l )
+	{
+		const DaedalusLight &	light( params.Lights[ l ] );
+
+		VecF	cos_t( Add( Add( Mul( norm.x, Splat( light.Direction.x ) ), Mul( norm.y, Splat( light.Direction.y ) ) ), Mul( norm.z, Splat( light.Direction.z ) ) ) );
+		cos_t = And( CmpGT( cos_t, zero ), cos_t );
+
+		col.x = Add( col.x, Mul( Splat( light.Colour.x ), cos_t ) );
+		col.y = Add( col.y, Mul( Splat( light.Colour.y ), cos_t ) );
+		col.z = Add( col.z, Mul( Splat( light.Colour.z ), cos_t ) );
+	}
+
+	col.x = Min( col.x, one );
+	col.y = Min( col.y, one );
+	col.z = Min( col.z, one );
+	return col;
+}
+
+// The cheap Acos(x)/Pi from TnLScalar
+inline VecF TexGen( VecF n )
+{
+	const VecF	quarter( Splat( 0.25f ) );
+	VecF		a( Abs( n ) );
+	return Sub( Sub( Splat( 0.5f ), Mul( quarter, a ) ), Mul( Mul( Mul( quarter, a ), a ), a ) );
+}
+
+//
+//	The words of a FiddledVtx are [x:y] [z:flag] [tu:tv] [r:g:b:a] (high to low)
+//
+void TransformBatch( const Matrix4x4 & mat_world, const Matrix4x4 & mat_world_project, const FiddledVtx * p_in, DaedalusVtx4 * p_out, const TnLParams & params, bool fog )
+{
+	VecI	w[ 4 ];
+	LoadVertices( p_in, w );
+
+	SVec3	pos = { ToFloat( Sra< 16 >( w[0] ) ), ToFloat( Sra< 16 >( Shl< 16 >( w[0] ) ) ), ToFloat( Sra< 16 >( w[1] ) ) };
+
+	SVec4	projected( Transform( mat_world_project, pos ) );
+	SVec4	transformed( Transform( mat_world, pos ) );
+
+	const VecF	inv_255( Splat( 1.0f / 255.0f ) );
+	SVec4		colour;
+	colour.w = Mul( ToFloat( AndI( w[3], SplatI( 0xff ) ) ), inv_255 );
+
+	VecF	tex_x( Mul( ToFloat( Sra< 16 >( w[2] ) ), Splat( params.TextureScaleX ) ) );
+	VecF	tex_y( Mul( ToFloat( Sra< 16 >( Shl< 16 >( w[2] ) ) ), Splat( params.TextureScaleY ) ) );
+
+	if( params.Flags.Light )
+	{
+		SVec3	model_normal = { ToFloat( Sra< 24 >( w[3] ) ), ToFloat( Sra< 24 >( Shl< 8 >( w[3] ) ) ), ToFloat( Sra< 24 >( Shl< 16 >( w[3] ) ) ) };
+
+		SVec3	col( Light( params, TransformNormalise( mat_world, model_normal ) ) );
+		colour.x = col.x;
+		colour.y = col.y;
+		colour.z = col.z;
+
+		if( params.Flags.TexGen )
+		{
+			SVec3	norm( TransformNormalise( mat_world_project, model_normal ) );
+			if( params.Flags.TexGenLin )
+			{
+				const VecF	half( Splat( 0.5f ) );
+				const VecF	one( Splat( 1.0f ) );
+				tex_x = Mul( half, Add( one, norm.x ) );
+				tex_y = Mul( half, Add( one, norm.y ) );
+			}
+			else
+			{
+				tex_x = TexGen( norm.x );
+				tex_y = TexGen( norm.y );
+			}
+		}
+	}
+	else
+	{
+		colour.x = Mul( ToFloat( Srl< 24 >( w[3] ) ), inv_255 );
+		colour.y = Mul( ToFloat( AndI( Srl< 16 >( w[3] ), SplatI( 0xff ) ) ), inv_255 );
+		colour.z = Mul( ToFloat( AndI( Srl< 8 >( w[3] ), SplatI( 0xff ) ) ), inv_255 );
+	}
+
+	if( fog )
+	{
+		VecF	fog_alpha( Add( Mul( Div( projected.z, projected.w ), Splat( params.FogMult ) ), Splat( params.FogOffs ) ) );
+		fog_alpha = Min( Max( fog_alpha, Splat( 0.0f ) ), Splat( 1.0f ) );
+		colour.w = And( CmpGT( projected.w, Splat( 0.0f ) ), fog_alpha );
+	}
+
+	VecI	clip_flags( ClipFlags( projected ) );
+
+	//
+	//	Back to one vertex per register
+	//
+	Transpose( transformed.x, transformed.y, transformed.z, transformed.w );
+	Transpose( projected.x, projected.y, projected.z, projected.w );
+	Transpose( colour.x, colour.y, colour.z, colour.w );
+
+	const VecF	out[ 3 ][ 4 ] =
+	{
+		{ transformed.x, transformed.y, transformed.z, transformed.w },
+		{ projected.x, projected.y, projected.z, projected.w },
+		{ colour.x, colour.y, colour.z, colour.w },
+	};
+
+	f32		tex_u[ 4 ], tex_v[ 4 ];
+	u32		flags[ 4 ];
+	Store( tex_u, tex_x );
+	Store( tex_v, tex_y );
+	StoreI( flags, clip_flags );
+
+	for( u32 i = 0; i < 4; ++i )
+	{
+		Store( &p_out[ i ].TransformedPos.x, out[0][ i ] );
+		Store( &p_out[ i ].ProjectedPos.x, out[1][ i ] );
+		Store( &p_out[ i ].Colour.x, out[2][ i ] );
+		p_out[ i ].Texture.x = tex_u[ i ];
+		p_out[ i ].Texture.y = tex_v[ i ];
+		p_out[ i ].ClipFlags = flags[ i ];
+	}
+}
+
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void TnLSIMD( const Matrix4x4 * world_matrix, const Matrix4x4 * projection_matrix, const FiddledVtx * p_in, DaedalusVtx4 * p_out, u32 num_vertices, const TnLParams * params, bool fog )
+{
+	// Point lights (Majora's Mask) are rare enough to leave to the scalar code
+	if( params->Flags.Light && params->Flags.PointLight )
+	{
+		TnLScalar( world_matrix, projection_matrix, p_in, p_out, num_vertices, params, fog );
+		return;
+	}
+
+	u32 i = 0;
+	for( ; i + 4 <= num_vertices; i += 4 )
+	{
+		TransformBatch( *world_matrix, *projection_matrix, p_in + i, p_out + i, *params, fog );
+	}
+
+	// Pad the last few out to a whole batch, so they get the same arithmetic as the rest
+	if( i < num_vertices )
+	{
+		FiddledVtx		in[ 4 ];
+		DaedalusVtx4	out[ 4 ];
+
+		// out starts as a copy of the destination, so the untouched fields come back unchanged
+		memset( in, 0, sizeof( in ) );
+		memcpy( in, p_in + i, (num_vertices - i) * sizeof( FiddledVtx ) );
+		memcpy( out, p_out + i, (num_vertices - i) * sizeof( DaedalusVtx4 ) );
+
+		TransformBatch( *world_matrix, *projection_matrix, in, out, *params, fog );
+		memcpy( p_out + i, out, (num_vertices - i) * sizeof( DaedalusVtx4 ) );
+	}
+}
+
+#endif // DAEDALUS_SIMD_TNL
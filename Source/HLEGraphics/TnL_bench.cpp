@@ -0,0 +1,280 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Checks TnLSIMD against TnLScalar for random matrices, vertices and lights,
+//	with every combination of lighting, texgen and fog and every vertex count
+//	up to a few batches. Clip flags must match exactly; everything else to a
+//	small tolerance, for the NEON reciprocal estimates (SSE2 is exact). Then
+//	times both over a 32 vertex load, the most a single G_VTX can send.
+//
+
+#include "stdafx.h"
+#include "HLEGraphics/TnL.h"
+#include "Utility/Timing.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+namespace
+{
+	const u32	kNumMatrices = 64;
+	const u32	kMaxVertices = 19;
+	const u32	kBenchVertices = 32;
+	const u32	kBenchLoads = 200000;
+	const f32	kTolerance = 1.0e-5f;		// Relative, or absolute for small values
+
+	u32		gState( 0x13579bdf );
+
+	u32		Rand()
+	{
+		gState = gState * 1664525 + 1013904223;
+		return gState;
+	}
+
+	f32		RandF( f32 lo, f32 hi )
+	{
+		return lo + (hi - lo) * f32( Rand() >> 8 ) / f32( 1 << 24 );
+	}
+
+	// A scale/rotate/translate, with a perspective projection on top if project is set
+	void	RandomMatrix( Matrix4x4 & m, bool project )
+	{
+		for( u32 i = 0; i < 16; ++i )
+		{
+			m.mRaw[ i ] = RandF( -0.02f, 0.02f );
+		}
+		m.m41 = RandF( -100.0f, 100.0f );
+		m.m42 = RandF( -100.0f, 100.0f );
+		m.m43 = RandF( -100.0f, 100.0f );
+		m.m44 = 1.0f;
+		m.m14 = m.m24 = m.m34 = 0.0f;
+
+		if( project )
+		{
+			m.m14 = RandF( -0.02f, 0.02f );
+			m.m24 = RandF( -0.02f, 0.02f );
+			m.m34 = RandF( -0.02f, 0.02f );
+			m.m44 = RandF( -200.0f, 400.0f );
+		}
+	}
+
+	void	RandomParams( TnLParams & params, u32 flags, u32 num_lights )
+	{
+		params = TnLParams();
+		params.Flags._u32 = flags;
+		params.NumLights = num_lights;
+		params.TextureScaleX = RandF( 0.0f, 1.0f / 32.0f );
+		params.TextureScaleY = RandF( 0.0f, 1.0f / 32.0f );
+		params.FogMult = RandF( 0.0f, 30.0f );
+		params.FogOffs = RandF( -29.0f, 0.0f );
+
+		// The light after the last is the ambient colour
+		for( u32 l = 0; l <= num_lights; ++l )
+		{
+			v3	dir( RandF( -1.0f, 1.0f ), RandF( -1.0f, 1.0f ), RandF( -1.0f, 1.0f ) );
+			dir.Normalise();
+			params.Lights[ l ].Direction = dir;
+			params.Lights[ l ].Colour = v3( RandF( 0.0f, 0.5f ), RandF( 0.0f, 0.5f ), RandF( 0.0f, 0.5f ) );
+		}
+	}
+
+	void	RandomVertices( FiddledVtx * verts, u32 num_vertices )
+	{
+		for( u32 i = 0; i < num_vertices; ++i )
+		{
+			u32		words[ 4 ] = { Rand(), Rand(), Rand(), Rand() };
+			memcpy( &verts[ i ], words, sizeof( words ) );
+
+			// Keep most positions in a sensible range, so not everything is clipped
+			if( i & 3 )
+			{
+				verts[ i ].x >>= 6;
+				verts[ i ].y >>= 6;
+				verts[ i ].z >>= 6;
+			}
+		}
+	}
+
+	bool	Close( f32 a, f32 b )
+	{
+		if( a == b )
+			return true;
+
+		f32		diff( fabsf( a - b ) );
+		f32		mag( fabsf( a ) > fabsf( b ) ? fabsf( a ) : fabsf( b ) );
+		return diff <= kTolerance * (mag > 1.0f ? mag : 1.0f);
+	}
+
+	bool	Close( const DaedalusVtx4 & a, const DaedalusVtx4 & b )
+	{
+		const f32 *		fa( &a.TransformedPos.x );
+		const f32 *		fb( &b.TransformedPos.x );
+		for( u32 i = 0; i < 14; ++i )
+		{
+			if( !Close( fa[ i ], fb[ i ] ) )
+				return false;
+		}
+		return a.ClipFlags == b.ClipFlags;
+	}
+
+	void	FillGuard( DaedalusVtx4 * verts, u32 num_vertices )
+	{
+		DaedalusVtx4	guard;
+		guard.TransformedPos = v4( -1234.5f, -1234.5f, -1234.5f, -1234.5f );
+		guard.ProjectedPos = guard.TransformedPos;
+		guard.Colour = guard.TransformedPos;
+		guard.Texture = v2( -1234.5f, -1234.5f );
+		guard.ClipFlags = 0xcdcdcdcd;
+		guard.Pad = 0xcdcdcdcd;
+
+		std::fill( verts, verts + num_vertices, guard );
+	}
+
+	u32		Check()
+	{
+		static const u32	flag_sets[] =
+		{
+			0,
+			TNL_LIGHT,
+			TNL_LIGHT | TNL_TEXGEN,
+			TNL_LIGHT | TNL_TEXGEN | TNL_TEXGENLIN,
+			TNL_LIGHT | TNL_POINTLIGHT,
+		};
+		const u32	num_flag_sets( sizeof( flag_sets ) / sizeof( flag_sets[0] ) );
+
+		FiddledVtx		in[ kMaxVertices ];
+		DaedalusVtx4	expected[ kMaxVertices + 1 ];
+		DaedalusVtx4	actual[ kMaxVertices + 1 ];
+		u32				failures( 0 );
+		u32				exact( 0 ), total( 0 );
+
+		for( u32 m = 0; m < kNumMatrices; ++m )
+		{
+			Matrix4x4	world, project;
+			RandomMatrix( world, false );
+			RandomMatrix( project, true );
+
+			for( u32 f = 0; f < num_flag_sets * 2; ++f )
+			{
+				const u32	flags( flag_sets[ f % num_flag_sets ] );
+				const bool	fog( f >= num_flag_sets );
+
+				TnLParams	params;
+				RandomParams( params, flags, m % 12 );
+
+				for( u32 n = 0; n <= kMaxVertices; ++n )
+				{
+					RandomVertices( in, n );
+
+					// The extra vertex catches writes past the end
+					FillGuard( expected, kMaxVertices + 1 );
+					FillGuard( actual, kMaxVertices + 1 );
+
+					TnLScalar( &world, &project, in, expected, n, &params, fog );
+					TnLSIMD( &world, &project, in, actual, n, &params, fog );
+
+					for( u32 i = 0; i <= n; ++i )
+					{
+						total++;
+						if( memcmp( &expected[ i ], &actual[ i ], sizeof( DaedalusVtx4 ) ) == 0 )
+						{
+							exact++;
+						}
+						else if( i == n || !Close( expected[ i ], actual[ i ] ) )
+						{
+							if( failures++ < 4 )
+							{
+								printf( "  mismatch: flags %#x%s, %u lights, vertex %u of %u\n", flags, fog ? " + fog" : "", params.NumLights, i, n );
+							}
+						}
+					}
+				}
+			}
+		}
+
+		printf( "%u of %u vertices bit exact\n", exact, total );
+		return failures;
+	}
+
+	typedef void (*TnLFunction)( const Matrix4x4 *, const Matrix4x4 *, const FiddledVtx *, DaedalusVtx4 *, u32, const TnLParams *, bool );
+
+	// Returns millions of vertices per second
+	f64		Time( TnLFunction fn, u32 flags, u32 num_lights )
+	{
+		Matrix4x4	world, project;
+		RandomMatrix( world, false );
+		RandomMatrix( project, true );
+
+		TnLParams	params;
+		RandomParams( params, flags, num_lights );
+
+		FiddledVtx		in[ kBenchVertices ];
+		DaedalusVtx4	out[ kBenchVertices ];
+		RandomVertices( in, kBenchVertices );
+
+		u64		freq( 0 ), start( 0 ), end( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+		NTiming::GetPreciseTime( &start );
+
+		for( u32 i = 0; i < kBenchLoads; ++i )
+		{
+			fn( &world, &project, in, out, kBenchVertices, &params, false );
+		}
+
+		NTiming::GetPreciseTime( &end );
+
+		f64		seconds( f64( end - start ) / f64( freq ) );
+		return seconds > 0.0 ? f64( kBenchLoads ) * kBenchVertices / seconds / 1000000.0 : 0.0;
+	}
+}
+
+int main()
+{
+#ifndef DAEDALUS_SIMD_TNL
+	printf( "No SIMD TnL in this build\n" );
+	return 0;
+#else
+	u32		failures( Check() );
+	printf( "TnLSIMD: %s\n\n", failures == 0 ? "matches scalar" : "MISMATCH" );
+
+	static const struct { const char * Name; u32 Flags; u32 NumLights; } cases[] =
+	{
+		{ "colour",				0,							0 },
+		{ "1 light",			TNL_LIGHT,					1 },
+		{ "2 lights + texgen",	TNL_LIGHT | TNL_TEXGEN,		2 },
+		{ "7 lights",			TNL_LIGHT,					7 },
+	};
+
+	printf( "%-20s %12s %12s %9s\n", "case", "scalar Mv/s", "SIMD Mv/s", "speedup" );
+	for( u32 c = 0; c < sizeof( cases ) / sizeof( cases[0] ); ++c )
+	{
+		f64		scalar_mvs( Time( TnLScalar, cases[ c ].Flags, cases[ c ].NumLights ) );
+		f64		simd_mvs( Time( TnLSIMD, cases[ c ].Flags, cases[ c ].NumLights ) );
+
+		printf( "%-20s %12.1f %12.1f %8.2fx\n", cases[ c ].Name, scalar_mvs, simd_mvs, simd_mvs / scalar_mvs );
+	}
+
+	return failures == 0 ? 0 : 1;
+#endif
+}
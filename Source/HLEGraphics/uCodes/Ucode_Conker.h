@@ -68,7 +68,7 @@ void DLParser_Tri1_Conker( MicroCodeCommand command )
 
 	// While the next command pair is Tri1, add vertices
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	// If this is true then just skip the whole list of tris //Corn
 	if (IgnoreConkerShadow())
@@ -116,7 +116,7 @@ void DLParser_Tri2_Conker( MicroCodeCommand command )
 {
 
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	// If this is true then just skip the whole list of tris //Corn
 	if (IgnoreConkerShadow())
@@ -177,8 +177,8 @@ void DLParser_Tri4_Conker( MicroCodeCommand command )
 		do
 		{
 			DL_PF("    Tri4 (Culled -> Off-Screen)");
-			command.inst.cmd0 = *(u32 *)(g_pu8RamBase + pc+0);
-			command.inst.cmd1 = *(u32 *)(g_pu8RamBase + pc+4);
+			command.inst.cmd0 = *(u32 *)(g_pu8GfxRamBase + pc+0);
+			command.inst.cmd1 = *(u32 *)(g_pu8GfxRamBase + pc+4);
 			pc += 8;
 		} while ((command.inst.cmd0>>28) == 1);
 		gDlistStack.address[gDlistStackPointer] = pc-8;
@@ -219,8 +219,8 @@ void DLParser_Tri4_Conker( MicroCodeCommand command )
 
 		tris_added |= gRenderer->AddTri(idx[9], idx[10], idx[11]);
 
-		command.inst.cmd0			= *(u32 *)(g_pu8RamBase + pc+0);
-		command.inst.cmd1			= *(u32 *)(g_pu8RamBase + pc+4);
+		command.inst.cmd0			= *(u32 *)(g_pu8GfxRamBase + pc+0);
+		command.inst.cmd1			= *(u32 *)(g_pu8GfxRamBase + pc+4);
 		pc += 8;
 	} while ((command.inst.cmd0>>28) == 1);
 
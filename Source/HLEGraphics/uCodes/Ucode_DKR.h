@@ -33,7 +33,7 @@ void DLParser_DumpVtxInfoDKR(u32 address, u32 v0_idx, u32 num_verts)
 {
 	if (DLDebug_IsActive())
 	{
-		uintptr_t psSrc = (uintptr_t)(g_pu8RamBase + address);
+		uintptr_t psSrc = (uintptr_t)(g_pu8GfxRamBase + address);
 
 		for ( u32 idx = v0_idx; idx < v0_idx + num_verts; idx++ )
 		{
@@ -59,7 +59,7 @@ void DLParser_DumpVtxInfoDKR(u32 address, u32 v0_idx, u32 num_verts)
 		}
 
 		/*
-		u16 * pwSrc = (u16 *)(g_pu8RamBase + address);
+		u16 * pwSrc = (u16 *)(g_pu8GfxRamBase + address);
 		i = 0;
 		for( u32 idx = v0_idx; idx < v0_idx + num_verts; idx++ )
 		{
@@ -207,7 +207,7 @@ void DLParser_DMA_Tri_DKR( MicroCodeCommand command )
 	if( !IsAddressValid(address, (count * 16), "DMA_Tri_DKR") )
 		return;
 
-	const TriDKR *tri = (const TriDKR*)(g_pu8RamBase + address);
+	const TriDKR *tri = (const TriDKR*)(g_pu8GfxRamBase + address);
 	bool tris_added = false;
 
 	for (u32 i = 0; i < count; i++)
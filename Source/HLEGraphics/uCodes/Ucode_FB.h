@@ -75,12 +75,14 @@ static inline void DrawFrameBuffer(u32 origin, const CNativeTexture * texture)
 
 		for (u32 x = 0; x < FB_WIDTH; ++x)
 		{
-			pixels[dst_offset] = (g_pu8RamBase[(origin + src_offset)^U8_TWIDDLE]<<8) | g_pu8RamBase[(origin + src_offset+  1)^U8_TWIDDLE] | 1;  // NB: or 1 to ensure we have alpha
+			pixels[dst_offset] = (g_pu8GfxRamBase[(origin + src_offset)^U8_TWIDDLE]<<8) | g_pu8GfxRamBase[(origin + src_offset+  1)^U8_TWIDDLE] | 1;  // NB: or 1 to ensure we have alpha
 			dst_offset += 1;
 			src_offset += 2;
 		}
 	}
+#ifndef DAEDALUS_HEADLESS
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, FB_WIDTH, FB_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, pixels);
+#endif
 
 	//ToDO: Implement me PSP
 	//Doesn't work
@@ -444,7 +444,11 @@ void DLParser_GBI1_SetOtherModeL( MicroCodeCommand command )
 {
 	const u32 mask = ((1 << command.othermode.len) - 1) << command.othermode.sft;
 
-	gRDPOtherMode.L = (gRDPOtherMode.L & ~mask) | command.othermode.data;
+	const u32 other_mode = (gRDPOtherMode.L & ~mask) | command.othermode.data;
+	if( other_mode != gRDPOtherMode.L )
+		gRenderer->FlushBatch();
+
+	gRDPOtherMode.L = other_mode;
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	DLDebug_DumpRDPOtherModeL(mask, command.othermode.data);
@@ -458,7 +462,11 @@ void DLParser_GBI1_SetOtherModeH( MicroCodeCommand command )
 {
 	const u32 mask = ((1 << command.othermode.len) - 1) << command.othermode.sft;
 
-	gRDPOtherMode.H = (gRDPOtherMode.H & ~mask) | command.othermode.data;
+	const u32 other_mode = (gRDPOtherMode.H & ~mask) | command.othermode.data;
+	if( other_mode != gRDPOtherMode.H )
+		gRenderer->FlushBatch();
+
+	gRDPOtherMode.H = other_mode;
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	DLDebug_DumpRDPOtherModeH(mask, command.othermode.data);
@@ -573,7 +581,7 @@ void DLParser_GBI1_Tri1_T( MicroCodeCommand command )
 
 	// While the next command pair is Tri1, add vertices
 	u32 pc	= gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)( g_pu8RamBase + pc );
+	u32 * pCmdBase = (u32 *)( g_pu8GfxRamBase + pc );
 
 	bool tris_added = false;
 
@@ -609,7 +617,7 @@ void DLParser_GBI1_Tri2_T( MicroCodeCommand command )
 
 	// While the next command pair is Tri2, add vertices
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	bool tris_added = false;
 
@@ -659,7 +667,7 @@ void DLParser_GBI1_Line3D_T( MicroCodeCommand command )
 
 	// While the next command pair is Tri1, add vertices
 	u32 pc	= gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)( g_pu8RamBase + pc );
+	u32 * pCmdBase = (u32 *)( g_pu8GfxRamBase + pc );
 
 	bool tris_added = false;
 
@@ -383,7 +383,11 @@ void DLParser_GBI2_SetOtherModeL( MicroCodeCommand command )
 	// Mask is constructed slightly differently
 	const u32 mask = (u32)((s32)(0x80000000) >> command.othermode.len) >> command.othermode.sft;
 
-	gRDPOtherMode.L = (gRDPOtherMode.L & ~mask) | command.othermode.data;
+	const u32 other_mode = (gRDPOtherMode.L & ~mask) | command.othermode.data;
+	if( other_mode != gRDPOtherMode.L )
+		gRenderer->FlushBatch();
+
+	gRDPOtherMode.L = other_mode;
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	DLDebug_DumpRDPOtherModeL(mask, command.othermode.data);
@@ -398,7 +402,11 @@ void DLParser_GBI2_SetOtherModeH( MicroCodeCommand command )
 	// Mask is constructed slightly differently
 	const u32 mask = (u32)((s32)(0x80000000) >> command.othermode.len) >> command.othermode.sft;
 
-	gRDPOtherMode.H = (gRDPOtherMode.H & ~mask) | command.othermode.data;
+	const u32 other_mode = (gRDPOtherMode.H & ~mask) | command.othermode.data;
+	if( other_mode != gRDPOtherMode.H )
+		gRenderer->FlushBatch();
+
+	gRDPOtherMode.H = other_mode;
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
 	DLDebug_DumpRDPOtherModeH(mask, command.othermode.data);
@@ -446,7 +454,7 @@ void DLParser_GBI2_Quad( MicroCodeCommand command )
 {
 	// While the next command pair is Tri2, add vertices
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	bool tris_added = false;
 
@@ -490,7 +498,7 @@ void DLParser_GBI2_Line3D( MicroCodeCommand command )
 {
 	// While the next command pair is Tri2, add vertices
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	bool tris_added = false;
 
@@ -531,7 +539,7 @@ void DLParser_GBI2_Tri1( MicroCodeCommand command )
 
 	// While the next command pair is Tri1, add vertices
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	bool tris_added = false;
 
@@ -565,7 +573,7 @@ void DLParser_GBI2_Tri2( MicroCodeCommand command )
 {
 
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	bool tris_added = false;
 
@@ -27,7 +27,7 @@ void DLParser_Trix_GE( MicroCodeCommand command )
 {
 	// While the next command pair is TriX, add vertices
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	bool tris_added = false;
 	do
@@ -70,7 +70,7 @@ void DLParser_RDPHalf1_GE( MicroCodeCommand command )
 		return;
 
 	u32 pc = gDlistStack.address[gDlistStackPointer];		// This points to the next instruction
-	u32 * Cmd = (u32 *)(g_pu8RamBase + pc);
+	u32 * Cmd = (u32 *)(g_pu8GfxRamBase + pc);
 
 	// Indices
 	u32 a1 = *Cmd+8*0+4;
@@ -94,6 +94,7 @@ void DLParser_RDPHalf1_GE( MicroCodeCommand command )
 
 	//DL_PF(" Word 1: %u, Word 2: %u, Word 3: %u, Word 4: %u, Word 5: %u, Word 6: %u, Word 7: %u, Word 8: %u, Word 9: %u", a1, a2, a3, a4, a5, a6, a7, a8, a9);
 	//DL_PF("    Tile:%d Screen(%f,%f) -> (%f,%f)",				   tile, xy0, xy1, uv0, uv1);
+	gRenderer->FlushBatch();
 	gRenderer->TexRect( 0, xy0, xy1, uv0, uv1 );
 
 	gDlistStack.address[gDlistStackPointer] += 312;
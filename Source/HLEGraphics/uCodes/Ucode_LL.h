@@ -56,8 +56,8 @@ void DLParser_Last_Legion_0x00( MicroCodeCommand command )
 			return;
 		}
 
-		u32 pc1 = *(u32 *)(g_pu8RamBase + newaddr+8*1+4);
-		u32 pc2 = *(u32 *)(g_pu8RamBase + newaddr+8*4+4);
+		u32 pc1 = *(u32 *)(g_pu8GfxRamBase + newaddr+8*1+4);
+		u32 pc2 = *(u32 *)(g_pu8GfxRamBase + newaddr+8*4+4);
 		pc1 = RDPSegAddr(pc1);
 		pc2 = RDPSegAddr(pc2);
 
@@ -154,6 +154,7 @@ void DLParser_TexRect_Last_Legion( MicroCodeCommand command )
 	v2 xy0( tex_rect.x0 / 4.0f, tex_rect.y0 / 4.0f );
 	v2 xy1( tex_rect.x1 / 4.0f, tex_rect.y1 / 4.0f );
 
+	gRenderer->FlushBatch();
 	gRenderer->TexRect( tex_rect.tile_idx, xy0, xy1, st0, st1 );
 }
 
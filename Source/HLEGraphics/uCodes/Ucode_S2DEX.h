@@ -365,7 +365,7 @@ static inline void Draw_ObjSprite( const uObjSprite *sprite, ESpriteMode mode, c
 // Bomberman : Second Atatck uses this
 void DLParser_S2DEX_ObjSprite( MicroCodeCommand command )
 {
-	uObjSprite *sprite = (uObjSprite*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjSprite *sprite = (uObjSprite*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 
 	CRefPtr<CNativeTexture> texture = Load_ObjSprite( sprite, NULL );
 	Draw_ObjSprite( sprite, FULL_ROTATION, texture );
@@ -378,7 +378,7 @@ void DLParser_S2DEX_ObjSprite( MicroCodeCommand command )
 // Note : This cmd loads textures from both ObjTxtr and LoadBlock/LoadTile!!
 void DLParser_S2DEX_ObjRectangle( MicroCodeCommand command )
 {
-	uObjSprite *sprite = (uObjSprite*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjSprite *sprite = (uObjSprite*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 
 	CRefPtr<CNativeTexture> texture = Load_ObjSprite( sprite, gObjTxtr );
 	Draw_ObjSprite( sprite, NO_ROTATION, texture );
@@ -389,7 +389,7 @@ void DLParser_S2DEX_ObjRectangle( MicroCodeCommand command )
 //*****************************************************************************
 void DLParser_S2DEX_ObjRectangleR( MicroCodeCommand command )
 {
-	uObjSprite *sprite = (uObjSprite*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjSprite *sprite = (uObjSprite*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 	if (sprite->imageFmt == G_IM_FMT_YUV)
 	{
 		DLParser_OB_YUV(sprite);
@@ -410,7 +410,7 @@ void DLParser_S2DEX_ObjRectangleR( MicroCodeCommand command )
 // Nintendo logo, shade, items, enemies & foes, sun, and pretty much everything in Yoshi
 void DLParser_S2DEX_ObjLdtxSprite( MicroCodeCommand command )
 {
-	uObjTxSprite *sprite = (uObjTxSprite*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjTxSprite *sprite = (uObjTxSprite*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 
 	CRefPtr<CNativeTexture> texture = Load_ObjSprite( &sprite->sprite, &sprite->txtr );
 	Draw_ObjSprite( &sprite->sprite, FULL_ROTATION, texture );
@@ -422,7 +422,7 @@ void DLParser_S2DEX_ObjLdtxSprite( MicroCodeCommand command )
 // No Rotation. Intro logo, Awesome command screens and HUD in game :)
 void DLParser_S2DEX_ObjLdtxRect( MicroCodeCommand command )
 {
-	uObjTxSprite *sprite = (uObjTxSprite*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjTxSprite *sprite = (uObjTxSprite*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 
 	CRefPtr<CNativeTexture> texture = Load_ObjSprite( &sprite->sprite, &sprite->txtr );
 	Draw_ObjSprite( &sprite->sprite, NO_ROTATION, texture );
@@ -434,7 +434,7 @@ void DLParser_S2DEX_ObjLdtxRect( MicroCodeCommand command )
 // With Rotation. Text, smoke, and items in Yoshi
 void DLParser_S2DEX_ObjLdtxRectR( MicroCodeCommand command )
 {
-	uObjTxSprite *sprite = (uObjTxSprite*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjTxSprite *sprite = (uObjTxSprite*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 
 	CRefPtr<CNativeTexture> texture = Load_ObjSprite( &sprite->sprite, &sprite->txtr );
 	Draw_ObjSprite( &sprite->sprite, PARTIAL_ROTATION, texture );
@@ -451,7 +451,7 @@ void DLParser_S2DEX_ObjMoveMem( MicroCodeCommand command )
 
 	if( index == 0 )	// Mtx
 	{
-		uObjMtx* mtx = (uObjMtx *)(addr+g_pu8RamBase);
+		uObjMtx* mtx = (uObjMtx *)(addr+g_pu8GfxRamBase);
 		mat2D.A = mtx->A/65536.0f;
 		mat2D.B = mtx->B/65536.0f;
 		mat2D.C = mtx->C/65536.0f;
@@ -463,7 +463,7 @@ void DLParser_S2DEX_ObjMoveMem( MicroCodeCommand command )
 	}
 	else if( index == 2 )	// Sub Mtx
 	{
-		uObjSubMtx* sub = (uObjSubMtx*)(addr+g_pu8RamBase);
+		uObjSubMtx* sub = (uObjSubMtx*)(addr+g_pu8GfxRamBase);
 		mat2D.X = f32(sub->X>>2);
 		mat2D.Y = f32(sub->Y>>2);
 		mat2D.BaseScaleX = sub->BaseScaleX/1024.0f;
@@ -477,7 +477,7 @@ void DLParser_S2DEX_ObjMoveMem( MicroCodeCommand command )
 // Kirby uses this for proper palette loading
 void DLParser_S2DEX_ObjLoadTxtr( MicroCodeCommand command )
 {
-	uObjTxtr* ObjTxtr = (uObjTxtr*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjTxtr* ObjTxtr = (uObjTxtr*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 	if( ObjTxtr->block.type == S2DEX_OBJLT_TLUT )
 	{
 		uObjTxtrTLUT *ObjTlut = (uObjTxtrTLUT*)ObjTxtr;
@@ -502,7 +502,7 @@ inline void DLParser_Yoshi_MemRect( MicroCodeCommand command )
 	// Fetch the next two instructions
 	//
 	u32 pc = gDlistStack.address[gDlistStackPointer];
-	u32 * pCmdBase = (u32 *)( g_pu8RamBase + pc );
+	u32 * pCmdBase = (u32 *)( g_pu8GfxRamBase + pc );
 	gDlistStack.address[gDlistStackPointer]+= 16;
 
 	RDP_MemRect mem_rect;
@@ -525,8 +525,8 @@ inline void DLParser_Yoshi_MemRect( MicroCodeCommand command )
 #if 1	//1->Optimized, 0->Generic
 	// This assumes Yoshi always copy 16 bytes per line and dst is aligned and we force alignment on src!!! //Corn
 	u32 tex_width = rdp_tile.line << 3;
-	uintptr_t texaddr = ((uintptr_t)g_pu8RamBase + tile_addr + tex_width * (mem_rect.s >> 5) + (mem_rect.t >> 5) + 3) & ~3;
-	uintptr_t fbaddr = (uintptr_t)g_pu8RamBase + g_CI.Address + x0;
+	uintptr_t texaddr = ((uintptr_t)g_pu8GfxRamBase + tile_addr + tex_width * (mem_rect.s >> 5) + (mem_rect.t >> 5) + 3) & ~3;
+	uintptr_t fbaddr = (uintptr_t)g_pu8GfxRamBase + g_CI.Address + x0;
 	for (u32 y = y0; y < y1; y++)
 	{
 		u32 *src = (u32*)(texaddr + (y - y0) * tex_width);
@@ -536,19 +536,21 @@ inline void DLParser_Yoshi_MemRect( MicroCodeCommand command )
 		dst[1] = src[1];
 		dst[2] = src[2];
 		dst[3] = src[3];
+		GraphicsTask_RamWritten( g_CI.Address + x0 + y * g_CI.Width, 16 );
 	}
 #else
 	u32	x1 = mem_rect.x1;
 	u32 width = x1 - x0;
 	u32 tex_width = rdp_tile.line << 3;
-	u8 * texaddr = g_pu8RamBase + tile_addr + tex_width * (mem_rect.s >> 5) + (mem_rect.t >> 5);
-	u8 * fbaddr = g_pu8RamBase + g_CI.Address + x0;
+	u8 * texaddr = g_pu8GfxRamBase + tile_addr + tex_width * (mem_rect.s >> 5) + (mem_rect.t >> 5);
+	u8 * fbaddr = g_pu8GfxRamBase + g_CI.Address + x0;
 
 	for (u32 y = y0; y < y1; y++)
 	{
 		u8 *src = texaddr + (y - y0) * tex_width;
 		u8 *dst = fbaddr + y * g_CI.Width;
 		memcpy(dst, src, width);
+		GraphicsTask_RamWritten( g_CI.Address + x0 + y * g_CI.Width, width );
 	}
 #endif
 
@@ -584,13 +586,14 @@ void DLParser_OB_YUV(const uObjSprite *sprite)
 	if (lr_y > ci_height)	
 		height = ci_height - ul_y;
 
-	u32 * mb = (u32*)(g_pu8RamBase + g_TI.Address); //pointer to the first macro block
-	u16 * dst = (u16*)(g_pu8RamBase + g_CI.Address);
+	u32 * mb = (u32*)(g_pu8GfxRamBase + g_TI.Address); //pointer to the first macro block
+	u16 * dst = (u16*)(g_pu8GfxRamBase + g_CI.Address);
 	dst += ul_x + ul_y * ci_width;
 
 	//yuv macro block contains 16x16 texture. we need to put it in the proper place inside cimg
 	for (u16 h = 0; h < 16; h++)
 	{
+		const u16 * row = dst;
 		for (u16 w = 0; w < 16; w+=2)
 		{
 			u32 t = *(mb++); //each u32 contains 2 pixels
@@ -604,6 +607,7 @@ void DLParser_OB_YUV(const uObjSprite *sprite)
 				*(dst++) = YUVtoRGBA(y1, u, v);
 			}
 		}
+		GraphicsTask_RamWritten( u32( (const u8 *)row - g_pu8GfxRamBase ), u32( (const u8 *)dst - (const u8 *)row ) );
 		dst += ci_width - 16;
 	}
 }
@@ -647,7 +651,7 @@ void DLParser_S2DEX_SelectDl( MicroCodeCommand command )
 void DLParser_S2DEX_BgCopy( MicroCodeCommand command )
 {
 	DL_PF("    DLParser_S2DEX_BgCopy");
-	uObjBg *objBg = (uObjBg*)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjBg *objBg = (uObjBg*)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 
 	u16 imageX = objBg->imageX >> 5;
 	u16 imageY = objBg->imageY >> 5;
@@ -690,7 +694,7 @@ void DLParser_S2DEX_Bg1cyc( MicroCodeCommand command )
 	if( g_ROM.GameHacks == ZELDA_MM )
 		return;
 
-	uObjScaleBg *objBg = (uObjScaleBg *)(g_pu8RamBase + RDPSegAddr(command.inst.cmd1));
+	uObjScaleBg *objBg = (uObjScaleBg *)(g_pu8GfxRamBase + RDPSegAddr(command.inst.cmd1));
 
 	f32 frameX = objBg->frameX / 4.0f;
 	f32 frameY = objBg->frameY / 4.0f;
@@ -50,7 +50,7 @@ void DLParser_GBI0_Vtx_SOTE( MicroCodeCommand command )
 void DLParser_GBI0_Line3D_SOTE( MicroCodeCommand command )
 {
 	u32 pc = gDisplayListStack.back().addr;
-	u32 * pCmdBase = (u32 *)(g_pu8RamBase + pc);
+	u32 * pCmdBase = (u32 *)(g_pu8GfxRamBase + pc);
 
 	bool tris_added = false;
 
@@ -68,8 +68,8 @@ void DLParser_GBI0_Line3D_SOTE( MicroCodeCommand command )
 
 		tris_added |= gRenderer->AddTri(v3_idx, v4_idx, v5_idx);
 
-		command.inst.cmd0			= *(u32 *)(g_pu8RamBase + pc+0);
-		command.inst.cmd1			= *(u32 *)(g_pu8RamBase + pc+4);
+		command.inst.cmd0			= *(u32 *)(g_pu8GfxRamBase + pc+0);
+		command.inst.cmd1			= *(u32 *)(g_pu8GfxRamBase + pc+4);
 		pc += 8;
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
@@ -94,7 +94,7 @@ void DLParser_GBI0_Line3D_SOTE( MicroCodeCommand command )
 void DLParser_GBI0_Tri1_SOTE( MicroCodeCommand command )
 {
 	u32 pc = gDisplayListStack.back().addr;
-	u32 * pCmdBase = (u32 *)( g_pu8RamBase + pc );
+	u32 * pCmdBase = (u32 *)( g_pu8GfxRamBase + pc );
 
 	bool tris_added = false;
 
@@ -107,8 +107,8 @@ void DLParser_GBI0_Tri1_SOTE( MicroCodeCommand command )
 
 		tris_added |= gRenderer->AddTri(v0_idx, v1_idx, v2_idx);
 
-		command.inst.cmd0			= *(u32 *)(g_pu8RamBase + pc+0);
-		command.inst.cmd1			= *(u32 *)(g_pu8RamBase + pc+4);
+		command.inst.cmd0			= *(u32 *)(g_pu8GfxRamBase + pc+0);
+		command.inst.cmd1			= *(u32 *)(g_pu8GfxRamBase + pc+4);
 		pc += 8;
 
 #ifdef DAEDALUS_DEBUG_DISPLAYLIST
@@ -9,6 +9,12 @@
 #include <pspvfpu.h>
 #endif
 
+#if defined(DAEDALUS_SIMD_MATRIX) && defined(__SSE2__)
+#include <xmmintrin.h>
+#elif defined(DAEDALUS_SIMD_MATRIX)
+#include <arm_neon.h>
+#endif
+
 // http://forums.ps2dev.org/viewtopic.php?t=5557
 // http://bradburn.net/mr.mr/vfpu.html
 
@@ -105,6 +111,91 @@ void myApplyMatrix(v4 *v_out, const Matrix4x4 *mat, const v4 *v_in)
 		"sv.q   R200, 0x0(%0)\n"
 	: : "r" (v_out) , "r" (mat) ,"r" (v_in) );
 }*/
+#elif defined(DAEDALUS_SIMD_MATRIX)
+
+//
+//	Each row of the result is a sum of the rows of mat_b, scaled by the
+//	elements of the same row of mat_a. The sums are done in the same order as
+//	the scalar code, so SSE gives identical results. All of mat_b is loaded
+//	before anything is stored, and each row of mat_a is read before that row
+//	of the result is written, so m_out can be either input (the matrix stack
+//	multiplies in place).
+//
+namespace
+{
+#if defined(__SSE2__)
+typedef __m128		VecF;
+
+inline VecF Splat( float x )					{ return _mm_set1_ps( x ); }
+inline VecF Add( VecF a, VecF b )				{ return _mm_add_ps( a, b ); }
+inline VecF Mul( VecF a, VecF b )				{ return _mm_mul_ps( a, b ); }
+inline VecF LoadA( const float * p )			{ return _mm_load_ps( p ); }
+inline VecF LoadU( const float * p )			{ return _mm_loadu_ps( p ); }
+inline void StoreA( float * p, VecF a )			{ _mm_store_ps( p, a ); }
+inline void StoreU( float * p, VecF a )			{ _mm_storeu_ps( p, a ); }
+#else
+typedef float32x4_t	VecF;
+
+inline VecF Splat( float x )					{ return vdupq_n_f32( x ); }
+inline VecF Add( VecF a, VecF b )				{ return vaddq_f32( a, b ); }
+inline VecF Mul( VecF a, VecF b )				{ return vmulq_f32( a, b ); }
+inline VecF LoadA( const float * p )			{ return vld1q_f32( p ); }
+inline VecF LoadU( const float * p )			{ return vld1q_f32( p ); }
+inline void StoreA( float * p, VecF a )			{ vst1q_f32( p, a ); }
+inline void StoreU( float * p, VecF a )			{ vst1q_f32( p, a ); }
+#endif
+
+template< bool aligned > inline VecF Load( const float * p )	{ return aligned ? LoadA( p ) : LoadU( p ); }
+template< bool aligned > inline void Store( float * p, VecF a )	{ if( aligned ) StoreA( p, a ); else StoreU( p, a ); }
+
+template< bool aligned >
+inline void MatrixMultiply( Matrix4x4 * m_out, const Matrix4x4 * mat_a, const Matrix4x4 * mat_b )
+{
+	const VecF	b0( Load< aligned >( mat_b->m[ 0 ] ) );
+	const VecF	b1( Load< aligned >( mat_b->m[ 1 ] ) );
+	const VecF	b2( Load< aligned >( mat_b->m[ 2 ] ) );
+	const VecF	b3( Load< aligned >( mat_b->m[ 3 ] ) );
+
+	for ( u32 i = 0; i < 4; ++i )
+	{
+		const float *	a( mat_a->m[ i ] );
+
+		VecF	r( Mul( Splat( a[ 0 ] ), b0 ) );
+		r = Add( r, Mul( Splat( a[ 1 ] ), b1 ) );
+		r = Add( r, Mul( Splat( a[ 2 ] ), b2 ) );
+		r = Add( r, Mul( Splat( a[ 3 ] ), b3 ) );
+
+		Store< aligned >( m_out->m[ i ], r );
+	}
+}
+
+// x * row 1 + y * row 2 + z * row 3, as in the scalar transforms
+inline VecF TransformXYZ( const Matrix4x4 & m, float x, float y, float z )
+{
+	VecF	r( Mul( Splat( x ), LoadA( m.m[ 0 ] ) ) );
+	r = Add( r, Mul( Splat( y ), LoadA( m.m[ 1 ] ) ) );
+	r = Add( r, Mul( Splat( z ), LoadA( m.m[ 2 ] ) ) );
+	return r;
+}
+
+inline v3 ToV3( VecF a )
+{
+	v4		r;
+	StoreA( &r.x, a );
+	return v3( r.x, r.y, r.z );
+}
+}
+
+void MatrixMultiplyUnaligned(Matrix4x4 * m_out, const Matrix4x4 *mat_a, const Matrix4x4 *mat_b)
+{
+	MatrixMultiply< false >( m_out, mat_a, mat_b );
+}
+
+void MatrixMultiplyAligned(Matrix4x4 * m_out, const Matrix4x4 *mat_a, const Matrix4x4 *mat_b)
+{
+	MatrixMultiply< true >( m_out, mat_a, mat_b );
+}
+
 #else // DAEDALUS_PSP_USE_VFPU
 
 
@@ -188,6 +279,32 @@ Matrix4x4 & Matrix4x4::SetRotateZ( float angle )
 	return *this;
 }
 
+#ifdef DAEDALUS_SIMD_MATRIX
+
+v3 Matrix4x4::TransformCoord( const v3 & vec ) const
+{
+	return ToV3( Add( TransformXYZ( *this, vec.x, vec.y, vec.z ), LoadA( m[ 3 ] ) ) );
+}
+
+v3 Matrix4x4::TransformNormal( const v3 & vec ) const
+{
+	return ToV3( TransformXYZ( *this, vec.x, vec.y, vec.z ) );
+}
+
+v4 Matrix4x4::Transform( const v4 & vec ) const
+{
+	v4		r;
+	StoreA( &r.x, Add( TransformXYZ( *this, vec.x, vec.y, vec.z ), Mul( Splat( vec.w ), LoadA( m[ 3 ] ) ) ) );
+	return r;
+}
+
+v3 Matrix4x4::Transform( const v3 & vec ) const
+{
+	v4		trans;
+	StoreA( &trans.x, Add( TransformXYZ( *this, vec.x, vec.y, vec.z ), LoadA( m[ 3 ] ) ) );
+
+#else
+
 v3 Matrix4x4::TransformCoord( const v3 & vec ) const
 {
 	return v3( vec.x * m11 + vec.y * m21 + vec.z * m31 + m41,
@@ -217,6 +334,8 @@ v3 Matrix4x4::Transform( const v3 & vec ) const
 			   vec.x * m13 + vec.y * m23 + vec.z * m33 + m43,
 			   vec.x * m14 + vec.y * m24 + vec.z * m34 + m44 );
 
+#endif // DAEDALUS_SIMD_MATRIX
+
 	if(fabsf(trans.w) > 0.0f)
 	{
 		return v3( trans.x / trans.w, trans.y / trans.w, trans.z / trans.w );
@@ -339,6 +458,9 @@ Matrix4x4 Matrix4x4::operator*( const Matrix4x4 & rhs ) const
 //VFPU
 #ifdef DAEDALUS_PSP
 	MatrixMultiplyUnaligned( &r, this, &rhs );
+//SSE/NEON
+#elif defined(DAEDALUS_SIMD_MATRIX)
+	MatrixMultiplyAligned( &r, this, &rhs );
 //CPU
 #else
 	for ( u32 i = 0; i < 4; ++i )
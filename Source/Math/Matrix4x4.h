@@ -6,6 +6,13 @@
 #include "Vector3.h"
 class v4;
 
+// Multiply and the transforms use SSE/NEON where there is no VFPU. They need the
+// matrix 16 byte aligned, which ALIGNED_TYPE doesn't do for GCC on W32
+#if !defined(DAEDALUS_PSP_USE_VFPU) && (defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)) && \
+	!(defined(DAEDALUS_W32) && defined(__GNUC__))
+#define DAEDALUS_SIMD_MATRIX
+#endif
+
 ALIGNED_TYPE(class, Matrix4x4, 16)
 {
 	public:
@@ -62,6 +69,9 @@ ALIGNED_TYPE(class, Matrix4x4, 16)
 };
 
 DAEDALUS_STATIC_ASSERT( sizeof( Matrix4x4 ) == 16*4 );
+#ifdef DAEDALUS_SIMD_MATRIX
+DAEDALUS_STATIC_ASSERT( alignof( Matrix4x4 ) == 16 );		// Rows are loaded with aligned vector loads
+#endif
 
 extern const Matrix4x4	gMatrixIdentity;
 
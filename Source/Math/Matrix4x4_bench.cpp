@@ -0,0 +1,270 @@
+/*
+Copyright (C) 2001 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Checks the Matrix4x4 multiply and transforms against the plain C++ they
+//	replaced, over random matrices and vectors, including multiplying in place
+//	and from misaligned copies. SSE must match to the bit; NEON is allowed a
+//	few ulp, as the compiler may fuse multiply-adds differently in the two.
+//	Then times the multiply as the G_MTX handlers use it, and Transform.
+//
+
+#include "stdafx.h"
+#include "Math/Matrix4x4.h"
+#include "Math/Vector3.h"
+#include "Math/Vector4.h"
+#include "Utility/Timing.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	const u32	kNumTests = 100000;
+	const u32	kBenchLoops = 10000000;
+#if defined(__SSE2__)
+	const u32	kMaxUlps = 0;
+#else
+	const u32	kMaxUlps = 4;
+#endif
+
+	u32		gState( 0x2468ace1 );
+	u32		gMaxUlps( 0 );
+
+	f32		RandF()
+	{
+		gState = gState * 1664525 + 1013904223;
+		return f32( s32( gState ) >> 8 ) / f32( 1 << 16 );		// -128..128
+	}
+
+	void	RandomMatrix( Matrix4x4 & m )
+	{
+		for( u32 i = 0; i < 16; ++i )
+		{
+			m.mRaw[ i ] = RandF();
+		}
+	}
+
+	//
+	//	The scalar code
+	//
+	void	RefMultiply( Matrix4x4 & r, const Matrix4x4 & a, const Matrix4x4 & b )
+	{
+		for ( u32 i = 0; i < 4; ++i )
+		{
+			for ( u32 j = 0; j < 4; ++j )
+			{
+				r.m[ i ][ j ] = a.m[ i ][ 0 ] * b.m[ 0 ][ j ] +
+								a.m[ i ][ 1 ] * b.m[ 1 ][ j ] +
+								a.m[ i ][ 2 ] * b.m[ 2 ][ j ] +
+								a.m[ i ][ 3 ] * b.m[ 3 ][ j ];
+			}
+		}
+	}
+
+	v4		RefTransform( const Matrix4x4 & m, const v4 & vec )
+	{
+		return v4( vec.x * m.m11 + vec.y * m.m21 + vec.z * m.m31 + vec.w * m.m41,
+				   vec.x * m.m12 + vec.y * m.m22 + vec.z * m.m32 + vec.w * m.m42,
+				   vec.x * m.m13 + vec.y * m.m23 + vec.z * m.m33 + vec.w * m.m43,
+				   vec.x * m.m14 + vec.y * m.m24 + vec.z * m.m34 + vec.w * m.m44 );
+	}
+
+	v3		RefTransformNormal( const Matrix4x4 & m, const v3 & vec )
+	{
+		return v3( vec.x * m.m11 + vec.y * m.m21 + vec.z * m.m31,
+				   vec.x * m.m12 + vec.y * m.m22 + vec.z * m.m32,
+				   vec.x * m.m13 + vec.y * m.m23 + vec.z * m.m33 );
+	}
+
+	v3		RefTransformCoord( const Matrix4x4 & m, const v3 & vec )
+	{
+		return v3( vec.x * m.m11 + vec.y * m.m21 + vec.z * m.m31 + m.m41,
+				   vec.x * m.m12 + vec.y * m.m22 + vec.z * m.m32 + m.m42,
+				   vec.x * m.m13 + vec.y * m.m23 + vec.z * m.m33 + m.m43 );
+	}
+
+	v3		RefTransform( const Matrix4x4 & m, const v3 & vec )
+	{
+		v4	trans( RefTransform( m, v4( vec.x, vec.y, vec.z, 1.0f ) ) );
+		if( fabsf( trans.w ) > 0.0f )
+		{
+			return v3( trans.x / trans.w, trans.y / trans.w, trans.z / trans.w );
+		}
+		return v3( trans.x, trans.y, trans.z );
+	}
+
+	//
+	//	Comparisons
+	//
+	u32		UlpDiff( f32 a, f32 b )
+	{
+		s32		ia, ib;
+		memcpy( &ia, &a, 4 );
+		memcpy( &ib, &b, 4 );
+		if( ia < 0 ) ia = s32( 0x80000000 ) - ia;
+		if( ib < 0 ) ib = s32( 0x80000000 ) - ib;
+		return ia > ib ? u32( ia - ib ) : u32( ib - ia );
+	}
+
+	bool	Same( const f32 * a, const f32 * b, u32 n )
+	{
+		u32		worst( 0 );
+		for( u32 i = 0; i < n; ++i )
+		{
+			u32		diff( UlpDiff( a[ i ], b[ i ] ) );
+			worst = diff > worst ? diff : worst;
+		}
+		gMaxUlps = worst > gMaxUlps ? worst : gMaxUlps;
+		return worst <= kMaxUlps;
+	}
+
+	bool	Same( const Matrix4x4 & a, const Matrix4x4 & b )	{ return Same( a.mRaw, b.mRaw, 16 ); }
+	bool	Same( const v4 & a, const v4 & b )					{ return Same( &a.x, &b.x, 4 ); }
+	bool	Same( const v3 & a, const v3 & b )					{ return Same( &a.x, &b.x, 3 ); }
+
+	u32		Check()
+	{
+		u32		failures( 0 );
+		u8		buffer[ 3 * sizeof( Matrix4x4 ) + 16 ];
+
+		for( u32 t = 0; t < kNumTests; ++t )
+		{
+			Matrix4x4	a, b, expected, actual;
+			RandomMatrix( a );
+			RandomMatrix( b );
+			RefMultiply( expected, a, b );
+
+			const char *	failed( nullptr );
+
+			MatrixMultiplyAligned( &actual, &a, &b );
+			if( !Same( expected, actual ) )		failed = "MatrixMultiplyAligned";
+
+			actual = a * b;
+			if( !Same( expected, actual ) )		failed = "operator*";
+
+			// The matrix stack multiplies in place, either way round
+			actual = a;
+			MatrixMultiplyAligned( &actual, &actual, &b );
+			if( !Same( expected, actual ) )		failed = "MatrixMultiplyAligned (out == a)";
+
+			actual = b;
+			MatrixMultiplyAligned( &actual, &a, &actual );
+			if( !Same( expected, actual ) )		failed = "MatrixMultiplyAligned (out == b)";
+
+			// Copies at a 4 byte alignment
+			Matrix4x4 *	ua( reinterpret_cast< Matrix4x4 * >( buffer + 4 ) );
+			Matrix4x4 *	ub( reinterpret_cast< Matrix4x4 * >( buffer + 4 + sizeof( Matrix4x4 ) ) );
+			Matrix4x4 *	ur( reinterpret_cast< Matrix4x4 * >( buffer + 4 + 2 * sizeof( Matrix4x4 ) ) );
+			memcpy( ua->mRaw, a.mRaw, sizeof( a.mRaw ) );
+			memcpy( ub->mRaw, b.mRaw, sizeof( b.mRaw ) );
+			MatrixMultiplyUnaligned( ur, ua, ub );
+			memcpy( actual.mRaw, ur->mRaw, sizeof( actual.mRaw ) );
+			if( !Same( expected, actual ) )		failed = "MatrixMultiplyUnaligned";
+
+			v4		v4_in( RandF(), RandF(), RandF(), RandF() );
+			v3		v3_in( RandF(), RandF(), RandF() );
+
+			if( !Same( RefTransform( a, v4_in ), a.Transform( v4_in ) ) )				failed = "Transform (v4)";
+			if( !Same( RefTransform( a, v3_in ), a.Transform( v3_in ) ) )				failed = "Transform (v3)";
+			if( !Same( RefTransformNormal( a, v3_in ), a.TransformNormal( v3_in ) ) )	failed = "TransformNormal";
+			if( !Same( RefTransformCoord( a, v3_in ), a.TransformCoord( v3_in ) ) )	failed = "TransformCoord";
+
+			if( failed != nullptr && failures++ < 4 )
+			{
+				printf( "  %s mismatch, test %u\n", failed, t );
+			}
+		}
+
+		return failures;
+	}
+
+	f64		Seconds( u64 start, u64 end )
+	{
+		u64		freq( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+		return f64( end - start ) / f64( freq );
+	}
+}
+
+int main()
+{
+#ifdef DAEDALUS_SIMD_MATRIX
+	const char *	name( "SIMD" );
+#else
+	const char *	name( "scalar" );
+#endif
+
+	u32		failures( Check() );
+	printf( "%s matrix code: %s (worst %u ulp)\n\n", name, failures == 0 ? "matches scalar" : "MISMATCH", gMaxUlps );
+
+	// A model view stack push, multiplying by the new matrix. A rotation keeps the values bounded.
+	Matrix4x4	rx, ry, m, stack[ 2 ];
+	rx.SetRotateX( 0.7f );
+	ry.SetRotateY( 0.3f );
+	RefMultiply( m, rx, ry );
+	RandomMatrix( stack[ 0 ] );
+	RandomMatrix( stack[ 1 ] );
+
+	u64		start( 0 ), end( 0 );
+	NTiming::GetPreciseTime( &start );
+	for( u32 i = 0; i < kBenchLoops; ++i )
+	{
+		RefMultiply( stack[ i & 1 ], m, stack[ (i + 1) & 1 ] );
+	}
+	NTiming::GetPreciseTime( &end );
+	const f64	ref_mul( Seconds( start, end ) );
+
+	NTiming::GetPreciseTime( &start );
+	for( u32 i = 0; i < kBenchLoops; ++i )
+	{
+		MatrixMultiplyAligned( &stack[ i & 1 ], &m, &stack[ (i + 1) & 1 ] );
+	}
+	NTiming::GetPreciseTime( &end );
+	const f64	mul( Seconds( start, end ) );
+
+	v4		v( RandF(), RandF(), RandF(), 1.0f );
+	NTiming::GetPreciseTime( &start );
+	for( u32 i = 0; i < kBenchLoops; ++i )
+	{
+		v = RefTransform( m, v );
+	}
+	NTiming::GetPreciseTime( &end );
+	const f64	ref_transform( Seconds( start, end ) );
+	const f32	ref_v( v.x );
+
+	v = v4( RandF(), RandF(), RandF(), 1.0f );
+	NTiming::GetPreciseTime( &start );
+	for( u32 i = 0; i < kBenchLoops; ++i )
+	{
+		v = m.Transform( v );
+	}
+	NTiming::GetPreciseTime( &end );
+	const f64	transform( Seconds( start, end ) );
+
+	printf( "%-12s %12s %12s %9s\n", "op", "scalar ns", name, "speedup" );
+	printf( "%-12s %12.2f %12.2f %8.2fx\n", "multiply", ref_mul * 1e9 / kBenchLoops, mul * 1e9 / kBenchLoops, ref_mul / mul );
+	printf( "%-12s %12.2f %12.2f %8.2fx\n", "transform", ref_transform * 1e9 / kBenchLoops, transform * 1e9 / kBenchLoops, ref_transform / transform );
+
+	// Keep the results live
+	printf( "\n(%g %g %g)\n", stack[ 0 ].m11, ref_v, v.x );
+
+	return failures == 0 ? 0 : 1;
+}
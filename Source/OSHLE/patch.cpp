@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "OSMesgQueue.h"
 
 #include "Config/ConfigOptions.h"
+#include "Core/AudioTask.h"
 #include "Core/CPU.h"
 #include "Core/DMA.h"
 #include "Core/Memory.h"
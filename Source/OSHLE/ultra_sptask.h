@@ -22,29 +22,31 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Utility/DaedalusTypes.h"
 
+// NB: Pointer fields are N64 addresses, so they're stored as u32 to keep the
+// structure layout identical to DMEM on 64 bit hosts.
 typedef struct {
 	u32	type;
 	u32	flags;
 
-	u64	*ucode_boot;
+	u32	ucode_boot;
 	u32	ucode_boot_size;
 
-	u64	*ucode;
+	u32	ucode;
 	u32	ucode_size;
 
-	u64	*ucode_data;
+	u32	ucode_data;
 	u32	ucode_data_size;
 
-	u64	*dram_stack;
+	u32	dram_stack;
 	u32	dram_stack_size;
 
-	u64	*output_buff;
-	u64	*output_buff_size;
+	u32	output_buff;
+	u32	output_buff_size;
 
-	u64	*data_ptr;
+	u32	data_ptr;
 	u32	data_size;
 
-	u64	*yield_data_ptr;
+	u32	yield_data_ptr;
 	u32	yield_data_size;
 
 } OSTask_t;
@@ -31,6 +31,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #define CODE_BUFFER_SIZE (8 * 1024 * 1024)
 
+// Room for the largest fragment, a MAX_TRACE_LENGTH trace plus its exit stubs
+#define CODE_BUFFER_HEADROOM (1024 * 1024)
+
 class CCodeBufferManagerARM : public CCodeBufferManager
 {
 public:
@@ -50,6 +53,7 @@ public:
 
 	virtual CCodeGenerator *StartNewBlock();
 	virtual u32				FinaliseCurrentBlock();
+	virtual bool			IsNearlyFull() const;
 
 private:
 
@@ -158,6 +162,10 @@ u32 CCodeBufferManagerARM::FinaliseCurrentBlock()
 	mBufferPtr += main_block_size;
 	mSecondBufferPtr += mSecondaryBuffer.GetSize();
 
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( mBufferPtr <= CODE_BUFFER_SIZE && mSecondBufferPtr <= CODE_BUFFER_SIZE, "Dynarec code buffer overflow" );
+	#endif
+
 	#if 0 //Second buffer is currently unused
 	mSecondBufferPtr += mSecondaryBuffer.GetSize();
 	mSecondBufferPtr = ((mSecondBufferPtr - 1) & 0xfffffff0) + 0x10; // align to 16-byte boundary
@@ -169,3 +177,12 @@ u32 CCodeBufferManagerARM::FinaliseCurrentBlock()
 	
 	return main_block_size;
 }
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CCodeBufferManagerARM::IsNearlyFull() const
+{
+	return mBufferPtr + CODE_BUFFER_HEADROOM > CODE_BUFFER_SIZE ||
+		   mSecondBufferPtr + CODE_BUFFER_HEADROOM > CODE_BUFFER_SIZE;
+}
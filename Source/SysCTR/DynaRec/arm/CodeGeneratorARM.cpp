@@ -898,7 +898,7 @@ EArmReg	CCodeGeneratorARM::GetRegisterAndLoad(EN64Reg n64_reg, u32 lo_hi_idx, EA
 //*****************************************************************************
 //
 //*****************************************************************************
-CJumpLocation CCodeGeneratorARM::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment )
+CJumpLocation CCodeGeneratorARM::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment, CCodeLabel * p_fallback )
 {
 	//DAEDALUS_ASSERT( exit_address != u32( ~0 ), "Invalid exit address" );
 	DAEDALUS_ASSERT( !next_fragment.IsSet() || jump_address == 0, "Shouldn't be specifying a jump address if we have a next fragment?" );
@@ -990,6 +990,7 @@ CJumpLocation CCodeGeneratorARM::GenerateExitCode( u32 exit_address, u32 jump_ad
 	CJumpLocation jump_to_next_fragment = BX_IMM( CCodeLabel { nullptr } );
 	
 	CCodeLabel interpret_next_fragment( GetAssemblyBuffer()->GetLabel() );
+	*p_fallback = interpret_next_fragment;
 	// No need to call CPU_SetPC(), as this is handled by CFragment when we exit
 	RET();
 
@@ -51,7 +51,7 @@ class CCodeGeneratorARM : public CCodeGenerator, public CAssemblyWriterARM
 		virtual CCodeLabel			GetCurrentLocation() const;
 		virtual u32					GetCompiledCodeSize() const;
 
-		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment );
+		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment, CCodeLabel * p_fallback );
 		virtual void				GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map );
 		virtual void				GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map );
 
@@ -175,4 +175,14 @@ void AudioOutput::StopAudio()
 	mAudioPlaying = false;
 
 	AudioExit();
+
+#ifdef DAEDALUS_DEBUG_CONSOLE
+	SAudioBufferStats	stats;
+	mAudioBuffer->GetStats( &stats );
+	DBGConsole_Msg( 0, "Audio: %d underruns (%d samples), %d overruns, latency %d-%d samples (avg %d)",
+					stats.Underruns, stats.UnderrunSamples, stats.Overruns,
+					stats.LatencyCount ? stats.LatencyMin : 0, stats.LatencyMax,
+					stats.LatencyCount ? stats.LatencySum / stats.LatencyCount : 0 );
+	mAudioBuffer->ResetStats();
+#endif
 }
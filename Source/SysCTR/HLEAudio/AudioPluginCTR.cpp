@@ -33,36 +33,17 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "HLEAudio/audiohle.h"
 
 #include "Config/ConfigOptions.h"
-#include "Core/CPU.h"
+#include "Core/AudioTask.h"
 #include "Core/Interrupt.h"
 #include "Core/Memory.h"
 #include "Core/ROM.h"
 #include "Core/RSP_HLE.h"
 
-#define RSP_AUDIO_INTR_CYCLES     1
-
 #define DEFAULT_FREQUENCY 44100	// Taken from Mupen64 : )
 
-extern bool isN3DS;
 // FIXME: Hack!
 extern EAudioPluginMode enable_audio;
 
-static bool _runThread = false;
-
-static Thread asyncThread;
-static Handle audioRequest;
-
-static void asyncProcess(void *arg)
-{
-	while(_runThread)
-	{
-		svcWaitSynchronization(audioRequest, U64_MAX);
-		if(_runThread) {
-			Audio_Ucode();
-		}
-	}
-}
-
 //*****************************************************************************
 //
 //*****************************************************************************
@@ -76,14 +57,6 @@ CAudioPluginCTR::CAudioPluginCTR()
 :	mAudioOutput( new AudioOutput )
 {
 	gAudioPluginEnabled = enable_audio;
-
-	if(isN3DS)
-	{
-		_runThread = true;
-
-		svcCreateEvent(&audioRequest, RESET_ONESHOT);
-		asyncThread = threadCreate(asyncProcess, 0, (8 * 1024), 0x18, 2, true);
-	}
 }
 
 //*****************************************************************************
@@ -92,14 +65,6 @@ CAudioPluginCTR::CAudioPluginCTR()
 CAudioPluginCTR::~CAudioPluginCTR()
 {
 	delete mAudioOutput;
-
-	if(isN3DS)
-	{
-		_runThread = false;
-		
-		svcSignalEvent(audioRequest);
-		threadJoin(asyncThread, U64_MAX);
-	}
 }
 
 //*****************************************************************************
@@ -190,18 +155,8 @@ EProcessResult	CAudioPluginCTR::ProcessAList()
 			result = PR_COMPLETED;
 			break;
 		case APM_ENABLED_ASYNC:
-			if (isN3DS)
-			{
-				svcSignalEvent(audioRequest);
-				// PSP async audio adds this event on the current thread after signaling the ME
-				CPU_AddEvent(RSP_AUDIO_INTR_CYCLES, CPU_EVENT_AUDIO);
-				result = PR_STARTED;
-			}
-			else
-			{
-				Audio_Ucode();
-				result = PR_COMPLETED;
-			}
+			// On the audio thread (on the spare core)
+			result = AudioTask_Start();
 			break;
 		case APM_ENABLED_SYNC:
 			Audio_Ucode();
@@ -1,12 +1,15 @@
 #include "stdafx.h"
 #include "RendererCTR.h"
 
+#include <stdio.h>
+
 #include <GL/picaGL.h>
 
 #include "Combiner/BlendConstant.h"
 #include "Combiner/CombinerTree.h"
 #include "Combiner/RenderSettings.h"
 #include "Core/ROM.h"
+#include "Debug/DBGConsole.h"
 #include "Debug/Dump.h"
 #include "Graphics/GraphicsContext.h"
 #include "Graphics/NativeTexture.h"
@@ -166,7 +169,12 @@ static void InitBlenderMode()
 }
 
 RendererCTR::RendererCTR()
+:	mBlendStates( 256 )
+,	mBlendStatesDirty( false )
+,	mLastBlendKey( ~0ULL )
 {
+	mBlendStatesFilename[0] = '\0';
+
 	//
 	//	Set up RGB = T0, A = T0
 	//
@@ -197,10 +205,13 @@ RendererCTR::RendererCTR()
 		mFillBlendStates->AddColourSettings( colour_settings );
 	}
 
+	LoadBlendStates();
 }
 
 RendererCTR::~RendererCTR()
 {
+	SaveBlendStates();
+
 	delete mFillBlendStates;
 	delete mCopyBlendStates;
 }
@@ -252,12 +263,28 @@ RendererCTR::SBlendStateEntry RendererCTR::LookupBlendState( u64 mux, bool two_c
 	// Top 8 bits are never set - use the very top one to differentiate between 1/2 cycles
 	key._u32_1 |= (two_cycles << 31);
 
-	BlendStatesMap::const_iterator	it( mBlendStatesMap.find( key._u64 ) );
-	if( it != mBlendStatesMap.end() )
+	if( key._u64 == mLastBlendKey )
 	{
-		return it->second;
+		return mLastBlendEntry;
 	}
 
+	const SBlendStateEntry * entry( mBlendStates.Find( key._u64 ) );
+	if( entry == NULL )
+	{
+		entry = &mBlendStates.Insert( key._u64, CreateBlendState( key._u64 ) );
+		mBlendStatesDirty = true;
+	}
+
+	mLastBlendKey = key._u64;
+	mLastBlendEntry = *entry;
+	return mLastBlendEntry;
+}
+
+RendererCTR::SBlendStateEntry RendererCTR::CreateBlendState( u64 key ) const
+{
+	const u64	mux( key & ~(u64( 1 ) << 63) );
+	const bool	two_cycles( (key >> 63) != 0 );
+
 	// Blendmodes with Inexact blends either get an Override blend or a Default blend (GU_TFX_MODULATE)
 	// If its not an Inexact blend then we check if we need to Force a blend mode none the less// Salvy
 	//
@@ -279,12 +306,96 @@ RendererCTR::SBlendStateEntry RendererCTR::LookupBlendState( u64 mux, bool two_c
 	printf( "Adding %08x%08x - %d cycles - %s\n", u32(mux>>32), u32(mux), two_cycles ? 2 : 1, entry.States->IsInexact() ?  IsCombinerStateDefault(mux) ? "Inexact(Default)" : "Inexact(Override)" : entry.OverrideFunction==nullptr ? "Auto" : "Forced");
 	#endif
 
-	//Add blend mode to the Blend States Map
-	mBlendStatesMap[ key._u64 ] = entry;
-
 	return entry;
 }
 
+namespace
+{
+	const u32 BLEND_STATES_MAGIC = 0x424c4e31;	// 'BLN1'
+	const u32 BLEND_STATES_VERSION = 1;
+	const u32 MAX_SAVED_BLEND_STATES = 4096;
+}
+
+void RendererCTR::LoadBlendStates()
+{
+	Dump_GetSaveDirectory( mBlendStatesFilename, g_ROM.mFileName, ".bln" );
+
+	FILE * fp( fopen( mBlendStatesFilename, "rb" ) );
+	if( fp == NULL )
+	{
+		return;
+	}
+
+	const RomID &	rom_id( g_ROM.mRomID );
+	u32				header[6];
+	bool			ok( fread( header, sizeof( header ), 1, fp ) == 1 );
+
+	ok = ok && header[0] == BLEND_STATES_MAGIC && header[1] == BLEND_STATES_VERSION;
+	ok = ok && header[2] == rom_id.CRC[0] && header[3] == rom_id.CRC[1] && header[4] == rom_id.CountryID;
+	ok = ok && header[5] <= MAX_SAVED_BLEND_STATES;
+
+	std::vector< u64 >	keys( ok ? header[5] : 0 );
+	ok = ok && (keys.empty() || fread( &keys[0], sizeof( u64 ), keys.size(), fp ) == keys.size());
+	fclose( fp );
+
+	if( !ok )
+	{
+		#ifdef DAEDALUS_DEBUG_CONSOLE
+		DBGConsole_Msg( 0, "Ignoring blend states %s", mBlendStatesFilename );
+		#endif
+		return;
+	}
+
+	// Build them all now rather than the first time each is drawn, when it would cause a hitch
+	for( u32 i = 0; i < keys.size(); ++i )
+	{
+		if( mBlendStates.Find( keys[ i ] ) == NULL )
+		{
+			mBlendStates.Insert( keys[ i ], CreateBlendState( keys[ i ] ) );
+		}
+	}
+
+	#ifdef DAEDALUS_DEBUG_CONSOLE
+	DBGConsole_Msg( 0, "Read %d blend states from %s", u32( keys.size() ), mBlendStatesFilename );
+	#endif
+}
+
+void RendererCTR::SaveBlendStates()
+{
+	if( !mBlendStatesDirty || mBlendStatesFilename[0] == '\0' )
+	{
+		return;
+	}
+
+	typedef CFlatHashMap< SBlendStateEntry >::SSlot SBlendStateSlot;
+
+	const SBlendStateSlot *	slots( mBlendStates.GetSlots() );
+	std::vector< u64 >		keys;
+	for( u32 i = 0; i < mBlendStates.GetCapacity() && keys.size() < MAX_SAVED_BLEND_STATES; ++i )
+	{
+		if( slots[ i ].Used )
+		{
+			keys.push_back( slots[ i ].Key );
+		}
+	}
+
+	FILE * fp( fopen( mBlendStatesFilename, "wb" ) );
+	if( fp != NULL )
+	{
+		const RomID &	rom_id( g_ROM.mRomID );
+		u32				header[6] = { BLEND_STATES_MAGIC, BLEND_STATES_VERSION, rom_id.CRC[0], rom_id.CRC[1], rom_id.CountryID, u32( keys.size() ) };
+
+		fwrite( header, sizeof( header ), 1, fp );
+		if( !keys.empty() )
+		{
+			fwrite( &keys[0], sizeof( u64 ), keys.size(), fp );
+		}
+		fclose( fp );
+	}
+
+	mBlendStatesDirty = false;
+}
+
 void RendererCTR::DrawPrimitives(DaedalusVtxBuffer * p_vertices, u32 triangle_mode, bool has_texture)
 {
 	int offset = (p_vertices->position - gVertexBufferPtr)/3;
@@ -1,10 +1,12 @@
 #pragma once
 
-#include <map>
 #include <set>
+#include <vector>
 
 #include "HLEGraphics/BaseRenderer.h"
 #include "SysCTR/HLEGraphics/BlendModes.h"
+#include "Utility/FlatHashMap.h"
+#include "Utility/IO.h"
 
 class CBlendStates;
 
@@ -56,17 +58,28 @@ private:
 	void				RenderUsingCurrentBlendMode(const float (&mat_project)[16], DaedalusVtxBuffer * p_vertices, u32 triangle_mode, bool disable_zbuffer );
 	void				RenderUsingRenderSettings( const CBlendStates * states, DaedalusVtxBuffer * p_vertices, u32 triangle_mode );
 	void                DrawPrimitives(DaedalusVtxBuffer * p_vertices, u32 triangle_mode, bool has_texture);
+
+	SBlendStateEntry	CreateBlendState( u64 key ) const;
+	void				LoadBlendStates();
+	void				SaveBlendStates();
 	
 	// Temporary vertex storage
-	s32			mVtx_Save[320];
+	s32			mVtx_Save[kMaxBatchVertices];
 	
 	// BlendMode support
 	//
 	CBlendStates *		mCopyBlendStates;
 	CBlendStates *		mFillBlendStates;
 
-	typedef std::map< u64, SBlendStateEntry > BlendStatesMap;
-	BlendStatesMap		mBlendStatesMap;
+	// Blend states for each mux seen. The muxes are saved with the rom's saves,
+	// and their states built up front the next time it runs
+	CFlatHashMap< SBlendStateEntry >	mBlendStates;
+	bool				mBlendStatesDirty;
+	IO::Filename		mBlendStatesFilename;
+
+	// Most draws in a row use the same mux
+	u64					mLastBlendKey;
+	SBlendStateEntry	mLastBlendEntry;
 };
 
 // NB: this is equivalent to gRenderer, but points to the implementation class, for platform-specific functionality.
@@ -0,0 +1,50 @@
+#include "stdafx.h"
+#include "Utility/Cond.h"
+#include "Utility/Mutex.h"
+
+#include <3ds.h>
+#include <stdlib.h>
+
+const double kTimeoutInfinity = 0.f;
+
+// The kernel has no condition variable, so this is a one-shot event. The
+// mutex is released before waiting rather than atomically, but a signal sent
+// in between leaves the event set, so the waiter still wakes. Several signals
+// with nobody waiting only wake one thread, so waiters should recheck what
+// they're waiting for (as with any Cond).
+
+Cond * CondCreate()
+{
+	Handle * event = (Handle *)malloc( sizeof(Handle) );
+	if (!event)
+	{
+		return NULL;
+	}
+
+	if (R_FAILED( svcCreateEvent( event, RESET_ONESHOT ) ))
+	{
+		free( event );
+		return NULL;
+	}
+	return (Cond *)event;
+}
+
+void CondDestroy(Cond * cond)
+{
+	svcCloseHandle( *(Handle *)cond );
+	free( cond );
+}
+
+void CondWait(Cond * cond, Mutex * mutex, double timeout)
+{
+	s64 wait_ns = (timeout <= 0) ? (s64)U64_MAX : (s64)(timeout * 1000000000.0);
+
+	mutex->Unlock();
+	svcWaitSynchronization( *(Handle *)cond, wait_ns );
+	mutex->Lock();
+}
+
+void CondSignal(Cond * cond)
+{
+	svcSignalEvent( *(Handle *)cond );
+}
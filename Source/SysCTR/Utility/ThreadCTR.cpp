@@ -49,15 +49,26 @@ static void StartThreadFunc(  void *argp )
 {
 	SDaedThreadDetails * thread_details( static_cast< SDaedThreadDetails * >( argp ) );
 	thread_details->ThreadFunction( thread_details->Argument );
+
+	delete thread_details;
 }
 
-ThreadHandle CreateThread( const char * name, DaedThread function, void * argument )
+ThreadHandle CreateThread( const char * name, DaedThread function, void * argument, s32 core )
 {
-	SDaedThreadDetails thread_details( function, argument );
+	// The details must outlive this call, as the thread may not have started yet
+	SDaedThreadDetails * thread_details = new SDaedThreadDetails( function, argument );
+
+	// -2 is the core the application was started on
+	s32 core_id = (core == kThreadDefaultCore) ? -2 : core;
 
-	Thread thid = threadCreate(StartThreadFunc, &thread_details, 0x10000, gThreadPriorities[TP_NORMAL], -2, false);
+	Thread thid = threadCreate(StartThreadFunc, thread_details, 0x10000, gThreadPriorities[TP_NORMAL], core_id, false);
+	if( !thid )
+	{
+		delete thread_details;
+		return kInvalidThreadHandle;
+	}
 
-	return thid ? (ThreadHandle)thid : kInvalidThreadHandle;
+	return (ThreadHandle)thid;
 }
 
 void SetThreadPriority( s32 handle, EThreadPriority pri )
@@ -81,7 +92,7 @@ bool JoinThread( s32 handle, s32 timeout )
 
 void ThreadSleepMs( u32 ms )
 {
-	svcSleepThread( ms * 1000 );		// Delay is specified in microseconds
+	svcSleepThread( u64( ms ) * 1000000 );		// Delay is specified in nanoseconds
 }
 
 void ThreadSleepTicks( u32 ticks )
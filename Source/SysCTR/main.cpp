@@ -10,6 +10,7 @@
 #include "Core/Cheats.h"
 #include "Core/CPU.h"
 #include "Core/CPU.h"
+#include "Core/GraphicsTask.h"
 #include "Core/Memory.h"
 #include "Core/PIF.h"
 #include "Core/RomSettings.h"
@@ -65,7 +66,7 @@ static void Initialize()
 	
 	APT_CheckNew3DS(&isN3DS);
 	osSetSpeedupEnable(true);
-	// only the N3DS supports async audio
+	// Only the N3DS has a spare core for the audio thread
 	enable_audio = isN3DS ? APM_ENABLED_ASYNC : APM_ENABLED_SYNC;
 
 	gfxInit(GSP_BGR8_OES, GSP_BGR8_OES, true);
@@ -31,6 +31,11 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #define DAEDALUS_ENDIAN_MODE DAEDALUS_ENDIAN_LITTLE
 
+// The dynarec backend lives in SysPosix/DynaRec/x64
+#if defined(__x86_64__)
+#define DAEDALUS_ENABLE_DYNAREC
+#endif
+
 #ifdef __GNUC__
 #define DAEDALUS_EXPECT_LIKELY(c) __builtin_expect((c),1)
 #define DAEDALUS_EXPECT_UNLIKELY(c) __builtin_expect((c),0)
@@ -38,8 +43,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define DAEDALUS_ATTRIBUTE_NOINLINE __attribute__((noinline))
 #endif
 
+#ifndef __has_feature
+#define __has_feature(x) 0
+#endif
+
 #define DAEDALUS_HALT			__builtin_trap()
 //#define DAEDALUS_HALT			__builtin_debugger()
+
+// The headless build swaps SysGL for the null graphics/audio/input layer in SysNull
+#ifndef DAEDALUS_HEADLESS
 #define DAEDALUS_GL
+#endif
 
 #endif // SYSLINUX_INCLUDE_PLATFORM_H_
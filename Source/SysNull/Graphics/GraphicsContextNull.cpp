@@ -0,0 +1,147 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+
+#include <stdlib.h>
+
+#include "Graphics/GraphicsContext.h"
+#include "Graphics/ColourValue.h"
+#include "SysNull/Null.h"
+
+static const u32 SCR_WIDTH  = 640;
+static const u32 SCR_HEIGHT = 480;
+
+// Same sizes as the CTR linear buffers - enough for the busiest frames we've seen.
+static const u32 kVertexBufferBytes   = 0x600000;
+static const u32 kColorBufferBytes    = 0x200000;
+static const u32 kTexCoordBufferBytes = 0x600000;
+
+float *		gVertexBuffer      = nullptr;
+u32 *		gColorBuffer       = nullptr;
+float *		gTexCoordBuffer    = nullptr;
+float *		gVertexBufferPtr   = nullptr;
+u32 *		gColorBufferPtr    = nullptr;
+float *		gTexCoordBufferPtr = nullptr;
+
+class GraphicsContextNull : public CGraphicsContext
+{
+public:
+	GraphicsContextNull();
+	virtual ~GraphicsContextNull();
+
+	virtual bool Initialise();
+	virtual bool IsInitialised() const				{ return mInitialised; }
+
+	virtual void SwitchToChosenDisplay()			{}
+	virtual void SwitchToLcdDisplay()				{}
+	virtual void StoreSaveScreenData()				{}
+
+	virtual void ClearAllSurfaces()					{}
+	virtual void ClearToBlack()						{}
+	virtual void ClearZBuffer()						{}
+	virtual void ClearColBuffer(const c32 & colour)	{}
+	virtual void ClearColBufferAndDepth(const c32 & colour) {}
+
+	virtual	void BeginFrame();
+	virtual void EndFrame()							{}
+	virtual void UpdateFrame( bool wait_for_vbl );
+
+	virtual void GetScreenSize(u32 * width, u32 * height) const;
+	virtual void ViewportType(u32 * width, u32 * height) const;
+
+	virtual void SetDebugScreenTarget( ETargetSurface buffer ) {}
+	virtual void DumpNextScreen()					{}
+	virtual void DumpScreenShot()					{}
+
+private:
+	void		ResetVertexBuffers();
+
+private:
+	bool		mInitialised;
+};
+
+template<> bool CSingleton< CGraphicsContext >::Create()
+{
+	DAEDALUS_ASSERT_Q(mpInstance == nullptr);
+
+	mpInstance = new GraphicsContextNull();
+	return mpInstance->Initialise();
+}
+
+GraphicsContextNull::GraphicsContextNull()
+:	mInitialised( false )
+{
+}
+
+GraphicsContextNull::~GraphicsContextNull()
+{
+	free( gVertexBufferPtr );
+	free( gColorBufferPtr );
+	free( gTexCoordBufferPtr );
+
+	gVertexBufferPtr = gVertexBuffer = nullptr;
+	gColorBufferPtr = gColorBuffer = nullptr;
+	gTexCoordBufferPtr = gTexCoordBuffer = nullptr;
+}
+
+bool GraphicsContextNull::Initialise()
+{
+	gVertexBufferPtr   = static_cast< float * >( malloc( kVertexBufferBytes ) );
+	gColorBufferPtr    = static_cast< u32 * >( malloc( kColorBufferBytes ) );
+	gTexCoordBufferPtr = static_cast< float * >( malloc( kTexCoordBufferBytes ) );
+
+	if( gVertexBufferPtr == nullptr || gColorBufferPtr == nullptr || gTexCoordBufferPtr == nullptr )
+		return false;
+
+	ResetVertexBuffers();
+
+	mInitialised = true;
+	return true;
+}
+
+void GraphicsContextNull::ResetVertexBuffers()
+{
+	gVertexBuffer   = gVertexBufferPtr;
+	gColorBuffer    = gColorBufferPtr;
+	gTexCoordBuffer = gTexCoordBufferPtr;
+}
+
+void GraphicsContextNull::BeginFrame()
+{
+	// The null renderer consumes vertices as soon as they're flushed, so
+	// unlike CTR it's safe to rewind the streams at the start of every display list.
+	ResetVertexBuffers();
+}
+
+void GraphicsContextNull::UpdateFrame( bool wait_for_vbl )
+{
+	ResetVertexBuffers();
+}
+
+void GraphicsContextNull::GetScreenSize(u32 * width, u32 * height) const
+{
+	*width  = SCR_WIDTH;
+	*height = SCR_HEIGHT;
+}
+
+void GraphicsContextNull::ViewportType(u32 * width, u32 * height) const
+{
+	GetScreenSize( width, height );
+}
@@ -0,0 +1,133 @@
+/*
+Copyright (C) 2013 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Graphics/NativeTexture.h"
+#include "Graphics/NativePixelFormat.h"
+
+#include "Math/MathUtil.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+//	Textures are kept in host memory only. Conversion and hashing still run
+//	through CachedTexture so the benchmark sees the same texture cost as a real port.
+//
+
+static const u32 kPalette4BytesRequired = 16 * sizeof( NativePf8888 );
+static const u32 kPalette8BytesRequired = 256 * sizeof( NativePf8888 );
+
+static u32 GetTextureBlockWidth( u32 dimension, ETextureFormat texture_format )
+{
+	DAEDALUS_ASSERT( GetNextPowerOf2( dimension ) == dimension, "This is not a power of 2" );
+
+	// Ensure that the pitch is at least 16 bytes
+	while( CalcBytesRequired( dimension, texture_format ) < 16 )
+	{
+		dimension *= 2;
+	}
+
+	return dimension;
+}
+
+static inline u32 CorrectDimension( u32 dimension )
+{
+	static const u32 MIN_TEXTURE_DIMENSION = 1;
+	return Max( GetNextPowerOf2( dimension ), MIN_TEXTURE_DIMENSION );
+}
+
+static u32 GetPaletteBytesRequired( ETextureFormat texture_format )
+{
+	switch( texture_format )
+	{
+	case TexFmt_CI4_8888:	return kPalette4BytesRequired;
+	case TexFmt_CI8_8888:	return kPalette8BytesRequired;
+	default:				return 0;
+	}
+}
+
+CRefPtr<CNativeTexture>	CNativeTexture::Create( u32 width, u32 height, ETextureFormat texture_format )
+{
+	return new CNativeTexture( width, height, texture_format );
+}
+
+CRefPtr<CNativeTexture>	CNativeTexture::CreateFromPng( const char * p_filename, ETextureFormat texture_format )
+{
+	// Nothing in the headless build needs UI artwork
+	return nullptr;
+}
+
+CNativeTexture::CNativeTexture( u32 w, u32 h, ETextureFormat texture_format )
+:	mTextureFormat( texture_format )
+,	mWidth( w )
+,	mHeight( h )
+,	mCorrectedWidth( CorrectDimension( w ) )
+,	mCorrectedHeight( CorrectDimension( h ) )
+,	mTextureBlockWidth( GetTextureBlockWidth( mCorrectedWidth, texture_format ) )
+,	mpData( nullptr )
+,	mpPalette( nullptr )
+{
+	size_t data_len = GetBytesRequired();
+	mpData = malloc(data_len);
+	memset(mpData, 0, data_len);
+
+	u32 palette_len = GetPaletteBytesRequired( texture_format );
+	if (palette_len > 0)
+	{
+		mpPalette = malloc(palette_len);
+		memset(mpPalette, 0, palette_len);
+	}
+}
+
+CNativeTexture::~CNativeTexture()
+{
+	free(mpData);
+	free(mpPalette);
+}
+
+bool CNativeTexture::HasData() const
+{
+	return mpData != nullptr;
+}
+
+void CNativeTexture::InstallTexture() const
+{
+}
+
+void CNativeTexture::SetData( void * data, void * palette )
+{
+	memcpy(mpData, data, GetBytesRequired());
+
+	u32 palette_len = GetPaletteBytesRequired( mTextureFormat );
+	if (palette_len > 0)
+	{
+		memcpy(mpPalette, palette, palette_len);
+	}
+}
+
+u32	CNativeTexture::GetStride() const
+{
+	return CalcBytesRequired( mTextureBlockWidth, mTextureFormat );
+}
+
+u32 CNativeTexture::GetBytesRequired() const
+{
+	return GetStride() * mCorrectedHeight;
+}
@@ -0,0 +1,76 @@
+/*
+Copyright (C) 2003 Azimer
+Copyright (C) 2001,2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Null audio plugin. The audio HLE ABIs still run on every alist (on the
+//	audio thread with APM_ENABLED_ASYNC) so their cost shows up in
+//	benchmarks, but the output is discarded.
+//
+
+#include "stdafx.h"
+
+#include "Config/ConfigOptions.h"
+#include "Core/AudioTask.h"
+#include "Core/Memory.h"
+#include "HLEAudio/audiohle.h"
+#include "Plugins/AudioPlugin.h"
+
+EAudioPluginMode gAudioPluginEnabled( APM_ENABLED_SYNC );
+
+class CAudioPluginNull : public CAudioPlugin
+{
+public:
+	virtual bool			StartEmulation()				{ return true; }
+	virtual void			StopEmulation()					{ Audio_Reset(); }
+
+	virtual void			DacrateChanged( int SystemType ) {}
+	virtual void			LenChanged()					{}
+	virtual u32				ReadLength()					{ return 0; }
+	virtual EProcessResult	ProcessAList();
+};
+
+//*****************************************************************************
+//
+//*****************************************************************************
+EProcessResult	CAudioPluginNull::ProcessAList()
+{
+	Memory_SP_SetRegisterBits(SP_STATUS_REG, SP_STATUS_HALT);
+
+	switch( gAudioPluginEnabled )
+	{
+		case APM_DISABLED:
+			break;
+		case APM_ENABLED_ASYNC:
+			return AudioTask_Start();
+		case APM_ENABLED_SYNC:
+			Audio_Ucode();
+			break;
+	}
+
+	return PR_COMPLETED;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CAudioPlugin *		CreateAudioPlugin()
+{
+	return new CAudioPluginNull();
+}
@@ -0,0 +1,125 @@
+/*
+Copyright (C) 2007 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+
+#include "Core/Memory.h"
+#include "Debug/DBGConsole.h"
+#include "Graphics/GraphicsContext.h"
+#include "HLEGraphics/DLParser.h"
+#include "HLEGraphics/TextureCache.h"
+#include "Plugins/GraphicsPlugin.h"
+#include "SysNull/HLEGraphics/RendererNull.h"
+#include "Utility/Preferences.h"
+
+u32					gVISyncRate {1500};
+EFrameskipValue		gFrameskipValue = FV_DISABLED;
+
+class CGraphicsPluginImpl : public CGraphicsPlugin
+{
+	public:
+	CGraphicsPluginImpl();
+	~CGraphicsPluginImpl();
+
+		bool		Initialise();
+
+		virtual bool		StartEmulation()		{ return true; }
+		virtual void		ViStatusChanged()		{}
+		virtual void		ViWidthChanged()		{}
+		virtual void		ProcessDList();
+
+		virtual void		UpdateScreen();
+
+		virtual void		RomClosed();
+private:
+		u32					LastOrigin;
+};
+
+CGraphicsPluginImpl::CGraphicsPluginImpl():	LastOrigin( 0 )
+{
+}
+
+CGraphicsPluginImpl::~CGraphicsPluginImpl()
+{
+}
+
+bool CGraphicsPluginImpl::Initialise()
+{
+	if(!CreateRenderer())
+	{
+		return false;
+	}
+
+	if(!CTextureCache::Create())
+	{
+		return false;
+	}
+
+	if (!DLParser_Initialise())
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void CGraphicsPluginImpl::ProcessDList()
+{
+	DLParser_Process();
+}
+
+void CGraphicsPluginImpl::UpdateScreen()
+{
+	u32 current_origin = Memory_VI_GetRegister(VI_ORIGIN_REG);
+
+	// Frameskip is never enabled here - the point is to measure every frame
+	if( current_origin != LastOrigin)
+	{
+		CGraphicsContext::Get()->UpdateFrame( false );
+		gRendererNull->CountFlip();
+
+		LastOrigin = current_origin;
+	}
+}
+
+void CGraphicsPluginImpl::RomClosed()
+{
+	#ifdef DAEDALUS_DEBUG_CONSOLE
+	DBGConsole_Msg(0, "Finalising Graphics");
+	#endif
+	DLParser_Finalise();
+	CTextureCache::Destroy();
+	DestroyRenderer();
+}
+
+CGraphicsPlugin * CreateGraphicsPlugin()
+{
+	#ifdef DAEDALUS_DEBUG_CONSOLE
+	DBGConsole_Msg( 0, "Initialising Graphics Plugin [Null]" );
+	#endif
+
+	CGraphicsPluginImpl * plugin = new CGraphicsPluginImpl;
+	if( !plugin->Initialise() )
+	{
+		delete plugin;
+		plugin = nullptr;
+	}
+
+	return plugin;
+}
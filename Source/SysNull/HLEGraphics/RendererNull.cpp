@@ -0,0 +1,129 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "RendererNull.h"
+
+#include <string.h>
+
+#include "HLEGraphics/RDPStateManager.h"
+#include "SysNull/Null.h"
+#include "Utility/Hash.h"
+
+BaseRenderer *	gRenderer     = nullptr;
+RendererNull *	gRendererNull = nullptr;
+
+ScePspFMatrix4	gProjection;
+void sceGuSetMatrix(EGuMatrixType type, const ScePspFMatrix4 * mtx)
+{
+	if (type == GU_PROJECTION)
+	{
+		memcpy(&gProjection, mtx, sizeof(gProjection));
+	}
+}
+
+RendererNull::RendererNull()
+:	mHashVertices( false )
+{
+	ResetStats();
+}
+
+RendererNull::~RendererNull()
+{
+}
+
+void RendererNull::ResetStats()
+{
+	memset( &mStats, 0, sizeof(mStats) );
+}
+
+void RendererNull::RestoreRenderStates()
+{
+}
+
+void RendererNull::RenderTriangles(DaedalusVtxBuffer * p_vertices, bool disable_zbuffer)
+{
+	// Keep the texture cache busy, exactly as a real renderer would
+	if (mTnL.Flags.Texture)
+	{
+		UpdateTileSnapshots( mTextureTile );
+	}
+
+	mStats.NumTriangleBatches++;
+	mStats.NumVertices  += p_vertices->num_vertices;
+	mStats.NumTriangles += p_vertices->num_vertices / 3;
+
+	if (mHashVertices)
+	{
+		u32 hash = mStats.VertexHash;
+		for (int i = 0; i < p_vertices->num_vertices; ++i)
+		{
+			hash = murmur2_hash( &p_vertices->position[i*3], 3 * sizeof(float), hash );
+			hash = murmur2_hash( &p_vertices->texture[i*2], 2 * sizeof(float), hash );
+			hash = murmur2_hash( &p_vertices->colour[i], sizeof(c32), hash );
+			hash = murmur2_hash( gProjection.m, sizeof(gProjection.m), hash );
+		}
+		mStats.VertexHash = hash;
+	}
+}
+
+void RendererNull::TexRect(u32 tile_idx, const v2 & xy0, const v2 & xy1, TexCoord st0, TexCoord st1)
+{
+	UpdateTileSnapshots( tile_idx );
+	PrepareTexRectUVs(&st0, &st1);
+
+	mStats.NumTexRects++;
+}
+
+void RendererNull::TexRectFlip(u32 tile_idx, const v2 & xy0, const v2 & xy1, TexCoord st0, TexCoord st1)
+{
+	UpdateTileSnapshots( tile_idx );
+	PrepareTexRectUVs(&st0, &st1);
+
+	mStats.NumTexRects++;
+}
+
+void RendererNull::FillRect(const v2 & xy0, const v2 & xy1, u32 color)
+{
+	mStats.NumFillRects++;
+}
+
+void RendererNull::Draw2DTexture(f32 x0, f32 y0, f32 x1, f32 y1, f32 u0, f32 v0, f32 u1, f32 v1, const CNativeTexture * texture)
+{
+	mStats.NumTexRects++;
+}
+
+void RendererNull::Draw2DTextureR(f32 x0, f32 y0, f32 x1, f32 y1, f32 x2, f32 y2, f32 x3, f32 y3, f32 s, f32 t, const CNativeTexture * texture)
+{
+	mStats.NumTexRects++;
+}
+
+bool CreateRenderer()
+{
+	gRendererNull = new RendererNull();
+	gRenderer     = gRendererNull;
+	return true;
+}
+
+void DestroyRenderer()
+{
+	delete gRendererNull;
+	gRendererNull = nullptr;
+	gRenderer     = nullptr;
+}
@@ -0,0 +1,76 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSNULL_HLEGRAPHICS_RENDERERNULL_H_
+#define SYSNULL_HLEGRAPHICS_RENDERERNULL_H_
+
+#include "HLEGraphics/BaseRenderer.h"
+
+//
+//	Runs the full DLParser/BaseRenderer T&L path, installs textures through the
+//	texture cache, then throws the resulting primitives away. Used for benchmarking.
+//
+struct SNullRendererStats
+{
+	u64		NumTriangles;
+	u64		NumTriangleBatches;
+	u64		NumTexRects;
+	u64		NumFillRects;
+	u64		NumVertices;
+	u64		NumFlips;
+	u32		VertexHash;			// Of every vertex drawn, in order, if SetHashVertices(true)
+};
+
+class RendererNull : public BaseRenderer
+{
+public:
+	RendererNull();
+	~RendererNull();
+
+	virtual void		RestoreRenderStates();
+
+	virtual void		RenderTriangles(DaedalusVtxBuffer * p_vertices, bool disable_zbuffer);
+
+	virtual void		TexRect(u32 tile_idx, const v2 & xy0, const v2 & xy1, TexCoord st0, TexCoord st1);
+	virtual void		TexRectFlip(u32 tile_idx, const v2 & xy0, const v2 & xy1, TexCoord st0, TexCoord st1);
+	virtual void		FillRect(const v2 & xy0, const v2 & xy1, u32 color);
+
+	virtual void		Draw2DTexture(f32 x0, f32 y0, f32 x1, f32 y1, f32 u0, f32 v0, f32 u1, f32 v1, const CNativeTexture * texture);
+	virtual void		Draw2DTextureR(f32 x0, f32 y0, f32 x1, f32 y1, f32 x2, f32 y2, f32 x3, f32 y3, f32 s, f32 t, const CNativeTexture * texture);
+
+	const SNullRendererStats &	GetStats() const		{ return mStats; }
+	void						ResetStats();
+	void						CountFlip()				{ mStats.NumFlips++; }
+
+	// The hash (which includes the projection each vertex is drawn with) doesn't depend
+	// on how the vertices were split into draws, so it can check that batching them
+	// hasn't changed what's drawn
+	void						SetHashVertices( bool enable )	{ mHashVertices = enable; }
+
+private:
+	SNullRendererStats	mStats;
+	bool				mHashVertices;
+};
+
+// NB: this is equivalent to gRenderer, but points to the implementation class, for platform-specific functionality.
+extern RendererNull * gRendererNull;
+
+#endif // SYSNULL_HLEGRAPHICS_RENDERERNULL_H_
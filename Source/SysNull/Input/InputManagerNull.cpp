@@ -0,0 +1,63 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Input/InputManager.h"
+
+// No controllers are connected in the headless build - every pad reads as idle.
+class IInputManager : public CInputManager
+{
+public:
+	virtual bool				Initialise()		{ return true; }
+	virtual void				Finalise()			{}
+
+	virtual void				GetState( OSContPad pPad[4] );
+
+	virtual u32					GetNumConfigurations() const								{ return 0; }
+	virtual const char *		GetConfigurationName( u32 configuration_idx ) const			{ return "?"; }
+	virtual const char *		GetConfigurationDescription( u32 configuration_idx ) const	{ return "?"; }
+	virtual void				SetConfiguration( u32 configuration_idx )					{}
+	virtual u32					GetConfigurationFromName( const char * name ) const			{ return 0; }
+};
+
+void IInputManager::GetState( OSContPad pPad[4] )
+{
+	for(u32 cont = 0; cont < 4; cont++)
+	{
+		pPad[cont].button = 0;
+		pPad[cont].stick_x = 0;
+		pPad[cont].stick_y = 0;
+	}
+}
+
+template<> bool	CSingleton< CInputManager >::Create()
+{
+	DAEDALUS_ASSERT_Q(mpInstance == nullptr);
+
+	IInputManager * manager = new IInputManager();
+
+	if(manager->Initialise())
+	{
+		mpInstance = manager;
+		return true;
+	}
+
+	delete manager;
+	return false;
+}
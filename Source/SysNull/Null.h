@@ -0,0 +1,61 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef SYSNULL_NULL_H_
+#define SYSNULL_NULL_H_
+
+#include "Utility/DaedalusTypes.h"
+
+//
+//	The headless build has no rasteriser. These mirror the handful of
+//	sceGu* shims that SysGL/GL.h provides so BaseRenderer compiles unchanged.
+//
+
+enum EGuTextureWrapMode
+{
+	GU_CLAMP			= 0,
+	GU_REPEAT			= 1,
+};
+
+enum EGuMatrixType
+{
+	GU_PROJECTION		= 0,
+};
+
+struct ScePspFMatrix4
+{
+	float m[16];
+};
+
+void sceGuSetMatrix(EGuMatrixType type, const ScePspFMatrix4 * mtx);
+
+// Texture wrap tokens BaseRenderer records for non-PSP targets. Values match GL.
+#define GL_REPEAT			0x2901
+#define GL_CLAMP			0x2900
+#define GL_MIRRORED_REPEAT	0x8370
+
+// Host side vertex streams filled by BaseRenderer::PrepareTrisUnclipped. Reset every frame.
+extern float *		gVertexBuffer;
+extern u32 *		gColorBuffer;
+extern float *		gTexCoordBuffer;
+extern float *		gVertexBufferPtr;
+extern u32 *		gColorBufferPtr;
+extern float *		gTexCoordBufferPtr;
+
+#endif // SYSNULL_NULL_H_
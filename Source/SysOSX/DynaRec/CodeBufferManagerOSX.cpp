@@ -35,6 +35,7 @@ public:
 
 	virtual CCodeGenerator *StartNewBlock();
 	virtual u32				FinaliseCurrentBlock();
+	virtual bool			IsNearlyFull() const;
 };
 
 CCodeBufferManager * CCodeBufferManager::Create()
@@ -69,3 +70,9 @@ u32 CCodeBufferManagerOSX::FinaliseCurrentBlock()
 	DAEDALUS_ASSERT(false, "Unimplemented");
 	return 0;
 }
+
+bool CCodeBufferManagerOSX::IsNearlyFull() const
+{
+	DAEDALUS_ASSERT(false, "Unimplemented");
+	return false;
+}
@@ -98,6 +98,16 @@ struct SCodeBuffer
 		}
 
 		mBufferPtr += used_size;
+
+		#ifdef DAEDALUS_ENABLE_ASSERTS
+		DAEDALUS_ASSERT( mBufferPtr <= mBufferSize, "Dynarec code buffer overflow" );
+		#endif
+	}
+
+	// Leaves twice the 32k assumed above, so StartNewBlock's rounding can't trip its assert
+	bool	IsNearlyFull() const
+	{
+		return mBufferPtr + 2 * 32768 > mBufferSize;
 	}
 
 };
@@ -117,6 +127,7 @@ public:
 
 	virtual CCodeGenerator *	StartNewBlock();
 	virtual u32					FinaliseCurrentBlock();
+	virtual bool				IsNearlyFull() const;
 
 private:
 
@@ -201,3 +212,11 @@ u32 CCodeBufferManagerPSP::FinaliseCurrentBlock()
 
 	return main_block_size_a;
 }
+
+
+//
+
+bool CCodeBufferManagerPSP::IsNearlyFull() const
+{
+	return mPrimaryBuffer.IsNearlyFull() || mSecondaryBuffer.IsNearlyFull();
+}
@@ -1024,7 +1024,7 @@ void	CCodeGeneratorPSP::RestoreAllRegisters( CN64RegisterCachePSP & current_cach
 
 //
 
-CJumpLocation CCodeGeneratorPSP::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment )
+CJumpLocation CCodeGeneratorPSP::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment, CCodeLabel * p_fallback )
 {
 	#ifdef DAEDALUS_ENABLE_ASSERTS
 	//DAEDALUS_ASSERT( exit_address != u32( ~0 ), "Invalid exit address" );
@@ -1128,10 +1128,12 @@ CJumpLocation CCodeGeneratorPSP::GenerateExitCode( u32 exit_address, u32 jump_ad
 	// This gets patched with a jump to the next fragment if the target is later found
 	CJumpLocation jump_to_next_fragment( J( next_fragment, true ) );
 
+	*p_fallback = CCodeLabel( reinterpret_cast< const void * >( _ReturnFromDynaRec ) );
+
 	// Patch up the exit jump if the target hasn't been compiled yet
 	if( !next_fragment.IsSet() )
 	{
-		PatchJumpLong( jump_to_next_fragment, CCodeLabel( reinterpret_cast< const void * >( _ReturnFromDynaRec ) ) );
+		PatchJumpLong( jump_to_next_fragment, *p_fallback );
 	}
 	return jump_to_next_fragment;
 
@@ -59,7 +59,7 @@ static int StartThreadFunc( SceSize args, void *argp )
 	return result;
 }
 
-s32		CreateThread( const char * name, DaedThread function, void * argument )
+s32		CreateThread( const char * name, DaedThread function, void * argument, s32 core )
 {
 	s32	thid( ::sceKernelCreateThread( name, StartThreadFunc, gThreadPriorities[TP_NORMAL], 0x10000, 0, nullptr ) );
 
@@ -0,0 +1,446 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "AssemblyWriterX64.h"
+
+extern "C" { void _ReturnFromDynaRec(); }
+
+static inline bool IsS8( s32 value )	{ return value >= -128 && value <= 127; }
+
+//*****************************************************************************
+//	Encoding helpers
+//*****************************************************************************
+void	CAssemblyWriterX64::EmitREX( bool w, u32 reg, u32 index, u32 base, bool force )
+{
+	u8 rex = 0x40 | (w ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((index & 8) ? 0x02 : 0) | ((base & 8) ? 0x01 : 0);
+
+	// force is needed to address spl/bpl/sil/dil rather than ah/ch/dh/bh
+	if( rex != 0x40 || force )
+	{
+		EmitBYTE( rex );
+	}
+}
+
+void	CAssemblyWriterX64::EmitModRM_Reg( u32 reg, u32 rm )
+{
+	EmitBYTE( 0xc0 | ((reg & 7) << 3) | (rm & 7) );
+}
+
+void	CAssemblyWriterX64::EmitModRM_Mem( u32 reg, EAmd64Reg base, s32 offset )
+{
+	u32 rm = base & 7;
+	u32 mod;
+
+	// rbp/r13 have no disp0 form
+	if( offset == 0 && rm != 5 )	mod = 0;
+	else if( IsS8( offset ) )		mod = 1;
+	else							mod = 2;
+
+	EmitBYTE( (mod << 6) | ((reg & 7) << 3) | rm );
+
+	// rsp/r12 always need a SIB byte
+	if( rm == 4 )
+	{
+		EmitBYTE( 0x24 );
+	}
+
+	if( mod == 1 )		EmitBYTE( u8( offset ) );
+	else if( mod == 2 )	EmitDWORD( u32( offset ) );
+}
+
+void	CAssemblyWriterX64::EmitModRM_MemIndex( u32 reg, EAmd64Reg base, EAmd64Reg index )
+{
+	DAEDALUS_ASSERT( index != Amd64Reg_RSP, "rsp can't be used as an index" );
+
+	u32 mod = (base & 7) == 5 ? 1 : 0;
+
+	EmitBYTE( (mod << 6) | ((reg & 7) << 3) | 4 );
+	EmitBYTE( ((index & 7) << 3) | (base & 7) );
+
+	if( mod == 1 )
+	{
+		EmitBYTE( 0 );
+	}
+}
+
+bool	CAssemblyWriterX64::IsRel32Reachable( CCodeLabel target, u32 instruction_length ) const
+{
+	s64 offset = target.GetTargetU8P() - (mpAssemblyBuffer->GetLabel().GetTargetU8P() + instruction_length);
+
+	return offset == s64( s32( offset ) );
+}
+
+//*****************************************************************************
+//	Moves
+//*****************************************************************************
+void	CAssemblyWriterX64::MOV( EAmd64Reg dst, EAmd64Reg src )
+{
+	EmitREX( false, src, 0, dst );
+	EmitBYTE( 0x89 );
+	EmitModRM_Reg( src, dst );
+}
+
+void	CAssemblyWriterX64::MOV64( EAmd64Reg dst, EAmd64Reg src )
+{
+	EmitREX( true, src, 0, dst );
+	EmitBYTE( 0x89 );
+	EmitModRM_Reg( src, dst );
+}
+
+void	CAssemblyWriterX64::MOVI( EAmd64Reg reg, u32 value )
+{
+	EmitREX( false, 0, 0, reg );
+	EmitBYTE( 0xb8 | (reg & 7) );
+	EmitDWORD( value );
+}
+
+void	CAssemblyWriterX64::MOVI64( EAmd64Reg reg, s64 value )
+{
+	if( u64( value ) <= 0xffffffff )
+	{
+		MOVI( reg, u32( value ) );
+	}
+	else if( value == s64( s32( value ) ) )
+	{
+		EmitREX( true, 0, 0, reg );
+		EmitBYTE( 0xc7 );
+		EmitModRM_Reg( 0, reg );
+		EmitDWORD( u32( value ) );
+	}
+	else
+	{
+		EmitREX( true, 0, 0, reg );
+		EmitBYTE( 0xb8 | (reg & 7) );
+		EmitQWORD( u64( value ) );
+	}
+}
+
+void	CAssemblyWriterX64::MOVSXD( EAmd64Reg dst, EAmd64Reg src )
+{
+	EmitREX( true, dst, 0, src );
+	EmitBYTE( 0x63 );
+	EmitModRM_Reg( dst, src );
+}
+
+void	CAssemblyWriterX64::MOVZX8( EAmd64Reg dst, EAmd64Reg src )
+{
+	EmitREX( false, dst, 0, src, src >= Amd64Reg_RSP );
+	EmitBYTE( 0x0f );
+	EmitBYTE( 0xb6 );
+	EmitModRM_Reg( dst, src );
+}
+
+void	CAssemblyWriterX64::MOV_REG_MEM( EAmd64Reg dst, EAmd64Reg base, s32 offset )
+{
+	EmitREX( false, dst, 0, base );
+	EmitBYTE( 0x8b );
+	EmitModRM_Mem( dst, base, offset );
+}
+
+void	CAssemblyWriterX64::MOV64_REG_MEM( EAmd64Reg dst, EAmd64Reg base, s32 offset )
+{
+	EmitREX( true, dst, 0, base );
+	EmitBYTE( 0x8b );
+	EmitModRM_Mem( dst, base, offset );
+}
+
+void	CAssemblyWriterX64::MOVSXD_REG_MEM( EAmd64Reg dst, EAmd64Reg base, s32 offset )
+{
+	EmitREX( true, dst, 0, base );
+	EmitBYTE( 0x63 );
+	EmitModRM_Mem( dst, base, offset );
+}
+
+void	CAssemblyWriterX64::MOV_MEM_REG( EAmd64Reg base, s32 offset, EAmd64Reg src )
+{
+	EmitREX( false, src, 0, base );
+	EmitBYTE( 0x89 );
+	EmitModRM_Mem( src, base, offset );
+}
+
+void	CAssemblyWriterX64::MOV64_MEM_REG( EAmd64Reg base, s32 offset, EAmd64Reg src )
+{
+	EmitREX( true, src, 0, base );
+	EmitBYTE( 0x89 );
+	EmitModRM_Mem( src, base, offset );
+}
+
+void	CAssemblyWriterX64::MOV_MEM_I32( EAmd64Reg base, s32 offset, u32 value )
+{
+	EmitREX( false, 0, 0, base );
+	EmitBYTE( 0xc7 );
+	EmitModRM_Mem( 0, base, offset );
+	EmitDWORD( value );
+}
+
+void	CAssemblyWriterX64::MOV64_MEM_I32( EAmd64Reg base, s32 offset, s32 value )
+{
+	EmitREX( true, 0, 0, base );
+	EmitBYTE( 0xc7 );
+	EmitModRM_Mem( 0, base, offset );
+	EmitDWORD( u32( value ) );
+}
+
+//*****************************************************************************
+//	8/16 bit loads are zero extended to 32 bits (and hence 64) or sign extended to 64
+//	32 bit signed loads are sign extended to 64 bits
+//*****************************************************************************
+void	CAssemblyWriterX64::LOAD_BASE_INDEX( u32 bits, bool is_signed, EAmd64Reg dst, EAmd64Reg base, EAmd64Reg index )
+{
+	switch( bits )
+	{
+	case 8:
+		EmitREX( is_signed, dst, index, base );
+		EmitBYTE( 0x0f );
+		EmitBYTE( is_signed ? 0xbe : 0xb6 );
+		break;
+	case 16:
+		EmitREX( is_signed, dst, index, base );
+		EmitBYTE( 0x0f );
+		EmitBYTE( is_signed ? 0xbf : 0xb7 );
+		break;
+	case 32:
+		EmitREX( is_signed, dst, index, base );
+		EmitBYTE( is_signed ? 0x63 : 0x8b );
+		break;
+	case 64:
+		EmitREX( true, dst, index, base );
+		EmitBYTE( 0x8b );
+		break;
+	default:
+		NODEFAULT;
+	}
+	EmitModRM_MemIndex( dst, base, index );
+}
+
+void	CAssemblyWriterX64::STORE_BASE_INDEX( u32 bits, EAmd64Reg base, EAmd64Reg index, EAmd64Reg src )
+{
+	switch( bits )
+	{
+	case 8:
+		EmitREX( false, src, index, base, src >= Amd64Reg_RSP );
+		EmitBYTE( 0x88 );
+		break;
+	case 16:
+		EmitBYTE( 0x66 );
+		EmitREX( false, src, index, base );
+		EmitBYTE( 0x89 );
+		break;
+	case 32:
+		EmitREX( false, src, index, base );
+		EmitBYTE( 0x89 );
+		break;
+	case 64:
+		EmitREX( true, src, index, base );
+		EmitBYTE( 0x89 );
+		break;
+	default:
+		NODEFAULT;
+	}
+	EmitModRM_MemIndex( src, base, index );
+}
+
+void	CAssemblyWriterX64::LEA( EAmd64Reg dst, EAmd64Reg base, s32 offset )
+{
+	EmitREX( false, dst, 0, base );
+	EmitBYTE( 0x8d );
+	EmitModRM_Mem( dst, base, offset );
+}
+
+//*****************************************************************************
+//	Arithmetic
+//*****************************************************************************
+void	CAssemblyWriterX64::ALU( EAmd64AluOp op, EAmd64Reg dst, EAmd64Reg src, bool is_64 )
+{
+	EmitREX( is_64, src, 0, dst );
+	EmitBYTE( (op << 3) | 0x01 );
+	EmitModRM_Reg( src, dst );
+}
+
+void	CAssemblyWriterX64::ALUI( EAmd64AluOp op, EAmd64Reg dst, s32 value, bool is_64 )
+{
+	EmitREX( is_64, 0, 0, dst );
+	if( IsS8( value ) )
+	{
+		EmitBYTE( 0x83 );
+		EmitModRM_Reg( op, dst );
+		EmitBYTE( u8( value ) );
+	}
+	else
+	{
+		EmitBYTE( 0x81 );
+		EmitModRM_Reg( op, dst );
+		EmitDWORD( u32( value ) );
+	}
+}
+
+void	CAssemblyWriterX64::ALU_MEM_I32( EAmd64AluOp op, EAmd64Reg base, s32 offset, s32 value )
+{
+	EmitREX( false, 0, 0, base );
+	if( IsS8( value ) )
+	{
+		EmitBYTE( 0x83 );
+		EmitModRM_Mem( op, base, offset );
+		EmitBYTE( u8( value ) );
+	}
+	else
+	{
+		EmitBYTE( 0x81 );
+		EmitModRM_Mem( op, base, offset );
+		EmitDWORD( u32( value ) );
+	}
+}
+
+void	CAssemblyWriterX64::TEST( EAmd64Reg a, EAmd64Reg b )
+{
+	EmitREX( false, b, 0, a );
+	EmitBYTE( 0x85 );
+	EmitModRM_Reg( b, a );
+}
+
+void	CAssemblyWriterX64::TEST64( EAmd64Reg a, EAmd64Reg b )
+{
+	EmitREX( true, b, 0, a );
+	EmitBYTE( 0x85 );
+	EmitModRM_Reg( b, a );
+}
+
+void	CAssemblyWriterX64::NOT64( EAmd64Reg reg )
+{
+	EmitREX( true, 0, 0, reg );
+	EmitBYTE( 0xf7 );
+	EmitModRM_Reg( 2, reg );
+}
+
+void	CAssemblyWriterX64::IMUL64( EAmd64Reg dst, EAmd64Reg src )
+{
+	EmitREX( true, dst, 0, src );
+	EmitBYTE( 0x0f );
+	EmitBYTE( 0xaf );
+	EmitModRM_Reg( dst, src );
+}
+
+void	CAssemblyWriterX64::SHIFTI( EAmd64ShiftOp op, EAmd64Reg reg, u8 sa, bool is_64 )
+{
+	EmitREX( is_64, 0, 0, reg );
+	if( sa == 1 )
+	{
+		EmitBYTE( 0xd1 );
+		EmitModRM_Reg( op, reg );
+	}
+	else
+	{
+		EmitBYTE( 0xc1 );
+		EmitModRM_Reg( op, reg );
+		EmitBYTE( sa );
+	}
+}
+
+void	CAssemblyWriterX64::SHIFT_CL( EAmd64ShiftOp op, EAmd64Reg reg, bool is_64 )
+{
+	EmitREX( is_64, 0, 0, reg );
+	EmitBYTE( 0xd3 );
+	EmitModRM_Reg( op, reg );
+}
+
+void	CAssemblyWriterX64::SETCC( EAmd64Cond cond, EAmd64Reg reg )
+{
+	EmitREX( false, 0, 0, reg, reg >= Amd64Reg_RSP );
+	EmitBYTE( 0x0f );
+	EmitBYTE( 0x90 | cond );
+	EmitModRM_Reg( 0, reg );
+}
+
+//*****************************************************************************
+//	Branches
+//*****************************************************************************
+CJumpLocation	CAssemblyWriterX64::JCCLong( EAmd64Cond cond, CCodeLabel target )
+{
+	const u32 JCC_LONG_LENGTH = 6;
+
+	CJumpLocation	jump_location( mpAssemblyBuffer->GetJumpLocation() );
+	s32				offset( target.IsSet() ? jump_location.GetOffset( target ) - JCC_LONG_LENGTH : 0 );
+
+	EmitBYTE( 0x0f );
+	EmitBYTE( 0x80 | cond );
+	EmitDWORD( u32( offset ) );
+
+	return jump_location;
+}
+
+CJumpLocation	CAssemblyWriterX64::JMPLong( CCodeLabel target )
+{
+	const u32 JMP_LONG_LENGTH = 5;
+
+	CJumpLocation	jump_location( mpAssemblyBuffer->GetJumpLocation() );
+	s32				offset( target.IsSet() ? jump_location.GetOffset( target ) - JMP_LONG_LENGTH : 0 );
+
+	EmitBYTE( 0xe9 );
+	EmitDWORD( u32( offset ) );
+
+	return jump_location;
+}
+
+void	CAssemblyWriterX64::JMP_REG( EAmd64Reg reg )
+{
+	EmitREX( false, 0, 0, reg );
+	EmitBYTE( 0xff );
+	EmitModRM_Reg( 4, reg );
+}
+
+void	CAssemblyWriterX64::CALL( CCodeLabel target )
+{
+	const u32 CALL_LENGTH = 5;
+
+	if( IsRel32Reachable( target, CALL_LENGTH ) )
+	{
+		s32 offset( mpAssemblyBuffer->GetJumpLocation().GetOffset( target ) - CALL_LENGTH );
+
+		EmitBYTE( 0xe8 );
+		EmitDWORD( u32( offset ) );
+	}
+	else
+	{
+		MOVI64( Amd64Reg_RAX, reinterpret_cast< intptr_t >( target.GetTarget() ) );
+		CALL_REG( Amd64Reg_RAX );
+	}
+}
+
+void	CAssemblyWriterX64::CALL_REG( EAmd64Reg reg )
+{
+	EmitREX( false, 0, 0, reg );
+	EmitBYTE( 0xff );
+	EmitModRM_Reg( 2, reg );
+}
+
+void	CAssemblyWriterX64::RET()
+{
+	CCodeLabel	return_from_dynarec( reinterpret_cast< const void * >( _ReturnFromDynaRec ) );
+
+	if( IsRel32Reachable( return_from_dynarec, 5 ) )
+	{
+		JMPLong( return_from_dynarec );
+	}
+	else
+	{
+		MOVI64( Amd64Reg_RAX, reinterpret_cast< intptr_t >( return_from_dynarec.GetTarget() ) );
+		JMP_REG( Amd64Reg_RAX );
+	}
+}
@@ -0,0 +1,174 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSPOSIX_DYNAREC_X64_ASSEMBLYWRITERX64_H_
+#define SYSPOSIX_DYNAREC_X64_ASSEMBLYWRITERX64_H_
+
+#include "DynaRec/AssemblyBuffer.h"
+#include "DynarecTargetX64.h"
+
+// Group 1 ALU ops, in /digit order
+enum EAmd64AluOp
+{
+	Amd64Alu_ADD = 0, Amd64Alu_OR,  Amd64Alu_ADC, Amd64Alu_SBB,
+	Amd64Alu_AND,     Amd64Alu_SUB, Amd64Alu_XOR, Amd64Alu_CMP,
+};
+
+// Group 2 shift ops, in /digit order
+enum EAmd64ShiftOp
+{
+	Amd64Shift_ROL = 0, Amd64Shift_ROR = 1,
+	Amd64Shift_SHL = 4, Amd64Shift_SHR = 5, Amd64Shift_SAR = 7,
+};
+
+//
+//	Unsuffixed ops work on the low 32 bits (and zero the upper half of the
+//	destination, as usual for AMD64). The *64 variants operate on the full register.
+//
+class CAssemblyWriterX64
+{
+	public:
+		CAssemblyWriterX64( CAssemblyBuffer * p_buffer_a, CAssemblyBuffer * p_buffer_b )
+			:	mpAssemblyBuffer( p_buffer_a )
+			,	mpAssemblyBufferA( p_buffer_a )
+			,	mpAssemblyBufferB( p_buffer_b )
+		{
+		}
+
+	public:
+		CAssemblyBuffer *	GetAssemblyBuffer() const									{ return mpAssemblyBuffer; }
+		void				SetAssemblyBuffer( CAssemblyBuffer * p_buffer )				{ mpAssemblyBuffer = p_buffer; }
+
+		void				SetBufferA()												{ mpAssemblyBuffer = mpAssemblyBufferA; }
+		void				SetBufferB()												{ mpAssemblyBuffer = mpAssemblyBufferB; }
+		bool				IsBufferA() const											{ return mpAssemblyBuffer == mpAssemblyBufferA; }
+		bool				IsBufferB() const											{ return mpAssemblyBuffer == mpAssemblyBufferB; }
+
+		inline void NOP()	{ EmitBYTE( 0x90 ); }
+		inline void INT3()	{ EmitBYTE( 0xcc ); }
+
+		void				MOV( EAmd64Reg dst, EAmd64Reg src );							// mov  dst32, src32
+		void				MOV64( EAmd64Reg dst, EAmd64Reg src );							// mov  dst, src
+		void				MOVI( EAmd64Reg reg, u32 value );								// mov  reg32, imm32 (zero extends)
+		void				MOVI64( EAmd64Reg reg, s64 value );								// shortest encoding for a 64 bit immediate
+		void				MOVSXD( EAmd64Reg dst, EAmd64Reg src );							// movsxd dst, src32
+		void				MOVZX8( EAmd64Reg dst, EAmd64Reg src );							// movzx dst32, src8
+
+		void				MOV_REG_MEM( EAmd64Reg dst, EAmd64Reg base, s32 offset );		// mov  dst32, dword ptr [base+offset]
+		void				MOV64_REG_MEM( EAmd64Reg dst, EAmd64Reg base, s32 offset );		// mov  dst, qword ptr [base+offset]
+		void				MOVSXD_REG_MEM( EAmd64Reg dst, EAmd64Reg base, s32 offset );	// movsxd dst, dword ptr [base+offset]
+		void				MOV_MEM_REG( EAmd64Reg base, s32 offset, EAmd64Reg src );		// mov  dword ptr [base+offset], src32
+		void				MOV64_MEM_REG( EAmd64Reg base, s32 offset, EAmd64Reg src );		// mov  qword ptr [base+offset], src
+		void				MOV_MEM_I32( EAmd64Reg base, s32 offset, u32 value );			// mov  dword ptr [base+offset], imm32
+		void				MOV64_MEM_I32( EAmd64Reg base, s32 offset, s32 value );			// mov  qword ptr [base+offset], simm32
+
+		// Loads/stores through [base+index], used for the rdram fast path
+		void				LOAD_BASE_INDEX( u32 bits, bool is_signed, EAmd64Reg dst, EAmd64Reg base, EAmd64Reg index );
+		void				STORE_BASE_INDEX( u32 bits, EAmd64Reg base, EAmd64Reg index, EAmd64Reg src );
+
+		void				LEA( EAmd64Reg dst, EAmd64Reg base, s32 offset );				// lea  dst32, [base+offset]
+
+		void				ALU( EAmd64AluOp op, EAmd64Reg dst, EAmd64Reg src, bool is_64 );
+		void				ALUI( EAmd64AluOp op, EAmd64Reg dst, s32 value, bool is_64 );
+		void				ALU_MEM_I32( EAmd64AluOp op, EAmd64Reg base, s32 offset, s32 value );	// op   dword ptr [base+offset], imm
+
+		void				ADD( EAmd64Reg dst, EAmd64Reg src )							{ ALU( Amd64Alu_ADD, dst, src, false ); }
+		void				ADD64( EAmd64Reg dst, EAmd64Reg src )						{ ALU( Amd64Alu_ADD, dst, src, true ); }
+		void				SUB( EAmd64Reg dst, EAmd64Reg src )							{ ALU( Amd64Alu_SUB, dst, src, false ); }
+		void				SUB64( EAmd64Reg dst, EAmd64Reg src )						{ ALU( Amd64Alu_SUB, dst, src, true ); }
+		void				AND64( EAmd64Reg dst, EAmd64Reg src )						{ ALU( Amd64Alu_AND, dst, src, true ); }
+		void				OR64( EAmd64Reg dst, EAmd64Reg src )						{ ALU( Amd64Alu_OR, dst, src, true ); }
+		void				XOR( EAmd64Reg dst, EAmd64Reg src )							{ ALU( Amd64Alu_XOR, dst, src, false ); }
+		void				XOR64( EAmd64Reg dst, EAmd64Reg src )						{ ALU( Amd64Alu_XOR, dst, src, true ); }
+		void				CMP( EAmd64Reg a, EAmd64Reg b )								{ ALU( Amd64Alu_CMP, a, b, false ); }
+		void				CMP64( EAmd64Reg a, EAmd64Reg b )							{ ALU( Amd64Alu_CMP, a, b, true ); }
+
+		void				ADDI( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_ADD, reg, value, false ); }
+		void				ADDI64( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_ADD, reg, value, true ); }
+		void				ANDI64( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_AND, reg, value, true ); }
+		void				ORI64( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_OR, reg, value, true ); }
+		void				XORI( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_XOR, reg, value, false ); }
+		void				XORI64( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_XOR, reg, value, true ); }
+		void				CMPI( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_CMP, reg, value, false ); }
+		void				CMPI64( EAmd64Reg reg, s32 value )							{ ALUI( Amd64Alu_CMP, reg, value, true ); }
+
+		void				TEST( EAmd64Reg a, EAmd64Reg b );
+		void				TEST64( EAmd64Reg a, EAmd64Reg b );
+		void				NOT64( EAmd64Reg reg );
+		void				IMUL64( EAmd64Reg dst, EAmd64Reg src );						// imul dst, src
+
+		void				SHIFTI( EAmd64ShiftOp op, EAmd64Reg reg, u8 sa, bool is_64 );
+		void				SHIFT_CL( EAmd64ShiftOp op, EAmd64Reg reg, bool is_64 );
+
+		void				SHLI( EAmd64Reg reg, u8 sa )								{ SHIFTI( Amd64Shift_SHL, reg, sa, false ); }
+		void				SHRI( EAmd64Reg reg, u8 sa )								{ SHIFTI( Amd64Shift_SHR, reg, sa, false ); }
+		void				SARI( EAmd64Reg reg, u8 sa )								{ SHIFTI( Amd64Shift_SAR, reg, sa, false ); }
+		void				SARI64( EAmd64Reg reg, u8 sa )								{ SHIFTI( Amd64Shift_SAR, reg, sa, true ); }
+		void				ROLI64( EAmd64Reg reg, u8 sa )								{ SHIFTI( Amd64Shift_ROL, reg, sa, true ); }
+
+		void				SETCC( EAmd64Cond cond, EAmd64Reg reg );					// setcc reg8
+
+		CJumpLocation		JCCLong( EAmd64Cond cond, CCodeLabel target );
+		CJumpLocation		JMPLong( CCodeLabel target );
+		void				JMP_REG( EAmd64Reg reg );
+
+		// Calls to host functions may be out of rel32 range of the code buffer - these go via rax
+		void				CALL( CCodeLabel target );
+		void				CALL_REG( EAmd64Reg reg );
+
+		// Leaves the dynarec via _ReturnFromDynaRec (this is the only way out of generated code)
+		void				RET();
+
+	private:
+		inline void EmitBYTE( u8 byte )
+		{
+			mpAssemblyBuffer->EmitBYTE( byte );
+		}
+
+		inline void EmitWORD( u16 word )
+		{
+			mpAssemblyBuffer->EmitWORD( word );
+		}
+
+		inline void EmitDWORD( u32 dword )
+		{
+			mpAssemblyBuffer->EmitDWORD( dword );
+		}
+
+		inline void EmitQWORD( u64 qword )
+		{
+			mpAssemblyBuffer->EmitData( &qword, sizeof( qword ) );
+		}
+
+		void				EmitREX( bool w, u32 reg, u32 index, u32 base, bool force = false );
+		void				EmitModRM_Reg( u32 reg, u32 rm );
+		void				EmitModRM_Mem( u32 reg, EAmd64Reg base, s32 offset );
+		void				EmitModRM_MemIndex( u32 reg, EAmd64Reg base, EAmd64Reg index );
+
+		bool				IsRel32Reachable( CCodeLabel target, u32 instruction_length ) const;
+
+	private:
+		CAssemblyBuffer *	mpAssemblyBuffer;
+		CAssemblyBuffer *	mpAssemblyBufferA;
+		CAssemblyBuffer *	mpAssemblyBufferB;
+};
+
+#endif // SYSPOSIX_DYNAREC_X64_ASSEMBLYWRITERX64_H_
@@ -0,0 +1,157 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+
+#include <sys/mman.h>
+
+#include "DynaRec/CodeBufferManager.h"
+#include "Debug/DBGConsole.h"
+#include "CodeGeneratorX64.h"
+
+// x64 code is bulkier than ARM, and address space is cheap on a desktop host
+#define CODE_BUFFER_SIZE (32 * 1024 * 1024)
+
+// Room for the largest fragment, a MAX_TRACE_LENGTH trace plus its exit stubs
+#define CODE_BUFFER_HEADROOM (1024 * 1024)
+
+class CCodeBufferManagerX64 : public CCodeBufferManager
+{
+public:
+	CCodeBufferManagerX64()
+		:	mpBuffer( nullptr )
+		,	mBufferPtr( 0 )
+		,	mpSecondBuffer( nullptr )
+		,	mSecondBufferPtr( 0 )
+	{
+	}
+
+	virtual bool			Initialise();
+	virtual void			Reset();
+	virtual void			Finalise();
+
+	virtual CCodeGenerator *StartNewBlock();
+	virtual u32				FinaliseCurrentBlock();
+	virtual bool			IsNearlyFull() const;
+
+private:
+
+	u8	*					mpBuffer;
+	u32						mBufferPtr;
+
+	u8 *					mpSecondBuffer;
+	u32						mSecondBufferPtr;
+
+private:
+	CAssemblyBuffer			mPrimaryBuffer;
+	CAssemblyBuffer			mSecondaryBuffer;
+};
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeBufferManager *	CCodeBufferManager::Create()
+{
+	return new CCodeBufferManagerX64;
+}
+
+//*****************************************************************************
+//	Both buffers come from a single mapping so jumps between them always fit in a rel32
+//*****************************************************************************
+bool	CCodeBufferManagerX64::Initialise()
+{
+	void * p_mem = mmap( nullptr, CODE_BUFFER_SIZE * 2, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if (p_mem == MAP_FAILED)
+	{
+		DBGConsole_Msg( 0, "Couldn't allocate dynarec code buffer" );
+		return false;
+	}
+
+	mpBuffer = static_cast< u8 * >( p_mem );
+	mpSecondBuffer = mpBuffer + CODE_BUFFER_SIZE;
+
+	mBufferPtr = 0;
+	mSecondBufferPtr = 0;
+
+	return true;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeBufferManagerX64::Reset()
+{
+	mBufferPtr = 0;
+	mSecondBufferPtr = 0;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void	CCodeBufferManagerX64::Finalise()
+{
+	if (mpBuffer != nullptr)
+	{
+		munmap( mpBuffer, CODE_BUFFER_SIZE * 2 );
+
+		mpBuffer = nullptr;
+		mpSecondBuffer = nullptr;
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeGenerator * CCodeBufferManagerX64::StartNewBlock()
+{
+	// Round up to 16 byte boundry
+	mBufferPtr = (mBufferPtr + 15) & (~15);
+	mSecondBufferPtr = (mSecondBufferPtr + 15) & (~15);
+
+	mPrimaryBuffer.SetBuffer( mpBuffer + mBufferPtr );
+	mSecondaryBuffer.SetBuffer( mpSecondBuffer + mSecondBufferPtr );
+
+	return new CCodeGeneratorX64( &mPrimaryBuffer, &mSecondaryBuffer );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 CCodeBufferManagerX64::FinaliseCurrentBlock()
+{
+	u32		main_block_size( mPrimaryBuffer.GetSize() );
+
+	mBufferPtr += main_block_size;
+	mSecondBufferPtr += mSecondaryBuffer.GetSize();
+
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( mBufferPtr <= CODE_BUFFER_SIZE && mSecondBufferPtr <= CODE_BUFFER_SIZE, "Dynarec code buffer overflow" );
+	#endif
+
+	return main_block_size;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+bool CCodeBufferManagerX64::IsNearlyFull() const
+{
+	return mBufferPtr + CODE_BUFFER_HEADROOM > CODE_BUFFER_SIZE ||
+		   mSecondBufferPtr + CODE_BUFFER_HEADROOM > CODE_BUFFER_SIZE;
+}
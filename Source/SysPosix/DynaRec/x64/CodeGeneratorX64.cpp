@@ -0,0 +1,1622 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "CodeGeneratorX64.h"
+
+#include <stddef.h>
+#include <algorithm>
+
+#include "Config/ConfigOptions.h"
+#include "Core/CPU.h"
+#include "Core/Memory.h"
+#include "Core/R4300.h"
+#include "Core/Registers.h"
+#include "Debug/DBGConsole.h"
+#include "DynaRec/AssemblyUtils.h"
+#include "DynaRec/IndirectExitMap.h"
+#include "DynaRec/StaticAnalysis.h"
+#include "DynaRec/Trace.h"
+#include "OSHLE/ultra_R4300.h"
+
+using namespace AssemblyUtils;
+
+//
+//	Pinned registers. All three are callee saved, so they survive calls out to C.
+//	_EnterDynaRec sets them up, and they must match the offsets used in DynarecStubX64.S
+//
+static const EAmd64Reg	gCPUStateReg = Amd64Reg_R15;		// &gCPUState
+static const EAmd64Reg	gMemoryBaseReg = Amd64Reg_R14;		// g_pu8RamBase_8000
+static const EAmd64Reg	gMemUpperBoundReg = Amd64Reg_R13;	// 0x80000000 + gRamSize
+
+//
+//	rax, rcx and rdx are never cached:
+//		rax - memory addresses, results
+//		rcx - second operand, shift counts
+//		rdx - flushing known values, twiddled store addresses
+//	Every call out of generated code flushes and invalidates the cache first,
+//	so it's fine to use caller saved registers here.
+//
+static const EAmd64Reg gRegistersToUseForCaching[] = {
+	Amd64Reg_R11,
+	Amd64Reg_R10,
+	Amd64Reg_R9,
+	Amd64Reg_R8,
+	Amd64Reg_RDI,
+	Amd64Reg_RSI,
+	Amd64Reg_R12,
+	Amd64Reg_RBP,
+	Amd64Reg_RBX,
+};
+
+DAEDALUS_STATIC_ASSERT( offsetof( SCPUState, CurrentPC ) == 0x280 );
+DAEDALUS_STATIC_ASSERT( offsetof( SCPUState, StuffToDo ) == 0x28c );
+DAEDALUS_STATIC_ASSERT( offsetof( SCPUState, Events ) == 0x2b0 );
+
+// function stubs from assembly
+extern "C" { void _DirectExitCheckNoDelay( u32 instructions_executed, u32 exit_pc ); }
+extern "C" { void _DirectExitCheckDelay( u32 instructions_executed, u32 exit_pc, u32 target_pc ); }
+extern "C" { void _IndirectExitCheck( u32 instructions_executed, CIndirectExitMap* map, u32 exit_pc ); }
+
+extern "C"
+{
+	void HandleException_extern()
+	{
+		switch (gCPUState.Delay)
+		{
+			case DO_DELAY:
+				gCPUState.CurrentPC += 4;
+				gCPUState.Delay = EXEC_DELAY;
+				break;
+			case EXEC_DELAY:
+				gCPUState.CurrentPC = gCPUState.TargetPC;
+				gCPUState.Delay = NO_DELAY;
+				break;
+			case NO_DELAY:
+				gCPUState.CurrentPC += 4;
+				break;
+			default:
+				NODEFAULT;
+		}
+	}
+
+	// Slow path memory access. Values come back already extended to 64 bits
+	u64 Read8BitsForDynaRec_u( u32 address )	{ return Read8Bits( address ); }
+	u64 Read8BitsForDynaRec_s( u32 address )	{ return s64( s8( Read8Bits( address ) ) ); }
+	u64 Read16BitsForDynaRec_u( u32 address )	{ return Read16Bits( address ); }
+	u64 Read16BitsForDynaRec_s( u32 address )	{ return s64( s16( Read16Bits( address ) ) ); }
+	u64 Read32BitsForDynaRec_s( u32 address )	{ return s64( s32( Read32Bits( address ) ) ); }
+	u64 Read64BitsForDynaRec( u32 address )		{ return Read64Bits( address ); }
+
+	void Write8BitsForDynaRec( u32 address, u64 value )		{ Write8Bits( address, u8( value ) ); }
+	void Write16BitsForDynaRec( u32 address, u64 value )	{ Write16Bits( address, u16( value ) ); }
+	void Write32BitsForDynaRec( u32 address, u64 value )	{ Write32Bits( address, u32( value ) ); }
+	void Write64BitsForDynaRec( u32 address, u64 value )	{ Write64Bits( address, value ); }
+
+	// These set CurrentPC (and Delay for the BD versions) and leave the dynarec if an exception is raised
+	u64 _ReadBitsDirect_u8( u32 address, u32 current_pc );
+	u64 _ReadBitsDirect_s8( u32 address, u32 current_pc );
+	u64 _ReadBitsDirect_u16( u32 address, u32 current_pc );
+	u64 _ReadBitsDirect_s16( u32 address, u32 current_pc );
+	u64 _ReadBitsDirect_s32( u32 address, u32 current_pc );
+	u64 _ReadBitsDirect_u64( u32 address, u32 current_pc );
+
+	u64 _ReadBitsDirectBD_u8( u32 address, u32 current_pc );
+	u64 _ReadBitsDirectBD_s8( u32 address, u32 current_pc );
+	u64 _ReadBitsDirectBD_u16( u32 address, u32 current_pc );
+	u64 _ReadBitsDirectBD_s16( u32 address, u32 current_pc );
+	u64 _ReadBitsDirectBD_s32( u32 address, u32 current_pc );
+	u64 _ReadBitsDirectBD_u64( u32 address, u32 current_pc );
+
+	void _WriteBitsDirect_u8( u32 address, u64 value, u32 current_pc );
+	void _WriteBitsDirect_u16( u32 address, u64 value, u32 current_pc );
+	void _WriteBitsDirect_u32( u32 address, u64 value, u32 current_pc );
+	void _WriteBitsDirect_u64( u32 address, u64 value, u32 current_pc );
+
+	void _WriteBitsDirectBD_u8( u32 address, u64 value, u32 current_pc );
+	void _WriteBitsDirectBD_u16( u32 address, u64 value, u32 current_pc );
+	void _WriteBitsDirectBD_u32( u32 address, u64 value, u32 current_pc );
+	void _WriteBitsDirectBD_u64( u32 address, u64 value, u32 current_pc );
+}
+
+static inline s32 CPUStateOffset( const void * p_var )
+{
+	ptrdiff_t	offset( reinterpret_cast< const u8 * >( p_var ) - reinterpret_cast< const u8 * >( &gCPUState ) );
+
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( offset >= 0 && offset < ptrdiff_t( sizeof( SCPUState ) ), "Variable is not in gCPUState" );
+	#endif
+	return s32( offset );
+}
+
+// Inverse of a condition code is obtained by flipping the bottom bit
+static inline EAmd64Cond InvertCondition( EAmd64Cond cond )	{ return EAmd64Cond( cond ^ 1 ); }
+
+//*****************************************************************************
+//	XXXX
+//*****************************************************************************
+void Dynarec_ClearedCPUStuffToDo(){}
+void Dynarec_SetCPUStuffToDo(){}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeGeneratorX64::CCodeGeneratorX64( CAssemblyBuffer * p_primary, CAssemblyBuffer * p_secondary )
+:	CCodeGenerator( )
+,	CAssemblyWriterX64( p_primary, p_secondary )
+,	mEntryAddress( 0 )
+,	mpPrimary( p_primary )
+,	mpSecondary( p_secondary )
+,	mLoopTop( nullptr )
+,	mUseFixedRegisterAllocation( false )
+{
+}
+
+void	CCodeGeneratorX64::Finalise( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps, const std::vector< RegisterSnapshotHandle >& exception_handler_snapshots )
+{
+	if( !exception_handler_jumps.empty() )
+	{
+		GenerateExceptionHander( p_exception_handler_fn, exception_handler_jumps, exception_handler_snapshots );
+	}
+
+	SetAssemblyBuffer( nullptr );
+	mpPrimary = nullptr;
+	mpSecondary = nullptr;
+}
+
+void CCodeGeneratorX64::Initialise( u32 entry_address, u32 exit_address, u32 * hit_counter, const void * p_base, const SRegisterUsageInfo & register_usage )
+{
+	mEntryAddress = entry_address;
+	if( hit_counter != nullptr )
+	{
+		MOVI64( Amd64Reg_RAX, reinterpret_cast< intptr_t >( hit_counter ) );
+		ALU_MEM_I32( Amd64Alu_ADD, Amd64Reg_RAX, 0, 1 );
+	}
+
+	// p_base ignored - the state register is always pinned to &gCPUState
+	SetRegisterSpanList( register_usage, entry_address == exit_address );
+}
+
+void	CCodeGeneratorX64::SetRegisterSpanList( const SRegisterUsageInfo & register_usage, bool loops_to_self )
+{
+	mRegisterSpanList = register_usage.SpanList;
+
+	// Sort in order of increasing start point
+	std::sort( mRegisterSpanList.begin(), mRegisterSpanList.end(), SAscendingSpanStartSort() );
+
+	const u32 NUM_CACHE_REGS( sizeof( gRegistersToUseForCaching ) / sizeof( gRegistersToUseForCaching[0] ) );
+
+	// Push all the available registers in reverse order, so the callee saved ones get used first
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( mAvailableRegisters.empty(), "Why isn't the available register list empty?" );
+	#endif
+	for( u32 i {0}; i < NUM_CACHE_REGS; i++ )
+	{
+		mAvailableRegisters.push( gRegistersToUseForCaching[i] );
+	}
+
+	// Optimization for self looping code
+	if( gDynarecLoopOptimisation && loops_to_self )
+	{
+		mUseFixedRegisterAllocation = true;
+		u32		cache_reg_idx( 0 );
+		for( RegisterSpanList::const_iterator span_it = mRegisterSpanList.begin(); span_it < mRegisterSpanList.end() && cache_reg_idx < NUM_CACHE_REGS; ++span_it )
+		{
+			mRegisterCache.SetCachedReg( span_it->Register, gRegistersToUseForCaching[ cache_reg_idx ] );
+			cache_reg_idx++;
+		}
+
+		//
+		//	Pull all the cached registers into memory
+		//
+		// Skip r0
+		for( u32 i {1}; i < NUM_N64_REGS; i++ )
+		{
+			EN64Reg	n64_reg = EN64Reg( i );
+
+			if( mRegisterCache.IsCached( n64_reg ) )
+			{
+				PrepareCachedRegister( n64_reg );
+
+				//
+				//	If the register is modified anywhere in the fragment, we need
+				//	to mark it as dirty so it's flushed correctly on exit.
+				//
+				if( register_usage.IsModified( n64_reg ) )
+				{
+					mRegisterCache.MarkAsDirty( n64_reg, true );
+				}
+			}
+		}
+		mLoopTop = GetAssemblyBuffer()->GetLabel();
+	} //End of Loop optimization code
+}
+
+void	CCodeGeneratorX64::ExpireOldIntervals( u32 instruction_idx )
+{
+	// mActiveIntervals is held in order of increasing end point
+	RegisterSpanList::iterator span_it = mActiveIntervals.begin();
+	while( span_it < mActiveIntervals.end() )
+	{
+		const SRegisterSpan & span( *span_it );
+
+		if( span.SpanEnd >= instruction_idx )
+		{
+			break;
+		}
+
+		// This interval is no longer active - flush the register and return it to the list of available regs
+		EAmd64Reg	host_reg( mRegisterCache.GetCachedReg( span.Register ) );
+
+		FlushRegister( mRegisterCache, span.Register, true );
+
+		mRegisterCache.ClearCachedReg( span.Register );
+
+		mAvailableRegisters.push( host_reg );
+
+		span_it = mActiveIntervals.erase( span_it );
+	}
+}
+
+void	CCodeGeneratorX64::SpillAtInterval( const SRegisterSpan & live_span )
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( !mActiveIntervals.empty(), "There are no active intervals" );
+	#endif
+	const SRegisterSpan &	last_span( mActiveIntervals.back() );		// Spill the last active interval (it has the greatest end point)
+
+	if( last_span.SpanEnd > live_span.SpanEnd )
+	{
+		// Uncache the old span
+		EAmd64Reg	host_reg( mRegisterCache.GetCachedReg( last_span.Register ) );
+		FlushRegister( mRegisterCache, last_span.Register, true );
+		mRegisterCache.ClearCachedReg( last_span.Register );
+
+		// Cache the new span
+		mRegisterCache.SetCachedReg( live_span.Register, host_reg );
+
+		mActiveIntervals.pop_back();				// Remove the last span
+		mActiveIntervals.push_back( live_span );	// Insert in order of increasing end point
+
+		std::sort( mActiveIntervals.begin(), mActiveIntervals.end(), SAscendingSpanEndSort() );
+	}
+	else
+	{
+		// There is no space for this register - we just don't update the register cache info, so we save/restore it from memory as needed
+	}
+}
+
+void	CCodeGeneratorX64::UpdateRegisterCaching( u32 instruction_idx )
+{
+	if( mUseFixedRegisterAllocation )
+		return;
+
+	ExpireOldIntervals( instruction_idx );
+
+	for( RegisterSpanList::const_iterator span_it = mRegisterSpanList.begin(); span_it < mRegisterSpanList.end(); ++span_it )
+	{
+		const SRegisterSpan & span( *span_it );
+
+		// As we keep the intervals sorted in order of SpanStart, we can exit as soon as we encounter a SpanStart in the future
+		if( instruction_idx < span.SpanStart )
+		{
+			break;
+		}
+
+		// Only process live intervals
+		if( (instruction_idx >= span.SpanStart) & (instruction_idx <= span.SpanEnd) )
+		{
+			if( !mRegisterCache.IsCached( span.Register ) )
+			{
+				if( mAvailableRegisters.empty() )
+				{
+					SpillAtInterval( span );
+				}
+				else
+				{
+					// Use this register for caching
+					mRegisterCache.SetCachedReg( span.Register, mAvailableRegisters.top() );
+
+					// Pop this register from the available list
+					mAvailableRegisters.pop();
+					mActiveIntervals.push_back( span );		// Insert in order of increasing end point
+
+					std::sort( mActiveIntervals.begin(), mActiveIntervals.end(), SAscendingSpanEndSort() );
+				}
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//	gCPUState access, relative to the pinned state register
+//*****************************************************************************
+void CCodeGeneratorX64::GetVar( EAmd64Reg reg, const u32 * p_var )
+{
+	MOV_REG_MEM( reg, gCPUStateReg, CPUStateOffset( p_var ) );
+}
+
+void CCodeGeneratorX64::SetVar( const u32 * p_var, u32 value )
+{
+	MOV_MEM_I32( gCPUStateReg, CPUStateOffset( p_var ), value );
+}
+
+void CCodeGeneratorX64::SetVar( const u32 * p_var, EAmd64Reg reg )
+{
+	MOV_MEM_REG( gCPUStateReg, CPUStateOffset( p_var ), reg );
+}
+
+void CCodeGeneratorX64::GetVar64( EAmd64Reg reg, const u64 * p_var )
+{
+	MOV64_REG_MEM( reg, gCPUStateReg, CPUStateOffset( p_var ) );
+}
+
+void CCodeGeneratorX64::SetVar64( const u64 * p_var, s64 value )
+{
+	if( value == s64( s32( value ) ) )
+	{
+		MOV64_MEM_I32( gCPUStateReg, CPUStateOffset( p_var ), s32( value ) );
+	}
+	else
+	{
+		MOVI64( Amd64Reg_RDX, value );
+		MOV64_MEM_REG( gCPUStateReg, CPUStateOffset( p_var ), Amd64Reg_RDX );
+	}
+}
+
+void CCodeGeneratorX64::SetVar64( const u64 * p_var, EAmd64Reg reg )
+{
+	MOV64_MEM_REG( gCPUStateReg, CPUStateOffset( p_var ), reg );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+RegisterSnapshotHandle	CCodeGeneratorX64::GetRegisterSnapshot()
+{
+	RegisterSnapshotHandle	handle( mRegisterSnapshots.size() );
+
+	mRegisterSnapshots.push_back( mRegisterCache );
+
+	return handle;
+}
+
+const CN64RegisterCacheX64 & CCodeGeneratorX64::GetRegisterCacheFromHandle( RegisterSnapshotHandle snapshot ) const
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( snapshot.Handle < mRegisterSnapshots.size(), "Invalid snapshot handle" );
+	#endif
+	return mRegisterSnapshots[ snapshot.Handle ];
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeLabel	CCodeGeneratorX64::GetEntryPoint() const
+{
+	return mpPrimary->GetStartAddress();
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CCodeLabel	CCodeGeneratorX64::GetCurrentLocation() const
+{
+	return mpPrimary->GetLabel();
+}
+
+//*****************************************************************************
+//	Register cache
+//*****************************************************************************
+void	CCodeGeneratorX64::GetRegisterValue( EAmd64Reg host_reg, EN64Reg n64_reg )
+{
+	if( mRegisterCache.IsKnownValue( n64_reg ) )
+	{
+		MOVI64( host_reg, mRegisterCache.GetKnownValue( n64_reg ) );
+		if( mRegisterCache.IsCached( n64_reg ) )
+		{
+			mRegisterCache.MarkAsValid( n64_reg, true );
+			mRegisterCache.MarkAsDirty( n64_reg, true );
+			mRegisterCache.ClearKnownValue( n64_reg );
+		}
+	}
+	else
+	{
+		GetVar64( host_reg, &gGPR[ n64_reg ]._u64 );
+	}
+}
+
+//	Similar to GetRegisterAndLoad, but ALWAYS loads into the specified host register
+void CCodeGeneratorX64::LoadRegister( EAmd64Reg host_reg, EN64Reg n64_reg )
+{
+	if( mRegisterCache.IsCached( n64_reg ) )
+	{
+		EAmd64Reg	cached_reg( mRegisterCache.GetCachedReg( n64_reg ) );
+
+		// Load the register if it's currently invalid
+		if( !mRegisterCache.IsValid( n64_reg ) )
+		{
+			GetRegisterValue( cached_reg, n64_reg );
+			mRegisterCache.MarkAsValid( n64_reg, true );
+		}
+
+		// Copy the register if necessary
+		if( host_reg != cached_reg )
+		{
+			MOV64( host_reg, cached_reg );
+		}
+	}
+	else if( n64_reg == N64Reg_R0 )
+	{
+		MOVI( host_reg, 0 );
+	}
+	else
+	{
+		GetRegisterValue( host_reg, n64_reg );
+	}
+}
+
+//	This function pulls in a cached register so that it can be used at a later point.
+//	This is usally done when we have a branching instruction - it guarantees that
+//	the register is valid regardless of whether or not the branch is taken.
+void	CCodeGeneratorX64::PrepareCachedRegister( EN64Reg n64_reg )
+{
+	if( mRegisterCache.IsCached( n64_reg ) )
+	{
+		EAmd64Reg	cached_reg( mRegisterCache.GetCachedReg( n64_reg ) );
+
+		// Load the register if it's currently invalid
+		if( !mRegisterCache.IsValid( n64_reg ) )
+		{
+			GetRegisterValue( cached_reg, n64_reg );
+			mRegisterCache.MarkAsValid( n64_reg, true );
+		}
+	}
+}
+
+//	Flush a specific register back to memory if dirty.
+//	Clears the dirty flag and invalidates the contents if specified
+void CCodeGeneratorX64::FlushRegister( CN64RegisterCacheX64 & cache, EN64Reg n64_reg, bool invalidate )
+{
+	if( cache.IsDirty( n64_reg ) )
+	{
+		if( cache.IsKnownValue( n64_reg ) )
+		{
+			SetVar64( &gGPR[ n64_reg ]._u64, cache.GetKnownValue( n64_reg ) );
+		}
+		else if( cache.IsCached( n64_reg ) )
+		{
+			#ifdef DAEDALUS_ENABLE_ASSERTS
+			DAEDALUS_ASSERT( cache.IsValid( n64_reg ), "Register is dirty but not valid?" );
+			#endif
+			SetVar64( &gGPR[ n64_reg ]._u64, cache.GetCachedReg( n64_reg ) );
+		}
+		#ifdef DAEDALUS_DEBUG_CONSOLE
+		else
+		{
+			DAEDALUS_ERROR( "Register is dirty, but not known or cached" );
+		}
+		#endif
+		// We're no longer dirty
+		cache.MarkAsDirty( n64_reg, false );
+	}
+
+	// Invalidate the register, so we pick up any values the function might have changed
+	if( invalidate )
+	{
+		cache.ClearKnownValue( n64_reg );
+		if( cache.IsCached( n64_reg ) )
+		{
+			cache.MarkAsValid( n64_reg, false );
+		}
+	}
+}
+
+//	This function flushes all dirty registers back to memory
+//	If the invalidate flag is set this also invalidates the known value/cached
+//	register. This is primarily to ensure that we keep the register set
+//	in a consistent set across calls to generic functions.
+void	CCodeGeneratorX64::FlushAllRegisters( CN64RegisterCacheX64 & cache, bool invalidate )
+{
+	// Skip r0
+	for( u32 i {1}; i < NUM_N64_REGS; i++ )
+	{
+		FlushRegister( cache, EN64Reg( i ), invalidate );
+	}
+}
+
+void	CCodeGeneratorX64::RestoreAllRegisters( CN64RegisterCacheX64 & current_cache, CN64RegisterCacheX64 & new_cache )
+{
+	// Skip r0
+	for( u32 i {1}; i < NUM_N64_REGS; i++ )
+	{
+		EN64Reg	n64_reg = EN64Reg( i );
+
+		if( new_cache.IsValid( n64_reg ) && !current_cache.IsValid( n64_reg ) )
+		{
+			GetVar64( new_cache.GetCachedReg( n64_reg ), &gGPR[ n64_reg ]._u64 );
+		}
+	}
+}
+
+void CCodeGeneratorX64::StoreRegister( EN64Reg n64_reg, EAmd64Reg host_reg )
+{
+	// Writes to r0 are discarded
+	if( n64_reg == N64Reg_R0 )
+		return;
+
+	mRegisterCache.ClearKnownValue( n64_reg );
+
+	if( mRegisterCache.IsCached( n64_reg ) )
+	{
+		EAmd64Reg	cached_reg( mRegisterCache.GetCachedReg( n64_reg ) );
+
+		// Update our copy as necessary
+		if( host_reg != cached_reg )
+		{
+			MOV64( cached_reg, host_reg );
+		}
+		mRegisterCache.MarkAsDirty( n64_reg, true );
+		mRegisterCache.MarkAsValid( n64_reg, true );
+	}
+	else
+	{
+		SetVar64( &gGPR[ n64_reg ]._u64, host_reg );
+
+		mRegisterCache.MarkAsDirty( n64_reg, false );
+	}
+}
+
+//	Store the low 32 bits of host_reg, sign extended to 64 bits
+void CCodeGeneratorX64::StoreRegister32s( EN64Reg n64_reg, EAmd64Reg host_reg )
+{
+	if( n64_reg == N64Reg_R0 )
+		return;
+
+	if( mRegisterCache.IsCached( n64_reg ) )
+	{
+		MOVSXD( mRegisterCache.GetCachedReg( n64_reg ), host_reg );
+		StoreRegister( n64_reg, mRegisterCache.GetCachedReg( n64_reg ) );
+	}
+	else
+	{
+		MOVSXD( host_reg, host_reg );
+		StoreRegister( n64_reg, host_reg );
+	}
+}
+
+void CCodeGeneratorX64::SetRegister( EN64Reg n64_reg, s64 value )
+{
+	if( n64_reg == N64Reg_R0 )
+		return;
+
+	mRegisterCache.SetKnownValue( n64_reg, value );
+	mRegisterCache.MarkAsDirty( n64_reg, true );
+	if( mRegisterCache.IsCached( n64_reg ) )
+	{
+		mRegisterCache.MarkAsValid( n64_reg, false );		// The actual cache is invalid though!
+	}
+}
+
+//Get a (cached) N64 register mapped to a host register (usefull for dst register)
+EAmd64Reg	CCodeGeneratorX64::GetRegisterNoLoad( EN64Reg n64_reg, EAmd64Reg scratch_reg )
+{
+	if( mRegisterCache.IsCached( n64_reg ) )
+	{
+		return mRegisterCache.GetCachedReg( n64_reg );
+	}
+	else
+	{
+		return scratch_reg;
+	}
+}
+
+//Get (cached) N64 register value mapped to a host register (or scratch reg)
+//and also load the value if not loaded yet (usefull for src register)
+EAmd64Reg	CCodeGeneratorX64::GetRegisterAndLoad( EN64Reg n64_reg, EAmd64Reg scratch_reg )
+{
+	EAmd64Reg	reg;
+	bool		need_load( false );
+
+	if( mRegisterCache.IsCached( n64_reg ) )
+	{
+		reg = mRegisterCache.GetCachedReg( n64_reg );
+
+		// We're loading it below, so set the valid flag
+		if( !mRegisterCache.IsValid( n64_reg ) )
+		{
+			need_load = true;
+			mRegisterCache.MarkAsValid( n64_reg, true );
+		}
+	}
+	else if( n64_reg == N64Reg_R0 )
+	{
+		reg = scratch_reg;
+
+		MOVI( scratch_reg, 0 );
+	}
+	else
+	{
+		reg = scratch_reg;
+		need_load = true;
+	}
+
+	if( need_load )
+	{
+		GetRegisterValue( reg, n64_reg );
+	}
+
+	return reg;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation CCodeGeneratorX64::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment, CCodeLabel * p_fallback )
+{
+	DAEDALUS_ASSERT( !next_fragment.IsSet() || jump_address == 0, "Shouldn't be specifying a jump address if we have a next fragment?" );
+
+	if( (exit_address == mEntryAddress) & mLoopTop.IsSet() )
+	{
+		#ifdef DAEDALUS_ENABLE_ASSERTS
+		DAEDALUS_ASSERT( mUseFixedRegisterAllocation, "Have mLoopTop but unfixed register allocation?" );
+		#endif
+
+		//
+		//	Pull in any registers which may have been flushed for whatever reason.
+		//
+		// Skip r0
+		for( u32 i {1}; i < NUM_N64_REGS; i++ )
+		{
+			PrepareCachedRegister( EN64Reg( i ) );
+		}
+
+		// Assuming we don't need to set CurrentPC/Delay flags before we branch to the top..
+		ALU_MEM_I32( Amd64Alu_ADD, gCPUStateReg, CPUStateOffset( &gCPUState.CPUControl[C0_COUNT]._u32 ), num_instructions );
+
+		//
+		//	If the event counter is still positive, just jump directly to the top of our loop
+		//
+		ALU_MEM_I32( Amd64Alu_SUB, gCPUStateReg, CPUStateOffset( &gCPUState.Events[0].mCount ), num_instructions );
+		JCCLong( Amd64Cond_G, mLoopTop );
+
+		FlushAllRegisters( mRegisterCache, true );
+
+		SetVar( &gCPUState.CurrentPC, exit_address );
+		SetVar( &gCPUState.Delay, NO_DELAY );
+
+		CALL( CCodeLabel( reinterpret_cast< const void * >( CPU_HANDLE_COUNT_INTERRUPT ) ) );
+
+		RET();
+		//
+		//	Return an invalid jump location to indicate we've handled our own linking.
+		//
+		return CJumpLocation( nullptr );
+	}
+
+	FlushAllRegisters( mRegisterCache, true );
+
+	MOVI( Amd64Reg_Arg0, num_instructions );
+	MOVI( Amd64Reg_Arg1, exit_address );
+	if( jump_address != 0 )
+	{
+		MOVI( Amd64Reg_Arg2, jump_address );
+		CALL( CCodeLabel( reinterpret_cast< const void * >( _DirectExitCheckDelay ) ) );
+	}
+	else
+	{
+		CALL( CCodeLabel( reinterpret_cast< const void * >( _DirectExitCheckNoDelay ) ) );
+	}
+
+	// If the flag was set, we need in initialise the pc/delay to exit with
+	CJumpLocation	jump_to_next_fragment( JMPLong( CCodeLabel( nullptr ) ) );
+
+	CCodeLabel		interpret_next_fragment( GetAssemblyBuffer()->GetLabel() );
+	*p_fallback = interpret_next_fragment;
+	// No need to call CPU_SetPC(), as this is handled by CFragment when we exit
+	RET();
+
+	// Patch up the exit jump
+	if( !next_fragment.IsSet() )
+	{
+		PatchJumpLong( jump_to_next_fragment, interpret_next_fragment );
+	}
+
+	return jump_to_next_fragment;
+}
+
+//*****************************************************************************
+// Handle branching back to the interpreter after an ERET
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map )
+{
+	FlushAllRegisters( mRegisterCache, true );
+
+	MOVI( Amd64Reg_Arg0, num_instructions );
+	MOVI64( Amd64Reg_Arg1, reinterpret_cast< intptr_t >( p_map ) );
+	GetVar( Amd64Reg_Arg2, &gCPUState.CurrentPC );
+	// Eret is a bit bodged so we exit at PC + 4
+	ADDI( Amd64Reg_Arg2, 4 );
+
+	CALL( CCodeLabel( reinterpret_cast< const void * >( _IndirectExitCheck ) ) );
+}
+
+//*****************************************************************************
+// Handle branching back to the interpreter after an indirect jump
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map )
+{
+	FlushAllRegisters( mRegisterCache, true );
+
+	MOVI( Amd64Reg_Arg0, num_instructions );
+	MOVI64( Amd64Reg_Arg1, reinterpret_cast< intptr_t >( p_map ) );
+	GetVar( Amd64Reg_Arg2, &gCPUState.TargetPC );
+
+	CALL( CCodeLabel( reinterpret_cast< const void * >( _IndirectExitCheck ) ) );
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateExceptionHander( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps, const std::vector< RegisterSnapshotHandle >& exception_handler_snapshots )
+{
+	SetBufferB();
+
+	CCodeLabel	exception_handler( GetAssemblyBuffer()->GetLabel() );
+
+	CALL( CCodeLabel( reinterpret_cast< const void * >( p_exception_handler_fn ) ) );
+	RET();
+
+	for( u32 i {0}; i < exception_handler_jumps.size(); i++ )
+	{
+		CJumpLocation	jump( exception_handler_jumps[i] );
+		PatchJumpLong( jump, GetAssemblyBuffer()->GetLabel() );
+
+		CN64RegisterCacheX64	cache( GetRegisterCacheFromHandle( exception_handler_snapshots[i] ) );
+		FlushAllRegisters( cache, true );
+
+		// jump to the handler
+		GenerateBranchAlways( exception_handler );
+	}
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateBranchAlways( CCodeLabel target )
+{
+	return JMPLong( target );
+}
+
+CJumpLocation	CCodeGeneratorX64::GenerateBranchIfSet( const u32 * p_var, CCodeLabel target )
+{
+	ALU_MEM_I32( Amd64Alu_CMP, gCPUStateReg, CPUStateOffset( p_var ), 0 );
+
+	return JCCLong( Amd64Cond_NE, target );
+}
+
+CJumpLocation	CCodeGeneratorX64::GenerateBranchIfEqual( const u32 * p_var, u32 value, CCodeLabel target )
+{
+	ALU_MEM_I32( Amd64Alu_CMP, gCPUStateReg, CPUStateOffset( p_var ), s32( value ) );
+
+	return JCCLong( Amd64Cond_E, target );
+}
+
+CJumpLocation	CCodeGeneratorX64::GenerateBranchIfNotEqual( const u32 * p_var, u32 value, CCodeLabel target )
+{
+	ALU_MEM_I32( Amd64Alu_CMP, gCPUStateReg, CPUStateOffset( p_var ), s32( value ) );
+
+	return JCCLong( Amd64Cond_NE, target );
+}
+
+//*****************************************************************************
+//	Generates instruction handler for the specified op code.
+//	Returns a jump location if an exception handler is required
+//*****************************************************************************
+CJumpLocation	CCodeGeneratorX64::GenerateOpCode( const STraceEntry& ti, bool branch_delay_slot, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	u32			address = ti.Address;
+	bool		exception = false;
+	OpCode		op_code = ti.OpCode;
+
+	CJumpLocation	exception_handler( nullptr );
+
+	if( op_code._u32 == 0 )
+	{
+		if( branch_delay_slot )
+		{
+			SetVar( &gCPUState.Delay, NO_DELAY );
+		}
+		return CJumpLocation( nullptr );
+	}
+
+	if( branch_delay_slot )
+	{
+		SetVar( &gCPUState.Delay, EXEC_DELAY );
+	}
+
+	const EN64Reg	rs = EN64Reg( op_code.rs );
+	const EN64Reg	rt = EN64Reg( op_code.rt );
+	const EN64Reg	rd = EN64Reg( op_code.rd );
+	const u32		sa = op_code.sa;
+	const EN64Reg	base = EN64Reg( op_code.base );
+
+	bool handled = false;
+
+	switch( op_code.op )
+	{
+		case OP_J:			/* nothing to do */		handled = true; break;
+
+		case OP_JAL: 	GenerateJAL( address ); handled = true; break;
+
+		// The 'likely' bit is handled elsewhere
+		case OP_BEQ:
+		case OP_BEQL:	GenerateCompareBranch( rs, rt, Amd64Cond_E, p_branch, p_branch_jump ); handled = true; break;
+		case OP_BNE:
+		case OP_BNEL:	GenerateCompareBranch( rs, rt, Amd64Cond_NE, p_branch, p_branch_jump ); handled = true; break;
+		case OP_BLEZ:
+		case OP_BLEZL:	GenerateCompareBranch( rs, N64Reg_R0, Amd64Cond_LE, p_branch, p_branch_jump ); handled = true; break;
+		case OP_BGTZ:
+		case OP_BGTZL:	GenerateCompareBranch( rs, N64Reg_R0, Amd64Cond_G, p_branch, p_branch_jump ); handled = true; break;
+
+		case OP_ADDI:	GenerateADDIU( rt, rs, s16( op_code.immediate ) ); handled = true; break;
+		case OP_ADDIU:	GenerateADDIU( rt, rs, s16( op_code.immediate ) ); handled = true; break;
+		case OP_ANDI:	GenerateANDI( rt, rs, op_code.immediate ); handled = true; break;
+		case OP_ORI:	GenerateORI( rt, rs, op_code.immediate ); handled = true; break;
+		case OP_XORI:	GenerateXORI( rt, rs, op_code.immediate ); handled = true; break;
+
+		case OP_DADDI:	GenerateDADDIU( rt, rs, s16( op_code.immediate ) ); handled = true; break;
+		case OP_DADDIU:	GenerateDADDIU( rt, rs, s16( op_code.immediate ) ); handled = true; break;
+
+		case OP_SLTIU: 	GenerateSLTI( rt, rs, s16( op_code.immediate ), true );  handled = true; break;
+		case OP_SLTI:	GenerateSLTI( rt, rs, s16( op_code.immediate ), false ); handled = true; break;
+
+		case OP_LUI:	GenerateLUI( rt, s16( op_code.immediate ) ); handled = true; break;
+
+		case OP_SW:		handled = GenerateSW( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_SH:		handled = GenerateSH( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_SB:		handled = GenerateSB( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_SD:		handled = GenerateSD( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+
+		case OP_LW:		handled = GenerateLW( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_LH:		handled = GenerateLH( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_LHU: 	handled = GenerateLHU( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_LB: 	handled = GenerateLB( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_LBU:	handled = GenerateLBU( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+		case OP_LD:		handled = GenerateLD( address, branch_delay_slot, rt, base, s16( op_code.immediate ) ); exception = !handled; break;
+
+		case OP_CACHE:	handled = GenerateCACHE( base, op_code.immediate, rt ); exception = !handled; break;
+
+		case OP_REGIMM:
+			switch( op_code.regimm_op )
+			{
+				case RegImmOp_BLTZ:
+				case RegImmOp_BLTZL: GenerateCompareBranch( rs, N64Reg_R0, Amd64Cond_L, p_branch, p_branch_jump ); handled = true; break;
+
+				case RegImmOp_BGEZ:
+				case RegImmOp_BGEZL: GenerateCompareBranch( rs, N64Reg_R0, Amd64Cond_GE, p_branch, p_branch_jump ); handled = true; break;
+			}
+			break;
+
+		case OP_SPECOP:
+			switch( op_code.spec_op )
+			{
+				case SpecOp_SLL: 	GenerateShift( rd, rt, sa, Amd64Shift_SHL ); handled = true; break;
+				case SpecOp_SRL: 	GenerateShift( rd, rt, sa, Amd64Shift_SHR ); handled = true; break;
+				case SpecOp_SRA: 	GenerateShift( rd, rt, sa, Amd64Shift_SAR ); handled = true; break;
+				case SpecOp_SLLV:	GenerateShiftVariable( rd, rs, rt, Amd64Shift_SHL ); handled = true; break;
+				case SpecOp_SRLV:	GenerateShiftVariable( rd, rs, rt, Amd64Shift_SHR ); handled = true; break;
+				case SpecOp_SRAV:	GenerateShiftVariable( rd, rs, rt, Amd64Shift_SAR ); handled = true; break;
+
+				case SpecOp_OR:		GenerateALU64( rd, rs, rt, Amd64Alu_OR ); handled = true; break;
+				case SpecOp_AND:	GenerateALU64( rd, rs, rt, Amd64Alu_AND ); handled = true; break;
+				case SpecOp_XOR:	GenerateALU64( rd, rs, rt, Amd64Alu_XOR ); handled = true; break;
+				case SpecOp_NOR:	GenerateNOR( rd, rs, rt ); handled = true; break;
+
+				case SpecOp_ADD:	GenerateADDU( rd, rs, rt ); handled = true; break;
+				case SpecOp_ADDU:	GenerateADDU( rd, rs, rt ); handled = true; break;
+				case SpecOp_SUB:	GenerateSUBU( rd, rs, rt ); handled = true; break;
+				case SpecOp_SUBU:	GenerateSUBU( rd, rs, rt ); handled = true; break;
+
+				case SpecOp_DADD:	GenerateALU64( rd, rs, rt, Amd64Alu_ADD ); handled = true; break;
+				case SpecOp_DADDU:	GenerateALU64( rd, rs, rt, Amd64Alu_ADD ); handled = true; break;
+				case SpecOp_DSUB:	GenerateALU64( rd, rs, rt, Amd64Alu_SUB ); handled = true; break;
+				case SpecOp_DSUBU:	GenerateALU64( rd, rs, rt, Amd64Alu_SUB ); handled = true; break;
+
+				case SpecOp_MULTU:	GenerateMULT( rs, rt, true ); handled = true; break;
+				case SpecOp_MULT:	GenerateMULT( rs, rt, false ); handled = true; break;
+
+				case SpecOp_MFLO:	GenerateMFLO( rd ); handled = true; break;
+				case SpecOp_MFHI:	GenerateMFHI( rd ); handled = true; break;
+				case SpecOp_MTLO:	GenerateMTLO( rs ); handled = true; break;
+				case SpecOp_MTHI:	GenerateMTHI( rs ); handled = true; break;
+
+				case SpecOp_SLT:	GenerateSLT( rd, rs, rt, false ); handled = true; break;
+				case SpecOp_SLTU:	GenerateSLT( rd, rs, rt, true ); handled = true; break;
+
+				case SpecOp_JR:		GenerateJR( rs, p_branch, p_branch_jump ); handled = true; break;
+				case SpecOp_JALR:	GenerateJALR( rs, rd, address, p_branch, p_branch_jump ); handled = true; break;
+
+				default: break;
+			}
+			break;
+
+		// COP0/COP1 go through the interpreter for now
+		default: break;
+	}
+
+	if( !handled )
+	{
+		CCodeLabel	no_target( nullptr );
+
+		if( R4300_InstructionHandlerNeedsPC( op_code ) )
+		{
+			SetVar( &gCPUState.CurrentPC, address );
+			exception = true;
+		}
+
+		GenerateGenericR4300( op_code, R4300_GetInstructionHandler( op_code ) );
+
+		if( exception )
+		{
+			exception_handler = GenerateBranchIfSet( const_cast< u32 * >( &gCPUState.StuffToDo ), no_target );
+		}
+
+		// Check whether we want to invert the status of this branch
+		if( p_branch != nullptr )
+		{
+			//
+			// Check if the branch has been taken
+			//
+			if( p_branch->Direct )
+			{
+				if( p_branch->ConditionalBranchTaken )
+				{
+					*p_branch_jump = GenerateBranchIfNotEqual( &gCPUState.Delay, DO_DELAY, no_target );
+				}
+				else
+				{
+					*p_branch_jump = GenerateBranchIfEqual( &gCPUState.Delay, DO_DELAY, no_target );
+				}
+			}
+			else
+			{
+				// XXXX eventually just exit here, and skip default exit code below
+				if( p_branch->Eret )
+				{
+					*p_branch_jump = GenerateBranchAlways( no_target );
+				}
+				else
+				{
+					*p_branch_jump = GenerateBranchIfNotEqual( &gCPUState.TargetPC, p_branch->TargetAddress, no_target );
+				}
+			}
+		}
+		else
+		{
+			if( branch_delay_slot )
+			{
+				SetVar( &gCPUState.Delay, NO_DELAY );
+			}
+		}
+	}
+	else
+	{
+		if( exception )
+		{
+			exception_handler = GenerateBranchIfSet( const_cast< u32 * >( &gCPUState.StuffToDo ), CCodeLabel( nullptr ) );
+		}
+
+		if( p_branch && branch_delay_slot )
+		{
+			SetVar( &gCPUState.Delay, NO_DELAY );
+		}
+	}
+
+	return exception_handler;
+}
+
+void	CCodeGeneratorX64::GenerateBranchHandler( CJumpLocation branch_handler_jump, RegisterSnapshotHandle snapshot )
+{
+	PatchJumpLong( branch_handler_jump, GetAssemblyBuffer()->GetLabel() );
+	mRegisterCache = GetRegisterCacheFromHandle( snapshot );
+}
+
+void	CCodeGeneratorX64::GenerateGenericR4300( OpCode op_code, CPU_Instruction p_instruction )
+{
+	FlushAllRegisters( mRegisterCache, true );
+
+	MOVI( Amd64Reg_Arg0, op_code._u32 );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( p_instruction ) ) );
+}
+
+CJumpLocation CCodeGeneratorX64::ExecuteNativeFunction( CCodeLabel speed_hack, bool check_return )
+{
+	FlushAllRegisters( mRegisterCache, true );
+	CALL( speed_hack );
+
+	if( check_return )
+	{
+		TEST( Amd64Reg_RAX, Amd64Reg_RAX );
+		return JCCLong( Amd64Cond_E, CCodeLabel( nullptr ) );
+	}
+	else
+	{
+		return CJumpLocation( nullptr );
+	}
+}
+
+//*****************************************************************************
+//
+//	Load/Store Instructions
+//
+//	Addresses in [0x80000000, 0x80000000+gRamSize) go straight to rdram through
+//	the pinned memory base. Everything else takes a slow path in the secondary
+//	buffer, which calls the same memory handlers as the interpreter.
+//
+//*****************************************************************************
+
+// Leaves the effective address in eax
+void CCodeGeneratorX64::GenerateAddress( EN64Reg base, s16 offset )
+{
+	if( mRegisterCache.IsKnownValue( base ) )
+	{
+		MOVI( Amd64Reg_RAX, u32( mRegisterCache.GetKnownValue( base ) + offset ) );
+	}
+	else
+	{
+		EAmd64Reg reg_base = GetRegisterAndLoad( base, Amd64Reg_RAX );
+		LEA( Amd64Reg_RAX, reg_base, offset );
+	}
+}
+
+void CCodeGeneratorX64::GenerateLoad( u32 current_pc, EAmd64Reg host_dst, EN64Reg base, s16 offset, u8 twiddle, u8 bits, bool is_signed, ReadMemoryFunction p_read_memory )
+{
+	GenerateAddress( base, offset );
+
+	// Signed compare - kseg0 addresses are negative, anything else is above the bound
+	CMP( Amd64Reg_RAX, gMemUpperBoundReg );
+	CJumpLocation	slow_path( JCCLong( Amd64Cond_GE, CCodeLabel( nullptr ) ) );
+
+	EAmd64Reg	index_reg = Amd64Reg_RAX;
+	if( twiddle != 0 )
+	{
+		MOV( Amd64Reg_RCX, Amd64Reg_RAX );
+		XORI( Amd64Reg_RCX, twiddle );
+		index_reg = Amd64Reg_RCX;
+	}
+
+	LOAD_BASE_INDEX( bits, is_signed, host_dst, gMemoryBaseReg, index_reg );
+	if( bits == 64 )
+	{
+		// Words are stored swapped in rdram
+		ROLI64( host_dst, 32 );
+	}
+
+	CJumpLocation	skip;
+	CCodeLabel		current;
+
+	if( IsBufferB() )
+	{
+		skip = GenerateBranchAlways( CCodeLabel( nullptr ) );
+	}
+	else
+	{
+		current = GetAssemblyBuffer()->GetLabel();
+		SetBufferB();
+	}
+
+	PatchJumpLong( slow_path, GetAssemblyBuffer()->GetLabel() );
+
+	CN64RegisterCacheX64	current_regs( mRegisterCache );
+	FlushAllRegisters( mRegisterCache, true );
+
+	MOV( Amd64Reg_Arg0, Amd64Reg_RAX );
+	MOVI( Amd64Reg_Arg1, current_pc );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( p_read_memory ) ) );
+
+	// Restore all registers BEFORE copying back final value
+	RestoreAllRegisters( mRegisterCache, current_regs );
+	if( host_dst != Amd64Reg_RAX )
+	{
+		MOV64( host_dst, Amd64Reg_RAX );
+	}
+	mRegisterCache = current_regs;
+
+	if( current.IsSet() )
+	{
+		// return back to our original buffer
+		GenerateBranchAlways( current );
+		SetBufferA();
+	}
+	else
+	{
+		// patch the unconditional branch to skip the slow path
+		PatchJumpLong( skip, GetAssemblyBuffer()->GetLabel() );
+	}
+}
+
+void CCodeGeneratorX64::GenerateStore( u32 current_pc, EAmd64Reg host_src, EN64Reg base, s16 offset, u8 twiddle, u8 bits, WriteMemoryFunction p_write_memory )
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( host_src != Amd64Reg_RAX && host_src != Amd64Reg_RDX, "Store source clashes with a scratch register" );
+	#endif
+
+	GenerateAddress( base, offset );
+
+	CMP( Amd64Reg_RAX, gMemUpperBoundReg );
+	CJumpLocation	slow_path( JCCLong( Amd64Cond_GE, CCodeLabel( nullptr ) ) );
+
+	if( bits == 64 )
+	{
+		// Words are stored swapped in rdram
+		MOV64( Amd64Reg_RDX, host_src );
+		ROLI64( Amd64Reg_RDX, 32 );
+		STORE_BASE_INDEX( bits, gMemoryBaseReg, Amd64Reg_RAX, Amd64Reg_RDX );
+	}
+	else if( twiddle != 0 )
+	{
+		MOV( Amd64Reg_RDX, Amd64Reg_RAX );
+		XORI( Amd64Reg_RDX, twiddle );
+		STORE_BASE_INDEX( bits, gMemoryBaseReg, Amd64Reg_RDX, host_src );
+	}
+	else
+	{
+		STORE_BASE_INDEX( bits, gMemoryBaseReg, Amd64Reg_RAX, host_src );
+	}
+
+	CJumpLocation	skip;
+	CCodeLabel		current;
+
+	if( IsBufferB() )
+	{
+		skip = GenerateBranchAlways( CCodeLabel( nullptr ) );
+	}
+	else
+	{
+		current = GetAssemblyBuffer()->GetLabel();
+		SetBufferB();
+	}
+
+	PatchJumpLong( slow_path, GetAssemblyBuffer()->GetLabel() );
+
+	CN64RegisterCacheX64	current_regs( mRegisterCache );
+	FlushAllRegisters( mRegisterCache, true );
+
+	// host_src may be rdi, so it has to be moved out of the way first
+	if( host_src != Amd64Reg_Arg1 )
+	{
+		MOV64( Amd64Reg_Arg1, host_src );
+	}
+	MOV( Amd64Reg_Arg0, Amd64Reg_RAX );
+	MOVI( Amd64Reg_Arg2, current_pc );
+	CALL( CCodeLabel( reinterpret_cast< const void * >( p_write_memory ) ) );
+
+	RestoreAllRegisters( mRegisterCache, current_regs );
+	mRegisterCache = current_regs;
+
+	if( current.IsSet() )
+	{
+		// return back to our original buffer
+		GenerateBranchAlways( current );
+		SetBufferA();
+	}
+	else
+	{
+		// patch the unconditional branch to skip the slow path
+		PatchJumpLong( skip, GetAssemblyBuffer()->GetLabel() );
+	}
+}
+
+//Load Word
+bool CCodeGeneratorX64::GenerateLW( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_dst = GetRegisterNoLoad( rt, Amd64Reg_RCX );
+	GenerateLoad( address, host_dst, base, offset, 0, 32, true, set_branch_delay ? _ReadBitsDirectBD_s32 : _ReadBitsDirect_s32 );
+	StoreRegister( rt, host_dst );
+	return true;
+}
+
+//Load Double Word
+bool CCodeGeneratorX64::GenerateLD( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_dst = GetRegisterNoLoad( rt, Amd64Reg_RCX );
+	GenerateLoad( address, host_dst, base, offset, 0, 64, false, set_branch_delay ? _ReadBitsDirectBD_u64 : _ReadBitsDirect_u64 );
+	StoreRegister( rt, host_dst );
+	return true;
+}
+
+//Load half word signed
+bool CCodeGeneratorX64::GenerateLH( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_dst = GetRegisterNoLoad( rt, Amd64Reg_RCX );
+	GenerateLoad( address, host_dst, base, offset, U16_TWIDDLE, 16, true, set_branch_delay ? _ReadBitsDirectBD_s16 : _ReadBitsDirect_s16 );
+	StoreRegister( rt, host_dst );
+	return true;
+}
+
+//Load half word unsigned
+bool CCodeGeneratorX64::GenerateLHU( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_dst = GetRegisterNoLoad( rt, Amd64Reg_RCX );
+	GenerateLoad( address, host_dst, base, offset, U16_TWIDDLE, 16, false, set_branch_delay ? _ReadBitsDirectBD_u16 : _ReadBitsDirect_u16 );
+	StoreRegister( rt, host_dst );
+	return true;
+}
+
+//Load byte signed
+bool CCodeGeneratorX64::GenerateLB( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_dst = GetRegisterNoLoad( rt, Amd64Reg_RCX );
+	GenerateLoad( address, host_dst, base, offset, U8_TWIDDLE, 8, true, set_branch_delay ? _ReadBitsDirectBD_s8 : _ReadBitsDirect_s8 );
+	StoreRegister( rt, host_dst );
+	return true;
+}
+
+//Load byte unsigned
+bool CCodeGeneratorX64::GenerateLBU( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_dst = GetRegisterNoLoad( rt, Amd64Reg_RCX );
+	GenerateLoad( address, host_dst, base, offset, U8_TWIDDLE, 8, false, set_branch_delay ? _ReadBitsDirectBD_u8 : _ReadBitsDirect_u8 );
+	StoreRegister( rt, host_dst );
+	return true;
+}
+
+//Store Word
+bool CCodeGeneratorX64::GenerateSW( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_src = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+	GenerateStore( address, host_src, base, offset, 0, 32, set_branch_delay ? _WriteBitsDirectBD_u32 : _WriteBitsDirect_u32 );
+	return true;
+}
+
+//Store Double Word
+bool CCodeGeneratorX64::GenerateSD( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_src = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+	GenerateStore( address, host_src, base, offset, 0, 64, set_branch_delay ? _WriteBitsDirectBD_u64 : _WriteBitsDirect_u64 );
+	return true;
+}
+
+//Store Half Word
+bool CCodeGeneratorX64::GenerateSH( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_src = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+	GenerateStore( address, host_src, base, offset, U16_TWIDDLE, 16, set_branch_delay ? _WriteBitsDirectBD_u16 : _WriteBitsDirect_u16 );
+	return true;
+}
+
+//Store Byte
+bool CCodeGeneratorX64::GenerateSB( u32 address, bool set_branch_delay, EN64Reg rt, EN64Reg base, s16 offset )
+{
+	EAmd64Reg host_src = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+	GenerateStore( address, host_src, base, offset, U8_TWIDDLE, 8, set_branch_delay ? _WriteBitsDirectBD_u8 : _WriteBitsDirect_u8 );
+	return true;
+}
+
+bool CCodeGeneratorX64::GenerateCACHE( EN64Reg base, s16 offset, u32 cache_op )
+{
+	u32 dwCache = cache_op & 0x3;
+	u32 dwAction = (cache_op >> 2) & 0x7;
+
+	// For instruction cache invalidation, make sure we let the CPU know so the whole
+	// dynarec system can be invalidated
+	if( dwCache == 0 && (dwAction == 0 || dwAction == 4) )
+	{
+		FlushAllRegisters( mRegisterCache, true );
+
+		// Read straight from memory - going through the cache would mark a caller saved register valid across the call
+		GetVar( Amd64Reg_Arg0, &gGPR[ base ]._u32_0 );
+		ADDI( Amd64Reg_Arg0, offset );
+		MOVI( Amd64Reg_Arg1, 0x20 );
+		CALL( CCodeLabel( reinterpret_cast< const void * >( CPU_InvalidateICacheRange ) ) );
+
+		return true;
+	}
+
+	return false;
+}
+
+//*****************************************************************************
+//
+//	Integer ops
+//
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateLUI( EN64Reg rt, s16 immediate )
+{
+	SetRegister32s( rt, s32( immediate ) << 16 );
+}
+
+void CCodeGeneratorX64::GenerateADDIU( EN64Reg rt, EN64Reg rs, s16 immediate )
+{
+	if( mRegisterCache.IsKnownValue( rs ) )
+	{
+		SetRegister32s( rt, s32( mRegisterCache.GetKnownValue( rs ) ) + immediate );
+		return;
+	}
+
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	LEA( Amd64Reg_RAX, reg_s, immediate );
+	StoreRegister32s( rt, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateDADDIU( EN64Reg rt, EN64Reg rs, s16 immediate )
+{
+	if( mRegisterCache.IsKnownValue( rs ) )
+	{
+		SetRegister( rt, mRegisterCache.GetKnownValue( rs ) + immediate );
+		return;
+	}
+
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	MOV64( Amd64Reg_RAX, reg_s );
+	ADDI64( Amd64Reg_RAX, immediate );
+	StoreRegister( rt, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateANDI( EN64Reg rt, EN64Reg rs, u16 immediate )
+{
+	if( mRegisterCache.IsKnownValue( rs ) )
+	{
+		SetRegister( rt, mRegisterCache.GetKnownValue( rs ) & immediate );
+		return;
+	}
+
+	// The immediate is zero extended, so a 32 bit op gives the right upper half for free
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	MOV( Amd64Reg_RAX, reg_s );
+	ALUI( Amd64Alu_AND, Amd64Reg_RAX, immediate, false );
+	StoreRegister( rt, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateORI( EN64Reg rt, EN64Reg rs, u16 immediate )
+{
+	if( mRegisterCache.IsKnownValue( rs ) )
+	{
+		SetRegister( rt, mRegisterCache.GetKnownValue( rs ) | immediate );
+		return;
+	}
+
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	MOV64( Amd64Reg_RAX, reg_s );
+	ORI64( Amd64Reg_RAX, immediate );
+	StoreRegister( rt, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateXORI( EN64Reg rt, EN64Reg rs, u16 immediate )
+{
+	if( mRegisterCache.IsKnownValue( rs ) )
+	{
+		SetRegister( rt, mRegisterCache.GetKnownValue( rs ) ^ immediate );
+		return;
+	}
+
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	MOV64( Amd64Reg_RAX, reg_s );
+	XORI64( Amd64Reg_RAX, immediate );
+	StoreRegister( rt, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateSLTI( EN64Reg rt, EN64Reg rs, s16 immediate, bool is_unsigned )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+
+	// The immediate is sign extended to 64 bits for both signed and unsigned compares
+	CMPI64( reg_s, immediate );
+	SETCC( is_unsigned ? Amd64Cond_B : Amd64Cond_L, Amd64Reg_RAX );
+	MOVZX8( Amd64Reg_RAX, Amd64Reg_RAX );
+	StoreRegister( rt, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateJAL( u32 address )
+{
+	SetRegister32s( N64Reg_RA, address + 8 );
+}
+
+void CCodeGeneratorX64::GenerateJR( EN64Reg rs, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	EAmd64Reg reg = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	SetVar( &gCPUState.TargetPC, reg );
+	CMPI( reg, s32( p_branch->TargetAddress ) );
+	*p_branch_jump = JCCLong( Amd64Cond_NE, CCodeLabel( nullptr ) );
+}
+
+void CCodeGeneratorX64::GenerateJALR( EN64Reg rs, EN64Reg rd, u32 address, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	// Read rs before setting rd, in case they're the same register
+	EAmd64Reg reg = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	SetVar( &gCPUState.TargetPC, reg );
+
+	SetRegister32s( rd, address + 8 );
+
+	CMPI( reg, s32( p_branch->TargetAddress ) );
+	*p_branch_jump = JCCLong( Amd64Cond_NE, CCodeLabel( nullptr ) );
+}
+
+void CCodeGeneratorX64::GenerateShift( EN64Reg rd, EN64Reg rt, u32 sa, EAmd64ShiftOp op )
+{
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RAX );
+	MOV( Amd64Reg_RAX, reg_t );
+	if( sa != 0 )
+	{
+		SHIFTI( op, Amd64Reg_RAX, u8( sa ), false );
+	}
+	StoreRegister32s( rd, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateShiftVariable( EN64Reg rd, EN64Reg rs, EN64Reg rt, EAmd64ShiftOp op )
+{
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RAX );
+	MOV( Amd64Reg_RAX, reg_t );
+
+	// 32 bit shifts mask the count to 5 bits, just like the R4300
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RCX );
+	if( reg_s != Amd64Reg_RCX )
+	{
+		MOV( Amd64Reg_RCX, reg_s );
+	}
+	SHIFT_CL( op, Amd64Reg_RAX, false );
+	StoreRegister32s( rd, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateALU64( EN64Reg rd, EN64Reg rs, EN64Reg rt, EAmd64AluOp op )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+
+	if( reg_s != Amd64Reg_RAX )
+	{
+		MOV64( Amd64Reg_RAX, reg_s );
+	}
+	ALU( op, Amd64Reg_RAX, reg_t, true );
+	StoreRegister( rd, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateNOR( EN64Reg rd, EN64Reg rs, EN64Reg rt )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+
+	if( reg_s != Amd64Reg_RAX )
+	{
+		MOV64( Amd64Reg_RAX, reg_s );
+	}
+	OR64( Amd64Reg_RAX, reg_t );
+	NOT64( Amd64Reg_RAX );
+	StoreRegister( rd, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateADDU( EN64Reg rd, EN64Reg rs, EN64Reg rt )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+
+	MOV( Amd64Reg_RAX, reg_s );
+	ADD( Amd64Reg_RAX, reg_t );
+	StoreRegister32s( rd, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateSUBU( EN64Reg rd, EN64Reg rs, EN64Reg rt )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+
+	MOV( Amd64Reg_RAX, reg_s );
+	SUB( Amd64Reg_RAX, reg_t );
+	StoreRegister32s( rd, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateSLT( EN64Reg rd, EN64Reg rs, EN64Reg rt, bool is_unsigned )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+
+	CMP64( reg_s, reg_t );
+	SETCC( is_unsigned ? Amd64Cond_B : Amd64Cond_L, Amd64Reg_RAX );
+	MOVZX8( Amd64Reg_RAX, Amd64Reg_RAX );
+	StoreRegister( rd, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateMULT( EN64Reg rs, EN64Reg rt, bool is_unsigned )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+
+	// Extend both operands to 64 bits, then the low half of a 64 bit multiply is the full product
+	if( is_unsigned )
+	{
+		MOV( Amd64Reg_RAX, reg_s );
+		MOV( Amd64Reg_RCX, reg_t );
+	}
+	else
+	{
+		MOVSXD( Amd64Reg_RAX, reg_s );
+		MOVSXD( Amd64Reg_RCX, reg_t );
+	}
+	IMUL64( Amd64Reg_RAX, Amd64Reg_RCX );
+
+	MOVSXD( Amd64Reg_RDX, Amd64Reg_RAX );
+	SetVar64( &gCPUState.MultLo._u64, Amd64Reg_RDX );
+
+	SARI64( Amd64Reg_RAX, 32 );
+	SetVar64( &gCPUState.MultHi._u64, Amd64Reg_RAX );
+}
+
+void CCodeGeneratorX64::GenerateMFLO( EN64Reg rd )
+{
+	EAmd64Reg reg_d = GetRegisterNoLoad( rd, Amd64Reg_RAX );
+	GetVar64( reg_d, &gCPUState.MultLo._u64 );
+	StoreRegister( rd, reg_d );
+}
+
+void CCodeGeneratorX64::GenerateMFHI( EN64Reg rd )
+{
+	EAmd64Reg reg_d = GetRegisterNoLoad( rd, Amd64Reg_RAX );
+	GetVar64( reg_d, &gCPUState.MultHi._u64 );
+	StoreRegister( rd, reg_d );
+}
+
+void CCodeGeneratorX64::GenerateMTLO( EN64Reg rs )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	SetVar64( &gCPUState.MultLo._u64, reg_s );
+}
+
+void CCodeGeneratorX64::GenerateMTHI( EN64Reg rs )
+{
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	SetVar64( &gCPUState.MultHi._u64, reg_s );
+}
+
+//*****************************************************************************
+//
+//	Branch instructions
+//
+//	cond is the condition for the branch to be taken, comparing rs against rt (64 bit).
+//	The generated jump goes to the branch handler when the outcome differs from the trace.
+//
+//*****************************************************************************
+void CCodeGeneratorX64::GenerateCompareBranch( EN64Reg rs, EN64Reg rt, EAmd64Cond cond, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump )
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( p_branch != nullptr, "No branch details?" );
+	DAEDALUS_ASSERT( p_branch->Direct, "Indirect branch for conditional branch?" );
+	#endif
+
+	EAmd64Reg reg_s = GetRegisterAndLoad( rs, Amd64Reg_RAX );
+	if( rt == N64Reg_R0 )
+	{
+		CMPI64( reg_s, 0 );
+	}
+	else
+	{
+		EAmd64Reg reg_t = GetRegisterAndLoad( rt, Amd64Reg_RCX );
+		CMP64( reg_s, reg_t );
+	}
+
+	if( p_branch->ConditionalBranchTaken )
+	{
+		// Flip the sign of the test -
+		*p_branch_jump = JCCLong( InvertCondition( cond ), CCodeLabel( nullptr ) );
+	}
+	else
+	{
+		*p_branch_jump = JCCLong( cond, CCodeLabel( nullptr ) );
+	}
+}
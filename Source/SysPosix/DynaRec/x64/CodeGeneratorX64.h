@@ -0,0 +1,166 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSPOSIX_DYNAREC_X64_CODEGENERATORX64_H_
+#define SYSPOSIX_DYNAREC_X64_CODEGENERATORX64_H_
+
+#include <stack>
+
+#include "DynaRec/CodeGenerator.h"
+#include "DynaRec/TraceRecorder.h"
+#include "AssemblyWriterX64.h"
+#include "DynarecTargetX64.h"
+#include "N64RegisterCacheX64.h"
+
+class CCodeGeneratorX64 : public CCodeGenerator, public CAssemblyWriterX64
+{
+	public:
+		CCodeGeneratorX64( CAssemblyBuffer * p_primary, CAssemblyBuffer * p_secondary );
+
+		virtual void				Initialise( u32 entry_address, u32 exit_address, u32 * hit_counter, const void * p_base, const SRegisterUsageInfo & register_usage );
+		virtual void				Finalise( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps, const std::vector< RegisterSnapshotHandle >& exception_handler_snapshots );
+
+		virtual void				UpdateRegisterCaching( u32 instruction_idx );
+
+		virtual RegisterSnapshotHandle	GetRegisterSnapshot();
+
+		virtual CCodeLabel			GetEntryPoint() const;
+		virtual CCodeLabel			GetCurrentLocation() const;
+
+		virtual	CJumpLocation		GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment, CCodeLabel * p_fallback );
+		virtual void				GenerateEretExitCode( u32 num_instructions, CIndirectExitMap * p_map );
+		virtual void				GenerateIndirectExitCode( u32 num_instructions, CIndirectExitMap * p_map );
+
+		virtual void				GenerateBranchHandler( CJumpLocation branch_handler_jump, RegisterSnapshotHandle snapshot );
+
+		virtual CJumpLocation		GenerateOpCode( const STraceEntry& ti, bool branch_delay_slot, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+
+		virtual CJumpLocation		ExecuteNativeFunction( CCodeLabel speed_hack, bool check_return );
+
+	private:
+				void				SetRegisterSpanList( const SRegisterUsageInfo & register_usage, bool loops_to_self );
+				void				ExpireOldIntervals( u32 instruction_idx );
+				void				SpillAtInterval( const SRegisterSpan & live_span );
+
+				// Access to gCPUState through the pinned state register
+				void				GetVar( EAmd64Reg reg, const u32 * p_var );
+				void				SetVar( const u32 * p_var, u32 value );
+				void				SetVar( const u32 * p_var, EAmd64Reg reg );
+				void				GetVar64( EAmd64Reg reg, const u64 * p_var );
+				void				SetVar64( const u64 * p_var, s64 value );
+				void				SetVar64( const u64 * p_var, EAmd64Reg reg );
+
+				EAmd64Reg			GetRegisterNoLoad( EN64Reg n64_reg, EAmd64Reg scratch_reg );
+				EAmd64Reg			GetRegisterAndLoad( EN64Reg n64_reg, EAmd64Reg scratch_reg );
+
+				void				GetRegisterValue( EAmd64Reg host_reg, EN64Reg n64_reg );
+				void				LoadRegister( EAmd64Reg host_reg, EN64Reg n64_reg );
+				void				PrepareCachedRegister( EN64Reg n64_reg );
+				void				FlushRegister( CN64RegisterCacheX64 & cache, EN64Reg n64_reg, bool invalidate );
+				void				FlushAllRegisters( CN64RegisterCacheX64 & cache, bool invalidate );
+				void				RestoreAllRegisters( CN64RegisterCacheX64 & current_cache, CN64RegisterCacheX64 & new_cache );
+
+				const CN64RegisterCacheX64 &	GetRegisterCacheFromHandle( RegisterSnapshotHandle snapshot ) const;
+
+				void				StoreRegister( EN64Reg n64_reg, EAmd64Reg host_reg );
+				void				StoreRegister32s( EN64Reg n64_reg, EAmd64Reg host_reg );
+				void				SetRegister( EN64Reg n64_reg, s64 value );
+				void				SetRegister32s( EN64Reg n64_reg, s32 value )		{ SetRegister( n64_reg, value ); }
+
+				CJumpLocation		GenerateBranchAlways( CCodeLabel target );
+				CJumpLocation		GenerateBranchIfSet( const u32 * p_var, CCodeLabel target );
+				CJumpLocation		GenerateBranchIfEqual( const u32 * p_var, u32 value, CCodeLabel target );
+				CJumpLocation		GenerateBranchIfNotEqual( const u32 * p_var, u32 value, CCodeLabel target );
+
+				void				GenerateGenericR4300( OpCode op_code, CPU_Instruction p_instruction );
+
+				void				GenerateExceptionHander( ExceptionHandlerFn p_exception_handler_fn, const std::vector< CJumpLocation > & exception_handler_jumps, const std::vector< RegisterSnapshotHandle >& exception_handler_snapshots );
+
+	private:
+				u32					mEntryAddress;
+				CAssemblyBuffer *	mpPrimary;
+				CAssemblyBuffer *	mpSecondary;
+				RegisterSpanList	mRegisterSpanList;
+
+				// For register allocation
+				RegisterSpanList	mActiveIntervals;
+				std::stack<EAmd64Reg>	mAvailableRegisters;
+				CCodeLabel			mLoopTop;
+				bool				mUseFixedRegisterAllocation;
+
+				std::vector< CN64RegisterCacheX64 >	mRegisterSnapshots;
+				CN64RegisterCacheX64	mRegisterCache;
+
+	private:
+				bool	GenerateCACHE( EN64Reg base, s16 offset, u32 cache_op );
+
+				typedef u64 (*ReadMemoryFunction)( u32 address, u32 current_pc );
+				typedef void (*WriteMemoryFunction)( u32 address, u64 value, u32 current_pc );
+
+				void	GenerateAddress( EN64Reg base, s16 offset );
+				void	GenerateLoad( u32 current_pc, EAmd64Reg host_dst, EN64Reg base, s16 offset, u8 twiddle, u8 bits, bool is_signed, ReadMemoryFunction p_read_memory );
+				void	GenerateStore( u32 current_pc, EAmd64Reg host_src, EN64Reg base, s16 offset, u8 twiddle, u8 bits, WriteMemoryFunction p_write_memory );
+
+				bool	GenerateLW( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateLD( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateLH( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateLHU( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateLB( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateLBU( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+
+				bool	GenerateSW( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateSD( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateSH( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+				bool	GenerateSB( u32 address, bool branch_delay_slot, EN64Reg rt, EN64Reg base, s16 offset );
+
+				void	GenerateLUI( EN64Reg rt, s16 immediate );
+
+				void	GenerateADDIU( EN64Reg rt, EN64Reg rs, s16 immediate );
+				void	GenerateDADDIU( EN64Reg rt, EN64Reg rs, s16 immediate );
+				void	GenerateANDI( EN64Reg rt, EN64Reg rs, u16 immediate );
+				void	GenerateORI( EN64Reg rt, EN64Reg rs, u16 immediate );
+				void	GenerateXORI( EN64Reg rt, EN64Reg rs, u16 immediate );
+				void	GenerateSLTI( EN64Reg rt, EN64Reg rs, s16 immediate, bool is_unsigned );
+
+				void	GenerateJAL( u32 address );
+				void	GenerateJR( EN64Reg rs, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+				void	GenerateJALR( EN64Reg rs, EN64Reg rd, u32 address, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+
+				void	GenerateShift( EN64Reg rd, EN64Reg rt, u32 sa, EAmd64ShiftOp op );
+				void	GenerateShiftVariable( EN64Reg rd, EN64Reg rs, EN64Reg rt, EAmd64ShiftOp op );
+
+				void	GenerateALU64( EN64Reg rd, EN64Reg rs, EN64Reg rt, EAmd64AluOp op );
+				void	GenerateNOR( EN64Reg rd, EN64Reg rs, EN64Reg rt );
+				void	GenerateADDU( EN64Reg rd, EN64Reg rs, EN64Reg rt );
+				void	GenerateSUBU( EN64Reg rd, EN64Reg rs, EN64Reg rt );
+				void	GenerateSLT( EN64Reg rd, EN64Reg rs, EN64Reg rt, bool is_unsigned );
+
+				void	GenerateMULT( EN64Reg rs, EN64Reg rt, bool is_unsigned );
+				void	GenerateMFLO( EN64Reg rd );
+				void	GenerateMFHI( EN64Reg rd );
+				void	GenerateMTLO( EN64Reg rs );
+				void	GenerateMTHI( EN64Reg rs );
+
+				//Branch
+				void	GenerateCompareBranch( EN64Reg rs, EN64Reg rt, EAmd64Cond cond, const SBranchDetails * p_branch, CJumpLocation * p_branch_jump );
+};
+
+#endif // SYSPOSIX_DYNAREC_X64_CODEGENERATORX64_H_
@@ -0,0 +1,52 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSPOSIX_DYNAREC_X64_DYNARECTARGETX64_H_
+#define SYSPOSIX_DYNAREC_X64_DYNARECTARGETX64_H_
+
+#include "Core/R4300OpCode.h"
+
+// AMD64 register codes. Ordering matches the ModRM/REX encoding
+enum EAmd64Reg
+{
+	Amd64Reg_RAX = 0, Amd64Reg_RCX, Amd64Reg_RDX, Amd64Reg_RBX,
+	Amd64Reg_RSP,     Amd64Reg_RBP, Amd64Reg_RSI, Amd64Reg_RDI,
+	Amd64Reg_R8,      Amd64Reg_R9,  Amd64Reg_R10, Amd64Reg_R11,
+	Amd64Reg_R12,     Amd64Reg_R13, Amd64Reg_R14, Amd64Reg_R15,
+
+	NUM_AMD64_REGISTERS = 16,
+};
+
+// Condition codes, as encoded in Jcc/SETcc. Do NOT reorder these
+enum EAmd64Cond
+{
+	Amd64Cond_O,  Amd64Cond_NO, Amd64Cond_B,  Amd64Cond_AE,
+	Amd64Cond_E,  Amd64Cond_NE, Amd64Cond_BE, Amd64Cond_A,
+	Amd64Cond_S,  Amd64Cond_NS, Amd64Cond_P,  Amd64Cond_NP,
+	Amd64Cond_L,  Amd64Cond_GE, Amd64Cond_LE, Amd64Cond_G,
+};
+
+// System V argument registers
+static const EAmd64Reg	Amd64Reg_Arg0 = Amd64Reg_RDI;
+static const EAmd64Reg	Amd64Reg_Arg1 = Amd64Reg_RSI;
+static const EAmd64Reg	Amd64Reg_Arg2 = Amd64Reg_RDX;
+
+#endif // SYSPOSIX_DYNAREC_X64_DYNARECTARGETX64_H_
@@ -0,0 +1,50 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "N64RegisterCacheX64.h"
+
+CN64RegisterCacheX64::CN64RegisterCacheX64()
+{
+	Reset();
+}
+
+void	CN64RegisterCacheX64::Reset()
+{
+	for( u32 i {}; i < NUM_N64_REGS; ++i )
+	{
+		mRegisterCacheInfo[ i ].KnownValue = 0;
+		mRegisterCacheInfo[ i ].HostRegister = NUM_AMD64_REGISTERS;
+		mRegisterCacheInfo[ i ].Valid = false;
+		mRegisterCacheInfo[ i ].Dirty = false;
+		mRegisterCacheInfo[ i ].Known = false;
+	}
+}
+
+void	CN64RegisterCacheX64::ClearCachedReg( EN64Reg n64_reg )
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( IsCached( n64_reg ), "This register is not currently cached" );
+	DAEDALUS_ASSERT( !IsDirty( n64_reg ), "This register is being cleared while still dirty" );
+	#endif
+	mRegisterCacheInfo[ n64_reg ].HostRegister = NUM_AMD64_REGISTERS;
+	mRegisterCacheInfo[ n64_reg ].Valid = false;
+	mRegisterCacheInfo[ n64_reg ].Dirty = false;
+	mRegisterCacheInfo[ n64_reg ].Known = false;
+}
@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2020 DaedalusX64 Team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef SYSPOSIX_DYNAREC_X64_N64REGISTERCACHEX64_H_
+#define SYSPOSIX_DYNAREC_X64_N64REGISTERCACHEX64_H_
+
+#include "DynarecTargetX64.h"
+
+//*************************************************************************************
+//	Host registers are 64 bits wide, so unlike the ARM cache each N64 register
+//	maps onto a single host register (no lo/hi split).
+//*************************************************************************************
+class CN64RegisterCacheX64
+{
+public:
+		CN64RegisterCacheX64();
+
+		void Reset();
+
+		inline void	SetCachedReg( EN64Reg n64_reg, EAmd64Reg host_reg )
+		{
+			mRegisterCacheInfo[ n64_reg ].HostRegister = host_reg;
+		}
+
+		inline bool	IsCached( EN64Reg reg ) const
+		{
+			return mRegisterCacheInfo[ reg ].HostRegister != NUM_AMD64_REGISTERS;
+		}
+
+		inline bool	IsValid( EN64Reg reg ) const
+		{
+			#ifdef DAEDALUS_ENABLE_ASSERTS
+			DAEDALUS_ASSERT( !mRegisterCacheInfo[ reg ].Valid || IsCached( reg ), "Checking register is valid but uncached?" );
+			#endif
+			return mRegisterCacheInfo[ reg ].Valid;
+		}
+
+		inline bool	IsDirty( EN64Reg reg ) const
+		{
+			#ifdef DAEDALUS_ENABLE_ASSERTS
+			if( mRegisterCacheInfo[ reg ].Dirty )
+			{
+				DAEDALUS_ASSERT( IsKnownValue( reg ) || IsCached( reg ), "Checking dirty flag on unknown/uncached register?" );
+			}
+			#endif
+			return mRegisterCacheInfo[ reg ].Dirty;
+		}
+
+		inline EAmd64Reg	GetCachedReg( EN64Reg reg ) const
+		{
+			#ifdef DAEDALUS_ENABLE_ASSERTS
+			DAEDALUS_ASSERT( IsCached( reg ), "Trying to retreive an uncached register" );
+			#endif
+			return mRegisterCacheInfo[ reg ].HostRegister;
+		}
+
+		inline void	MarkAsValid( EN64Reg reg, bool valid )
+		{
+			#ifdef DAEDALUS_ENABLE_ASSERTS
+			DAEDALUS_ASSERT( IsCached( reg ), "Changing valid flag on uncached register?" );
+			#endif
+			mRegisterCacheInfo[ reg ].Valid = valid;
+		}
+
+		inline void	MarkAsDirty( EN64Reg reg, bool dirty )
+		{
+			#ifdef DAEDALUS_ENABLE_ASSERTS
+			if( dirty )
+			{
+				DAEDALUS_ASSERT( IsKnownValue( reg ) || IsCached( reg ), "Setting dirty flag on unknown/uncached register?" );
+			}
+			#endif
+			mRegisterCacheInfo[ reg ].Dirty = dirty;
+		}
+
+		inline bool	IsKnownValue( EN64Reg reg ) const
+		{
+			return mRegisterCacheInfo[ reg ].Known;
+		}
+
+		inline void	SetKnownValue( EN64Reg reg, s64 value )
+		{
+			mRegisterCacheInfo[ reg ].Known = true;
+			mRegisterCacheInfo[ reg ].KnownValue = value;
+		}
+
+		inline void	ClearKnownValue( EN64Reg reg )
+		{
+			mRegisterCacheInfo[ reg ].Known = false;
+		}
+
+		inline s64	GetKnownValue( EN64Reg reg ) const
+		{
+			return mRegisterCacheInfo[ reg ].KnownValue;
+		}
+
+		void		ClearCachedReg( EN64Reg n64_reg );
+
+private:
+
+		struct RegisterCacheInfoX64
+		{
+			s64				KnownValue;			// The contents (if known)
+			EAmd64Reg		HostRegister;		// If cached, this is the host register we're using
+			bool			Valid;				// Is the contents of the register valid?
+			bool			Dirty;				// Is the contents of the register modified?
+			bool			Known;				// Is the contents of the known?
+		};
+
+		RegisterCacheInfoX64	mRegisterCacheInfo[ NUM_N64_REGS ];
+};
+
+#endif // SYSPOSIX_DYNAREC_X64_N64REGISTERCACHEX64_H_
@@ -75,7 +75,7 @@ void * StartThreadFunc( void * arg )
 
 } // anonymous namespace
 
-ThreadHandle CreateThread( const char * name, DaedThread function, void * argument )
+ThreadHandle CreateThread( const char * name, DaedThread function, void * argument, s32 core )
 {
 	pthread_t		thread;
 	pthread_attr_t	thread_attr;
@@ -0,0 +1,315 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Core/CPU.h"
+#include "Core/GraphicsTask.h"
+#include "Core/TLB.h"
+#include "Debug/DBGConsole.h"
+#include "DynaRec/FragmentCache.h"
+#include "DynaRec/TraceCache.h"
+#include "HLEGraphics/DLCapture.h"
+#include "HLEGraphics/TextureCache.h"
+#include "Interface/RomDB.h"
+#include "System/Paths.h"
+#include "System/System.h"
+#include "Test/BatchTest.h"
+#include "Utility/IO.h"
+#include "Utility/Timing.h"
+
+#ifdef DAEDALUS_HEADLESS
+#include "SysNull/HLEGraphics/RendererNull.h"
+#endif
+
+#ifdef DAEDALUS_LINUX
+#include <linux/limits.h>
+#endif
+
+//*****************************************************************************
+//	Benchmark mode: run for a fixed number of VBLs and report throughput.
+//*****************************************************************************
+namespace
+{
+	u32		gBenchmarkVblLimit = 0;
+	u32		gBenchmarkVblCount = 0;
+	std::vector< u64 >	gBenchmarkVblTimes;
+
+	void BenchmarkVblHandler( void * arg )
+	{
+		u64 now = 0;
+		NTiming::GetPreciseTime( &now );
+		gBenchmarkVblTimes.push_back( now );
+
+		++gBenchmarkVblCount;
+		if (gBenchmarkVblCount >= gBenchmarkVblLimit)
+		{
+			CPU_Halt( "Benchmark complete" );
+		}
+	}
+
+	long GetPeakRSSKb()
+	{
+		struct rusage usage;
+		if (getrusage( RUSAGE_SELF, &usage ) != 0)
+			return 0;
+
+		// Linux reports ru_maxrss in kilobytes, OSX in bytes
+#ifdef DAEDALUS_OSX
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+
+	// Host time between consecutive VIs, as a percentile of all of them
+	f64 GetVblPercentileMs( std::vector< u64 > & deltas, u64 freq, u32 percentile )
+	{
+		if (deltas.empty())
+			return 0.0;
+
+		u32 idx = u32( (u64( deltas.size() - 1 ) * percentile) / 100 );
+		std::nth_element( deltas.begin(), deltas.begin() + idx, deltas.end() );
+		return f64( deltas[ idx ] ) * 1000.0 / f64( freq );
+	}
+
+	void RunBenchmark( const char * filename, u32 num_vbls )
+	{
+		if (!System_Open( filename ))
+		{
+			fprintf( stderr, "Couldn't open %s\n", filename );
+			return;
+		}
+
+		gBenchmarkVblLimit = num_vbls;
+		gBenchmarkVblCount = 0;
+		gBenchmarkVblTimes.clear();
+		gBenchmarkVblTimes.reserve( num_vbls );
+		CPU_RegisterVblCallback( &BenchmarkVblHandler, nullptr );
+
+		u64 freq = 0, start = 0, end = 0;
+		NTiming::GetPreciseFrequency( &freq );
+		NTiming::GetPreciseTime( &start );
+
+		CPU_Run();
+
+		NTiming::GetPreciseTime( &end );
+		CPU_UnregisterVblCallback( &BenchmarkVblHandler, nullptr );
+
+		const f64	elapsed  = f64( end - start ) / f64( freq );
+		const u32	vbls     = gBenchmarkVblCount;
+		const f64	vi_rate  = elapsed > 0.0 ? f64( vbls ) / elapsed : 0.0;
+		const f64	ms_per_vi = vbls > 0 ? (elapsed * 1000.0) / f64( vbls ) : 0.0;
+
+		printf( "Benchmark: %u VIs in %.3fs\n", vbls, elapsed );
+		printf( "  Emulated VI/s:  %.2f\n", vi_rate );
+		printf( "  Host ms per VI: %.3f\n", ms_per_vi );
+
+		std::vector< u64 >	deltas;
+		for (u32 i = 1; i < gBenchmarkVblTimes.size(); ++i)
+		{
+			deltas.push_back( gBenchmarkVblTimes[ i ] - gBenchmarkVblTimes[ i - 1 ] );
+		}
+		printf( "  VI ms p50/p95/p99/max: %.3f / %.3f / %.3f / %.3f\n",
+				GetVblPercentileMs( deltas, freq, 50 ), GetVblPercentileMs( deltas, freq, 95 ),
+				GetVblPercentileMs( deltas, freq, 99 ), GetVblPercentileMs( deltas, freq, 100 ) );
+
+#ifdef DAEDALUS_HEADLESS
+		if (gRendererNull != nullptr)
+		{
+			const SNullRendererStats & stats = gRendererNull->GetStats();
+			printf( "  Frames:         %llu\n", (unsigned long long)stats.NumFlips );
+			printf( "  Triangles:      %llu (%llu batches)\n", (unsigned long long)stats.NumTriangles, (unsigned long long)stats.NumTriangleBatches );
+			printf( "  Rects:          %llu tex, %llu fill\n", (unsigned long long)stats.NumTexRects, (unsigned long long)stats.NumFillRects );
+		}
+#endif
+		if (CTextureCache::IsAvailable())
+		{
+			const STextureCacheStats & stats = CTextureCache::Get()->GetStats();
+			const u32 table_lookups = stats.TableHits + stats.Misses;
+			printf( "  Textures:       %u lookups, %u l1 hit, %u table hit, %u miss, %u purged\n", stats.Lookups, stats.L1Hits, stats.TableHits, stats.Misses, stats.NumPurged );
+			printf( "  Texture table:  %u/%u slots, %.2f avg probes, %u max\n", stats.NumTextures, stats.TableSize,
+					table_lookups > 0 ? f32( stats.TableProbes ) / f32( table_lookups ) : 0.0f, stats.MaxProbeLength );
+
+			const STextureConversionStats & conversions = CachedTexture::GetConversionStats();
+			printf( "  Conversions:    %u sync, %u queued, %u uploaded\n", conversions.SyncConversions, conversions.QueuedConversions, conversions.Uploads );
+		}
+
+#ifdef DAEDALUS_ENABLE_DYNAREC
+		printf( "  Fragments:      %u (%u evicted from the hash table)\n", gFragmentCache.GetCacheSize(), gFragmentCache.GetEvictions() );
+		printf( "  Lookups:        %llu hit (%llu from the victim buffer), %llu miss\n", (unsigned long long)gFragmentCache.GetLookupHits(),
+				(unsigned long long)gFragmentCache.GetLookupVictimHits(), (unsigned long long)gFragmentCache.GetLookupMisses() );
+		printf( "  Invalidations:  %u full, %u partial\n", gFragmentCache.GetFullInvalidations(), gFragmentCache.GetPartialInvalidations() );
+		printf( "  Trace cache:    %u traces, %u replayed\n", gTraceCache.GetNumTraces(), gTraceCache.GetNumReplayed() );
+#endif
+		printf( "  TLB cache:      %llu hit, %llu miss, %u invalidations\n", (unsigned long long)gTLBCacheHits, (unsigned long long)gTLBCacheMisses, gTLBCacheInvalidations );
+
+		System_Close();
+
+		printf( "  Peak RSS:       %ld KB\n", GetPeakRSSKb() );
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int result = 0;
+
+	if (argc > 0)
+	{
+		IO::Filename exe_path;
+		realpath(argv[0], exe_path);
+
+		strcpy(gDaedalusExePath, exe_path);
+		IO::Path::RemoveFileSpec(gDaedalusExePath);
+	}
+	else
+	{
+		fprintf(stderr, "Couldn't determine executable path\n");
+		return 1;
+	}
+
+	if (!System_Init())
+		return 1;
+
+#ifdef DAEDALUS_HEADLESS
+	// Overlap display lists with the cpu when there's a core to spare. GL contexts belong to one thread, so not there
+	gGraphicsTaskMode = sysconf( _SC_NPROCESSORS_ONLN ) > 1 ? GTM_ASYNC : GTM_SYNC;
+#endif
+
+	if (argc > 1)
+	{
+		bool 			batch_test = false;
+		u32				num_vbls   = 0;
+		const char *	filename   = NULL;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const char * arg = argv[i];
+			if (*arg == '-')
+			{
+				++arg;
+				if( strcmp( arg, "-batch" ) == 0 )
+				{
+					batch_test = true;
+					break;
+				}
+				else if (strcmp( arg, "-roms" ) == 0 )
+				{
+					if (i+1 < argc)
+					{
+						const char * relative_path = argv[i+1];
+						++i;
+
+						IO::Filename	dir;
+						realpath(relative_path, dir);
+
+						CRomDB::Get()->AddRomDirectory(dir);
+					}
+				}
+				else if (strcmp( arg, "gfxmode" ) == 0 )
+				{
+					if (i+1 < argc)
+					{
+						const char * mode = argv[i+1];
+						++i;
+
+						if (strcmp( mode, "sync" ) == 0)			gGraphicsTaskMode = GTM_SYNC;
+						else if (strcmp( mode, "async" ) == 0)		gGraphicsTaskMode = GTM_ASYNC;
+						else if (strcmp( mode, "fbsync" ) == 0)		gGraphicsTaskMode = GTM_ASYNC_FB_SYNC;
+						else fprintf( stderr, "Unknown graphics mode %s\n", mode );
+					}
+				}
+				else if (strcmp( arg, "dlcapture" ) == 0 )
+				{
+					if (i+2 < argc)
+					{
+						DLCapture_Request( strtoul( argv[i+1], NULL, 10 ), argv[i+2] );
+						i += 2;
+					}
+				}
+				else if (strcmp( arg, "vbls" ) == 0 )
+				{
+					if (i+1 < argc)
+					{
+						num_vbls = strtoul( argv[i+1], NULL, 10 );
+						++i;
+					}
+				}
+			}
+			else
+			{
+				filename = arg;
+			}
+		}
+
+		if (batch_test)
+		{
+			#ifdef DAEDALUS_BATCH_TEST_ENABLED
+				BatchTestMain(argc, argv);
+			#else
+				fprintf(stderr, "BatchTest mode is not present in this build.\n");
+			#endif
+		}
+		else if (filename && num_vbls > 0)
+		{
+			RunBenchmark( filename, num_vbls );
+		}
+		else if (filename)
+		{
+			System_Open( filename );
+			CPU_Run();
+			System_Close();
+		}
+	}
+	else
+	{
+		printf( "Usage: daedalus [--roms <dir>] [-vbls <count>] [-gfxmode sync|async|fbsync] [-dlcapture <n> <file>] <rom>\n" );
+	}
+
+	System_Finalize();
+
+	return result;
+}
+
+//FIXME: All this stuff needs tidying
+
+#ifndef DAEDALUS_ENABLE_DYNAREC
+void Dynarec_ClearedCPUStuffToDo()
+{
+}
+
+void Dynarec_SetCPUStuffToDo()
+{
+}
+
+
+extern "C" {
+void _EnterDynaRec()
+{
+	DAEDALUS_ASSERT(false, "Unimplemented");
+}
+}
+#endif
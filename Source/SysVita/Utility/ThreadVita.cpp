@@ -59,7 +59,7 @@ static int StartThreadFunc( SceSize args, void *argp )
 	return result;
 }
 
-ThreadHandle	CreateThread( const char * name, DaedThread function, void * argument )
+ThreadHandle	CreateThread( const char * name, DaedThread function, void * argument, s32 core )
 {
 	ThreadHandle	thid( ::sceKernelCreateThread( name, StartThreadFunc, gThreadPriorities[TP_NORMAL], 0x10000, 0, 0, nullptr ) );
 
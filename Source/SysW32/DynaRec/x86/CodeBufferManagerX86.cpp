@@ -24,6 +24,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "CodeGeneratorX86.h"
 
+// The address range reserved for both buffers, and where the second one starts in it
+#define CODE_BUFFER_RESERVE			(256 * 1024 * 1024)
+#define CODE_BUFFER_SECOND_OFFSET	(192 * 1024 * 1024)
+
+// Room for the largest fragment, a MAX_TRACE_LENGTH trace plus its exit stubs
+#define CODE_BUFFER_HEADROOM		(1024 * 1024)
+
 /* Added by Lkb (24/8/2001)
 The second buffer is used to hold conditionally executed code pieces that will usually not be executed
 
@@ -71,6 +78,7 @@ public:
 
 	virtual CCodeGenerator *StartNewBlock();
 	virtual u32				FinaliseCurrentBlock();
+	virtual bool			IsNearlyFull() const;
 
 private:
 
@@ -105,14 +113,14 @@ bool	CCodeBufferManagerX86::Initialise()
 	// mess up all the existing function pointers and jumps etc).
 	// Note that this call does not actually allocate any storage - we're not
 	// actually asking Windows to allocate 256Mb!
-	mpBuffer = (u8*)VirtualAlloc(NULL, 256 * 1024 * 1024, MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+	mpBuffer = (u8*)VirtualAlloc(NULL, CODE_BUFFER_RESERVE, MEM_RESERVE, PAGE_EXECUTE_READWRITE);
 	if (mpBuffer == NULL)
 		return false;
 
 	mBufferPtr = 0;
 	mBufferSize = 0;
 
-	mpSecondBuffer = mpBuffer + 192 * 1024 * 1024;
+	mpSecondBuffer = mpBuffer + CODE_BUFFER_SECOND_OFFSET;
 	mSecondBufferPtr = 0;
 	mSecondBufferSize = 0;
 
@@ -218,5 +226,18 @@ u32 CCodeBufferManagerX86::FinaliseCurrentBlock()
 	mSecondBufferPtr += mSecondaryBuffer.GetSize();
 	mSecondBufferPtr = ((mSecondBufferPtr - 1) & 0xfffffff0) + 0x10; // align to 16-byte boundary
 
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( mBufferPtr <= CODE_BUFFER_SECOND_OFFSET && mSecondBufferPtr <= CODE_BUFFER_RESERVE - CODE_BUFFER_SECOND_OFFSET, "Dynarec code buffer overflow" );
+	#endif
+
 	return main_block_size;
 }
+
+//*****************************************************************************
+//	The buffers grow on demand, but only within the range reserved for them
+//*****************************************************************************
+bool CCodeBufferManagerX86::IsNearlyFull() const
+{
+	return mBufferPtr + CODE_BUFFER_HEADROOM > CODE_BUFFER_SECOND_OFFSET ||
+		   mSecondBufferPtr + CODE_BUFFER_HEADROOM > CODE_BUFFER_RESERVE - CODE_BUFFER_SECOND_OFFSET;
+}
@@ -263,7 +263,7 @@ u32	CCodeGeneratorX86::GetCompiledCodeSize() const
 //*****************************************************************************
 //
 //*****************************************************************************
-CJumpLocation CCodeGeneratorX86::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment )
+CJumpLocation CCodeGeneratorX86::GenerateExitCode( u32 exit_address, u32 jump_address, u32 num_instructions, CCodeLabel next_fragment, CCodeLabel * p_fallback )
 {
 	//DAEDALUS_ASSERT( exit_address != u32( ~0 ), "Invalid exit address" );
 	DAEDALUS_ASSERT( !next_fragment.IsSet() || jump_address == 0, "Shouldn't be specifying a jump address if we have a next fragment?" );
@@ -284,6 +284,7 @@ CJumpLocation CCodeGeneratorX86::GenerateExitCode( u32 exit_address, u32 jump_ad
 
 	// If the flag was set, we need in initialise the pc/delay to exit with
 	CCodeLabel interpret_next_fragment( GetAssemblyBuffer()->GetLabel() );
+	*p_fallback = interpret_next_fragment;
 
 	u8		exit_delay;
 
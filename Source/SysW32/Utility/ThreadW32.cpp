@@ -54,7 +54,7 @@ static DWORD WINAPI StartThreadFunc( LPVOID arg )
 	return result;
 }
 
-ThreadHandle CreateThread( const char * name, DaedThread function, void * argument )
+ThreadHandle CreateThread( const char * name, DaedThread function, void * argument, s32 core )
 {
 	DWORD					id;
 	SDaedThreadDetails *	thread_details( new SDaedThreadDetails( function, argument ) );
@@ -21,6 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "Core/Memory.h"
 #include "Core/CPU.h"
+#include "Core/AudioTask.h"
+#include "Core/GraphicsTask.h"
 #include "Core/Save.h"
 #include "Core/PIF.h"
 #include "Core/ROMBuffer.h"
@@ -207,10 +209,12 @@ static const RomEntityEntry gRomInitTable[] =
 	{"InputManager",		CInputManager::Init,	CInputManager::Fini},
 	{"Memory",				Memory_Reset,			Memory_Cleanup},
 	{"Audio",				InitAudioPlugin,		DisposeAudioPlugin},
+	{"AudioTask",			AudioTask_Open,			AudioTask_Close},
 	{"Graphics",			InitGraphicsPlugin,		DisposeGraphicsPlugin},
+	{"GraphicsTask",		GraphicsTask_Open,		GraphicsTask_Close},
 	{"FramerateLimiter",	FramerateLimiter_Reset,	NULL},
 	//{"RSP", RSP_Reset, NULL},
-	{"CPU",					CPU_RomOpen},
+	{"CPU",					CPU_RomOpen,			CPU_RomClose},
 	{"ROM",					ROM_ReBoot,				ROM_Unload},
 	{"Controller",			CController::Reset,		CController::RomClose},
 	{"Save",				Save_Reset,				Save_Fini},
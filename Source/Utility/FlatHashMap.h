@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef UTILITY_FLATHASHMAP_H_
+#define UTILITY_FLATHASHMAP_H_
+
+#include "Utility/DaedalusTypes.h"
+
+#include <vector>
+
+//*************************************************************************************
+//	Map from u64 keys to T, kept in a single open addressed array (power of two
+//	sized, linear probing). It doubles before it gets more than half full, so
+//	probe sequences stay short, and a lookup touches one or two cache lines rather
+//	than the handful of nodes a std::map walks. Entries can't be removed.
+//*************************************************************************************
+template< typename T >
+class CFlatHashMap
+{
+public:
+	struct SSlot
+	{
+		SSlot() : Key( 0 ), Value(), Used( false ) {}
+
+		u64			Key;
+		T			Value;
+		bool		Used;		// false for an empty slot
+	};
+
+	explicit CFlatHashMap( u32 capacity = 16 )
+		:	mSize( 0 )
+	{
+		u32		size( 2 );
+		while( size < capacity )
+		{
+			size <<= 1;
+		}
+		mSlots.resize( size );
+	}
+
+	const T *			Find( u64 key ) const
+	{
+		const SSlot &	slot( mSlots[ FindSlot( key ) ] );
+		return slot.Used ? &slot.Value : nullptr;
+	}
+
+	T *					Find( u64 key )
+	{
+		SSlot &			slot( mSlots[ FindSlot( key ) ] );
+		return slot.Used ? &slot.Value : nullptr;
+	}
+
+	// key mustn't be in the map already. Returns the stored copy of value
+	T &					Insert( u64 key, const T & value )
+	{
+		if( (mSize + 1) * 2 > mSlots.size() )
+		{
+			Grow();
+		}
+
+		SSlot &			slot( mSlots[ FindSlot( key ) ] );
+		#ifdef DAEDALUS_ENABLE_ASSERTS
+		DAEDALUS_ASSERT( !slot.Used, "Key is already in the map" );
+		#endif
+		slot.Key = key;
+		slot.Value = value;
+		slot.Used = true;
+		mSize++;
+		return slot.Value;
+	}
+
+	u32					GetSize() const						{ return mSize; }		// Number of entries
+	u32					GetCapacity() const					{ return mSlots.size(); }
+	const SSlot *		GetSlots() const					{ return &mSlots[0]; }	// GetCapacity() of them, in table order
+
+	// The slot key's probe starts at (Fibonacci hashing). Keys sharing one collide
+	u32					GetHomeSlot( u64 key ) const		{ return u32( (key * 0x9E3779B97F4A7C15ULL) >> 32 ) & (mSlots.size() - 1); }
+
+private:
+	// Returns the slot holding key, or the empty slot where it belongs
+	u32					FindSlot( u64 key ) const
+	{
+		const u32	mask( mSlots.size() - 1 );
+		u32			slot( GetHomeSlot( key ) );
+
+		while( mSlots[ slot ].Used && mSlots[ slot ].Key != key )
+		{
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+
+	void				Grow()
+	{
+		std::vector< SSlot >	old_slots( mSlots.size() * 2 );
+		mSlots.swap( old_slots );
+
+		for( u32 i = 0; i < old_slots.size(); ++i )
+		{
+			if( old_slots[ i ].Used )
+			{
+				mSlots[ FindSlot( old_slots[ i ].Key ) ] = old_slots[ i ];
+			}
+		}
+	}
+
+private:
+	std::vector< SSlot >	mSlots;
+	u32						mSize;
+};
+
+#endif // UTILITY_FLATHASHMAP_H_
@@ -0,0 +1,298 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Micro-benchmark for CFlatHashMap, which holds the 3DS renderer's blend
+//	states. Checks lookups against a std::map, keys which all probe from the
+//	same slot (including ones wrapping past the end of the table), and growing
+//	from the smallest table, then times lookups of mux-like keys against the
+//	std::map the renderer used before.
+//
+
+#include "stdafx.h"
+#include "Utility/FlatHashMap.h"
+#include "Utility/Timing.h"
+
+#include <stdio.h>
+
+#include <map>
+#include <vector>
+
+namespace
+{
+	const u32	kLookupsPerRun = 16*1024*1024;
+
+	class CRandom
+	{
+	public:
+		explicit CRandom( u64 seed ) : mState( seed ) {}
+
+		u64		Next()
+		{
+			mState = mState * 6364136223846793005ULL + 1442695040888963407ULL;
+			return mState;
+		}
+
+	private:
+		u64		mState;
+	};
+
+	// Like the renderer's keys - 56 bits of mux, with the top bit for two cycle mode
+	u64		MakeMux( CRandom & random )
+	{
+		u64		mux( random.Next() & 0x00ffffffffffffffULL );
+		return (random.Next() & 1) ? mux | (u64( 1 ) << 63) : mux;
+	}
+
+	u32		CountUsedSlots( const CFlatHashMap< u64 > & map )
+	{
+		u32		count( 0 );
+		for( u32 i = 0; i < map.GetCapacity(); ++i )
+		{
+			count += map.GetSlots()[ i ].Used ? 1 : 0;
+		}
+		return count;
+	}
+
+	u32		CheckLookups()
+	{
+		u32						failures( 0 );
+		CRandom					random( 0x2545f4914f6cdd1dULL );
+		CFlatHashMap< u64 >		flat;
+		std::map< u64, u64 >	reference;
+
+		for( u32 i = 0; i < 4096; ++i )
+		{
+			u64		key( MakeMux( random ) );
+			if( reference.find( key ) == reference.end() )
+			{
+				reference[ key ] = key * 3;
+				flat.Insert( key, key * 3 );
+			}
+		}
+
+		for( std::map< u64, u64 >::const_iterator it = reference.begin(); it != reference.end(); ++it )
+		{
+			const u64 *	value( flat.Find( it->first ) );
+			if( value == nullptr || *value != it->second )
+			{
+				printf( "Lost key %016llx\n", (unsigned long long)it->first );
+				failures++;
+			}
+		}
+
+		for( u32 i = 0; i < 4096; ++i )
+		{
+			u64		key( MakeMux( random ) );
+			if( reference.find( key ) == reference.end() && flat.Find( key ) != nullptr )
+			{
+				printf( "Found missing key %016llx\n", (unsigned long long)key );
+				failures++;
+			}
+		}
+
+		if( flat.GetSize() != reference.size() || CountUsedSlots( flat ) != reference.size() )
+		{
+			printf( "Size is %u (%u slots used), expected %u\n", flat.GetSize(), CountUsedSlots( flat ), u32( reference.size() ) );
+			failures++;
+		}
+
+		return failures;
+	}
+
+	// Fills a table with keys which all start probing at home_slot
+	u32		CheckCollisions( u32 home_slot )
+	{
+		const u32				kCapacity = 64;
+		u32						failures( 0 );
+		CFlatHashMap< u64 >		flat( kCapacity );
+		std::vector< u64 >		keys;
+
+		// One more than fits without growing, the last is only looked up
+		for( u64 key = 1; keys.size() <= kCapacity / 2; ++key )
+		{
+			if( flat.GetHomeSlot( key ) == home_slot )
+			{
+				keys.push_back( key );
+			}
+		}
+
+		for( u32 i = 0; i < keys.size() - 1; ++i )
+		{
+			flat.Insert( keys[ i ], i );
+		}
+
+		if( flat.GetCapacity() != kCapacity )
+		{
+			printf( "Grew to %u slots with %u entries\n", flat.GetCapacity(), flat.GetSize() );
+			failures++;
+		}
+
+		for( u32 i = 0; i < keys.size() - 1; ++i )
+		{
+			const u64 *	value( flat.Find( keys[ i ] ) );
+			if( value == nullptr || *value != i )
+			{
+				printf( "Lost colliding key %u of %u from slot %u\n", i, u32( keys.size() - 1 ), home_slot );
+				failures++;
+			}
+		}
+
+		if( flat.Find( keys.back() ) != nullptr )
+		{
+			printf( "Found missing colliding key from slot %u\n", home_slot );
+			failures++;
+		}
+
+		return failures;
+	}
+
+	u32		CheckGrowth()
+	{
+		u32						failures( 0 );
+		CRandom					random( 0x9e3779b97f4a7c15ULL );
+		CFlatHashMap< u64 >		flat( 1 );
+		std::vector< u64 >		keys;
+		u32						grows( 0 );
+
+		for( u32 i = 0; i < 20000; ++i )
+		{
+			u64		key( MakeMux( random ) );
+			if( flat.Find( key ) != nullptr )
+				continue;
+
+			u32		capacity( flat.GetCapacity() );
+			u64 &	stored( flat.Insert( key, i ) );
+			if( stored != i )
+			{
+				printf( "Insert returned %llu, expected %u\n", (unsigned long long)stored, i );
+				failures++;
+			}
+			keys.push_back( key );
+
+			if( flat.GetCapacity() != capacity )
+			{
+				grows++;
+			}
+			if( (flat.GetCapacity() & (flat.GetCapacity() - 1)) != 0 || flat.GetSize() * 2 > flat.GetCapacity() )
+			{
+				printf( "%u entries in %u slots\n", flat.GetSize(), flat.GetCapacity() );
+				failures++;
+				break;
+			}
+		}
+
+		for( u32 i = 0; i < keys.size(); ++i )
+		{
+			if( flat.Find( keys[ i ] ) == nullptr )
+			{
+				printf( "Lost key %u of %u after growing\n", i, u32( keys.size() ) );
+				failures++;
+			}
+		}
+
+		if( CountUsedSlots( flat ) != keys.size() )
+		{
+			printf( "%u slots used after growing, expected %u\n", CountUsedSlots( flat ), u32( keys.size() ) );
+			failures++;
+		}
+
+		printf( "Grew %u times to %u slots for %u entries\n", grows, flat.GetCapacity(), flat.GetSize() );
+		return failures;
+	}
+
+	// Returns ns per lookup
+	f64		ElapsedNs( u64 start, u64 end, u64 freq )
+	{
+		f64		seconds( f64( end - start ) / f64( freq ) );
+		return seconds * 1e9 / f64( kLookupsPerRun );
+	}
+
+	void	TimeLookups( u32 num_keys )
+	{
+		CRandom					random( num_keys );
+		CFlatHashMap< u64 >		flat( 256 );
+		std::map< u64, u64 >	reference;
+		std::vector< u64 >		keys;
+
+		while( keys.size() < num_keys )
+		{
+			u64		key( MakeMux( random ) );
+			if( reference.find( key ) == reference.end() )
+			{
+				reference[ key ] = key;
+				flat.Insert( key, key );
+				keys.push_back( key );
+			}
+		}
+
+		// Draws come in runs with the same mux, but the runs jump about
+		std::vector< u64 >		stream( 64*1024 );
+		for( u32 i = 0; i < stream.size(); ++i )
+		{
+			stream[ i ] = keys[ random.Next() % num_keys ];
+		}
+
+		u64		freq( 0 ), start( 0 ), end( 0 );
+		u64		map_checksum( 0 ), flat_checksum( 0 );
+		const u32	mask( stream.size() - 1 );
+		NTiming::GetPreciseFrequency( &freq );
+
+		NTiming::GetPreciseTime( &start );
+		for( u32 i = 0; i < kLookupsPerRun; ++i )
+		{
+			map_checksum += reference.find( stream[ i & mask ] )->second;
+		}
+		NTiming::GetPreciseTime( &end );
+		f64		map_ns( ElapsedNs( start, end, freq ) );
+
+		NTiming::GetPreciseTime( &start );
+		for( u32 i = 0; i < kLookupsPerRun; ++i )
+		{
+			flat_checksum += *flat.Find( stream[ i & mask ] );
+		}
+		NTiming::GetPreciseTime( &end );
+		f64		flat_ns( ElapsedNs( start, end, freq ) );
+
+		printf( "%-8u %12.2f %12.2f %8.2fx %8s\n", num_keys, map_ns, flat_ns, flat_ns > 0.0 ? map_ns / flat_ns : 0.0,
+				map_checksum == flat_checksum ? "yes" : "NO" );
+	}
+}
+
+int main()
+{
+	u32		failures( 0 );
+
+	failures += CheckLookups();
+	failures += CheckCollisions( 5 );
+	failures += CheckCollisions( 63 );		// Probes wrap around to the start
+	failures += CheckGrowth();
+
+	printf( "CFlatHashMap: %s\n\n", failures == 0 ? "ok" : "FAILED" );
+
+	static const u32	num_keys[] = { 16, 64, 256, 1024 };
+
+	printf( "%-8s %12s %12s %9s %8s\n", "keys", "map ns", "flat ns", "speedup", "match" );
+	for( u32 i = 0; i < sizeof( num_keys ) / sizeof( num_keys[0] ); ++i )
+	{
+		TimeLookups( num_keys[ i ] );
+	}
+
+	return failures == 0 ? 0 : 1;
+}
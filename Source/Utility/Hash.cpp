@@ -68,8 +68,8 @@ unsigned int murmur2_hash ( const void * key, int len, unsigned int seed )
 
 	switch(len)
 	{
-	case 3: h ^= data[2] << 16;
-	case 2: h ^= data[1] << 8;
+	case 3: h ^= data[2] << 16;	// fallthrough
+	case 2: h ^= data[1] << 8;	// fallthrough
 	case 1: h ^= data[0];
 	        h *= m;
 	};
@@ -120,8 +120,8 @@ unsigned int murmur2_neutral_hash ( const void * key, int len, unsigned int seed
 
 	switch(len)
 	{
-	case 3: h ^= data[2] << 16;
-	case 2: h ^= data[1] << 8;
+	case 3: h ^= data[2] << 16;	// fallthrough
+	case 2: h ^= data[1] << 8;	// fallthrough
 	case 1: h ^= data[0];
 	        h *= m;
 	};
@@ -132,3 +132,224 @@ unsigned int murmur2_neutral_hash ( const void * key, int len, unsigned int seed
 
 	return h;
 }
+
+//-----------------------------------------------------------------------------
+// xxHash32x4 - four interleaved xxHash32 streams (after xxHash by Yann Collet)
+// Used for texture hashing, where the whole texture is hashed every time it's
+// checked so it needs to run close to memory bandwidth. Plain xxHash32 is
+// bound by the latency of its multiply chain, so this runs 16 accumulators
+// over 64 byte stripes instead - four SSE2/NEON registers with no dependency
+// between them. The vector and scalar paths give the same result (little-endian
+// words, so like murmur2_hash it's not the same across endianness).
+//-----------------------------------------------------------------------------
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include <string.h>
+
+namespace
+{
+	const u32 XXH_PRIME32_1 = 0x9E3779B1u;
+	const u32 XXH_PRIME32_2 = 0x85EBCA77u;
+	const u32 XXH_PRIME32_3 = 0xC2B2AE3Du;
+	const u32 XXH_PRIME32_4 = 0x27D4EB2Fu;
+	const u32 XXH_PRIME32_5 = 0x165667B1u;
+
+	const u32 XXH_LANES = 16;
+	const u32 XXH_STRIPE = XXH_LANES * 4;
+
+	inline u32 xxh_rotl( u32 x, u32 r )
+	{
+		return (x << r) | (x >> (32 - r));
+	}
+
+	inline u32 xxh_read32( const u8 * p )
+	{
+		u32 v;
+		memcpy( &v, p, sizeof( v ) );
+		return v;
+	}
+
+	// Runs the main loop over all the whole stripes, returns the number of bytes consumed.
+	// Without vector registers there aren't enough to keep all 16 accumulators in, so
+	// this makes a pass over the data for each stream instead.
+	u32 xxh_stripes_scalar( const u8 * p, u32 len, u32 acc[XXH_LANES] )
+	{
+		u32 n( len - len % XXH_STRIPE );
+
+		for( u32 s = 0; s < XXH_LANES; s += 4 )
+		{
+			u32 v1( acc[s + 0] ), v2( acc[s + 1] ), v3( acc[s + 2] ), v4( acc[s + 3] );
+
+			for( const u8 * q = p + s * 4, * e = p + n; q < e; q += XXH_STRIPE )
+			{
+				v1 = xxh_rotl( v1 + xxh_read32( q + 0 )  * XXH_PRIME32_2, 13 ) * XXH_PRIME32_1;
+				v2 = xxh_rotl( v2 + xxh_read32( q + 4 )  * XXH_PRIME32_2, 13 ) * XXH_PRIME32_1;
+				v3 = xxh_rotl( v3 + xxh_read32( q + 8 )  * XXH_PRIME32_2, 13 ) * XXH_PRIME32_1;
+				v4 = xxh_rotl( v4 + xxh_read32( q + 12 ) * XXH_PRIME32_2, 13 ) * XXH_PRIME32_1;
+			}
+
+			acc[s + 0] = v1; acc[s + 1] = v2; acc[s + 2] = v3; acc[s + 3] = v4;
+		}
+
+		return n;
+	}
+
+#if defined(__SSE2__)
+	inline __m128i xxh_mullo( __m128i a, __m128i b )
+	{
+#if defined(__SSE4_1__)
+		return _mm_mullo_epi32( a, b );
+#else
+		// SSE2 only has a 32x32->64 multiply on the even lanes, so do the odd lanes separately and interleave
+		__m128i even( _mm_mul_epu32( a, b ) );
+		__m128i odd( _mm_mul_epu32( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( b, 32 ) ) );
+		return _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ),
+								   _mm_shuffle_epi32( odd,  _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+#endif
+	}
+
+	inline __m128i xxh_round( __m128i acc, const u8 * p, __m128i prime1, __m128i prime2 )
+	{
+		acc = _mm_add_epi32( acc, xxh_mullo( _mm_loadu_si128( (const __m128i *)p ), prime2 ) );
+		acc = _mm_or_si128( _mm_slli_epi32( acc, 13 ), _mm_srli_epi32( acc, 19 ) );
+		return xxh_mullo( acc, prime1 );
+	}
+
+	u32 xxh_stripes( const u8 * p, u32 len, u32 acc[XXH_LANES] )
+	{
+		const __m128i	prime1( _mm_set1_epi32( XXH_PRIME32_1 ) );
+		const __m128i	prime2( _mm_set1_epi32( XXH_PRIME32_2 ) );
+		__m128i			v0( _mm_loadu_si128( (const __m128i *)( acc + 0 ) ) );
+		__m128i			v1( _mm_loadu_si128( (const __m128i *)( acc + 4 ) ) );
+		__m128i			v2( _mm_loadu_si128( (const __m128i *)( acc + 8 ) ) );
+		__m128i			v3( _mm_loadu_si128( (const __m128i *)( acc + 12 ) ) );
+		u32				n( len - len % XXH_STRIPE );
+
+		for( u32 i = 0; i < n; i += XXH_STRIPE )
+		{
+			v0 = xxh_round( v0, p + i + 0,  prime1, prime2 );
+			v1 = xxh_round( v1, p + i + 16, prime1, prime2 );
+			v2 = xxh_round( v2, p + i + 32, prime1, prime2 );
+			v3 = xxh_round( v3, p + i + 48, prime1, prime2 );
+		}
+
+		_mm_storeu_si128( (__m128i *)( acc + 0 ),  v0 );
+		_mm_storeu_si128( (__m128i *)( acc + 4 ),  v1 );
+		_mm_storeu_si128( (__m128i *)( acc + 8 ),  v2 );
+		_mm_storeu_si128( (__m128i *)( acc + 12 ), v3 );
+		return n;
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	inline uint32x4_t xxh_round( uint32x4_t acc, const u8 * p, uint32x4_t prime1, uint32x4_t prime2 )
+	{
+		acc = vmlaq_u32( acc, vreinterpretq_u32_u8( vld1q_u8( p ) ), prime2 );
+		acc = vsriq_n_u32( vshlq_n_u32( acc, 13 ), acc, 19 );
+		return vmulq_u32( acc, prime1 );
+	}
+
+	u32 xxh_stripes( const u8 * p, u32 len, u32 acc[XXH_LANES] )
+	{
+		const uint32x4_t	prime1( vdupq_n_u32( XXH_PRIME32_1 ) );
+		const uint32x4_t	prime2( vdupq_n_u32( XXH_PRIME32_2 ) );
+		uint32x4_t			v0( vld1q_u32( acc + 0 ) );
+		uint32x4_t			v1( vld1q_u32( acc + 4 ) );
+		uint32x4_t			v2( vld1q_u32( acc + 8 ) );
+		uint32x4_t			v3( vld1q_u32( acc + 12 ) );
+		u32					n( len - len % XXH_STRIPE );
+
+		for( u32 i = 0; i < n; i += XXH_STRIPE )
+		{
+			v0 = xxh_round( v0, p + i + 0,  prime1, prime2 );
+			v1 = xxh_round( v1, p + i + 16, prime1, prime2 );
+			v2 = xxh_round( v2, p + i + 32, prime1, prime2 );
+			v3 = xxh_round( v3, p + i + 48, prime1, prime2 );
+		}
+
+		vst1q_u32( acc + 0,  v0 );
+		vst1q_u32( acc + 4,  v1 );
+		vst1q_u32( acc + 8,  v2 );
+		vst1q_u32( acc + 12, v3 );
+		return n;
+	}
+#else
+	inline u32 xxh_stripes( const u8 * p, u32 len, u32 acc[XXH_LANES] )
+	{
+		return xxh_stripes_scalar( p, len, acc );
+	}
+#endif
+
+	template< u32 (*Stripes)( const u8 *, u32, u32[XXH_LANES] ) >
+	u32 xxh32x4( const void * key, u32 len, u32 seed )
+	{
+		const u8 *	p( (const u8 *)key );
+		u32			h;
+		u32			i( 0 );
+
+		if( len >= XXH_STRIPE )
+		{
+			// Each stream is seeded like xxHash32, with the stream index mixed in so they differ
+			u32 acc[XXH_LANES];
+			for( u32 s = 0; s < 4; ++s )
+			{
+				u32 stream_seed( seed + s * XXH_PRIME32_3 );
+				acc[s * 4 + 0] = stream_seed + XXH_PRIME32_1 + XXH_PRIME32_2;
+				acc[s * 4 + 1] = stream_seed + XXH_PRIME32_2;
+				acc[s * 4 + 2] = stream_seed;
+				acc[s * 4 + 3] = stream_seed - XXH_PRIME32_1;
+			}
+
+			i = Stripes( p, len, acc );
+
+			h = 0;
+			for( u32 s = 0; s < 4; ++s )
+			{
+				u32 v( xxh_rotl( acc[s * 4 + 0], 1 ) + xxh_rotl( acc[s * 4 + 1], 7 ) +
+					   xxh_rotl( acc[s * 4 + 2], 12 ) + xxh_rotl( acc[s * 4 + 3], 18 ) );
+				h = xxh_rotl( h ^ v, 17 ) * XXH_PRIME32_1;
+			}
+		}
+		else
+		{
+			h = seed + XXH_PRIME32_5;
+		}
+
+		h += len;
+
+		for( ; i + 4 <= len; i += 4 )
+		{
+			h += xxh_read32( p + i ) * XXH_PRIME32_3;
+			h  = xxh_rotl( h, 17 ) * XXH_PRIME32_4;
+		}
+		for( ; i < len; ++i )
+		{
+			h += p[ i ] * XXH_PRIME32_5;
+			h  = xxh_rotl( h, 11 ) * XXH_PRIME32_1;
+		}
+
+		h ^= h >> 15;
+		h *= XXH_PRIME32_2;
+		h ^= h >> 13;
+		h *= XXH_PRIME32_3;
+		h ^= h >> 16;
+
+		return h;
+	}
+}
+
+u32 xxhash32x4( const void * key, u32 len, u32 seed )
+{
+	return xxh32x4< xxh_stripes >( key, len, seed );
+}
+
+u32 xxhash32x4_scalar( const void * key, u32 len, u32 seed )
+{
+	return xxh32x4< xxh_stripes_scalar >( key, len, seed );
+}
@@ -25,4 +25,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 unsigned int murmur2_hash ( const void * key, int len, unsigned int seed );
 unsigned int murmur2_neutral_hash ( const void * key, int len, unsigned int seed );
 
+// Four interleaved xxHash32 streams - uses SSE2/NEON where available. The _scalar version is the plain C one, kept to check them against
+u32 xxhash32x4( const void * key, u32 len, u32 seed );
+u32 xxhash32x4_scalar( const void * key, u32 len, u32 seed );
+
 #endif // UTILITY_HASH_H_
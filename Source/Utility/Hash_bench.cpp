@@ -0,0 +1,110 @@
+/*
+Copyright (C) 2006 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+//
+//	Micro-benchmark for the texture hash. Checks the vectorised xxhash32x4 against
+//	the scalar version, then times both and murmur2 over buffers the size of
+//	typical n64 textures.
+//
+
+#include "stdafx.h"
+#include "Utility/Hash.h"
+#include "Utility/Timing.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+namespace
+{
+	const u32	kBytesPerRun = 256*1024*1024;
+
+	typedef u32 (*HashFunction)( const void * key, u32 len, u32 seed );
+
+	u32		Murmur2( const void * key, u32 len, u32 seed )
+	{
+		return murmur2_hash( key, len, seed );
+	}
+
+	// Returns GB/s
+	f64		Time( HashFunction hash, const u8 * data, u32 size, u32 * p_checksum )
+	{
+		u32		iterations( kBytesPerRun / size );
+		u32		checksum( 0 );
+
+		u64		freq( 0 ), start( 0 ), end( 0 );
+		NTiming::GetPreciseFrequency( &freq );
+		NTiming::GetPreciseTime( &start );
+
+		for( u32 i = 0; i < iterations; ++i )
+		{
+			checksum += hash( data, size, checksum );
+		}
+
+		NTiming::GetPreciseTime( &end );
+
+		*p_checksum = checksum;
+		f64		seconds( f64( end - start ) / f64( freq ) );
+		return seconds > 0.0 ? f64( iterations ) * f64( size ) / seconds / 1e9 : 0.0;
+	}
+}
+
+int main()
+{
+	u32		failures( 0 );
+
+	std::vector< u8 >	buffer( 1024*1024 + 16 );
+	u32		state( 0x13579bdf );
+	for( u32 i = 0; i < buffer.size(); ++i )
+	{
+		state = state * 1664525 + 1013904223;
+		buffer[ i ] = u8( state >> 24 );
+	}
+
+	// Every length up to a few stripes, from every alignment
+	for( u32 offset = 0; offset < 16; ++offset )
+	{
+		for( u32 len = 0; len < 600; ++len )
+		{
+			if( xxhash32x4( &buffer[ offset ], len, offset ) != xxhash32x4_scalar( &buffer[ offset ], len, offset ) )
+			{
+				printf( "Mismatch at offset %u length %u\n", offset, len );
+				failures++;
+			}
+		}
+	}
+
+	printf( "xxhash32x4: %s\n\n", failures == 0 ? "ok" : "FAILED" );
+
+	static const u32	sizes[] = { 256, 2*1024, 4*1024, 64*1024, 1024*1024 };
+
+	printf( "%-10s %14s %14s %14s %8s\n", "bytes", "murmur2 GB/s", "scalar GB/s", "vector GB/s", "match" );
+	for( u32 i = 0; i < sizeof( sizes ) / sizeof( sizes[0] ); ++i )
+	{
+		u32		murmur_checksum, scalar_checksum, simd_checksum;
+		f64		murmur( Time( Murmur2, &buffer[0], sizes[ i ], &murmur_checksum ) );
+		f64		scalar( Time( xxhash32x4_scalar, &buffer[0], sizes[ i ], &scalar_checksum ) );
+		f64		simd( Time( xxhash32x4, &buffer[0], sizes[ i ], &simd_checksum ) );
+
+		printf( "%-10u %14.2f %14.2f %14.2f %8s\n", sizes[ i ], murmur, scalar, simd, scalar_checksum == simd_checksum ? "yes" : "NO" );
+	}
+
+	return failures == 0 ? 0 : 1;
+}
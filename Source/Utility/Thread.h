@@ -39,10 +39,14 @@ enum EThreadPriority
 	TP_NUM_PRIORITIES,
 };
 
+// Lets the platform pick which core a thread runs on
+const s32		kThreadDefaultCore = -1;
+
 //
 //	Returns a thread handle - you must check it for error status (== kInvalidThreadHandle)
+//	core is only honoured on the 3DS, other platforms always use the default
 //
-ThreadHandle	CreateThread( const char * name, DaedThread function, void * argument );
+ThreadHandle	CreateThread( const char * name, DaedThread function, void * argument, s32 core = kThreadDefaultCore );
 
 //
 //	Adjusts a thread's priority
@@ -0,0 +1,249 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "stdafx.h"
+#include "Utility/WorkerPool.h"
+
+#include "Debug/DBGConsole.h"
+
+#include <algorithm>
+
+#ifdef DAEDALUS_WORKERPOOL_COND
+namespace
+{
+	// Guards against a lost wakeup, e.g. where a platform's Cond can't
+	// release the mutex and wait atomically
+	const double	kJobDoneTimeout = 0.001;
+
+	// How long WPW_POLL workers sleep between looking at the queue
+	const double	kPollInterval = 0.001;
+}
+#endif
+
+//*****************************************************************************
+//
+//*****************************************************************************
+CWorkerPool::CWorkerPool( const char * name, u32 num_threads, EWorkerPoolWake wake, s32 core )
+:	mMutex( name )
+#ifdef DAEDALUS_WORKERPOOL_COND
+,	mWorkReady( CondCreate() )
+,	mJobDone( CondCreate() )
+#endif
+,	mWake( wake )
+,	mQuit( false )
+{
+	for( u32 i = 0; i < num_threads; ++i )
+	{
+		ThreadHandle	handle( CreateThread( name, &CWorkerPool::WorkerThread, this, core ) );
+		if( handle == kInvalidThreadHandle )
+		{
+			#ifdef DAEDALUS_DEBUG_CONSOLE
+			DBGConsole_Msg( 0, "Couldn't create worker thread for [C%s]", name );
+			#endif
+			break;
+		}
+		mThreads.push_back( handle );
+	}
+}
+
+//*****************************************************************************
+//	Jobs still queued are run here, so their owners always see them finish
+//*****************************************************************************
+CWorkerPool::~CWorkerPool()
+{
+	{
+		MutexLock	lock( &mMutex );
+		mQuit = true;
+#ifdef DAEDALUS_WORKERPOOL_COND
+		CondSignal( mWorkReady );
+#endif
+	}
+
+	for( u32 i = 0; i < mThreads.size(); ++i )
+	{
+		JoinThread( mThreads[ i ], -1 );
+		ReleaseThreadHandle( mThreads[ i ] );
+	}
+
+	while( !mQueue.empty() )
+	{
+		CWorkerJob *	job( mQueue.front() );
+		mQueue.pop_front();
+
+		job->Run();
+		job->mState = WJS_IDLE;
+	}
+
+#ifdef DAEDALUS_WORKERPOOL_COND
+	CondDestroy( mJobDone );
+	CondDestroy( mWorkReady );
+#endif
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CWorkerPool::Submit( CWorkerJob * job )
+{
+	#ifdef DAEDALUS_ENABLE_ASSERTS
+	DAEDALUS_ASSERT( job->mState == WJS_IDLE, "Job has already been submitted" );
+	#endif
+
+	if( mThreads.empty() )
+	{
+		job->Run();
+		return;
+	}
+
+	MutexLock	lock( &mMutex );
+	job->mState = WJS_QUEUED;
+	mQueue.push_back( job );
+#ifdef DAEDALUS_WORKERPOOL_COND
+	if( mWake == WPW_ON_SUBMIT )
+	{
+		CondSignal( mWorkReady );
+	}
+#endif
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+EWorkerJobState CWorkerPool::GetState( const CWorkerJob * job )
+{
+	MutexLock	lock( &mMutex );
+	return job->mState;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+void CWorkerPool::Wait( CWorkerJob * job )
+{
+	bool	run_here( false );
+	{
+		MutexLock	lock( &mMutex );
+
+		if( job->mState == WJS_QUEUED )
+		{
+			mQueue.erase( std::find( mQueue.begin(), mQueue.end(), job ) );
+			job->mState = WJS_RUNNING;
+			run_here = true;
+		}
+	}
+
+	if( run_here )
+	{
+		job->Run();
+
+		MutexLock	lock( &mMutex );
+		job->mState = WJS_IDLE;
+		return;
+	}
+
+#ifdef DAEDALUS_WORKERPOOL_COND
+	// Running on a worker - sleep until it finishes
+	MutexLock	lock( &mMutex );
+	while( job->mState != WJS_IDLE )
+	{
+		CondWait( mJobDone, &mMutex, kJobDoneTimeout );
+	}
+#else
+	// Running on a worker - jobs are short, so just wait for it to finish
+	while( GetState( job ) != WJS_IDLE )
+	{
+		ThreadYield();
+	}
+#endif
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+u32 DAEDALUS_THREAD_CALL_TYPE CWorkerPool::WorkerThread( void * arg )
+{
+	static_cast< CWorkerPool * >( arg )->WorkerLoop();
+	return 0;
+}
+
+//*****************************************************************************
+//
+//*****************************************************************************
+#ifdef DAEDALUS_WORKERPOOL_COND
+void CWorkerPool::WorkerLoop()
+{
+	MutexLock	lock( &mMutex );
+	while( true )
+	{
+		while( !mQuit && mQueue.empty() )
+		{
+			CondWait( mWorkReady, &mMutex, mWake == WPW_ON_SUBMIT ? kTimeoutInfinity : kPollInterval );
+		}
+
+		// Signals can be merged, so pass this one on in case another thread
+		// is asleep with work still queued, or needs to see mQuit
+		if( mQuit || mQueue.size() > 1 )
+		{
+			CondSignal( mWorkReady );
+		}
+
+		if( mQuit )
+			break;
+
+		CWorkerJob *	job( mQueue.front() );
+		mQueue.pop_front();
+		job->mState = WJS_RUNNING;
+
+		mMutex.Unlock();
+		job->Run();
+		mMutex.Lock();
+
+		job->mState = WJS_IDLE;
+		CondSignal( mJobDone );
+	}
+}
+#else
+void CWorkerPool::WorkerLoop()
+{
+	while( !mQuit )
+	{
+		CWorkerJob *	job( nullptr );
+		{
+			MutexLock	lock( &mMutex );
+			if( !mQueue.empty() )
+			{
+				job = mQueue.front();
+				mQueue.pop_front();
+				job->mState = WJS_RUNNING;
+			}
+		}
+
+		if( job == nullptr )
+		{
+			ThreadSleepMs( 1 );
+			continue;
+		}
+
+		job->Run();
+
+		MutexLock	lock( &mMutex );
+		job->mState = WJS_IDLE;
+	}
+}
+#endif
@@ -0,0 +1,110 @@
+/*
+Copyright (C) 2012 StrmnNrmn
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#pragma once
+
+#ifndef UTILITY_WORKERPOOL_H_
+#define UTILITY_WORKERPOOL_H_
+
+#include "Utility/Mutex.h"
+#include "Utility/Thread.h"
+
+// Platforms with a Cond implementation wake the workers (and anyone waiting
+// on a job) when there's something to do. The others poll
+#if defined(DAEDALUS_POSIX) || defined(DAEDALUS_W32) || defined(DAEDALUS_CTR)
+#define DAEDALUS_WORKERPOOL_COND
+#include "Utility/Cond.h"
+#endif
+
+#include <deque>
+#include <vector>
+
+enum EWorkerJobState
+{
+	WJS_IDLE = 0,		// Not submitted, or finished
+	WJS_QUEUED,
+	WJS_RUNNING,
+};
+
+//
+//	Jobs are owned by whoever submits them, and must not be destroyed or
+//	resubmitted until they're idle again (see CWorkerPool::Wait).
+//
+class CWorkerJob
+{
+public:
+	CWorkerJob() : mState( WJS_IDLE ) {}
+	virtual ~CWorkerJob() {}
+
+	virtual void			Run() = 0;
+
+private:
+	friend class CWorkerPool;
+	EWorkerJobState			mState;			// Guarded by the pool's mutex
+};
+
+//
+//	A fixed set of threads running jobs in the order they were submitted.
+//	Idle threads sleep on a Cond where the platform has one, and otherwise
+//	poll the queue with a short sleep. With no threads, Submit runs jobs
+//	immediately.
+//
+//	Pools of many small jobs that nobody waits for straight away (texture
+//	conversion) can ask for WPW_POLL, so Submit doesn't wake a worker, and
+//	interrupt the submitting thread, for every job. Their idle workers look
+//	at the queue about once a millisecond instead.
+//
+enum EWorkerPoolWake
+{
+	WPW_ON_SUBMIT,
+	WPW_POLL,
+};
+
+class CWorkerPool
+{
+public:
+	// core is passed on to CreateThread
+	CWorkerPool( const char * name, u32 num_threads, EWorkerPoolWake wake = WPW_ON_SUBMIT, s32 core = kThreadDefaultCore );
+	~CWorkerPool();
+
+	u32						GetNumThreads() const		{ return mThreads.size(); }
+
+	void					Submit( CWorkerJob * job );
+	EWorkerJobState			GetState( const CWorkerJob * job );
+
+	// Blocks until the job is idle. A job which hasn't started is run on the calling thread.
+	void					Wait( CWorkerJob * job );
+
+private:
+	static u32 DAEDALUS_THREAD_CALL_TYPE	WorkerThread( void * arg );
+	void					WorkerLoop();
+
+private:
+	Mutex					mMutex;
+#ifdef DAEDALUS_WORKERPOOL_COND
+	Cond *					mWorkReady;		// Signalled when a job is queued, or on quitting
+	Cond *					mJobDone;		// Signalled when a worker finishes a job
+#endif
+	std::deque< CWorkerJob * >	mQueue;
+	std::vector< ThreadHandle >	mThreads;
+	const EWorkerPoolWake	mWake;
+	volatile bool			mQuit;
+};
+
+#endif // UTILITY_WORKERPOOL_H_
@@ -208,7 +208,8 @@ bool	CInStream::ReadData( void * data, u32 length )
 				mBytesAvailable -= bytes_to_process;
 			}
 
-			if( mBytesAvailable == 0 )
+			// Don't refill once we're done, or a read which ends the file fails
+			if( bytes_remaining > 0 && mBytesAvailable == 0 )
 			{
 				if( !Fill() )
 				{